@@ -0,0 +1,92 @@
+/** @file AdvancedLoggerReaderLib.h
+
+  Advanced Logger Reader Library interface
+
+  The reader walks the ADVANCED_LOGGER_MESSAGE_ENTRY records of an in memory log in
+  place, without copying the log, while writers may still be appending to it.  It can
+  be used on any ADVANCED_LOGGER_INFO block, whether located through the Advanced
+  Logger protocol, the Advanced Logger HOB or PcdAdvancedLoggerBase, so it is usable
+  from DXE, MM and runtime code.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __ADVANCED_LOGGER_READER_LIB_H__
+#define __ADVANCED_LOGGER_READER_LIB_H__
+
+//
+// NOTE:
+//
+//     A cursor is a position in the log. It holds the offset of the next record from
+//     LogBuffer rather than a pointer, so it stays valid when the log is moved to a
+//     new buffer, and it can be saved and used again later to resume reading where it
+//     left off.  The cursor is validated against LogCurrent on every call.
+//
+//     Writers reserve space for a record before they fill it in, and write the record
+//     signature last.  A record that has been reserved but not yet completed is never
+//     returned; the reader reports EFI_NOT_READY and the same cursor may be retried.
+//
+
+typedef struct {
+  UINT64    Sequence;                   // Number of records returned through this cursor
+  UINT32    Offset;                     // Offset of the next record from LogBuffer
+  UINT32    DiscardedSize;              // DiscardedSize of the log when last read
+} ADVANCED_LOGGER_READER_CURSOR;
+
+/**
+  Open a cursor at the first record of the log.
+
+  @param  LoggerInfo             The logger information block of the log.
+  @param  Cursor                 Receives a cursor at the first record.
+
+  @retval EFI_SUCCESS            The cursor was initialized.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL or LoggerInfo is not a valid logger
+                                 information block.
+
+**/
+EFI_STATUS
+EFIAPI
+AdvancedLoggerReaderOpen (
+  IN  CONST ADVANCED_LOGGER_INFO     *LoggerInfo,
+  OUT ADVANCED_LOGGER_READER_CURSOR  *Cursor
+  );
+
+/**
+  Get the record at the cursor and advance the cursor past it.
+
+  The returned entry points into the log itself and must be treated as read only.
+  Once returned, a record is complete and is not modified by writers.
+
+  @param  LoggerInfo             The logger information block of the log.
+  @param  Cursor                 The position of the record to return. Advanced past the
+                                 record on EFI_SUCCESS, unchanged otherwise.
+  @param  Entry                  Receives a pointer to the record.
+  @param  DiscardedSize          Optional. Unless EFI_INVALID_PARAMETER is returned,
+                                 receives the number of message bytes the logger dropped
+                                 because the log was full since the previous call with
+                                 this cursor. These messages are not in the log.
+
+  @retval EFI_SUCCESS            Entry points to the next complete record.
+  @retval EFI_END_OF_FILE        There are no more records. The cursor may be used again
+                                 later to check for new records.
+  @retval EFI_NOT_READY          A writer has reserved the next record but not completed
+                                 it yet. Retry with the same cursor.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL, LoggerInfo is not a valid logger
+                                 information block, or the cursor is not a valid position
+                                 in this log.
+  @retval EFI_COMPROMISED_DATA   The record at the cursor extends past the end of the log.
+
+**/
+EFI_STATUS
+EFIAPI
+AdvancedLoggerReaderGetNext (
+  IN     CONST ADVANCED_LOGGER_INFO           *LoggerInfo,
+  IN OUT ADVANCED_LOGGER_READER_CURSOR        *Cursor,
+  OUT    CONST ADVANCED_LOGGER_MESSAGE_ENTRY  **Entry,
+  OUT    UINT32                               *DiscardedSize  OPTIONAL
+  );
+
+#endif // __ADVANCED_LOGGER_READER_LIB_H__
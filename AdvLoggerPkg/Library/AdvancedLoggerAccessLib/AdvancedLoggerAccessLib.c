@@ -14,6 +14,7 @@
 #include <AdvancedLoggerInternalProtocol.h>
 
 #include <Library/AdvancedLoggerAccessLib.h>
+#include <Library/AdvancedLoggerReaderLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
@@ -112,7 +113,9 @@ AdvancedLoggerAccessLibGetNextMessageBlock (
   IN  ADVANCED_LOGGER_ACCESS_MESSAGE_BLOCK_ENTRY  *BlockEntry
   )
 {
-  ADVANCED_LOGGER_MESSAGE_ENTRY  *LogEntry;
+  CONST ADVANCED_LOGGER_MESSAGE_ENTRY  *LogEntry;
+  ADVANCED_LOGGER_READER_CURSOR        Cursor;
+  EFI_STATUS                           Status;
 
   if (mLoggerInfo == NULL) {
     return EFI_NOT_STARTED;
@@ -122,42 +125,55 @@ AdvancedLoggerAccessLibGetNextMessageBlock (
     return EFI_INVALID_PARAMETER;
   }
 
-  if (mLoggerInfo->LogCurrent == mLoggerInfo->LogBuffer) {
-    return EFI_END_OF_FILE;
-  }
-
+  //
+  // The previous message is the position in the log.  Turn it into a reader cursor
+  // past that message, so the log is walked by AdvancedLoggerReaderGetNext.
+  //
   if (BlockEntry->Message == NULL) {
-    LogEntry = (ADVANCED_LOGGER_MESSAGE_ENTRY *)PTR_FROM_PA (mLoggerInfo->LogBuffer);
+    Cursor.Sequence = 0;
+    Cursor.Offset   = 0;
   } else {
     LogEntry = (ADVANCED_LOGGER_MESSAGE_ENTRY *)MESSAGE_ENTRY_FROM_MSG (BlockEntry->Message);
+
+    // Validate that LogEntry points within the proper Memory Log region
+    // in memory log buffer
+    if ((LogEntry != (ADVANCED_LOGGER_MESSAGE_ENTRY *)ALIGN_POINTER (LogEntry, 8)) || // Insure pointer is on boundary
+        (LogEntry < mLowAddress) ||                                                   // and within the log region
+        (LogEntry >= mHighAddress))
+    {
+      DEBUG ((DEBUG_ERROR, "Invalid Address for LogEntry %p. Low=%p, High=%p\n", LogEntry, mLowAddress, mHighAddress));
+      return EFI_INVALID_PARAMETER;
+    }
+
     if (LogEntry->Signature != MESSAGE_ENTRY_SIGNATURE) {
       DEBUG ((DEBUG_ERROR, "Resume LogEntry invalid signature at %p\n", LogEntry));
       DUMP_HEX (DEBUG_INFO, 0, (CHAR8 *)LogEntry - 128, 256, "");
       return EFI_INVALID_PARAMETER;
     }
 
-    LogEntry = NEXT_LOG_ENTRY (LogEntry);
+    // Any non zero sequence tells the reader the cursor is past the first record.
+    Cursor.Sequence = 1;
+    Cursor.Offset   = (UINT32)((UINTN)NEXT_LOG_ENTRY (LogEntry) - (UINTN)mLowAddress);
   }
 
-  // Validate that LogEntry points within the proper Memory Log region
-  // in memory log buffer
-  if ((LogEntry != (ADVANCED_LOGGER_MESSAGE_ENTRY *)ALIGN_POINTER (LogEntry, 8)) || // Insure pointer is on boundary
-      (LogEntry < mLowAddress) ||                                                   // and within the log region
-      (LogEntry > mHighAddress))
-  {
-    DEBUG ((DEBUG_ERROR, "Invalid Address for LogEntry %p. Low=%p, High=%p\n", LogEntry, mLowAddress, mHighAddress));
-    return EFI_INVALID_PARAMETER;
-  }
+  Cursor.DiscardedSize = mLoggerInfo->DiscardedSize;
+
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &Cursor, &LogEntry, NULL);
 
-  if (LogEntry >= (ADVANCED_LOGGER_MESSAGE_ENTRY *)PTR_FROM_PA (mLoggerInfo->LogCurrent)) {
+  //
+  // A message that a writer has reserved but not completed yet is not returned.  The
+  // previous message stays the position, so the next call checks it again.
+  //
+  if (Status == EFI_NOT_READY) {
     return EFI_END_OF_FILE;
   }
 
-  if (LogEntry->Signature != MESSAGE_ENTRY_SIGNATURE) {
-    DEBUG ((DEBUG_ERROR, "Next LogEntry invalid signature at %p, Last=%p\n", LogEntry, BlockEntry->Message));
-    DUMP_HEX (DEBUG_INFO, 0, (CHAR8 *)BlockEntry->Message - 128, 256, "");
-    DUMP_HEX (DEBUG_INFO, 0, (CHAR8 *)LogEntry - 128, 256, "");
-    return EFI_COMPROMISED_DATA;
+  if (EFI_ERROR (Status)) {
+    if (Status != EFI_END_OF_FILE) {
+      DEBUG ((DEBUG_ERROR, "Unable to get the next LogEntry after %p. Code=%r\n", BlockEntry->Message, Status));
+    }
+
+    return Status;
   }
 
   BlockEntry->TimeStamp  = LogEntry->TimeStamp;
@@ -12,6 +12,7 @@
 #include <AdvancedLoggerInternal.h>
 
 #include <Library/AdvancedLoggerHdwPortLib.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/PcdLib.h>
 #include <Library/SynchronizationLib.h>
@@ -101,6 +102,12 @@ AdvancedLoggerMemoryLoggerWrite (
     Entry->DebugLevel = (UINT32)DebugLevel;
     Entry->MessageLen = (UINT16)NumberOfBytes;
     CopyMem (Entry->MessageText, Buffer, NumberOfBytes);
+
+    //
+    // Readers may be walking the log while it is written. The signature marks the entry
+    // complete, so make the rest of the entry visible before it.
+    //
+    MemoryFence ();
     Entry->Signature = MESSAGE_ENTRY_SIGNATURE;
   }
 
@@ -358,7 +358,11 @@ DxeCoreAdvancedLoggerLibConstructor (
   if (LoggerInfo == NULL) {
     LoggerInfo = (ADVANCED_LOGGER_INFO *)AllocateReservedPages (FixedPcdGet32 (PcdAdvancedLoggerPages));
     if (LoggerInfo != NULL) {
-      ZeroMem ((VOID *)LoggerInfo, sizeof (ADVANCED_LOGGER_INFO));
+      //
+      // Zero the log too. A reader takes a message signature left in a reserved record
+      // as the record being complete.
+      //
+      ZeroMem ((VOID *)LoggerInfo, EFI_PAGES_TO_SIZE (FixedPcdGet32 (PcdAdvancedLoggerPages)));
       LoggerInfo->Signature     = ADVANCED_LOGGER_SIGNATURE;
       LoggerInfo->Version       = ADVANCED_LOGGER_VERSION;
       LoggerInfo->LogBuffer     = PA_FROM_PTR (LoggerInfo + 1);
@@ -211,6 +211,10 @@ InstallPermanentMemoryBuffer (
                  );
       if (!EFI_ERROR (Status)) {
         NewLoggerInfo = ALI_FROM_PA (NewLogBuffer);
+        //
+        // Zero the new buffer so no stale message signature follows the copied records.
+        //
+        ZeroMem ((VOID *)NewLoggerInfo, EFI_PAGES_TO_SIZE (FixedPcdGet32 (PcdAdvancedLoggerPages)));
         CopyMem ((VOID *)NewLoggerInfo, (VOID *)LoggerInfo, sizeof (ADVANCED_LOGGER_INFO));
         CurrentLogOffset         = (UINTN)(LoggerInfo->LogCurrent - LoggerInfo->LogBuffer);
         NewLoggerInfo->LogBuffer = PA_FROM_PTR ((CHAR8 *)(NewLoggerInfo + 1));
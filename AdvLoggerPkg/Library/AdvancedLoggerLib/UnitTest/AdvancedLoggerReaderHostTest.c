@@ -0,0 +1,733 @@
+/** @file
+  Host based test of AdvancedLoggerReaderLib.
+
+  Messages are written with the real AdvancedLoggerWrite () path of
+  AdvancedLoggerLib.  The writer calls GetPerformanceCounter () after it has
+  reserved space for a record and before it fills the record in, so the mocked
+  GetPerformanceCounter () is used to run a reader tailing the log, and further
+  writers, while a record is in flight.  This simulates writers preempting each
+  other (interrupts, MM) and a reader running concurrently with them.
+
+  Every message carries its sequence number and a body derived from it, so the
+  reader can check that each record it gets is complete and that records are
+  returned exactly once and in order.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+
+#include <AdvancedLoggerInternal.h>
+
+#include <Library/AdvancedLoggerReaderLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "../AdvancedLoggerCommon.h"
+
+#define UNIT_TEST_NAME     "Advanced Logger Reader Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define TEST_LOG_SIZE         (256 * 1024)
+#define TEST_MAX_MESSAGE      128
+#define TEST_MAX_WRITE_DEPTH  3
+#define TEST_STALE_BYTE       0xA5
+
+//
+// Message layout: "#" 8 hex digits of the sequence number ":" body "\n".
+//
+#define TEST_HEADER_SIZE  10
+
+STATIC UINT64                mLogMemory[(sizeof (ADVANCED_LOGGER_INFO) + TEST_LOG_SIZE) / sizeof (UINT64)];
+STATIC UINT64                mCopyMemory[(sizeof (ADVANCED_LOGGER_INFO) + TEST_LOG_SIZE) / sizeof (UINT64)];
+STATIC ADVANCED_LOGGER_INFO  *mLoggerInfo;
+STATIC UINT64                mTicks;
+STATIC UINT32                mRandomState;
+
+//
+// Writer state.
+//
+typedef enum {
+  HookNone,
+  HookInFlight,
+  HookRandom
+} TEST_HOOK;
+
+STATIC TEST_HOOK  mHook;
+STATIC UINT32     mHookDepth;
+STATIC UINT32     mNextSequence;
+STATIC UINT32     mInFlight[TEST_MAX_WRITE_DEPTH + 1];
+STATIC UINT32     mInFlightCount;
+
+//
+// Tailing reader state.
+//
+STATIC ADVANCED_LOGGER_READER_CURSOR  mCursor;
+STATIC UINT32                         mRecordsRead;
+STATIC UINT32                         mNotReadyCount;
+STATIC BOOLEAN                        mReaderFailed;
+
+/**
+  AdvancedLoggerLib instance interface used by AdvancedLoggerWrite ().
+
+  @return The test log.
+**/
+ADVANCED_LOGGER_INFO *
+EFIAPI
+AdvancedLoggerGetLoggerInfo (
+  VOID
+  )
+{
+  return mLoggerInfo;
+}
+
+/**
+  Returns the next value of a xorshift generator.
+**/
+STATIC
+UINT32
+NextRandom (
+  VOID
+  )
+{
+  mRandomState ^= mRandomState << 13;
+  mRandomState ^= mRandomState >> 17;
+  mRandomState ^= mRandomState << 5;
+  return mRandomState;
+}
+
+/**
+  Get the message length used for a sequence number.
+**/
+STATIC
+UINT16
+MessageLength (
+  IN UINT32  Sequence
+  )
+{
+  return (UINT16)(TEST_HEADER_SIZE + 1 + (Sequence * 37) % (TEST_MAX_MESSAGE - TEST_HEADER_SIZE - 1));
+}
+
+/**
+  Build the message for a sequence number.
+**/
+STATIC
+UINT16
+BuildMessage (
+  IN  UINT32  Sequence,
+  OUT CHAR8   *Message
+  )
+{
+  UINT16  Length;
+  UINT16  Index;
+
+  Length     = MessageLength (Sequence);
+  Message[0] = '#';
+  for (Index = 0; Index < 8; Index++) {
+    Message[1 + Index] = "0123456789abcdef"[(Sequence >> (28 - 4 * Index)) & 0xF];
+  }
+
+  Message[9] = ':';
+  for (Index = TEST_HEADER_SIZE; Index < Length - 1; Index++) {
+    Message[Index] = (CHAR8)('a' + (Sequence * 7 + Index) % 26);
+  }
+
+  Message[Length - 1] = '\n';
+  return Length;
+}
+
+/**
+  Check that a record holds the complete message of the expected sequence number.
+**/
+STATIC
+BOOLEAN
+RecordIsComplete (
+  IN CONST ADVANCED_LOGGER_MESSAGE_ENTRY  *Entry,
+  IN UINT32                               Sequence
+  )
+{
+  CHAR8   Expected[TEST_MAX_MESSAGE];
+  UINT16  Length;
+
+  Length = BuildMessage (Sequence, Expected);
+  return (Entry->Signature == MESSAGE_ENTRY_SIGNATURE) &&
+         (Entry->DebugLevel == DEBUG_INFO) &&
+         (Entry->MessageLen == Length) &&
+         (CompareMem (Entry->MessageText, Expected, Length) == 0);
+}
+
+/**
+  Read every available record with the tailing reader and check it.
+**/
+STATIC
+VOID
+TailLog (
+  VOID
+  )
+{
+  CONST ADVANCED_LOGGER_MESSAGE_ENTRY  *Entry;
+  EFI_STATUS                           Status;
+  UINT32                               Index;
+
+  while (TRUE) {
+    Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+    if (Status == EFI_END_OF_FILE) {
+      return;
+    }
+
+    if (Status == EFI_NOT_READY) {
+      //
+      // The record at the cursor must belong to a writer that has not returned.
+      //
+      for (Index = 0; Index < mInFlightCount; Index++) {
+        if (mInFlight[Index] == mRecordsRead) {
+          break;
+        }
+      }
+
+      if (Index == mInFlightCount) {
+        DEBUG ((DEBUG_ERROR, "Record %d not ready with no writer in flight\n", mRecordsRead));
+        mReaderFailed = TRUE;
+      }
+
+      mNotReadyCount++;
+      return;
+    }
+
+    if (EFI_ERROR (Status) || !RecordIsComplete (Entry, mRecordsRead) ||
+        ((UINT8 *)Entry < (UINT8 *)(mLoggerInfo + 1)) ||
+        ((UINT8 *)Entry >= (UINT8 *)(mLoggerInfo + 1) + TEST_LOG_SIZE))
+    {
+      DEBUG ((DEBUG_ERROR, "Record %d is not valid. Status=%r\n", mRecordsRead, Status));
+      mReaderFailed = TRUE;
+      return;
+    }
+
+    mRecordsRead++;
+    if (mCursor.Sequence != mRecordsRead) {
+      mReaderFailed = TRUE;
+      return;
+    }
+  }
+}
+
+/**
+  Write the next test message.
+**/
+STATIC
+VOID
+WriteTestMessage (
+  VOID
+  )
+{
+  CHAR8   Message[TEST_MAX_MESSAGE];
+  UINT16  Length;
+
+  Length                      = BuildMessage (mNextSequence, Message);
+  mInFlight[mInFlightCount++] = mNextSequence++;
+  AdvancedLoggerWrite (DEBUG_INFO, Message, Length);
+  mInFlightCount--;
+}
+
+/**
+  Mocked TimerLib GetPerformanceCounter ().
+
+  The writer calls it between reserving a record and filling it in, so the
+  reader and other writers run here to interleave with the writer.
+**/
+UINT64
+EFIAPI
+GetPerformanceCounter (
+  VOID
+  )
+{
+  UINT32  Random;
+
+  if ((mHook != HookNone) && (mHookDepth < TEST_MAX_WRITE_DEPTH)) {
+    mHookDepth++;
+    if (mHook == HookInFlight) {
+      //
+      // Read the log, preempt the writer with a second writer, and read the log
+      // again once the second record is complete.
+      //
+      TailLog ();
+      if (mHookDepth == 1) {
+        WriteTestMessage ();
+        TailLog ();
+      }
+    } else {
+      Random = NextRandom ();
+      if ((Random & 0x3) == 0) {
+        TailLog ();
+      }
+
+      if ((Random & 0x30) == 0) {
+        WriteTestMessage ();
+      }
+
+      if ((Random & 0x300) == 0) {
+        TailLog ();
+      }
+    }
+
+    mHookDepth--;
+  }
+
+  return ++mTicks;
+}
+
+/**
+  Reset the test log. The unused part of the log holds stale data, as it would
+  after a warm reset.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ResetLog (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  SetMem (mLogMemory, sizeof (mLogMemory), TEST_STALE_BYTE);
+  mLoggerInfo = (ADVANCED_LOGGER_INFO *)mLogMemory;
+  ZeroMem ((VOID *)mLoggerInfo, sizeof (ADVANCED_LOGGER_INFO));
+  mLoggerInfo->Signature       = ADVANCED_LOGGER_SIGNATURE;
+  mLoggerInfo->Version         = ADVANCED_LOGGER_VERSION;
+  mLoggerInfo->LogBuffer       = PA_FROM_PTR (mLoggerInfo + 1);
+  mLoggerInfo->LogCurrent      = mLoggerInfo->LogBuffer;
+  mLoggerInfo->LogBufferSize   = TEST_LOG_SIZE;
+  mLoggerInfo->HdwPortDisabled = TRUE;
+
+  mHook          = HookNone;
+  mHookDepth     = 0;
+  mNextSequence  = 0;
+  mInFlightCount = 0;
+  mRecordsRead   = 0;
+  mNotReadyCount = 0;
+  mReaderFailed  = FALSE;
+  mRandomState   = 0x6C8E9CF5;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Records should be returned in place and in order, and a saved cursor should
+  resume where it was saved.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReaderSequential (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  ADVANCED_LOGGER_READER_CURSOR        Saved;
+  CONST ADVANCED_LOGGER_MESSAGE_ENTRY  *Entry;
+  CONST ADVANCED_LOGGER_MESSAGE_ENTRY  *First;
+  EFI_STATUS                           Status;
+  UINT32                               Index;
+
+  Status = AdvancedLoggerReaderOpen (mLoggerInfo, &mCursor);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_END_OF_FILE);
+
+  for (Index = 0; Index < 3; Index++) {
+    WriteTestMessage ();
+  }
+
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &First, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_TRUE (First == (ADVANCED_LOGGER_MESSAGE_ENTRY *)(mLoggerInfo + 1));
+  UT_ASSERT_TRUE (RecordIsComplete (First, 0));
+
+  CopyMem (&Saved, &mCursor, sizeof (Saved));
+  for (Index = 1; Index < 3; Index++) {
+    Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_TRUE (RecordIsComplete (Entry, Index));
+  }
+
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_END_OF_FILE);
+  UT_ASSERT_EQUAL (mCursor.Sequence, 3);
+  UT_ASSERT_EQUAL (mCursor.Offset, mLoggerInfo->LogCurrent - mLoggerInfo->LogBuffer);
+
+  //
+  // New records are found from the same cursor, and the saved cursor resumes at the
+  // second record.
+  //
+  WriteTestMessage ();
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_TRUE (RecordIsComplete (Entry, 3));
+
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &Saved, &Entry, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_TRUE (Entry == NEXT_LOG_ENTRY (First));
+  UT_ASSERT_TRUE (RecordIsComplete (Entry, 1));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A record that is reserved but not yet written should block the reader, also
+  when records behind it are already complete.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReaderInFlightRecord (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = AdvancedLoggerReaderOpen (mLoggerInfo, &mCursor);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  WriteTestMessage ();
+
+  mHook = HookInFlight;
+  WriteTestMessage ();
+  mHook = HookNone;
+
+  UT_ASSERT_FALSE (mReaderFailed);
+
+  //
+  // Each of the three reads stopped at the second record, including the one made
+  // after the third record was complete.
+  //
+  UT_ASSERT_EQUAL (mRecordsRead, 1);
+  UT_ASSERT_EQUAL (mNotReadyCount, 3);
+
+  TailLog ();
+  UT_ASSERT_FALSE (mReaderFailed);
+  UT_ASSERT_EQUAL (mRecordsRead, mNextSequence);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A reader tailing the log while writers preempt each other should get every
+  record exactly once, in order, and never a partially written record.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReaderConcurrentWriters (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Round;
+
+  Status = AdvancedLoggerReaderOpen (mLoggerInfo, &mCursor);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  mHook = HookRandom;
+  for (Round = 0; Round < 1500; Round++) {
+    WriteTestMessage ();
+    if ((NextRandom () & 0x7) == 0) {
+      TailLog ();
+    }
+
+    UT_ASSERT_FALSE (mReaderFailed);
+  }
+
+  mHook = HookNone;
+
+  UT_ASSERT_EQUAL (mLoggerInfo->DiscardedSize, 0);
+  UT_ASSERT_TRUE (mNotReadyCount > 0);
+
+  TailLog ();
+  UT_ASSERT_FALSE (mReaderFailed);
+  UT_ASSERT_EQUAL (mRecordsRead, mNextSequence);
+  UT_ASSERT_TRUE (mNextSequence > 1500);
+
+  UT_LOG_INFO ("%d records, %d waits on in flight records\n", mRecordsRead, mNotReadyCount);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Cursors that are not a valid position in the log should be rejected, and a
+  cursor should stay valid when the log is moved.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReaderCursorValidation (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  ADVANCED_LOGGER_READER_CURSOR        Cursor;
+  CONST ADVANCED_LOGGER_MESSAGE_ENTRY  *Entry;
+  ADVANCED_LOGGER_INFO                 *CopyInfo;
+  EFI_STATUS                           Status;
+  UINT32                               Index;
+
+  for (Index = 0; Index < 4; Index++) {
+    WriteTestMessage ();
+  }
+
+  Status = AdvancedLoggerReaderOpen (mLoggerInfo, &mCursor);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  //
+  // Past LogCurrent, misaligned, and an offset that does not match the sequence.
+  //
+  CopyMem (&Cursor, &mCursor, sizeof (Cursor));
+  Cursor.Offset = (UINT32)(mLoggerInfo->LogCurrent - mLoggerInfo->LogBuffer) + 8;
+  Status        = AdvancedLoggerReaderGetNext (mLoggerInfo, &Cursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  CopyMem (&Cursor, &mCursor, sizeof (Cursor));
+  Cursor.Offset += 4;
+  Status         = AdvancedLoggerReaderGetNext (mLoggerInfo, &Cursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  CopyMem (&Cursor, &mCursor, sizeof (Cursor));
+  Cursor.Sequence = 0;
+  Status          = AdvancedLoggerReaderGetNext (mLoggerInfo, &Cursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  Status = AdvancedLoggerReaderGetNext (NULL, &mCursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, NULL, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  //
+  // An information block with a bad signature or LogCurrent is rejected.
+  //
+  mLoggerInfo->Signature = 0;
+  Status                 = AdvancedLoggerReaderOpen (mLoggerInfo, &Cursor);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  mLoggerInfo->Signature = ADVANCED_LOGGER_SIGNATURE;
+
+  mLoggerInfo->LogCurrent += TEST_LOG_SIZE;
+  Status                   = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  mLoggerInfo->LogCurrent -= TEST_LOG_SIZE;
+
+  //
+  // Move the log to a new buffer, as PEI does when memory becomes available. The
+  // cursor resumes at the second record of the copy.
+  //
+  CopyMem (mCopyMemory, mLogMemory, sizeof (mCopyMemory));
+  CopyInfo             = (ADVANCED_LOGGER_INFO *)mCopyMemory;
+  CopyInfo->LogBuffer  = PA_FROM_PTR (CopyInfo + 1);
+  CopyInfo->LogCurrent = CopyInfo->LogBuffer + (mLoggerInfo->LogCurrent - mLoggerInfo->LogBuffer);
+
+  Status = AdvancedLoggerReaderGetNext (CopyInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_TRUE ((UINT8 *)Entry > (UINT8 *)CopyInfo);
+  UT_ASSERT_TRUE ((UINT8 *)Entry < (UINT8 *)CopyInfo + sizeof (mCopyMemory));
+  UT_ASSERT_TRUE (RecordIsComplete (Entry, 1));
+
+  //
+  // A record whose length runs past LogCurrent is reported as compromised.
+  //
+  ((ADVANCED_LOGGER_MESSAGE_ENTRY *)Entry)->MessageLen = MAX_UINT16;
+  CopyMem (&Cursor, &mCursor, sizeof (Cursor));
+  Cursor.Sequence--;
+  Cursor.Offset -= (UINT32)MESSAGE_ENTRY_SIZE (MessageLength (1));
+  Status         = AdvancedLoggerReaderGetNext (CopyInfo, &Cursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_COMPROMISED_DATA);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Messages dropped because the log is full should be reported once.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReaderDiscarded (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  CONST ADVANCED_LOGGER_MESSAGE_ENTRY  *Entry;
+  EFI_STATUS                           Status;
+  UINT32                               Discarded;
+  UINT32                               Total;
+  UINT32                               Records;
+
+  mLoggerInfo->LogBufferSize = 1024;
+
+  Status = AdvancedLoggerReaderOpen (mLoggerInfo, &mCursor);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  while (mLoggerInfo->DiscardedSize == 0) {
+    WriteTestMessage ();
+  }
+
+  Total   = 0;
+  Records = 0;
+  do {
+    Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, &Discarded);
+    Total += Discarded;
+    if (!EFI_ERROR (Status)) {
+      UT_ASSERT_TRUE (RecordIsComplete (Entry, Records));
+      Records++;
+    }
+  } while (!EFI_ERROR (Status));
+
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_END_OF_FILE);
+  UT_ASSERT_EQUAL (Total, mLoggerInfo->DiscardedSize);
+  UT_ASSERT_EQUAL (Total, MessageLength (mNextSequence - 1));
+  UT_ASSERT_EQUAL (Records, mNextSequence - 1);
+
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, &Discarded);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_END_OF_FILE);
+  UT_ASSERT_EQUAL (Discarded, 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Message signatures left past LogCurrent, as a previous boot may leave them, should
+  never be returned as records. Once the loggers zero the unused log, a reserved
+  record should read as in flight rather than complete.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReaderStaleSignatures (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  CONST ADVANCED_LOGGER_MESSAGE_ENTRY  *Entry;
+  ADVANCED_LOGGER_MESSAGE_ENTRY        *Stale;
+  EFI_STATUS                           Status;
+  UINT32                               Index;
+  UINT32                               Offset;
+
+  //
+  // Put a plausible record with a valid signature at every aligned offset of the log.
+  //
+  for (Offset = 0; Offset < TEST_LOG_SIZE; Offset += sizeof (UINT64)) {
+    Stale            = (ADVANCED_LOGGER_MESSAGE_ENTRY *)((UINT8 *)(mLoggerInfo + 1) + Offset);
+    Stale->Signature = MESSAGE_ENTRY_SIGNATURE;
+  }
+
+  Status = AdvancedLoggerReaderOpen (mLoggerInfo, &mCursor);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_END_OF_FILE);
+
+  for (Index = 0; Index < 3; Index++) {
+    WriteTestMessage ();
+  }
+
+  for (Index = 0; Index < 3; Index++) {
+    Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_TRUE (RecordIsComplete (Entry, Index));
+  }
+
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_END_OF_FILE);
+  UT_ASSERT_EQUAL (mCursor.Offset, mLoggerInfo->LogCurrent - mLoggerInfo->LogBuffer);
+
+  //
+  // Zero the unused log as the loggers do when they allocate or move it, and reserve a
+  // record the way a writer does before filling it in.
+  //
+  ZeroMem (
+    PTR_FROM_PA (mLoggerInfo->LogCurrent),
+    (UINTN)(mLoggerInfo->LogBufferSize - (mLoggerInfo->LogCurrent - mLoggerInfo->LogBuffer))
+    );
+  mLoggerInfo->LogCurrent += MESSAGE_ENTRY_SIZE (MessageLength (3));
+
+  Status = AdvancedLoggerReaderGetNext (mLoggerInfo, &mCursor, &Entry, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_READY);
+  UT_ASSERT_EQUAL (mCursor.Sequence, 3);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  Advanced Logger reader and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ReaderSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the Reader Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&ReaderSuite, Framework, "Reader", "AdvLogger.Reader", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ReaderSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (ReaderSuite, "Records should be read in place and resumed from a saved cursor", "Sequential", ReaderSequential, ResetLog, NULL, NULL);
+  AddTestCase (ReaderSuite, "A record in flight should block the reader", "InFlightRecord", ReaderInFlightRecord, ResetLog, NULL, NULL);
+  AddTestCase (ReaderSuite, "Tailing concurrent writers should return no torn records", "ConcurrentWriters", ReaderConcurrentWriters, ResetLog, NULL, NULL);
+  AddTestCase (ReaderSuite, "Invalid cursors should be rejected and moved logs resumed", "CursorValidation", ReaderCursorValidation, ResetLog, NULL, NULL);
+  AddTestCase (ReaderSuite, "Discarded messages should be reported once", "Discarded", ReaderDiscarded, ResetLog, NULL, NULL);
+  AddTestCase (ReaderSuite, "Stale signatures past LogCurrent should not be read as records", "StaleSignatures", ReaderStaleSignatures, ResetLog, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
@@ -0,0 +1,192 @@
+/** @file
+  Implementation of Advanced Logger Reader Library.
+
+  Copyright (c) Microsoft Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+
+#include <AdvancedLoggerInternal.h>
+
+#include <Library/AdvancedLoggerReaderLib.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+
+/**
+  Validate the logger information block and get the number of bytes of the log that
+  writers have reserved.
+
+  @param  LoggerInfo  The logger information block.
+  @param  UsedSize    Receives the offset of LogCurrent from LogBuffer.
+
+  @retval TRUE        The logger information block is valid.
+  @retval FALSE       The logger information block is not valid.
+
+**/
+STATIC
+BOOLEAN
+GetUsedSize (
+  IN  CONST ADVANCED_LOGGER_INFO  *LoggerInfo,
+  OUT UINT32                      *UsedSize
+  )
+{
+  EFI_PHYSICAL_ADDRESS  LogBuffer;
+  EFI_PHYSICAL_ADDRESS  LogCurrent;
+
+  if (LoggerInfo->Signature != ADVANCED_LOGGER_SIGNATURE) {
+    return FALSE;
+  }
+
+  //
+  // LogCurrent is read once, so every check in a call is made against the same value.
+  //
+  LogBuffer  = LoggerInfo->LogBuffer;
+  LogCurrent = LoggerInfo->LogCurrent;
+  if ((LogCurrent < LogBuffer) || ((LogCurrent - LogBuffer) > LoggerInfo->LogBufferSize)) {
+    return FALSE;
+  }
+
+  *UsedSize = (UINT32)(LogCurrent - LogBuffer);
+  return TRUE;
+}
+
+/**
+  Open a cursor at the first record of the log.
+
+  @param  LoggerInfo             The logger information block of the log.
+  @param  Cursor                 Receives a cursor at the first record.
+
+  @retval EFI_SUCCESS            The cursor was initialized.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL or LoggerInfo is not a valid logger
+                                 information block.
+
+**/
+EFI_STATUS
+EFIAPI
+AdvancedLoggerReaderOpen (
+  IN  CONST ADVANCED_LOGGER_INFO     *LoggerInfo,
+  OUT ADVANCED_LOGGER_READER_CURSOR  *Cursor
+  )
+{
+  UINT32  UsedSize;
+
+  if ((LoggerInfo == NULL) || (Cursor == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!GetUsedSize (LoggerInfo, &UsedSize)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Cursor->Sequence      = 0;
+  Cursor->Offset        = 0;
+  Cursor->DiscardedSize = 0;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the record at the cursor and advance the cursor past it.
+
+  The returned entry points into the log itself and must be treated as read only.
+  Once returned, a record is complete and is not modified by writers.
+
+  @param  LoggerInfo             The logger information block of the log.
+  @param  Cursor                 The position of the record to return. Advanced past the
+                                 record on EFI_SUCCESS, unchanged otherwise.
+  @param  Entry                  Receives a pointer to the record.
+  @param  DiscardedSize          Optional. Unless EFI_INVALID_PARAMETER is returned,
+                                 receives the number of message bytes the logger dropped
+                                 because the log was full since the previous call with
+                                 this cursor. These messages are not in the log.
+
+  @retval EFI_SUCCESS            Entry points to the next complete record.
+  @retval EFI_END_OF_FILE        There are no more records. The cursor may be used again
+                                 later to check for new records.
+  @retval EFI_NOT_READY          A writer has reserved the next record but not completed
+                                 it yet. Retry with the same cursor.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL, LoggerInfo is not a valid logger
+                                 information block, or the cursor is not a valid position
+                                 in this log.
+  @retval EFI_COMPROMISED_DATA   The record at the cursor extends past the end of the log.
+
+**/
+EFI_STATUS
+EFIAPI
+AdvancedLoggerReaderGetNext (
+  IN     CONST ADVANCED_LOGGER_INFO           *LoggerInfo,
+  IN OUT ADVANCED_LOGGER_READER_CURSOR        *Cursor,
+  OUT    CONST ADVANCED_LOGGER_MESSAGE_ENTRY  **Entry,
+  OUT    UINT32                               *DiscardedSize  OPTIONAL
+  )
+{
+  ADVANCED_LOGGER_MESSAGE_ENTRY  *LogEntry;
+  UINT32                         UsedSize;
+  UINT32                         Discarded;
+  UINTN                          EntrySize;
+
+  if ((LoggerInfo == NULL) || (Cursor == NULL) || (Entry == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!GetUsedSize (LoggerInfo, &UsedSize)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Records are 8 byte aligned and reserved in order, so a valid cursor is aligned, is
+  // not past LogCurrent, and is at the start of the log only before the first record.
+  //
+  if ((Cursor->Offset > UsedSize) ||
+      ((Cursor->Offset & (sizeof (UINT64) - 1)) != 0) ||
+      ((Cursor->Sequence == 0) != (Cursor->Offset == 0)))
+  {
+    DEBUG ((DEBUG_ERROR, "%a: Invalid cursor. Sequence=%ld Offset=0x%x Used=0x%x\n", __FUNCTION__, Cursor->Sequence, Cursor->Offset, UsedSize));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // The logger only grows DiscardedSize, so the difference is what was dropped since
+  // the previous call, even if the counter wrapped.
+  //
+  Discarded = LoggerInfo->DiscardedSize;
+  if (DiscardedSize != NULL) {
+    *DiscardedSize = Discarded - Cursor->DiscardedSize;
+  }
+
+  Cursor->DiscardedSize = Discarded;
+
+  if (Cursor->Offset == UsedSize) {
+    return EFI_END_OF_FILE;
+  }
+
+  if ((UsedSize - Cursor->Offset) < sizeof (ADVANCED_LOGGER_MESSAGE_ENTRY)) {
+    return EFI_COMPROMISED_DATA;
+  }
+
+  LogEntry = (ADVANCED_LOGGER_MESSAGE_ENTRY *)PTR_FROM_PA (LoggerInfo->LogBuffer + Cursor->Offset);
+
+  //
+  // The signature is written last, after a fence. Read it first, and fence again before
+  // reading the rest of the record, so a record is never returned partially written.
+  //
+  if (*(volatile UINT32 *)&LogEntry->Signature != MESSAGE_ENTRY_SIGNATURE) {
+    return EFI_NOT_READY;
+  }
+
+  MemoryFence ();
+
+  EntrySize = MESSAGE_ENTRY_SIZE (LogEntry->MessageLen);
+  if (EntrySize > (UsedSize - Cursor->Offset)) {
+    DEBUG ((DEBUG_ERROR, "%a: Record at 0x%x overruns the log. Length=%d Used=0x%x\n", __FUNCTION__, Cursor->Offset, LogEntry->MessageLen, UsedSize));
+    return EFI_COMPROMISED_DATA;
+  }
+
+  *Entry = LogEntry;
+  Cursor->Offset += (UINT32)EntrySize;
+  Cursor->Sequence++;
+
+  return EFI_SUCCESS;
+}
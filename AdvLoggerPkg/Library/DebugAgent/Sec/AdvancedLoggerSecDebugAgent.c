@@ -125,7 +125,11 @@ InitializeDebugAgent (
     NewLogBuffer = AllocateRamForSEC (CarBase, LogBufferSize);
     if (NewLogBuffer != 0ULL) {
       LoggerInfo = ALI_FROM_PA (NewLogBuffer);
-      ZeroMem ((VOID *)LoggerInfo, sizeof (ADVANCED_LOGGER_INFO));
+      //
+      // CAR may hold data from a previous boot. Zero the whole log, as readers take a
+      // message signature in a reserved record as the record being complete.
+      //
+      ZeroMem ((VOID *)LoggerInfo, LogBufferSize);
       LoggerInfo->Signature          = ADVANCED_LOGGER_SIGNATURE;
       LoggerInfo->Version            = ADVANCED_LOGGER_VERSION;
       LoggerInfo->LogBufferSize      = LogBufferSize - sizeof (ADVANCED_LOGGER_INFO);
@@ -195,6 +199,10 @@ InitializeDebugAgent (
 
           BufferSize    = (UINTN)(LoggerInfo->LogCurrent - LoggerInfo->LogBuffer);
           NewLoggerInfo = ALI_FROM_PA (NewLogBuffer);
+          //
+          // Zero the new buffer so no stale message signature follows the copied records.
+          //
+          ZeroMem ((VOID *)NewLoggerInfo, EFI_PAGES_TO_SIZE (FixedPcdGet32 (PcdAdvancedLoggerPages)));
           CopyMem ((VOID *)NewLoggerInfo, (VOID *)LoggerInfo, sizeof (ADVANCED_LOGGER_INFO));
           NewLoggerInfo->LogBuffer = PA_FROM_PTR ((NewLoggerInfo + 1));
           TargetLog                = CHAR8_FROM_PA (NewLoggerInfo->LogBuffer);
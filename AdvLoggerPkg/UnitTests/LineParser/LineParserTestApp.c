@@ -319,9 +319,11 @@ InitializeInMemoryLog (
 
   #define IN_MEMORY_PAGES  32// 1 MB test memory log
 
+  mLoggerInfo.Signature     = ADVANCED_LOGGER_SIGNATURE;
   mLoggerInfo.LogBuffer     = (EFI_PHYSICAL_ADDRESS)AllocatePages (IN_MEMORY_PAGES);
   mLoggerInfo.LogBufferSize = EFI_PAGE_SIZE * IN_MEMORY_PAGES;
   mLoggerInfo.LogCurrent    = mLoggerInfo.LogBuffer;
+  ZeroMem ((VOID *)(UINTN)mLoggerInfo.LogBuffer, mLoggerInfo.LogBufferSize);
 
   for (i = 0; i < ARRAY_SIZE (InternalMemoryLog); i++) {
     UnitTestStatus = InternalTestLoggerWrite (
@@ -119,6 +119,7 @@ struct _DFCI_NETWORK_REQUEST {
     EFI_HTTP_PROTOCOL       *HttpProtocol;
     EFI_HANDLE              HttpChildHandle;
     EFI_HTTP_CONFIG_DATA    ConfigData;
+    UINTN                   RequestCount;    // Requests issued on this HTTP child
   } Http;
 
   struct {
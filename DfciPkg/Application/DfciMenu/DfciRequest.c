@@ -25,6 +25,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/ServiceBinding.h>
 #include <Protocol/TlsConfig.h>
 
+#include <Library/BaseCryptLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
@@ -55,11 +56,30 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define HEADER_CONTENT_JSON  "application/json"
 #define HEADER_RETRY_AFTER   "Retry-After"
 #define HEADER_LOCATION      "Location"
+#define HEADER_DIGEST        "Digest"
+#define HEADER_CONNECTION    "Connection"
+
+#define HEADER_CONNECTION_CLOSE  "close"
+
+#define DIGEST_SHA256_PREFIX  "SHA-256="
 
 STATIC VOID    *mOldCertificateList = NULL;
 STATIC UINTN   mOldCertificateSize;
 STATIC UINT32  mOldCertificateAttr;
 
+//
+// Per NIC state while racing DHCP on every NIC with media present
+//
+typedef struct {
+  EFI_HANDLE                      NicHandle;
+  EFI_SERVICE_BINDING_PROTOCOL    *HttpSbProtocol;
+  EFI_IP4_CONFIG2_PROTOCOL        *Ip4Config2;
+  EFI_EVENT                       AddressEvent;         // Signaled by Ip4Config2 when the interface info changes
+  BOOLEAN                         DhcpRequested;
+  BOOLEAN                         AddressReady;
+  BOOLEAN                         Tried;
+} DFCI_NIC_CANDIDATE;
+
 /**
  * Dump the HTTP Headers
  *
@@ -368,6 +388,69 @@ EventWait (
   return Status;
 }
 
+/**
+ *  Get the IPv4 station address of a NIC
+ *
+ *  @param[in]  Ip4Config2      IPv4 Config2 protocol of the NIC
+ *  @param[out] StationAddress  Current station address. 0.0.0.0 if no address is assigned
+ *
+ *  @retval EFI_SUCCESS   StationAddress is valid
+ *  @retval Others        Unable to read the interface info
+ *
+ **/
+STATIC
+EFI_STATUS
+GetNicStationAddress (
+  IN  EFI_IP4_CONFIG2_PROTOCOL  *Ip4Config2,
+  OUT EFI_IPv4_ADDRESS          *StationAddress
+  )
+{
+  UINTN                           DataSize;
+  EFI_IP4_CONFIG2_INTERFACE_INFO  *Info;
+  EFI_STATUS                      Status;
+
+  ZeroMem (StationAddress, sizeof (EFI_IPv4_ADDRESS));
+
+  DataSize = 0;
+  Status   = Ip4Config2->GetData (
+                           Ip4Config2,
+                           Ip4Config2DataTypeInterfaceInfo,
+                           &DataSize,
+                           NULL
+                           );
+  if (EFI_BUFFER_TOO_SMALL != Status) {
+    DEBUG ((DEBUG_ERROR, "Error obtaining IP4 Interface Info size. Code=%r\n", Status));
+    return EFI_ERROR (Status) ? Status : EFI_DEVICE_ERROR;
+  }
+
+  Info = AllocatePool (DataSize);
+  if (NULL == Info) {
+    DEBUG ((DEBUG_ERROR, "Error allocating %d bytes for Info\n", DataSize));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = Ip4Config2->GetData (
+                         Ip4Config2,
+                         Ip4Config2DataTypeInterfaceInfo,
+                         &DataSize,
+                         Info
+                         );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Error obtaining IP4 Interface Info. Code=%r\n", Status));
+    DEBUG ((
+      DEBUG_ERROR,
+      " DataSize=%d, StructSize=%d\n",
+      DataSize,
+      sizeof (EFI_IP4_CONFIG2_INTERFACE_INFO)
+      ));
+  } else {
+    CopyMem (StationAddress, &Info->StationAddress, sizeof (EFI_IPv4_ADDRESS));
+  }
+
+  FreePool (Info);
+  return Status;
+}
+
 /**
  *  Timer Tick handler  - Update the list of devices
  *
@@ -385,11 +468,10 @@ TimerTick (
   IN VOID       *Context
   )
 {
-  UINTN                           DataSize;
-  EFI_IP4_CONFIG2_INTERFACE_INFO  *Info;
-  EFI_IP4_CONFIG2_PROTOCOL        *Ip4Config2;
-  DFCI_NETWORK_REQUEST            *NetworkRequest;
-  EFI_STATUS                      Status;
+  EFI_IP4_CONFIG2_PROTOCOL  *Ip4Config2;
+  DFCI_NETWORK_REQUEST      *NetworkRequest;
+  EFI_IPv4_ADDRESS          StationAddress;
+  EFI_STATUS                Status;
 
   NetworkRequest = (DFCI_NETWORK_REQUEST *)Context;
 
@@ -407,61 +489,27 @@ TimerTick (
     return;
   }
 
-  DataSize = 0;
-  Status   = Ip4Config2->GetData (
-                           Ip4Config2,
-                           Ip4Config2DataTypeInterfaceInfo,
-                           &DataSize,
-                           &Info
-                           );
-  if (EFI_BUFFER_TOO_SMALL != Status) {
-    DEBUG ((DEBUG_ERROR, "Error obtaining IP4 Interface Info size. Code=%r\n", Status));
-  } else {
-    Info = AllocatePool (DataSize);
-    if (NULL == Info) {
-      DEBUG ((DEBUG_ERROR, "Error allocating %d bytes for Info\n", DataSize));
-    } else {
-      Info->StationAddress.Addr[0] = 0;
-      Status                       = Ip4Config2->GetData (
-                                                   Ip4Config2,
-                                                   Ip4Config2DataTypeInterfaceInfo,
-                                                   &DataSize,
-                                                   Info
-                                                   );
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "Error obtaining IP4 Interface Info. Code=%r\n", Status));
-        DEBUG ((
-          DEBUG_ERROR,
-          " DataSize=%d, StructSize=%d\n",
-          DataSize,
-          sizeof (EFI_IP4_CONFIG2_INTERFACE_INFO)
-          ));
-      } else {
-        if (Info->StationAddress.Addr[0] != 0) {
-          if (NULL != NetworkRequest->HttpNic.WaitEvent) {
-            gBS->SignalEvent (NetworkRequest->HttpNic.WaitEvent);
-          }
-
-          DEBUG ((
-            DEBUG_INFO,
-            "DHCP Local Address is %d.%d.%d.%d.\n",
-            Info->StationAddress.Addr[0],
-            Info->StationAddress.Addr[1],
-            Info->StationAddress.Addr[2],
-            Info->StationAddress.Addr[3]
-            ));
-        }
-      }
-
-      FreePool (Info);
+  Status = GetNicStationAddress (Ip4Config2, &StationAddress);
+  if (!EFI_ERROR (Status) && (StationAddress.Addr[0] != 0)) {
+    if (NULL != NetworkRequest->HttpNic.WaitEvent) {
+      gBS->SignalEvent (NetworkRequest->HttpNic.WaitEvent);
     }
+
+    DEBUG ((
+      DEBUG_INFO,
+      "DHCP Local Address is %d.%d.%d.%d.\n",
+      StationAddress.Addr[0],
+      StationAddress.Addr[1],
+      StationAddress.Addr[2],
+      StationAddress.Addr[3]
+      ));
   }
 }
 
 /**
  * Unconfigure the NIC
  *
- * @param NetworkRequest  - Internal data
+ * @param NicHandle       - Handle of the NIC to return to a static, unassigned address
  *
  * @retval EFI_STATUS
  *
@@ -469,7 +517,7 @@ TimerTick (
 STATIC
 EFI_STATUS
 UnconfigureNIC (
-  IN DFCI_NETWORK_REQUEST  *NetworkRequest
+  IN EFI_HANDLE  NicHandle
   )
 {
   EFI_IP4_CONFIG2_PROTOCOL  *Ip4Config2;
@@ -477,7 +525,7 @@ UnconfigureNIC (
   EFI_STATUS                Status;
 
   Status = gBS->HandleProtocol (
-                  NetworkRequest->HttpNic.NicHandle,
+                  NicHandle,
                   &gEfiIp4Config2ProtocolGuid,
                   (VOID **)&Ip4Config2
                   );
@@ -566,7 +614,7 @@ ConfigureDHCP (
   }
 
   do {
-    Status = UnconfigureNIC (NetworkRequest);
+    Status = UnconfigureNIC (NetworkRequest->HttpNic.NicHandle);
 
     if (EFI_ERROR (Status)) {
       break;
@@ -663,10 +711,9 @@ ConfigureHTTP (
   IN DFCI_NETWORK_REQUEST  *NetworkRequest
   )
 {
-  EFI_IP4_CONFIG2_MANUAL_ADDRESS  Address;
-  UINTN                           DataSize;
-  EFI_IP4_CONFIG2_PROTOCOL        *Ip4Config2;
-  EFI_STATUS                      Status;
+  EFI_IP4_CONFIG2_PROTOCOL  *Ip4Config2;
+  EFI_IPv4_ADDRESS          StationAddress;
+  EFI_STATUS                Status;
 
   if (NULL == NetworkRequest) {
     return EFI_INVALID_PARAMETER;
@@ -700,14 +747,12 @@ ConfigureHTTP (
       return Status;
     }
 
-    DataSize = sizeof (EFI_IP4_CONFIG2_MANUAL_ADDRESS);
-    Status   = Ip4Config2->GetData (
-                             Ip4Config2,
-                             Ip4Config2DataTypeManualAddress,
-                             &DataSize,
-                             &Address
-                             );
-    if (EFI_ERROR (Status) || (Address.Address.Addr[0] == 0)) {
+    //
+    // Use the station address rather than the manual address so that a NIC that already
+    // obtained a DHCP address (for example while racing NICs) is not sent through DHCP again.
+    //
+    Status = GetNicStationAddress (Ip4Config2, &StationAddress);
+    if (EFI_ERROR (Status) || (StationAddress.Addr[0] == 0)) {
       DEBUG ((DEBUG_ERROR, "Configuring DHCP for DFCI. Code=%r\n", Status));
       Status = ConfigureDHCP (NetworkRequest);
     }
@@ -1129,6 +1174,71 @@ INITIALIZE_CLEANUP:
   return Status;
 }
 
+/**
+ * GetResponseDigest
+ *
+ * Decode the value of an RFC 3230 "Digest: SHA-256=<base64>" response header,
+ * if the server supplied one.
+ *
+ * @param[in]  NetworkRequest  - Response headers are in NetworkRequest->HttpResponse
+ * @param[out] ExpectedDigest  - The decoded SHA-256 digest of the body
+ * @param[out] HasDigest       - TRUE if the server supplied a SHA-256 digest
+ *
+ * @retval EFI_SUCCESS            - ExpectedDigest is valid if HasDigest is TRUE
+ * @retval EFI_SECURITY_VIOLATION - The SHA-256 digest in the header is malformed
+ *
+ **/
+STATIC
+EFI_STATUS
+GetResponseDigest (
+  IN  DFCI_NETWORK_REQUEST  *NetworkRequest,
+  OUT UINT8                 *ExpectedDigest,
+  OUT BOOLEAN               *HasDigest
+  )
+{
+  UINTN            DigestSize;
+  EFI_HTTP_HEADER  *Header;
+  CHAR8            *Value;
+  UINTN            ValueLength;
+  EFI_STATUS       Status;
+
+  *HasDigest = FALSE;
+
+  Header = HttpFindHeader (
+             NetworkRequest->HttpResponse.HeaderCount,
+             NetworkRequest->HttpResponse.Headers,
+             (CHAR8 *)&HEADER_DIGEST
+             );
+  if ((NULL == Header) || (NULL == Header->FieldValue)) {
+    return EFI_SUCCESS;
+  }
+
+  Value = AsciiStrStr (Header->FieldValue, DIGEST_SHA256_PREFIX);
+  if (NULL == Value) {
+    DEBUG ((DEBUG_INFO, "No SHA-256 in Digest header. Digest=%a\n", Header->FieldValue));
+    return EFI_SUCCESS;
+  }
+
+  //
+  // The digest value ends at the next algorithm in the list, if any.
+  //
+  Value      += AsciiStrLen (DIGEST_SHA256_PREFIX);
+  ValueLength = 0;
+  while ((Value[ValueLength] != '\0') && (Value[ValueLength] != ',')) {
+    ValueLength++;
+  }
+
+  DigestSize = SHA256_DIGEST_SIZE;
+  Status     = Base64Decode (Value, ValueLength, ExpectedDigest, &DigestSize);
+  if (EFI_ERROR (Status) || (DigestSize != SHA256_DIGEST_SIZE)) {
+    DEBUG ((DEBUG_ERROR, "Invalid SHA-256 Digest header. Code=%r, Size=%d\n", Status, DigestSize));
+    return EFI_SECURITY_VIOLATION;
+  }
+
+  *HasDigest = TRUE;
+  return EFI_SUCCESS;
+}
+
 STATIC
 EFI_STATUS
 ProcessHttpRequest (
@@ -1140,6 +1250,9 @@ ProcessHttpRequest (
   UINTN                   ContentLength;
   EFI_HTTP_HEADER         *ContentLengthHeader;
   UINTN                   CurrentLength;
+  UINT8                   Digest[SHA256_DIGEST_SIZE];
+  UINT8                   ExpectedDigest[SHA256_DIGEST_SIZE];
+  BOOLEAN                 HasDigest;
   CHAR8                   *Packet;
   EFI_HTTP_REQUEST_DATA   RequestData;
   EFI_HTTP_MESSAGE        RequestMessage;
@@ -1148,8 +1261,11 @@ ProcessHttpRequest (
   EFI_HTTP_MESSAGE        ResponseMessage;
   EFI_HTTP_TOKEN          ResponseToken;
   EFI_STATUS              Status;
+  VOID                    *HashContext;
 
   RequestData.Method = HttpMethod;
+  HashContext        = NULL;
+  Packet             = NULL;
 
   Status = DfciConvertToCHAR16 (Url, AsciiStrLen (Url), &RequestData.Url, NULL);
   if (EFI_ERROR (Status)) {
@@ -1224,13 +1340,38 @@ ProcessHttpRequest (
     goto S_EXIT1;
   }
 
-  Packet = AllocatePool (ContentLength + sizeof (CHAR8));   // Add 1 for a NULL
+  //
+  // Only hash the body when the server supplied a digest to check it against.
+  //
+  Status = GetResponseDigest (NetworkRequest, ExpectedDigest, &HasDigest);
+  if (EFI_ERROR (Status)) {
+    goto S_EXIT1;
+  }
+
+  if (HasDigest) {
+    HashContext = AllocatePool (Sha256GetContextSize ());
+    if ((NULL == HashContext) || !Sha256Init (HashContext)) {
+      DEBUG ((DEBUG_ERROR, "Unable to hash the response body\n"));
+      Status = EFI_SECURITY_VIOLATION;
+      goto S_EXIT1;
+    }
+  }
+
+  // Add 1 for a NULL
+  Packet = NULL;
+  if (ContentLength < MAX_UINTN) {
+    Packet = AllocatePool (ContentLength + sizeof (CHAR8));
+  }
+
   if (NULL == Packet) {
     DEBUG ((DEBUG_ERROR, "Unable to allocate return buffer\n"));
     Status = EFI_OUT_OF_RESOURCES;
     goto S_EXIT1;
   }
 
+  //
+  // Receive the body straight into the return buffer, hashing each piece as it arrives.
+  //
   CurrentLength = 0;
 
   while (CurrentLength < ContentLength) {
@@ -1239,18 +1380,54 @@ ProcessHttpRequest (
     Status                     = DfciGetResponse (NetworkRequest, &ResponseToken);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Error from additional response data. Code=%r\n", Status));
-      FreePool (Packet);
+      goto S_EXIT1;
+    }
+
+    if (0 == ResponseMessage.BodyLength) {
+      DEBUG ((DEBUG_ERROR, "Response ended after %d of %d bytes\n", CurrentLength, ContentLength));
+      Status = EFI_END_OF_FILE;
+      goto S_EXIT1;
+    }
+
+    if ((NULL != HashContext) && !Sha256Update (HashContext, &Packet[CurrentLength], ResponseMessage.BodyLength)) {
+      DEBUG ((DEBUG_ERROR, "Unable to hash the response body\n"));
+      Status = EFI_SECURITY_VIOLATION;
       goto S_EXIT1;
     }
 
     CurrentLength += ResponseMessage.BodyLength;
   }
 
+  if (NULL != HashContext) {
+    if (!Sha256Final (HashContext, Digest)) {
+      DEBUG ((DEBUG_ERROR, "Unable to finalize body digest\n"));
+      Status = EFI_SECURITY_VIOLATION;
+      goto S_EXIT1;
+    }
+
+    if (CompareMem (Digest, ExpectedDigest, SHA256_DIGEST_SIZE) != 0) {
+      DEBUG ((DEBUG_ERROR, "Response body does not match the Digest header\n"));
+      Status = EFI_SECURITY_VIOLATION;
+      goto S_EXIT1;
+    }
+
+    DEBUG ((DEBUG_INFO, "Response body digest verified\n"));
+  }
+
   Packet[ContentLength]                 = '\0'; // Add terminating NULL
   NetworkRequest->HttpResponse.Body     = Packet;
   NetworkRequest->HttpResponse.BodySize = ContentLength + sizeof (CHAR8);
+  Packet                                = NULL;
 
 S_EXIT1:
+  if (NULL != HashContext) {
+    FreePool (HashContext);
+  }
+
+  if (NULL != Packet) {
+    FreePool (Packet);
+  }
+
   FreePool (RequestData.Url);
   HttpFreeHeaderFields (RequestMessage.Headers, RequestMessage.HeaderCount);
   return Status;
@@ -1349,52 +1526,195 @@ ProcessHttpRequestInternal (
   return Status;
 }
 
+/**
+ * Close the HTTP session on the current NIC
+ *
+ * @param[in]  NetworkRequest
+ *
+ * Closes the connection and destroys the HTTP child created by OpenHttpSession.
+ * Safe to call when no session is open.
+ *
+ **/
+STATIC
+VOID
+CloseHttpSession (
+  IN  DFCI_NETWORK_REQUEST  *NetworkRequest
+  )
+{
+  EFI_STATUS  Status;
+
+  if (NULL != NetworkRequest->Http.HttpProtocol) {
+    Status = NetworkRequest->Http.HttpProtocol->Configure (NetworkRequest->Http.HttpProtocol, NULL);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Unable to cleanup HTTP Protocol. Code=%r\n", Status));
+    }
+  }
+
+  if ((NULL != NetworkRequest->HttpNic.HttpSbProtocol) &&
+      (NULL != NetworkRequest->Http.HttpChildHandle))
+  {
+    Status = NetworkRequest->HttpNic.HttpSbProtocol->DestroyChild (
+                                                       NetworkRequest->HttpNic.HttpSbProtocol,
+                                                       NetworkRequest->Http.HttpChildHandle
+                                                       );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Error destroying worker child. Code=%r\n", Status));
+    }
+  }
+
+  CleanupNetworkRequest (NetworkRequest, CLEANUP_HTTP);
+}
+
+/**
+ * Open the HTTP session on the current NIC
+ *
+ * @param[in]  NetworkRequest
+ *
+ * Creates and configures the HTTP child that is used for every request issued on
+ * the current NIC.  The HTTP driver keeps the TCP connection, and the TLS session
+ * on top of it, open between requests to the same host, so requests issued on the
+ * same session do not pay for a new connection and TLS handshake.
+ *
+ * @return EFI_STATUS
+ **/
 STATIC
 EFI_STATUS
-ProcessHttpRequestWithRetries (
-  IN  DFCI_NETWORK_REQUEST  *NetworkRequest,
-  IN  EFI_HTTP_METHOD       HttpMethod,
-  IN  CHAR8                 *Url,
-  IN  BOOLEAN               RetryOn202
+OpenHttpSession (
+  IN  DFCI_NETWORK_REQUEST  *NetworkRequest
   )
 {
   EFI_STATUS  Status;
-  EFI_STATUS  Status2;
 
   NetworkRequest->Http.ConfigData.LocalAddressIsIPv6 = FALSE;
   NetworkRequest->Http.HttpChildHandle               = gImageHandle; // Place HttpChild on our image handle
+  NetworkRequest->Http.RequestCount                  = 0;
   Status                                             = ConfigureHTTP (NetworkRequest);
   if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Unable to open HTTP session. Code=%r\n", Status));
+    if (NULL != NetworkRequest->Http.HttpProtocol) {
+      CloseHttpSession (NetworkRequest);
+    } else {
+      CleanupNetworkRequest (NetworkRequest, CLEANUP_HTTP);
+    }
+  }
+
+  return Status;
+}
+
+/**
+ * Check if a failed request indicates the server dropped a reused connection
+ *
+ * @param[in]  Status  - Status of the failed request
+ *
+ * @return TRUE if the request should be retried on a fresh connection
+ **/
+STATIC
+BOOLEAN
+IsConnectionDropped (
+  IN  EFI_STATUS  Status
+  )
+{
+  return (BOOLEAN)((EFI_CONNECTION_FIN == Status) ||
+                   (EFI_CONNECTION_RESET == Status));
+}
+
+/**
+ * ProcessHttpRequestWithRetries
+ *
+ * Issue an Http request on the current HTTP session, opening the session if needed.
+ *
+ * @param  [in]    NetworkRequest
+ * @param  [in]    HttpMethod
+ * @param  [in]    Url
+ * &param  [in]    RetryOn202
+ *
+ * If the request fails because the server closed a connection that was kept open
+ * from an earlier request, the request is retried once on a new connection.  The
+ * session is left open for the next request.  It is closed by the caller once all
+ * of the requests on this NIC are complete, or here if the server asks for the
+ * connection to be closed.
+ *
+ * Url may point into the headers of the previous response, which are freed before
+ * the request is sent again, so the request is issued with a copy of Url.
+ *
+ * return  EFI_STATUS
+ **/
+STATIC
+EFI_STATUS
+ProcessHttpRequestWithRetries (
+  IN  DFCI_NETWORK_REQUEST  *NetworkRequest,
+  IN  EFI_HTTP_METHOD       HttpMethod,
+  IN  CHAR8                 *Url,
+  IN  BOOLEAN               RetryOn202
+  )
+{
+  EFI_HTTP_HEADER  *Header;
+  CHAR8            *RequestUrl;
+  BOOLEAN          Reused;
+  EFI_STATUS       Status;
+
+  RequestUrl = AllocateCopyPool (AsciiStrSize (Url), Url);
+  if (NULL == RequestUrl) {
+    Status = EFI_OUT_OF_RESOURCES;
     goto EARLY_EXIT;
   }
 
+  if (NULL == NetworkRequest->Http.HttpProtocol) {
+    Status = OpenHttpSession (NetworkRequest);
+    if (EFI_ERROR (Status)) {
+      goto EARLY_EXIT;
+    }
+  }
+
+  Reused = (BOOLEAN)(NetworkRequest->Http.RequestCount > 0);
+  NetworkRequest->Http.RequestCount++;
+
   Status = ProcessHttpRequestInternal (
              NetworkRequest,
              HttpMethod,
-             Url,
+             RequestUrl,
              RetryOn202
              );
-  //
-  // Don't let success or fail of cleanup from disturbing the return status.
-  //
-  if (NULL != NetworkRequest->Http.HttpProtocol) {
-    Status2 = NetworkRequest->Http.HttpProtocol->Configure (NetworkRequest->Http.HttpProtocol, NULL);
-    if (EFI_ERROR (Status2)) {
-      DEBUG ((DEBUG_ERROR, "Unable to cleanup HTTP Protocol. Code=%r\n", Status2));
+
+  if (EFI_ERROR (Status) && Reused && IsConnectionDropped (Status)) {
+    DEBUG ((DEBUG_INFO, "Connection dropped by server (%r). Retrying on a new connection\n", Status));
+    CloseHttpSession (NetworkRequest);
+    CleanupNetworkRequest (NetworkRequest, CLEANUP_RESPONSE);
+
+    Status = OpenHttpSession (NetworkRequest);
+    if (EFI_ERROR (Status)) {
+      goto EARLY_EXIT;
     }
-  }
 
-  Status2 = NetworkRequest->HttpNic.HttpSbProtocol->DestroyChild (
-                                                      NetworkRequest->HttpNic.HttpSbProtocol,
-                                                      NetworkRequest->Http.HttpChildHandle
-                                                      );
-  if (EFI_ERROR (Status2)) {
-    DEBUG ((DEBUG_ERROR, "Error destroying worker child. Code=%r\n", Status2));
+    NetworkRequest->Http.RequestCount++;
+    Status = ProcessHttpRequestInternal (
+               NetworkRequest,
+               HttpMethod,
+               RequestUrl,
+               RetryOn202
+               );
   }
 
-  CleanupNetworkRequest (NetworkRequest, CLEANUP_HTTP);
+  //
+  // Don't keep a connection the server is going to close, or one that is in an unknown state.
+  //
+  Header = HttpFindHeader (
+             NetworkRequest->HttpResponse.HeaderCount,
+             NetworkRequest->HttpResponse.Headers,
+             (CHAR8 *)&HEADER_CONNECTION
+             );
+  if (EFI_ERROR (Status) ||
+      ((NULL != Header) && (NULL != Header->FieldValue) &&
+       (0 == AsciiStriCmp (Header->FieldValue, HEADER_CONNECTION_CLOSE))))
+  {
+    CloseHttpSession (NetworkRequest);
+  }
 
 EARLY_EXIT:
+  if (NULL != RequestUrl) {
+    FreePool (RequestUrl);
+  }
+
   return Status;
 }
 
@@ -1687,11 +2007,150 @@ MAIN_CLEANUP:
   return Status;
 }
 
+/**
+ * Start obtaining an address on a NIC
+ *
+ * @param[in,out]  Candidate  - NIC to start.  NicHandle must be set.
+ *
+ * If the NIC already has a station address it is marked ready.  Otherwise, the
+ * NIC is set to DHCP and Candidate->AddressEvent is registered to be signaled
+ * when the interface info changes.  DHCP then runs in the background while the
+ * other NICs are started.
+ *
+ * @return EFI_STATUS
+ **/
+STATIC
+EFI_STATUS
+StartNicCandidate (
+  IN OUT DFCI_NIC_CANDIDATE  *Candidate
+  )
+{
+  EFI_IP4_CONFIG2_POLICY  Policy;
+  EFI_IPv4_ADDRESS        StationAddress;
+  EFI_STATUS              Status;
+
+  Status = gBS->HandleProtocol (
+                  Candidate->NicHandle,
+                  &gEfiIp4Config2ProtocolGuid,
+                  (VOID **)&Candidate->Ip4Config2
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Error locating IPv4 Config2 protocol. Code=%r\n", Status));
+    Candidate->Ip4Config2 = NULL;
+    return Status;
+  }
+
+  Status = GetNicStationAddress (Candidate->Ip4Config2, &StationAddress);
+  if (!EFI_ERROR (Status) && (StationAddress.Addr[0] != 0)) {
+    Candidate->AddressReady = TRUE;
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->CreateEvent (0, 0, NULL, NULL, &Candidate->AddressEvent);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Unable to create address event. Code=%r\n", Status));
+    Candidate->AddressEvent = NULL;
+    goto START_ERROR;
+  }
+
+  Status = Candidate->Ip4Config2->RegisterDataNotify (
+                                    Candidate->Ip4Config2,
+                                    Ip4Config2DataTypeInterfaceInfo,
+                                    Candidate->AddressEvent
+                                    );
+  if (EFI_ERROR (Status)) {
+    //
+    // Not fatal.  The periodic tick in the race loop will still notice the address.
+    //
+    DEBUG ((DEBUG_INFO, "Unable to register for interface info changes. Code=%r\n", Status));
+    gBS->CloseEvent (Candidate->AddressEvent);
+    Candidate->AddressEvent = NULL;
+  }
+
+  Status = UnconfigureNIC (Candidate->NicHandle);
+  if (EFI_ERROR (Status)) {
+    goto START_ERROR;
+  }
+
+  //
+  // Set policy to DHCP - this should start a DHCP DORA
+  //
+  Policy = Ip4Config2PolicyDhcp;
+  Status = Candidate->Ip4Config2->SetData (
+                                    Candidate->Ip4Config2,
+                                    Ip4Config2DataTypePolicy,
+                                    sizeof (EFI_IP4_CONFIG2_POLICY),
+                                    &Policy
+                                    );
+  Candidate->DhcpRequested = TRUE;        // Remember to set back to STATIC
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Unable to set DHCP address. Code=%r\n", Status));
+    goto START_ERROR;
+  }
+
+  return EFI_SUCCESS;
+
+START_ERROR:
+  if (NULL != Candidate->AddressEvent) {
+    Candidate->Ip4Config2->UnregisterDataNotify (
+                             Candidate->Ip4Config2,
+                             Ip4Config2DataTypeInterfaceInfo,
+                             Candidate->AddressEvent
+                             );
+    gBS->CloseEvent (Candidate->AddressEvent);
+    Candidate->AddressEvent = NULL;
+  }
+
+  Candidate->Ip4Config2 = NULL;       // Exclude from the race
+  return Status;
+}
+
+/**
+ * Stop a NIC that was started by StartNicCandidate
+ *
+ * @param[in,out]  Candidate
+ *
+ **/
+STATIC
+VOID
+StopNicCandidate (
+  IN OUT DFCI_NIC_CANDIDATE  *Candidate
+  )
+{
+  if ((NULL != Candidate->AddressEvent) && (NULL != Candidate->Ip4Config2)) {
+    Candidate->Ip4Config2->UnregisterDataNotify (
+                             Candidate->Ip4Config2,
+                             Ip4Config2DataTypeInterfaceInfo,
+                             Candidate->AddressEvent
+                             );
+    gBS->CloseEvent (Candidate->AddressEvent);
+  }
+
+  Candidate->AddressEvent = NULL;
+
+  if (Candidate->DhcpRequested) {
+    UnconfigureNIC (Candidate->NicHandle);
+    Candidate->DhcpRequested = FALSE;
+  }
+}
+
 /**
  * TryEachNICThenProcessRequest
  *
  * @param[in]   NetworkRequest
  *
+ * DHCP is started on every NIC with media present at the same time, and the NICs
+ * are then raced from a single loop.  The first NIC to obtain an address runs
+ * MainLogic.  If that NIC cannot complete the request (no route to the server,
+ * TLS handshake failure, etc.), the next NIC that has obtained an address in the
+ * meantime is tried without waiting.  Once a NIC completes the request, or the
+ * DHCP timeout expires, all NICs are torn down.
+ *
+ * The worst case wait for an address is a single DHCP_TIMEOUT rather than one
+ * DHCP_TIMEOUT per NIC.  While no NIC is ready, the loop blocks in WaitForEvent
+ * until the timeout, the periodic recheck, or an interface info change of a
+ * pending NIC.
+ *
  * Returns      EFI_STATUS
  *
  **/
@@ -1701,13 +2160,28 @@ TryEachNICThenProcessRequest (
   DFCI_NETWORK_REQUEST  *NetworkRequest
   )
 {
+  UINTN                             Attempts;
   EFI_BOOT_MANAGER_POLICY_PROTOCOL  *BootPolicy;
+  DFCI_NIC_CANDIDATE                *Candidate;
+  DFCI_NIC_CANDIDATE                *Candidates;
+  EFI_EVENT                         DeadlineEvent;
   BOOLEAN                           DoneProcessing;
   EFI_HANDLE                        *HandleBuffer;
   UINTN                             HandleCount;
   BOOLEAN                           MediaPresent;
   UINTN                             NicIndex;
+  BOOLEAN                           Pending;
+  EFI_IPv4_ADDRESS                  StationAddress;
   EFI_STATUS                        Status;
+  EFI_EVENT                         TickEvent;
+  BOOLEAN                           Tick;
+  DFCI_NIC_CANDIDATE                *Signaled;
+  UINTN                             WaitCount;
+  EFI_EVENT                         *WaitEvents;
+  UINTN                             WaitIndex;
+  DFCI_NIC_CANDIDATE                **WaitNics;
+  EFI_STATUS                        WaitStatus;
+  DFCI_NIC_CANDIDATE                *Winner;
 
   Status = gBS->LocateProtocol (
                   &gEfiBootManagerPolicyProtocolGuid,
@@ -1725,12 +2199,16 @@ TryEachNICThenProcessRequest (
     }
   }
 
-  //
-  // Try each connected NIC until a successful settings transfer.
-  //
-
   DoneProcessing = FALSE;
   HandleBuffer   = NULL;
+  HandleCount    = 0;
+  Candidates     = NULL;
+  WaitEvents     = NULL;
+  WaitNics       = NULL;
+  DeadlineEvent  = NULL;
+  TickEvent      = NULL;
+  Attempts       = 0;
+
   //
   // Find NICs with HTTP ServiceBinding protocol.  These are the available HTTP devices.
   //
@@ -1747,20 +2225,51 @@ TryEachNICThenProcessRequest (
     goto CLEANUP;
   }
 
-  for (NicIndex = 0; (NicIndex < HandleCount) && !DoneProcessing; NicIndex++) {
+  //
+  // The wait list holds the deadline, the tick, and the address event of each NIC.
+  //
+  Candidates = AllocateZeroPool (HandleCount * sizeof (DFCI_NIC_CANDIDATE));
+  WaitEvents = AllocateZeroPool ((HandleCount + 2) * sizeof (EFI_EVENT));
+  WaitNics   = AllocateZeroPool ((HandleCount + 2) * sizeof (DFCI_NIC_CANDIDATE *));
+  if ((NULL == Candidates) || (NULL == WaitEvents) || (NULL == WaitNics)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto CLEANUP;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER, 0, NULL, NULL, &DeadlineEvent);
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->SetTimer (DeadlineEvent, TimerRelative, DHCP_TIMEOUT);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->CreateEvent (EVT_TIMER, 0, NULL, NULL, &TickEvent);
+  }
+
+  if (!EFI_ERROR (Status)) {
     //
-    // Clear the working section of DFCI_NETWORK_REQUEST
+    // Recheck every pending NIC once a second in case the interface info notify is missed
     //
-    DEBUG ((DEBUG_INFO, "Attempting NicIndex=%d\n", NicIndex));
+    Status = gBS->SetTimer (TickEvent, TimerPeriodic, TIMER_PERIOD_1s);
+  }
 
-    CleanupNetworkRequest (NetworkRequest, CLEANUP_NIC);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Unable to create NIC race timers. Code=%r\n", Status));
+    goto CLEANUP;
+  }
 
-    NetworkRequest->HttpNic.NicHandle = HandleBuffer[NicIndex];
+  //
+  // Start every NIC that has media present.
+  //
+  for (NicIndex = 0; NicIndex < HandleCount; NicIndex++) {
+    DEBUG ((DEBUG_INFO, "Starting NicIndex=%d\n", NicIndex));
+
+    Candidate            = &Candidates[NicIndex];
+    Candidate->NicHandle = HandleBuffer[NicIndex];
 
     Status = gBS->HandleProtocol (
-                    NetworkRequest->HttpNic.NicHandle,
+                    Candidate->NicHandle,
                     &gEfiHttpServiceBindingProtocolGuid,
-                    (VOID **)&NetworkRequest->HttpNic.HttpSbProtocol
+                    (VOID **)&Candidate->HttpSbProtocol
                     );
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Error locating HttpServiceBinding protocol. Code=%r\n", Status));
@@ -1770,30 +2279,175 @@ TryEachNICThenProcessRequest (
     // Verify Media is present before doing any work.  We don't really care about the error cases.  On
     // error cases, assume Media is Present.
     MediaPresent = TRUE;
-    Status       = NetLibDetectMedia (NetworkRequest->HttpNic.NicHandle, &MediaPresent);
+    Status       = NetLibDetectMedia (Candidate->NicHandle, &MediaPresent);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_INFO, "NetLibDetectMedi returned %r. Assuming Media Present\n", Status));
     }
 
     if (!MediaPresent) {
-      Status = EFI_NO_MEDIA;
       continue;
     }
 
+    Status = StartNicCandidate (Candidate);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Unable to start NicIndex=%d. Code=%r\n", NicIndex, Status));
+    }
+  }
+
+  //
+  // Race the NICs.  Any NIC that has an address and has not been tried yet gets to run
+  // MainLogic.  Stop when a NIC completes the request, when no NIC is left that could
+  // still obtain an address, or when the DHCP timeout expires.
+  //
+  Status   = EFI_NO_MEDIA;
+  Tick     = FALSE;
+  Signaled = NULL;
+  while (!DoneProcessing) {
+    Pending = FALSE;
+    Winner  = NULL;
+
+    for (NicIndex = 0; NicIndex < HandleCount; NicIndex++) {
+      Candidate = &Candidates[NicIndex];
+      if ((NULL == Candidate->Ip4Config2) || Candidate->Tried) {
+        continue;
+      }
+
+      if (!Candidate->AddressReady) {
+        if (Tick || (Candidate == Signaled)) {
+          Status = GetNicStationAddress (Candidate->Ip4Config2, &StationAddress);
+          if (!EFI_ERROR (Status) && (StationAddress.Addr[0] != 0)) {
+            Candidate->AddressReady = TRUE;
+            DEBUG ((
+              DEBUG_INFO,
+              "NicIndex=%d obtained address %d.%d.%d.%d.\n",
+              NicIndex,
+              StationAddress.Addr[0],
+              StationAddress.Addr[1],
+              StationAddress.Addr[2],
+              StationAddress.Addr[3]
+              ));
+          }
+        }
+      }
+
+      if (Candidate->AddressReady) {
+        if (NULL == Winner) {
+          Winner = Candidate;
+        }
+      } else {
+        Pending = TRUE;
+      }
+    }
+
+    Tick     = FALSE;
+    Signaled = NULL;
+
+    if (NULL != Winner) {
+      Winner->Tried = TRUE;
+      Attempts++;
+
+      DEBUG ((DEBUG_INFO, "Attempting NicIndex=%d\n", Winner - Candidates));
+
+      //
+      // Clear the working section of DFCI_NETWORK_REQUEST
+      //
+      CleanupNetworkRequest (NetworkRequest, CLEANUP_NIC);
+      NetworkRequest->HttpNic.NicHandle      = Winner->NicHandle;
+      NetworkRequest->HttpNic.HttpSbProtocol = Winner->HttpSbProtocol;
+
+      //
+      // Process HTTP Recovery flow on this NIC. If it fails, move on to the next NIC with an address
+      //
+      Status = NetworkRequest->MainLogic (NetworkRequest, &DoneProcessing);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_INFO, "MainLogic error. Code=%r\n", Status));
+      }
+
+      //
+      // The HTTP session is kept open across all of the requests MainLogic issues on this NIC.
+      //
+      CloseHttpSession (NetworkRequest);
+
+      if (NetworkRequest->HttpNic.DhcpRequested) {
+        Winner->DhcpRequested = TRUE;
+      }
+
+      continue;
+    }
+
+    if (!Pending) {
+      break;
+    }
+
     //
-    // Process HTTP Recovery flow on this NIC. If it fails, check the next NIC
+    // Wait for the deadline, the tick, or an interface info change of a pending NIC.
     //
-    Status = NetworkRequest->MainLogic (NetworkRequest, &DoneProcessing);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_INFO, "MainLogic error. Code=%r\n", Status));
+    WaitCount               = 0;
+    WaitEvents[WaitCount++] = DeadlineEvent;
+    WaitEvents[WaitCount++] = TickEvent;
+    for (NicIndex = 0; NicIndex < HandleCount; NicIndex++) {
+      Candidate = &Candidates[NicIndex];
+      if ((NULL != Candidate->Ip4Config2) && !Candidate->Tried &&
+          !Candidate->AddressReady && (NULL != Candidate->AddressEvent))
+      {
+        WaitNics[WaitCount]     = Candidate;
+        WaitEvents[WaitCount++] = Candidate->AddressEvent;
+      }
     }
 
-    if (NetworkRequest->HttpNic.DhcpRequested) {
-      UnconfigureNIC (NetworkRequest);
+    WaitStatus = gBS->WaitForEvent (WaitCount, WaitEvents, &WaitIndex);
+    if (EFI_ERROR (WaitStatus)) {
+      DEBUG ((DEBUG_ERROR, "Unable to wait for a NIC to obtain an address. Code=%r\n", WaitStatus));
+      Status = WaitStatus;
+      break;
+    }
+
+    if (0 == WaitIndex) {
+      DEBUG ((DEBUG_ERROR, "Timed out waiting for a NIC to obtain an address\n"));
+      if (0 == Attempts) {
+        Status = EFI_TIMEOUT;
+      }
+
+      break;
+    }
+
+    if (1 == WaitIndex) {
+      Tick = TRUE;
+    } else {
+      Signaled = WaitNics[WaitIndex];
     }
   }
 
 CLEANUP:
+  if (NULL != Candidates) {
+    //
+    // Tear down every NIC, including the one that completed the request.
+    //
+    for (NicIndex = 0; NicIndex < HandleCount; NicIndex++) {
+      StopNicCandidate (&Candidates[NicIndex]);
+    }
+
+    FreePool (Candidates);
+  }
+
+  if (NULL != WaitEvents) {
+    FreePool (WaitEvents);
+  }
+
+  if (NULL != WaitNics) {
+    FreePool (WaitNics);
+  }
+
+  if (NULL != TickEvent) {
+    gBS->SetTimer (TickEvent, TimerCancel, 0);
+    gBS->CloseEvent (TickEvent);
+  }
+
+  if (NULL != DeadlineEvent) {
+    gBS->SetTimer (DeadlineEvent, TimerCancel, 0);
+    gBS->CloseEvent (DeadlineEvent);
+  }
+
   if (NULL != HandleBuffer) {
     FreePool (HandleBuffer);
   }
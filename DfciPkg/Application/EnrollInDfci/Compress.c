@@ -16,6 +16,8 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 
+#include "Compress.h"
+
 //
 // Macro Definitions
 //
@@ -50,6 +52,17 @@ typedef INT16 NODE;
 #else
 #define                 NPT  NP
 #endif
+
+//
+// Fast mode hash chains.  Heads are indexed by a hash of the next THRESHOLD
+// bytes, each position links to the previous one with the same hash.
+//
+#define FAST_HASH_BIT   15
+#define FAST_HASH_SIZE  (1U << FAST_HASH_BIT)
+#define FAST_NIL        MAX_UINT32
+#define FAST_HASH(Ptr) \
+  (((((UINT32)(Ptr)[0] << 16) | ((UINT32)(Ptr)[1] << 8) | (Ptr)[2]) * 2654435761U) >> (32 - FAST_HASH_BIT))
+
 //
 // Function Prototypes
 //
@@ -114,6 +127,9 @@ STATIC NODE  *mPrev;
 STATIC NODE  *mNext        = NULL;
 INT32        mHuffmanDepth = 0;
 
+STATIC UINT32  *mHashHead;
+STATIC UINT32  *mHashPrev;
+
 /**
   Make a CRC table.
 
@@ -171,24 +187,17 @@ PutDword (
 }
 
 /**
-  Allocate memory spaces for data structures used in compression process.
+  Allocate the buffer that collects one block of characters and pointers
+  before it is Huffman coded.
 
   @retval EFI_SUCCESS           Memory was allocated successfully.
   @retval EFI_OUT_OF_RESOURCES  A memory allocation failed.
 **/
 EFI_STATUS
-AllocateMemory (
+AllocateBlockBuffer (
   VOID
   )
 {
-  mText       = AllocateZeroPool (WNDSIZ * 2 + MAXMATCH);
-  mLevel      = AllocateZeroPool ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mLevel));
-  mChildCount = AllocateZeroPool ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mChildCount));
-  mPosition   = AllocateZeroPool ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mPosition));
-  mParent     = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mParent));
-  mPrev       = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mPrev));
-  mNext       = AllocateZeroPool ((MAX_HASH_VAL + 1) * sizeof (*mNext));
-
   mBufSiz = BLKSIZ;
   mBuf    = AllocateZeroPool (mBufSiz);
   while (mBuf == NULL) {
@@ -205,6 +214,28 @@ AllocateMemory (
   return EFI_SUCCESS;
 }
 
+/**
+  Allocate memory spaces for data structures used in compression process.
+
+  @retval EFI_SUCCESS           Memory was allocated successfully.
+  @retval EFI_OUT_OF_RESOURCES  A memory allocation failed.
+**/
+EFI_STATUS
+AllocateMemory (
+  VOID
+  )
+{
+  mText       = AllocateZeroPool (WNDSIZ * 2 + MAXMATCH);
+  mLevel      = AllocateZeroPool ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mLevel));
+  mChildCount = AllocateZeroPool ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mChildCount));
+  mPosition   = AllocateZeroPool ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mPosition));
+  mParent     = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mParent));
+  mPrev       = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mPrev));
+  mNext       = AllocateZeroPool ((MAX_HASH_VAL + 1) * sizeof (*mNext));
+
+  return AllocateBlockBuffer ();
+}
+
 /**
   Called when compression is completed to free memory previously allocated.
 
@@ -245,6 +276,14 @@ FreeMemory (
   if (NULL != mBuf) {
     FreePool (mBuf);
   }
+
+  if (NULL != mHashHead) {
+    FreePool (mHashHead);
+  }
+
+  if (NULL != mHashPrev) {
+    FreePool (mHashPrev);
+  }
 }
 
 /**
@@ -870,6 +909,8 @@ MakeTree (
 /**
   Outputs rightmost LoopVar8 bits of x
 
+  Bits collect in mSubBitBuf and are written out a whole byte at a time.
+
   @param[in] LoopVar8   The rightmost LoopVar8 bits of the data is used.
   @param[in] x   The data.
 **/
@@ -879,30 +920,16 @@ PutBits (
   IN UINT32  x
   )
 {
-  UINT8  Temp;
+  mSubBitBuf = (mSubBitBuf << LoopVar8) | (x & ((1U << LoopVar8) - 1));
+  mBitCount += LoopVar8;
 
-  if (LoopVar8 < mBitCount) {
-    mSubBitBuf |= x << (mBitCount -= LoopVar8);
-  } else {
-    Temp = (UINT8)(mSubBitBuf | (x >> (LoopVar8 -= mBitCount)));
+  while (mBitCount >= UINT8_BIT) {
+    mBitCount -= UINT8_BIT;
     if (mDst < mDstUpperLimit) {
-      *mDst++ = Temp;
+      *mDst++ = (UINT8)(mSubBitBuf >> mBitCount);
     }
 
     mCompSize++;
-
-    if (LoopVar8 < UINT8_BIT) {
-      mSubBitBuf = x << (mBitCount = UINT8_BIT - LoopVar8);
-    } else {
-      Temp = (UINT8)(x >> (LoopVar8 - UINT8_BIT));
-      if (mDst < mDstUpperLimit) {
-        *mDst++ = Temp;
-      }
-
-      mCompSize++;
-
-      mSubBitBuf = x << (mBitCount = 2 * UINT8_BIT - LoopVar8);
-    }
   }
 }
 
@@ -1185,7 +1212,7 @@ HufEncodeStart (
 
   mOutputPos = mOutputMask = 0;
 
-  mBitCount  = UINT8_BIT;
+  mBitCount  = 0;
   mSubBitBuf = 0;
 }
 
@@ -1329,23 +1356,218 @@ Encode (
 }
 
 /**
-  The compression routine.
+  Add the positions from *Indexed up to, but not including, Pos to the hash chains.
+
+  @param[in]      Size     The number of bytes in mSrc.
+  @param[in, out] Indexed  The first position not yet in the hash chains.
+  @param[in]      Pos      The position to index up to.
+**/
+VOID
+FastIndex (
+  IN     UINT32  Size,
+  IN OUT UINT32  *Indexed,
+  IN     UINT32  Pos
+  )
+{
+  UINT32  Hash;
+
+  for ( ; (*Indexed < Pos) && (*Indexed + THRESHOLD <= Size); (*Indexed)++) {
+    Hash                               = FAST_HASH (&mSrc[*Indexed]);
+    mHashPrev[*Indexed & (WNDSIZ - 1)] = mHashHead[Hash];
+    mHashHead[Hash]                    = *Indexed;
+  }
+
+  if (*Indexed < Pos) {
+    *Indexed = Pos;
+  }
+}
+
+/**
+  Find the longest earlier string that matches the data at Pos by following
+  its hash chain.  Every position before Pos must already be indexed.
+
+  @param[in]  Size        The number of bytes in mSrc.
+  @param[in]  Pos         The position to find a match for.
+  @param[in]  ChainDepth  The maximum number of earlier positions to compare.
+  @param[out] MatchDist   The distance back to the match.
+
+  @return The length of the match, or 0 if there is no match of at least THRESHOLD bytes.
+**/
+UINT32
+FastFindMatch (
+  IN  UINT32  Size,
+  IN  UINT32  Pos,
+  IN  UINT32  ChainDepth,
+  OUT UINT32  *MatchDist
+  )
+{
+  UINT8   *Cur;
+  UINT8   *Match;
+  UINT32  Candidate;
+  UINT32  Next;
+  UINT32  MaxLen;
+  UINT32  BestLen;
+  UINT32  Len;
+
+  MaxLen = MIN (MAXMATCH, Size - Pos);
+  if (MaxLen < THRESHOLD) {
+    return 0;
+  }
+
+  Cur       = &mSrc[Pos];
+  BestLen   = THRESHOLD - 1;
+  Candidate = mHashHead[FAST_HASH (Cur)];
+
+  while ((Candidate != FAST_NIL) && (Pos - Candidate <= WNDSIZ) && (ChainDepth-- > 0)) {
+    Match = &mSrc[Candidate];
+
+    //
+    // Only a candidate that also matches the byte after the best so far can improve on it
+    //
+    if ((Match[BestLen] == Cur[BestLen]) && (Match[0] == Cur[0])) {
+      for (Len = 1; (Len < MaxLen) && (Match[Len] == Cur[Len]); Len++) {
+      }
+
+      if (Len > BestLen) {
+        BestLen    = Len;
+        *MatchDist = Pos - Candidate;
+        if (Len == MaxLen) {
+          break;
+        }
+      }
+    }
+
+    Next = mHashPrev[Candidate & (WNDSIZ - 1)];
+    if (Next >= Candidate) {
+      break;
+    }
+
+    Candidate = Next;
+  }
+
+  return (BestLen >= THRESHOLD) ? BestLen : 0;
+}
+
+/**
+  The main controlling routine for the fast compression process.
+
+  Matches are found through hash chains over the whole source buffer
+  rather than the tree maintained by InsertNode and DeleteNode.  The
+  window, match lengths and block format are unchanged, so the output
+  is decoded by the standard EFI decompressor.
+
+  @param[in] Options  The chain depth and effort level to use.
+
+  @retval EFI_SUCCESS           The compression is successful.
+  @retval EFI_OUT_0F_RESOURCES  Not enough memory for compression process.
+**/
+EFI_STATUS
+EncodeFast (
+  IN CONST COMPRESS_FAST_OPTIONS  *Options
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Size;
+  UINT32      Pos;
+  UINT32      Indexed;
+  UINT32      MatchLen;
+  UINT32      MatchDist;
+  UINT32      NextLen;
+  UINT32      NextDist;
+  BOOLEAN     HaveNext;
+
+  Size      = (UINT32)(mSrcUpperLimit - mSrc);
+  mOrigSize = Size;
+
+  mHashHead = AllocatePool (FAST_HASH_SIZE * sizeof (*mHashHead));
+  mHashPrev = AllocatePool (WNDSIZ * sizeof (*mHashPrev));
+  Status    = AllocateBlockBuffer ();
+  if ((mHashHead == NULL) || (mHashPrev == NULL) || EFI_ERROR (Status)) {
+    FreeMemory ();
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SetMem32 (mHashHead, FAST_HASH_SIZE * sizeof (*mHashHead), FAST_NIL);
+
+  HufEncodeStart ();
+
+  Pos       = 0;
+  Indexed   = 0;
+  MatchDist = 0;
+  NextLen   = 0;
+  NextDist  = 0;
+  HaveNext  = FALSE;
+
+  while (Pos < Size) {
+    if (HaveNext) {
+      MatchLen  = NextLen;
+      MatchDist = NextDist;
+      HaveNext  = FALSE;
+    } else {
+      FastIndex (Size, &Indexed, Pos);
+      MatchLen = FastFindMatch (Size, Pos, Options->ChainDepth, &MatchDist);
+    }
+
+    if ((Options->Effort >= CompressEffortLazy) && (MatchLen != 0) && (MatchLen < MAXMATCH)) {
+      //
+      // If the next position has a longer match, output this character on its own
+      //
+      FastIndex (Size, &Indexed, Pos + 1);
+      NextLen = FastFindMatch (Size, Pos + 1, Options->ChainDepth, &NextDist);
+      if (NextLen > MatchLen) {
+        HaveNext = TRUE;
+        MatchLen = 0;
+      }
+    }
+
+    if (MatchLen == 0) {
+      CompressOutput (mSrc[Pos], 0);
+      Pos++;
+      continue;
+    }
+
+    CompressOutput (
+      MatchLen + (UINT8_MAX + 1 - THRESHOLD),
+      MatchDist - 1
+      );
+
+    if (Options->Effort == CompressEffortFastest) {
+      //
+      // Leave the rest of the match out of the hash chains
+      //
+      FastIndex (Size, &Indexed, Pos + 1);
+      Indexed = Pos + MatchLen;
+    }
+
+    Pos += MatchLen;
+  }
+
+  HufEncodeEnd ();
+  FreeMemory ();
+  return EFI_SUCCESS;
+}
+
+/**
+  Compress a buffer with either match finder.
 
   @param[in]       SrcBuffer     The buffer containing the source data.
   @param[in]       SrcSize       The number of bytes in SrcBuffer.
   @param[in]       DstBuffer     The buffer to put the compressed image in.
   @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
                                 return the number of bytes placed in DstBuffer.
+  @param[in]       Options       The fast mode options, or NULL for the classic match finder.
 
   @retval EFI_SUCCESS           The compression was successful.
   @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for compression process.
 **/
 EFI_STATUS
-Compress (
-  IN       VOID    *SrcBuffer,
-  IN       UINT64  SrcSize,
-  IN       VOID    *DstBuffer,
-  IN OUT   UINT64  *DstSize
+CompressWorker (
+  IN       VOID                   *SrcBuffer,
+  IN       UINT64                 SrcSize,
+  IN       VOID                   *DstBuffer,
+  IN OUT   UINT64                 *DstSize,
+  IN CONST COMPRESS_FAST_OPTIONS  *Options OPTIONAL
   )
 {
   EFI_STATUS  Status;
@@ -1362,6 +1584,8 @@ Compress (
   mParent     = NULL;
   mPrev       = NULL;
   mNext       = NULL;
+  mHashHead   = NULL;
+  mHashPrev   = NULL;
 
   mSrc           = SrcBuffer;
   mSrcUpperLimit = mSrc + SrcSize;
@@ -1379,7 +1603,12 @@ Compress (
   //
   // Compress it
   //
-  Status = Encode ();
+  if (Options == NULL) {
+    Status = Encode ();
+  } else {
+    Status = EncodeFast (Options);
+  }
+
   if (EFI_ERROR (Status)) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -1409,3 +1638,68 @@ Compress (
     return EFI_SUCCESS;
   }
 }
+
+/**
+  The compression routine.
+
+  @param[in]       SrcBuffer     The buffer containing the source data.
+  @param[in]       SrcSize       The number of bytes in SrcBuffer.
+  @param[in]       DstBuffer     The buffer to put the compressed image in.
+  @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
+                                return the number of bytes placed in DstBuffer.
+
+  @retval EFI_SUCCESS           The compression was successful.
+  @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+**/
+EFI_STATUS
+EFIAPI
+Compress (
+  IN       VOID    *SrcBuffer,
+  IN       UINT64  SrcSize,
+  IN       VOID    *DstBuffer,
+  IN OUT   UINT64  *DstSize
+  )
+{
+  return CompressWorker (SrcBuffer, SrcSize, DstBuffer, DstSize, NULL);
+}
+
+/**
+  The compression routine, using hash chains to find matches.
+
+  @param[in]       SrcBuffer     The buffer containing the source data.
+  @param[in]       SrcSize       The number of bytes in SrcBuffer.
+  @param[in]       DstBuffer     The buffer to put the compressed image in.
+  @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
+                                return the number of bytes placed in DstBuffer.
+  @param[in]       Options       The chain depth and effort level.  NULL selects
+                                COMPRESS_FAST_DEFAULT_CHAIN_DEPTH and CompressEffortLazy.
+
+  @retval EFI_SUCCESS            The compression was successful.
+  @retval EFI_BUFFER_TOO_SMALL   The buffer was too small.  DstSize is required.
+  @retval EFI_INVALID_PARAMETER  SrcSize is larger than MAX_UINT32 or Options is not valid.
+  @retval EFI_OUT_OF_RESOURCES   Not enough memory for compression process.
+**/
+EFI_STATUS
+EFIAPI
+CompressFast (
+  IN       VOID                   *SrcBuffer,
+  IN       UINT64                 SrcSize,
+  IN       VOID                   *DstBuffer,
+  IN OUT   UINT64                 *DstSize,
+  IN CONST COMPRESS_FAST_OPTIONS  *Options OPTIONAL
+  )
+{
+  COMPRESS_FAST_OPTIONS  Default;
+
+  if (Options == NULL) {
+    Default.ChainDepth = COMPRESS_FAST_DEFAULT_CHAIN_DEPTH;
+    Default.Effort     = CompressEffortLazy;
+    Options            = &Default;
+  }
+
+  if ((SrcSize > MAX_UINT32) || (Options->ChainDepth == 0) || (Options->Effort >= CompressEffortMax)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return CompressWorker (SrcBuffer, SrcSize, DstBuffer, DstSize, Options);
+}
@@ -9,6 +9,23 @@
 #ifndef _EFI_SHELL_COMPRESS_H_
 #define _EFI_SHELL_COMPRESS_H_
 
+//
+// Chain depth used by CompressFast when no options are given
+//
+#define COMPRESS_FAST_DEFAULT_CHAIN_DEPTH  32
+
+typedef enum {
+  CompressEffortFastest,    // Greedy matching, only the start of each match is indexed
+  CompressEffortGreedy,     // Greedy matching, every position is indexed
+  CompressEffortLazy,       // Output a character instead when the next position matches longer
+  CompressEffortMax
+} COMPRESS_EFFORT;
+
+typedef struct {
+  UINT32             ChainDepth; // Maximum earlier positions compared for each match.  Must not be 0
+  COMPRESS_EFFORT    Effort;
+} COMPRESS_FAST_OPTIONS;
+
 /**
   The compression routine.
 
@@ -30,4 +47,34 @@ Compress (
   IN OUT  UINT64  *DstSize
   );
 
+/**
+  The compression routine, using hash chains to find matches.
+
+  This is typically several times faster than Compress, at the cost of a
+  slightly larger output for low chain depths.  The output has the same
+  format and is decompressed by the standard EFI decompressor.
+
+  @param[in]       SrcBuffer     The buffer containing the source data.
+  @param[in]       SrcSize       Number of bytes in SrcBuffer.
+  @param[in]       DstBuffer     The buffer to put the compressed image in.
+  @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
+                                 return the number of bytes placed in DstBuffer.
+  @param[in]       Options       The chain depth and effort level.  NULL selects
+                                 COMPRESS_FAST_DEFAULT_CHAIN_DEPTH and CompressEffortLazy.
+
+  @retval EFI_SUCCESS            The compression was successful.
+  @retval EFI_BUFFER_TOO_SMALL   The buffer was too small.  DstSize is required.
+  @retval EFI_INVALID_PARAMETER  SrcSize is larger than MAX_UINT32 or Options is not valid.
+  @retval EFI_OUT_OF_RESOURCES   Not enough memory for compression process.
+**/
+EFI_STATUS
+EFIAPI
+CompressFast (
+  IN      VOID                         *SrcBuffer,
+  IN      UINT64                       SrcSize,
+  IN      VOID                         *DstBuffer,
+  IN OUT  UINT64                       *DstSize,
+  IN      CONST COMPRESS_FAST_OPTIONS  *Options OPTIONAL
+  );
+
 #endif
@@ -34,6 +34,7 @@ STATIC CONST SHELL_PARAM_ITEM  ParamList[] = {
   { L"-h", TypeFlag  },    // -h   Help
   { L"-?", TypeFlag  },    // -h   Help
   { L"-z", TypeFlag  },    // -z   Compress Certificate
+  { L"-f", TypeFlag  },    // -f   Fast compression
   { L"-u", TypeValue },    // -u URL input file
   { L"-c", TypeValue },    // -c Cert File
   { NULL,  TypeMax   }
@@ -53,6 +54,63 @@ CHAR16  *mValidCertSuffix[] = {
   NULL
 };
 
+/**
+  Compress a buffer, sizing the output from a first guess instead of a
+  separate sizing pass.
+
+  @param[in]  Buffer          Data to compress.
+  @param[in]  BufferSize      Number of bytes in Buffer.
+  @param[in]  Fast            TRUE to use CompressFast with its default options.
+  @param[out] CompressedSize  Number of bytes in the returned buffer.
+
+  @return Pool allocated compressed data, or NULL on error.
+**/
+CHAR8 *
+CompressBuffer (
+  IN  CONST CHAR8  *Buffer,
+  IN  UINT64       BufferSize,
+  IN  BOOLEAN      Fast,
+  OUT UINT64       *CompressedSize
+  )
+{
+  CHAR8       *CompressedBuffer;
+  EFI_STATUS  Status;
+  UINTN       Attempt;
+
+  Status = EFI_BUFFER_TOO_SMALL;
+
+  //
+  // Incompressible data grows by well under 1/8.  If the guess is still too small,
+  // the first attempt returns the exact size for the second.
+  //
+  *CompressedSize = BufferSize + BufferSize / 8 + 64;
+  for (Attempt = 0; Attempt < 2; Attempt++) {
+    CompressedBuffer = AllocatePool (*CompressedSize);
+    if (NULL == CompressedBuffer) {
+      AsciiPrint ("Error allocating compressed buffer. Size = %ld\n", *CompressedSize);
+      return NULL;
+    }
+
+    if (Fast) {
+      Status = CompressFast ((VOID *)Buffer, BufferSize, CompressedBuffer, CompressedSize, NULL);
+    } else {
+      Status = Compress ((VOID *)Buffer, BufferSize, CompressedBuffer, CompressedSize);
+    }
+
+    if (!EFI_ERROR (Status)) {
+      return CompressedBuffer;
+    }
+
+    FreePool (CompressedBuffer);
+    if (EFI_BUFFER_TOO_SMALL != Status) {
+      break;
+    }
+  }
+
+  AsciiPrint ("Error compressing Cert. Code=%r\n", Status);
+  return NULL;
+}
+
 /**
  * ValidateFileExtension - validates if file extension is supported
  *
@@ -346,6 +404,7 @@ EnrollInDfciEntry (
   UINT64        CertFileSize;
   CHAR8         *CompressedBuffer;
   UINT64        CompressedSize;
+  BOOLEAN       FlagF;
   BOOLEAN       FlagH;
   BOOLEAN       FlagZ;
   LIST_ENTRY    *ParamPackage;
@@ -372,12 +431,14 @@ EnrollInDfciEntry (
   FlagH  = ShellCommandLineGetFlag (ParamPackage, L"-h");
   FlagH |= ShellCommandLineGetFlag (ParamPackage, L"-?");
   FlagZ  = ShellCommandLineGetFlag (ParamPackage, L"-z");
+  FlagF  = ShellCommandLineGetFlag (ParamPackage, L"-f");
 
   if (FlagH) {
-    AsciiPrint ("EnrollInDfci -c CertFileName -u UrlFileName [-z] [-h] [-?] \n");
+    AsciiPrint ("EnrollInDfci -c CertFileName -u UrlFileName [-z [-f]] [-h] [-?] \n");
     AsciiPrint ("   -h    Print this Help\n");
     AsciiPrint ("   -l    Print this help\n");
     AsciiPrint ("   -z    Compress Certificate\n");
+    AsciiPrint ("   -f    Use fast compression with -z\n");
     AsciiPrint ("   -c    Certificate File Name - Certificate for HTTPS\n");
     AsciiPrint ("   -u    UrlFIleName - ASCII Encoded file with base URL\"\n");
 
@@ -434,26 +495,9 @@ EnrollInDfciEntry (
   }
 
   if (FlagZ) {
-    CompressedSize = 0;
-    Status         = Compress (CertBuffer, CertFileSize, NULL, &CompressedSize);
-    if (EFI_BUFFER_TOO_SMALL != Status) {
-      FreePool (CertBuffer);
-      AsciiPrint ("Error determining compressed size. Code=%r\n", Status);
-      return 8;
-    }
-
-    CompressedBuffer = AllocatePool (CompressedSize);
+    CompressedBuffer = CompressBuffer (CertBuffer, CertFileSize, FlagF, &CompressedSize);
     if (NULL == CompressedBuffer) {
       FreePool (CertBuffer);
-      AsciiPrint ("Error allocating compressed buffer. Size = %d\n", CompressedSize);
-      return 8;
-    }
-
-    Status = Compress (CertBuffer, CertFileSize, CompressedBuffer, &CompressedSize);
-    if (EFI_ERROR (Status)) {
-      FreePool (CompressedBuffer);
-      FreePool (CertBuffer);
-      AsciiPrint ("Error compressing Cert. Code=%r\n", Status);
       return 8;
     }
 
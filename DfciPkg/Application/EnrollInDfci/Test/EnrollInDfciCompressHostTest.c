@@ -0,0 +1,552 @@
+/** @file
+  Host based unit test and benchmark for the EnrollInDfci compression routines.
+
+  Every packet is decompressed with the standard EFI decompressor and compared
+  with the original.  The benchmark compresses a large settings packet with the
+  classic and fast match finders and logs the time and size of each.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PrintLib.h>
+#include <Library/UefiDecompressLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "../Compress.h"
+
+#define UNIT_TEST_NAME     "EnrollInDfci Compress Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define CERT_SIZE              1400
+#define SETTINGS_PACKET_SIZE   (512 * 1024)
+#define BENCHMARK_ITERATIONS   10
+
+typedef struct {
+  CONST CHAR8    *Name;
+  UINT8          *Data;
+  UINTN          Size;
+} TEST_PACKET;
+
+typedef enum {
+  PacketCert,
+  PacketPermissions,
+  PacketSettings,
+  PacketMax
+} TEST_PACKET_INDEX;
+
+STATIC TEST_PACKET  mPackets[PacketMax] = {
+  { "Cert",        NULL, 0 },
+  { "Permissions", NULL, 0 },
+  { "Settings",    NULL, 0 }
+};
+
+STATIC CONST CHAR8  *mSettingIds[] = {
+  "Dfci.OnboardCameras.Enable",
+  "Dfci.OnboardAudio.Enable",
+  "Dfci.OnboardRadios.Enable",
+  "Dfci.BootExternalMedia.Enable",
+  "Dfci.BootOnboardNetwork.Enable",
+  "Dfci.CpuAndIoVirtualization.Enable",
+  "Dfci.RecoveryUrl.String",
+  "Dfci.HttpsCert.Binary"
+};
+
+STATIC UINT32  mSeed;
+
+/**
+  Return the next value of a simple linear congruential generator, so the
+  packets are identical on every run.
+
+  @return A pseudo random byte.
+**/
+STATIC
+UINT8
+NextRandomByte (
+  VOID
+  )
+{
+  mSeed = mSeed * 1103515245 + 12345;
+  return (UINT8)(mSeed >> 16);
+}
+
+/**
+  Append text to a packet under construction.
+
+  @param[in, out] Packet    The packet to append to.  Data must have room for Capacity bytes.
+  @param[in]      Capacity  The size of the Data buffer.
+  @param[in]      Format    AsciiSPrint format string.
+  @param[in]      ...       Arguments for Format.
+**/
+STATIC
+VOID
+EFIAPI
+AppendText (
+  IN OUT TEST_PACKET  *Packet,
+  IN     UINTN        Capacity,
+  IN     CONST CHAR8  *Format,
+  ...
+  )
+{
+  VA_LIST  Marker;
+
+  VA_START (Marker, Format);
+  Packet->Size += AsciiVSPrint ((CHAR8 *)Packet->Data + Packet->Size, Capacity - Packet->Size, Format, Marker);
+  VA_END (Marker);
+}
+
+/**
+  Build the packets used by the tests.  The certificate is random DER-like
+  data, the permissions and settings packets are XML in the DFCI schema with
+  a base64 certificate in the settings.
+
+  @retval EFI_SUCCESS           The packets were built.
+  @retval EFI_OUT_OF_RESOURCES  A memory allocation failed.
+**/
+STATIC
+EFI_STATUS
+BuildPackets (
+  VOID
+  )
+{
+  TEST_PACKET  *Packet;
+  CHAR8        *Base64;
+  UINTN        Base64Size;
+  UINTN        Index;
+
+  mSeed = 0x44464349;
+
+  Packet       = &mPackets[PacketCert];
+  Packet->Data = AllocatePool (CERT_SIZE);
+  if (Packet->Data == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Packet->Data[0] = 0x30;
+  Packet->Data[1] = 0x82;
+  Packet->Data[2] = (UINT8)((CERT_SIZE - 4) >> 8);
+  Packet->Data[3] = (UINT8)(CERT_SIZE - 4);
+  for (Index = 4; Index < CERT_SIZE; Index++) {
+    Packet->Data[Index] = NextRandomByte ();
+  }
+
+  Packet->Size = CERT_SIZE;
+
+  Base64Size = 0;
+  Base64Encode (Packet->Data, Packet->Size, NULL, &Base64Size);
+  Base64 = AllocatePool (Base64Size);
+  if ((Base64 == NULL) || EFI_ERROR (Base64Encode (Packet->Data, Packet->Size, Base64, &Base64Size))) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Packet       = &mPackets[PacketPermissions];
+  Packet->Data = AllocatePool (SIZE_16KB);
+  if (Packet->Data == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  AppendText (Packet, SIZE_16KB, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<PermissionsPacket xmlns=\"urn:UefiSettings-Schema\">\n");
+  AppendText (Packet, SIZE_16KB, "    <CreatedBy>DFCI Tester</CreatedBy>\n    <CreatedOn>2020-03-27 10:22:00</CreatedOn>\n");
+  AppendText (Packet, SIZE_16KB, "    <Version>1</Version>\n    <LowestSupportedVersion>1</LowestSupportedVersion>\n");
+  AppendText (Packet, SIZE_16KB, "    <Permissions Default=\"129\" Delegated=\"192\" Append=\"False\">\n");
+  for (Index = 0; Index < ARRAY_SIZE (mSettingIds); Index++) {
+    AppendText (Packet, SIZE_16KB, "        <Permission>\n            <Id>%a</Id>\n            <PMask>%d</PMask>\n            <DMask>%d</DMask>\n        </Permission>\n", mSettingIds[Index], 128 | (Index & 1), 64);
+  }
+
+  AppendText (Packet, SIZE_16KB, "    </Permissions>\n</PermissionsPacket>\n");
+
+  Packet       = &mPackets[PacketSettings];
+  Packet->Data = AllocatePool (SETTINGS_PACKET_SIZE);
+  if (Packet->Data == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  AppendText (Packet, SETTINGS_PACKET_SIZE, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<SettingsPacket xmlns=\"urn:UefiSettings-Schema\">\n");
+  AppendText (Packet, SETTINGS_PACKET_SIZE, "    <CreatedBy>DFCI Tester</CreatedBy>\n    <CreatedOn>2020-03-27 10:22:00</CreatedOn>\n");
+  AppendText (Packet, SETTINGS_PACKET_SIZE, "    <Version>2</Version>\n    <LowestSupportedVersion>2</LowestSupportedVersion>\n    <Settings>\n");
+  for (Index = 0; Packet->Size + Base64Size + SIZE_1KB < SETTINGS_PACKET_SIZE; Index++) {
+    if ((Index % 64) == 0) {
+      AppendText (Packet, SETTINGS_PACKET_SIZE, "        <Setting>\n            <Id>Dfci.HttpsCert.Binary</Id>\n            <Value>%a</Value>\n        </Setting>\n", Base64);
+    } else {
+      AppendText (
+        Packet,
+        SETTINGS_PACKET_SIZE,
+        "        <Setting>\n            <Id>%a</Id>\n            <Value>%a</Value>\n        </Setting>\n",
+        mSettingIds[Index % ARRAY_SIZE (mSettingIds)],
+        (NextRandomByte () & 1) ? "Enabled" : "Disabled"
+        );
+    }
+  }
+
+  AppendText (Packet, SETTINGS_PACKET_SIZE, "    </Settings>\n</SettingsPacket>\n");
+
+  FreePool (Base64);
+  return EFI_SUCCESS;
+}
+
+/**
+  Compress a packet, check the size query agrees with the real compression,
+  and check the standard EFI decompressor restores the original.
+
+  @param[in]  Packet          The packet to compress.
+  @param[in]  Options         Options for CompressFast, or NULL to use Compress.
+  @param[out] CompressedSize  The size of the compressed packet.  Optional.
+
+  @retval UNIT_TEST_PASSED    The packet round tripped.
+  @retval Others              An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+RoundTrip (
+  IN  CONST TEST_PACKET            *Packet,
+  IN  CONST COMPRESS_FAST_OPTIONS  *Options OPTIONAL,
+  OUT UINT64                       *CompressedSize OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      RequiredSize;
+  UINT64      Size;
+  UINT8       *Compressed;
+  UINT8       *Decompressed;
+  VOID        *Scratch;
+  UINT32      DecompressedSize;
+  UINT32      ScratchSize;
+
+  RequiredSize = 0;
+  if (Options == NULL) {
+    Status = Compress (Packet->Data, Packet->Size, NULL, &RequiredSize);
+  } else {
+    Status = CompressFast (Packet->Data, Packet->Size, NULL, &RequiredSize, Options);
+  }
+
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_BUFFER_TOO_SMALL);
+
+  Compressed = AllocatePool ((UINTN)RequiredSize);
+  UT_ASSERT_NOT_NULL (Compressed);
+
+  Size = RequiredSize;
+  if (Options == NULL) {
+    Status = Compress (Packet->Data, Packet->Size, Compressed, &Size);
+  } else {
+    Status = CompressFast (Packet->Data, Packet->Size, Compressed, &Size, Options);
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Size, RequiredSize);
+
+  Status = UefiDecompressGetInfo (Compressed, (UINT32)Size, &DecompressedSize, &ScratchSize);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (DecompressedSize, Packet->Size);
+
+  Decompressed = AllocatePool (DecompressedSize);
+  Scratch      = AllocatePool (ScratchSize);
+  UT_ASSERT_NOT_NULL (Decompressed);
+  UT_ASSERT_NOT_NULL (Scratch);
+
+  Status = UefiDecompress (Compressed, Decompressed, Scratch);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_MEM_EQUAL (Decompressed, Packet->Data, Packet->Size);
+
+  FreePool (Scratch);
+  FreePool (Decompressed);
+  FreePool (Compressed);
+
+  if (CompressedSize != NULL) {
+    *CompressedSize = Size;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Compress should produce output the standard EFI decompressor restores.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestClassicRoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < PacketMax; Index++) {
+    UT_LOG_INFO ("Packet %a\n", mPackets[Index].Name);
+    UT_ASSERT_EQUAL (RoundTrip (&mPackets[Index], NULL, NULL), UNIT_TEST_PASSED);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  CompressFast should produce output the standard EFI decompressor restores
+  at every effort level and chain depth.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestFastRoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINT32    ChainDepths[] = { 1, COMPRESS_FAST_DEFAULT_CHAIN_DEPTH, 4096 };
+  COMPRESS_FAST_OPTIONS  Options;
+  UINTN                  Index;
+  UINTN                  Effort;
+  UINTN                  DepthIndex;
+  UINT64                 Size;
+  UINT64                 DefaultSize;
+
+  for (Index = 0; Index < PacketMax; Index++) {
+    for (Effort = 0; Effort < CompressEffortMax; Effort++) {
+      for (DepthIndex = 0; DepthIndex < ARRAY_SIZE (ChainDepths); DepthIndex++) {
+        Options.Effort     = (COMPRESS_EFFORT)Effort;
+        Options.ChainDepth = ChainDepths[DepthIndex];
+        UT_LOG_INFO ("Packet %a Effort %d ChainDepth %d\n", mPackets[Index].Name, Effort, Options.ChainDepth);
+        UT_ASSERT_EQUAL (RoundTrip (&mPackets[Index], &Options, NULL), UNIT_TEST_PASSED);
+      }
+    }
+
+    //
+    // NULL options select the defaults
+    //
+    Options.Effort     = CompressEffortLazy;
+    Options.ChainDepth = COMPRESS_FAST_DEFAULT_CHAIN_DEPTH;
+    UT_ASSERT_EQUAL (RoundTrip (&mPackets[Index], &Options, &Size), UNIT_TEST_PASSED);
+
+    DefaultSize = 0;
+    UT_ASSERT_STATUS_EQUAL (CompressFast (mPackets[Index].Data, mPackets[Index].Size, NULL, &DefaultSize, NULL), EFI_BUFFER_TOO_SMALL);
+    UT_ASSERT_EQUAL (DefaultSize, Size);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  CompressFast should reject options it cannot honor.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestFastInvalidOptions (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  COMPRESS_FAST_OPTIONS  Options;
+  UINT64                 Size;
+
+  Size               = 0;
+  Options.ChainDepth = 0;
+  Options.Effort     = CompressEffortLazy;
+  UT_ASSERT_STATUS_EQUAL (CompressFast (mPackets[PacketCert].Data, mPackets[PacketCert].Size, NULL, &Size, &Options), EFI_INVALID_PARAMETER);
+
+  Options.ChainDepth = COMPRESS_FAST_DEFAULT_CHAIN_DEPTH;
+  Options.Effort     = CompressEffortMax;
+  UT_ASSERT_STATUS_EQUAL (CompressFast (mPackets[PacketCert].Data, mPackets[PacketCert].Size, NULL, &Size, &Options), EFI_INVALID_PARAMETER);
+
+  UT_ASSERT_STATUS_EQUAL (CompressFast (mPackets[PacketCert].Data, (UINT64)MAX_UINT32 + 1, NULL, &Size, NULL), EFI_INVALID_PARAMETER);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Compress a packet repeatedly and return the average time per call.
+
+  @param[in]  Packet      The packet to compress.
+  @param[in]  Options     Options for CompressFast, or NULL to use Compress.
+  @param[in]  Buffer      The buffer to compress into.
+  @param[in]  BufferSize  The size of Buffer.
+
+  @return The average time per call in microseconds, or MAX_UINTN if compression failed.
+**/
+STATIC
+UINTN
+TimeCompress (
+  IN CONST TEST_PACKET            *Packet,
+  IN CONST COMPRESS_FAST_OPTIONS  *Options OPTIONAL,
+  IN VOID                         *Buffer,
+  IN UINT64                       BufferSize
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Size;
+  clock_t     Start;
+  UINTN       Iteration;
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    Size = BufferSize;
+    if (Options == NULL) {
+      Status = Compress (Packet->Data, Packet->Size, Buffer, &Size);
+    } else {
+      Status = CompressFast (Packet->Data, Packet->Size, Buffer, &Size, Options);
+    }
+
+    if (EFI_ERROR (Status)) {
+      return MAX_UINTN;
+    }
+  }
+
+  return (UINTN)((UINT64)(clock () - Start) * 1000000 / CLOCKS_PER_SEC / BENCHMARK_ITERATIONS);
+}
+
+/**
+  Compress the settings packet repeatedly with each match finder and log the
+  time and size.  CompressFast at its default options should stay within 5%
+  of the size Compress achieves.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST CHAR8     *EffortNames[] = { "Fastest", "Greedy", "Lazy" };
+  CONST TEST_PACKET      *Packet;
+  COMPRESS_FAST_OPTIONS  Options;
+  VOID                   *Buffer;
+  UINT64                 BufferSize;
+  UINT64                 ClassicSize;
+  UINT64                 Size;
+  UINTN                  Micro;
+  UINTN                  Effort;
+
+  Packet = &mPackets[PacketSettings];
+
+  UT_ASSERT_EQUAL (RoundTrip (Packet, NULL, &ClassicSize), UNIT_TEST_PASSED);
+
+  BufferSize = Packet->Size + Packet->Size / 8 + 64;
+  Buffer     = AllocatePool ((UINTN)BufferSize);
+  UT_ASSERT_NOT_NULL (Buffer);
+
+  Micro = TimeCompress (Packet, NULL, Buffer, BufferSize);
+  UT_ASSERT_NOT_EQUAL (Micro, MAX_UINTN);
+  DEBUG ((DEBUG_INFO, "%a: Compress %d -> %d bytes, %d us\n", __FUNCTION__, (UINT32)Packet->Size, (UINT32)ClassicSize, Micro));
+
+  Options.ChainDepth = COMPRESS_FAST_DEFAULT_CHAIN_DEPTH;
+  for (Effort = 0; Effort < CompressEffortMax; Effort++) {
+    Options.Effort = (COMPRESS_EFFORT)Effort;
+    UT_ASSERT_EQUAL (RoundTrip (Packet, &Options, &Size), UNIT_TEST_PASSED);
+
+    Micro = TimeCompress (Packet, &Options, Buffer, BufferSize);
+    UT_ASSERT_NOT_EQUAL (Micro, MAX_UINTN);
+    DEBUG ((DEBUG_INFO, "%a: CompressFast %a %d -> %d bytes, %d us\n", __FUNCTION__, EffortNames[Effort], (UINT32)Packet->Size, (UINT32)Size, Micro));
+  }
+
+  //
+  // Size is from the last, default, effort level
+  //
+  UT_ASSERT_TRUE (Size <= ClassicSize + ClassicSize / 20);
+
+  FreePool (Buffer);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  compression routines and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      CompressSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = BuildPackets ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to build test packets. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the Compress Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&CompressSuite, Framework, "Compress", "Dfci.EnrollInDfci.Compress", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for CompressSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (CompressSuite, "Compress output should decompress to the original packet", "ClassicRoundTrip", UnitTestClassicRoundTrip, NULL, NULL, NULL);
+  AddTestCase (CompressSuite, "CompressFast output should decompress to the original packet", "FastRoundTrip", UnitTestFastRoundTrip, NULL, NULL, NULL);
+  AddTestCase (CompressSuite, "CompressFast should reject invalid options", "FastInvalidOptions", UnitTestFastInvalidOptions, NULL, NULL, NULL);
+  AddTestCase (CompressSuite, "Benchmark Compress and CompressFast on a settings packet", "Benchmark", UnitTestBenchmark, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
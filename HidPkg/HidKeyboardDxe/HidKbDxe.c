@@ -132,9 +132,10 @@ HIDKeyboardDriverBindingStart (
   IN EFI_DEVICE_PATH_PROTOCOL     *RemainingDevicePath
   )
 {
-  EFI_STATUS  Status;
-  HID_KB_DEV  *HidKeyboardDevice = NULL;
-  EFI_TPL     OldTpl;
+  EFI_STATUS                      Status;
+  HID_KB_DEV                      *HidKeyboardDevice = NULL;
+  HID_REPORT_DESCRIPTOR_PROTOCOL  *ReportDescriptorProtocol;
+  EFI_TPL                         OldTpl;
 
   DEBUG ((DEBUG_VERBOSE, "[%a]\n", __FUNCTION__));
 
@@ -184,6 +185,19 @@ HIDKeyboardDriverBindingStart (
     goto ErrorExit;
   }
 
+  // The report descriptor is optional. Without it only BootKeyboard reports are accepted.
+  Status = gBS->OpenProtocol (
+                  Controller,
+                  &gHidReportDescriptorProtocolGuid,
+                  (VOID **)&ReportDescriptorProtocol,
+                  This->DriverBindingHandle,
+                  Controller,
+                  EFI_OPEN_PROTOCOL_GET_PROTOCOL
+                  );
+  if (!EFI_ERROR (Status)) {
+    InitKeyboardReportTable (HidKeyboardDevice, ReportDescriptorProtocol);
+  }
+
   // Set up SimpleTextIn
   HidKeyboardDevice->SimpleInput.Reset         = HIDKeyboardReset;
   HidKeyboardDevice->SimpleInput.ReadKeyStroke = HIDKeyboardReadKeyStroke;
@@ -317,8 +331,8 @@ HIDKeyboardDriverBindingStart (
   //
 ErrorExit:
   if (HidKeyboardDevice != NULL) {
-    if (HidKeyboardDevice->LastReport != NULL) {
-      FreePool (HidKeyboardDevice->LastReport);
+    if (HidKeyboardDevice->ReportTable != NULL) {
+      FreePool (HidKeyboardDevice->ReportTable);
     }
 
     if (HidKeyboardDevice->SimpleInput.WaitForKey != NULL) {
@@ -453,8 +467,8 @@ HIDKeyboardDriverBindingStop (
   DestroyQueue (&HidKeyboardDevice->EfiKeyQueue);
   DestroyQueue (&HidKeyboardDevice->EfiKeyQueueForNotify);
 
-  if (HidKeyboardDevice->LastReport != NULL) {
-    FreePool (HidKeyboardDevice->LastReport);
+  if (HidKeyboardDevice->ReportTable != NULL) {
+    FreePool (HidKeyboardDevice->ReportTable);
   }
 
   FreePool (HidKeyboardDevice);
@@ -34,6 +34,7 @@ Environment:
 #include <Guid/HiiKeyBoardLayout.h>
 #include <Guid/HidKeyBoardLayout.h>
 
+#include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
@@ -43,8 +44,11 @@ Environment:
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
 #include <Protocol/HidKeyboardProtocol.h>
+#include <Protocol/HidReportDescriptorProtocol.h>
 #include <Library/HiiLib.h>
 
+#include "HidReportDescriptor.h"
+
 #define KEYBOARD_TIMER_INTERVAL  200000         // 0.02s
 
 #define MAX_KEY_ALLOWED  32
@@ -55,8 +59,6 @@ Environment:
 
 #define HID_KEYBOARD_DRIVER_VERSION  0x10
 
-#define INPUT_REPORT_HEADER_SIZE  (OFFSET_OF(KEYBOARD_HID_INPUT_BUFFER, KeyCode))
-
 typedef struct {
   BOOLEAN    Down;
   UINT8      KeyCode;
@@ -95,6 +97,12 @@ typedef struct {
   // NsKey[1] ~ NsKey[KeyCount] : Physical keys
   //
   EFI_KEY_DESCRIPTOR    *NsKey;
+
+  //
+  // Indexed by EFI_KEY: position of the physical key definition in NsKey[],
+  // or 0 if the key has no definition under this non-spacing key.
+  //
+  UINT8                 *PhysicalKeyIndex;
 } HID_NS_KEY;
 
 #define HID_NS_KEY_FORM_FROM_LINK(a)  CR (a, HID_NS_KEY, Link, HID_NS_KEY_SIGNATURE)
@@ -115,8 +123,12 @@ typedef struct {
   HID_SIMPLE_QUEUE                     EfiKeyQueue;
   HID_SIMPLE_QUEUE                     EfiKeyQueueForNotify;
 
-  KEYBOARD_HID_INPUT_BUFFER            *LastReport;
-  UINTN                                LastReportSize;
+  //
+  // Keys down as of the last report, and the compiled report descriptor when
+  // the device provides one through HID_REPORT_DESCRIPTOR_PROTOCOL.
+  //
+  HID_KEY_BITMAP                       KeysDown;
+  HID_REPORT_TABLE                     *ReportTable;
   UINT8                                CurKeyCode;
 
   UINT8                                RepeatKey;
@@ -154,6 +166,7 @@ typedef struct {
   // Non-spacing key list
   //
   LIST_ENTRY                           NsKeyList;
+  HID_NS_KEY                           **NsKeyLookup;       // Indexed by EFI_KEY
   HID_NS_KEY                           *CurrentNsKey;
   EFI_KEY_DESCRIPTOR                   *KeyConvertionTable;
   EFI_EVENT                            KeyboardLayoutEvent;
@@ -257,6 +257,22 @@ UINT8  EfiKeyToHidKeyCodeConvertionTable[] = {
   0x48   //  EfiKeyPause
 };
 
+#define EFI_KEY_COUNT  ARRAY_SIZE (EfiKeyToHidKeyCodeConvertionTable)
+
+//
+// Boot keyboard report descriptor as defined in HID 1.11 Appendix B.1. BootKeyboard
+// reports are decoded through the same compiled table as descriptor driven reports.
+//
+STATIC CONST UINT8  mBootKeyboardReportDescriptor[] = {
+  0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+  0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01,
+  0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06,
+  0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65, 0x81, 0x00, 0xC0
+};
+
+STATIC HID_REPORT_TABLE  mBootKeyboardReportTable;
+STATIC BOOLEAN           mBootKeyboardReportTableReady = FALSE;
+
 //
 // Keyboard modifier value to EFI Scan Code conversion table
 // EFI Scan Code and the modifier values are defined in UEFI spec.
@@ -474,32 +490,20 @@ FindHidNsKey (
   IN EFI_KEY_DESCRIPTOR  *KeyDescriptor
   )
 {
-  LIST_ENTRY  *Link;
-  LIST_ENTRY  *NsKeyList;
-  HID_NS_KEY  *HidNsKey;
-
-  NsKeyList = &HidKeyboardDevice->NsKeyList;
-  Link      = GetFirstNode (NsKeyList);
-  while (!IsNull (NsKeyList, Link)) {
-    HidNsKey = HID_NS_KEY_FORM_FROM_LINK (Link);
-
-    if (HidNsKey->NsKey[0].Key == KeyDescriptor->Key) {
-      return HidNsKey;
-    }
-
-    Link = GetNextNode (NsKeyList, Link);
+  if ((HidKeyboardDevice->NsKeyLookup == NULL) || ((UINTN)KeyDescriptor->Key >= EFI_KEY_COUNT)) {
+    return NULL;
   }
 
-  return NULL;
+  return HidKeyboardDevice->NsKeyLookup[KeyDescriptor->Key];
 }
 
 /**
   Find physical key definition for a given key descriptor.
 
   For a specified non-spacing key, there are a list of physical
-  keys following it. This function traverses the list of
-  physical keys and tries to find the physical key matching
-  the KeyDescriptor.
+  keys following it. This function looks up the physical key
+  matching the KeyDescriptor in the index built when the layout
+  was loaded.
 
   @param  HidNsKey          The non-spacing key information.
   @param  KeyDescriptor     The key descriptor.
@@ -514,16 +518,13 @@ FindPhysicalKey (
   IN EFI_KEY_DESCRIPTOR  *KeyDescriptor
   )
 {
-  UINTN               Index;
-  EFI_KEY_DESCRIPTOR  *PhysicalKey;
+  UINT8  Index;
 
-  PhysicalKey = &HidNsKey->NsKey[1];
-  for (Index = 0; Index < HidNsKey->KeyCount; Index++) {
-    if (KeyDescriptor->Key == PhysicalKey->Key) {
-      return PhysicalKey;
+  if ((HidNsKey->PhysicalKeyIndex != NULL) && ((UINTN)KeyDescriptor->Key < EFI_KEY_COUNT)) {
+    Index = HidNsKey->PhysicalKeyIndex[KeyDescriptor->Key];
+    if (Index != 0) {
+      return &HidNsKey->NsKey[Index];
     }
-
-    PhysicalKey++;
   }
 
   //
@@ -581,6 +582,8 @@ SetKeyboardLayoutEvent (
   ReleaseKeyboardLayoutResources (HidKeyboardDevice);
   HidKeyboardDevice->KeyConvertionTable = AllocateZeroPool ((NUMBER_OF_VALID_HID_KEYCODE)*sizeof (EFI_KEY_DESCRIPTOR));
   ASSERT (HidKeyboardDevice->KeyConvertionTable != NULL);
+  HidKeyboardDevice->NsKeyLookup = AllocateZeroPool (EFI_KEY_COUNT * sizeof (HID_NS_KEY *));
+  ASSERT (HidKeyboardDevice->NsKeyLookup != NULL);
 
   //
   // Traverse the list of key descriptors following the header of EFI_HII_KEYBOARD_LAYOUT
@@ -636,6 +639,24 @@ SetKeyboardLayoutEvent (
                               );
       InsertTailList (&HidKeyboardDevice->NsKeyList, &HidNsKey->Link);
 
+      //
+      // Index the non-spacing key and its physical keys by EFI_KEY. The first
+      // definition wins, as it would for a search of the list.
+      //
+      HidNsKey->PhysicalKeyIndex = AllocateZeroPool (EFI_KEY_COUNT);
+      ASSERT (HidNsKey->PhysicalKeyIndex != NULL);
+      if ((HidNsKey->NsKey != NULL) && (HidNsKey->PhysicalKeyIndex != NULL) && (HidKeyboardDevice->NsKeyLookup != NULL)) {
+        if (((UINTN)HidNsKey->NsKey[0].Key < EFI_KEY_COUNT) && (HidKeyboardDevice->NsKeyLookup[HidNsKey->NsKey[0].Key] == NULL)) {
+          HidKeyboardDevice->NsKeyLookup[HidNsKey->NsKey[0].Key] = HidNsKey;
+        }
+
+        for (Index2 = 1; (Index2 <= KeyCount) && (Index2 <= MAX_UINT8); Index2++) {
+          if (((UINTN)HidNsKey->NsKey[Index2].Key < EFI_KEY_COUNT) && (HidNsKey->PhysicalKeyIndex[HidNsKey->NsKey[Index2].Key] == 0)) {
+            HidNsKey->PhysicalKeyIndex[HidNsKey->NsKey[Index2].Key] = (UINT8)Index2;
+          }
+        }
+      }
+
       //
       // Skip over the child physical keys
       //
@@ -682,8 +703,19 @@ ReleaseKeyboardLayoutResources (
     RemoveEntryList (&HidNsKey->Link);
 
     FreePool (HidNsKey->NsKey);
+    if (HidNsKey->PhysicalKeyIndex != NULL) {
+      FreePool (HidNsKey->PhysicalKeyIndex);
+    }
+
     FreePool (HidNsKey);
   }
+
+  if (HidKeyboardDevice->NsKeyLookup != NULL) {
+    FreePool (HidKeyboardDevice->NsKeyLookup);
+  }
+
+  HidKeyboardDevice->NsKeyLookup  = NULL;
+  HidKeyboardDevice->CurrentNsKey = NULL;
 }
 
 /**
@@ -804,12 +836,7 @@ InitHidKeyboard (
   //
   SetKeyLED (HidKeyboardDevice);
 
-  if (HidKeyboardDevice->LastReport != NULL) {
-    FreePool (HidKeyboardDevice->LastReport);
-  }
-
-  HidKeyboardDevice->LastReport     = NULL;
-  HidKeyboardDevice->LastReportSize = 0;
+  ZeroMem (&HidKeyboardDevice->KeysDown, sizeof (HidKeyboardDevice->KeysDown));
 
   //
   // Create event for repeat keys' generation.
@@ -830,6 +857,104 @@ InitHidKeyboard (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the report table used to decode BootKeyboard reports.
+
+  @return The compiled boot keyboard report table, or NULL on failure.
+
+**/
+CONST HID_REPORT_TABLE *
+GetBootKeyboardReportTable (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+
+  if (!mBootKeyboardReportTableReady) {
+    Status = HidCompileReportDescriptor (
+               mBootKeyboardReportDescriptor,
+               sizeof (mBootKeyboardReportDescriptor),
+               &mBootKeyboardReportTable
+               );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "[%a] - Failed to compile boot keyboard report descriptor: %r\n", __FUNCTION__, Status));
+      ASSERT_EFI_ERROR (Status);
+      return NULL;
+    }
+
+    //
+    // Boot keyboard reports may carry more or fewer than six keycodes (see
+    // KEYBOARD_HID_INPUT_BUFFER), so read the key array up to the end of each report.
+    //
+    for (Index = 0; Index < mBootKeyboardReportTable.FieldCount; Index++) {
+      if ((mBootKeyboardReportTable.Field[Index].Flags & HID_REPORT_FIELD_ARRAY) != 0) {
+        mBootKeyboardReportTable.Field[Index].Flags |= HID_REPORT_FIELD_FILL_REPORT;
+      }
+    }
+
+    mBootKeyboardReportTableReady = TRUE;
+  }
+
+  return &mBootKeyboardReportTable;
+}
+
+/**
+  Compile the report descriptor of a keyboard that provides
+  HID_REPORT_DESCRIPTOR_PROTOCOL, so that its ReportKeyboard reports can be decoded.
+
+  @param  HidKeyboardDevice          The HID_KB_DEV instance.
+  @param  ReportDescriptorProtocol   The report descriptor protocol of the device.
+
+  @retval EFI_SUCCESS                The report table was built.
+  @retval EFI_OUT_OF_RESOURCES       Out of memory.
+  @retval Other                      The descriptor could not be retrieved or does not
+                                     describe a usable keyboard.
+
+**/
+EFI_STATUS
+InitKeyboardReportTable (
+  IN OUT HID_KB_DEV                      *HidKeyboardDevice,
+  IN     HID_REPORT_DESCRIPTOR_PROTOCOL  *ReportDescriptorProtocol
+  )
+{
+  EFI_STATUS        Status;
+  UINT8             *ReportDescriptor;
+  UINTN             ReportDescriptorSize;
+  HID_REPORT_TABLE  *ReportTable;
+
+  ReportDescriptor = NULL;
+  Status           = ReportDescriptorProtocol->GetReportDescriptor (
+                                                 ReportDescriptorProtocol,
+                                                 &ReportDescriptor,
+                                                 &ReportDescriptorSize
+                                                 );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[%a] - Failed to get report descriptor: %r\n", __FUNCTION__, Status));
+    return Status;
+  }
+
+  ReportTable = AllocateZeroPool (sizeof (HID_REPORT_TABLE));
+  if (ReportTable == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  Status = HidCompileReportDescriptor (ReportDescriptor, ReportDescriptorSize, ReportTable);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[%a] - Unusable keyboard report descriptor: %r\n", __FUNCTION__, Status));
+    FreePool (ReportTable);
+    goto Exit;
+  }
+
+  DEBUG ((DEBUG_VERBOSE, "[%a] - %d keyboard report(s), %d field(s)\n", __FUNCTION__, ReportTable->ReportCount, ReportTable->FieldCount));
+  HidKeyboardDevice->ReportTable = ReportTable;
+
+Exit:
+  FreePool (ReportDescriptor);
+  return Status;
+}
+
 /**
   Top-level function for handling key report form HID layer.
 
@@ -853,15 +978,11 @@ HIDProcessKeyStrokesCallback (
   IN VOID                    *Context
   )
 {
-  EFI_STATUS    Status;
-  HID_KB_DEV    *HidKeyboardDevice;
-  HID_KEY       HIDKey;
-  EFI_KEY_DATA  KeyData;
-
-  if (Interface != BootKeyboard) {
-    DEBUG ((DEBUG_ERROR, "[%a] - Unsupported HID report interface %d\n", __FUNCTION__, Interface));
-    return;
-  }
+  EFI_STATUS              Status;
+  HID_KB_DEV              *HidKeyboardDevice;
+  HID_KEY                 HIDKey;
+  EFI_KEY_DATA            KeyData;
+  CONST HID_REPORT_TABLE  *ReportTable;
 
   HidKeyboardDevice = (HID_KB_DEV *)Context;
 
@@ -871,8 +992,20 @@ HIDProcessKeyStrokesCallback (
     return;
   }
 
+  ReportTable = NULL;
+  if (Interface == BootKeyboard) {
+    ReportTable = GetBootKeyboardReportTable ();
+  } else if (Interface == ReportKeyboard) {
+    ReportTable = HidKeyboardDevice->ReportTable;
+  }
+
+  if (ReportTable == NULL) {
+    DEBUG ((DEBUG_ERROR, "[%a] - Unsupported HID report interface %d\n", __FUNCTION__, Interface));
+    return;
+  }
+
   // Process the HID keystrokes and enqueue them for further processing.
-  ProcessKeyStroke (HidInputReportBuffer, HidInputReportBufferSize, HidKeyboardDevice);
+  ProcessKeyStroke (ReportTable, HidInputReportBuffer, HidInputReportBufferSize, HidKeyboardDevice);
 
   while (!IsQueueEmpty (&HidKeyboardDevice->HidKeyQueue)) {
     //
@@ -898,6 +1031,10 @@ HIDProcessKeyStrokesCallback (
   Initial processing of the HID key report. Processes and queues individual keys
   in the key report.
 
+  The report is decoded into a bitmap of the keys held down, and the keys that
+  changed since the previous report are found by XOR-ing the two bitmaps.
+
+  @param  *ReportTable              - compiled report descriptor describing the report.
   @param  *HidInputReportBuffer     - Pointer to the buffer containing HID key report.
   @param  HidInputReportBufferSize  - gives the size of the input report buffer.
   @param  *HidKeyboardDevice        - pointer to HID_KB_DEV struct.
@@ -907,54 +1044,71 @@ HIDProcessKeyStrokesCallback (
 **/
 VOID
 ProcessKeyStroke (
-  IN UINT8       *HidInputReportBuffer,
-  IN UINTN       HidInputReportBufferSize,
-  IN HID_KB_DEV  *HidKeyboardDevice
+  IN CONST HID_REPORT_TABLE  *ReportTable,
+  IN UINT8                   *HidInputReportBuffer,
+  IN UINTN                   HidInputReportBufferSize,
+  IN HID_KB_DEV              *HidKeyboardDevice
   )
 {
-  HID_KEY                    HIDKey;
-  UINT8                      ModifierIndex;
-  UINT8                      Mask;
-  UINT8                      KeyCode;
-  UINT8                      LastKeyCode;
-  UINT8                      NewRepeatKey = 0;
-  BOOLEAN                    KeyPress;
-  BOOLEAN                    KeyRelease;
-  EFI_KEY_DESCRIPTOR         *KeyDescriptor;
-  KEYBOARD_HID_INPUT_BUFFER  *LastReport;
-  UINTN                      LastReportKeyCount;
-  KEYBOARD_HID_INPUT_BUFFER  *CurrentReport;
-  UINTN                      CurrentReportKeyCount;
+  EFI_STATUS          Status;
+  HID_KEY             HIDKey;
+  HID_KEY_BITMAP      CurrentKeys;
+  HID_KEY_BITMAP      Pressed;
+  UINT8               KeyOrder[MAX_KEY_ALLOWED];
+  UINTN               KeyOrderCount;
+  UINTN               Index;
+  UINTN               Word;
+  UINT32              Changed;
+  UINT8               ModifierIndex;
+  UINT8               Mask;
+  UINT8               KeyCode;
+  UINT8               NewRepeatKey = 0;
+  EFI_KEY_DESCRIPTOR  *KeyDescriptor;
 
-  if ((HidKeyboardDevice == NULL) || (HidInputReportBuffer == NULL)) {
+  if ((ReportTable == NULL) || (HidKeyboardDevice == NULL) || (HidInputReportBuffer == NULL)) {
     DEBUG ((DEBUG_ERROR, "[%a] - Invalid input pointer.\n", __FUNCTION__));
-    ASSERT ((HidKeyboardDevice != NULL) && (HidInputReportBuffer != NULL));
+    ASSERT ((ReportTable != NULL) && (HidKeyboardDevice != NULL) && (HidInputReportBuffer != NULL));
     return;
   }
 
-  if (HidInputReportBufferSize < INPUT_REPORT_HEADER_SIZE) {
-    DEBUG ((DEBUG_ERROR, "[%a] - HID input report buffer is too small to process.\n", __FUNCTION__));
+  CopyMem (&CurrentKeys, &HidKeyboardDevice->KeysDown, sizeof (CurrentKeys));
+  KeyOrderCount = ARRAY_SIZE (KeyOrder);
+  Status        = HidExtractKeyboardReport (
+                    ReportTable,
+                    HidInputReportBuffer,
+                    HidInputReportBufferSize,
+                    &CurrentKeys,
+                    KeyOrder,
+                    &KeyOrderCount
+                    );
+  if (EFI_ERROR (Status)) {
+    //
+    // EFI_NOT_FOUND is a report from another collection of the device (consumer
+    // control, system control...), which carries no keys.
+    //
+    if (Status != EFI_NOT_FOUND) {
+      DEBUG ((DEBUG_ERROR, "[%a] - Failed to decode HID input report: %r\n", __FUNCTION__, Status));
+    }
+
     return;
   }
 
-  // if Last response doesn't exist, create it.
-  if (HidKeyboardDevice->LastReport == NULL) {
-    HidKeyboardDevice->LastReportSize = INPUT_REPORT_HEADER_SIZE;
-    HidKeyboardDevice->LastReport     = AllocateZeroPool (INPUT_REPORT_HEADER_SIZE);
-    if (HidKeyboardDevice->LastReport == NULL) {
-      DEBUG ((DEBUG_ERROR, "[%a] - Could not allocate empty last report.\n", __FUNCTION__));
-      return;
-    }
+  for (Word = 0; Word < HID_KEY_BITMAP_WORDS; Word++) {
+    Pressed.Bits[Word] = (CurrentKeys.Bits[Word] ^ HidKeyboardDevice->KeysDown.Bits[Word]) & CurrentKeys.Bits[Word];
   }
 
-  LastReport            = HidKeyboardDevice->LastReport;
-  LastReportKeyCount    = HidKeyboardDevice->LastReportSize - INPUT_REPORT_HEADER_SIZE;
-  CurrentReport         = (KEYBOARD_HID_INPUT_BUFFER *)HidInputReportBuffer;
-  CurrentReportKeyCount = HidInputReportBufferSize - INPUT_REPORT_HEADER_SIZE;
+  //
+  // Handle normal key's releasing situation. Releases are not queued; only
+  // the release of the original repeat key needs handling.
+  //
+  if ((HidKeyboardDevice->RepeatKey != 0) && !HID_KEY_BITMAP_TEST (&CurrentKeys, HidKeyboardDevice->RepeatKey)) {
+    DEBUG ((DEBUG_VERBOSE, "HIDKeyboard: Resetting key repeat\n"));
+    HidKeyboardDevice->RepeatKey = 0;
+  }
 
   //
   // Handle modifier key's pressing or releasing situation.
-  // According to USB HID Firmware spec, Byte 0 uses following map of Modifier keys:
+  // Modifier keys use the following keycodes:
   // Bit0: Left Control,  Keycode: 0xe0
   // Bit1: Left Shift,    Keycode: 0xe1
   // Bit2: Left Alt,      Keycode: 0xe2
@@ -964,58 +1118,20 @@ ProcessKeyStroke (
   // Bit6: Right Alt,     Keycode: 0xe6
   // Bit7: Right GUI,     Keycode: 0xe7
   //
+  Changed = (CurrentKeys.Bits[0xe0 >> 5] ^ HidKeyboardDevice->KeysDown.Bits[0xe0 >> 5]) & 0xFF;
   for (ModifierIndex = 0; ModifierIndex < 8; ModifierIndex++) {
     Mask = (UINT8)(1 << ModifierIndex);
-    if ((CurrentReport->ModifierKeys & Mask) != (LastReport->ModifierKeys & Mask)) {
+    if ((Changed & Mask) != 0) {
       //
-      // If current modifier key is up, then CurModifierMap & Mask = 0;
-      // otherwise it is a non-zero value.
       // Insert the changed modifier key into key buffer.
       //
       HIDKey.KeyCode = (UINT8)(0xe0 + ModifierIndex);
-      HIDKey.Down    = (BOOLEAN)((CurrentReport->ModifierKeys & Mask) != 0);
+      HIDKey.Down    = HID_KEY_BITMAP_TEST (&CurrentKeys, HIDKey.KeyCode);
       Enqueue (&HidKeyboardDevice->HidKeyQueue, &HIDKey, sizeof (HID_KEY));
     }
   }
 
-  //
-  // Handle normal key's releasing situation
-  // Bytes 3 to n are for normal keycodes
-  //
-  KeyRelease = FALSE;
-  for (LastKeyCode = 0; LastKeyCode < LastReportKeyCount; LastKeyCode++) {
-    if (!HIDKBD_VALID_KEYCODE (LastReport->KeyCode[LastKeyCode])) {
-      continue;
-    }
-
-    //
-    // For any key in old keycode buffer, if it is not in current keycode buffer,
-    // then it is released. Otherwise, it is not released.
-    //
-    KeyRelease = TRUE;
-    for (KeyCode = 0; KeyCode < CurrentReportKeyCount; KeyCode++) {
-      if (!HIDKBD_VALID_KEYCODE (CurrentReport->KeyCode[KeyCode])) {
-        continue;
-      }
-
-      if (LastReport->KeyCode[LastKeyCode] == CurrentReport->KeyCode[KeyCode]) {
-        KeyRelease = FALSE;
-        break;
-      }
-    }
-
-    if (KeyRelease) {
-      HIDKey.KeyCode = LastReport->KeyCode[LastKeyCode];
-      HIDKey.Down    = FALSE;
-      //
-      // The original repeat key is released.
-      //
-      if (LastReport->KeyCode[LastKeyCode] == HidKeyboardDevice->RepeatKey) {
-        DEBUG ((DEBUG_VERBOSE, "HIDKeyboard: Resetting key repeat\n"));
-        HidKeyboardDevice->RepeatKey = 0;
-      }
-    }
-  }
+  Pressed.Bits[0xe0 >> 5] &= ~(UINT32)0xFF;
 
   //
   // If original repeat key is released, cancel the repeat timer
@@ -1030,70 +1146,63 @@ ProcessKeyStroke (
   }
 
   //
-  // Handle normal key's pressing situation
+  // Handle normal key's pressing situation. Keys reported by array fields are
+  // queued in report order, which is the order they were pressed; the rest
+  // (bitmap fields) follow in usage order.
   //
-  KeyPress = FALSE;
-  for (KeyCode = 0; KeyCode < CurrentReportKeyCount; KeyCode++) {
-    if (!HIDKBD_VALID_KEYCODE (CurrentReport->KeyCode[KeyCode])) {
-      continue;
-    }
-
-    //
-    // For any key in current keycode buffer, if it is not in old keycode buffer,
-    // then it is pressed. Otherwise, it is not pressed.
-    //
-    KeyPress = TRUE;
-    for (LastKeyCode = 0; LastKeyCode < LastReportKeyCount; LastKeyCode++) {
-      if (!HIDKBD_VALID_KEYCODE (LastReport->KeyCode[LastKeyCode])) {
+  Index = 0;
+  for ( ; ;) {
+    if (Index < KeyOrderCount) {
+      KeyCode = KeyOrder[Index++];
+      if (!HID_KEY_BITMAP_TEST (&Pressed, KeyCode)) {
         continue;
       }
+    } else {
+      Word = 0;
+      while ((Word < HID_KEY_BITMAP_WORDS) && (Pressed.Bits[Word] == 0)) {
+        Word++;
+      }
 
-      if (CurrentReport->KeyCode[KeyCode] == LastReport->KeyCode[LastKeyCode]) {
-        KeyPress = FALSE;
+      if (Word == HID_KEY_BITMAP_WORDS) {
         break;
       }
+
+      KeyCode = (UINT8)((Word << 5) + (UINTN)LowBitSet32 (Pressed.Bits[Word]));
     }
 
-    if (KeyPress) {
-      HIDKey.KeyCode = CurrentReport->KeyCode[KeyCode];
-      HIDKey.Down    = TRUE;
-      DEBUG ((DEBUG_VERBOSE, "HIDKeyboard: Enqueuing Key = %d, on KeyPress\n", HIDKey.KeyCode));
-      Enqueue (&HidKeyboardDevice->HidKeyQueue, &HIDKey, sizeof (HID_KEY));
+    Pressed.Bits[KeyCode >> 5] &= ~(1u << (KeyCode & 0x1F));
 
+    HIDKey.KeyCode = KeyCode;
+    HIDKey.Down    = TRUE;
+    DEBUG ((DEBUG_VERBOSE, "HIDKeyboard: Enqueuing Key = %d, on KeyPress\n", HIDKey.KeyCode));
+    Enqueue (&HidKeyboardDevice->HidKeyQueue, &HIDKey, sizeof (HID_KEY));
+
+    //
+    // Handle repeat key
+    //
+    KeyDescriptor = GetKeyDescriptor (HidKeyboardDevice, KeyCode);
+    if (KeyDescriptor == NULL) {
+      continue;
+    }
+
+    if ((KeyDescriptor->Modifier == EFI_NUM_LOCK_MODIFIER) || (KeyDescriptor->Modifier == EFI_CAPS_LOCK_MODIFIER)) {
       //
-      // Handle repeat key
+      // For NumLock or CapsLock pressed, there is no need to handle repeat key for them.
       //
-      KeyDescriptor = GetKeyDescriptor (HidKeyboardDevice, CurrentReport->KeyCode[KeyCode]);
-      if (KeyDescriptor == NULL) {
-        return;
-      }
-
-      if ((KeyDescriptor->Modifier == EFI_NUM_LOCK_MODIFIER) || (KeyDescriptor->Modifier == EFI_CAPS_LOCK_MODIFIER)) {
-        //
-        // For NumLock or CapsLock pressed, there is no need to handle repeat key for them.
-        //
-        HidKeyboardDevice->RepeatKey = 0;
-      } else {
-        //
-        // Prepare new repeat key, and clear the original one.
-        //
-        NewRepeatKey                 = CurrentReport->KeyCode[KeyCode];
-        HidKeyboardDevice->RepeatKey = 0;
-      }
+      HidKeyboardDevice->RepeatKey = 0;
+    } else {
+      //
+      // Prepare new repeat key, and clear the original one.
+      //
+      NewRepeatKey                 = KeyCode;
+      HidKeyboardDevice->RepeatKey = 0;
     }
   }
 
   //
-  // Copy the current report buffer as the last report buffer
+  // Keep the current key state for the next report
   //
-  FreePool (LastReport);
-  HidKeyboardDevice->LastReport = AllocateCopyPool (HidInputReportBufferSize, HidInputReportBuffer);
-  if (HidKeyboardDevice->LastReport == NULL) {
-    DEBUG ((DEBUG_ERROR, "[%a] - could not allocate last report buffer\n", __FUNCTION__));
-    HidKeyboardDevice->LastReportSize = 0;
-  } else {
-    HidKeyboardDevice->LastReportSize = HidInputReportBufferSize;
-  }
+  CopyMem (&HidKeyboardDevice->KeysDown, &CurrentKeys, sizeof (CurrentKeys));
 
   //
   // If there is new key pressed, update the RepeatKey value, and set the
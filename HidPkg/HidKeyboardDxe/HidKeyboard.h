@@ -96,6 +96,7 @@ ReleaseKeyboardLayoutResources (
   Initial processing of the HID key report. Processes and queues individual keys
   in the key report.
 
+  @param  *ReportTable              - compiled report descriptor describing the report.
   @param  *HidInputReportBuffer     - Pointer to the buffer containing HID key report.
   @param  HidInputReportBufferSize  - gives the size of the input report buffer.
   @param  *HidKeyboardDevice        - pointer to HID_KB_DEV struct.
@@ -105,9 +106,40 @@ ReleaseKeyboardLayoutResources (
 **/
 VOID
 ProcessKeyStroke (
-  IN UINT8       *HidInputReportBuffer,
-  IN UINTN       HidInputReportBufferSize,
-  IN HID_KB_DEV  *HidKeyboardDevice
+  IN CONST HID_REPORT_TABLE  *ReportTable,
+  IN UINT8                   *HidInputReportBuffer,
+  IN UINTN                   HidInputReportBufferSize,
+  IN HID_KB_DEV              *HidKeyboardDevice
+  );
+
+/**
+  Compile the report descriptor of a keyboard that provides
+  HID_REPORT_DESCRIPTOR_PROTOCOL, so that its ReportKeyboard reports can be decoded.
+
+  @param  HidKeyboardDevice          The HID_KB_DEV instance.
+  @param  ReportDescriptorProtocol   The report descriptor protocol of the device.
+
+  @retval EFI_SUCCESS                The report table was built.
+  @retval EFI_OUT_OF_RESOURCES       Out of memory.
+  @retval Other                      The descriptor could not be retrieved or does not
+                                     describe a usable keyboard.
+
+**/
+EFI_STATUS
+InitKeyboardReportTable (
+  IN OUT HID_KB_DEV                      *HidKeyboardDevice,
+  IN     HID_REPORT_DESCRIPTOR_PROTOCOL  *ReportDescriptorProtocol
+  );
+
+/**
+  Get the report table used to decode BootKeyboard reports.
+
+  @return The compiled boot keyboard report table, or NULL on failure.
+
+**/
+CONST HID_REPORT_TABLE *
+GetBootKeyboardReportTable (
+  VOID
   );
 
 /**
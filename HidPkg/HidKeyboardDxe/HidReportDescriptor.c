@@ -0,0 +1,857 @@
+/** @file HidReportDescriptor.c
+
+  HID report descriptor compiler and keyboard input report decoder.
+
+  The descriptor is walked once, tracking the global item stack and local usages
+  as described in HID 1.11 section 6.2.2, and every keyboard input main item is
+  reduced to a HID_REPORT_FIELD. Decoding an input report is then a walk over
+  the fields of its report ID, with no further descriptor parsing.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "HidReportDescriptor.h"
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+
+//
+// Item prefix layout: bits 7-4 tag, bits 3-2 type, bits 1-0 size (3 means 4 bytes).
+//
+#define HID_ITEM_LONG_PREFIX  0xFE
+#define HID_ITEM_DATA_SIZE(Prefix)  ((((Prefix) & 0x03) == 0x03) ? 4 : ((Prefix) & 0x03))
+#define HID_ITEM_TYPE(Prefix)       (((Prefix) >> 2) & 0x03)
+#define HID_ITEM_TAG(Prefix)        ((Prefix) >> 4)
+
+#define HID_ITEM_TYPE_MAIN    0
+#define HID_ITEM_TYPE_GLOBAL  1
+#define HID_ITEM_TYPE_LOCAL   2
+
+#define HID_MAIN_INPUT           0x8
+#define HID_MAIN_OUTPUT          0x9
+#define HID_MAIN_COLLECTION      0xA
+#define HID_MAIN_FEATURE         0xB
+#define HID_MAIN_END_COLLECTION  0xC
+
+#define HID_GLOBAL_USAGE_PAGE    0x0
+#define HID_GLOBAL_LOGICAL_MIN   0x1
+#define HID_GLOBAL_LOGICAL_MAX   0x2
+#define HID_GLOBAL_REPORT_SIZE   0x7
+#define HID_GLOBAL_REPORT_ID     0x8
+#define HID_GLOBAL_REPORT_COUNT  0x9
+#define HID_GLOBAL_PUSH          0xA
+#define HID_GLOBAL_POP           0xB
+
+#define HID_LOCAL_USAGE      0x0
+#define HID_LOCAL_USAGE_MIN  0x1
+#define HID_LOCAL_USAGE_MAX  0x2
+
+//
+// Input item data bits
+//
+#define HID_INPUT_CONSTANT  BIT0
+#define HID_INPUT_VARIABLE  BIT1
+
+#define HID_GLOBAL_STACK_DEPTH    4
+#define HID_MAX_COLLECTION_DEPTH  32
+#define HID_MAX_REPORT_SIZE       32
+#define HID_MAX_ARRAY_SIZE        16
+
+typedef struct {
+  UINT32    UsagePage;
+  INT32     LogicalMinimum;
+  INT32     LogicalMaximum;
+  UINT32    LogicalMaximumRaw;
+  UINT32    ReportSize;
+  UINT32    ReportCount;
+  UINT8     ReportId;
+} HID_GLOBAL_STATE;
+
+//
+// Usages are kept as received: either a 16-bit usage on the current usage page,
+// or a 32-bit extended usage carrying its own page in the upper 16 bits.
+//
+typedef struct {
+  UINT32    Minimum;
+  UINT32    Maximum;
+} HID_USAGE_RANGE;
+
+typedef struct {
+  HID_USAGE_RANGE    Range[HID_REPORT_MAX_USAGES];
+  UINTN              RangeCount;
+  UINT32             PendingMinimum;
+  BOOLEAN            HasPendingMinimum;
+} HID_LOCAL_STATE;
+
+/**
+  Set the bits for usages First through Last in a key bitmap.
+
+  @param  Bitmap   The key bitmap.
+  @param  First    The first usage.
+  @param  Last     The last usage, inclusive.
+
+**/
+STATIC
+VOID
+SetUsageRange (
+  IN OUT HID_KEY_BITMAP  *Bitmap,
+  IN     UINT8           First,
+  IN     UINT8           Last
+  )
+{
+  UINTN  Usage;
+
+  for (Usage = First; Usage <= Last; Usage++) {
+    Bitmap->Bits[Usage >> 5] |= 1u << (Usage & 0x1F);
+  }
+}
+
+/**
+  Append a usage range to the local state, merging it with the previous range
+  when the two are contiguous.
+
+  @param  Local     The local item state.
+  @param  Minimum   First usage of the range.
+  @param  Maximum   Last usage of the range.
+
+  @retval EFI_SUCCESS           The range was added.
+  @retval EFI_INVALID_PARAMETER Minimum is greater than Maximum.
+  @retval EFI_OUT_OF_RESOURCES  Too many disjoint usages for one main item.
+
+**/
+STATIC
+EFI_STATUS
+AddUsageRange (
+  IN OUT HID_LOCAL_STATE  *Local,
+  IN     UINT32           Minimum,
+  IN     UINT32           Maximum
+  )
+{
+  HID_USAGE_RANGE  *Last;
+
+  if (Minimum > Maximum) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Local->RangeCount > 0) {
+    Last = &Local->Range[Local->RangeCount - 1];
+    if ((Last->Maximum != MAX_UINT32) && (Last->Maximum + 1 == Minimum)) {
+      Last->Maximum = Maximum;
+      return EFI_SUCCESS;
+    }
+  }
+
+  if (Local->RangeCount >= HID_REPORT_MAX_USAGES) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Local->Range[Local->RangeCount].Minimum = Minimum;
+  Local->Range[Local->RangeCount].Maximum = Maximum;
+  Local->RangeCount++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Record a keyboard input field in the table.
+
+  @retval EFI_SUCCESS           The field was added.
+  @retval EFI_OUT_OF_RESOURCES  The field table is full.
+
+**/
+STATIC
+EFI_STATUS
+AddField (
+  IN OUT HID_REPORT_TABLE  *Table,
+  IN     UINT8             ReportId,
+  IN     UINT32            BitOffset,
+  IN     UINT32            ReportSize,
+  IN     UINT8             Flags,
+  IN     UINT32            ReportCount,
+  IN     UINT8             UsageMinimum,
+  IN     UINT8             UsageMaximum,
+  IN     INT32             LogicalMinimum,
+  IN     INT32             LogicalMaximum
+  )
+{
+  HID_REPORT_FIELD  *Field;
+
+  if (Table->FieldCount >= HID_REPORT_MAX_FIELDS) {
+    DEBUG ((DEBUG_ERROR, "[%a] - too many keyboard fields in report descriptor.\n", __FUNCTION__));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Field                 = &Table->Field[Table->FieldCount++];
+  Field->ReportId       = ReportId;
+  Field->BitOffset      = (UINT16)BitOffset;
+  Field->ReportSize     = (UINT8)ReportSize;
+  Field->Flags          = Flags;
+  Field->ReportCount    = (UINT16)ReportCount;
+  Field->UsageMinimum   = UsageMinimum;
+  Field->UsageMaximum   = UsageMaximum;
+  Field->LogicalMinimum = LogicalMinimum;
+  Field->LogicalMaximum = LogicalMaximum;
+  return EFI_SUCCESS;
+}
+
+/**
+  Process an Input main item.
+
+  @param  Table       The table being compiled.
+  @param  Global      The current global item state.
+  @param  Local       The local items preceding the Input item.
+  @param  ItemData    The Input item data bits.
+  @param  InputBits   Running input report sizes in bits, indexed by report ID.
+
+  @retval EFI_SUCCESS           The item was processed.
+  @retval EFI_INVALID_PARAMETER The item is malformed.
+  @retval EFI_OUT_OF_RESOURCES  The report or field table limits were exceeded.
+
+**/
+STATIC
+EFI_STATUS
+AddInputItem (
+  IN OUT HID_REPORT_TABLE        *Table,
+  IN     CONST HID_GLOBAL_STATE  *Global,
+  IN     CONST HID_LOCAL_STATE   *Local,
+  IN     UINT32                  ItemData,
+  IN OUT UINT16                  *InputBits
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      BitOffset;
+  UINT32      TotalBits;
+  UINT32      Remaining;
+  UINT32      Span;
+  UINT32      KeyCount;
+  UINT32      Page;
+  UINT32      Minimum;
+  UINT32      Maximum;
+  INT32       LogicalMaximum;
+  UINTN       Index;
+
+  if ((Global->ReportSize > HID_MAX_REPORT_SIZE) || (Global->ReportCount > MAX_UINT16)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  BitOffset = InputBits[Global->ReportId];
+  TotalBits = Global->ReportSize * Global->ReportCount;
+  if (BitOffset + TotalBits > MAX_UINT16) {
+    DEBUG ((DEBUG_ERROR, "[%a] - input report %d is too large.\n", __FUNCTION__, Global->ReportId));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  InputBits[Global->ReportId] = (UINT16)(BitOffset + TotalBits);
+
+  if (((ItemData & HID_INPUT_CONSTANT) != 0) || (TotalBits == 0)) {
+    return EFI_SUCCESS;
+  }
+
+  if ((ItemData & HID_INPUT_VARIABLE) != 0) {
+    //
+    // One report item per usage. Only one bit keys are of interest; items past
+    // the end of the usage list repeat the last usage and are ignored.
+    //
+    if (Global->ReportSize != 1) {
+      return EFI_SUCCESS;
+    }
+
+    Remaining = Global->ReportCount;
+    for (Index = 0; (Index < Local->RangeCount) && (Remaining > 0); Index++) {
+      Minimum = Local->Range[Index].Minimum;
+      Maximum = Local->Range[Index].Maximum;
+      Page    = ((Minimum >> 16) != 0) ? (Minimum >> 16) : Global->UsagePage;
+      Minimum = Minimum & MAX_UINT16;
+      Maximum = Maximum & MAX_UINT16;
+      if (Maximum < Minimum) {
+        return EFI_INVALID_PARAMETER;
+      }
+
+      Span = MIN (Maximum - Minimum + 1, Remaining);
+
+      if ((Page == HID_USAGE_PAGE_KEYBOARD) && (Minimum <= MAX_UINT8)) {
+        KeyCount = MIN (Span, 0x100 - Minimum);
+        Status   = AddField (
+                     Table,
+                     Global->ReportId,
+                     BitOffset,
+                     1,
+                     0,
+                     KeyCount,
+                     (UINT8)Minimum,
+                     (UINT8)(Minimum + KeyCount - 1),
+                     0,
+                     1
+                     );
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+      }
+
+      BitOffset += Span;
+      Remaining -= Span;
+    }
+
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Array item: each element holds an index into a single usage range.
+  //
+  if (Local->RangeCount != 1) {
+    DEBUG ((DEBUG_VERBOSE, "[%a] - skipping array item with %d usage ranges.\n", __FUNCTION__, Local->RangeCount));
+    return EFI_SUCCESS;
+  }
+
+  Minimum = Local->Range[0].Minimum;
+  Maximum = Local->Range[0].Maximum;
+  Page    = ((Minimum >> 16) != 0) ? (Minimum >> 16) : Global->UsagePage;
+  Minimum = Minimum & MAX_UINT16;
+  Maximum = Maximum & MAX_UINT16;
+  if (Maximum < Minimum) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((Page != HID_USAGE_PAGE_KEYBOARD) || (Minimum > MAX_UINT8) || (Global->ReportSize > HID_MAX_ARRAY_SIZE)) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Descriptors commonly encode an unsigned 8-bit Logical Maximum as one signed
+  // byte (0x25 0xFF). Read it as unsigned when the minimum is not negative.
+  //
+  LogicalMaximum = Global->LogicalMaximum;
+  if ((Global->LogicalMinimum >= 0) && (LogicalMaximum < 0)) {
+    LogicalMaximum = (INT32)MIN (Global->LogicalMaximumRaw, (UINT32)MAX_INT32);
+  }
+
+  if (LogicalMaximum < Global->LogicalMinimum) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return AddField (
+           Table,
+           Global->ReportId,
+           BitOffset,
+           Global->ReportSize,
+           HID_REPORT_FIELD_ARRAY,
+           Global->ReportCount,
+           (UINT8)Minimum,
+           (UINT8)MIN (Maximum, MAX_UINT8),
+           Global->LogicalMinimum,
+           LogicalMaximum
+           );
+}
+
+/**
+  Group the compiled fields by report ID and compute the usage coverage of
+  each report.
+
+  @param  Table       The table being compiled.
+  @param  InputBits   Input report sizes in bits, indexed by report ID.
+
+  @retval EFI_SUCCESS           The reports were built.
+  @retval EFI_INVALID_PARAMETER Report IDs are used but a keyboard field has none.
+  @retval EFI_OUT_OF_RESOURCES  Too many keyboard reports.
+
+**/
+STATIC
+EFI_STATUS
+BuildReports (
+  IN OUT HID_REPORT_TABLE  *Table,
+  IN     CONST UINT16      *InputBits
+  )
+{
+  HID_REPORT_FIELD  Field;
+  HID_REPORT_INFO   *Report;
+  UINTN             Index;
+  UINTN             Index2;
+
+  //
+  // Stable insertion sort so fields keep descriptor order within a report.
+  //
+  for (Index = 1; Index < Table->FieldCount; Index++) {
+    CopyMem (&Field, &Table->Field[Index], sizeof (Field));
+    for (Index2 = Index; (Index2 > 0) && (Table->Field[Index2 - 1].ReportId > Field.ReportId); Index2--) {
+      CopyMem (&Table->Field[Index2], &Table->Field[Index2 - 1], sizeof (Field));
+    }
+
+    CopyMem (&Table->Field[Index2], &Field, sizeof (Field));
+  }
+
+  Report = NULL;
+  for (Index = 0; Index < Table->FieldCount; Index++) {
+    if (Table->UsesReportIds && (Table->Field[Index].ReportId == 0)) {
+      DEBUG ((DEBUG_ERROR, "[%a] - keyboard field outside of any report ID.\n", __FUNCTION__));
+      return EFI_INVALID_PARAMETER;
+    }
+
+    if ((Report == NULL) || (Report->ReportId != Table->Field[Index].ReportId)) {
+      if (Table->ReportCount >= HID_REPORT_MAX_REPORTS) {
+        DEBUG ((DEBUG_ERROR, "[%a] - too many keyboard reports in report descriptor.\n", __FUNCTION__));
+        return EFI_OUT_OF_RESOURCES;
+      }
+
+      Report             = &Table->Report[Table->ReportCount++];
+      Report->ReportId   = Table->Field[Index].ReportId;
+      Report->FirstField = (UINT8)Index;
+      Report->SizeInBits = InputBits[Report->ReportId];
+    }
+
+    Report->FieldCount++;
+    if (Table->Field[Index].UsageMaximum >= HID_KEYBOARD_USAGE_FIRST_KEY) {
+      SetUsageRange (
+        &Report->Coverage,
+        MAX (Table->Field[Index].UsageMinimum, HID_KEYBOARD_USAGE_FIRST_KEY),
+        Table->Field[Index].UsageMaximum
+        );
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Compile a HID report descriptor into a keyboard report table.
+
+  Only input fields on the keyboard usage page are recorded; every other input
+  item (constant padding, consumer control, vendor data...) only advances the
+  bit offset of its report.
+
+  @param  ReportDescriptor      Pointer to the report descriptor.
+  @param  ReportDescriptorSize  Size of the report descriptor in bytes.
+  @param  Table                 Receives the compiled table.
+
+  @retval EFI_SUCCESS           The descriptor was compiled.
+  @retval EFI_INVALID_PARAMETER A parameter is NULL or the descriptor is malformed.
+  @retval EFI_OUT_OF_RESOURCES  The descriptor exceeds the limits of HID_REPORT_TABLE.
+  @retval EFI_UNSUPPORTED       The descriptor does not describe any keyboard input field.
+
+**/
+EFI_STATUS
+HidCompileReportDescriptor (
+  IN  CONST UINT8       *ReportDescriptor,
+  IN  UINTN             ReportDescriptorSize,
+  OUT HID_REPORT_TABLE  *Table
+  )
+{
+  EFI_STATUS        Status;
+  HID_GLOBAL_STATE  Global;
+  HID_GLOBAL_STATE  GlobalStack[HID_GLOBAL_STACK_DEPTH];
+  UINTN             GlobalStackDepth;
+  HID_LOCAL_STATE   Local;
+  UINT16            InputBits[MAX_UINT8 + 1];
+  UINTN             CollectionDepth;
+  UINTN             Index;
+  UINTN             DataIndex;
+  UINT8             Prefix;
+  UINT8             DataSize;
+  UINT32            Data;
+  INT32             SignedData;
+
+  if ((ReportDescriptor == NULL) || (Table == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Table, sizeof (*Table));
+  ZeroMem (&Global, sizeof (Global));
+  ZeroMem (&Local, sizeof (Local));
+  ZeroMem (InputBits, sizeof (InputBits));
+  GlobalStackDepth = 0;
+  CollectionDepth  = 0;
+
+  Index = 0;
+  while (Index < ReportDescriptorSize) {
+    Prefix = ReportDescriptor[Index];
+
+    //
+    // Long items carry no information the keyboard driver uses; skip them.
+    //
+    if (Prefix == HID_ITEM_LONG_PREFIX) {
+      if ((ReportDescriptorSize - Index < 3) || (ReportDescriptorSize - Index - 3 < ReportDescriptor[Index + 1])) {
+        return EFI_INVALID_PARAMETER;
+      }
+
+      Index += 3 + ReportDescriptor[Index + 1];
+      continue;
+    }
+
+    DataSize = HID_ITEM_DATA_SIZE (Prefix);
+    if (ReportDescriptorSize - Index - 1 < DataSize) {
+      DEBUG ((DEBUG_ERROR, "[%a] - truncated item at offset %d.\n", __FUNCTION__, Index));
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Data = 0;
+    for (DataIndex = 0; DataIndex < DataSize; DataIndex++) {
+      Data |= (UINT32)ReportDescriptor[Index + 1 + DataIndex] << (8 * DataIndex);
+    }
+
+    switch (DataSize) {
+      case 1:
+        SignedData = (INT8)Data;
+        break;
+      case 2:
+        SignedData = (INT16)Data;
+        break;
+      default:
+        SignedData = (INT32)Data;
+        break;
+    }
+
+    Index += 1 + DataSize;
+
+    switch (HID_ITEM_TYPE (Prefix)) {
+      case HID_ITEM_TYPE_MAIN:
+        switch (HID_ITEM_TAG (Prefix)) {
+          case HID_MAIN_INPUT:
+            Status = AddInputItem (Table, &Global, &Local, Data, InputBits);
+            if (EFI_ERROR (Status)) {
+              return Status;
+            }
+
+            break;
+          case HID_MAIN_COLLECTION:
+            if (++CollectionDepth > HID_MAX_COLLECTION_DEPTH) {
+              return EFI_INVALID_PARAMETER;
+            }
+
+            break;
+          case HID_MAIN_END_COLLECTION:
+            if (CollectionDepth == 0) {
+              DEBUG ((DEBUG_ERROR, "[%a] - unbalanced End Collection.\n", __FUNCTION__));
+              return EFI_INVALID_PARAMETER;
+            }
+
+            CollectionDepth--;
+            break;
+          case HID_MAIN_OUTPUT:
+          case HID_MAIN_FEATURE:
+            break;
+          default:
+            return EFI_INVALID_PARAMETER;
+        }
+
+        //
+        // Local items only apply to the main item that follows them.
+        //
+        ZeroMem (&Local, sizeof (Local));
+        break;
+
+      case HID_ITEM_TYPE_GLOBAL:
+        switch (HID_ITEM_TAG (Prefix)) {
+          case HID_GLOBAL_USAGE_PAGE:
+            Global.UsagePage = Data;
+            break;
+          case HID_GLOBAL_LOGICAL_MIN:
+            Global.LogicalMinimum = SignedData;
+            break;
+          case HID_GLOBAL_LOGICAL_MAX:
+            Global.LogicalMaximum    = SignedData;
+            Global.LogicalMaximumRaw = Data;
+            break;
+          case HID_GLOBAL_REPORT_SIZE:
+            Global.ReportSize = Data;
+            break;
+          case HID_GLOBAL_REPORT_ID:
+            if ((Data == 0) || (Data > MAX_UINT8)) {
+              return EFI_INVALID_PARAMETER;
+            }
+
+            Global.ReportId      = (UINT8)Data;
+            Table->UsesReportIds = TRUE;
+            break;
+          case HID_GLOBAL_REPORT_COUNT:
+            Global.ReportCount = Data;
+            break;
+          case HID_GLOBAL_PUSH:
+            if (GlobalStackDepth >= HID_GLOBAL_STACK_DEPTH) {
+              return EFI_OUT_OF_RESOURCES;
+            }
+
+            CopyMem (&GlobalStack[GlobalStackDepth++], &Global, sizeof (Global));
+            break;
+          case HID_GLOBAL_POP:
+            if (GlobalStackDepth == 0) {
+              return EFI_INVALID_PARAMETER;
+            }
+
+            CopyMem (&Global, &GlobalStack[--GlobalStackDepth], sizeof (Global));
+            break;
+          default:
+            //
+            // Physical extents, units and reserved tags do not affect report layout.
+            //
+            break;
+        }
+
+        break;
+
+      case HID_ITEM_TYPE_LOCAL:
+        switch (HID_ITEM_TAG (Prefix)) {
+          case HID_LOCAL_USAGE:
+            Status = AddUsageRange (&Local, Data, Data);
+            if (EFI_ERROR (Status)) {
+              return Status;
+            }
+
+            break;
+          case HID_LOCAL_USAGE_MIN:
+            Local.PendingMinimum    = Data;
+            Local.HasPendingMinimum = TRUE;
+            break;
+          case HID_LOCAL_USAGE_MAX:
+            if (Local.HasPendingMinimum) {
+              Status = AddUsageRange (&Local, Local.PendingMinimum, Data);
+              if (EFI_ERROR (Status)) {
+                return Status;
+              }
+
+              Local.HasPendingMinimum = FALSE;
+            }
+
+            break;
+          default:
+            break;
+        }
+
+        break;
+
+      default:
+        return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  if (CollectionDepth != 0) {
+    DEBUG ((DEBUG_ERROR, "[%a] - unterminated collection.\n", __FUNCTION__));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Table->FieldCount == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  return BuildReports (Table, InputBits);
+}
+
+/**
+  Read an unsigned little endian bit field of up to 32 bits.
+
+  @param  Data       The report payload.
+  @param  BitOffset  Offset of the first bit.
+  @param  BitCount   Number of bits to read.
+
+  @return The field value.
+
+**/
+STATIC
+UINT32
+ReadBits (
+  IN CONST UINT8  *Data,
+  IN UINTN        BitOffset,
+  IN UINTN        BitCount
+  )
+{
+  UINT32  Value;
+  UINTN   Shift;
+  UINTN   Take;
+  UINTN   Done;
+
+  Value = 0;
+  for (Done = 0; Done < BitCount; Done += Take) {
+    Shift  = BitOffset & 7;
+    Take   = MIN (8 - Shift, BitCount - Done);
+    Value |= (UINT32)((Data[BitOffset >> 3] >> Shift) & ((1u << Take) - 1)) << Done;
+    BitOffset += Take;
+  }
+
+  return Value;
+}
+
+/**
+  Decode an input report with a compiled table and update the pressed key bitmap.
+
+  Usages reported by the report are replaced with the report contents; usages
+  the report does not cover keep their previous state. Array fields reporting
+  ErrorRollOver keep the previous state of all their usages.
+
+  @param  Table           Compiled report table.
+  @param  Report          The input report, including the report ID byte if the
+                          table uses report IDs.
+  @param  ReportSize      Size of Report in bytes.
+  @param  KeysDown        On input, the keys down before the report. On output,
+                          the keys down after the report.
+  @param  KeyOrder        Optional. Receives the usages reported by array fields
+                          in report order, which is the order they were pressed.
+  @param  KeyOrderCount   Optional. On input, the capacity of KeyOrder. On output,
+                          the number of entries written.
+
+  @retval EFI_SUCCESS           KeysDown was updated.
+  @retval EFI_INVALID_PARAMETER A required parameter is NULL, ReportSize is 0, or the
+                                report is only a report ID. KeysDown is unchanged.
+  @retval EFI_NOT_FOUND         The report does not carry keyboard fields. KeysDown
+                                is unchanged.
+
+**/
+EFI_STATUS
+HidExtractKeyboardReport (
+  IN     CONST HID_REPORT_TABLE  *Table,
+  IN     CONST UINT8             *Report,
+  IN     UINTN                   ReportSize,
+  IN OUT HID_KEY_BITMAP          *KeysDown,
+  OUT    UINT8                   *KeyOrder       OPTIONAL,
+  IN OUT UINTN                   *KeyOrderCount  OPTIONAL
+  )
+{
+  CONST HID_REPORT_INFO   *Info;
+  CONST HID_REPORT_FIELD  *Field;
+  CONST UINT8             *Data;
+  HID_KEY_BITMAP          Extracted;
+  HID_KEY_BITMAP          RollOver;
+  UINTN                   AvailableBits;
+  UINTN                   OrderCapacity;
+  UINTN                   OrderCount;
+  UINTN                   Count;
+  UINTN                   Index;
+  UINTN                   Element;
+  UINTN                   Usage;
+  UINT32                  Bits;
+  UINT32                  Mask;
+  INT32                   Value;
+  BOOLEAN                 FieldRollOver;
+
+  if ((Table == NULL) || (Report == NULL) || (ReportSize == 0) || (KeysDown == NULL) ||
+      ((KeyOrder != NULL) && (KeyOrderCount == NULL)))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OrderCapacity = (KeyOrder != NULL) ? *KeyOrderCount : 0;
+  OrderCount    = 0;
+  if (KeyOrderCount != NULL) {
+    *KeyOrderCount = 0;
+  }
+
+  Info = NULL;
+  Data = Report;
+  if (Table->UsesReportIds) {
+    //
+    // A report ID with no payload covers no field. Decoding it would release every
+    // key of the report.
+    //
+    if (ReportSize == 1) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Data++;
+    ReportSize--;
+  }
+
+  for (Index = 0; Index < Table->ReportCount; Index++) {
+    if (!Table->UsesReportIds || (Table->Report[Index].ReportId == Report[0])) {
+      Info = &Table->Report[Index];
+      break;
+    }
+  }
+
+  if (Info == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  ZeroMem (&Extracted, sizeof (Extracted));
+  ZeroMem (&RollOver, sizeof (RollOver));
+  AvailableBits = ReportSize * 8;
+
+  for (Field = &Table->Field[Info->FirstField]; Field < &Table->Field[Info->FirstField + Info->FieldCount]; Field++) {
+    if (Field->BitOffset >= AvailableBits) {
+      continue;
+    }
+
+    if ((Field->Flags & HID_REPORT_FIELD_ARRAY) == 0) {
+      //
+      // One bit per usage. Byte aligned bitmaps (boot modifiers, NKRO) are read a
+      // byte at a time and only set bits are visited.
+      //
+      Count = MIN (Field->ReportCount, AvailableBits - Field->BitOffset);
+      for (Index = 0; Index < Count; Index += 8) {
+        if ((Field->BitOffset & 7) == 0) {
+          Bits = Data[(Field->BitOffset + Index) >> 3];
+        } else {
+          Bits = ReadBits (Data, Field->BitOffset + Index, MIN (8, Count - Index));
+        }
+
+        if (Count - Index < 8) {
+          Bits &= (1u << (Count - Index)) - 1;
+        }
+
+        while (Bits != 0) {
+          Usage = Field->UsageMinimum + Index + (UINTN)LowBitSet32 (Bits);
+          if (Usage >= HID_KEYBOARD_USAGE_FIRST_KEY) {
+            Extracted.Bits[Usage >> 5] |= 1u << (Usage & 0x1F);
+          }
+
+          Bits &= Bits - 1;
+        }
+      }
+
+      continue;
+    }
+
+    //
+    // Array of usage indices, in the order the keys were pressed.
+    //
+    Count = (AvailableBits - Field->BitOffset) / Field->ReportSize;
+    if ((Field->Flags & HID_REPORT_FIELD_FILL_REPORT) == 0) {
+      Count = MIN (Count, Field->ReportCount);
+    }
+
+    FieldRollOver = FALSE;
+    for (Element = 0; Element < Count; Element++) {
+      Bits = ReadBits (Data, Field->BitOffset + Element * Field->ReportSize, Field->ReportSize);
+      if ((Field->LogicalMinimum < 0) && ((Bits & (1u << (Field->ReportSize - 1))) != 0)) {
+        Bits |= ~((1u << (Field->ReportSize - 1)) - 1);
+      }
+
+      Value = (INT32)Bits;
+      if ((Value < Field->LogicalMinimum) || (Value > Field->LogicalMaximum)) {
+        continue;
+      }
+
+      Usage = Field->UsageMinimum + (UINTN)((INT64)Value - Field->LogicalMinimum);
+      if (Usage > Field->UsageMaximum) {
+        continue;
+      }
+
+      if (Usage == HID_KEYBOARD_USAGE_ERROR_ROLL_OVER) {
+        FieldRollOver = TRUE;
+        continue;
+      }
+
+      if ((Usage < HID_KEYBOARD_USAGE_FIRST_KEY) || HID_KEY_BITMAP_TEST (&Extracted, Usage)) {
+        continue;
+      }
+
+      Extracted.Bits[Usage >> 5] |= 1u << (Usage & 0x1F);
+      if (OrderCount < OrderCapacity) {
+        KeyOrder[OrderCount++] = (UINT8)Usage;
+      }
+    }
+
+    if (FieldRollOver) {
+      SetUsageRange (&RollOver, Field->UsageMinimum, Field->UsageMaximum);
+    }
+  }
+
+  for (Index = 0; Index < HID_KEY_BITMAP_WORDS; Index++) {
+    Mask                  = Info->Coverage.Bits[Index] & ~RollOver.Bits[Index];
+    KeysDown->Bits[Index] = (KeysDown->Bits[Index] & ~Mask) | (Extracted.Bits[Index] & Mask);
+  }
+
+  if (KeyOrderCount != NULL) {
+    *KeyOrderCount = OrderCount;
+  }
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/** @file HidReportDescriptor.h
+
+  HID report descriptor compiler for the HID keyboard driver.
+
+  A report descriptor is parsed once into a table of keyboard (usage page 0x07)
+  input fields per report ID. Input reports are then decoded by walking that
+  table into a 256-bit bitmap of pressed usages, which supports boot reports,
+  N-key rollover bitmap reports and devices with several top level collections.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+  Spec:
+    Refer to USB Device Class Definition for Human Interface Devices (HID) version 1.11
+    section 6.2.2 (Report Descriptor) and Appendix B.1.
+
+**/
+
+#ifndef _HID_REPORT_DESCRIPTOR_H_
+#define _HID_REPORT_DESCRIPTOR_H_
+
+#include <Uefi.h>
+
+#define HID_USAGE_PAGE_KEYBOARD  0x07
+
+//
+// Keyboard usages 0x00 - 0x03 are "no event", ErrorRollOver, POSTFail and ErrorUndefined.
+//
+#define HID_KEYBOARD_USAGE_ERROR_ROLL_OVER  0x01
+#define HID_KEYBOARD_USAGE_FIRST_KEY        0x04
+
+#define HID_KEY_BITMAP_WORDS  8
+
+#define HID_REPORT_MAX_REPORTS  8
+#define HID_REPORT_MAX_FIELDS   32
+#define HID_REPORT_MAX_USAGES   16
+
+//
+// HID_REPORT_FIELD.Flags
+//
+#define HID_REPORT_FIELD_ARRAY        BIT0    // Each element carries a usage index rather than one bit per usage.
+#define HID_REPORT_FIELD_FILL_REPORT  BIT1    // Array elements continue up to the end of the received report.
+
+///
+/// One bit per keyboard usage, set while the key is down.
+///
+typedef struct {
+  UINT32    Bits[HID_KEY_BITMAP_WORDS];
+} HID_KEY_BITMAP;
+
+#define HID_KEY_BITMAP_TEST(Bitmap, Usage)  \
+  ((((Bitmap)->Bits[(UINT8)(Usage) >> 5]) & (1u << ((UINT8)(Usage) & 0x1F))) != 0)
+
+///
+/// A keyboard input field of a report. BitOffset is relative to the first byte
+/// following the report ID (if any).
+///
+typedef struct {
+  UINT16    BitOffset;
+  UINT8     ReportSize;
+  UINT8     Flags;
+  UINT16    ReportCount;
+  UINT8     UsageMinimum;
+  UINT8     UsageMaximum;
+  INT32     LogicalMinimum;
+  INT32     LogicalMaximum;
+  UINT8     ReportId;
+} HID_REPORT_FIELD;
+
+///
+/// An input report carrying keyboard fields, with the usages it reports on.
+///
+typedef struct {
+  UINT8             ReportId;
+  UINT8             FirstField;
+  UINT8             FieldCount;
+  UINT32            SizeInBits;
+  HID_KEY_BITMAP    Coverage;
+} HID_REPORT_INFO;
+
+///
+/// Compiled report descriptor.
+///
+typedef struct {
+  BOOLEAN             UsesReportIds;
+  UINT8               ReportCount;
+  UINT8               FieldCount;
+  HID_REPORT_INFO     Report[HID_REPORT_MAX_REPORTS];
+  HID_REPORT_FIELD    Field[HID_REPORT_MAX_FIELDS];
+} HID_REPORT_TABLE;
+
+/**
+  Compile a HID report descriptor into a keyboard report table.
+
+  Only input fields on the keyboard usage page are recorded; every other input
+  item (constant padding, consumer control, vendor data...) only advances the
+  bit offset of its report.
+
+  @param  ReportDescriptor      Pointer to the report descriptor.
+  @param  ReportDescriptorSize  Size of the report descriptor in bytes.
+  @param  Table                 Receives the compiled table.
+
+  @retval EFI_SUCCESS           The descriptor was compiled.
+  @retval EFI_INVALID_PARAMETER A parameter is NULL or the descriptor is malformed.
+  @retval EFI_OUT_OF_RESOURCES  The descriptor exceeds the limits of HID_REPORT_TABLE.
+  @retval EFI_UNSUPPORTED       The descriptor does not describe any keyboard input field.
+
+**/
+EFI_STATUS
+HidCompileReportDescriptor (
+  IN  CONST UINT8       *ReportDescriptor,
+  IN  UINTN             ReportDescriptorSize,
+  OUT HID_REPORT_TABLE  *Table
+  );
+
+/**
+  Decode an input report with a compiled table and update the pressed key bitmap.
+
+  Usages reported by the report are replaced with the report contents; usages
+  the report does not cover keep their previous state. Array fields reporting
+  ErrorRollOver keep the previous state of all their usages.
+
+  @param  Table           Compiled report table.
+  @param  Report          The input report, including the report ID byte if the
+                          table uses report IDs.
+  @param  ReportSize      Size of Report in bytes.
+  @param  KeysDown        On input, the keys down before the report. On output,
+                          the keys down after the report.
+  @param  KeyOrder        Optional. Receives the usages reported by array fields
+                          in report order, which is the order they were pressed.
+  @param  KeyOrderCount   Optional. On input, the capacity of KeyOrder. On output,
+                          the number of entries written.
+
+  @retval EFI_SUCCESS           KeysDown was updated.
+  @retval EFI_INVALID_PARAMETER A required parameter is NULL or ReportSize is 0.
+  @retval EFI_NOT_FOUND         The report does not carry keyboard fields. KeysDown
+                                is unchanged.
+
+**/
+EFI_STATUS
+HidExtractKeyboardReport (
+  IN     CONST HID_REPORT_TABLE  *Table,
+  IN     CONST UINT8             *Report,
+  IN     UINTN                   ReportSize,
+  IN OUT HID_KEY_BITMAP          *KeysDown,
+  OUT    UINT8                   *KeyOrder       OPTIONAL,
+  IN OUT UINTN                   *KeyOrderCount  OPTIONAL
+  );
+
+#endif // _HID_REPORT_DESCRIPTOR_H_
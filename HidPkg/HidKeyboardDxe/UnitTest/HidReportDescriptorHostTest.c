@@ -0,0 +1,708 @@
+/** @file
+  This module tests the HID report descriptor compiler and keyboard report
+  decoder used by HidKeyboardDxe.
+
+  Copyright (c) Microsoft Corporation
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UnitTestLib.h>
+#include "../HidReportDescriptor.h"
+
+#define UNIT_TEST_NAME     "HID Report Descriptor Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define RANDOM_REPORT_ITERATIONS  20000
+
+//
+// Boot keyboard, HID 1.11 Appendix B.1.
+//
+STATIC CONST UINT8  mBootKeyboardDescriptor[] = {
+  0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+  0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01,
+  0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06,
+  0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65, 0x81, 0x00, 0xC0
+};
+
+//
+// N-key rollover keyboard as exposed by QMK firmware on its shared endpoint:
+// report ID 6, modifier byte followed by a 240 bit usage bitmap (0x00 - 0xEF).
+//
+STATIC CONST UINT8  mNkroKeyboardDescriptor[] = {
+  0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x85, 0x06, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00,
+  0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x95, 0x05,
+  0x75, 0x01, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x03, 0x05, 0x07, 0x19, 0x00, 0x29, 0xEF,
+  0x15, 0x00, 0x25, 0x01, 0x95, 0xF0, 0x75, 0x01, 0x81, 0x02, 0xC0
+};
+
+#define NKRO_REPORT_ID    0x06
+#define NKRO_REPORT_SIZE  32
+
+//
+// Laptop style composite keyboard: keyboard (ID 1) with a 0-255 key array,
+// consumer control (ID 2) and system control (ID 3) collections.
+//
+STATIC CONST UINT8  mCompositeKeyboardDescriptor[] = {
+  // Keyboard
+  0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x85, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00,
+  0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05,
+  0x75, 0x01, 0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01,
+  0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x05, 0x07, 0x19, 0x00, 0x2A, 0xFF, 0x00,
+  0x81, 0x00, 0xC0,
+  // Consumer control
+  0x05, 0x0C, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x02, 0x15, 0x00, 0x26, 0xFF, 0x03, 0x19, 0x00, 0x2A,
+  0xFF, 0x03, 0x75, 0x10, 0x95, 0x01, 0x81, 0x00, 0xC0,
+  // System control
+  0x05, 0x01, 0x09, 0x80, 0xA1, 0x01, 0x85, 0x03, 0x19, 0x81, 0x29, 0x83, 0x15, 0x00, 0x25, 0x01,
+  0x75, 0x01, 0x95, 0x03, 0x81, 0x02, 0x95, 0x05, 0x81, 0x01, 0xC0
+};
+
+//
+// Exercises extended (32-bit) usages, Push/Pop, long items and a modifier
+// field that does not start on a byte boundary.
+//
+STATIC CONST UINT8  mUnalignedKeyboardDescriptor[] = {
+  0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,
+  0xFE, 0x02, 0x10, 0xAA, 0xBB,                       // Long item
+  0x05, 0x0C, 0x75, 0x01, 0x15, 0x00, 0x25, 0x01,     // Usage Page (Consumer), 1 bit, 0 - 1
+  0xA4,                                               // Push
+  0x95, 0x03, 0x81, 0x01,                             // 3 padding bits
+  0x1B, 0xE0, 0x00, 0x07, 0x00,                       // Usage Minimum (Keyboard:Left Control)
+  0x2B, 0xE7, 0x00, 0x07, 0x00,                       // Usage Maximum (Keyboard:Right GUI)
+  0x95, 0x08, 0x81, 0x02,                             // 8 modifier bits at bit 3
+  0xB4,                                               // Pop
+  0x95, 0x05, 0x81, 0x01,                             // 5 padding bits
+  0x05, 0x07, 0x09, 0x04, 0x09, 0x05, 0x09, 0x06,     // Usages a, b, c
+  0x09, 0x28,                                         // Usage Enter
+  0x95, 0x04, 0x81, 0x02,                             // 4 key bits
+  0x95, 0x04, 0x81, 0x01,                             // 4 padding bits
+  0xC0
+};
+
+//
+// Boot mouse, HID 1.11 Appendix B.2. Carries no keyboard fields.
+//
+STATIC CONST UINT8  mBootMouseDescriptor[] = {
+  0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x09, 0x01, 0xA1, 0x00, 0x05, 0x09, 0x19, 0x01, 0x29, 0x03,
+  0x15, 0x00, 0x25, 0x01, 0x95, 0x03, 0x75, 0x01, 0x81, 0x02, 0x95, 0x01, 0x75, 0x05, 0x81, 0x01,
+  0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x02, 0x81, 0x06,
+  0xC0, 0xC0
+};
+
+STATIC UINT32  mRandomState = 0x12345678;
+
+/**
+  Small deterministic pseudo random generator for report fuzzing.
+
+  @return Next pseudo random value.
+**/
+STATIC
+UINT32
+NextRandom (
+  VOID
+  )
+{
+  mRandomState ^= mRandomState << 13;
+  mRandomState ^= mRandomState >> 17;
+  mRandomState ^= mRandomState << 5;
+  return mRandomState;
+}
+
+/**
+  Set a usage in a key bitmap.
+**/
+STATIC
+VOID
+SetKey (
+  IN OUT HID_KEY_BITMAP  *Bitmap,
+  IN     UINTN           Usage
+  )
+{
+  Bitmap->Bits[Usage >> 5] |= 1u << (Usage & 0x1F);
+}
+
+/**
+ * @brief The boot keyboard descriptor compiles to a modifier bitmap and a key
+ * array at their Appendix B.1 offsets.
+ *
+ * @param Context
+ * @return UNIT_TEST_STATUS
+ */
+UNIT_TEST_STATUS
+EFIAPI
+TestCompileBootKeyboard (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HID_REPORT_TABLE  Table;
+  EFI_STATUS        Status;
+
+  Status = HidCompileReportDescriptor (mBootKeyboardDescriptor, sizeof (mBootKeyboardDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  UT_ASSERT_FALSE (Table.UsesReportIds);
+  UT_ASSERT_EQUAL (Table.ReportCount, 1);
+  UT_ASSERT_EQUAL (Table.FieldCount, 2);
+  UT_ASSERT_EQUAL (Table.Report[0].SizeInBits, 64);
+
+  UT_ASSERT_EQUAL (Table.Field[0].BitOffset, 0);
+  UT_ASSERT_EQUAL (Table.Field[0].ReportCount, 8);
+  UT_ASSERT_EQUAL (Table.Field[0].UsageMinimum, 0xE0);
+  UT_ASSERT_EQUAL (Table.Field[0].UsageMaximum, 0xE7);
+  UT_ASSERT_EQUAL (Table.Field[0].Flags & HID_REPORT_FIELD_ARRAY, 0);
+
+  UT_ASSERT_EQUAL (Table.Field[1].BitOffset, 16);
+  UT_ASSERT_EQUAL (Table.Field[1].ReportSize, 8);
+  UT_ASSERT_EQUAL (Table.Field[1].ReportCount, 6);
+  UT_ASSERT_EQUAL (Table.Field[1].UsageMinimum, 0x00);
+  UT_ASSERT_EQUAL (Table.Field[1].UsageMaximum, 0x65);
+  UT_ASSERT_EQUAL (Table.Field[1].LogicalMaximum, 0x65);
+  UT_ASSERT_NOT_EQUAL (Table.Field[1].Flags & HID_REPORT_FIELD_ARRAY, 0);
+
+  UT_ASSERT_TRUE (HID_KEY_BITMAP_TEST (&Table.Report[0].Coverage, 0x04));
+  UT_ASSERT_TRUE (HID_KEY_BITMAP_TEST (&Table.Report[0].Coverage, 0x65));
+  UT_ASSERT_TRUE (HID_KEY_BITMAP_TEST (&Table.Report[0].Coverage, 0xE7));
+  UT_ASSERT_FALSE (HID_KEY_BITMAP_TEST (&Table.Report[0].Coverage, 0x01));
+  UT_ASSERT_FALSE (HID_KEY_BITMAP_TEST (&Table.Report[0].Coverage, 0x66));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+ * @brief Boot reports update modifiers and keys, report key order, and keep
+ * the previous keys on ErrorRollOver.
+ *
+ * @param Context
+ * @return UNIT_TEST_STATUS
+ */
+UNIT_TEST_STATUS
+EFIAPI
+TestExtractBootKeyboard (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HID_REPORT_TABLE  Table;
+  HID_KEY_BITMAP    KeysDown;
+  HID_KEY_BITMAP    Expected;
+  UINT8             KeyOrder[8];
+  UINTN             KeyOrderCount;
+  EFI_STATUS        Status;
+  UINT8             Report1[] = { 0x02, 0x00, 0x05, 0x04, 0x00, 0x00, 0x00, 0x00 };
+  UINT8             Report2[] = { 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 };
+  UINT8             RollOver[] = { 0x01, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01 };
+
+  Status = HidCompileReportDescriptor (mBootKeyboardDescriptor, sizeof (mBootKeyboardDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  ZeroMem (&KeysDown, sizeof (KeysDown));
+
+  //
+  // Left Shift + b + a, pressed in that order.
+  //
+  KeyOrderCount = ARRAY_SIZE (KeyOrder);
+  Status        = HidExtractKeyboardReport (&Table, Report1, sizeof (Report1), &KeysDown, KeyOrder, &KeyOrderCount);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_EQUAL (KeyOrderCount, 2);
+  UT_ASSERT_EQUAL (KeyOrder[0], 0x05);
+  UT_ASSERT_EQUAL (KeyOrder[1], 0x04);
+
+  ZeroMem (&Expected, sizeof (Expected));
+  SetKey (&Expected, 0xE1);
+  SetKey (&Expected, 0x04);
+  SetKey (&Expected, 0x05);
+  UT_ASSERT_MEM_EQUAL (&KeysDown, &Expected, sizeof (Expected));
+
+  //
+  // Shift and b released.
+  //
+  Status = HidExtractKeyboardReport (&Table, Report2, sizeof (Report2), &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  ZeroMem (&Expected, sizeof (Expected));
+  SetKey (&Expected, 0x04);
+  UT_ASSERT_MEM_EQUAL (&KeysDown, &Expected, sizeof (Expected));
+
+  //
+  // ErrorRollOver keeps the key array state but still reports modifiers.
+  //
+  Status = HidExtractKeyboardReport (&Table, RollOver, sizeof (RollOver), &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  SetKey (&Expected, 0xE0);
+  UT_ASSERT_MEM_EQUAL (&KeysDown, &Expected, sizeof (Expected));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+ * @brief Arrays flagged HID_REPORT_FIELD_FILL_REPORT accept boot reports with
+ * more than six key codes, and short reports release the missing keys.
+ *
+ * @param Context
+ * @return UNIT_TEST_STATUS
+ */
+UNIT_TEST_STATUS
+EFIAPI
+TestExtractBootKeyboardReportLength (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HID_REPORT_TABLE  Table;
+  HID_KEY_BITMAP    KeysDown;
+  UINT8             KeyOrder[16];
+  UINTN             KeyOrderCount;
+  EFI_STATUS        Status;
+  UINTN             Index;
+  UINT8             LongReport[] = { 0x00, 0x00, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D };
+  UINT8             ShortReport[] = { 0x00, 0x00, 0x04 };
+
+  Status = HidCompileReportDescriptor (mBootKeyboardDescriptor, sizeof (mBootKeyboardDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  //
+  // Without the flag, only the six described elements are read.
+  //
+  ZeroMem (&KeysDown, sizeof (KeysDown));
+  KeyOrderCount = ARRAY_SIZE (KeyOrder);
+  Status        = HidExtractKeyboardReport (&Table, LongReport, sizeof (LongReport), &KeysDown, KeyOrder, &KeyOrderCount);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_EQUAL (KeyOrderCount, 6);
+  UT_ASSERT_FALSE (HID_KEY_BITMAP_TEST (&KeysDown, 0x0A));
+
+  Table.Field[1].Flags |= HID_REPORT_FIELD_FILL_REPORT;
+  ZeroMem (&KeysDown, sizeof (KeysDown));
+  KeyOrderCount = ARRAY_SIZE (KeyOrder);
+  Status        = HidExtractKeyboardReport (&Table, LongReport, sizeof (LongReport), &KeysDown, KeyOrder, &KeyOrderCount);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_EQUAL (KeyOrderCount, 10);
+  for (Index = 0; Index < KeyOrderCount; Index++) {
+    UT_ASSERT_EQUAL (KeyOrder[Index], LongReport[Index + 2]);
+    UT_ASSERT_TRUE (HID_KEY_BITMAP_TEST (&KeysDown, LongReport[Index + 2]));
+  }
+
+  Status = HidExtractKeyboardReport (&Table, ShortReport, sizeof (ShortReport), &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_TRUE (HID_KEY_BITMAP_TEST (&KeysDown, 0x04));
+  UT_ASSERT_FALSE (HID_KEY_BITMAP_TEST (&KeysDown, 0x05));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+ * @brief Random boot reports decode the same as a direct reading of the
+ * Appendix B.1 layout.
+ *
+ * @param Context
+ * @return UNIT_TEST_STATUS
+ */
+UNIT_TEST_STATUS
+EFIAPI
+TestExtractBootKeyboardRandom (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HID_REPORT_TABLE  Table;
+  HID_KEY_BITMAP    KeysDown;
+  HID_KEY_BITMAP    Expected;
+  UINT8             Report[8];
+  EFI_STATUS        Status;
+  UINTN             Iteration;
+  UINTN             Index;
+
+  Status = HidCompileReportDescriptor (mBootKeyboardDescriptor, sizeof (mBootKeyboardDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  for (Iteration = 0; Iteration < RANDOM_REPORT_ITERATIONS; Iteration++) {
+    for (Index = 0; Index < sizeof (Report); Index++) {
+      Report[Index] = (UINT8)NextRandom ();
+    }
+
+    //
+    // Keep most key codes in the described range so that keys are exercised.
+    //
+    for (Index = 2; Index < sizeof (Report); Index++) {
+      if ((NextRandom () & 3) != 0) {
+        Report[Index] = (UINT8)(Report[Index] % 0x66);
+      }
+
+      if (Report[Index] == 0x01) {
+        Report[Index] = 0x00;
+      }
+    }
+
+    ZeroMem (&Expected, sizeof (Expected));
+    for (Index = 0; Index < 8; Index++) {
+      if ((Report[0] & (1 << Index)) != 0) {
+        SetKey (&Expected, 0xE0 + Index);
+      }
+    }
+
+    for (Index = 2; Index < sizeof (Report); Index++) {
+      if ((Report[Index] >= 0x04) && (Report[Index] <= 0x65)) {
+        SetKey (&Expected, Report[Index]);
+      }
+    }
+
+    SetMem (&KeysDown, sizeof (KeysDown), 0xFF);
+    Status = HidExtractKeyboardReport (&Table, Report, sizeof (Report), &KeysDown, NULL, NULL);
+    UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+    //
+    // Usages outside the report coverage keep their previous (set) state.
+    //
+    for (Index = 0; Index < HID_KEY_BITMAP_WORDS; Index++) {
+      UT_ASSERT_EQUAL (
+        KeysDown.Bits[Index],
+        (Expected.Bits[Index] & Table.Report[0].Coverage.Bits[Index]) | ~Table.Report[0].Coverage.Bits[Index]
+        );
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+ * @brief An NKRO bitmap report decodes every key held down at once, and
+ * random bitmaps match a direct reading.
+ *
+ * @param Context
+ * @return UNIT_TEST_STATUS
+ */
+UNIT_TEST_STATUS
+EFIAPI
+TestExtractNkroKeyboard (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HID_REPORT_TABLE  Table;
+  HID_KEY_BITMAP    KeysDown;
+  UINT8             Report[NKRO_REPORT_SIZE];
+  UINTN             KeyOrderCount;
+  UINT8             KeyOrder[8];
+  EFI_STATUS        Status;
+  UINTN             Iteration;
+  UINTN             Usage;
+
+  Status = HidCompileReportDescriptor (mNkroKeyboardDescriptor, sizeof (mNkroKeyboardDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_TRUE (Table.UsesReportIds);
+  UT_ASSERT_EQUAL (Table.ReportCount, 1);
+  UT_ASSERT_EQUAL (Table.Report[0].ReportId, NKRO_REPORT_ID);
+  UT_ASSERT_EQUAL (Table.Report[0].SizeInBits, (NKRO_REPORT_SIZE - 1) * 8);
+  UT_ASSERT_EQUAL (Table.Field[1].BitOffset, 8);
+  UT_ASSERT_EQUAL (Table.Field[1].ReportCount, 0xF0);
+
+  //
+  // Every letter held down at once.
+  //
+  ZeroMem (Report, sizeof (Report));
+  Report[0] = NKRO_REPORT_ID;
+  for (Usage = 0x04; Usage <= 0x1D; Usage++) {
+    Report[2 + Usage / 8] |= (UINT8)(1 << (Usage % 8));
+  }
+
+  ZeroMem (&KeysDown, sizeof (KeysDown));
+  KeyOrderCount = ARRAY_SIZE (KeyOrder);
+  Status        = HidExtractKeyboardReport (&Table, Report, sizeof (Report), &KeysDown, KeyOrder, &KeyOrderCount);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_EQUAL (KeyOrderCount, 0);
+  for (Usage = 0; Usage < 256; Usage++) {
+    UT_ASSERT_EQUAL (HID_KEY_BITMAP_TEST (&KeysDown, Usage), (Usage >= 0x04) && (Usage <= 0x1D));
+  }
+
+  //
+  // A report that is only the report ID is rejected and keeps every key down.
+  //
+  Status = HidExtractKeyboardReport (&Table, Report, 1, &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  for (Usage = 0; Usage < 256; Usage++) {
+    UT_ASSERT_EQUAL (HID_KEY_BITMAP_TEST (&KeysDown, Usage), (Usage >= 0x04) && (Usage <= 0x1D));
+  }
+
+  for (Iteration = 0; Iteration < RANDOM_REPORT_ITERATIONS; Iteration++) {
+    for (Usage = 1; Usage < sizeof (Report); Usage++) {
+      Report[Usage] = (UINT8)NextRandom ();
+    }
+
+    Status = HidExtractKeyboardReport (&Table, Report, sizeof (Report), &KeysDown, NULL, NULL);
+    UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+    for (Usage = 0x04; Usage < 0xF0; Usage++) {
+      if ((Usage >= 0xE0) && (Usage <= 0xE7)) {
+        //
+        // Modifiers are described twice; either field reporting them counts.
+        //
+        UT_ASSERT_EQUAL (
+          HID_KEY_BITMAP_TEST (&KeysDown, Usage),
+          ((Report[1] >> (Usage - 0xE0)) & 1) != 0 || ((Report[2 + Usage / 8] >> (Usage % 8)) & 1) != 0
+          );
+      } else {
+        UT_ASSERT_EQUAL (HID_KEY_BITMAP_TEST (&KeysDown, Usage), ((Report[2 + Usage / 8] >> (Usage % 8)) & 1) != 0);
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+ * @brief Reports from non-keyboard collections of a composite device are
+ * rejected without disturbing the key state.
+ *
+ * @param Context
+ * @return UNIT_TEST_STATUS
+ */
+UNIT_TEST_STATUS
+EFIAPI
+TestExtractCompositeKeyboard (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HID_REPORT_TABLE  Table;
+  HID_KEY_BITMAP    KeysDown;
+  HID_KEY_BITMAP    Expected;
+  EFI_STATUS        Status;
+  UINT8             KeyboardReport[] = { 0x01, 0x04, 0x00, 0xE3, 0x00, 0x00, 0x00, 0x00, 0x00 };
+  UINT8             ConsumerReport[] = { 0x02, 0xE9, 0x00 };
+  UINT8             SystemReport[]   = { 0x03, 0x01 };
+  UINT8             UnknownReport[]  = { 0x07, 0x00, 0x00 };
+
+  Status = HidCompileReportDescriptor (mCompositeKeyboardDescriptor, sizeof (mCompositeKeyboardDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_TRUE (Table.UsesReportIds);
+  UT_ASSERT_EQUAL (Table.ReportCount, 1);
+  UT_ASSERT_EQUAL (Table.Report[0].ReportId, 1);
+  UT_ASSERT_EQUAL (Table.Field[1].UsageMaximum, 0xFF);
+  UT_ASSERT_EQUAL (Table.Field[1].LogicalMaximum, 0xFF);
+
+  ZeroMem (&KeysDown, sizeof (KeysDown));
+  Status = HidExtractKeyboardReport (&Table, KeyboardReport, sizeof (KeyboardReport), &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  ZeroMem (&Expected, sizeof (Expected));
+  SetKey (&Expected, 0xE2);
+  SetKey (&Expected, 0xE3);
+  UT_ASSERT_MEM_EQUAL (&KeysDown, &Expected, sizeof (Expected));
+
+  Status = HidExtractKeyboardReport (&Table, ConsumerReport, sizeof (ConsumerReport), &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  Status = HidExtractKeyboardReport (&Table, SystemReport, sizeof (SystemReport), &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  Status = HidExtractKeyboardReport (&Table, UnknownReport, sizeof (UnknownReport), &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  UT_ASSERT_MEM_EQUAL (&KeysDown, &Expected, sizeof (Expected));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+ * @brief Extended usages, Push/Pop and long items are handled, and fields off
+ * byte boundaries decode correctly.
+ *
+ * @param Context
+ * @return UNIT_TEST_STATUS
+ */
+UNIT_TEST_STATUS
+EFIAPI
+TestExtractUnalignedKeyboard (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HID_REPORT_TABLE  Table;
+  HID_KEY_BITMAP    KeysDown;
+  HID_KEY_BITMAP    Expected;
+  EFI_STATUS        Status;
+  UINT8             Report[3];
+
+  Status = HidCompileReportDescriptor (mUnalignedKeyboardDescriptor, sizeof (mUnalignedKeyboardDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_EQUAL (Table.FieldCount, 3);
+  UT_ASSERT_EQUAL (Table.Report[0].SizeInBits, 24);
+  UT_ASSERT_EQUAL (Table.Field[0].BitOffset, 3);
+  UT_ASSERT_EQUAL (Table.Field[0].UsageMinimum, 0xE0);
+  UT_ASSERT_EQUAL (Table.Field[1].BitOffset, 16);
+  UT_ASSERT_EQUAL (Table.Field[1].UsageMinimum, 0x04);
+  UT_ASSERT_EQUAL (Table.Field[1].ReportCount, 3);
+  UT_ASSERT_EQUAL (Table.Field[2].BitOffset, 19);
+  UT_ASSERT_EQUAL (Table.Field[2].UsageMinimum, 0x28);
+
+  //
+  // Left Control and Right GUI (bits 3 and 10), b and Enter (bits 17 and 19).
+  //
+  Report[0] = 0x08;
+  Report[1] = 0x04;
+  Report[2] = 0x0A;
+
+  ZeroMem (&KeysDown, sizeof (KeysDown));
+  Status = HidExtractKeyboardReport (&Table, Report, sizeof (Report), &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  ZeroMem (&Expected, sizeof (Expected));
+  SetKey (&Expected, 0xE0);
+  SetKey (&Expected, 0xE7);
+  SetKey (&Expected, 0x05);
+  SetKey (&Expected, 0x28);
+  UT_ASSERT_MEM_EQUAL (&KeysDown, &Expected, sizeof (Expected));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+ * @brief Malformed descriptors, descriptors without keyboard fields and bad
+ * parameters are rejected.
+ *
+ * @param Context
+ * @return UNIT_TEST_STATUS
+ */
+UNIT_TEST_STATUS
+EFIAPI
+TestCompileInvalidDescriptors (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HID_REPORT_TABLE  Table;
+  HID_KEY_BITMAP    KeysDown;
+  UINT8             Report[8];
+  EFI_STATUS        Status;
+  UINT8             Truncated[]      = { 0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x26, 0xFF };
+  UINT8             Unbalanced[]     = { 0x05, 0x01, 0xC0 };
+  UINT8             ReportIdZero[]   = { 0xA1, 0x01, 0x85, 0x00, 0xC0 };
+  UINT8             PopUnderflow[]   = { 0xB4 };
+  UINT8             ReservedType[]   = { 0x0C };
+  UINT8             TruncatedLong[]  = { 0xFE, 0x04, 0x10, 0x00 };
+  UINT8             MissingReportId[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x85, 0x02, 0x81, 0x01, 0xC0
+  };
+
+  Status = HidCompileReportDescriptor (Truncated, sizeof (Truncated), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidCompileReportDescriptor (mBootKeyboardDescriptor, sizeof (mBootKeyboardDescriptor) - 1, &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidCompileReportDescriptor (Unbalanced, sizeof (Unbalanced), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidCompileReportDescriptor (ReportIdZero, sizeof (ReportIdZero), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidCompileReportDescriptor (PopUnderflow, sizeof (PopUnderflow), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidCompileReportDescriptor (ReservedType, sizeof (ReservedType), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidCompileReportDescriptor (TruncatedLong, sizeof (TruncatedLong), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidCompileReportDescriptor (MissingReportId, sizeof (MissingReportId), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  Status = HidCompileReportDescriptor (mBootMouseDescriptor, sizeof (mBootMouseDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_UNSUPPORTED);
+
+  Status = HidCompileReportDescriptor (NULL, 4, &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidCompileReportDescriptor (mBootKeyboardDescriptor, sizeof (mBootKeyboardDescriptor), NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  Status = HidCompileReportDescriptor (mBootKeyboardDescriptor, sizeof (mBootKeyboardDescriptor), &Table);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  ZeroMem (Report, sizeof (Report));
+  Status = HidExtractKeyboardReport (&Table, Report, 0, &KeysDown, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidExtractKeyboardReport (&Table, Report, sizeof (Report), NULL, NULL, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = HidExtractKeyboardReport (&Table, Report, sizeof (Report), &KeysDown, Report, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  unit tests and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      CompileSuiteHandle;
+  UNIT_TEST_SUITE_HANDLE      ExtractSuiteHandle;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Create a suite
+  //
+  Status = CreateUnitTestSuite (&CompileSuiteHandle, Framework, "HID report descriptor compiler tests", "HidKeyboardDxe.ReportDescriptor.Compile", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for CompileSuiteHandle\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Register Tests
+  //
+  AddTestCase (CompileSuiteHandle, "Compile the boot keyboard descriptor", "BootKeyboard", TestCompileBootKeyboard, NULL, NULL, NULL);
+  AddTestCase (CompileSuiteHandle, "Reject malformed and non-keyboard descriptors", "InvalidDescriptors", TestCompileInvalidDescriptors, NULL, NULL, NULL);
+
+  //
+  // Create a suite
+  //
+  Status = CreateUnitTestSuite (&ExtractSuiteHandle, Framework, "HID keyboard report extraction tests", "HidKeyboardDxe.ReportDescriptor.Extract", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ExtractSuiteHandle\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Register Tests
+  //
+  AddTestCase (ExtractSuiteHandle, "Boot keyboard reports and ErrorRollOver", "BootKeyboard", TestExtractBootKeyboard, NULL, NULL, NULL);
+  AddTestCase (ExtractSuiteHandle, "Boot keyboard reports longer and shorter than described", "BootKeyboard.Length", TestExtractBootKeyboardReportLength, NULL, NULL, NULL);
+  AddTestCase (ExtractSuiteHandle, "Random boot keyboard reports", "BootKeyboard.Random", TestExtractBootKeyboardRandom, NULL, NULL, NULL);
+  AddTestCase (ExtractSuiteHandle, "N-key rollover bitmap reports", "Nkro", TestExtractNkroKeyboard, NULL, NULL, NULL);
+  AddTestCase (ExtractSuiteHandle, "Composite keyboard with consumer and system control", "Composite", TestExtractCompositeKeyboard, NULL, NULL, NULL);
+  AddTestCase (ExtractSuiteHandle, "Extended usages and unaligned fields", "Unaligned", TestExtractUnalignedKeyboard, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
@@ -26,9 +26,13 @@ Spec:
 typedef struct _HID_KEYBOARD_PROTOCOL HID_KEYBOARD_PROTOCOL;
 
 // Define the supported HID interfaces.
-// Currently only Boot Keyboard as defined in HID 1.11 B.1 is supported.
+// Currently supported interfaces:
+// Boot Keyboard as defined in HID 1.11 B.1
+// Report Keyboard, formatted as described by the report descriptor returned by
+// HID_REPORT_DESCRIPTOR_PROTOCOL on the same handle.
 typedef enum {
-  BootKeyboard
+  BootKeyboard,
+  ReportKeyboard
 } KEYBOARD_HID_INTERFACE;
 
 // Structures for BootKeyboard interface
@@ -0,0 +1,57 @@
+/*++ @file HidReportDescriptorProtocol.h
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+Module Name:
+
+  HidReportDescriptorProtocol.h
+
+Abstract:
+
+  This header defines an optional interface that a HID hardware layer installs alongside HID_KEYBOARD_PROTOCOL
+  to expose the device report descriptor. When it is present, the keyboard HID processing driver accepts
+  ReportKeyboard reports formatted as the descriptor describes (N-key rollover bitmaps, report IDs, multiple
+  top level collections) in addition to BootKeyboard reports.
+
+Environment:
+
+  UEFI pre-boot Driver Execution Environment (DXE).
+
+Spec:
+  Refer to USB Device Class Definition for Human Interface Devices (HID) version 1.11 section 6.2.2
+
+--*/
+
+#ifndef __HID_REPORT_DESCRIPTOR_PROTOCOL_H__
+#define __HID_REPORT_DESCRIPTOR_PROTOCOL_H__
+
+typedef struct _HID_REPORT_DESCRIPTOR_PROTOCOL HID_REPORT_DESCRIPTOR_PROTOCOL;
+
+/**
+  This function returns a copy of the device HID report descriptor.
+
+  @param  This                  - pointer to the current driver instance.
+  @param  ReportDescriptor      - receives a pool allocated copy of the report descriptor. The caller must free it
+                                  with FreePool().
+  @param  ReportDescriptorSize  - receives the size of the report descriptor in bytes.
+
+  @retval EFI_SUCCESS           - The report descriptor was returned.
+  @retval EFI_INVALID_PARAMETER - ReportDescriptor or ReportDescriptorSize is NULL.
+  @retval other                 - there was an implementation specific failure retrieving the report descriptor.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *GET_HID_REPORT_DESCRIPTOR)(
+  IN  HID_REPORT_DESCRIPTOR_PROTOCOL  *This,
+  OUT UINT8                           **ReportDescriptor,
+  OUT UINTN                           *ReportDescriptorSize
+  );
+
+struct _HID_REPORT_DESCRIPTOR_PROTOCOL {
+  GET_HID_REPORT_DESCRIPTOR    GetReportDescriptor;
+};
+
+extern EFI_GUID  gHidReportDescriptorProtocolGuid;
+
+#endif //__HID_REPORT_DESCRIPTOR_PROTOCOL_H__
@@ -275,6 +275,7 @@ UsbKbHidDriverBindingStart (
   UsbKeyboardDevice->HidKeyboard.RegisterKeyboardHidReportCallback   = RegisterKeyboardHidReportCallback;
   UsbKeyboardDevice->HidKeyboard.UnRegisterKeyboardHidReportCallback = UnRegisterKeyboardHidReportCallback;
   UsbKeyboardDevice->HidKeyboard.SetOutputReport                     = SetOutputReport;
+  UsbKeyboardDevice->HidReportDescriptor.GetReportDescriptor         = GetReportDescriptor;
 
   UsbKeyboardDevice->ControllerHandle = Controller;
 
@@ -321,15 +322,37 @@ UsbKbHidDriverBindingStart (
   }
 
   //
-  // Install HID USB keyboard device.
+  // Install HID USB keyboard device. The report descriptor is installed in the same
+  // call so that it is present whenever the HID keyboard driver binds.
   //
-  Status = gBS->InstallMultipleProtocolInterfaces (
-                  &Controller,
-                  &gHidKeyboardProtocolGuid,
-                  &UsbKeyboardDevice->HidKeyboard,
-                  NULL
-                  );
+  if (UsbKeyboardDevice->ReportInterface == ReportKeyboard) {
+    Status = gBS->InstallMultipleProtocolInterfaces (
+                    &Controller,
+                    &gHidKeyboardProtocolGuid,
+                    &UsbKeyboardDevice->HidKeyboard,
+                    &gHidReportDescriptorProtocolGuid,
+                    &UsbKeyboardDevice->HidReportDescriptor,
+                    NULL
+                    );
+  } else {
+    Status = gBS->InstallMultipleProtocolInterfaces (
+                    &Controller,
+                    &gHidKeyboardProtocolGuid,
+                    &UsbKeyboardDevice->HidKeyboard,
+                    NULL
+                    );
+  }
+
   if (EFI_ERROR (Status)) {
+    UsbIo->UsbAsyncInterruptTransfer (
+             UsbIo,
+             EndpointAddr,
+             FALSE,
+             PollingInterval,
+             0,
+             NULL,
+             NULL
+             );
     goto ErrorExit;
   }
 
@@ -357,6 +380,14 @@ UsbKbHidDriverBindingStart (
   //
 ErrorExit:
   if (UsbKeyboardDevice != NULL) {
+    if (UsbKeyboardDevice->DelayedRecoveryEvent != NULL) {
+      gBS->CloseEvent (UsbKeyboardDevice->DelayedRecoveryEvent);
+    }
+
+    if (UsbKeyboardDevice->ReportDescriptor != NULL) {
+      FreePool (UsbKeyboardDevice->ReportDescriptor);
+    }
+
     FreePool (UsbKeyboardDevice);
     UsbKeyboardDevice = NULL;
   }
@@ -437,12 +468,24 @@ UsbKbHidDriverBindingStop (
                               NULL,
                               NULL
                               );
-  Status = gBS->UninstallMultipleProtocolInterfaces (
-                  Controller,
-                  &gHidKeyboardProtocolGuid,
-                  &UsbKeyboardDevice->HidKeyboard,
-                  NULL
-                  );
+  if (UsbKeyboardDevice->ReportInterface == ReportKeyboard) {
+    Status = gBS->UninstallMultipleProtocolInterfaces (
+                    Controller,
+                    &gHidKeyboardProtocolGuid,
+                    &UsbKeyboardDevice->HidKeyboard,
+                    &gHidReportDescriptorProtocolGuid,
+                    &UsbKeyboardDevice->HidReportDescriptor,
+                    NULL
+                    );
+  } else {
+    Status = gBS->UninstallMultipleProtocolInterfaces (
+                    Controller,
+                    &gHidKeyboardProtocolGuid,
+                    &UsbKeyboardDevice->HidKeyboard,
+                    NULL
+                    );
+  }
+
   ASSERT_EFI_ERROR (Status); // Proceed on error in non-debug case.
 
   // Close the recovery event, if one exists.
@@ -466,6 +509,10 @@ UsbKbHidDriverBindingStop (
     FreeUnicodeStringTable (UsbKeyboardDevice->ControllerNameTable);
   }
 
+  if (UsbKeyboardDevice->ReportDescriptor != NULL) {
+    FreePool (UsbKeyboardDevice->ReportDescriptor);
+  }
+
   FreePool (UsbKeyboardDevice);
 
   return Status;
@@ -599,6 +646,48 @@ SetOutputReport (
   return Status;
 }
 
+//
+// HID Report Descriptor Protocol functions
+//
+
+/**
+  This function returns a copy of the device HID report descriptor.
+
+  @param  This                  - pointer to the current driver instance.
+  @param  ReportDescriptor      - receives a pool allocated copy of the report descriptor. The caller must free it
+                                  with FreePool().
+  @param  ReportDescriptorSize  - receives the size of the report descriptor in bytes.
+
+  @retval EFI_SUCCESS           - The report descriptor was returned.
+  @retval EFI_INVALID_PARAMETER - ReportDescriptor or ReportDescriptorSize is NULL.
+  @retval EFI_OUT_OF_RESOURCES  - The copy could not be allocated.
+**/
+EFI_STATUS
+EFIAPI
+GetReportDescriptor (
+  IN  HID_REPORT_DESCRIPTOR_PROTOCOL  *This,
+  OUT UINT8                           **ReportDescriptor,
+  OUT UINTN                           *ReportDescriptorSize
+  )
+{
+  USB_KB_HID_DEV  *HidKeyboard;
+
+  if ((This == NULL) || (ReportDescriptor == NULL) || (ReportDescriptorSize == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  HidKeyboard = USB_KB_HID_DEV_FROM_REPORT_DESCRIPTOR (This);
+
+  *ReportDescriptor = AllocateCopyPool (HidKeyboard->ReportDescriptorSize, HidKeyboard->ReportDescriptor);
+  if (*ReportDescriptor == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  *ReportDescriptorSize = HidKeyboard->ReportDescriptorSize;
+
+  return EFI_SUCCESS;
+}
+
 //
 // Module-global utility functions
 //
@@ -643,6 +732,71 @@ IsUSBKeyboard (
   return FALSE;
 }
 
+/**
+  Read the HID report descriptor of the keyboard interface.
+
+  @param  UsbKeyboardDevice     The USB_KB_HID_DEV instance. On success ReportDescriptor
+                                and ReportDescriptorSize describe a pool buffer owned by
+                                the device.
+
+  @retval EFI_SUCCESS           The report descriptor was read.
+  @retval EFI_UNSUPPORTED       The HID descriptor does not list a report descriptor.
+  @retval EFI_OUT_OF_RESOURCES  Out of memory.
+  @retval Other                 The control transfer failed.
+
+**/
+EFI_STATUS
+ReadUsbReportDescriptor (
+  IN OUT USB_KB_HID_DEV  *UsbKeyboardDevice
+  )
+{
+  EFI_STATUS              Status;
+  EFI_USB_HID_DESCRIPTOR  HidDescriptor;
+  UINT16                  ReportDescriptorSize;
+  UINT8                   *ReportDescriptor;
+
+  Status = UsbGetHidDescriptor (
+             UsbKeyboardDevice->UsbIo,
+             UsbKeyboardDevice->InterfaceDescriptor.InterfaceNumber,
+             &HidDescriptor
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // The first class descriptor of a HID interface is its report descriptor.
+  //
+  ReportDescriptorSize = HidDescriptor.HidClassDesc[0].DescriptorLength;
+  if ((HidDescriptor.NumDescriptors == 0) ||
+      (HidDescriptor.HidClassDesc[0].DescriptorType != USB_DESC_TYPE_REPORT) ||
+      (ReportDescriptorSize == 0))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  ReportDescriptor = AllocateZeroPool (ReportDescriptorSize);
+  if (ReportDescriptor == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = UsbGetReportDescriptor (
+             UsbKeyboardDevice->UsbIo,
+             UsbKeyboardDevice->InterfaceDescriptor.InterfaceNumber,
+             ReportDescriptorSize,
+             ReportDescriptor
+             );
+  if (EFI_ERROR (Status)) {
+    FreePool (ReportDescriptor);
+    return Status;
+  }
+
+  UsbKeyboardDevice->ReportDescriptor     = ReportDescriptor;
+  UsbKeyboardDevice->ReportDescriptorSize = ReportDescriptorSize;
+
+  return EFI_SUCCESS;
+}
+
 /**
   Initialize USB keyboard device and all private data structures.
 
@@ -659,6 +813,7 @@ InitUsbKeyboard (
 {
   UINT16      ConfigValue;
   UINT8       Protocol;
+  UINT8       WantedProtocol;
   EFI_STATUS  Status;
   UINT32      TransferResult;
 
@@ -703,21 +858,52 @@ InitUsbKeyboard (
     }
   }
 
-  UsbGetProtocolRequest (
-    UsbKeyboardDevice->UsbIo,
-    UsbKeyboardDevice->InterfaceDescriptor.InterfaceNumber,
-    &Protocol
-    );
   //
-  // Set boot protocol for the USB Keyboard.
-  // This driver only supports boot protocol.
+  // Prefer report protocol, whose reports are decoded with the device report
+  // descriptor (N-key rollover, report IDs). Fall back to boot protocol when the
+  // descriptor cannot be read or the device refuses report protocol.
   //
-  if (Protocol != BOOT_PROTOCOL) {
-    UsbSetProtocolRequest (
-      UsbKeyboardDevice->UsbIo,
-      UsbKeyboardDevice->InterfaceDescriptor.InterfaceNumber,
-      BOOT_PROTOCOL
-      );
+  UsbKeyboardDevice->ReportInterface = BootKeyboard;
+  WantedProtocol                     = BOOT_PROTOCOL;
+  if (UsbKeyboardDevice->ReportDescriptor == NULL) {
+    Status = ReadUsbReportDescriptor (UsbKeyboardDevice);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "[%a] - failed to read report descriptor, using boot protocol: %r.\n", __FUNCTION__, Status));
+    }
+  }
+
+  if (UsbKeyboardDevice->ReportDescriptor != NULL) {
+    WantedProtocol = REPORT_PROTOCOL;
+  }
+
+  Status = UsbGetProtocolRequest (
+             UsbKeyboardDevice->UsbIo,
+             UsbKeyboardDevice->InterfaceDescriptor.InterfaceNumber,
+             &Protocol
+             );
+  if (EFI_ERROR (Status) || (Protocol != WantedProtocol)) {
+    Status = UsbSetProtocolRequest (
+               UsbKeyboardDevice->UsbIo,
+               UsbKeyboardDevice->InterfaceDescriptor.InterfaceNumber,
+               WantedProtocol
+               );
+    if (EFI_ERROR (Status) && (WantedProtocol == REPORT_PROTOCOL)) {
+      DEBUG ((DEBUG_WARN, "[%a] - failed to select report protocol, using boot protocol: %r.\n", __FUNCTION__, Status));
+      WantedProtocol = BOOT_PROTOCOL;
+      UsbSetProtocolRequest (
+        UsbKeyboardDevice->UsbIo,
+        UsbKeyboardDevice->InterfaceDescriptor.InterfaceNumber,
+        BOOT_PROTOCOL
+        );
+    }
+  }
+
+  if (WantedProtocol == REPORT_PROTOCOL) {
+    UsbKeyboardDevice->ReportInterface = ReportKeyboard;
+  } else if (UsbKeyboardDevice->ReportDescriptor != NULL) {
+    FreePool (UsbKeyboardDevice->ReportDescriptor);
+    UsbKeyboardDevice->ReportDescriptor     = NULL;
+    UsbKeyboardDevice->ReportDescriptorSize = 0;
   }
 
   //
@@ -790,7 +976,8 @@ KeyboardHandler (
       );
 
     // send a HID packet with no keys pressed so that
-    // the HID layer will cancel repeat.
+    // the HID layer will cancel repeat. A boot packet releases
+    // every key whichever protocol the device is in.
     ZeroMem (EmptyKeyPacket, sizeof (EmptyKeyPacket));
     if (UsbKeyboardDevice->KeyReportCallback != NULL) {
       UsbKeyboardDevice->KeyReportCallback (
@@ -846,7 +1033,7 @@ KeyboardHandler (
   //
   if (UsbKeyboardDevice->KeyReportCallback != NULL) {
     UsbKeyboardDevice->KeyReportCallback (
-                         BootKeyboard,
+                         UsbKeyboardDevice->ReportInterface,
                          (UINT8 *)Data,
                          DataLength,
                          UsbKeyboardDevice->KeyReportCallbackContext
@@ -15,6 +15,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <Protocol/DevicePath.h>
 #include <Protocol/HidKeyboardProtocol.h>
+#include <Protocol/HidReportDescriptorProtocol.h>
 #include <Protocol/UsbIo.h>
 
 #include <Library/BaseMemoryLib.h>
@@ -54,6 +55,10 @@ typedef struct {
   EFI_USB_INTERFACE_DESCRIPTOR    InterfaceDescriptor;
   EFI_USB_ENDPOINT_DESCRIPTOR     IntEndpointDescriptor;
   HID_KEYBOARD_PROTOCOL           HidKeyboard;
+  HID_REPORT_DESCRIPTOR_PROTOCOL  HidReportDescriptor;
+  UINT8                           *ReportDescriptor;
+  UINT16                          ReportDescriptorSize;
+  KEYBOARD_HID_INTERFACE          ReportInterface;
   KEYBOARD_HID_REPORT_CALLBACK    KeyReportCallback;
   VOID                            *KeyReportCallbackContext;
 } USB_KB_HID_DEV;
@@ -68,6 +73,9 @@ extern EFI_COMPONENT_NAME2_PROTOCOL  gUsbKbHidComponentName2;
 #define USB_KB_HID_DEV_FROM_THIS(a) \
     CR(a, USB_KB_HID_DEV, HidKeyboard, USB_HID_KB_DEV_SIGNATURE)
 
+#define USB_KB_HID_DEV_FROM_REPORT_DESCRIPTOR(a) \
+    CR(a, USB_KB_HID_DEV, HidReportDescriptor, USB_HID_KB_DEV_SIGNATURE)
+
 //
 // Functions of Driver Binding Protocol
 //
@@ -314,6 +322,30 @@ SetOutputReport (
   IN UINTN                   HidOutputReportBufferSize
   );
 
+//
+// HID Report Descriptor Protocol functions
+//
+
+/**
+  This function returns a copy of the device HID report descriptor.
+
+  @param  This                  - pointer to the current driver instance.
+  @param  ReportDescriptor      - receives a pool allocated copy of the report descriptor. The caller must free it
+                                  with FreePool().
+  @param  ReportDescriptorSize  - receives the size of the report descriptor in bytes.
+
+  @retval EFI_SUCCESS           - The report descriptor was returned.
+  @retval EFI_INVALID_PARAMETER - ReportDescriptor or ReportDescriptorSize is NULL.
+  @retval EFI_OUT_OF_RESOURCES  - The copy could not be allocated.
+**/
+EFI_STATUS
+EFIAPI
+GetReportDescriptor (
+  IN  HID_REPORT_DESCRIPTOR_PROTOCOL  *This,
+  OUT UINT8                           **ReportDescriptor,
+  OUT UINTN                           *ReportDescriptorSize
+  );
+
 //
 // Module-global utility functions
 //
@@ -332,6 +364,24 @@ IsUSBKeyboard (
   IN  EFI_USB_IO_PROTOCOL  *UsbIo
   );
 
+/**
+  Read the HID report descriptor of the keyboard interface.
+
+  @param  UsbKeyboardDevice     The USB_KB_HID_DEV instance. On success ReportDescriptor
+                                and ReportDescriptorSize describe a pool buffer owned by
+                                the device.
+
+  @retval EFI_SUCCESS           The report descriptor was read.
+  @retval EFI_UNSUPPORTED       The HID descriptor does not list a report descriptor.
+  @retval EFI_OUT_OF_RESOURCES  Out of memory.
+  @retval Other                 The control transfer failed.
+
+**/
+EFI_STATUS
+ReadUsbReportDescriptor (
+  IN OUT USB_KB_HID_DEV  *UsbKeyboardDevice
+  );
+
 /**
   Initialize USB keyboard device and all private data structures.
 
@@ -92,6 +92,15 @@
 #define NEXT_MFCI_NONCE_VARIABLE_NAME \
         L"NextMfciPolicyNonce"
 
+/**
+  Name of the variable that records the digest, nonce and matching certificate
+  of the most recently authenticated policy blob, so that an identical blob can
+  skip PKCS7 verification on subsequent boots.  Only consulted when
+  PcdMfciVerifiedPolicyCacheEnable is TRUE.
+**/
+#define MFCI_VERIFIED_POLICY_CACHE_VARIABLE_NAME \
+        L"MfciVerifiedPolicyCache"
+
 /**
   Policy Engine Per-Device Targeting Variable Names
   Below are the variable names that are populated by OEM code during the DXE phase to enable per-device
@@ -410,6 +410,25 @@ RegisterVarPolicies (
     goto Done;
   }
 
+  if (FeaturePcdGet (PcdMfciVerifiedPolicyCacheEnable)) {
+    Status = RegisterVarStateVariablePolicy (
+               VariablePolicy,
+               &MFCI_VAR_VENDOR_GUID,
+               MFCI_VERIFIED_POLICY_CACHE_VARIABLE_NAME,
+               sizeof (MFCI_VERIFIED_POLICY_CACHE),
+               sizeof (MFCI_VERIFIED_POLICY_CACHE),
+               MFCI_POLICY_VARIABLE_ATTR,
+               (UINT32) ~MFCI_POLICY_VARIABLE_ATTR,
+               &gMuVarPolicyWriteOnceStateVarGuid,
+               MFCI_LOCK_VAR_NAME,
+               MFCI_LOCK_VAR_VALUE
+               );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a - Registering Variable Policy for Verified Policy Cache failed - %r\n", __FUNCTION__, Status));
+      goto Done;
+    }
+  }
+
   // Walk the list of OEM-supplied targeting variables to register variable policy
   // to lock the OEM-supplied targeting variables at End of DXE
   for (UINTN fieldIndex = MFCI_POLICY_TARGET_MANUFACTURER;
@@ -569,12 +588,69 @@ VarPolicyCallback (
 }
 
 /**
- * Validate blob on each certificate from preset XDR buffer.
+ * Extract the next certificate from an XDR formatted certificate buffer.
+ *
+ * @param Cursor              On input, the start of the next XDR entry.  On output, the start of the entry after it.
+ * @param XdrEnd              End of the XDR formatted buffer.
+ * @param CertData            Returns a pointer to the certificate data of this entry.
+ * @param CertDataLength      Returns the size of CertData, in bytes.
+ *
+ * @retval EFI_SUCCESS        The certificate was extracted.
+ * @retval EFI_ABORTED        The entry extends beyond the end of the XDR buffer.
+ */
+STATIC
+EFI_STATUS
+GetNextXdrCertificate (
+  IN OUT CONST UINT8  **Cursor,
+  IN     CONST UINT8  *XdrEnd,
+  OUT    CONST UINT8  **CertData,
+  OUT    UINTN        *CertDataLength
+  )
+{
+  if ((*Cursor + sizeof (UINT32)) > XdrEnd) {
+    //
+    // Key data extends beyond end of PCD
+    //
+    DEBUG ((DEBUG_ERROR, "%a: Certificate size extends beyond end of PCD, skipping it.\n", __FUNCTION__));
+    return EFI_ABORTED;
+  }
+
+  // Read key length stored in big-endian format
+  //
+  *CertDataLength = SwapBytes32 (*(UINT32 *)(*Cursor));
+  //
+  // Point to the start of the key data
+  //
+  *CertData = *Cursor + sizeof (UINT32);
+
+  // Length + ALIGN_VALUE(Length, 4) for 4-byte alignment (XDR standard).
+  if ((*CertData + ALIGN_VALUE (*CertDataLength, 4)) > XdrEnd) {
+    DEBUG ((
+      DEBUG_ERROR,
+      "%a - PcdMfciPkcs7CertBufferXdr size incorrect: PublicKeyData(0x%x) PublicKeyDataLength(0x%x) PublicKeyDataXdrEnd(0x%x)\n",
+      __FUNCTION__,
+      *CertData,
+      *CertDataLength,
+      XdrEnd
+      ));
+    return EFI_ABORTED;
+  }
+
+  *Cursor = *CertData + *CertDataLength;
+  *Cursor = (UINT8 *)ALIGN_POINTER (*Cursor, sizeof (UINT32));
+  return EFI_SUCCESS;
+}
+
+/**
+ * Validate blob on each certificate from preset XDR buffer, trying the certificate at
+ * PreferredIndex first.
  *
  * @param SignedPolicy        Pointer to hold the policy buffer to be validated.
  * @param SignedPolicySize    Size of SignedPolicy, in bytes.
  * @param Certificates        Pointer to hold the XDR formatted buffer of certificates.
  * @param CertificatesSize    Size of Certificates, in bytes.
+ * @param PreferredIndex      1-based index of the certificate to try first, 0 to try them in order.
+ * @param MatchedIndex        Optional, returns the 1-based index of the certificate that validated the blob.
  *
  * @retval EFI_SUCCESS        The one certificate from Certificate is valid for input policy validation.
  * @retval EFI_ABORTED        SignedPolicy is null data or at least one certificate from incoming Certificates is
@@ -582,14 +658,17 @@ VarPolicyCallback (
  * @retval Others             Other errors from the underlying ValidateBlob function.
  */
 EFI_STATUS
-ValidateBlobWithXdrCertificates (
+ValidateBlobWithXdrCertificatesEx (
   IN CONST UINT8  *SignedPolicy,
   IN UINTN        SignedPolicySize,
   IN CONST UINT8  *Certificates,
-  IN UINTN        CertificatesSize
+  IN UINTN        CertificatesSize,
+  IN UINTN        PreferredIndex,
+  OUT UINTN       *MatchedIndex OPTIONAL
   )
 {
   EFI_STATUS   Status;
+  EFI_STATUS   CertStatus;
   CONST UINT8  *PublicKeyDataXdr;
   CONST UINT8  *PublicKeyDataCurrent;
   CONST UINT8  *PublicKeyDataXdrEnd;
@@ -617,6 +696,32 @@ ValidateBlobWithXdrCertificates (
     goto Exit;
   }
 
+  Status = EFI_NOT_FOUND;
+
+  //
+  // Try the preferred key first, the walk still checks the format of every entry before it
+  //
+  if (PreferredIndex != 0) {
+    PublicKeyDataCurrent = PublicKeyDataXdr;
+    for (Index = 1; PublicKeyDataCurrent < PublicKeyDataXdrEnd; Index++) {
+      CertStatus = GetNextXdrCertificate (&PublicKeyDataCurrent, PublicKeyDataXdrEnd, &PublicKeyData, &PublicKeyDataLength);
+      if (EFI_ERROR (CertStatus)) {
+        Status = CertStatus;
+        goto Exit;
+      }
+
+      if (Index == PreferredIndex) {
+        DEBUG ((DEBUG_INFO, "%a: Trying preferred certificate #%d first.\n", __FUNCTION__, Index));
+        Status = ValidateBlob (SignedPolicy, SignedPolicySize, PublicKeyData, PublicKeyDataLength, RequiredEKUs);
+        if (!EFI_ERROR (Status)) {
+          goto Exit;
+        }
+
+        break;
+      }
+    }
+  }
+
   PublicKeyDataCurrent = PublicKeyDataXdr;
   //
   // Try each key from PcdFmpDevicePkcs7CertBufferXdr
@@ -631,48 +736,110 @@ ValidateBlobWithXdrCertificates (
       PublicKeyDataXdrEnd
       ));
 
-    if ((PublicKeyDataCurrent + sizeof (UINT32)) > PublicKeyDataXdrEnd) {
-      //
-      // Key data extends beyond end of PCD
-      //
-      DEBUG ((DEBUG_ERROR, "%a: Certificate size extends beyond end of PCD, skipping it.\n", __FUNCTION__));
-      Status = EFI_ABORTED;
+    CertStatus = GetNextXdrCertificate (&PublicKeyDataCurrent, PublicKeyDataXdrEnd, &PublicKeyData, &PublicKeyDataLength);
+    if (EFI_ERROR (CertStatus)) {
+      Status = CertStatus;
       goto Exit;
     }
 
-    // Read key length stored in big-endian format
-    //
-    PublicKeyDataLength = SwapBytes32 (*(UINT32 *)(PublicKeyDataCurrent));
-    //
-    // Point to the start of the key data
-    //
-    PublicKeyData = PublicKeyDataCurrent + sizeof (UINT32);
-
-    // Length + ALIGN_VALUE(Length, 4) for 4-byte alignment (XDR standard).
-    if ((PublicKeyData + ALIGN_VALUE (PublicKeyDataLength, 4)) > PublicKeyDataXdrEnd) {
-      DEBUG ((
-        DEBUG_ERROR,
-        "%a - PcdMfciPkcs7CertBufferXdr size incorrect: PublicKeyData(0x%x) PublicKeyDataLength(0x%x) PublicKeyDataXdrEnd(0x%x)\n",
-        __FUNCTION__,
-        PublicKeyData,
-        PublicKeyDataLength,
-        PublicKeyDataXdrEnd
-        ));
-      Status = EFI_ABORTED;
-      goto Exit;
+    if (Index == PreferredIndex) {
+      // Already tried above
+      continue;
     }
 
     Status = ValidateBlob (SignedPolicy, SignedPolicySize, PublicKeyData, PublicKeyDataLength, RequiredEKUs);
     if (!EFI_ERROR (Status)) {
       break;
     }
-
-    PublicKeyDataCurrent = PublicKeyData + PublicKeyDataLength;
-    PublicKeyDataCurrent = (UINT8 *)ALIGN_POINTER (PublicKeyDataCurrent, sizeof (UINT32));
   }
 
   // above is inspired/borrowed from FmpDxe.c
 Exit:
+  if (!EFI_ERROR (Status) && (MatchedIndex != NULL)) {
+    *MatchedIndex = Index;
+  }
+
+  return Status;
+}
+
+/**
+ * Validate blob on each certificate from preset XDR buffer.
+ *
+ * @param SignedPolicy        Pointer to hold the policy buffer to be validated.
+ * @param SignedPolicySize    Size of SignedPolicy, in bytes.
+ * @param Certificates        Pointer to hold the XDR formatted buffer of certificates.
+ * @param CertificatesSize    Size of Certificates, in bytes.
+ *
+ * @retval EFI_SUCCESS        The one certificate from Certificate is valid for input policy validation.
+ * @retval EFI_ABORTED        SignedPolicy is null data or at least one certificate from incoming Certificates is
+ *                            malformatted.
+ * @retval Others             Other errors from the underlying ValidateBlob function.
+ */
+EFI_STATUS
+ValidateBlobWithXdrCertificates (
+  IN CONST UINT8  *SignedPolicy,
+  IN UINTN        SignedPolicySize,
+  IN CONST UINT8  *Certificates,
+  IN UINTN        CertificatesSize
+  )
+{
+  return ValidateBlobWithXdrCertificatesEx (SignedPolicy, SignedPolicySize, Certificates, CertificatesSize, 0, NULL);
+}
+
+/**
+ * Validate blob against PcdMfciPkcs7CertBufferXdr, consulting the verified policy cache first when
+ * PcdMfciVerifiedPolicyCacheEnable is set.  A blob and nonce that match a trusted cache entry are
+ * accepted without PKCS7 verification.  Otherwise the certificate that verified the cached blob is
+ * tried first and a successful verification is recorded in the cache.
+ *
+ * @param SignedPolicy        Pointer to hold the policy buffer to be validated.
+ * @param SignedPolicySize    Size of SignedPolicy, in bytes.
+ * @param Nonce               The nonce the policy is expected to be bound to.
+ *
+ * @retval EFI_SUCCESS        The policy was validated, either by the cache or by a certificate.
+ * @retval Others             Errors from ValidateBlobWithXdrCertificatesEx.
+ */
+STATIC
+EFI_STATUS
+ValidateBlobWithVerifiedPolicyCache (
+  IN CONST UINT8  *SignedPolicy,
+  IN UINTN        SignedPolicySize,
+  IN UINT64       Nonce
+  )
+{
+  EFI_STATUS  Status;
+  EFI_STATUS  CacheStatus;
+  UINTN       CertIndex;
+
+  if (!FeaturePcdGet (PcdMfciVerifiedPolicyCacheEnable)) {
+    return ValidateBlobWithXdrCertificates (SignedPolicy, SignedPolicySize, FixedPcdGetPtr (PcdMfciPkcs7CertBufferXdr), FixedPcdGetSize (PcdMfciPkcs7CertBufferXdr));
+  }
+
+  CertIndex   = 0;
+  CacheStatus = GetVerifiedPolicyCache (SignedPolicy, SignedPolicySize, Nonce, &CertIndex);
+  if (!EFI_ERROR (CacheStatus)) {
+    DEBUG ((DEBUG_INFO, "%a - Policy blob matches verified policy cache (certificate #%d).\n", __FUNCTION__, CertIndex));
+    return EFI_SUCCESS;
+  }
+
+  DEBUG ((DEBUG_INFO, "%a - Verified policy cache miss - %r, hint certificate #%d.\n", __FUNCTION__, CacheStatus, CertIndex));
+
+  Status = ValidateBlobWithXdrCertificatesEx (
+             SignedPolicy,
+             SignedPolicySize,
+             FixedPcdGetPtr (PcdMfciPkcs7CertBufferXdr),
+             FixedPcdGetSize (PcdMfciPkcs7CertBufferXdr),
+             CertIndex,
+             &CertIndex
+             );
+  if (!EFI_ERROR (Status) && (CacheStatus != EFI_ACCESS_DENIED)) {
+    // A failure to update the cache only costs a full verification on the next boot
+    CacheStatus = SetVerifiedPolicyCache (SignedPolicy, SignedPolicySize, Nonce, CertIndex);
+    if (EFI_ERROR (CacheStatus)) {
+      DEBUG ((DEBUG_WARN, "%a - Failed to update verified policy cache - %r.\n", __FUNCTION__, CacheStatus));
+    }
+  }
+
   return Status;
 }
 
@@ -859,7 +1026,7 @@ VerifyPolicyAndChange (
 
   // Step 2.3: validate current blob signature
 
-  Status = ValidateBlobWithXdrCertificates (CurrentBlob, CurrentBlobSize, FixedPcdGetPtr (PcdMfciPkcs7CertBufferXdr), FixedPcdGetSize (PcdMfciPkcs7CertBufferXdr));
+  Status = ValidateBlobWithVerifiedPolicyCache (CurrentBlob, CurrentBlobSize, CurrentNonce);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a - validate current blob failed - %r.\n", __FUNCTION__, Status));
 
@@ -962,7 +1129,7 @@ VerifyTarget:
   // Do nothing.
 
   // Step 3.3: validate target blob signature
-  Status = ValidateBlobWithXdrCertificates (TargetBlob, TargetBlobSize, FixedPcdGetPtr (PcdMfciPkcs7CertBufferXdr), FixedPcdGetSize (PcdMfciPkcs7CertBufferXdr));
+  Status = ValidateBlobWithVerifiedPolicyCache (TargetBlob, TargetBlobSize, TargetNonce);
   if (EFI_ERROR (Status)) {
     // In effort of being fail safe, we let it fail here
     DEBUG ((DEBUG_ERROR, "%a - Target blob validation failed - %r.\n", __FUNCTION__, Status));
@@ -10,6 +10,28 @@
 #define __FIRMWARE_POLICY_DXE_H__
 
 extern MFCI_POLICY_TYPE  mCurrentPolicy;
+extern BOOLEAN           mVarPolicyRegistered;
+
+#define MFCI_VERIFIED_POLICY_CACHE_VERSION  1
+#define MFCI_VERIFIED_POLICY_DIGEST_SIZE    32   // SHA256_DIGEST_SIZE
+
+/**
+  Content of the MFCI_VERIFIED_POLICY_CACHE_VARIABLE_NAME variable.
+
+  An entry is only ever written after a blob passed PKCS7 and EKU verification,
+  so a matching entry implies a successful verification result.  CertDigest binds
+  the entry to the trust anchors built into this firmware, so a firmware update
+  that changes PcdMfciPkcs7CertBufferXdr invalidates the cache.
+**/
+#pragma pack(1)
+typedef struct {
+  UINT32    Version;
+  UINT32    CertIndex;                                         // 1-based index into PcdMfciPkcs7CertBufferXdr
+  UINT64    Nonce;
+  UINT8     BlobDigest[MFCI_VERIFIED_POLICY_DIGEST_SIZE];
+  UINT8     CertDigest[MFCI_VERIFIED_POLICY_DIGEST_SIZE];
+} MFCI_VERIFIED_POLICY_CACHE;
+#pragma pack()
 
 /**
   This is the definition of MFCI policies that this package natively support.
@@ -36,6 +58,50 @@ NotifyMfciPolicyChange (
   IN MFCI_POLICY_TYPE  NewPolicy
   );
 
+/**
+  Look up a policy blob in the verified policy cache.
+
+  @param[in]  PolicyBlob      Pointer to the signed policy blob.
+  @param[in]  PolicyBlobSize  Size of PolicyBlob, in bytes.
+  @param[in]  Nonce           The nonce the blob is expected to be bound to.
+  @param[out] CertIndex       On EFI_SUCCESS, the 1-based index of the certificate that verified
+                              the blob.  On EFI_NOT_FOUND, the index of the certificate that verified
+                              the previously cached blob, or 0 if there is no usable hint.
+
+  @retval EFI_SUCCESS            The blob and nonce match a trusted cache entry.
+  @retval EFI_NOT_FOUND          The cache is absent, stale or does not match this blob.
+  @retval EFI_ACCESS_DENIED      The cache variable is not protected by variable policy on this boot.
+  @retval EFI_INVALID_PARAMETER  An input pointer is NULL or PolicyBlobSize is 0.
+**/
+EFI_STATUS
+GetVerifiedPolicyCache (
+  IN  CONST VOID  *PolicyBlob,
+  IN  UINTN       PolicyBlobSize,
+  IN  UINT64      Nonce,
+  OUT UINTN       *CertIndex
+  );
+
+/**
+  Record a policy blob that has just passed PKCS7 verification in the verified policy cache.
+
+  @param[in]  PolicyBlob      Pointer to the signed policy blob.
+  @param[in]  PolicyBlobSize  Size of PolicyBlob, in bytes.
+  @param[in]  Nonce           The nonce the blob is bound to.
+  @param[in]  CertIndex       The 1-based index of the certificate that verified the blob.
+
+  @retval EFI_SUCCESS            The cache entry was written.
+  @retval EFI_ACCESS_DENIED      The cache variable is not protected by variable policy on this boot.
+  @retval EFI_INVALID_PARAMETER  An input pointer is NULL, PolicyBlobSize is 0 or CertIndex is 0.
+  @retval Others                 Failed to hash the blob or write the variable.
+**/
+EFI_STATUS
+SetVerifiedPolicyCache (
+  IN  CONST VOID  *PolicyBlob,
+  IN  UINTN       PolicyBlobSize,
+  IN  UINT64      Nonce,
+  IN  UINTN       CertIndex
+  );
+
 // Initializer for the SecureBoot Callback
 EFI_STATUS
 EFIAPI
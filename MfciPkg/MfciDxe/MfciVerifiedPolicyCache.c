@@ -0,0 +1,196 @@
+/** @file
+  Maintains a cache of the most recently authenticated MFCI policy blob so
+  that an identical blob does not need a full PKCS7 verification every boot.
+
+  The cache variable is protected by the same write-once variable policy as
+  the MFCI nonces and is locked prior to BDS, so it can only have been written
+  by this driver on a prior boot.  If variable policy registration failed on
+  this boot the cache is neither consulted nor updated.
+
+  Copyright (c) Microsoft Corporation
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi.h>
+
+#include <MfciPolicyType.h>
+#include <MfciVariables.h>
+
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/BaseCryptLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+
+#include "MfciDxe.h"
+
+/**
+  Compute the digest binding a cache entry to the certificates built into this firmware.
+
+  @param[out] CertDigest  Returns the SHA-256 digest of PcdMfciPkcs7CertBufferXdr.
+
+  @retval EFI_SUCCESS       The digest was computed.
+  @retval EFI_DEVICE_ERROR  The hash operation failed.
+**/
+STATIC
+EFI_STATUS
+GetCertificateDigest (
+  OUT UINT8  *CertDigest
+  )
+{
+  if (!Sha256HashAll (
+         FixedPcdGetPtr (PcdMfciPkcs7CertBufferXdr),
+         FixedPcdGetSize (PcdMfciPkcs7CertBufferXdr),
+         CertDigest
+         ))
+  {
+    DEBUG ((DEBUG_ERROR, "%a - Failed to hash PcdMfciPkcs7CertBufferXdr\n", __FUNCTION__));
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Look up a policy blob in the verified policy cache.
+
+  @param[in]  PolicyBlob      Pointer to the signed policy blob.
+  @param[in]  PolicyBlobSize  Size of PolicyBlob, in bytes.
+  @param[in]  Nonce           The nonce the blob is expected to be bound to.
+  @param[out] CertIndex       On EFI_SUCCESS, the 1-based index of the certificate that verified
+                              the blob.  On EFI_NOT_FOUND, the index of the certificate that verified
+                              the previously cached blob, or 0 if there is no usable hint.
+
+  @retval EFI_SUCCESS            The blob and nonce match a trusted cache entry.
+  @retval EFI_NOT_FOUND          The cache is absent, stale or does not match this blob.
+  @retval EFI_ACCESS_DENIED      The cache variable is not protected by variable policy on this boot.
+  @retval EFI_INVALID_PARAMETER  An input pointer is NULL or PolicyBlobSize is 0.
+**/
+EFI_STATUS
+GetVerifiedPolicyCache (
+  IN  CONST VOID  *PolicyBlob,
+  IN  UINTN       PolicyBlobSize,
+  IN  UINT64      Nonce,
+  OUT UINTN       *CertIndex
+  )
+{
+  EFI_STATUS                  Status;
+  MFCI_VERIFIED_POLICY_CACHE  Cache;
+  UINT8                       Digest[MFCI_VERIFIED_POLICY_DIGEST_SIZE];
+  UINT32                      VariableAttr;
+  UINTN                       DataSize;
+
+  if ((PolicyBlob == NULL) || (PolicyBlobSize == 0) || (CertIndex == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *CertIndex = 0;
+
+  if (mVarPolicyRegistered != TRUE) {
+    DEBUG ((DEBUG_WARN, "%a - Variable policy not registered, verified policy cache is not trusted\n", __FUNCTION__));
+    return EFI_ACCESS_DENIED;
+  }
+
+  VariableAttr = 0;
+  DataSize     = sizeof (Cache);
+  Status       = gRT->GetVariable (
+                        MFCI_VERIFIED_POLICY_CACHE_VARIABLE_NAME,
+                        &MFCI_VAR_VENDOR_GUID,
+                        &VariableAttr,
+                        &DataSize,
+                        &Cache
+                        );
+  if (EFI_ERROR (Status) ||
+      (DataSize != sizeof (Cache)) ||
+      (VariableAttr != MFCI_POLICY_VARIABLE_ATTR) ||
+      (Cache.Version != MFCI_VERIFIED_POLICY_CACHE_VERSION))
+  {
+    DEBUG ((DEBUG_INFO, "%a - No usable cache entry - Status(%r) DataSize(%d) VariableAttr(%x)\n", __FUNCTION__, Status, DataSize, VariableAttr));
+    return EFI_NOT_FOUND;
+  }
+
+  // The entry, including its certificate hint, is only meaningful for the trust anchors it was created with
+  Status = GetCertificateDigest (Digest);
+  if (EFI_ERROR (Status) || (CompareMem (Digest, Cache.CertDigest, sizeof (Digest)) != 0)) {
+    DEBUG ((DEBUG_INFO, "%a - Cache entry was created with different certificates\n", __FUNCTION__));
+    return EFI_NOT_FOUND;
+  }
+
+  *CertIndex = Cache.CertIndex;
+
+  if ((Nonce == MFCI_POLICY_INVALID_NONCE) || (Cache.Nonce != Nonce)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (!Sha256HashAll (PolicyBlob, PolicyBlobSize, Digest)) {
+    DEBUG ((DEBUG_ERROR, "%a - Failed to hash policy blob\n", __FUNCTION__));
+    return EFI_NOT_FOUND;
+  }
+
+  if (CompareMem (Digest, Cache.BlobDigest, sizeof (Digest)) != 0) {
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Record a policy blob that has just passed PKCS7 verification in the verified policy cache.
+
+  @param[in]  PolicyBlob      Pointer to the signed policy blob.
+  @param[in]  PolicyBlobSize  Size of PolicyBlob, in bytes.
+  @param[in]  Nonce           The nonce the blob is bound to.
+  @param[in]  CertIndex       The 1-based index of the certificate that verified the blob.
+
+  @retval EFI_SUCCESS            The cache entry was written.
+  @retval EFI_ACCESS_DENIED      The cache variable is not protected by variable policy on this boot.
+  @retval EFI_INVALID_PARAMETER  An input pointer is NULL, PolicyBlobSize is 0 or CertIndex is 0.
+  @retval Others                 Failed to hash the blob or write the variable.
+**/
+EFI_STATUS
+SetVerifiedPolicyCache (
+  IN  CONST VOID  *PolicyBlob,
+  IN  UINTN       PolicyBlobSize,
+  IN  UINT64      Nonce,
+  IN  UINTN       CertIndex
+  )
+{
+  EFI_STATUS                  Status;
+  MFCI_VERIFIED_POLICY_CACHE  Cache;
+
+  if ((PolicyBlob == NULL) || (PolicyBlobSize == 0) || (CertIndex == 0) || (CertIndex > MAX_UINT32)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mVarPolicyRegistered != TRUE) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  ZeroMem (&Cache, sizeof (Cache));
+  Cache.Version   = MFCI_VERIFIED_POLICY_CACHE_VERSION;
+  Cache.CertIndex = (UINT32)CertIndex;
+  Cache.Nonce     = Nonce;
+
+  Status = GetCertificateDigest (Cache.CertDigest);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (!Sha256HashAll (PolicyBlob, PolicyBlobSize, Cache.BlobDigest)) {
+    DEBUG ((DEBUG_ERROR, "%a - Failed to hash policy blob\n", __FUNCTION__));
+    return EFI_DEVICE_ERROR;
+  }
+
+  Status = gRT->SetVariable (
+                  MFCI_VERIFIED_POLICY_CACHE_VARIABLE_NAME,
+                  &MFCI_VAR_VENDOR_GUID,
+                  MFCI_POLICY_VARIABLE_ATTR,
+                  sizeof (Cache),
+                  &Cache
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a - Failed to set %s, returned %r\n", __FUNCTION__, MFCI_VERIFIED_POLICY_CACHE_VARIABLE_NAME, Status));
+  }
+
+  return Status;
+}
@@ -125,6 +125,32 @@ InitTpmListener (
   return EFI_DEVICE_ERROR;
 }
 
+EFI_STATUS
+GetVerifiedPolicyCache (
+  IN  CONST VOID  *PolicyBlob,
+  IN  UINTN       PolicyBlobSize,
+  IN  UINT64      Nonce,
+  OUT UINTN       *CertIndex
+  )
+{
+  // Not used
+  ASSERT (FALSE);
+  return EFI_NOT_FOUND;
+}
+
+EFI_STATUS
+SetVerifiedPolicyCache (
+  IN  CONST VOID  *PolicyBlob,
+  IN  UINTN       PolicyBlobSize,
+  IN  UINT64      Nonce,
+  IN  UINTN       CertIndex
+  )
+{
+  // Not used
+  ASSERT (FALSE);
+  return EFI_DEVICE_ERROR;
+}
+
 EFI_RUNTIME_SERVICES  mMockRuntime;
 
 /**
@@ -0,0 +1,436 @@
+/** @file
+  This module tests the verified policy cache logic for the
+  MfciDxe driver.
+
+  Note: This module uses a mocked digest from MockBaseCryptLib,
+  it only verifies the cache bookkeeping, not SHA-256 itself.
+
+  Copyright (c) Microsoft Corporation
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+
+#include <MfciPolicyType.h>
+#include <MfciVariables.h>
+
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "../MfciDxe.h"
+
+#define UNIT_TEST_NAME     "Mfci Verified Policy Cache Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define MFCI_TEST_NONCE       0x0123456789abcdef
+#define MFCI_TEST_NONCE_2     0xBA5EBA11FEEDF00D
+#define MFCI_TEST_CERT_INDEX  2
+
+EFI_STATUS
+EFIAPI
+UnitTestGetVariable (
+  IN     CHAR16 *VariableName,
+  IN     EFI_GUID *VendorGuid,
+  OUT    UINT32 *Attributes, OPTIONAL
+  IN OUT UINTN                       *DataSize,
+  OUT    VOID                        *Data           OPTIONAL
+  );
+
+EFI_STATUS
+EFIAPI
+UnitTestSetVariable (
+  IN  CHAR16    *VariableName,
+  IN  EFI_GUID  *VendorGuid,
+  IN  UINT32    Attributes,
+  IN  UINTN     DataSize,
+  IN  VOID      *Data
+  );
+
+EFI_RUNTIME_SERVICES  mMockRuntime = {
+  .GetVariable = UnitTestGetVariable,
+  .SetVariable = UnitTestSetVariable,
+};
+
+MFCI_POLICY_TYPE  mCurrentPolicy;
+BOOLEAN           mVarPolicyRegistered;
+
+//
+// Backing store for the single variable this module touches
+//
+BOOLEAN  mCacheVarPresent;
+UINT32   mCacheVarAttr;
+UINTN    mCacheVarSize;
+UINT8    mCacheVarData[MFCI_VAR_MAX_SIZE];
+
+UINT8  mPolicyBlob1[] = { 0x30, 0x82, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+UINT8  mPolicyBlob2[] = { 0x30, 0x82, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x08 };
+
+/**
+A mocked version of GetVariable backed by mCacheVarData.
+
+@retval EFI_NOT_FOUND                 The cache variable has not been written
+@retval Others                        See EFI_GET_VARIABLE for more details
+
+**/
+EFI_STATUS
+EFIAPI
+UnitTestGetVariable (
+  IN     CHAR16 *VariableName,
+  IN     EFI_GUID *VendorGuid,
+  OUT    UINT32 *Attributes, OPTIONAL
+  IN OUT UINTN                       *DataSize,
+  OUT    VOID                        *Data           OPTIONAL
+  )
+{
+  assert_string_equal (VariableName, MFCI_VERIFIED_POLICY_CACHE_VARIABLE_NAME);
+
+  if (!mCacheVarPresent) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (Attributes != NULL) {
+    *Attributes = mCacheVarAttr;
+  }
+
+  if (*DataSize < mCacheVarSize) {
+    *DataSize = mCacheVarSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  CopyMem (Data, mCacheVarData, mCacheVarSize);
+  *DataSize = mCacheVarSize;
+  return EFI_SUCCESS;
+}
+
+/**
+A mocked version of SetVariable backed by mCacheVarData.
+
+@retval EFI_SUCCESS                   The cache variable was updated
+@retval EFI_OUT_OF_RESOURCES          The data does not fit into the backing store
+
+**/
+EFI_STATUS
+EFIAPI
+UnitTestSetVariable (
+  IN  CHAR16    *VariableName,
+  IN  EFI_GUID  *VendorGuid,
+  IN  UINT32    Attributes,
+  IN  UINTN     DataSize,
+  IN  VOID      *Data
+  )
+{
+  assert_string_equal (VariableName, MFCI_VERIFIED_POLICY_CACHE_VARIABLE_NAME);
+
+  if (DataSize > sizeof (mCacheVarData)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  mCacheVarPresent = (DataSize != 0);
+  mCacheVarAttr    = Attributes;
+  mCacheVarSize    = DataSize;
+  CopyMem (mCacheVarData, Data, DataSize);
+  return EFI_SUCCESS;
+}
+
+/**
+  Reset the backing store and mark variable policy as registered.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED   Always.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CachePrerequisite (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  mCacheVarPresent     = FALSE;
+  mCacheVarAttr        = 0;
+  mCacheVarSize        = 0;
+  mVarPolicyRegistered = TRUE;
+  ZeroMem (mCacheVarData, sizeof (mCacheVarData));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A blob recorded in the cache should be accepted for the same nonce and
+  report the certificate that verified it.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestCacheHitAfterSet (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       CertIndex;
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  UT_ASSERT_EQUAL (CertIndex, 0);
+
+  Status = SetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, MFCI_TEST_CERT_INDEX);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (mCacheVarSize, sizeof (MFCI_VERIFIED_POLICY_CACHE));
+  UT_ASSERT_EQUAL (mCacheVarAttr, MFCI_POLICY_VARIABLE_ATTR);
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (CertIndex, MFCI_TEST_CERT_INDEX);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A different blob or nonce must miss the cache, but still get the
+  certificate hint.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestCacheMissOnMismatch (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       CertIndex;
+
+  Status = SetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, MFCI_TEST_CERT_INDEX);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob2, sizeof (mPolicyBlob2), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  UT_ASSERT_EQUAL (CertIndex, MFCI_TEST_CERT_INDEX);
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1) - 1, MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE_2, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  UT_ASSERT_EQUAL (CertIndex, MFCI_TEST_CERT_INDEX);
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_POLICY_INVALID_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A cache entry with unexpected attributes, size, version or certificate
+  binding must not be trusted, not even as a hint.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestCacheRejectsTamperedEntry (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS                  Status;
+  UINTN                       CertIndex;
+  MFCI_VERIFIED_POLICY_CACHE  *Cache;
+
+  Cache = (MFCI_VERIFIED_POLICY_CACHE *)mCacheVarData;
+
+  Status = SetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, MFCI_TEST_CERT_INDEX);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  mCacheVarAttr = MFCI_POLICY_VARIABLE_ATTR & ~EFI_VARIABLE_NON_VOLATILE;
+  Status        = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  UT_ASSERT_EQUAL (CertIndex, 0);
+  mCacheVarAttr = MFCI_POLICY_VARIABLE_ATTR;
+
+  mCacheVarSize = sizeof (MFCI_VERIFIED_POLICY_CACHE) - 1;
+  Status        = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  mCacheVarSize = sizeof (MFCI_VERIFIED_POLICY_CACHE);
+
+  Cache->Version = MFCI_VERIFIED_POLICY_CACHE_VERSION + 1;
+  Status         = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  Cache->Version = MFCI_VERIFIED_POLICY_CACHE_VERSION;
+
+  Cache->CertDigest[0] ^= 0xFF;
+  Status                = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  UT_ASSERT_EQUAL (CertIndex, 0);
+  Cache->CertDigest[0] ^= 0xFF;
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The cache must be neither consulted nor updated when the variable
+  policy protecting it is not in place.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestCacheUntrustedWithoutPolicy (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       CertIndex;
+
+  Status = SetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, MFCI_TEST_CERT_INDEX);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  mVarPolicyRegistered = FALSE;
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_ACCESS_DENIED);
+  UT_ASSERT_EQUAL (CertIndex, 0);
+
+  mCacheVarPresent = FALSE;
+  Status           = SetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, MFCI_TEST_CERT_INDEX);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_ACCESS_DENIED);
+  UT_ASSERT_FALSE (mCacheVarPresent);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Invalid inputs should be rejected without touching the variable.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestCacheCheckInputs (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       CertIndex;
+
+  Status = GetVerifiedPolicyCache (NULL, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, 0, MFCI_TEST_NONCE, &CertIndex);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  Status = GetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  Status = SetVerifiedPolicyCache (NULL, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, MFCI_TEST_CERT_INDEX);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  Status = SetVerifiedPolicyCache (mPolicyBlob1, sizeof (mPolicyBlob1), MFCI_TEST_NONCE, 0);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  UT_ASSERT_FALSE (mCacheVarPresent);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  verified policy cache and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      VerifiedPolicyCacheSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the VerifiedPolicyCacheSuite Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&VerifiedPolicyCacheSuite, Framework, "VerifiedPolicyCache", "Mfci.VerifiedPolicyCache", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for VerifiedPolicyCacheSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (VerifiedPolicyCacheSuite, "Verified policy cache should hit for a recorded blob and nonce", "CacheHit", UnitTestCacheHitAfterSet, CachePrerequisite, NULL, NULL);
+  AddTestCase (VerifiedPolicyCacheSuite, "Verified policy cache should miss for a different blob or nonce", "CacheMiss", UnitTestCacheMissOnMismatch, CachePrerequisite, NULL, NULL);
+  AddTestCase (VerifiedPolicyCacheSuite, "Verified policy cache should reject tampered entries", "CacheTampered", UnitTestCacheRejectsTamperedEntry, CachePrerequisite, NULL, NULL);
+  AddTestCase (VerifiedPolicyCacheSuite, "Verified policy cache should not be trusted without variable policy", "CacheUntrusted", UnitTestCacheUntrustedWithoutPolicy, CachePrerequisite, NULL, NULL);
+  AddTestCase (VerifiedPolicyCacheSuite, "Verified policy cache should check inputs for validity", "CheckInputs", UnitTestCacheCheckInputs, CachePrerequisite, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
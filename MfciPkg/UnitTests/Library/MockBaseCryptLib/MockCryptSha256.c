@@ -0,0 +1,66 @@
+/** @file
+  Cryptographic Library instance for host based unit test in MFCI.
+
+  This function provides a deterministic, non-cryptographic stand-in for
+  SHA-256 so that MFCI logic keyed on digests can be tested without an
+  OpenSSL dependency.  Equal inputs produce equal digests and a change in
+  any input byte changes the digest, which is all the MFCI logic relies on.
+
+  Copyright (c) Microsoft Corporation.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseCryptLib.h>
+#include <Library/DebugLib.h>
+
+#define MOCK_FNV_OFFSET_BASIS  0xcbf29ce484222325ULL
+#define MOCK_FNV_PRIME         0x00000100000001b3ULL
+
+/**
+  Computes a mocked SHA-256 digest of the input data buffer.
+
+  @param[in]   Data        Pointer to the buffer containing the data to be hashed.
+  @param[in]   DataSize    Size of Data buffer in bytes.
+  @param[out]  HashValue   Pointer to a buffer that receives the mocked SHA-256 digest
+                           value (32 bytes).
+
+  @retval TRUE   Mocked SHA-256 digest computation succeeded.
+  @retval FALSE  HashValue is NULL, or Data is NULL with a non-zero DataSize.
+
+**/
+BOOLEAN
+EFIAPI
+Sha256HashAll (
+  IN   CONST VOID  *Data,
+  IN   UINTN       DataSize,
+  OUT  UINT8       *HashValue
+  )
+{
+  UINT64       Lane[SHA256_DIGEST_SIZE / sizeof (UINT64)];
+  CONST UINT8  *Bytes;
+  UINTN        Index;
+  UINTN        LaneIndex;
+
+  if ((HashValue == NULL) || ((Data == NULL) && (DataSize != 0))) {
+    return FALSE;
+  }
+
+  Bytes = Data;
+
+  // Four FNV-1a lanes with distinct seeds, each lane also folds in the data size
+  for (LaneIndex = 0; LaneIndex < ARRAY_SIZE (Lane); LaneIndex++) {
+    Lane[LaneIndex] = (MOCK_FNV_OFFSET_BASIS + LaneIndex) ^ (UINT64)DataSize;
+    for (Index = 0; Index < DataSize; Index++) {
+      Lane[LaneIndex] ^= Bytes[Index];
+      Lane[LaneIndex] *= MOCK_FNV_PRIME;
+    }
+
+    WriteUnaligned64 ((UINT64 *)(HashValue + LaneIndex * sizeof (UINT64)), Lane[LaneIndex]);
+  }
+
+  return TRUE;
+}
@@ -14,6 +14,7 @@
 #include <Library/DeviceSpecificBusInfoLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/MuTelemetryHelperLib.h>
+#include <Library/PcdLib.h>
 #include <Library/PciExpressLib.h>
 #include <Library/UefiLib.h>
 #include <Protocol/PciIo.h>
@@ -30,23 +31,21 @@ PerformPciChecks (
   )
 {
   EFI_STATUS               Status;
-  PCIE_LINK_SPEED          DeviceLinkSpeed;
   DEVICE_PCI_CHECK_RESULT  *DeviceCheckResult;
   DEVICE_PCI_INFO          *Devices;
   EFI_PCI_IO_PROTOCOL      **ProtocolList;
+  EFI_PCI_IO_PROTOCOL      **DeviceProtocol;
+  EFI_STATUS               *LinkStatus;
 
   UINTN  ProtocolCount;
-  UINTN  Seg;
-  UINTN  Bus;
-  UINTN  Dev;
-  UINTN  Fun;
   UINTN  NumDevices;
   UINTN  AdditionalData1;
   UINTN  Index;
-  UINTN  DeviceIndex;
 
-  Devices      = NULL;
-  ProtocolList = NULL;
+  Devices        = NULL;
+  ProtocolList   = NULL;
+  DeviceProtocol = NULL;
+  LinkStatus     = NULL;
 
   // Get the set of platform-defined PCI devices
   NumDevices = GetPciCheckDevices (&Devices);
@@ -59,29 +58,37 @@ PerformPciChecks (
     return;
   }
 
+  DeviceProtocol = AllocateZeroPool (sizeof (EFI_PCI_IO_PROTOCOL *) * NumDevices);
+  LinkStatus     = AllocateZeroPool (sizeof (EFI_STATUS) * NumDevices);
+  if ((DeviceProtocol == NULL) || (LinkStatus == NULL)) {
+    goto Cleanup;
+  }
+
   Status = EfiLocateProtocolBuffer (&gEfiPciIoProtocolGuid, &ProtocolCount, (VOID ***)&ProtocolList);
   if (EFI_ERROR (Status)) {
     goto Cleanup;
   }
 
-  for (Index = 0; Index < ProtocolCount; Index++) {
-    Status = ProtocolList[Index]->GetLocation (ProtocolList[Index], &Seg, &Bus, &Dev, &Fun);
-    if (EFI_ERROR (Status)) {
-      continue;
-    }
+  // Find the protocol instance of each device
+  Status = MatchPciCheckDevices (Devices, NumDevices, ProtocolList, ProtocolCount, DeviceProtocol);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a - Failed to match the PCI devices - %r\n", __FUNCTION__, Status));
+    goto Cleanup;
+  }
 
-    for (DeviceIndex = 0; DeviceIndex < NumDevices; DeviceIndex++) {
-      // Check if that device matches the current protocol
-      if ((Seg == Devices[DeviceIndex].SegmentNumber) &&
-          (Bus == Devices[DeviceIndex].BusNumber) &&
-          (Dev == Devices[DeviceIndex].DeviceNumber) &&
-          (Fun == Devices[DeviceIndex].FunctionNumber))
-      {
-        DeviceCheckResult[DeviceIndex].DevicePresent = TRUE;
-      }
-    }
+  for (Index = 0; Index < NumDevices; Index++) {
+    DeviceCheckResult[Index].DevicePresent = (DeviceProtocol[Index] != NULL);
   }
 
+  CheckPciDeviceLinkSpeeds (
+    Devices,
+    NumDevices,
+    DeviceProtocol,
+    (UINTN)FixedPcdGet32 (PcdCheckHardwareConnectedLinkTrainingTimeout) * 1000,
+    DeviceCheckResult,
+    LinkStatus
+    );
+
   for (Index = 0; Index < NumDevices; Index++) {
     // Get the BDF for AdditionalData1 to be used in potential telemetry calls
     AdditionalData1 = PCI_ECAM_ADDRESS (
@@ -91,38 +98,28 @@ PerformPciChecks (
                         0
                         );
 
-    if (Devices[Index].MinimumLinkSpeed != Ignore) {
-      Status = GetPciExpressDeviceLinkSpeed (ProtocolList[Index], &DeviceLinkSpeed);
-      if (EFI_ERROR (Status)) {
-        DeviceCheckResult[Index].LinkSpeedResult.ActualSpeed = Unknown;
-
-        // Log to telemetry that an error prevented an unignored link speed from being read
-        LogTelemetry (
-          Devices[Index].IsFatal,
-          NULL,
-          (EFI_IO_BUS_PCI | EFI_IOB_EC_CONTROLLER_ERROR),
-          &gDeviceSpecificBusInfoLibTelemetryGuid,
-          NULL,
-          AdditionalData1,
-          *((UINT64 *)Devices[Index].DeviceName)
-          );
-      } else {
-        DeviceCheckResult[Index].LinkSpeedResult.ActualSpeed = DeviceLinkSpeed;
-        if ((Devices[Index].MinimumLinkSpeed <= DeviceLinkSpeed) && (DeviceLinkSpeed != Unknown)) {
-          DeviceCheckResult[Index].LinkSpeedResult.MinimumSatisfied = TRUE;
-        } else {
-          // Log to telemetry that a specified minimum link speed was not satisfied
-          LogTelemetry (
-            Devices[Index].IsFatal,
-            NULL,
-            (EFI_IO_BUS_PCI | EFI_IOB_EC_NOT_SUPPORTED),
-            &gDeviceSpecificBusInfoLibTelemetryGuid,
-            NULL,
-            AdditionalData1,
-            *((UINT64 *)Devices[Index].DeviceName)
-            );
-        }
-      }
+    if (EFI_ERROR (LinkStatus[Index]) && (LinkStatus[Index] != EFI_NOT_STARTED)) {
+      // Log to telemetry that an error prevented an unignored link speed from being read
+      LogTelemetry (
+        Devices[Index].IsFatal,
+        NULL,
+        (EFI_IO_BUS_PCI | EFI_IOB_EC_CONTROLLER_ERROR),
+        &gDeviceSpecificBusInfoLibTelemetryGuid,
+        NULL,
+        AdditionalData1,
+        *((UINT64 *)Devices[Index].DeviceName)
+        );
+    } else if ((LinkStatus[Index] == EFI_SUCCESS) && !DeviceCheckResult[Index].LinkSpeedResult.MinimumSatisfied) {
+      // Log to telemetry that a specified minimum link speed was not satisfied
+      LogTelemetry (
+        Devices[Index].IsFatal,
+        NULL,
+        (EFI_IO_BUS_PCI | EFI_IOB_EC_NOT_SUPPORTED),
+        &gDeviceSpecificBusInfoLibTelemetryGuid,
+        NULL,
+        AdditionalData1,
+        *((UINT64 *)Devices[Index].DeviceName)
+        );
     }
 
     if (DeviceCheckResult[Index].DevicePresent == FALSE) {
@@ -145,6 +142,14 @@ Cleanup:
     FreePool (DeviceCheckResult);
   }
 
+  if (DeviceProtocol != NULL) {
+    FreePool (DeviceProtocol);
+  }
+
+  if (LinkStatus != NULL) {
+    FreePool (LinkStatus);
+  }
+
   if (ProtocolList != NULL) {
     FreePool (ProtocolList);
   }
@@ -29,4 +29,63 @@ GetPciExpressDeviceLinkSpeed (
   OUT   PCIE_LINK_SPEED      *DeviceLinkSpeed
   );
 
+/**
+  Associates each platform device with the PCI I/O protocol instance found at its location.
+
+  The platform devices are placed in a hash table keyed by their packed segment, bus, device and
+  function numbers, so each protocol instance is located with a single lookup instead of being
+  compared with every platform device.
+
+  @param[in]  Devices               The platform devices returned by GetPciCheckDevices ().
+  @param[in]  NumDevices            The number of elements in Devices.
+  @param[in]  ProtocolList          The PCI I/O protocol instances in the system.
+  @param[in]  ProtocolCount         The number of elements in ProtocolList.
+  @param[out] DeviceProtocol        An array of NumDevices elements. Each element is set to the protocol
+                                    instance located at the BDF of the device with the same index, or
+                                    NULL if no instance is at that location.
+
+  @retval     EFI_SUCCESS           DeviceProtocol was filled in.
+  @retval     EFI_INVALID_PARAMETER A required pointer parameter is NULL.
+  @retval     EFI_OUT_OF_RESOURCES  The hash table could not be allocated.
+
+**/
+EFI_STATUS
+MatchPciCheckDevices (
+  IN  DEVICE_PCI_INFO      *Devices,
+  IN  UINTN                NumDevices,
+  IN  EFI_PCI_IO_PROTOCOL  **ProtocolList,
+  IN  UINTN                ProtocolCount,
+  OUT EFI_PCI_IO_PROTOCOL  **DeviceProtocol
+  );
+
+/**
+  Checks the link speed of every present platform device that specifies a minimum link speed.
+
+  If TimeoutInMicroseconds is not 0, devices whose link is below the minimum speed are polled until
+  every link is satisfied or the timeout expires. All pending devices are polled together against
+  the same timeout, so the total wait does not grow with the number of devices.
+
+  @param[in]  Devices               The platform devices returned by GetPciCheckDevices ().
+  @param[in]  NumDevices            The number of elements in Devices.
+  @param[in]  DeviceProtocol        The protocol instance of each device as returned by
+                                    MatchPciCheckDevices (). Devices with a NULL instance are skipped.
+  @param[in]  TimeoutInMicroseconds The maximum time to wait for links to train, or 0 to not wait.
+  @param[out] Results               The LinkSpeedResult of each checked device is updated.
+  @param[out] LinkStatus            An array of NumDevices elements. Each checked device receives the
+                                    status of its last GetPciExpressDeviceLinkSpeed () call. Other
+                                    elements are set to EFI_NOT_STARTED.
+
+  @return     The number of checked devices whose minimum link speed is not satisfied.
+
+**/
+UINTN
+CheckPciDeviceLinkSpeeds (
+  IN  DEVICE_PCI_INFO          *Devices,
+  IN  UINTN                    NumDevices,
+  IN  EFI_PCI_IO_PROTOCOL      **DeviceProtocol,
+  IN  UINTN                    TimeoutInMicroseconds,
+  OUT DEVICE_PCI_CHECK_RESULT  *Results,
+  OUT EFI_STATUS               *LinkStatus
+  );
+
 #endif
@@ -9,11 +9,29 @@
 #include <Uefi.h>
 #include <IndustryStandard/Pci.h>
 #include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
 #include <Library/DeviceSpecificBusInfoLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
 #include <Protocol/PciIo.h>
 
 #include "CheckHardwareConnected.h"
 
+//
+// Time between two reads of the links that have not reached their minimum speed yet.
+//
+#define LINK_TRAINING_POLL_INTERVAL_US  1000
+
+//
+// Smallest hash table used for the platform devices, as a power of two.
+//
+#define PCI_CHECK_MIN_TABLE_BITS  4
+
+//
+// Multiplier of the Fibonacci hash (2^32 / golden ratio).
+//
+#define PCI_CHECK_HASH_MULTIPLIER  0x9E3779B1
+
 typedef enum {
   PciDevice,
   PciP2pBridge,
@@ -33,6 +51,11 @@ typedef struct {
   UINT32                           Data[48];
 } PCI_CONFIG_SPACE;
 
+typedef struct {
+  UINT32    Key;                    // Segment[31:16], Bus[15:8], Device[7:3], Function[2:0]
+  UINT32    DeviceIndex;            // Index of the platform device plus one, 0 if the slot is empty
+} PCI_CHECK_SLOT;
+
 /**
   Locate capability register block per capability ID.
 
@@ -173,3 +196,327 @@ GetPciExpressDeviceLinkSpeed (
 
   return EFI_SUCCESS;
 }
+
+/**
+  Packs a PCI location into a hash key.
+
+  @param[in]  Seg   The segment number.
+  @param[in]  Bus   The bus number.
+  @param[in]  Dev   The device number.
+  @param[in]  Fun   The function number.
+  @param[out] Key   The packed location.
+
+  @retval     TRUE  The location is valid and Key was set.
+  @retval     FALSE A number is out of range, so the location cannot match any device.
+
+**/
+STATIC
+BOOLEAN
+PackPciLocation (
+  IN  UINTN   Seg,
+  IN  UINTN   Bus,
+  IN  UINTN   Dev,
+  IN  UINTN   Fun,
+  OUT UINT32  *Key
+  )
+{
+  if ((Seg > MAX_UINT16) || (Bus > PCI_MAX_BUS) || (Dev > PCI_MAX_DEVICE) || (Fun > PCI_MAX_FUNC)) {
+    return FALSE;
+  }
+
+  *Key = (UINT32)((Seg << 16) | (Bus << 8) | (Dev << 3) | Fun);
+  return TRUE;
+}
+
+/**
+  Associates each platform device with the PCI I/O protocol instance found at its location.
+
+  The platform devices are placed in a hash table keyed by their packed segment, bus, device and
+  function numbers, so each protocol instance is located with a single lookup instead of being
+  compared with every platform device.
+
+  @param[in]  Devices               The platform devices returned by GetPciCheckDevices ().
+  @param[in]  NumDevices            The number of elements in Devices.
+  @param[in]  ProtocolList          The PCI I/O protocol instances in the system.
+  @param[in]  ProtocolCount         The number of elements in ProtocolList.
+  @param[out] DeviceProtocol        An array of NumDevices elements. Each element is set to the protocol
+                                    instance located at the BDF of the device with the same index, or
+                                    NULL if no instance is at that location.
+
+  @retval     EFI_SUCCESS           DeviceProtocol was filled in.
+  @retval     EFI_INVALID_PARAMETER A required pointer parameter is NULL.
+  @retval     EFI_OUT_OF_RESOURCES  The hash table could not be allocated.
+
+**/
+EFI_STATUS
+MatchPciCheckDevices (
+  IN  DEVICE_PCI_INFO      *Devices,
+  IN  UINTN                NumDevices,
+  IN  EFI_PCI_IO_PROTOCOL  **ProtocolList,
+  IN  UINTN                ProtocolCount,
+  OUT EFI_PCI_IO_PROTOCOL  **DeviceProtocol
+  )
+{
+  EFI_STATUS      Status;
+  PCI_CHECK_SLOT  *Table;
+  UINTN           TableBits;
+  UINT32          TableMask;
+  UINT32          Slot;
+  UINT32          Key;
+  UINTN           Seg;
+  UINTN           Bus;
+  UINTN           Dev;
+  UINTN           Fun;
+  UINTN           Index;
+
+  if ((Devices == NULL) || (DeviceProtocol == NULL) || ((ProtocolList == NULL) && (ProtocolCount != 0))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  for (Index = 0; Index < NumDevices; Index++) {
+    DeviceProtocol[Index] = NULL;
+  }
+
+  if ((NumDevices == 0) || (ProtocolCount == 0)) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Keep the table at most half full so that probe sequences stay short.
+  //
+  TableBits = PCI_CHECK_MIN_TABLE_BITS;
+  while ((TableBits < 31) && ((1u << TableBits) < NumDevices * 2)) {
+    TableBits++;
+  }
+
+  if ((1u << TableBits) < NumDevices * 2) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  TableMask = (1u << TableBits) - 1;
+  Table     = AllocateZeroPool (sizeof (PCI_CHECK_SLOT) << TableBits);
+  if (Table == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < NumDevices; Index++) {
+    if (!PackPciLocation (
+           Devices[Index].SegmentNumber,
+           Devices[Index].BusNumber,
+           Devices[Index].DeviceNumber,
+           Devices[Index].FunctionNumber,
+           &Key
+           ))
+    {
+      DEBUG ((DEBUG_WARN, "%a - Device %u has an invalid PCI location.\n", __FUNCTION__, (UINT32)Index));
+      continue;
+    }
+
+    Slot = (Key * PCI_CHECK_HASH_MULTIPLIER) >> (32 - TableBits);
+    while (Table[Slot].DeviceIndex != 0) {
+      Slot = (Slot + 1) & TableMask;
+    }
+
+    Table[Slot].Key         = Key;
+    Table[Slot].DeviceIndex = (UINT32)Index + 1;
+  }
+
+  for (Index = 0; Index < ProtocolCount; Index++) {
+    Status = ProtocolList[Index]->GetLocation (ProtocolList[Index], &Seg, &Bus, &Dev, &Fun);
+    if (EFI_ERROR (Status) || !PackPciLocation (Seg, Bus, Dev, Fun, &Key)) {
+      continue;
+    }
+
+    //
+    // The platform may list the same location more than once, so walk the whole probe sequence.
+    //
+    Slot = (Key * PCI_CHECK_HASH_MULTIPLIER) >> (32 - TableBits);
+    while (Table[Slot].DeviceIndex != 0) {
+      if ((Table[Slot].Key == Key) && (DeviceProtocol[Table[Slot].DeviceIndex - 1] == NULL)) {
+        DeviceProtocol[Table[Slot].DeviceIndex - 1] = ProtocolList[Index];
+      }
+
+      Slot = (Slot + 1) & TableMask;
+    }
+  }
+
+  FreePool (Table);
+  return EFI_SUCCESS;
+}
+
+/**
+  Reads the link speed of a device and updates its result.
+
+  @param[in]  Device      The platform device.
+  @param[in]  PciIo       The protocol instance of the device.
+  @param[out] Result      The LinkSpeedResult of the device is updated.
+  @param[out] LinkStatus  Receives the status of GetPciExpressDeviceLinkSpeed ().
+
+  @retval     TRUE        The link speed was read and is below the minimum, so it may still be training.
+  @retval     FALSE       The minimum link speed is satisfied or the link speed could not be read.
+
+**/
+STATIC
+BOOLEAN
+UpdatePciDeviceLinkSpeed (
+  IN  DEVICE_PCI_INFO          *Device,
+  IN  EFI_PCI_IO_PROTOCOL      *PciIo,
+  OUT DEVICE_PCI_CHECK_RESULT  *Result,
+  OUT EFI_STATUS               *LinkStatus
+  )
+{
+  PCIE_LINK_SPEED  DeviceLinkSpeed;
+
+  *LinkStatus = GetPciExpressDeviceLinkSpeed (PciIo, &DeviceLinkSpeed);
+  if (EFI_ERROR (*LinkStatus)) {
+    Result->LinkSpeedResult.ActualSpeed      = Unknown;
+    Result->LinkSpeedResult.MinimumSatisfied = FALSE;
+    return FALSE;
+  }
+
+  Result->LinkSpeedResult.ActualSpeed      = DeviceLinkSpeed;
+  Result->LinkSpeedResult.MinimumSatisfied = (Device->MinimumLinkSpeed <= DeviceLinkSpeed) && (DeviceLinkSpeed != Unknown);
+  return !Result->LinkSpeedResult.MinimumSatisfied;
+}
+
+/**
+  Returns the number of performance counter ticks between two counter values.
+
+  The interval must be shorter than one period of the counter.
+
+  @param[in]  Previous  Counter value at the start of the interval.
+  @param[in]  Current   Counter value at the end of the interval.
+
+  @return     The number of ticks, accounting for the direction and wrap of the counter.
+
+**/
+STATIC
+UINT64
+PerformanceCounterTicksBetween (
+  IN UINT64  Previous,
+  IN UINT64  Current
+  )
+{
+  UINT64  StartValue;
+  UINT64  EndValue;
+
+  GetPerformanceCounterProperties (&StartValue, &EndValue);
+  if (StartValue < EndValue) {
+    if (Current >= Previous) {
+      return Current - Previous;
+    }
+
+    return (EndValue - Previous) + (Current - StartValue) + 1;
+  }
+
+  if (Previous >= Current) {
+    return Previous - Current;
+  }
+
+  return (Previous - EndValue) + (StartValue - Current) + 1;
+}
+
+/**
+  Checks the link speed of every present platform device that specifies a minimum link speed.
+
+  If TimeoutInMicroseconds is not 0, devices whose link is below the minimum speed are polled until
+  every link is satisfied or the timeout expires. All pending devices are polled together against
+  the same timeout, so the total wait does not grow with the number of devices. The timeout is
+  measured with the performance counter, so it includes the time spent reading the links.
+
+  @param[in]  Devices               The platform devices returned by GetPciCheckDevices ().
+  @param[in]  NumDevices            The number of elements in Devices.
+  @param[in]  DeviceProtocol        The protocol instance of each device as returned by
+                                    MatchPciCheckDevices (). Devices with a NULL instance are skipped.
+  @param[in]  TimeoutInMicroseconds The maximum time to wait for links to train, or 0 to not wait.
+  @param[out] Results               The LinkSpeedResult of each checked device is updated.
+  @param[out] LinkStatus            An array of NumDevices elements. Each checked device receives the
+                                    status of its last GetPciExpressDeviceLinkSpeed () call. Other
+                                    elements are set to EFI_NOT_STARTED.
+
+  @return     The number of checked devices whose minimum link speed is not satisfied.
+
+**/
+UINTN
+CheckPciDeviceLinkSpeeds (
+  IN  DEVICE_PCI_INFO          *Devices,
+  IN  UINTN                    NumDevices,
+  IN  EFI_PCI_IO_PROTOCOL      **DeviceProtocol,
+  IN  UINTN                    TimeoutInMicroseconds,
+  OUT DEVICE_PCI_CHECK_RESULT  *Results,
+  OUT EFI_STATUS               *LinkStatus
+  )
+{
+  UINTN   Index;
+  UINTN   Pending;
+  UINTN   Unsatisfied;
+  UINTN   Delay;
+  UINT64  TimeoutNs;
+  UINT64  ElapsedNs;
+  UINT64  ElapsedTicks;
+  UINT64  PreviousCounter;
+  UINT64  CurrentCounter;
+
+  if ((Devices == NULL) || (DeviceProtocol == NULL) || (Results == NULL) || (LinkStatus == NULL)) {
+    ASSERT ((Devices != NULL) && (DeviceProtocol != NULL) && (Results != NULL) && (LinkStatus != NULL));
+    return 0;
+  }
+
+  Pending = 0;
+  for (Index = 0; Index < NumDevices; Index++) {
+    LinkStatus[Index] = EFI_NOT_STARTED;
+    if (Devices[Index].MinimumLinkSpeed == Ignore) {
+      continue;
+    }
+
+    if (DeviceProtocol[Index] == NULL) {
+      Results[Index].LinkSpeedResult.ActualSpeed = Unknown;
+      continue;
+    }
+
+    if (UpdatePciDeviceLinkSpeed (&Devices[Index], DeviceProtocol[Index], &Results[Index], &LinkStatus[Index])) {
+      Pending++;
+    }
+  }
+
+  TimeoutNs       = MultU64x32 ((UINT64)TimeoutInMicroseconds, 1000);
+  ElapsedNs       = 0;
+  ElapsedTicks    = 0;
+  PreviousCounter = GetPerformanceCounter ();
+  while ((Pending > 0) && (ElapsedNs < TimeoutNs)) {
+    Delay = (UINTN)MIN ((UINT64)LINK_TRAINING_POLL_INTERVAL_US, DivU64x32 (TimeoutNs - ElapsedNs + 999, 1000));
+    MicroSecondDelay (Delay);
+
+    Pending = 0;
+    for (Index = 0; Index < NumDevices; Index++) {
+      if ((LinkStatus[Index] != EFI_SUCCESS) || Results[Index].LinkSpeedResult.MinimumSatisfied) {
+        continue;
+      }
+
+      if (UpdatePciDeviceLinkSpeed (&Devices[Index], DeviceProtocol[Index], &Results[Index], &LinkStatus[Index])) {
+        Pending++;
+      }
+    }
+
+    //
+    // Add up the counter per poll so a counter that wraps during a long timeout is still measured.
+    //
+    CurrentCounter   = GetPerformanceCounter ();
+    ElapsedTicks    += PerformanceCounterTicksBetween (PreviousCounter, CurrentCounter);
+    PreviousCounter  = CurrentCounter;
+    ElapsedNs        = GetTimeInNanoSecond (ElapsedTicks);
+  }
+
+  Unsatisfied = 0;
+  for (Index = 0; Index < NumDevices; Index++) {
+    if ((LinkStatus[Index] != EFI_NOT_STARTED) && !Results[Index].LinkSpeedResult.MinimumSatisfied) {
+      Unsatisfied++;
+    }
+  }
+
+  if (ElapsedNs > 0) {
+    DEBUG ((DEBUG_INFO, "%a - Waited %lu us for link training, %u link(s) below minimum speed.\n", __FUNCTION__, DivU64x32 (ElapsedNs, 1000), (UINT32)Unsatisfied));
+  }
+
+  return Unsatisfied;
+}
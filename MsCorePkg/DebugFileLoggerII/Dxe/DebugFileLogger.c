@@ -16,6 +16,7 @@
 VOID                      *mFileSystemRegistration    = NULL;
 CHAR8                     *mLoggingBuffer             = NULL;
 UINT64                    mLoggingBuffer_BytesWritten = 0;
+UINT64                    mLoggingBuffer_BytesFlushed = 0;
 UINT64                    mLoggingBuffer_Size         = 0;
 LIST_ENTRY                mLoggingDeviceHead          = INITIALIZE_LIST_HEAD_VARIABLE (mLoggingDeviceHead);
 UINT32                    mLoggingSemaphore           = 0;
@@ -135,51 +136,110 @@ CleanUp:
 }
 
 /**
-    WriteLogFiles
+    WriteLogDevices
 
-    Write current log file to all of the logged file systems
+    Write the new part of the log to all of the logged file systems.  Each device
+    only receives the bytes past its CurrentOffset.
+
+    @retval   TRUE      The log devices were written
+    @retval   FALSE     A write was already in progress
 
   **/
-VOID
-WriteLogFiles (
+STATIC
+BOOLEAN
+WriteLogDevices (
   VOID
   )
 {
   LIST_ENTRY  *Link;
   LOG_DEVICE  *LogDevice;
-  UINT64      TimeEnd;
-  UINT64      TimeStart;
+  UINT64      BytesWritten;
 
   //
   // Use an atomic lock to catch a re-entrant call. Non-zero means we've entered
   // a second time.
   //
-  DEBUG ((DEBUG_INFO, "Entry to WriteLogFiles.\n"));
   if (InterlockedCompareExchange32 (&mWritingSemaphore, 0, 1) != 0) {
-    DEBUG ((DEBUG_ERROR, "WriteLogFiles blocked.\n"));
-    return;
+    return FALSE;
   }
 
-  TimeStart = GetPerformanceCounter ();
+  //
+  // Status codes are captured at TPL_HIGH_LEVEL, so the buffer may grow while the
+  // devices are written.  Write every device up to the same length.
+  //
+  BytesWritten = mLoggingBuffer_BytesWritten;
 
   EFI_LIST_FOR_EACH (Link, &(mLoggingDeviceHead)) {
     LogDevice = LOG_DEVICE_FROM_LINK (Link);
 
     // Each logging device coud arrive with different data, so always pass
     // the current buffer size.
-    WriteALogFile (LogDevice, mLoggingBuffer, mLoggingBuffer_BytesWritten);
+    WriteALogFile (LogDevice, mLoggingBuffer, BytesWritten);
   }
 
-  TimeEnd = GetPerformanceCounter ();
-  DEBUG ((DEBUG_ERROR, "Time to write logs: %ld ms\n\n", (GetTimeInNanoSecond (TimeEnd-TimeStart) / (1000 * 1000))));
+  mLoggingBuffer_BytesFlushed = BytesWritten;
 
   //
   // Release the lock.
   //
   InterlockedCompareExchange32 (&mWritingSemaphore, 1, 0);
+  return TRUE;
+}
+
+/**
+    WriteLogFiles
+
+    Write current log file to all of the logged file systems
+
+  **/
+VOID
+WriteLogFiles (
+  VOID
+  )
+{
+  UINT64  TimeEnd;
+  UINT64  TimeStart;
+
+  DEBUG ((DEBUG_INFO, "Entry to WriteLogFiles.\n"));
+
+  TimeStart = GetPerformanceCounter ();
+
+  if (!WriteLogDevices ()) {
+    DEBUG ((DEBUG_ERROR, "WriteLogFiles blocked.\n"));
+    return;
+  }
+
+  TimeEnd = GetPerformanceCounter ();
+  DEBUG ((DEBUG_ERROR, "Time to write logs: %ld ms\n\n", (GetTimeInNanoSecond (TimeEnd-TimeStart) / (1000 * 1000))));
+
   DEBUG ((DEBUG_INFO, "Exit from WriteLogFiles.\n"));
 }
 
+/**
+    OnFlushTimer
+
+    Append what was logged since the previous write to the log files.
+
+    Nothing is logged here, so an idle system does not keep adding to the log
+    just to write it.
+
+    @param    Event           Not Used.
+    @param    Context         Not Used.
+
+  **/
+STATIC
+VOID
+EFIAPI
+OnFlushTimer (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  if (mLoggingBuffer_BytesWritten != mLoggingBuffer_BytesFlushed) {
+    WriteLogDevices ();
+  }
+}
+
 /**
     OnResetNotification
 
@@ -455,6 +515,7 @@ RegisterLogDevice (
   LogDevice->Handle        = Handle;
   LogDevice->FileIndex     = 0;
   LogDevice->CurrentOffset = 0;
+  LogDevice->LogFile       = NULL;
   LogDevice->Valid         = TRUE;
 
   Status = EnableLoggingOnThisDevice (LogDevice);
@@ -783,6 +844,54 @@ ProcessPostReadyToBootRegistration (
   return Status;
 }
 
+/**
+    ProcessFlushTimerRegistration
+
+    Start the timer that appends new log data to the log files while booting.
+
+    @param    VOID
+
+    @returns  EFI_SUCCESS   - The timer was started, or is not enabled
+    @returns  other         - failure code from CreateEvent or SetTimer
+
+  **/
+EFI_STATUS
+ProcessFlushTimerRegistration (
+  VOID
+  )
+{
+  EFI_EVENT   FlushTimerEvent;
+  EFI_STATUS  Status;
+
+  if (FixedPcdGet32 (PcdDebugFileLoggerFlushInterval) == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // TPL_CALLBACK is the highest TPL at which the file systems can be written.
+  //
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  OnFlushTimer,
+                  NULL,
+                  &FlushTimerEvent
+                  );
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to create flush timer (%r)\n", __FUNCTION__, Status));
+    return Status;
+  }
+
+  Status = gBS->SetTimer (FlushTimerEvent, TimerPeriodic, DEBUG_LOG_FLUSH_INTERVAL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to start flush timer (%r)\n", __FUNCTION__, Status));
+    gBS->CloseEvent (FlushTimerEvent);
+  }
+
+  return Status;
+}
+
 /**
     Main entry point for this driver.
 
@@ -840,6 +949,14 @@ DebugFileLoggerDxeEntry (
   // Step 5. Register for PostReadyToBoot Notifications.
   //
   Status = ProcessPostReadyToBootRegistration ();
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  //
+  // Step 6. Start writing the log periodically.
+  //
+  Status = ProcessFlushTimerRegistration ();
 
 Exit:
   DEBUG ((DEBUG_INFO, "%a: Leaving, code = %r\n", __FUNCTION__, Status));
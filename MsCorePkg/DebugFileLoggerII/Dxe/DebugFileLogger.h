@@ -55,7 +55,8 @@ typedef struct {
   LIST_ENTRY    Link;
   EFI_HANDLE    Handle;
   UINTN         FileIndex;
-  UINT64        CurrentOffset;
+  UINT64        CurrentOffset;                  // Bytes of the log already written to the log file
+  EFI_FILE      *LogFile;                       // Log file, kept open once first written
   BOOLEAN       Valid;
 } LOG_DEVICE;
 
@@ -82,6 +83,8 @@ typedef struct {
 
 #define LOG_DIRECTORY_NAME  L"\\Logs"
 
+#define DEBUG_LOG_FLUSH_INTERVAL  EFI_TIMER_PERIOD_MILLISECONDS (FixedPcdGet32 (PcdDebugFileLoggerFlushInterval))
+
 //
 // Iterate through the double linked list. NOT delete safe
 //
@@ -100,7 +103,8 @@ typedef struct {
 /**
   WriteALogFile
 
-  Writes the currently unwritten part of the log file.
+  Writes the currently unwritten part of the log file.  The log file is opened
+  the first time, and kept open for the following writes.
 
   @param   LogDevice        Which log device to write the log to
   @param   LogBuffer        The log data to be written
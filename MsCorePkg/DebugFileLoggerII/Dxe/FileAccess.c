@@ -337,6 +337,7 @@ CleanUp:
   Read the index value from the log index file.
 
   @param   LogDevice        Which log device to write the log to
+  @param   Volume           The open volume of the log device
 
   @retval  EFI_SUCCESS      The LogData->FileIndex was updated
   @retval  other            An error occurred.  The log device was disabled
@@ -345,20 +346,14 @@ CleanUp:
 STATIC
 EFI_STATUS
 DetermineLogFile (
-  IN LOG_DEVICE  *LogDevice
+  IN LOG_DEVICE  *LogDevice,
+  IN EFI_FILE    *Volume
   )
 {
   UINTN       BufferSize;
   EFI_FILE    *File;
   CHAR8       FileIndex;
   EFI_STATUS  Status;
-  EFI_FILE    *Volume;
-
-  Volume = VolumeFromFileSystemHandle (LogDevice->Handle);
-  if (NULL == Volume) {
-    LogDevice->Valid = FALSE;
-    return EFI_INVALID_PARAMETER;
-  }
 
   //
   // Open Index File
@@ -457,46 +452,34 @@ DetermineLogFile (
 }
 
 /**
-  WriteALogFIle
+  OpenLogFile
 
-  Writes the currently unwritten part of the log file.
+  Select the log file to use on this boot, and open it.
 
-  @param   LogDevice        Which log device to write the log to
-  @param   LogBuffer        The log data to be written
-  @param   LogBufferLength  The number of bytes to write to the log
+  @param   LogDevice        Which log device to open the log file on
 
-  @retval  EFI_SUCCESS      The log was updated
-  @retval  other            An error occurred.  The log device was disabled
+  @retval  EFI_SUCCESS      LogDevice->LogFile is open
+  @retval  other            An error occurred.
 
   **/
+STATIC
 EFI_STATUS
-WriteALogFile (
-  IN LOG_DEVICE  *LogDevice,
-  IN CHAR8       *LogBuffer,
-  IN UINT64      LogBufferLength
+OpenLogFile (
+  IN LOG_DEVICE  *LogDevice
   )
 {
-  CHAR8       *Buffer;
-  UINT64      BufferSize;
-  EFI_FILE    *File;
-  UINT64      RoomLeft;
   EFI_STATUS  Status;
   EFI_FILE    *Volume;
 
-  if (!LogDevice->Valid) {
-    return EFI_DEVICE_ERROR;
-  }
-
   Volume = VolumeFromFileSystemHandle (LogDevice->Handle);
   if (NULL == Volume) {
     return EFI_INVALID_PARAMETER;
   }
 
   if (LogDevice->FileIndex == 0) {
-    Status = DetermineLogFile (LogDevice);
+    Status = DetermineLogFile (LogDevice, Volume);
     if (EFI_ERROR (Status)) {
-      LogDevice->Valid = FALSE;
-      return Status;
+      goto CleanUp;
     }
   }
 
@@ -505,26 +488,51 @@ WriteALogFile (
   //
   Status = Volume->Open (
                      Volume,
-                     &File,
+                     &LogDevice->LogFile,
                      mLogFiles[LogDevice->FileIndex].LogFileName,
                      EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE,
                      0
                      );
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: Unable to open log file. Code = %r\n", __FUNCTION__, Status));
-    LogDevice->Valid = FALSE;
-    return Status;
+    LogDevice->LogFile = NULL;
   }
 
-  //
-  // Reposition the log file to the current offset.
-  //
-  Status = File->SetPosition (File, LogDevice->CurrentOffset);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a: Failed to seek to current offset: %r !\n", __FUNCTION__, Status));
-    LogDevice->Valid = FALSE;
-    File->Close (File);
-    return Status;
+CleanUp:
+  Volume->Close (Volume);
+
+  return Status;
+}
+
+/**
+  WriteALogFIle
+
+  Writes the currently unwritten part of the log file.  The log file is opened
+  the first time, and kept open for the following writes.
+
+  @param   LogDevice        Which log device to write the log to
+  @param   LogBuffer        The log data to be written
+  @param   LogBufferLength  The number of bytes to write to the log
+
+  @retval  EFI_SUCCESS      The log was updated
+  @retval  other            An error occurred.  The log device was disabled
+
+  **/
+EFI_STATUS
+WriteALogFile (
+  IN LOG_DEVICE  *LogDevice,
+  IN CHAR8       *LogBuffer,
+  IN UINT64      LogBufferLength
+  )
+{
+  CHAR8       *Buffer;
+  UINT64      BufferSize;
+  EFI_FILE    *File;
+  UINT64      RoomLeft;
+  EFI_STATUS  Status;
+
+  if (!LogDevice->Valid) {
+    return EFI_DEVICE_ERROR;
   }
 
   //
@@ -536,6 +544,34 @@ WriteALogFile (
     LogBufferLength = DEBUG_LOG_FILE_SIZE;
   }
 
+  //
+  // Everything up to CurrentOffset is already in the log file.  Don't touch
+  // the device when there is nothing new to write.
+  //
+  if (LogBufferLength <= LogDevice->CurrentOffset) {
+    return EFI_SUCCESS;
+  }
+
+  if (LogDevice->LogFile == NULL) {
+    Status = OpenLogFile (LogDevice);
+    if (EFI_ERROR (Status)) {
+      LogDevice->Valid = FALSE;
+      return Status;
+    }
+  }
+
+  File = LogDevice->LogFile;
+
+  //
+  // Reposition the log file to the current offset.  This overwrites the end
+  // of file marker of the previous write.
+  //
+  Status = File->SetPosition (File, LogDevice->CurrentOffset);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to seek to current offset: %r !\n", __FUNCTION__, Status));
+    goto Error;
+  }
+
   RoomLeft   = DEBUG_LOG_FILE_SIZE - LogDevice->CurrentOffset;
   BufferSize = LogBufferLength - LogDevice->CurrentOffset;
 
@@ -546,37 +582,46 @@ WriteALogFile (
 
   RoomLeft -= BufferSize;
 
+  Buffer = &LogBuffer[LogDevice->CurrentOffset];
+  Status = File->Write (File, &BufferSize, (VOID *)Buffer);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to write to log file: %r !\n", __FUNCTION__, Status));
+    goto Error;
+  }
+
+  LogDevice->CurrentOffset += BufferSize;
+  //
+  // Write End Of Buffer file mark.
+  //
+  BufferSize = END_OF_FILE_MARKER_SIZE;
+  if (BufferSize > RoomLeft) {
+    BufferSize = RoomLeft;
+  }
+
   if (BufferSize > 0) {
-    Buffer = &LogBuffer[LogDevice->CurrentOffset];
-    Status = File->Write (File, &BufferSize, (VOID *)Buffer);
+    Status = File->Write (File, &BufferSize, (VOID *)END_OF_FILE_MARKER);
     if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a: Failed to write to log file: %r !\n", __FUNCTION__, Status));
-      File->Close (File);
-      LogDevice->Valid = FALSE;
-      return Status;
-    }
-
-    LogDevice->CurrentOffset += BufferSize;
-    //
-    // Write End Of Buffer file mark.
-    //
-    BufferSize = END_OF_FILE_MARKER_SIZE;
-    if (BufferSize > RoomLeft) {
-      BufferSize = RoomLeft;
+      DEBUG ((DEBUG_ERROR, "%a: Failed to write end of buffer marker: %r !\n", __FUNCTION__, Status));
+      goto Error;
     }
+  }
 
-    if (BufferSize > 0) {
-      Status = File->Write (File, &BufferSize, (VOID *)END_OF_FILE_MARKER);
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "%a: Failed to write end of buffer marker: %r !\n", __FUNCTION__, Status));
-        File->Close (File);
-        LogDevice->Valid = FALSE;
-        return Status;
-      }
-    }
+  //
+  // The file stays open, so flush it to have the log on the media if the
+  // system hangs before the next write.
+  //
+  Status = File->Flush (File);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to flush log file: %r !\n", __FUNCTION__, Status));
+    goto Error;
   }
 
+  return EFI_SUCCESS;
+
+Error:
   File->Close (File);
+  LogDevice->LogFile = NULL;
+  LogDevice->Valid   = FALSE;
 
   return Status;
 }
@@ -12,12 +12,25 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define MU_PI  3.1415926535897932384626433832
 
+//
+// Largest error of sin_d and cos_d, in units in the last place, for angles
+// within 2^20 * pi/2 radians.  Beyond that the absolute error grows with the
+// angle, and angles of 2^30 radians or more return NaN.
+//
+#define MATH_LIB_TRIG_MAX_ULP  1
+
+//
+// Largest error of sqrt_d, in units in the last place, for any positive input.
+//
+#define MATH_LIB_SQRT_MAX_ULP  1
+
 /**
 Find sine of a provided double in radians
 
 @param[in] input angle to calculate in radians
 
-@retval the result (double)
+@retval the result (double), within MATH_LIB_TRIG_MAX_ULP for |angle| <= 2^20 * pi/2
+@retval NaN if the angle is not finite or its magnitude is 2^30 or more
 **/
 double
 EFIAPI
@@ -30,7 +43,8 @@ Find cosine of a provided double in radians
 
 @param[in]  angle to calculate in radians
 
-@retval the result (double)
+@retval the result (double), within MATH_LIB_TRIG_MAX_ULP for |angle| <= 2^20 * pi/2
+@retval NaN if the angle is not finite or its magnitude is 2^30 or more
 **/
 double
 EFIAPI
@@ -51,6 +65,43 @@ sqrt_d (
   IN CONST double  input
   );
 
+/**
+Find sine and cosine of each angle in an array.
+
+Gives the same results as calling sin_d and cos_d on each angle, but computes
+both from one range reduction and lets the compiler vectorize the loop.
+
+@param[in]  Angles   Angles in radians
+@param[out] Sines    Receives sin_d of each angle
+@param[out] Cosines  Receives cos_d of each angle
+@param[in]  Count    Number of angles
+**/
+VOID
+EFIAPI
+SinCosArray (
+  IN  CONST double  *Angles,
+  OUT double        *Sines,
+  OUT double        *Cosines,
+  IN  UINTN         Count
+  );
+
+/**
+Find square root of each double in an array.
+
+Gives the same results as calling sqrt_d on each input.
+
+@param[in]  Inputs   The numbers to square root
+@param[out] Results  Receives sqrt_d of each input
+@param[in]  Count    Number of inputs
+**/
+VOID
+EFIAPI
+SqrtArray (
+  IN  CONST double  *Inputs,
+  OUT double        *Results,
+  IN  UINTN         Count
+  );
+
 /**
 Find square root of the provided unsigned integer
 
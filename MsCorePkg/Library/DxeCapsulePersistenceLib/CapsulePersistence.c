@@ -28,6 +28,9 @@
 #define CAPSULE_DIR               L"Capsules"
 #define CAPSULE_DEFAULT_FILENAME  L"capsule00000.bin"
 #define CAPSULE_ID_MODULO         100000// because we have five digits
+#define CAPSULE_FILENAME_PREFIX   L"capsule"
+#define CAPSULE_FILENAME_SUFFIX   L".bin"
+#define CAPSULE_IO_CHUNK_SIZE     SIZE_1MB
 
 /**
   Gets the SFS protocol handle for the the first disk that has a GPT partition.
@@ -443,9 +446,50 @@ GenerateFileName (
   return EFI_SUCCESS;
 }
 
+/**
+  Parse the capsule ID out of a capsule file name.
+
+  @param[in]    Filename        Name of a file in the capsules directory
+  @param[out]   CapsuleId       Capsule ID encoded in the name
+
+  @retval       TRUE            Filename is a capsule file and CapsuleId is valid
+  @retval       FALSE           Filename is not a capsule file
+*/
+BOOLEAN
+STATIC
+ParseCapsuleFileName (
+  IN  CONST CHAR16  *Filename,
+  OUT UINTN         *CapsuleId
+  )
+{
+  CHAR16  *EndPointer;
+
+  if (StrnCmp (Filename, CAPSULE_FILENAME_PREFIX, StrLen (CAPSULE_FILENAME_PREFIX)) != 0) {
+    return FALSE;
+  }
+
+  Filename += StrLen (CAPSULE_FILENAME_PREFIX);
+  if ((*Filename < L'0') || (*Filename > L'9')) {
+    return FALSE;
+  }
+
+  if (EFI_ERROR (StrDecimalToUintnS (Filename, &EndPointer, CapsuleId))) {
+    return FALSE;
+  }
+
+  if (StrCmp (EndPointer, CAPSULE_FILENAME_SUFFIX) != 0) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(*CapsuleId < CAPSULE_ID_MODULO);
+}
+
 /**
   Generate Capsule ID to be used on the disk.
 
+  The capsules directory is enumerated once to build a bitmap of the IDs in use,
+  and the first free ID after the one handed out last is returned.
+
   @param[in]  FileSystemHandle        Root handle to SFS.
   @param[out] CapsuleId               The next free capsule ID
 
@@ -463,19 +507,22 @@ FindNextFreeCapsuleID (
   STATIC UINT32  CapsuleNum = 1;
   EFI_STATUS     Status;
   UINT32         CapsuleNumberModulo = CAPSULE_ID_MODULO;
-  CHAR16         Filename[]          = CAPSULE_DEFAULT_FILENAME;
-  UINTN          FilenameSize;
   EFI_FILE       *DirHandle;
-  EFI_FILE       *File;
-  UINTN          Attempts;
+  EFI_FILE_INFO  *FileInfo;
+  UINTN          FileInfoSize;
+  UINTN          AllocatedFileInfoSize;
+  UINT8          *UsedIds;
+  UINTN          UsedId;
+  UINT32         Attempts;
+  UINT32         Candidate;
 
   if ((FileSystemHandle == NULL) || (CapsuleId == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  FilenameSize = sizeof (Filename);
-  File         = NULL;
-  DirHandle    = NULL;
+  DirHandle = NULL;
+  FileInfo  = NULL;
+  UsedIds   = NULL;
 
   // Open Capsule directory
   Status = OpenCapsulesDirectory (FileSystemHandle, &DirHandle, FALSE);
@@ -489,46 +536,69 @@ FindNextFreeCapsuleID (
     goto Cleanup;
   }
 
-  Attempts = 0;
-  // create the number that our capsule will be
-  while (TRUE) {
-    Attempts += 1; // increment the number of attempts
-    // generate a new capsule id and filename
-    CapsuleNum = (CapsuleNum + Attempts) % CapsuleNumberModulo;
-    Status     = GenerateFileName (CapsuleNum, Filename, FilenameSize);
+  UsedIds = AllocateZeroPool ((CAPSULE_ID_MODULO + 7) / 8);
+  if (UsedIds == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Cleanup;
+  }
+
+  // Mark every ID that already has a file in a single pass over the directory.
+  AllocatedFileInfoSize = 0;
+  do {
+    FileInfoSize = AllocatedFileInfoSize;
+    Status       = DirHandle->Read (DirHandle, &FileInfoSize, FileInfo);
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      if (FileInfo != NULL) {
+        FreePool (FileInfo);
+      }
+
+      FileInfo = AllocatePool (FileInfoSize);
+      if (FileInfo == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto Cleanup;
+      }
+
+      AllocatedFileInfoSize = FileInfoSize;
+      continue;
+    }
+
     if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "[%a] - failed to generate a filename: %r\n", __FUNCTION__, Status));
+      DEBUG ((DEBUG_ERROR, "[%a] - failed to read the capsules directory: %r\n", __FUNCTION__, Status));
       goto Cleanup;
     }
 
-    // check if this particular file already exists
-    Status = DirHandle->Open (DirHandle, &File, Filename, EFI_FILE_MODE_READ, 0);
-    if (Status == EFI_NOT_FOUND) {
-      // if we didn't find it, success
-      Status = EFI_SUCCESS;
-      break;
+    if ((FileInfoSize != 0) &&
+        ((FileInfo->Attribute & EFI_FILE_DIRECTORY) == 0) &&
+        ParseCapsuleFileName (FileInfo->FileName, &UsedId))
+    {
+      UsedIds[UsedId / 8] |= (UINT8)(1 << (UsedId % 8));
     }
+  } while (FileInfoSize != 0);
 
-    // otherwise close it
-    File->Close (File);
-    File = NULL;
-    // make sure we don't loop forever
-    if (Attempts > 500) {
-      Status = EFI_OUT_OF_RESOURCES;
-      goto Cleanup;
+  // create the number that our capsule will be
+  Status = EFI_OUT_OF_RESOURCES;
+  for (Attempts = 1; Attempts <= CapsuleNumberModulo; Attempts++) {
+    Candidate = (CapsuleNum + Attempts) % CapsuleNumberModulo;
+    if ((UsedIds[Candidate / 8] & (1 << (Candidate % 8))) == 0) {
+      CapsuleNum = Candidate;
+      *CapsuleId = CapsuleNum;
+      Status     = EFI_SUCCESS;
+      break;
     }
   }
 
-  *CapsuleId = CapsuleNum;
-
 Cleanup:
 
   if (DirHandle != NULL) {
     DirHandle->Close (DirHandle);
   }
 
-  if (File != NULL) {
-    File->Close (File);
+  if (FileInfo != NULL) {
+    FreePool (FileInfo);
+  }
+
+  if (UsedIds != NULL) {
+    FreePool (UsedIds);
   }
 
   return Status;
@@ -615,33 +685,42 @@ Cleanup:
 }
 
 /**
-  Given a capsule, calculate a hash of it
+  Write a capsule to a file, or read it back from one, hashing the data in the same pass.
+
+  The data is moved in CAPSULE_IO_CHUNK_SIZE pieces and each piece is hashed while it is
+  still in the cache, so the capsule is only touched once.  Every write or read except
+  the last one starts at a CAPSULE_IO_CHUNK_SIZE aligned file offset.
 
-  @param[in]    CapsuleHeader         Points to the capsule
-  @param[out]   CapsuleHash           The hash of the capsule passed in
+  @param[in]      File                  File to write or read, positioned at offset 0
+  @param[in,out]  Buffer                Capsule data to write, or buffer to read the capsule into
+  @param[in]      BufferSize            Number of bytes to write or read
+  @param[in]      WriteToFile           TRUE to write Buffer to File, FALSE to read File into Buffer
+  @param[out]     CapsuleHash           The hash of the data written or read
 
-  @retval       EFI_SUCCESS           Hash was calculated successfully
-  @retval       EFI_INVALID_PARAMETER CapsuleHash or CapsuleHeader was null
+  @retval       EFI_SUCCESS           All data was transferred and CapsuleHash is valid
+  @retval       EFI_INVALID_PARAMETER File, Buffer or CapsuleHash was null
   @retval       EFI_OUT_OF_RESOURCES  Couldn't allocate memory for the hash
-  @retval       EFI_DEVICE_ERROR      Something went wrong hashing the capsule
+  @retval       EFI_DEVICE_ERROR      Something went wrong hashing the capsule or the file was short
+  @retval       Other                 The file write or read failed
 */
 EFI_STATUS
 STATIC
-CalculateCapsuleHash (
-  IN  EFI_CAPSULE_HEADER  *CapsuleHeader,
-  OUT UINT64              *CapsuleHash
+TransferAndHashCapsule (
+  IN     EFI_FILE  *File,
+  IN OUT VOID      *Buffer,
+  IN     UINTN     BufferSize,
+  IN     BOOLEAN   WriteToFile,
+  OUT    UINT64    *CapsuleHash
   )
 {
   VOID        *HashContext;
-  BOOLEAN     HashStatus;
   EFI_STATUS  Status;
   UINT8       Digest[SHA256_DIGEST_SIZE];
+  UINT8       *Chunk;
+  UINTN       ChunkSize;
+  UINTN       Remaining;
 
-  if (CapsuleHeader == NULL) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (CapsuleHash == NULL) {
+  if ((File == NULL) || (Buffer == NULL) || (CapsuleHash == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
@@ -651,23 +730,52 @@ CalculateCapsuleHash (
     return EFI_OUT_OF_RESOURCES;
   }
 
-  Status = EFI_SUCCESS;
-  // start by initializing the context
   ZeroMem (Digest, SHA256_DIGEST_SIZE);
-  HashStatus = Sha256Init (HashContext);
-  if (!HashStatus) {
+  if (!Sha256Init (HashContext)) {
     Status = EFI_DEVICE_ERROR;
     goto Cleanup;
   }
 
-  HashStatus = Sha256Update (HashContext, (VOID *)CapsuleHeader, CapsuleHeader->CapsuleImageSize);
-  if (!HashStatus) {
-    Status = EFI_DEVICE_ERROR;
-    goto Cleanup;
+  Status    = EFI_SUCCESS;
+  Chunk     = (UINT8 *)Buffer;
+  Remaining = BufferSize;
+  while (Remaining > 0) {
+    ChunkSize = MIN (Remaining, CAPSULE_IO_CHUNK_SIZE);
+    if (WriteToFile) {
+      if (!Sha256Update (HashContext, Chunk, ChunkSize)) {
+        Status = EFI_DEVICE_ERROR;
+        goto Cleanup;
+      }
+
+      Status = File->Write (File, &ChunkSize, Chunk);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "[%a] - Failed to write capsule data at offset 0x%x: %r\n", __FUNCTION__, BufferSize - Remaining, Status));
+        goto Cleanup;
+      }
+    } else {
+      Status = File->Read (File, &ChunkSize, Chunk);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "[%a] - Failed to read capsule data at offset 0x%x: %r\n", __FUNCTION__, BufferSize - Remaining, Status));
+        goto Cleanup;
+      }
+
+      if (ChunkSize == 0) {
+        DEBUG ((DEBUG_ERROR, "[%a] - Capsule file ended 0x%x bytes early\n", __FUNCTION__, Remaining));
+        Status = EFI_DEVICE_ERROR;
+        goto Cleanup;
+      }
+
+      if (!Sha256Update (HashContext, Chunk, ChunkSize)) {
+        Status = EFI_DEVICE_ERROR;
+        goto Cleanup;
+      }
+    }
+
+    Chunk     += ChunkSize;
+    Remaining -= ChunkSize;
   }
 
-  HashStatus = Sha256Final (HashContext, Digest);
-  if (!HashStatus) {
+  if (!Sha256Final (HashContext, Digest)) {
     Status = EFI_DEVICE_ERROR;
     goto Cleanup;
   }
@@ -854,14 +962,6 @@ InternalPersistCapsuleImageAcrossReset (
     goto Cleanup;
   }
 
-  DEBUG ((DEBUG_INFO, "%a:%d - \n", __FUNCTION__, __LINE__));
-  // Get the hash of the Capsule to save into the system
-  Status = CalculateCapsuleHash (CapsuleHeader, &CapsuleHash);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "[%a] - Failed to calculate hash of capsule\n", __FUNCTION__));
-    goto Cleanup;
-  }
-
   DEBUG ((DEBUG_INFO, "%a:%d - \n", __FUNCTION__, __LINE__));
   // Create the file on the disk to store the capsule
   Status = CreateCapsuleFileOnFileSystem (FileSystemHandle, &FileHandle, CapsuleId);
@@ -871,10 +971,13 @@ InternalPersistCapsuleImageAcrossReset (
   }
 
   DEBUG ((DEBUG_INFO, "%a:%d - \n", __FUNCTION__, __LINE__));
-  // Write the capsule to the disk with the file handle we created
-  Status = FileHandle->Write (FileHandle, &CapsuleSize, CapsuleHeader);
+  // Write the capsule to the disk with the file handle we created, hashing it on the way
+  Status = TransferAndHashCapsule (FileHandle, CapsuleHeader, CapsuleSize, TRUE, &CapsuleHash);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "[%a] - Failed to write the capsule file to disk\n", __FUNCTION__));
+    // Don't leave a partial capsule behind
+    FileHandle->Delete (FileHandle); // delete implies close
+    FileHandle = NULL;
     goto Cleanup;
   }
 
@@ -981,10 +1084,8 @@ InternalGetPersistedCapsuleData (
     goto Cleanup;
   }
 
-  CapsuleSize = *CapsuleDataSize;
-
-  // read in the file from the disk
-  Status = File->Read (File, &CapsuleSize, CapsuleData);
+  // read in the file from the disk, hashing it as it is read
+  Status = TransferAndHashCapsule (File, CapsuleData, CapsuleSize, FALSE, &CalculatedCapsuleHash);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "[%a] - Failed to read capsule file\n", __FUNCTION__));
     goto Cleanup;
@@ -993,13 +1094,7 @@ InternalGetPersistedCapsuleData (
   // Check to make sure the file we read in matches what we expect
   if (CapsuleSize != CapsuleData->CapsuleImageSize) {
     DEBUG ((DEBUG_ERROR, "[%a] - File loaded is not the correct size. Expected %x Got %x\n", __FUNCTION__, CapsuleData->CapsuleImageSize, CapsuleSize));
-    return EFI_DEVICE_ERROR;
-  }
-
-  // calculate the hash of the capsule we just loaded from disk
-  Status = CalculateCapsuleHash (CapsuleData, &CalculatedCapsuleHash);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "[%a] - Failed to calculate hash for capsule\n", __FUNCTION__));
+    Status = EFI_DEVICE_ERROR;
     goto Cleanup;
   }
 
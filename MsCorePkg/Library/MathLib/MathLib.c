@@ -3,6 +3,18 @@ MathLib
 
 This library supports math operations such as Square Root, Cosine, and Sine
 
+sin_d and cos_d reduce the angle to [-pi/4, pi/4] with a three part Cody-Waite
+reduction and evaluate minimax polynomials fitted on that interval.  The
+polynomials alone are accurate to better than 2^-58 relative error, and the
+reduction is exact for |angle| <= 2^20 * pi/2, so results are within
+MATH_LIB_TRIG_MAX_ULP of the correctly rounded value over that range.
+
+sqrt_d starts from an exponent halving estimate and applies a fixed number of
+Newton steps, which is within MATH_LIB_SQRT_MAX_ULP for every positive input.
+
+Neither kernel branches on the input, so SinCosArray and SqrtArray are plain
+loops over them that compilers can vectorize.
+
 Copyright (C) Microsoft Corporation. All rights reserved.
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -10,21 +22,185 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Uefi.h>
 #include <Library/MathLib.h>
 
-#if _MSC_VER > 1500
-// Include explicit prototypes for intrinsic functions.
-unsigned char
-_BitScanReverse (
-  unsigned long  *Index,
-  unsigned long  Mask
-  );
+//
+// pi/2 split in three.  The first two parts have 33 significant bits, so N * part
+// is exact for |N| < 2^20, and the third part holds the next 53 bits.
+//
+#define PIO2_1     1.57079632673412561417e+00
+#define PIO2_2     6.07710050630396597660e-11
+#define PIO2_3     2.02226624879595063154e-21
+#define TWO_OVER_PI  6.36619772367581382433e-01
+
+//
+// Angles at or above this magnitude do not fit the quadrant count and return NaN.
+//
+#define TRIG_MAX_ANGLE  1073741824.0           // 2^30
+
+//
+// sin(r) = r + r^3 * (S1 + S2 z + ... + S6 z^5), z = r^2, relative error < 3.7e-18 on [-pi/4, pi/4]
+//
+#define S1  -1.66666666666666297e-01
+#define S2  8.33333333332211823e-03
+#define S3  -1.98412698295895415e-04
+#define S4  2.75573136213867008e-06
+#define S5  -2.50507477629874522e-08
+#define S6  1.58962301640191695e-10
+
+//
+// cos(r) = 1 - z/2 + z^2 * (C1 + C2 z + ... + C6 z^5), z = r^2, error < 6.9e-19 on [-pi/4, pi/4]
+//
+#define C1  4.16666666666666644e-02
+#define C2  -1.38888888888873976e-03
+#define C3  2.48015872987670410e-05
+#define C4  -2.75573172723441461e-07
+#define C5  2.08761463822201455e-09
+#define C6  -1.13826398057568854e-11
+
+//
+// sqrt_d constants.  SQRT_MAGIC halves the biased exponent of an input to give an
+// estimate within 4% of the root, and inputs below SQRT_SCALE_BELOW (subnormals)
+// are scaled up by 2^108 first so the estimate stays that close.
+//
+#define SQRT_MAGIC        0x1FF7A3BEA91D9B1BULL
+#define SQRT_SCALE_BELOW  2.2250738585072014e-308   // Smallest normal double
+#define SQRT_SCALE_UP     3.2451855365842673e+32    // 2^108
+#define SQRT_SCALE_DOWN   5.5511151231257827e-17    // 2^-54
+#define SQRT_MAX_FINITE   1.7976931348623157e+308   // Largest finite double
+#define SQRT_STEPS        4
+
+typedef union {
+  UINT64    Bits;
+  double    Double;
+} DOUBLE_BITS;
+
+STATIC CONST DOUBLE_BITS  mNan = { 0x7FF8000000000000ULL };
+
+/**
+Compute sine and cosine of an angle.
+
+The angle is reduced to R + Tail = Angle - N * pi/2, with |R| <= pi/4, and the
+quadrant N mod 4 selects which of sin(R) and cos(R) is each result and its sign.
+Every step is straight line code so the callers that loop over arrays vectorize.
+
+@param[in]  Angle   Angle in radians
+@param[out] Sine    Sine of the angle
+@param[out] Cosine  Cosine of the angle
+**/
+STATIC
+inline
+VOID
+SinCosKernel (
+  IN  double  Angle,
+  OUT double  *Sine,
+  OUT double  *Cosine
+  )
+{
+  double  Abs;
+  double  Scaled;
+  INT32   Quadrant;
+  double  N;
+  double  A;
+  double  B;
+  double  R2;
+  double  E2;
+  double  C;
+  double  R;
+  double  Tail;
+  double  Z;
+  double  Poly;
+  double  Half;
+  double  W;
+  double  SinR;
+  double  CosR;
+  double  Swap1;
+  double  Swap2;
+
+  //
+  // Quadrant count N = round (Angle * 2/pi).  Out of range angles and NaNs use N = 0
+  // and have their result replaced with NaN below.
+  //
+  Abs      = (Angle < 0) ? -Angle : Angle;
+  Scaled   = Angle * TWO_OVER_PI;
+  Scaled   = (Abs < TRIG_MAX_ANGLE) ? Scaled : 0.0;
+  Quadrant = (INT32)(Scaled + ((Scaled < 0) ? -0.5 : 0.5));
+  N        = (double)Quadrant;
+
+  //
+  // R2 + E2 = (Angle - N * PIO2_1) - N * PIO2_2 exactly, then subtract N * PIO2_3
+  // and keep the rounding error of each subtraction in Tail.
+  //
+  A    = Angle - N * PIO2_1;
+  B    = N * PIO2_2;
+  R2   = A - B;
+  W    = R2 - A;
+  E2   = (A - (R2 - W)) + (-B - W);
+  C    = N * PIO2_3;
+  R    = R2 - C;
+  Tail = ((R2 - R) - C) + E2;
+
+  //
+  // sin(R + Tail) ~ sin(R) + Tail * cos(R) and cos(R + Tail) ~ cos(R) - Tail * R
+  //
+  Z    = R * R;
+  Poly = S1 + Z * (S2 + Z * (S3 + Z * (S4 + Z * (S5 + Z * S6))));
+  SinR = R + ((R * Z) * Poly + Tail * (1.0 - 0.5 * Z));
+
+  Poly = C1 + Z * (C2 + Z * (C3 + Z * (C4 + Z * (C5 + Z * C6))));
+  Half = 0.5 * Z;
+  W    = 1.0 - Half;
+  CosR = W + (((1.0 - W) - Half) + ((Z * Z) * Poly - R * Tail));
+
+  //
+  // Quadrant 0: ( sin,  cos)  1: ( cos, -sin)  2: (-sin, -cos)  3: (-cos,  sin)
+  //
+  Swap1 = (Quadrant & 1) ? CosR : SinR;
+  Swap2 = (Quadrant & 1) ? SinR : CosR;
+  Swap1 = (Quadrant & 2) ? -Swap1 : Swap1;
+  Swap2 = ((Quadrant + 1) & 2) ? -Swap2 : Swap2;
+
+  //
+  // NaN compares false, so this also catches NaN and infinite angles
+  //
+  *Sine   = (Abs < TRIG_MAX_ANGLE) ? Swap1 : mNan.Double;
+  *Cosine = (Abs < TRIG_MAX_ANGLE) ? Swap2 : mNan.Double;
+}
+
+/**
+Compute the square root of a double.
+
+@param[in] Input  the number to square root
 
-unsigned char
-_BitScanReverse64 (
-  unsigned long     *Index,
-  unsigned __int64  Mask
-  );
+@retval result when Input > 0 otherwise returns Input
+**/
+STATIC
+inline
+double
+SqrtKernel (
+  IN double  Input
+  )
+{
+  BOOLEAN      Scale;
+  DOUBLE_BITS  Value;
+  DOUBLE_BITS  Estimate;
+  double       X;
+  UINTN        Step;
+
+  Scale        = (Input < SQRT_SCALE_BELOW);
+  X            = Input * SQRT_SCALE_UP;
+  Value.Double = Scale ? X : Input;
+  X            = Value.Double;
+
+  Estimate.Bits = (Value.Bits >> 1) + SQRT_MAGIC;
+  for (Step = 0; Step < SQRT_STEPS; Step++) {
+    Estimate.Double = 0.5 * (Estimate.Double + X / Estimate.Double);
+  }
+
+  X               = Estimate.Double * SQRT_SCALE_DOWN;
+  Estimate.Double = Scale ? X : Estimate.Double;
 
-#endif
+  // if we get anything under 0 or is zero return what we got, and infinity and NaN are their own root
+  return ((Input > 0) && (Input <= SQRT_MAX_FINITE)) ? Estimate.Double : Input;
+}
 
 /**
 Find sine of a provided double in radians
@@ -39,50 +215,11 @@ sin_d (
   IN CONST double  angleInRadians
   )
 {
-  double  radians = angleInRadians;
-  double  previousValue;
-  INT16   multiply       = -1;      // we subtract first possibly faster
-  UINT32  iterationCount = 5;       //
-  double  top;                      // x^3
-  double  denom = 3.0 * 2.0;        // 3!
-  double  value;
-
-  // Using taylor series expansions
-  // https://en.wikipedia.org/wiki/Trigonometric_functions#Series_definitions
-  // so far seems comparable performance to the build in sin function from math.h
-  // first range modify it to be within 0 and 2 pi
-  while (radians > 2* MU_PI) {
-    radians -= 2*MU_PI;
-  }
-
-  while (radians < -2* MU_PI) {
-    radians += 2*MU_PI;
-  }
+  double  Sine;
+  double  Cosine;
 
-  previousValue = radians;  // x0
-
-  // compute the first iteration
-  // Formula is sum over N to infinity with x being the radians
-  // -1^n x^(2n+1)
-  // ----------------
-  //    (2n+1)!
-
-  top   = radians * radians * radians; // x^3
-  value = previousValue - (top/denom);
-
-  // iterate 12 iterations
-  for ( ; iterationCount <= 27; iterationCount += 2) {
-    previousValue = value;
-    denom        *= iterationCount * (iterationCount-1); // n * n-1 * (previous computed n-2!)
-    top          *= radians * radians;                   // x^2 * (previous computed x^n-2)
-    multiply     *= -1;                                  // invert the sign
-    // could be possibly faster to not use multiply but a conditional move?
-    value = previousValue + (multiply*top/denom);
-  }
-
-  // checking for convergence provides negligible speedup and a drop in accuracy.
-
-  return value;
+  SinCosKernel (angleInRadians, &Sine, &Cosine);
+  return Sine;
 }
 
 /**
@@ -98,116 +235,40 @@ cos_d (
   IN CONST double  angleInRadians
   )
 {
-  double  radians = angleInRadians;
-
-  double  previousValue  = 1;  // x0
-  INT16   multiply       = -1; // we subtract first possibly faster
-  UINT32  iterationCount = 4;  // we start at four
-  double  top;
-  double  denom = 2.0;  // 2!
-  double  value;
-
-  // Using taylor series expansions
-  // https://en.wikipedia.org/wiki/Trigonometric_functions#Series_definitions
-  // so far seems to be slightly slower to built in COS
-  // first range modify it to be within 0 and 2 pi
-  while (radians > 2* MU_PI) {
-    radians -= 2*MU_PI;
-  }
+  double  Sine;
+  double  Cosine;
 
-  while (radians < -2* MU_PI) {
-    radians += 2*MU_PI;
-  }
-
-  // compute the first iteration
-  // Formula is sum over N to infinity with x being the radians
-  // -1^n x^(2n)
-  // ----------------
-  //    (2n)!
-
-  top   = radians * radians; // x^2
-  value = previousValue - (top/denom);
-
-  // iterate 12 iterations
-  for ( ; iterationCount <= 26; iterationCount += 2) {
-    previousValue = value;
-    denom        *= iterationCount * (iterationCount-1); // n * n-1 * (previous computed n-2!)
-    top          *= radians * radians;                   // x^2 * (previous computed x^n-2)
-    multiply     *= -1;                                  // invert the sign
-    // could be possibly faster to not use multiply but a conditional move?
-    value = previousValue + (multiply*top/denom);
-  }
-
-  // checking for convergence provides negligible speedup and a drop in accuracy.
-  return value;
+  SinCosKernel (angleInRadians, &Sine, &Cosine);
+  return Cosine;
 }
 
-// Bit scan reverse for 64 bit values
-static inline UINT16
-bsr64 (
-  UINT64  value
+/**
+Find sine and cosine of each angle in an array.
+
+@param[in]  Angles   Angles in radians
+@param[out] Sines    Receives sin_d of each angle
+@param[out] Cosines  Receives cos_d of each angle
+@param[in]  Count    Number of angles
+**/
+VOID
+EFIAPI
+SinCosArray (
+  IN  CONST double  *Angles,
+  OUT double        *Sines,
+  OUT double        *Cosines,
+  IN  UINTN         Count
   )
 {
- #if __GNUC__ > 3 // if we are using GCC take advantage of their builtins
-  return 64 - __builtin_clzl (value);
-
- #elif _MSC_VER > 1500 // if we are using MS VS compiler 15 or greater
-  unsigned long  result;
- #if defined _M_X64
-  // https://msdn.microsoft.com/en-us/library/fbxyd7zd.aspx
-  // this will only work on ARM and x64
-  _BitScanReverse64 (&result, value);
-  return (UINT16)result + 1;
- #else
-
-  UINT32  valueLow  = value & 0xffffffff;
-  UINT32  valueHigh = value >> 32;
-  // https://msdn.microsoft.com/en-us/library/fbxyd7zd.aspx
-  // we split the operation up - first we check the upper bits and then check
-  if (_BitScanReverse (&result, valueHigh)) {
-    result += 32;
-  } else {
-    _BitScanReverse (&result, valueLow);
-  }
+  UINTN  Index;
 
-  return (UINT16)result + 1;
-
- #endif
- #else //this is our fallback
-  UINT16  count  = 1;
-  UINT16  result = value;
-  if (value == 0) {
-    return 0;
+  for (Index = 0; Index < Count; Index++) {
+    SinCosKernel (Angles[Index], &Sines[Index], &Cosines[Index]);
   }
-
-  while (count < 64 && value != 0x1) {
-    value = value >> 1;
-    // printf("Checking %x at %d\n",value,count);
-    count++;
-  }
-
-  return count;
- #endif
-}
-
-// helper function to get the highest bit set and zeros everything else.
-static inline UINT64
-hibit (
-  UINT64  n
-  )
-{
-  n |= (n >>  1);
-  n |= (n >>  2);
-  n |= (n >>  4);
-  n |= (n >>  8);
-  n |= (n >> 16);
-  n |= (n >> 32);
-  return n - (n >> 1);
 }
 
 /**
 Find square root of the provided double
-Currently not very fast -> needs setup
+
 @param[in] input the number to square root
 
 @retval result when input >0 otherwise returns input
@@ -218,45 +279,29 @@ sqrt_d (
   IN CONST double  input
   )
 {
-  UINT64  firstGuess = (UINT64)input;
-  double  x          = 0;
-  double  prevX      = -1;
-
-  // if we get anything under 0 or is zero return what we got
-  if (input <= 0) {
-    return input;
-  }
+  return SqrtKernel (input);
+}
 
-  // find a reasonable first approximation for faster convergence
-  // sqrt(input) = sqrt(a) * 2^n roughly equals 2^n
-  // We find the highest order bit and xor everything else
-  UINT64  highestOrderBit = hibit (firstGuess) /2;
-  // then we get the position of the highest or'd bit
-  // we might need to use another function other than clzl since that relies on BSR
-  // this should output a bsrl on x86 and polyfill it in on ARM64
-  UINT16  highestOrderBitPosition = bsr64 (highestOrderBit);
-
-  // our first guess is then just 2 ^ (n/2)
-  firstGuess = (UINT64)1 << highestOrderBitPosition/2;
-
-  // make sure our first guess is at least above zero
-  if (firstGuess == 0) {
-    firstGuess = 1;
-  }
+/**
+Find square root of each double in an array.
 
-  // do a few iteration using Heron's method
-  // https://en.wikipedia.org/wiki/Methods_of_computing_square_roots
-  x = (double)firstGuess;
+@param[in]  Inputs   The numbers to square root
+@param[out] Results  Receives sqrt_d of each input
+@param[in]  Count    Number of inputs
+**/
+VOID
+EFIAPI
+SqrtArray (
+  IN  CONST double  *Inputs,
+  OUT double        *Results,
+  IN  UINTN         Count
+  )
+{
+  UINTN  Index;
 
-  // do 7 iterations
-  // any further iterations yields no accuracy benefits
-  // quadratic convergent so we get 4x the precision each iteration
-  for (UINT64 i = 0; i < 6 && x != 0 && prevX != x; i++) {
-    prevX = x;
-    x     = .5 * (prevX + (input/prevX));
+  for (Index = 0; Index < Count; Index++) {
+    Results[Index] = SqrtKernel (Inputs[Index]);
   }
-
-  return x;
 }
 
 /**
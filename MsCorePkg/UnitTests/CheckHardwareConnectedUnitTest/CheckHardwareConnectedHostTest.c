@@ -0,0 +1,805 @@
+/** @file
+  Host based test of the PCI device matching and link training wait of
+  CheckHardwareConnected.
+
+  A server sized set of PCI I/O protocol instances is mocked, listed in a
+  different order than the platform devices, so that associating a device with
+  the wrong instance is visible in its link speed. MicroSecondDelay () is mocked
+  to advance a virtual clock, so the link training wait runs instantly. The
+  performance counter is mocked as a 24-bit down counter of that clock.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <IndustryStandard/Pci.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/DeviceSpecificBusInfoLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UnitTestLib.h>
+#include <Protocol/PciIo.h>
+
+#include "../../CheckHardwareConnected/CheckHardwareConnected.h"
+
+#define UNIT_TEST_NAME     "CheckHardwareConnected Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+//
+// Mocked topology: 3 segments x 16 buses x 8 devices x 2 functions.
+//
+#define MOCK_SEGMENTS   3
+#define MOCK_BUSES      16
+#define MOCK_DEVICES    8
+#define MOCK_FUNCTIONS  2
+#define MOCK_COUNT      (MOCK_SEGMENTS * MOCK_BUSES * MOCK_DEVICES * MOCK_FUNCTIONS)
+
+#define MOCK_PCIE_CAPABILITY_OFFSET  0x40
+#define MOCK_CONFIG_SPACE_SIZE       0x100
+
+#define POLL_INTERVAL_US  1000
+
+//
+// The mocked performance counter counts microseconds down from MOCK_COUNTER_START to 0.
+//
+#define MOCK_COUNTER_START   0xFFFFFF
+#define MOCK_COUNTER_PERIOD  (MOCK_COUNTER_START + 1)
+
+typedef struct {
+  EFI_PCI_IO_PROTOCOL    PciIo;
+  UINTN                  Seg;
+  UINTN                  Bus;
+  UINTN                  Dev;
+  UINTN                  Fun;
+  BOOLEAN                LocationError;
+  BOOLEAN                NoPcieCapability;
+  UINT8                  LinkSpeed;         // CurrentLinkSpeed once the link is trained
+  UINTN                  TrainingReads;     // Number of reads reporting 2.5 GT/s before LinkSpeed
+  UINTN                  ReadCount;
+  UINTN                  LocationCount;
+} MOCK_PCI_FUNCTION;
+
+STATIC MOCK_PCI_FUNCTION    mFunctions[MOCK_COUNT];
+STATIC EFI_PCI_IO_PROTOCOL  *mProtocolList[MOCK_COUNT];
+STATIC UINTN                mElapsedUs;
+STATIC UINTN                mDelayCount;
+STATIC UINTN                mReadCostUs;
+STATIC UINTN                mCounterOffsetUs;
+STATIC UINT32               mRandomState;
+
+/**
+  Mocked TimerLib MicroSecondDelay () which only advances the virtual clock.
+
+  @param  MicroSeconds  The number of microseconds to delay.
+
+  @return MicroSeconds
+
+**/
+UINTN
+EFIAPI
+MicroSecondDelay (
+  IN UINTN  MicroSeconds
+  )
+{
+  mElapsedUs += MicroSeconds;
+  mDelayCount++;
+  return MicroSeconds;
+}
+
+/**
+  Mocked TimerLib GetPerformanceCounter () derived from the virtual clock.
+
+  @return The current value of the mocked down counter.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounter (
+  VOID
+  )
+{
+  return MOCK_COUNTER_START - ((mElapsedUs + mCounterOffsetUs) % MOCK_COUNTER_PERIOD);
+}
+
+/**
+  Mocked TimerLib GetPerformanceCounterProperties () of a 1 MHz down counter.
+
+  @param  StartValue  The value the counter starts with.
+  @param  EndValue    The value the counter ends with.
+
+  @return The frequency of the counter in Hz.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounterProperties (
+  OUT UINT64  *StartValue OPTIONAL,
+  OUT UINT64  *EndValue OPTIONAL
+  )
+{
+  if (StartValue != NULL) {
+    *StartValue = MOCK_COUNTER_START;
+  }
+
+  if (EndValue != NULL) {
+    *EndValue = 0;
+  }
+
+  return 1000000;
+}
+
+/**
+  Mocked TimerLib GetTimeInNanoSecond () of a 1 MHz counter.
+
+  @param  Ticks  The number of elapsed ticks.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+EFIAPI
+GetTimeInNanoSecond (
+  IN UINT64  Ticks
+  )
+{
+  return Ticks * 1000;
+}
+
+/**
+  Mocked EFI_PCI_IO_PROTOCOL.GetLocation ().
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MockGetLocation (
+  IN  EFI_PCI_IO_PROTOCOL  *This,
+  OUT UINTN                *SegmentNumber,
+  OUT UINTN                *BusNumber,
+  OUT UINTN                *DeviceNumber,
+  OUT UINTN                *FunctionNumber
+  )
+{
+  MOCK_PCI_FUNCTION  *Function;
+
+  Function = (MOCK_PCI_FUNCTION *)This;
+  Function->LocationCount++;
+  if (Function->LocationError) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  *SegmentNumber  = Function->Seg;
+  *BusNumber      = Function->Bus;
+  *DeviceNumber   = Function->Dev;
+  *FunctionNumber = Function->Fun;
+  return EFI_SUCCESS;
+}
+
+/**
+  Mocked EFI_PCI_IO_PROTOCOL.Pci.Read () returning a type 0 header with a PCI Express capability.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+MockPciRead (
+  IN     EFI_PCI_IO_PROTOCOL        *This,
+  IN     EFI_PCI_IO_PROTOCOL_WIDTH  Width,
+  IN     UINT32                     Offset,
+  IN     UINTN                      Count,
+  IN OUT VOID                       *Buffer
+  )
+{
+  MOCK_PCI_FUNCTION      *Function;
+  UINT8                  Config[MOCK_CONFIG_SPACE_SIZE];
+  PCI_TYPE00             *Header;
+  PCI_CAPABILITY_PCIEXP  *Capability;
+
+  Function = (MOCK_PCI_FUNCTION *)This;
+  if ((Width != EfiPciIoWidthUint8) || (Offset + Count > sizeof (Config))) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Function->ReadCount++;
+  mElapsedUs += mReadCostUs;
+
+  ZeroMem (Config, sizeof (Config));
+  Header                       = (PCI_TYPE00 *)Config;
+  Header->Hdr.VendorId         = 0x1414;
+  Header->Hdr.HeaderType       = HEADER_TYPE_DEVICE;
+  Header->Device.CapabilityPtr = MOCK_PCIE_CAPABILITY_OFFSET;
+  if (!Function->NoPcieCapability) {
+    Header->Hdr.Status |= EFI_PCI_STATUS_CAPABILITY;
+  }
+
+  Capability                                   = (PCI_CAPABILITY_PCIEXP *)(Config + MOCK_PCIE_CAPABILITY_OFFSET);
+  Capability->Hdr.CapabilityID                 = EFI_PCI_CAPABILITY_ID_PCIEXP;
+  Capability->Hdr.NextItemPtr                  = 0;
+  Capability->LinkStatus.Bits.CurrentLinkSpeed = (Function->ReadCount <= Function->TrainingReads) ? 1 : Function->LinkSpeed;
+
+  CopyMem (Buffer, Config + Offset, Count);
+  return EFI_SUCCESS;
+}
+
+/**
+  Returns the next value of a xorshift generator.
+**/
+STATIC
+UINT32
+NextRandom (
+  VOID
+  )
+{
+  mRandomState ^= mRandomState << 13;
+  mRandomState ^= mRandomState >> 17;
+  mRandomState ^= mRandomState << 5;
+  return mRandomState;
+}
+
+/**
+  Returns the mocked function at a location of the topology.
+**/
+STATIC
+MOCK_PCI_FUNCTION *
+GetMockFunction (
+  IN UINTN  Seg,
+  IN UINTN  Bus,
+  IN UINTN  Dev,
+  IN UINTN  Fun
+  )
+{
+  return &mFunctions[((Seg * MOCK_BUSES + Bus) * MOCK_DEVICES + Dev) * MOCK_FUNCTIONS + Fun];
+}
+
+/**
+  Builds the mocked topology and lists its protocol instances in a shuffled order.
+
+  Every function is trained at a link speed derived from its location, so each
+  device reads a different speed than its neighbours.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SetupMockTopology (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MOCK_PCI_FUNCTION    *Function;
+  EFI_PCI_IO_PROTOCOL  *Swap;
+  UINTN                Seg;
+  UINTN                Bus;
+  UINTN                Dev;
+  UINTN                Fun;
+  UINTN                Index;
+  UINTN                Other;
+
+  ZeroMem (mFunctions, sizeof (mFunctions));
+  for (Seg = 0; Seg < MOCK_SEGMENTS; Seg++) {
+    for (Bus = 0; Bus < MOCK_BUSES; Bus++) {
+      for (Dev = 0; Dev < MOCK_DEVICES; Dev++) {
+        for (Fun = 0; Fun < MOCK_FUNCTIONS; Fun++) {
+          Function                    = GetMockFunction (Seg, Bus, Dev, Fun);
+          Function->PciIo.GetLocation = MockGetLocation;
+          Function->PciIo.Pci.Read    = MockPciRead;
+          Function->Seg               = Seg;
+          Function->Bus               = Bus;
+          Function->Dev               = Dev;
+          Function->Fun               = Fun;
+          Function->LinkSpeed         = (UINT8)(1 + (Seg + Bus + Dev + Fun) % 5);
+        }
+      }
+    }
+  }
+
+  for (Index = 0; Index < MOCK_COUNT; Index++) {
+    mProtocolList[Index] = &mFunctions[Index].PciIo;
+  }
+
+  mRandomState = 0x2545F491;
+  for (Index = MOCK_COUNT - 1; Index > 0; Index--) {
+    Other                = NextRandom () % (Index + 1);
+    Swap                 = mProtocolList[Index];
+    mProtocolList[Index] = mProtocolList[Other];
+    mProtocolList[Other] = Swap;
+  }
+
+  mElapsedUs       = 0;
+  mDelayCount      = 0;
+  mReadCostUs      = 0;
+  mCounterOffsetUs = 0;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Fills a platform device entry.
+**/
+STATIC
+VOID
+SetDevice (
+  OUT DEVICE_PCI_INFO  *Device,
+  IN  UINTN            Seg,
+  IN  UINTN            Bus,
+  IN  UINTN            Dev,
+  IN  UINTN            Fun,
+  IN  PCIE_LINK_SPEED  MinimumLinkSpeed
+  )
+{
+  ZeroMem (Device, sizeof (*Device));
+  AsciiStrCpyS (Device->DeviceName, sizeof (Device->DeviceName), "TestDev");
+  Device->SegmentNumber    = Seg;
+  Device->BusNumber        = Bus;
+  Device->DeviceNumber     = Dev;
+  Device->FunctionNumber   = Fun;
+  Device->MinimumLinkSpeed = MinimumLinkSpeed;
+}
+
+/**
+  Every platform device of a large topology should be matched to the instance at
+  its location, with a single GetLocation () call per instance.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+MatchLargeTopology (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DEVICE_PCI_INFO      Devices[MOCK_COUNT / 8 + 16];
+  EFI_PCI_IO_PROTOCOL  *DeviceProtocol[ARRAY_SIZE (Devices)];
+  MOCK_PCI_FUNCTION    *Function;
+  EFI_STATUS           Status;
+  UINTN                NumDevices;
+  UINTN                Index;
+
+  //
+  // Every eighth function in reverse order, followed by locations that do not exist.
+  //
+  NumDevices = 0;
+  for (Index = MOCK_COUNT; Index >= 8; Index -= 8) {
+    Function = &mFunctions[Index - 1];
+    SetDevice (&Devices[NumDevices++], Function->Seg, Function->Bus, Function->Dev, Function->Fun, Ignore);
+  }
+
+  for (Index = 0; Index < 16; Index++) {
+    SetDevice (&Devices[NumDevices++], Index % 4, 0x80 + Index, Index % 32, Index % 8, Ignore);
+  }
+
+  Status = MatchPciCheckDevices (Devices, NumDevices, mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  for (Index = 0; Index < NumDevices; Index++) {
+    if (Devices[Index].BusNumber >= MOCK_BUSES) {
+      UT_ASSERT_TRUE (DeviceProtocol[Index] == NULL);
+      continue;
+    }
+
+    UT_ASSERT_NOT_NULL (DeviceProtocol[Index]);
+    Function = (MOCK_PCI_FUNCTION *)DeviceProtocol[Index];
+    UT_ASSERT_EQUAL (Function->Seg, Devices[Index].SegmentNumber);
+    UT_ASSERT_EQUAL (Function->Bus, Devices[Index].BusNumber);
+    UT_ASSERT_EQUAL (Function->Dev, Devices[Index].DeviceNumber);
+    UT_ASSERT_EQUAL (Function->Fun, Devices[Index].FunctionNumber);
+  }
+
+  for (Index = 0; Index < MOCK_COUNT; Index++) {
+    UT_ASSERT_EQUAL (mFunctions[Index].LocationCount, 1);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Duplicate, invalid and unreadable locations should be handled.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+MatchDuplicateAndInvalidLocations (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DEVICE_PCI_INFO      Devices[5];
+  EFI_PCI_IO_PROTOCOL  *DeviceProtocol[ARRAY_SIZE (Devices)];
+  EFI_STATUS           Status;
+
+  SetDevice (&Devices[0], 1, 2, 3, 1, Ignore);
+  SetDevice (&Devices[1], 1, 2, 3, 1, Ignore);
+  SetDevice (&Devices[2], 0, 0, PCI_MAX_DEVICE + 1, 0, Ignore);
+  SetDevice (&Devices[3], 2, 5, 1, 0, Ignore);
+  SetDevice (&Devices[4], 0x10000, 0, 0, 0, Ignore);
+
+  //
+  // The instance at 2:5:1.0 cannot report its location.
+  //
+  GetMockFunction (2, 5, 1, 0)->LocationError = TRUE;
+
+  Status = MatchPciCheckDevices (Devices, ARRAY_SIZE (Devices), mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  UT_ASSERT_TRUE (DeviceProtocol[0] == &GetMockFunction (1, 2, 3, 1)->PciIo);
+  UT_ASSERT_TRUE (DeviceProtocol[1] == &GetMockFunction (1, 2, 3, 1)->PciIo);
+  UT_ASSERT_TRUE (DeviceProtocol[2] == NULL);
+  UT_ASSERT_TRUE (DeviceProtocol[3] == NULL);
+  UT_ASSERT_TRUE (DeviceProtocol[4] == NULL);
+
+  //
+  // No platform device or no protocol instance.
+  //
+  DeviceProtocol[0] = mProtocolList[0];
+  Status            = MatchPciCheckDevices (Devices, 1, NULL, 0, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_TRUE (DeviceProtocol[0] == NULL);
+
+  Status = MatchPciCheckDevices (Devices, 0, mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Status = MatchPciCheckDevices (NULL, 1, mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = MatchPciCheckDevices (Devices, 1, NULL, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = MatchPciCheckDevices (Devices, 1, mProtocolList, MOCK_COUNT, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The link speed of each device should be read from the instance at its own
+  location, and only from that instance.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LinkSpeedUsesMatchedProtocol (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DEVICE_PCI_INFO          Devices[64];
+  EFI_PCI_IO_PROTOCOL      *DeviceProtocol[ARRAY_SIZE (Devices)];
+  DEVICE_PCI_CHECK_RESULT  Results[ARRAY_SIZE (Devices)];
+  EFI_STATUS               LinkStatus[ARRAY_SIZE (Devices)];
+  MOCK_PCI_FUNCTION        *Function;
+  EFI_STATUS               Status;
+  UINTN                    Unsatisfied;
+  UINTN                    Expected;
+  UINTN                    Reads;
+  UINTN                    Index;
+
+  //
+  // Pick devices at random locations. Half of them require Gen3.
+  //
+  for (Index = 0; Index < ARRAY_SIZE (Devices); Index++) {
+    Function = &mFunctions[(Index * 37 + 11) % MOCK_COUNT];
+    SetDevice (&Devices[Index], Function->Seg, Function->Bus, Function->Dev, Function->Fun, (Index & 1) ? Gen3 : Gen1);
+  }
+
+  Status = MatchPciCheckDevices (Devices, ARRAY_SIZE (Devices), mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  ZeroMem (Results, sizeof (Results));
+  Unsatisfied = CheckPciDeviceLinkSpeeds (Devices, ARRAY_SIZE (Devices), DeviceProtocol, 0, Results, LinkStatus);
+
+  Expected = 0;
+  for (Index = 0; Index < ARRAY_SIZE (Devices); Index++) {
+    Function = &mFunctions[(Index * 37 + 11) % MOCK_COUNT];
+    UT_ASSERT_NOT_EFI_ERROR (LinkStatus[Index]);
+    UT_ASSERT_EQUAL (Results[Index].LinkSpeedResult.ActualSpeed, (PCIE_LINK_SPEED)Function->LinkSpeed);
+    UT_ASSERT_EQUAL (Results[Index].LinkSpeedResult.MinimumSatisfied, Function->LinkSpeed >= Devices[Index].MinimumLinkSpeed);
+    UT_ASSERT_EQUAL (Function->ReadCount, 1);
+    if (!Results[Index].LinkSpeedResult.MinimumSatisfied) {
+      Expected++;
+    }
+  }
+
+  UT_ASSERT_EQUAL (Unsatisfied, Expected);
+  UT_ASSERT_EQUAL (mDelayCount, 0);
+
+  Reads = 0;
+  for (Index = 0; Index < MOCK_COUNT; Index++) {
+    Reads += mFunctions[Index].ReadCount;
+  }
+
+  UT_ASSERT_EQUAL (Reads, ARRAY_SIZE (Devices));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Links below their minimum speed should be polled together until they train or
+  the shared timeout expires.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LinkTrainingWait (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINTN       TrainingReads[] = { 0, 2, 5, 9, 3 };
+  DEVICE_PCI_INFO          Devices[ARRAY_SIZE (TrainingReads) + 1];
+  EFI_PCI_IO_PROTOCOL      *DeviceProtocol[ARRAY_SIZE (Devices)];
+  DEVICE_PCI_CHECK_RESULT  Results[ARRAY_SIZE (Devices)];
+  EFI_STATUS               LinkStatus[ARRAY_SIZE (Devices)];
+  MOCK_PCI_FUNCTION        *Function;
+  EFI_STATUS               Status;
+  UINTN                    Unsatisfied;
+  UINTN                    Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (TrainingReads); Index++) {
+    Function                = GetMockFunction (1, Index, 4, 0);
+    Function->LinkSpeed     = 4;
+    Function->TrainingReads = TrainingReads[Index];
+    SetDevice (&Devices[Index], 1, Index, 4, 0, Gen3);
+  }
+
+  //
+  // This link never trains beyond Gen2.
+  //
+  Function            = GetMockFunction (2, 7, 7, 1);
+  Function->LinkSpeed = 2;
+  SetDevice (&Devices[Index], 2, 7, 7, 1, Gen3);
+
+  Status = MatchPciCheckDevices (Devices, ARRAY_SIZE (Devices), mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  ZeroMem (Results, sizeof (Results));
+  Unsatisfied = CheckPciDeviceLinkSpeeds (Devices, ARRAY_SIZE (Devices), DeviceProtocol, 20 * POLL_INTERVAL_US, Results, LinkStatus);
+
+  UT_ASSERT_EQUAL (Unsatisfied, 1);
+  for (Index = 0; Index < ARRAY_SIZE (TrainingReads); Index++) {
+    Function = GetMockFunction (1, Index, 4, 0);
+    UT_ASSERT_NOT_EFI_ERROR (LinkStatus[Index]);
+    UT_ASSERT_TRUE (Results[Index].LinkSpeedResult.MinimumSatisfied);
+    UT_ASSERT_EQUAL (Results[Index].LinkSpeedResult.ActualSpeed, Gen4);
+
+    //
+    // A link is not read again once it has trained.
+    //
+    UT_ASSERT_EQUAL (Function->ReadCount, TrainingReads[Index] + 1);
+  }
+
+  UT_ASSERT_FALSE (Results[Index].LinkSpeedResult.MinimumSatisfied);
+  UT_ASSERT_EQUAL (Results[Index].LinkSpeedResult.ActualSpeed, Gen2);
+
+  //
+  // The whole set waited for one timeout, not one per link.
+  //
+  UT_ASSERT_EQUAL (mElapsedUs, 20 * POLL_INTERVAL_US);
+  UT_ASSERT_EQUAL (mDelayCount, 20);
+  UT_ASSERT_EQUAL (GetMockFunction (2, 7, 7, 1)->ReadCount, 21);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The wait should end as soon as every link is satisfied, and should not happen
+  at all without a timeout.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LinkTrainingWaitEndsEarly (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DEVICE_PCI_INFO          Devices[3];
+  EFI_PCI_IO_PROTOCOL      *DeviceProtocol[ARRAY_SIZE (Devices)];
+  DEVICE_PCI_CHECK_RESULT  Results[ARRAY_SIZE (Devices)];
+  EFI_STATUS               LinkStatus[ARRAY_SIZE (Devices)];
+  MOCK_PCI_FUNCTION        *Function;
+  EFI_STATUS               Status;
+  UINTN                    Unsatisfied;
+  UINTN                    Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (Devices); Index++) {
+    Function                = GetMockFunction (0, 3, Index, 1);
+    Function->LinkSpeed     = 3;
+    Function->TrainingReads = 4 * Index;
+    SetDevice (&Devices[Index], 0, 3, Index, 1, Gen3);
+  }
+
+  Status = MatchPciCheckDevices (Devices, ARRAY_SIZE (Devices), mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  //
+  // Without a timeout the training links are reported right away.
+  //
+  ZeroMem (Results, sizeof (Results));
+  Unsatisfied = CheckPciDeviceLinkSpeeds (Devices, ARRAY_SIZE (Devices), DeviceProtocol, 0, Results, LinkStatus);
+  UT_ASSERT_EQUAL (Unsatisfied, 2);
+  UT_ASSERT_EQUAL (mDelayCount, 0);
+
+  //
+  // With a long timeout the wait ends when the slowest link trains. One of its
+  // 8 training reads was consumed above, so it needs the first read plus 7 polls.
+  //
+  ZeroMem (Results, sizeof (Results));
+  Unsatisfied = CheckPciDeviceLinkSpeeds (Devices, ARRAY_SIZE (Devices), DeviceProtocol, 1000 * POLL_INTERVAL_US, Results, LinkStatus);
+  UT_ASSERT_EQUAL (Unsatisfied, 0);
+  UT_ASSERT_EQUAL (mDelayCount, 7);
+  UT_ASSERT_EQUAL (mElapsedUs, 7 * POLL_INTERVAL_US);
+
+  //
+  // A timeout shorter than the poll interval is honored.
+  //
+  GetMockFunction (0, 3, 0, 1)->LinkSpeed = 1;
+  mElapsedUs                              = 0;
+  mDelayCount                             = 0;
+  ZeroMem (Results, sizeof (Results));
+  Unsatisfied = CheckPciDeviceLinkSpeeds (Devices, ARRAY_SIZE (Devices), DeviceProtocol, POLL_INTERVAL_US / 4, Results, LinkStatus);
+  UT_ASSERT_EQUAL (Unsatisfied, 1);
+  UT_ASSERT_EQUAL (mElapsedUs, POLL_INTERVAL_US / 4);
+  UT_ASSERT_EQUAL (mDelayCount, 1);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The time spent reading the links should count against the timeout, including
+  when the performance counter wraps during the wait.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LinkTrainingWaitCountsReadTime (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DEVICE_PCI_INFO          Devices[1];
+  EFI_PCI_IO_PROTOCOL      *DeviceProtocol[ARRAY_SIZE (Devices)];
+  DEVICE_PCI_CHECK_RESULT  Results[ARRAY_SIZE (Devices)];
+  EFI_STATUS               LinkStatus[ARRAY_SIZE (Devices)];
+  EFI_STATUS               Status;
+  UINTN                    Unsatisfied;
+
+  //
+  // This link never trains beyond Gen1, and each read takes as long as a poll interval.
+  //
+  GetMockFunction (1, 9, 2, 1)->LinkSpeed = 1;
+  SetDevice (&Devices[0], 1, 9, 2, 1, Gen3);
+
+  Status = MatchPciCheckDevices (Devices, ARRAY_SIZE (Devices), mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  mReadCostUs      = POLL_INTERVAL_US;
+  mCounterOffsetUs = MOCK_COUNTER_PERIOD - 5 * POLL_INTERVAL_US;
+  ZeroMem (Results, sizeof (Results));
+  Unsatisfied = CheckPciDeviceLinkSpeeds (Devices, ARRAY_SIZE (Devices), DeviceProtocol, 20 * POLL_INTERVAL_US, Results, LinkStatus);
+
+  //
+  // Each poll takes two intervals, so the timeout expires after half as many polls.
+  //
+  UT_ASSERT_EQUAL (Unsatisfied, 1);
+  UT_ASSERT_EQUAL (mDelayCount, 10);
+  UT_ASSERT_EQUAL (GetMockFunction (1, 9, 2, 1)->ReadCount, 11);
+  UT_ASSERT_EQUAL (mElapsedUs, 21 * POLL_INTERVAL_US);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Absent devices, ignored devices and devices without a PCI Express capability
+  should not be polled.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LinkSpeedNotPolled (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DEVICE_PCI_INFO          Devices[3];
+  EFI_PCI_IO_PROTOCOL      *DeviceProtocol[ARRAY_SIZE (Devices)];
+  DEVICE_PCI_CHECK_RESULT  Results[ARRAY_SIZE (Devices)];
+  EFI_STATUS               LinkStatus[ARRAY_SIZE (Devices)];
+  EFI_STATUS               Status;
+  UINTN                    Unsatisfied;
+
+  GetMockFunction (0, 1, 1, 0)->NoPcieCapability = TRUE;
+  SetDevice (&Devices[0], 0, 1, 1, 0, Gen2);
+  SetDevice (&Devices[1], 0, 1, 2, 0, Ignore);
+  SetDevice (&Devices[2], 0, 0x40, 0, 0, Gen2);
+
+  Status = MatchPciCheckDevices (Devices, ARRAY_SIZE (Devices), mProtocolList, MOCK_COUNT, DeviceProtocol);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_TRUE (DeviceProtocol[2] == NULL);
+
+  ZeroMem (Results, sizeof (Results));
+  Unsatisfied = CheckPciDeviceLinkSpeeds (Devices, ARRAY_SIZE (Devices), DeviceProtocol, 50 * POLL_INTERVAL_US, Results, LinkStatus);
+
+  UT_ASSERT_EQUAL (Unsatisfied, 1);
+  UT_ASSERT_STATUS_EQUAL (LinkStatus[0], EFI_NOT_FOUND);
+  UT_ASSERT_EQUAL (Results[0].LinkSpeedResult.ActualSpeed, Unknown);
+  UT_ASSERT_FALSE (Results[0].LinkSpeedResult.MinimumSatisfied);
+  UT_ASSERT_EQUAL (GetMockFunction (0, 1, 1, 0)->ReadCount, 1);
+
+  UT_ASSERT_STATUS_EQUAL (LinkStatus[1], EFI_NOT_STARTED);
+  UT_ASSERT_EQUAL (GetMockFunction (0, 1, 2, 0)->ReadCount, 0);
+
+  UT_ASSERT_STATUS_EQUAL (LinkStatus[2], EFI_NOT_STARTED);
+  UT_ASSERT_EQUAL (Results[2].LinkSpeedResult.ActualSpeed, Unknown);
+
+  UT_ASSERT_EQUAL (mDelayCount, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  CheckHardwareConnected PCI checks and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      PciCheckSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the PCI check Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&PciCheckSuite, Framework, "PCI Checks", "MsCore.CheckHardwareConnected", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for PciCheckSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (PciCheckSuite, "Devices should be matched to the instance at their location", "MatchLargeTopology", MatchLargeTopology, SetupMockTopology, NULL, NULL);
+  AddTestCase (PciCheckSuite, "Duplicate and invalid locations should be handled", "MatchDuplicateAndInvalidLocations", MatchDuplicateAndInvalidLocations, SetupMockTopology, NULL, NULL);
+  AddTestCase (PciCheckSuite, "Link speeds should be read from the matched instance", "LinkSpeedUsesMatchedProtocol", LinkSpeedUsesMatchedProtocol, SetupMockTopology, NULL, NULL);
+  AddTestCase (PciCheckSuite, "Training links should share one timeout", "LinkTrainingWait", LinkTrainingWait, SetupMockTopology, NULL, NULL);
+  AddTestCase (PciCheckSuite, "The wait should end when all links are satisfied", "LinkTrainingWaitEndsEarly", LinkTrainingWaitEndsEarly, SetupMockTopology, NULL, NULL);
+  AddTestCase (PciCheckSuite, "Time spent reading links should count against the timeout", "LinkTrainingWaitCountsReadTime", LinkTrainingWaitCountsReadTime, SetupMockTopology, NULL, NULL);
+  AddTestCase (PciCheckSuite, "Links that cannot train should not be polled", "LinkSpeedNotPolled", LinkSpeedNotPolled, SetupMockTopology, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
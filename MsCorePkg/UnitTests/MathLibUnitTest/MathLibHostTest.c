@@ -0,0 +1,502 @@
+/** @file
+  Host based accuracy test and benchmark for MathLib.
+
+  sin_d, cos_d and sqrt_d are swept densely and compared with the host C
+  library, SinCosArray and SqrtArray are checked against the scalar functions,
+  and the benchmark logs the time per element of the original Taylor series
+  functions, the current scalar functions and the array functions.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MathLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "MathLibReference.h"
+
+#define UNIT_TEST_NAME     "MathLib Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+//
+// The host C library is itself only within about half an ULP, so allow one
+// more ULP than MathLib promises when comparing against it.
+//
+#define HOST_LIBM_SLACK_ULP  1
+
+#define TRIG_SWEEP_RANGE     (64.0 * MU_PI)
+#define TRIG_SWEEP_COUNT     (1024 * 1024)
+#define TRIG_WIDE_LIMIT      (1048576.0 * MU_PI / 2.0)       // 2^20 * pi/2
+#define TRIG_WIDE_COUNT      (256 * 1024)
+#define SQRT_MANTISSA_STEPS  512
+#define BENCHMARK_COUNT      4096
+#define BENCHMARK_ITERATIONS 500
+
+typedef union {
+  UINT64    Bits;
+  double    Double;
+} DOUBLE_BITS;
+
+/**
+  Map a double onto an integer line where adjacent doubles differ by one.
+
+  @param[in] Value  The double to map.
+
+  @retval The position of Value on the line.
+**/
+STATIC
+INT64
+OrderedBits (
+  IN double  Value
+  )
+{
+  DOUBLE_BITS  Bits;
+
+  Bits.Double = Value;
+  if ((Bits.Bits & BIT63) != 0) {
+    return -(INT64)(Bits.Bits & ~BIT63);
+  }
+
+  return (INT64)Bits.Bits;
+}
+
+/**
+  Count the doubles between Actual and Expected.
+
+  @param[in] Actual    The computed value.
+  @param[in] Expected  The host C library value.
+
+  @retval The distance in units in the last place, or MAX_UINT64 if only one
+          of them is NaN.
+**/
+STATIC
+UINT64
+UlpDistance (
+  IN double  Actual,
+  IN double  Expected
+  )
+{
+  INT64  Difference;
+
+  if (isnan (Actual) || isnan (Expected)) {
+    return (isnan (Actual) && isnan (Expected)) ? 0 : MAX_UINT64;
+  }
+
+  Difference = OrderedBits (Actual) - OrderedBits (Expected);
+  return (Difference < 0) ? (UINT64)-Difference : (UINT64)Difference;
+}
+
+/**
+  Check sin_d and cos_d for one angle, tracking the largest error seen.
+
+  @param[in]      Angle    Angle in radians.
+  @param[in, out] MaxUlp   Largest error seen so far.
+
+  @retval TRUE   Both results are within the allowed error.
+  @retval FALSE  One of the results is not.
+**/
+STATIC
+BOOLEAN
+CheckSinCos (
+  IN     double  Angle,
+  IN OUT UINT64  *MaxUlp
+  )
+{
+  UINT64       SinUlp;
+  UINT64       CosUlp;
+  DOUBLE_BITS  Bits;
+
+  SinUlp  = UlpDistance (sin_d (Angle), sin (Angle));
+  CosUlp  = UlpDistance (cos_d (Angle), cos (Angle));
+  *MaxUlp = MAX (*MaxUlp, MAX (SinUlp, CosUlp));
+
+  if (MAX (SinUlp, CosUlp) > MATH_LIB_TRIG_MAX_ULP + HOST_LIBM_SLACK_ULP) {
+    Bits.Double = Angle;
+    DEBUG ((DEBUG_ERROR, "%a: angle %lx sin off by %ld, cos off by %ld ULP\n", __FUNCTION__, Bits.Bits, SinUlp, CosUlp));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Sweep sin_d and cos_d densely over several turns and sparsely out to the end
+  of the exactly reduced range.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              Every result was within the allowed error.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A result was not.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestSinCosAccuracy (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN   Index;
+  UINT64  MaxUlp;
+  double  Angle;
+
+  MaxUlp = 0;
+  for (Index = 0; Index <= TRIG_SWEEP_COUNT; Index++) {
+    Angle = -TRIG_SWEEP_RANGE + (2.0 * TRIG_SWEEP_RANGE * Index) / TRIG_SWEEP_COUNT;
+    UT_ASSERT_TRUE (CheckSinCos (Angle, &MaxUlp));
+  }
+
+  //
+  // Geometric steps from 1 to 2^20 * pi/2 so every magnitude gets covered.
+  //
+  Angle = 1.0;
+  for (Index = 0; Index < TRIG_WIDE_COUNT; Index++) {
+    UT_ASSERT_TRUE (CheckSinCos (Angle, &MaxUlp));
+    UT_ASSERT_TRUE (CheckSinCos (-Angle, &MaxUlp));
+    Angle *= pow (TRIG_WIDE_LIMIT, 1.0 / TRIG_WIDE_COUNT);
+  }
+
+  //
+  // Multiples of pi/2, where the reduced angle is smallest.
+  //
+  for (Index = 1; Index < 4096; Index++) {
+    UT_ASSERT_TRUE (CheckSinCos (Index * (MU_PI / 2.0), &MaxUlp));
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: largest difference from the host C library %ld ULP\n", __FUNCTION__, MaxUlp));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Sweep sqrt_d over every binade, subnormals included.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              Every result was within the allowed error.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A result was not.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestSqrtAccuracy (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT64       Exponent;
+  UINT64       Step;
+  UINT64       Ulp;
+  UINT64       MaxUlp;
+  DOUBLE_BITS  Input;
+
+  MaxUlp = 0;
+  for (Exponent = 0; Exponent < 0x7FF; Exponent++) {
+    for (Step = 0; Step < SQRT_MANTISSA_STEPS; Step++) {
+      Input.Bits = (Exponent << 52) | (Step * (BIT52 / SQRT_MANTISSA_STEPS)) | (Step & 1);
+      Ulp        = UlpDistance (sqrt_d (Input.Double), sqrt (Input.Double));
+      MaxUlp     = MAX (MaxUlp, Ulp);
+      if (Ulp > MATH_LIB_SQRT_MAX_ULP) {
+        DEBUG ((DEBUG_ERROR, "%a: sqrt of %lx off by %ld ULP\n", __FUNCTION__, Input.Bits, Ulp));
+      }
+
+      UT_ASSERT_TRUE (Ulp <= MATH_LIB_SQRT_MAX_ULP);
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: largest difference from the host C library %ld ULP\n", __FUNCTION__, MaxUlp));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check zero, infinities, NaN and out of range angles.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              Every special value gave the documented result.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   One did not.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestSpecialValues (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UT_ASSERT_TRUE (sin_d (0.0) == 0.0);
+  UT_ASSERT_TRUE (cos_d (0.0) == 1.0);
+  UT_ASSERT_TRUE (sin_d (-0.0) == 0.0);
+  UT_ASSERT_TRUE (cos_d (-0.0) == 1.0);
+  UT_ASSERT_TRUE (isnan (sin_d (INFINITY)));
+  UT_ASSERT_TRUE (isnan (cos_d (-INFINITY)));
+  UT_ASSERT_TRUE (isnan (sin_d (NAN)));
+  UT_ASSERT_TRUE (isnan (cos_d (NAN)));
+  UT_ASSERT_TRUE (isnan (sin_d (1073741824.0)));
+  UT_ASSERT_TRUE (isnan (cos_d (-1073741824.0)));
+  UT_ASSERT_TRUE (!isnan (sin_d (1073741823.0)));
+
+  UT_ASSERT_TRUE (sqrt_d (0.0) == 0.0);
+  UT_ASSERT_TRUE (sqrt_d (-1.0) == -1.0);
+  UT_ASSERT_TRUE (sqrt_d (1.0) == 1.0);
+  UT_ASSERT_TRUE (sqrt_d (4.0) == 2.0);
+  UT_ASSERT_TRUE (sqrt_d (0.25) == 0.5);
+  UT_ASSERT_TRUE (sqrt_d (INFINITY) == INFINITY);
+  UT_ASSERT_TRUE (sqrt_d (-INFINITY) == -INFINITY);
+  UT_ASSERT_TRUE (isnan (sqrt_d (NAN)));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that SinCosArray and SqrtArray return exactly what the scalar functions
+  return, for every length up to a few vectors and from an unaligned start.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The array functions matched.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   They did not.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestArrayMatchesScalar (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  double       Inputs[67];
+  double       First[67];
+  double       Second[67];
+  double       Expected;
+  DOUBLE_BITS  Guard;
+  UINTN        Count;
+  UINTN        Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (Inputs); Index++) {
+    Inputs[Index] = (Index * 7.25) - 200.0;
+  }
+
+  Inputs[3]  = INFINITY;
+  Inputs[10] = NAN;
+  Inputs[17] = 0.0;
+  Inputs[40] = 2.5e9;
+
+  for (Count = 0; Count < ARRAY_SIZE (Inputs); Count++) {
+    SetMem (First, sizeof (First), 0xA5);
+    SetMem (Second, sizeof (Second), 0xA5);
+    SinCosArray (&Inputs[1], First, Second, Count);
+    for (Index = 0; Index < Count; Index++) {
+      Expected = sin_d (Inputs[Index + 1]);
+      UT_ASSERT_MEM_EQUAL (&First[Index], &Expected, sizeof (double));
+      Expected = cos_d (Inputs[Index + 1]);
+      UT_ASSERT_MEM_EQUAL (&Second[Index], &Expected, sizeof (double));
+    }
+
+    //
+    // Nothing past Count may be written.
+    //
+    Guard.Double = First[Count];
+    UT_ASSERT_EQUAL (Guard.Bits, 0xA5A5A5A5A5A5A5A5ULL);
+    Guard.Double = Second[Count];
+    UT_ASSERT_EQUAL (Guard.Bits, 0xA5A5A5A5A5A5A5A5ULL);
+
+    SetMem (First, sizeof (First), 0xA5);
+    SqrtArray (&Inputs[1], First, Count);
+    for (Index = 0; Index < Count; Index++) {
+      Expected = sqrt_d (Inputs[Index + 1]);
+      UT_ASSERT_MEM_EQUAL (&First[Index], &Expected, sizeof (double));
+    }
+
+    Guard.Double = First[Count];
+    UT_ASSERT_EQUAL (Guard.Bits, 0xA5A5A5A5A5A5A5A5ULL);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Log the time per element of the original functions, the current scalar
+  functions and the array functions.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED                 The benchmark ran.
+  @retval UNIT_TEST_ERROR_TEST_FAILED      A buffer could not be allocated.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  double   *Inputs;
+  double   *Sines;
+  double   *Cosines;
+  UINTN    Index;
+  UINTN    Iteration;
+  clock_t  Start;
+  double   Elements;
+  double   Reference;
+  double   Scalar;
+  double   Array;
+
+  Inputs  = AllocatePool (BENCHMARK_COUNT * sizeof (double));
+  Sines   = AllocatePool (BENCHMARK_COUNT * sizeof (double));
+  Cosines = AllocatePool (BENCHMARK_COUNT * sizeof (double));
+  UT_ASSERT_NOT_NULL (Inputs);
+  UT_ASSERT_NOT_NULL (Sines);
+  UT_ASSERT_NOT_NULL (Cosines);
+
+  Elements = (double)BENCHMARK_COUNT * BENCHMARK_ITERATIONS;
+
+  //
+  // The original functions only reduce to [-2pi, 2pi], so keep to that range.
+  //
+  for (Index = 0; Index < BENCHMARK_COUNT; Index++) {
+    Inputs[Index] = -2.0 * MU_PI + (4.0 * MU_PI * Index) / BENCHMARK_COUNT;
+  }
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    for (Index = 0; Index < BENCHMARK_COUNT; Index++) {
+      Sines[Index]   = SinReference (Inputs[Index]);
+      Cosines[Index] = CosReference (Inputs[Index]);
+    }
+  }
+
+  Reference = (double)(clock () - Start) * 1e9 / CLOCKS_PER_SEC / Elements;
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    for (Index = 0; Index < BENCHMARK_COUNT; Index++) {
+      Sines[Index]   = sin_d (Inputs[Index]);
+      Cosines[Index] = cos_d (Inputs[Index]);
+    }
+  }
+
+  Scalar = (double)(clock () - Start) * 1e9 / CLOCKS_PER_SEC / Elements;
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    SinCosArray (Inputs, Sines, Cosines, BENCHMARK_COUNT);
+  }
+
+  Array = (double)(clock () - Start) * 1e9 / CLOCKS_PER_SEC / Elements;
+
+  DEBUG ((DEBUG_INFO, "%a: sin+cos ns/element original %d, sin_d+cos_d %d, SinCosArray %d\n", __FUNCTION__, (INT32)Reference, (INT32)Scalar, (INT32)Array));
+
+  for (Index = 0; Index < BENCHMARK_COUNT; Index++) {
+    Inputs[Index] = 1.0 + (4096.0 * Index) / BENCHMARK_COUNT;
+  }
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    for (Index = 0; Index < BENCHMARK_COUNT; Index++) {
+      Sines[Index] = SqrtReference (Inputs[Index]);
+    }
+  }
+
+  Reference = (double)(clock () - Start) * 1e9 / CLOCKS_PER_SEC / Elements;
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    for (Index = 0; Index < BENCHMARK_COUNT; Index++) {
+      Sines[Index] = sqrt_d (Inputs[Index]);
+    }
+  }
+
+  Scalar = (double)(clock () - Start) * 1e9 / CLOCKS_PER_SEC / Elements;
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    SqrtArray (Inputs, Sines, BENCHMARK_COUNT);
+  }
+
+  Array = (double)(clock () - Start) * 1e9 / CLOCKS_PER_SEC / Elements;
+
+  DEBUG ((DEBUG_INFO, "%a: sqrt ns/element original %d, sqrt_d %d, SqrtArray %d\n", __FUNCTION__, (INT32)Reference, (INT32)Scalar, (INT32)Array));
+
+  FreePool (Inputs);
+  FreePool (Sines);
+  FreePool (Cosines);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for MathLib and
+  run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      MathSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the MathLib Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&MathSuite, Framework, "MathLib", "MsCore.MathLib", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for MathSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (MathSuite, "sin_d and cos_d should be within MATH_LIB_TRIG_MAX_ULP", "SinCosAccuracy", UnitTestSinCosAccuracy, NULL, NULL, NULL);
+  AddTestCase (MathSuite, "sqrt_d should be within MATH_LIB_SQRT_MAX_ULP", "SqrtAccuracy", UnitTestSqrtAccuracy, NULL, NULL, NULL);
+  AddTestCase (MathSuite, "Special values should give the documented results", "SpecialValues", UnitTestSpecialValues, NULL, NULL, NULL);
+  AddTestCase (MathSuite, "Array functions should match the scalar functions", "ArrayMatchesScalar", UnitTestArrayMatchesScalar, NULL, NULL, NULL);
+  AddTestCase (MathSuite, "Benchmark the original, scalar and array functions", "Benchmark", UnitTestBenchmark, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
@@ -0,0 +1,155 @@
+/** @file
+MathLibReference.c
+
+Frozen copy of the Taylor series sin_d and cos_d and the Heron sqrt_d that
+MathLib used before its minimax rewrite.  MathLibHostTest only times these, it
+does not check results against them.
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+#include <Uefi.h>
+#include <Library/MathLib.h>
+
+#include "MathLibReference.h"
+
+/**
+Find sine of a provided double in radians with the original Taylor series.
+
+@param[in]  angle to calculate in radians
+
+@retval the result (double)
+**/
+double
+EFIAPI
+SinReference (
+  IN CONST double  angleInRadians
+  )
+{
+  double  radians = angleInRadians;
+  double  previousValue;
+  INT16   multiply       = -1;
+  UINT32  iterationCount = 5;
+  double  top;
+  double  denom = 3.0 * 2.0;
+  double  value;
+
+  while (radians > 2* MU_PI) {
+    radians -= 2*MU_PI;
+  }
+
+  while (radians < -2* MU_PI) {
+    radians += 2*MU_PI;
+  }
+
+  previousValue = radians;
+  top           = radians * radians * radians;
+  value         = previousValue - (top/denom);
+
+  for ( ; iterationCount <= 27; iterationCount += 2) {
+    previousValue = value;
+    denom        *= iterationCount * (iterationCount-1);
+    top          *= radians * radians;
+    multiply     *= -1;
+    value         = previousValue + (multiply*top/denom);
+  }
+
+  return value;
+}
+
+/**
+Find cosine of a provided double in radians with the original Taylor series.
+
+@param[in]  angle to calculate in radians
+
+@retval the result (double)
+**/
+double
+EFIAPI
+CosReference (
+  IN CONST double  angleInRadians
+  )
+{
+  double  radians = angleInRadians;
+  double  previousValue  = 1;
+  INT16   multiply       = -1;
+  UINT32  iterationCount = 4;
+  double  top;
+  double  denom = 2.0;
+  double  value;
+
+  while (radians > 2* MU_PI) {
+    radians -= 2*MU_PI;
+  }
+
+  while (radians < -2* MU_PI) {
+    radians += 2*MU_PI;
+  }
+
+  top   = radians * radians;
+  value = previousValue - (top/denom);
+
+  for ( ; iterationCount <= 26; iterationCount += 2) {
+    previousValue = value;
+    denom        *= iterationCount * (iterationCount-1);
+    top          *= radians * radians;
+    multiply     *= -1;
+    value         = previousValue + (multiply*top/denom);
+  }
+
+  return value;
+}
+
+/**
+Find square root of the provided double with the original Heron iteration.
+
+@param[in] input the number to square root
+
+@retval result when input >0 otherwise returns input
+**/
+double
+EFIAPI
+SqrtReference (
+  IN CONST double  input
+  )
+{
+  UINT64  firstGuess = (UINT64)input;
+  UINT64  highestOrderBit;
+  UINT16  highestOrderBitPosition;
+  double  x     = 0;
+  double  prevX = -1;
+  UINT64  i;
+
+  if (input <= 0) {
+    return input;
+  }
+
+  //
+  // Highest set bit of the integer part, halved, then its bit position.
+  //
+  highestOrderBit = firstGuess;
+  while ((highestOrderBit & (highestOrderBit - 1)) != 0) {
+    highestOrderBit &= highestOrderBit - 1;
+  }
+
+  highestOrderBit        /= 2;
+  highestOrderBitPosition = 0;
+  while (highestOrderBit != 0) {
+    highestOrderBit >>= 1;
+    highestOrderBitPosition++;
+  }
+
+  firstGuess = (UINT64)1 << highestOrderBitPosition/2;
+  if (firstGuess == 0) {
+    firstGuess = 1;
+  }
+
+  x = (double)firstGuess;
+  for (i = 0; i < 6 && x != 0 && prevX != x; i++) {
+    prevX = x;
+    x     = .5 * (prevX + (input/prevX));
+  }
+
+  return x;
+}
@@ -0,0 +1,54 @@
+/** @file
+MathLibReference.h
+
+The original Taylor series sin_d, cos_d and sqrt_d, kept so MathLibHostTest can
+compare the throughput of the current MathLib against them.
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __MATH_LIB_REFERENCE_H__
+#define __MATH_LIB_REFERENCE_H__
+
+/**
+Find sine of a provided double in radians with the original Taylor series.
+
+@param[in]  angle to calculate in radians
+
+@retval the result (double)
+**/
+double
+EFIAPI
+SinReference (
+  IN CONST double  angleInRadians
+  );
+
+/**
+Find cosine of a provided double in radians with the original Taylor series.
+
+@param[in]  angle to calculate in radians
+
+@retval the result (double)
+**/
+double
+EFIAPI
+CosReference (
+  IN CONST double  angleInRadians
+  );
+
+/**
+Find square root of the provided double with the original Heron iteration.
+
+@param[in] input the number to square root
+
+@retval result when input >0 otherwise returns input
+**/
+double
+EFIAPI
+SqrtReference (
+  IN CONST double  input
+  );
+
+#endif
@@ -18,6 +18,8 @@ Copyright (C) Microsoft Corporation. All rights reserved.
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugPrintErrorLevelLib.h>
 
+#include "SerialStatusCodeHandler.h"
+
 VOID
 EFIAPI
 WriteStatusCode (
@@ -25,6 +27,35 @@ WriteStatusCode (
   IN UINTN  NumberOfBytes
   );
 
+/**
+  Format a progress code the way SerialStatusCode writes it.
+
+  @param  Buffer           Receives the NULL terminated string.
+  @param  BufferSize       Size of Buffer in bytes.
+  @param  Value            Progress code value.
+  @param  Instance         Progress code instance.
+
+  @return  Number of characters written to Buffer, not including the NULL terminator.
+
+**/
+UINTN
+EFIAPI
+FormatProgressCode (
+  OUT CHAR8                  *Buffer,
+  IN  UINTN                  BufferSize,
+  IN  EFI_STATUS_CODE_VALUE  Value,
+  IN  UINT32                 Instance
+  )
+{
+  return AsciiSPrint (
+           Buffer,
+           BufferSize,
+           "PROGRESS CODE: V%08x I%x\n\r",
+           Value,
+           Instance
+           );
+}
+
 /**
   Convert status code value and extended data to readable ASCII string, send string to serial I/O device.
 
@@ -120,16 +151,18 @@ SerialStatusCode (
       goto Cleanup;
     }
 
+    //
+    // Progress codes carry nothing that needs formatting now, so the phase
+    // may record them and write them later.
+    //
+    if (DeferStatusCode (Value, Instance)) {
+      goto Cleanup;
+    }
+
     //
     // Print PROGRESS information into output buffer.
     //
-    CharCount = AsciiSPrint (
-                  BufferPtr,
-                  sizeof (Buffer),
-                  "PROGRESS CODE: V%08x I%x\n\r",
-                  Value,
-                  Instance
-                  );
+    CharCount = FormatProgressCode (BufferPtr, sizeof (Buffer), Value, Instance);
   } else if ((Data != NULL) && CompareGuid (&Data->Type, &gEfiStatusCodeDataTypeStringGuid) &&
              (((EFI_STATUS_CODE_STRING_DATA *)Data)->StringType == EfiStringAscii))
   {
@@ -41,4 +41,41 @@ SerialStatusCode (
   IN CONST EFI_STATUS_CODE_DATA  *Data OPTIONAL
   );
 
+/**
+Format a progress code the way SerialStatusCode writes it.
+
+@param  Buffer           Receives the NULL terminated string.
+@param  BufferSize       Size of Buffer in bytes.
+@param  Value            Progress code value.
+@param  Instance         Progress code instance.
+
+@return  Number of characters written to Buffer, not including the NULL terminator.
+
+**/
+UINTN
+EFIAPI
+FormatProgressCode (
+  OUT CHAR8                  *Buffer,
+  IN  UINTN                  BufferSize,
+  IN  EFI_STATUS_CODE_VALUE  Value,
+  IN  UINT32                 Instance
+  );
+
+/**
+Hand a progress code to the phase specific handler to be written later.
+
+@param  Value            Progress code value.
+@param  Instance         Progress code instance.
+
+@retval TRUE             The progress code was recorded and will be written later.
+@retval FALSE            The caller must write the progress code now.
+
+**/
+BOOLEAN
+EFIAPI
+DeferStatusCode (
+  IN EFI_STATUS_CODE_VALUE  Value,
+  IN UINT32                 Instance
+  );
+
 #endif
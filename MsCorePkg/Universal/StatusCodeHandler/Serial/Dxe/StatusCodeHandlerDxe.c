@@ -11,6 +11,8 @@ Copyright (C) Microsoft Corporation. All rights reserved.
 #include <Library/SerialPortLib.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
 #include <Guid/EventGroup.h>
 #include <Guid/StatusCodeDataTypeDebug.h>
 #include <Protocol/ReportStatusCodeHandler.h>
@@ -20,6 +22,214 @@ EFI_RSC_HANDLER_PROTOCOL  *mRscHandlerProtocol   = NULL;
 EFI_EVENT                 mExitBootServicesEvent = NULL;
 EFI_EVENT                 mRscRegisterEvent      = NULL;
 
+//
+// Deferred progress codes.  The router calls SerialStatusCode at the TPL of the caller,
+// so the ring is filled and emptied with the TPL raised to TPL_HIGH_LEVEL, which is the
+// only lock needed.
+// mDeferredHead and mDeferredTail are free running; their difference is the fill level.
+//
+#define DEFERRED_DRAIN_PERIOD      (10 * 1000 * 10)     // 10ms in 100ns units
+#define DEFERRED_DRAIN_BATCH_SIZE  16
+#define DEFERRED_LINE_SIZE         48                   // "PROGRESS CODE: V%08x I%x\n\r" and the NULL terminator
+
+typedef struct {
+  EFI_STATUS_CODE_VALUE    Value;
+  UINT32                   Instance;
+} DEFERRED_PROGRESS_CODE;
+
+DEFERRED_PROGRESS_CODE  *mDeferredCodes     = NULL;
+UINT32                  mDeferredCapacity   = 0;
+UINT32                  mDeferredHead       = 0;
+UINT32                  mDeferredTail       = 0;
+EFI_EVENT               mDeferredTimerEvent = NULL;
+
+/**
+  Write up to MaxCount deferred progress codes to the serial port in one write.
+
+  The caller must raise the TPL to TPL_HIGH_LEVEL.
+
+  @param  MaxCount      Largest number of progress codes to write.  At most
+                        DEFERRED_DRAIN_BATCH_SIZE are written per call.
+
+  @return  Number of progress codes written.
+
+**/
+STATIC
+UINTN
+WriteDeferredBatch (
+  IN UINTN  MaxCount
+  )
+{
+  CHAR8                   Buffer[DEFERRED_DRAIN_BATCH_SIZE * DEFERRED_LINE_SIZE];
+  UINTN                   Length;
+  UINTN                   Count;
+  DEFERRED_PROGRESS_CODE  *Code;
+
+  Length = 0;
+  for (Count = 0; Count < MIN (MaxCount, DEFERRED_DRAIN_BATCH_SIZE); Count++) {
+    if (mDeferredHead == mDeferredTail) {
+      break;
+    }
+
+    Code    = &mDeferredCodes[mDeferredTail % mDeferredCapacity];
+    Length += FormatProgressCode (&Buffer[Length], sizeof (Buffer) - Length, Code->Value, Code->Instance);
+    mDeferredTail++;
+  }
+
+  if (Length > 0) {
+    SerialPortWrite ((UINT8 *)Buffer, Length);
+  }
+
+  return Count;
+}
+
+/**
+  Write every deferred progress code.  The caller must raise the TPL to TPL_HIGH_LEVEL.
+**/
+STATIC
+VOID
+FlushDeferredCodes (
+  VOID
+  )
+{
+  if (mDeferredCodes == NULL) {
+    return;
+  }
+
+  while (WriteDeferredBatch (DEFERRED_DRAIN_BATCH_SIZE) == DEFERRED_DRAIN_BATCH_SIZE) {
+  }
+}
+
+/**
+  Timer callback that writes deferred progress codes.
+
+  Each batch is written at TPL_HIGH_LEVEL so that a status code reported from an
+  interrupt can't be written between two queued progress codes, and the TPL is
+  dropped between batches to bound how long interrupts are held off.
+
+  @param  Event         The timer event.
+  @param  Context       Not used.
+
+**/
+VOID
+EFIAPI
+DrainDeferredCodes (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_TPL  OldTpl;
+  UINTN    Written;
+
+  do {
+    OldTpl  = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    Written = WriteDeferredBatch (DEFERRED_DRAIN_BATCH_SIZE);
+    gBS->RestoreTPL (OldTpl);
+  } while (Written == DEFERRED_DRAIN_BATCH_SIZE);
+}
+
+/**
+  Record a progress code to be written by the drain timer.
+
+  @param  Value            Progress code value.
+  @param  Instance         Progress code instance.
+
+  @retval TRUE             The progress code was recorded and will be written later.
+  @retval FALSE            Deferred output is off or the ring is full.  The caller
+                           must write the progress code now.
+
+**/
+BOOLEAN
+EFIAPI
+DeferStatusCode (
+  IN EFI_STATUS_CODE_VALUE  Value,
+  IN UINT32                 Instance
+  )
+{
+  DEFERRED_PROGRESS_CODE  *Code;
+  EFI_TPL                 OldTpl;
+  BOOLEAN                 Deferred;
+
+  if (mDeferredCodes == NULL) {
+    return FALSE;
+  }
+
+  //
+  // The drain timer or a status code reported from an interrupt must not see a
+  // partly written entry.
+  //
+  Deferred = FALSE;
+  OldTpl   = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+  //
+  // When full, WriteStatusCode empties the ring before writing this one, so order is kept.
+  //
+  if ((mDeferredCodes != NULL) && ((mDeferredHead - mDeferredTail) < mDeferredCapacity)) {
+    Code           = &mDeferredCodes[mDeferredHead % mDeferredCapacity];
+    Code->Value    = Value;
+    Code->Instance = Instance;
+    mDeferredHead++;
+    Deferred = TRUE;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  return Deferred;
+}
+
+/**
+  Allocate the deferred progress code ring and start the drain timer.
+
+  Failure only means progress codes are written immediately.
+
+**/
+STATIC
+VOID
+InitializeDeferredCodes (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Capacity;
+
+  Capacity = FixedPcdGet32 (PcdSerialStatusCodeDeferredProgressCodes);
+  if (Capacity == 0) {
+    return;
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  DrainDeferredCodes,
+                  NULL,
+                  &mDeferredTimerEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to create drain timer (%r)\n", __FUNCTION__, Status));
+    return;
+  }
+
+  mDeferredCodes = AllocateZeroPool (Capacity * sizeof (DEFERRED_PROGRESS_CODE));
+  if (mDeferredCodes == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to allocate %d deferred progress codes\n", __FUNCTION__, Capacity));
+    gBS->CloseEvent (mDeferredTimerEvent);
+    mDeferredTimerEvent = NULL;
+    return;
+  }
+
+  mDeferredCapacity = Capacity;
+
+  Status = gBS->SetTimer (mDeferredTimerEvent, TimerPeriodic, DEFERRED_DRAIN_PERIOD);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to start drain timer (%r)\n", __FUNCTION__, Status));
+    gBS->CloseEvent (mDeferredTimerEvent);
+    mDeferredTimerEvent = NULL;
+    FreePool (mDeferredCodes);
+    mDeferredCodes    = NULL;
+    mDeferredCapacity = 0;
+  }
+}
+
 /**
 
 Unregister status code callback functions only available at boot time from
@@ -37,7 +247,21 @@ UnregisterBootTimeHandlers (
   IN VOID       *Context
   )
 {
+  EFI_TPL  OldTpl;
+
   mRscHandlerProtocol->Unregister ((EFI_RSC_HANDLER_CALLBACK)SerialStatusCode);
+
+  //
+  // Timers stop at ExitBootServices, so write whatever is still queued.
+  // The pool stays allocated; it is boot services memory and about to be reclaimed.
+  //
+  if (mDeferredCodes != NULL) {
+    gBS->SetTimer (mDeferredTimerEvent, TimerCancel, 0);
+    OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    FlushDeferredCodes ();
+    mDeferredCodes = NULL;
+    gBS->RestoreTPL (OldTpl);
+  }
 }
 
 /**
@@ -77,6 +301,8 @@ DxeEntry (
     return Status;
   }
 
+  InitializeDeferredCodes ();
+
   mRscHandlerProtocol->Register ((EFI_RSC_HANDLER_CALLBACK)SerialStatusCode, TPL_HIGH_LEVEL);
 
   //
@@ -129,5 +355,18 @@ WriteStatusCode (
   IN UINTN  NumberOfBytes
   )
 {
+  EFI_TPL  OldTpl;
+
+  //
+  // Anything queued before this one goes first.  The router calls this at the TPL of
+  // the caller, so raise the TPL to keep the drain timer out of the ring while it is
+  // emptied.
+  //
+  if (mDeferredCodes != NULL) {
+    OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    FlushDeferredCodes ();
+    gBS->RestoreTPL (OldTpl);
+  }
+
   SerialPortWrite (Buffer, NumberOfBytes);
 }
@@ -72,3 +72,22 @@ WriteStatusCode (
   //
   SerialPortWrite (Buffer, NumberOfBytes);
 }
+
+/**
+  Progress codes are always written immediately in MM.
+
+  @param  Value            Progress code value.
+  @param  Instance         Progress code instance.
+
+  @retval FALSE            The caller must write the progress code now.
+
+**/
+BOOLEAN
+EFIAPI
+DeferStatusCode (
+  IN EFI_STATUS_CODE_VALUE  Value,
+  IN UINT32                 Instance
+  )
+{
+  return FALSE;
+}
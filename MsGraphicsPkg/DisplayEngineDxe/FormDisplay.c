@@ -140,12 +140,37 @@ UINT32                       mLastOpCrc              = 0;
 EFI_HII_DATABASE_PROTOCOL    *mHiiDatabase;
 EFI_HANDLE                   mNotifyHandle;
 
-// Form Reuse check
-#define CHUNK_SIZE  240 // Set this to 32 to test filling the buffer and reallocating it.
+// Form Reuse check.  The opcode sequence is folded into a running CRC32 as it is measured.
+static UINT32   mCrcTable[256];
+static BOOLEAN  mCrcTableReady = FALSE;
+static UINT32   mOpCrc         = 0;
 
-static UINT8  *mBuffer    = NULL;
-static UINTN  mIndex      = 0;
-static UINTN  mBufferSize = 0;
+//
+// Grid size cache.  The rows and columns of each grid only depend on the opcodes and their payloads,
+// so they are kept per form and reused whenever the form is displayed again with the same opcode CRC.
+// Controls are still created on every display.
+//
+#define GRID_SIZE_CACHE_ENTRIES    8
+#define GRID_SIZE_CACHE_MAX_GRIDS  8
+
+typedef struct {
+  UINT32    Rows;
+  UINT32    Columns;
+} FORM_GRID_GEOMETRY;
+
+typedef struct {
+  BOOLEAN               Valid;
+  EFI_HII_HANDLE        HiiHandle;
+  EFI_GUID              FormSetGuid;
+  EFI_FORM_ID           FormId;
+  UINT32                OpCrc;
+  UINTN                 GridCount;
+  FORM_GRID_GEOMETRY    Grids[GRID_SIZE_CACHE_MAX_GRIDS];
+} GRID_SIZE_CACHE_ENTRY;
+
+static GRID_SIZE_CACHE_ENTRY  mGridSizeCache[GRID_SIZE_CACHE_ENTRIES];
+static UINTN                  mGridSizeCacheNext = 0;
+static GRID_SIZE_CACHE_ENTRY  *mCurrentGridSizes = NULL;
 
 //
 // Browser Global Strings
@@ -192,7 +217,9 @@ FormUpdateNotify (
   //
   // Force reparsing the form display data
   //
-  mLastOpCrc = 0;
+  mLastOpCrc     = 0;
+  mCurrentGridSizes = NULL;
+  ZeroMem (mGridSizeCache, sizeof (mGridSizeCache));
 
   return EFI_SUCCESS;
 }
@@ -544,54 +571,107 @@ VOID
 MeasureStart (
   )
 {
-  if (mBuffer != NULL) {
-    FreePool (mBuffer);
+  UINT32  Index;
+  UINT32  Bit;
+  UINT32  Value;
+
+  // Same CRC32 polynomial as gBS->CalculateCrc32
+  if (!mCrcTableReady) {
+    for (Index = 0; Index < 256; Index++) {
+      Value = Index;
+      for (Bit = 0; Bit < 8; Bit++) {
+        Value = (Value & 1) ? ((Value >> 1) ^ 0xEDB88320) : (Value >> 1);
+      }
+
+      mCrcTable[Index] = Value;
+    }
+
+    mCrcTableReady = TRUE;
   }
 
-  mBuffer     = NULL;
-  mIndex      = 0;
-  mBufferSize = 0;
+  mOpCrc = 0xFFFFFFFF;
 }
 
-// Measure the VFR Opcode sequence.  Store the opcode into a buffer, then crc the buffer.
+// Measure the VFR Opcode sequence.  Each opcode is folded into the running crc.
 void
 Measure (
   UINT8  Data
   )
 {
-  if (mIndex == mBufferSize) {
-    if (mBuffer == NULL) {
-      mBuffer     = AllocatePool (CHUNK_SIZE);
-      mBufferSize = CHUNK_SIZE;
-    } else {
-      mBuffer      = ReallocatePool (mBufferSize, mBufferSize + CHUNK_SIZE, mBuffer);
-      mBufferSize += CHUNK_SIZE;
-    }
-  }
+  mOpCrc = mCrcTable[(mOpCrc ^ Data) & 0xFF] ^ (mOpCrc >> 8);
+}
 
-  mBuffer[mIndex++] = Data;
+// Measure a whole opcode, including its payload.  GUID opcodes such as GRID_SELECT_CELL
+// carry the layout in the payload, so the opcode byte alone is not enough.
+VOID
+MeasureOpCode (
+  IN EFI_IFR_OP_HEADER  *OpCode
+  )
+{
+  UINT8  *Data;
+  UINTN  Index;
+
+  Data = (UINT8 *)OpCode;
+  for (Index = 0; Index < OpCode->Length; Index++) {
+    Measure (Data[Index]);
+  }
 }
 
 UINT32
 MeasureEnd (
   )
 {
-  UINT32      Crc = 0;
-  EFI_STATUS  Status;
+  return mOpCrc ^ 0xFFFFFFFF;
+}
 
-  if (mBuffer != NULL) {
-    Status = gBS->CalculateCrc32 (mBuffer, mIndex, &Crc);
-    if (EFI_ERROR (Status)) {
-      Crc = 0;
+/**
+  Find the grid size cache entry for a form, or claim one for the form to be recorded in.
+
+  @param  FormData   Form Data being displayed.
+  @param  OpCrc      CRC of the form's opcode sequence.
+
+  @return The cache entry.  It is Valid if the form's grid sizes were recorded with the same opcode CRC.
+
+**/
+static
+GRID_SIZE_CACHE_ENTRY *
+GetGridSizeCacheEntry (
+  IN FORM_DISPLAY_ENGINE_FORM  *FormData,
+  IN UINT32                    OpCrc
+  )
+{
+  GRID_SIZE_CACHE_ENTRY  *Entry;
+  UINTN                  Index;
+
+  for (Index = 0; Index < GRID_SIZE_CACHE_ENTRIES; Index++) {
+    Entry = &mGridSizeCache[Index];
+    if (  Entry->Valid
+       && (Entry->HiiHandle == FormData->HiiHandle)
+       && (Entry->FormId == FormData->FormId)
+       && CompareGuid (&Entry->FormSetGuid, &FormData->FormSetGuid))
+    {
+      if (Entry->OpCrc == OpCrc) {
+        return Entry;
+      }
+
+      // The form changed, record it again in the same entry.
+      break;
     }
+  }
 
-    FreePool (mBuffer);
-    mBuffer     = NULL;
-    mIndex      = 0;
-    mBufferSize = 0;
+  if (Index == GRID_SIZE_CACHE_ENTRIES) {
+    Index              = mGridSizeCacheNext;
+    mGridSizeCacheNext = (mGridSizeCacheNext + 1) % GRID_SIZE_CACHE_ENTRIES;
   }
 
-  return Crc;
+  Entry = &mGridSizeCache[Index];
+  ZeroMem (Entry, sizeof (GRID_SIZE_CACHE_ENTRY));
+  Entry->HiiHandle = FormData->HiiHandle;
+  Entry->FormId    = FormData->FormId;
+  Entry->OpCrc     = OpCrc;
+  CopyGuid (&Entry->FormSetGuid, &FormData->FormSetGuid);
+
+  return Entry;
 }
 
 /**
@@ -665,7 +745,7 @@ UiAddMenuOption (
       MenuOption->GrayOut = TRUE;
     }
 
-    Measure (Statement->OpCode->OpCode);
+    MeasureOpCode (Statement->OpCode);
 
     switch (Statement->OpCode->OpCode) {
       case EFI_IFR_ORDERED_LIST_OP:
@@ -908,6 +988,12 @@ CreateFormControls (
   UINT16                         CurrentColumn          = 0;
   UINT16                         CurrentRow             = 0;
   BOOLEAN                        FoundFirstGridSubtitle = FALSE;
+  UINTN                          GridIndex              = 0;
+  BOOLEAN                        GridSizesCached;
+
+  // Reuse the grid sizes recorded when this form was last displayed, if it hasn't changed.
+  //
+  GridSizesCached = (NULL != mCurrentGridSizes) && mCurrentGridSizes->Valid;
 
   // Define a canvas bounding rectangle that fills the form window.
   //
@@ -1027,11 +1113,24 @@ CreateFormControls (
 
           // Calculate the required grid size.
           //
-          Status = CalculateGridSize (
-                     Link,
-                     &MaxRows,
-                     &MaxColumns
-                     );
+          if (GridSizesCached && (GridIndex < mCurrentGridSizes->GridCount)) {
+            MaxRows    = mCurrentGridSizes->Grids[GridIndex].Rows;
+            MaxColumns = mCurrentGridSizes->Grids[GridIndex].Columns;
+            Status     = EFI_SUCCESS;
+          } else {
+            Status = CalculateGridSize (
+                       Link,
+                       &MaxRows,
+                       &MaxColumns
+                       );
+
+            if (!GridSizesCached && (NULL != mCurrentGridSizes) && (GridIndex < GRID_SIZE_CACHE_MAX_GRIDS)) {
+              mCurrentGridSizes->Grids[GridIndex].Rows    = MaxRows;
+              mCurrentGridSizes->Grids[GridIndex].Columns = MaxColumns;
+            }
+          }
+
+          GridIndex++;
 
           if (EFI_ERROR (Status) || (0 == MaxRows) || (0 == MaxColumns)) {
             DEBUG ((DEBUG_ERROR, "ERROR [DE]: Calculated grid size (Rows=%d, Columns=%d, CellHeight=%d) failed.  Code=%r.\n", MaxRows, MaxColumns, GridCellHeight, Status));
@@ -1927,6 +2026,13 @@ CreateFormControls (
     goto Exit;
   }
 
+  // The whole form was laid out, so its grid geometry can be reused next time.
+  //
+  if (!GridSizesCached && (NULL != mCurrentGridSizes) && (GridIndex <= GRID_SIZE_CACHE_MAX_GRIDS)) {
+    mCurrentGridSizes->GridCount = GridIndex;
+    mCurrentGridSizes->Valid     = TRUE;
+  }
+
   // If there is a canvas from earlier, see what we can recycle from it then free it.
   // Do this before redrawing the controlls
   if (NULL != mPrivateData.PreviousCanvas) {
@@ -2776,7 +2882,8 @@ FormDisplay (
     mStatementLayoutIsChanged = FALSE;
   }
 
-  mLastOpCrc = ThisOpCrc;
+  mLastOpCrc     = ThisOpCrc;
+  mCurrentGridSizes = GetGridSizeCacheEntry (FormData, ThisOpCrc);
 
   // Enable mouse pointer (conditional, based on whether a mouse input device is being used).
   //
@@ -103,4 +103,46 @@ QrEncodeData (
   OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  **Bitmap
   );                                                             // Place to store the created bitmap pointer
 
+// *----------------------------------------------------------------------------*
+// *   QrEncoderGetContextSize                                                  *
+// *                                                                            *
+// *   Returns the size, in bytes, of the encoder context used by               *
+// *   QrEncodeDataEx.                                                          *
+// *----------------------------------------------------------------------------*
+UINTN
+EFIAPI
+QrEncoderGetContextSize (
+  VOID
+  );
+
+// *----------------------------------------------------------------------------*
+// *   QrEncodeDataEx                                                           *
+// *                                                                            *
+// *   Same as QrEncodeData, using an encoder context supplied by the caller.   *
+// *   No memory other than the returned bitmap is allocated, and one context   *
+// *   may be reused for any number of QR codes.  Callers encoding on more than *
+// *   one thread at a time must use one context per thread.                   *
+// *                                                                            *
+// *   Input:                                                                   *
+// *      Context      QrEncoderGetContextSize () bytes of memory.  Does not    *
+// *                   need to be initialized.                                  *
+// *      Others       See QrEncodeData                                         *
+// *                                                                            *
+// *   Returns:                                                                 *
+// *      EFI_INVALID_PARAMETER = Context == NULL, or see QrEncodeData          *
+// *----------------------------------------------------------------------------*
+EFI_STATUS
+EFIAPI
+QrEncodeDataEx (
+  IN  VOID                           *Context,                   // Encoder context
+  IN  UINT8                          Version,                    // Version requested
+  IN  QRLEVEL                        Level,                      // EC Correction level
+  IN  QRENCODING                     Mode,                       // Alpha encoding??
+  IN  UINT32                         Flags,                      // Debug fla
+  IN  UINT8                          *Data,                      // Input Ascii Character data (BINARY IS NOT SUPPORTED)
+  IN  UINT16                         DataLen,                    // Length of the data
+  IN  INTN                           RegionSize,                 // Width and height of the square display area
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  **Bitmap
+  );                                                             // Place to store the created bitmap pointer
+
 #endif
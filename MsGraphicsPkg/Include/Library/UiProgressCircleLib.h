@@ -126,4 +126,21 @@ DrawSegment (
   UINT32  Color
   );
 
+/*
+  Method to turn anti-aliased edges on or off.  Off by default.
+  When on, pixels on the inner and outer edge of the donut are blended with the
+  framebuffer contents under them at the time this is called, so call it after
+  the background behind the circle has been drawn.
+
+  @param this     - ProgressCircle object to draw
+  @param Enable   - TRUE to blend edge pixels, FALSE to paint them solid
+
+*/
+VOID
+EFIAPI
+SetAntiAliasedEdges (
+  IN ProgressCircle *this,
+  IN BOOLEAN  Enable
+  );
+
 #endif
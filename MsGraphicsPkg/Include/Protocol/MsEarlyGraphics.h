@@ -20,7 +20,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
   }
 
 #define MS_EARLY_GRAPHICS_PROTOCOL_SIGNATURE  SIGNATURE_32 ('G', 'D', 'X', 'E')
-#define MS_EARLY_GRAPHICS_VERSION             1
+#define MS_EARLY_GRAPHICS_VERSION             2
 
 typedef struct _MS_EARLY_GRAPHICS_PROTOCOL MS_EARLY_GRAPHICS_PROTOCOL;
 
@@ -94,6 +94,22 @@ EFI_STATUS
   IN  CONST CHAR8                     *String
   );
 
+/**
+ *  Scroll the text rows up by moving the contents of the frame buffer, and
+ *  fill the rows uncovered at the bottom with the background color.
+ *
+ *  Added in MS_EARLY_GRAPHICS_VERSION 2.
+
+    @retval EFI_SUCCESS           The display was scrolled
+*/
+typedef
+EFI_STATUS
+(EFIAPI *MS_EARLY_GRAPHICS_SCROLL_UP)(
+  IN  MS_EARLY_GRAPHICS_PROTOCOL      *This,
+  IN  UINT32                          Rows,
+  IN  EFI_GRAPHICS_OUTPUT_BLT_PIXEL   BackgroundColor
+  );
+
 /**
  *  Update FrameBufferBase
 
@@ -118,6 +134,7 @@ struct _MS_EARLY_GRAPHICS_PROTOCOL {
   MS_EARLY_GRAPHICS_SIMPLE_FILL                 SimpleFill;
   MS_EARLY_GRAPHICS_PRINT_LINE                  PrintLn;
   EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE             *Mode;
+  MS_EARLY_GRAPHICS_SCROLL_UP                   ScrollUp;
 };
 
 extern EFI_GUID  gMsEarlyGraphicsProtocolGuid;
@@ -22,6 +22,30 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define BMP_PADDING  1
 
+//
+// Span lists are indexed by segment.  List 0 holds the runs of the whole donut,
+// lists 1 - 100 the runs of each segment, and the extra entry marks the end of
+// list 100.
+//
+#define SPAN_LIST_COUNT  (100 + 2)
+#define FULL_COVERAGE    (0xFF)
+
+//
+// One horizontal run of pixels in the bitmap that belong to the same list.
+// Coverage is less than FULL_COVERAGE only for end pixels on the edge of the
+// donut, and Under holds the framebuffer color those pixels are blended with
+// in anti-aliased mode.
+//
+typedef struct {
+  UINT32    Row;
+  UINT32    Start;
+  UINT32    Length;
+  UINT8     LeftCoverage;
+  UINT8     RightCoverage;
+  UINT32    LeftUnder;
+  UINT32    RightUnder;
+} PROGRESS_SPAN;
+
 typedef struct {
   ProgressCircle    PublicPC;
   UINT32            ProgressBackgroundColor; // Color for unused progress
@@ -30,6 +54,9 @@ typedef struct {
   INT8              ProgressPreviousState;   // Previous percentage  0-100
   POINT             UpperLeft;               // Upper left corner of circle bounding box in screen coordinates
   INTN              BmpWidth;                // Width of circle bounding box including required padding.
+  BOOLEAN           AntiAlias;               // Blend the edge pixels of the donut
+  PROGRESS_SPAN     *Spans;                  // Span lists, see SPAN_LIST_COUNT
+  UINT32            SpanList[SPAN_LIST_COUNT]; // Index of the first span of each list
   UINT8             BitmapData[0];
 } PRIVATE_ProgressCircle;
 
@@ -76,6 +103,26 @@ PRIVATE_Init (
   IN PRIVATE_ProgressCircle  *this
   );
 
+/**
+Internal function to build the span lists from the segment bitmap
+**/
+static
+EFI_STATUS
+PRIVATE_BuildSpans (
+  IN PRIVATE_ProgressCircle  *this
+  );
+
+/**
+Internal function to paint one span list
+**/
+static
+VOID
+PRIVATE_DrawSpans (
+  IN PRIVATE_ProgressCircle  *this,
+  IN UINTN                   List,
+  IN UINT32                  Color
+  );
+
 /*
 Method to use create a new ProgressCircle struct.
 This structure is used by all the other functions to update and
@@ -129,6 +176,11 @@ new_ProgressCircle (
     this->PublicPC.InnerRadius       = InnerRadius;
 
     PRIVATE_Init (this);
+    if (EFI_ERROR (PRIVATE_BuildSpans (this))) {
+      FreePool (this);
+      return NULL;
+    }
+
     return &this->PublicPC;
   }
 
@@ -147,7 +199,13 @@ delete_ProgressCircle (
   IN ProgressCircle  *this
   )
 {
+  PRIVATE_ProgressCircle  *thispri = (PRIVATE_ProgressCircle *)this;
+
   if (this != NULL) {
+    if (thispri->Spans != NULL) {
+      FreePool (thispri->Spans);
+    }
+
     FreePool (this);
   }
 }
@@ -253,29 +311,12 @@ DrawAll (
   UINT32              Color
   )
 {
-  PRIVATE_ProgressCircle  *thispri = (PRIVATE_ProgressCircle *)this;
-  UINT32                  *Pix     = NULL;
-  UINT8                   *cur     = NULL;
-
   if (this == NULL) {
     ASSERT (this != NULL);
     return;
   }
 
-  Pix = ((UINT32 *)thispri->PublicPC.FrameBufferBase) + (thispri->UpperLeft.Y * thispri->PublicPC.PixelsPerScanLine) + thispri->UpperLeft.X;
-  cur = (UINT8 *)thispri->BitmapData;
-  for (INTN Y = 0; Y < thispri->BmpWidth; Y++) {
-    for (INTN X = 0; X < thispri->BmpWidth; X++) {
-      if (*cur != OUTSIDE_CONTROL) {
-        *(Pix + X) = Color;
-      }
-
-      cur++;
-    }
-
-    // increment Pix 1 row
-    Pix = Pix + thispri->PublicPC.PixelsPerScanLine;
-  }
+  PRIVATE_DrawSpans ((PRIVATE_ProgressCircle *)this, 0, Color);
 }
 
 /*
@@ -294,12 +335,6 @@ DrawSegment (
   UINT32             Color
   )
 {
-  PRIVATE_ProgressCircle  *thispri       = (PRIVATE_ProgressCircle *)this;
-  UINT32                  *Pix           = NULL;
-  UINT8                   *cur           = NULL;
-  BOOLEAN                 FoundOnce      = FALSE; // to optimize the exit of loop
-  BOOLEAN                 FoundInThisRow = FALSE; // to optimize the exit of loop
-
   if (this == NULL) {
     ASSERT (this != NULL);
     return;
@@ -310,34 +345,47 @@ DrawSegment (
     return;
   }
 
-  // Find start of circle bmp in framebuffer space.
-  Pix = ((UINT32 *)thispri->PublicPC.FrameBufferBase) + (thispri->UpperLeft.Y * thispri->PublicPC.PixelsPerScanLine) + thispri->UpperLeft.X;
+  PRIVATE_DrawSpans ((PRIVATE_ProgressCircle *)this, (UINTN)Segment, Color);
+}
 
-  // Get pointer to start of circle bmp
-  cur = (UINT8 *)thispri->BitmapData;
+/*
+Method to turn anti-aliased edges on or off.
+When on, the pixels on the inner and outer edge of the donut are blended with
+what was in the framebuffer under them at the time this is called, so call it
+after the background behind the circle has been drawn.
 
-  // iterate each line looking for requested segment
-  for (INTN Y = 0; Y < thispri->BmpWidth; Y++) {
-    FoundInThisRow = FALSE;  // reset for next row
+@param this     - ProgressCircle object to draw
+@param Enable   - TRUE to blend edge pixels, FALSE to paint them solid
 
-    for (INTN X = 0; X < thispri->BmpWidth; X++) {
-      if (*cur == Segment) {
-        *(Pix + X)     = Color;
-        FoundInThisRow = TRUE;
-        FoundOnce      = TRUE;
-      }
+*/
+VOID
+EFIAPI
+SetAntiAliasedEdges (
+  IN ProgressCircle  *this,
+  IN BOOLEAN         Enable
+  )
+{
+  PRIVATE_ProgressCircle  *thispri = (PRIVATE_ProgressCircle *)this;
+  PROGRESS_SPAN           *Span;
+  UINT32                  *Pix;
 
-      cur++;
-    }
+  if (this == NULL) {
+    ASSERT (this != NULL);
+    return;
+  }
 
-    // exit early
-    if (FoundOnce && !FoundInThisRow) {
-      break;
-    }
+  if (Enable) {
+    // capture the colors under the edge pixels to blend with
+    for (UINT32 Index = 0; Index < thispri->SpanList[SPAN_LIST_COUNT - 1]; Index++) {
+      Span = &thispri->Spans[Index];
+      Pix  = ((UINT32 *)thispri->PublicPC.FrameBufferBase) + ((thispri->UpperLeft.Y + Span->Row) * thispri->PublicPC.PixelsPerScanLine) + thispri->UpperLeft.X + Span->Start;
 
-    // increment Pix 1 row
-    Pix = Pix + thispri->PublicPC.PixelsPerScanLine;
+      Span->LeftUnder  = Pix[0];
+      Span->RightUnder = Pix[Span->Length - 1];
+    }
   }
+
+  thispri->AntiAlias = Enable;
 }
 
 // ---------------------------------------------------------------------------------------
@@ -596,3 +644,220 @@ PRIVATE_Init (
   Fill (this, OUTSIDE_CONTROL); // remove the middel
   Segmatize (this);             // break into 100 segments
 }
+
+/**
+Private function to get how much of a bitmap pixel lies inside the donut,
+from 0 to FULL_COVERAGE.  Uses the first order expansion of the distance to
+each edge so no square root is needed.
+
+**/
+static
+UINT8
+EdgeCoverage (
+  IN PRIVATE_ProgressCircle  *this,
+  IN INTN                    X,
+  IN INTN                    Y
+  )
+{
+  INT64  Center  = this->BmpWidth / 2;
+  INT64  Dist2x4 = 4 * ((X - Center) * (X - Center) + (Y - Center) * (Y - Center));
+  INT64  Outer   = 2 * (INT64)this->PublicPC.OuterRadius;
+  INT64  Inner   = 2 * (INT64)this->PublicPC.InnerRadius;
+  INT64  Coverage;
+  INT64  InnerCoverage;
+
+  // coverage = (R + 1/2) - d, approximated as ((2R + 1)^2 - 4d^2) / 8R
+  Coverage = FULL_COVERAGE;
+  if (Outer > 0) {
+    Coverage = (((Outer + 1) * (Outer + 1) - Dist2x4) * FULL_COVERAGE) / (4 * Outer);
+  }
+
+  // coverage = d - (r - 1/2), approximated as (4d^2 - (2r - 1)^2) / 8r
+  if (Inner > 0) {
+    InnerCoverage = ((Dist2x4 - (Inner - 1) * (Inner - 1)) * FULL_COVERAGE) / (4 * Inner);
+    Coverage      = MIN (Coverage, InnerCoverage);
+  }
+
+  return (UINT8)MAX (0, MIN (FULL_COVERAGE, Coverage));
+}
+
+/**
+Private function to blend Color over Under with the given coverage.
+Two 8 bit channels are blended at once in the low and high half of a UINT32,
+and (x + 1 + (x >> 8)) >> 8 divides each by 255 exactly.
+
+**/
+static
+UINT32
+BlendPixel (
+  IN UINT32  Color,
+  IN UINT32  Under,
+  IN UINT8   Coverage
+  )
+{
+  UINT32  Inverse = FULL_COVERAGE - Coverage;
+  UINT32  RedBlue;
+  UINT32  AlphaGreen;
+
+  RedBlue    = (Color & 0x00FF00FF) * Coverage + (Under & 0x00FF00FF) * Inverse;
+  AlphaGreen = ((Color >> 8) & 0x00FF00FF) * Coverage + ((Under >> 8) & 0x00FF00FF) * Inverse;
+
+  RedBlue    = ((RedBlue + 0x00010001 + ((RedBlue >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+  AlphaGreen = ((AlphaGreen + 0x00010001 + ((AlphaGreen >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+
+  return RedBlue | (AlphaGreen << 8);
+}
+
+/**
+Private function to paint every span in one list.
+Each span is a single fill, with the end pixels blended in anti-aliased mode.
+
+**/
+static
+VOID
+PRIVATE_DrawSpans (
+  IN PRIVATE_ProgressCircle  *this,
+  IN UINTN                   List,
+  IN UINT32                  Color
+  )
+{
+  PROGRESS_SPAN  *Span;
+  UINT32         *Pix;
+  UINT32         First;
+  UINT32         Length;
+
+  // Find start of circle bmp in framebuffer space.
+  Pix = ((UINT32 *)this->PublicPC.FrameBufferBase) + (this->UpperLeft.Y * this->PublicPC.PixelsPerScanLine) + this->UpperLeft.X;
+
+  for (UINT32 Index = this->SpanList[List]; Index < this->SpanList[List + 1]; Index++) {
+    Span   = &this->Spans[Index];
+    First  = 0;
+    Length = Span->Length;
+
+    if (this->AntiAlias) {
+      if (Span->LeftCoverage != FULL_COVERAGE) {
+        Pix[(Span->Row * this->PublicPC.PixelsPerScanLine) + Span->Start] = BlendPixel (Color, Span->LeftUnder, Span->LeftCoverage);
+        First++;
+      }
+
+      if ((Span->RightCoverage != FULL_COVERAGE) && (Length > First)) {
+        Pix[(Span->Row * this->PublicPC.PixelsPerScanLine) + Span->Start + Length - 1] = BlendPixel (Color, Span->RightUnder, Span->RightCoverage);
+        Length--;
+      }
+    }
+
+    if (Length > First) {
+      SetMem32 (&Pix[(Span->Row * this->PublicPC.PixelsPerScanLine) + Span->Start + First], (Length - First) * sizeof (UINT32), Color);
+    }
+  }
+}
+
+/**
+Private function to add one span to a list.
+On the counting pass Next is NULL and the span is only counted.
+
+**/
+static
+VOID
+PRIVATE_AddSpan (
+  IN     PRIVATE_ProgressCircle  *this,
+  IN     UINTN                   List,
+  IN OUT UINT32                  *Next,
+  IN     INTN                    Y,
+  IN     INTN                    Start,
+  IN     INTN                    End,
+  IN     BOOLEAN                 LeftEdge,
+  IN     BOOLEAN                 RightEdge
+  )
+{
+  PROGRESS_SPAN  *Span;
+
+  if (Next == NULL) {
+    this->SpanList[List + 1]++;
+    return;
+  }
+
+  Span                = &this->Spans[Next[List]++];
+  Span->Row           = (UINT32)Y;
+  Span->Start         = (UINT32)Start;
+  Span->Length        = (UINT32)(End - Start);
+  Span->LeftCoverage  = LeftEdge ? EdgeCoverage (this, Start, Y) : FULL_COVERAGE;
+  Span->RightCoverage = RightEdge ? EdgeCoverage (this, End - 1, Y) : FULL_COVERAGE;
+  if (Span->Length == 1) {
+    // both ends are the same pixel
+    Span->LeftCoverage  = MIN (Span->LeftCoverage, Span->RightCoverage);
+    Span->RightCoverage = FULL_COVERAGE;
+  }
+}
+
+/**
+Private function to build the span lists once the bitmap has its segments.
+The first pass counts the runs in each list and the second fills them in,
+so each list ends up in row order in one allocation.
+
+**/
+static
+EFI_STATUS
+PRIVATE_BuildSpans (
+  IN PRIVATE_ProgressCircle  *this
+  )
+{
+  UINT32  Next[SPAN_LIST_COUNT];
+  UINT32  *NextSpan;
+  UINT8   *Row;
+  INTN    X;
+  INTN    End;
+  INTN    Run;
+  INTN    RunEnd;
+  UINTN   List;
+
+  ZeroMem (this->SpanList, sizeof (this->SpanList));
+  NextSpan = NULL;
+
+  for (UINTN Pass = 0; Pass < 2; Pass++) {
+    for (INTN Y = 0; Y < this->BmpWidth; Y++) {
+      Row = this->BitmapData + (Y * this->BmpWidth);
+      for (X = 0; X < this->BmpWidth; X = End) {
+        if (Row[X] == OUTSIDE_CONTROL) {
+          End = X + 1;
+          continue;
+        }
+
+        // one run of the donut, then the run of each segment within it
+        for (End = X; (End < this->BmpWidth) && (Row[End] != OUTSIDE_CONTROL); End++) {
+        }
+
+        PRIVATE_AddSpan (this, 0, NextSpan, Y, X, End, TRUE, TRUE);
+
+        for (Run = X; Run < End; Run = RunEnd) {
+          for (RunEnd = Run; (RunEnd < End) && (Row[RunEnd] == Row[Run]); RunEnd++) {
+          }
+
+          ASSERT ((Row[Run] >= 1) && (Row[Run] <= 100));
+          PRIVATE_AddSpan (this, Row[Run], NextSpan, Y, Run, RunEnd, (Run == X), (RunEnd == End));
+        }
+      }
+    }
+
+    if (NextSpan != NULL) {
+      break;
+    }
+
+    // turn the counts into the index of the first span of each list
+    for (List = 1; List < SPAN_LIST_COUNT; List++) {
+      this->SpanList[List] += this->SpanList[List - 1];
+    }
+
+    this->Spans = AllocateZeroPool (MAX (1, this->SpanList[SPAN_LIST_COUNT - 1]) * sizeof (PROGRESS_SPAN));
+    if (this->Spans == NULL) {
+      DEBUG ((DEBUG_ERROR, "Failed to allocate %d progress circle spans\n", this->SpanList[SPAN_LIST_COUNT - 1]));
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    CopyMem (Next, this->SpanList, sizeof (Next));
+    NextSpan = Next;
+  }
+
+  DEBUG ((DEBUG_INFO, "Progress circle has %d spans\n", this->SpanList[SPAN_LIST_COUNT - 1]));
+  return EFI_SUCCESS;
+}
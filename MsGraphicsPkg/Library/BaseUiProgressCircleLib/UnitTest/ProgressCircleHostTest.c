@@ -0,0 +1,527 @@
+/** @file
+  Host based unit test and benchmark for UiProgressCircleLib.
+
+  Every segment, the whole donut and a progress sequence are drawn with the
+  library and with the frozen bitmap scanning copy in ProgressCircleReference.c
+  and the framebuffers are compared pixel for pixel, for a range of radii.
+  The anti-aliased edge mode is checked against the solid output, and the
+  benchmark logs the time to draw every segment with both.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <UiPrimitiveSupport.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UiProgressCircleLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "ProgressCircleReference.h"
+
+#define UNIT_TEST_NAME     "UiProgressCircleLib Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define FRAME_MARGIN          8
+#define BACKGROUND_COLOR      0xFF102030
+#define PROGRESS_COLOR        0xFFE0C0A0
+#define BENCHMARK_RADIUS      200
+#define BENCHMARK_ITERATIONS  20
+
+typedef struct {
+  UINT16    InnerRadius;
+  UINT16    OuterRadius;
+} CIRCLE_RADII;
+
+STATIC CONST CIRCLE_RADII  mRadii[] = {
+  { 0,   0   },
+  { 0,   1   },
+  { 0,   7   },
+  { 3,   4   },
+  { 10,  20  },
+  { 47,  48  },
+  { 60,  100 },
+  { 95,  100 },
+  { 0,   100 },
+  { 150, 200 }
+};
+
+//
+// Two framebuffers with a stride wider than the circle, one for the library
+// and one for the reference.
+//
+typedef struct {
+  UINT32    *Frame;
+  UINT32    *ReferenceFrame;
+  UINTN     PixelsPerScanLine;
+  UINTN     Height;
+  POINT     Origin;
+} TEST_FRAMES;
+
+/**
+  Allocate both framebuffers for a circle and fill them with the same pattern.
+
+  @param[in]   OuterRadius  Outer radius of the circle.
+  @param[out]  Frames       Receives the framebuffers.
+
+  @retval TRUE   The framebuffers were allocated.
+  @retval FALSE  Out of memory.
+**/
+STATIC
+BOOLEAN
+CreateFrames (
+  IN  UINT16       OuterRadius,
+  OUT TEST_FRAMES  *Frames
+  )
+{
+  UINTN  Index;
+
+  Frames->PixelsPerScanLine = (2 * OuterRadius) + (2 * FRAME_MARGIN) + 1;
+  Frames->Height            = (2 * OuterRadius) + (2 * FRAME_MARGIN);
+  Frames->Origin.X          = OuterRadius + FRAME_MARGIN + 1;
+  Frames->Origin.Y          = OuterRadius + FRAME_MARGIN;
+  Frames->Frame             = AllocatePool (Frames->PixelsPerScanLine * Frames->Height * sizeof (UINT32));
+  Frames->ReferenceFrame    = AllocatePool (Frames->PixelsPerScanLine * Frames->Height * sizeof (UINT32));
+  if ((Frames->Frame == NULL) || (Frames->ReferenceFrame == NULL)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Frames->PixelsPerScanLine * Frames->Height; Index++) {
+    Frames->Frame[Index] = (UINT32)(Index * 2654435761u);
+  }
+
+  CopyMem (Frames->ReferenceFrame, Frames->Frame, Frames->PixelsPerScanLine * Frames->Height * sizeof (UINT32));
+  return TRUE;
+}
+
+/**
+  Free both framebuffers.
+
+  @param[in]  Frames  The framebuffers.
+**/
+STATIC
+VOID
+FreeFrames (
+  IN TEST_FRAMES  *Frames
+  )
+{
+  if (Frames->Frame != NULL) {
+    FreePool (Frames->Frame);
+  }
+
+  if (Frames->ReferenceFrame != NULL) {
+    FreePool (Frames->ReferenceFrame);
+  }
+}
+
+/**
+  Check whether both framebuffers hold the same pixels.
+
+  @param[in]  Frames  The framebuffers.
+
+  @retval TRUE   They match.
+  @retval FALSE  They do not; the first different pixel is logged.
+**/
+STATIC
+BOOLEAN
+FramesMatch (
+  IN TEST_FRAMES  *Frames
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Frames->PixelsPerScanLine * Frames->Height; Index++) {
+    if (Frames->Frame[Index] != Frames->ReferenceFrame[Index]) {
+      DEBUG ((
+        DEBUG_ERROR,
+        "%a: pixel (%d, %d) is %08x, expected %08x\n",
+        __FUNCTION__,
+        Index % Frames->PixelsPerScanLine,
+        Index / Frames->PixelsPerScanLine,
+        Frames->Frame[Index],
+        Frames->ReferenceFrame[Index]
+        ));
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Draw every segment and then the whole donut with both implementations.
+
+  @param[in]  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             Every framebuffer matched the reference.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A framebuffer did not.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestDrawMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_FRAMES     Frames;
+  ProgressCircle  *Circle;
+  ProgressCircle  *Reference;
+  UINTN           Index;
+  INT8            Segment;
+  BOOLEAN         Match;
+
+  for (Index = 0; Index < ARRAY_SIZE (mRadii); Index++) {
+    ZeroMem (&Frames, sizeof (Frames));
+    UT_ASSERT_TRUE (CreateFrames (mRadii[Index].OuterRadius, &Frames));
+
+    Circle    = new_ProgressCircle (&Frames.Origin, (UINT8 *)Frames.Frame, Frames.PixelsPerScanLine, mRadii[Index].InnerRadius, mRadii[Index].OuterRadius);
+    Reference = new_ProgressCircleReference (&Frames.Origin, (UINT8 *)Frames.ReferenceFrame, Frames.PixelsPerScanLine, mRadii[Index].InnerRadius, mRadii[Index].OuterRadius);
+    UT_ASSERT_NOT_NULL (Circle);
+    UT_ASSERT_NOT_NULL (Reference);
+
+    Match = TRUE;
+    for (Segment = 1; Match && (Segment <= 100); Segment++) {
+      DrawSegment (Circle, Segment, 0xFF000000 | (Segment * 0x00010203));
+      DrawSegmentReference (Reference, Segment, 0xFF000000 | (Segment * 0x00010203));
+      Match = FramesMatch (&Frames);
+    }
+
+    if (Match) {
+      DrawAll (Circle, BACKGROUND_COLOR);
+      DrawAllReference (Reference, BACKGROUND_COLOR);
+      Match = FramesMatch (&Frames);
+    }
+
+    if (!Match) {
+      DEBUG ((DEBUG_ERROR, "%a: radii %d - %d\n", __FUNCTION__, mRadii[Index].InnerRadius, mRadii[Index].OuterRadius));
+    }
+
+    delete_ProgressCircle (Circle);
+    delete_ProgressCircleReference (Reference);
+    FreeFrames (&Frames);
+    UT_ASSERT_TRUE (Match);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Run the same progress sequence with both implementations.
+
+  @param[in]  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             Every framebuffer matched the reference.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A framebuffer did not.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestProgressMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST INT8  Steps[] = { 0, 1, 2, 25, 26, 50, 51, 75, 99, 100 };
+  TEST_FRAMES        Frames;
+  ProgressCircle     *Circle;
+  ProgressCircle     *Reference;
+  UINTN              Index;
+  BOOLEAN            Match;
+
+  ZeroMem (&Frames, sizeof (Frames));
+  UT_ASSERT_TRUE (CreateFrames (100, &Frames));
+
+  Circle    = new_ProgressCircle (&Frames.Origin, (UINT8 *)Frames.Frame, Frames.PixelsPerScanLine, 60, 100);
+  Reference = new_ProgressCircleReference (&Frames.Origin, (UINT8 *)Frames.ReferenceFrame, Frames.PixelsPerScanLine, 60, 100);
+  UT_ASSERT_NOT_NULL (Circle);
+  UT_ASSERT_NOT_NULL (Reference);
+
+  InitializeProgress (Circle, BACKGROUND_COLOR, PROGRESS_COLOR);
+  InitializeProgressReference (Reference, BACKGROUND_COLOR, PROGRESS_COLOR);
+
+  Match = TRUE;
+  for (Index = 0; Match && (Index < ARRAY_SIZE (Steps)); Index++) {
+    UpdateProgress (Circle, Steps[Index]);
+    UpdateProgressReference (Reference, Steps[Index]);
+    Match = FramesMatch (&Frames);
+  }
+
+  delete_ProgressCircle (Circle);
+  delete_ProgressCircleReference (Reference);
+  FreeFrames (&Frames);
+  UT_ASSERT_TRUE (Match);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check one channel of an anti-aliased pixel lies between the background and
+  the drawn color.
+
+  @param[in]  Pixel       The anti-aliased pixel.
+  @param[in]  Background  The pixel before drawing.
+  @param[in]  Color       The drawn color.
+  @param[in]  Shift       Bit position of the channel.
+
+  @retval TRUE   The channel is between the two.
+  @retval FALSE  It is not.
+**/
+STATIC
+BOOLEAN
+ChannelBetween (
+  IN UINT32  Pixel,
+  IN UINT32  Background,
+  IN UINT32  Color,
+  IN UINTN   Shift
+  )
+{
+  UINT8  Value = (UINT8)(Pixel >> Shift);
+  UINT8  Low   = (UINT8)(Background >> Shift);
+  UINT8  High  = (UINT8)(Color >> Shift);
+
+  if (Low > High) {
+    Value = (UINT8)~Value;
+    Low   = (UINT8)~Low;
+    High  = (UINT8)~High;
+  }
+
+  return (Value >= Low) && (Value <= High);
+}
+
+/**
+  Check the anti-aliased edge mode.
+
+  Only pixels on the edge of the donut may differ from the solid output, and
+  each must lie between the background and the drawn color.  Drawing the
+  background and then every segment must give the same pixels as drawing the
+  whole donut, so edges are never blended twice.  Turning the mode off must
+  give the solid output again.
+
+  @param[in]  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The edges were blended as expected.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  They were not.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestAntiAliasedEdges (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_FRAMES     Frames;
+  ProgressCircle  *Circle;
+  ProgressCircle  *Solid;
+  UINT32          *Background;
+  UINT32          *Blended;
+  UINTN           Size;
+  UINTN           Index;
+  UINTN           Changed;
+  INT8            Segment;
+
+  ZeroMem (&Frames, sizeof (Frames));
+  UT_ASSERT_TRUE (CreateFrames (100, &Frames));
+  Size       = Frames.PixelsPerScanLine * Frames.Height * sizeof (UINT32);
+  Background = AllocateCopyPool (Size, Frames.Frame);
+  Blended    = AllocatePool (Size);
+  UT_ASSERT_NOT_NULL (Background);
+  UT_ASSERT_NOT_NULL (Blended);
+
+  //
+  // Solid output in the reference frame, blended output in the other.
+  //
+  Circle = new_ProgressCircle (&Frames.Origin, (UINT8 *)Frames.Frame, Frames.PixelsPerScanLine, 60, 100);
+  Solid  = new_ProgressCircle (&Frames.Origin, (UINT8 *)Frames.ReferenceFrame, Frames.PixelsPerScanLine, 60, 100);
+  UT_ASSERT_NOT_NULL (Circle);
+  UT_ASSERT_NOT_NULL (Solid);
+
+  SetAntiAliasedEdges (Circle, TRUE);
+  DrawAll (Circle, PROGRESS_COLOR);
+  DrawAll (Solid, PROGRESS_COLOR);
+
+  Changed = 0;
+  for (Index = 0; Index < Size / sizeof (UINT32); Index++) {
+    if (Frames.Frame[Index] != Frames.ReferenceFrame[Index]) {
+      Changed++;
+      UT_ASSERT_EQUAL (Frames.ReferenceFrame[Index], PROGRESS_COLOR);
+      UT_ASSERT_TRUE (ChannelBetween (Frames.Frame[Index], Background[Index], PROGRESS_COLOR, 0));
+      UT_ASSERT_TRUE (ChannelBetween (Frames.Frame[Index], Background[Index], PROGRESS_COLOR, 8));
+      UT_ASSERT_TRUE (ChannelBetween (Frames.Frame[Index], Background[Index], PROGRESS_COLOR, 16));
+      UT_ASSERT_TRUE (ChannelBetween (Frames.Frame[Index], Background[Index], PROGRESS_COLOR, 24));
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: %d edge pixels blended\n", __FUNCTION__, Changed));
+  UT_ASSERT_TRUE (Changed > 0);
+  CopyMem (Blended, Frames.Frame, Size);
+
+  //
+  // Background then every segment lands on the same pixels.
+  //
+  DrawAll (Circle, BACKGROUND_COLOR);
+  for (Segment = 1; Segment <= 100; Segment++) {
+    DrawSegment (Circle, Segment, PROGRESS_COLOR);
+  }
+
+  UT_ASSERT_MEM_EQUAL (Frames.Frame, Blended, Size);
+
+  SetAntiAliasedEdges (Circle, FALSE);
+  DrawAll (Circle, PROGRESS_COLOR);
+  UT_ASSERT_TRUE (FramesMatch (&Frames));
+
+  delete_ProgressCircle (Circle);
+  delete_ProgressCircle (Solid);
+  FreePool (Background);
+  FreePool (Blended);
+  FreeFrames (&Frames);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Log the time to draw the whole donut and every segment with both implementations.
+
+  @param[in]  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The benchmark ran.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A framebuffer could not be allocated.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_FRAMES     Frames;
+  ProgressCircle  *Circle;
+  ProgressCircle  *Reference;
+  UINTN           Iteration;
+  INT8            Segment;
+  clock_t         Start;
+  UINT64          SpanTime;
+  UINT64          ReferenceTime;
+
+  ZeroMem (&Frames, sizeof (Frames));
+  UT_ASSERT_TRUE (CreateFrames (BENCHMARK_RADIUS, &Frames));
+
+  Circle    = new_ProgressCircle (&Frames.Origin, (UINT8 *)Frames.Frame, Frames.PixelsPerScanLine, BENCHMARK_RADIUS / 2, BENCHMARK_RADIUS);
+  Reference = new_ProgressCircleReference (&Frames.Origin, (UINT8 *)Frames.ReferenceFrame, Frames.PixelsPerScanLine, BENCHMARK_RADIUS / 2, BENCHMARK_RADIUS);
+  UT_ASSERT_NOT_NULL (Circle);
+  UT_ASSERT_NOT_NULL (Reference);
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    DrawAllReference (Reference, BACKGROUND_COLOR);
+    for (Segment = 1; Segment <= 100; Segment++) {
+      DrawSegmentReference (Reference, Segment, PROGRESS_COLOR);
+    }
+  }
+
+  ReferenceTime = (UINT64)(clock () - Start) * 1000000 / CLOCKS_PER_SEC;
+
+  Start = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    DrawAll (Circle, BACKGROUND_COLOR);
+    for (Segment = 1; Segment <= 100; Segment++) {
+      DrawSegment (Circle, Segment, PROGRESS_COLOR);
+    }
+  }
+
+  SpanTime = (UINT64)(clock () - Start) * 1000000 / CLOCKS_PER_SEC;
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: DrawAll and 100 segments at radius %d, bitmap %ld us, spans %ld us\n",
+    __FUNCTION__,
+    BENCHMARK_RADIUS,
+    ReferenceTime / BENCHMARK_ITERATIONS,
+    SpanTime / BENCHMARK_ITERATIONS
+    ));
+
+  UT_ASSERT_TRUE (FramesMatch (&Frames));
+
+  delete_ProgressCircle (Circle);
+  delete_ProgressCircleReference (Reference);
+  FreeFrames (&Frames);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for
+  UiProgressCircleLib and run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      CircleSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the ProgressCircle Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&CircleSuite, Framework, "ProgressCircle", "MsGraphics.UiProgressCircleLib", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for CircleSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (CircleSuite, "DrawSegment and DrawAll should paint the same pixels as the bitmap path", "DrawMatchesReference", UnitTestDrawMatchesReference, NULL, NULL, NULL);
+  AddTestCase (CircleSuite, "UpdateProgress should paint the same pixels as the bitmap path", "ProgressMatchesReference", UnitTestProgressMatchesReference, NULL, NULL, NULL);
+  AddTestCase (CircleSuite, "Anti-aliased mode should only blend edge pixels, once", "AntiAliasedEdges", UnitTestAntiAliasedEdges, NULL, NULL, NULL);
+  AddTestCase (CircleSuite, "Benchmark the bitmap and span paths", "Benchmark", UnitTestBenchmark, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
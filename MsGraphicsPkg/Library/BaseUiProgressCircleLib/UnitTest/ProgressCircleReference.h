@@ -0,0 +1,87 @@
+/** @file
+ProgressCircleReference.h
+
+Entry points of the frozen bitmap scanning UiProgressCircleLib used as the
+expected output by ProgressCircleHostTest.
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __PROGRESS_CIRCLE_REFERENCE__
+#define __PROGRESS_CIRCLE_REFERENCE__
+
+/**
+  Create a ProgressCircle with the original implementation.
+
+  Parameters and return values are the same as new_ProgressCircle.
+
+**/
+ProgressCircle *
+EFIAPI
+new_ProgressCircleReference (
+  IN POINT   *Origin,
+  IN UINT8   *FrameBufferBase,
+  IN UINTN   PixelsPerScanLine,
+  IN UINT16  InnerRadius,
+  IN UINT16  OuterRadius
+  );
+
+/**
+  Free a ProgressCircle created by new_ProgressCircleReference.
+
+**/
+VOID
+EFIAPI
+delete_ProgressCircleReference (
+  IN ProgressCircle  *this
+  );
+
+/**
+  InitializeProgress of the original implementation.
+
+**/
+VOID
+EFIAPI
+InitializeProgressReference (
+  IN ProgressCircle  *this,
+  IN UINT32          BgColor,
+  IN UINT32          ProgressColor
+  );
+
+/**
+  UpdateProgress of the original implementation.
+
+**/
+VOID
+EFIAPI
+UpdateProgressReference (
+  IN ProgressCircle  *this,
+  IN INT8            Progress
+  );
+
+/**
+  DrawAll of the original implementation.
+
+**/
+VOID
+EFIAPI
+DrawAllReference (
+  IN  ProgressCircle  *this,
+  UINT32              Color
+  );
+
+/**
+  DrawSegment of the original implementation.
+
+**/
+VOID
+EFIAPI
+DrawSegmentReference (
+  IN ProgressCircle  *this,
+  INT8               Segment,
+  UINT32             Color
+  );
+
+#endif
@@ -0,0 +1,498 @@
+/** @file
+Caches boot graphics that have already been translated from BMP and scaled for a
+display mode, so that redrawing them only costs a single blit.
+
+The cache is published as gMsBootGraphicsCacheProtocolGuid so that BDS and later
+boot applications, e.g. MsBootPolicy, share it.
+
+When PcdBootGraphicsPersistCache is set, the system logo is also copied to reserved
+pages that the BootGraphicsCache variable locates.  The next boot reclaims the same
+pages and, if their content still matches the logo and display mode, draws from
+them without translating the BMP.
+
+Copyright (C) Microsoft Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Protocol/GraphicsOutput.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/PcdLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/BootGraphicsLib.h>
+
+#include "BootGraphicsLibInternal.h"
+
+/**
+  Locate the shared cache, publishing an empty one if this is the first user.
+
+  @retval NULL    The cache could not be located or created.
+  @retval Others  The shared cache.
+**/
+STATIC
+BOOT_GRAPHICS_CACHE *
+GetBootGraphicsCache (
+  VOID
+  )
+{
+  EFI_STATUS           Status;
+  BOOT_GRAPHICS_CACHE  *Cache;
+  EFI_HANDLE           Handle;
+
+  Status = gBS->LocateProtocol (&gMsBootGraphicsCacheProtocolGuid, NULL, (VOID **)&Cache);
+  if (!EFI_ERROR (Status)) {
+    if ((Cache->Signature != BOOT_GRAPHICS_CACHE_SIGNATURE) || (Cache->Version != BOOT_GRAPHICS_CACHE_VERSION)) {
+      DEBUG ((DEBUG_WARN, "%a - Ignoring incompatible boot graphics cache\n", __FUNCTION__));
+      return NULL;
+    }
+
+    return Cache;
+  }
+
+  Cache = AllocateZeroPool (sizeof (BOOT_GRAPHICS_CACHE));
+  if (Cache == NULL) {
+    return NULL;
+  }
+
+  Cache->Signature = BOOT_GRAPHICS_CACHE_SIGNATURE;
+  Cache->Version   = BOOT_GRAPHICS_CACHE_VERSION;
+
+  Handle = NULL;
+  Status = gBS->InstallProtocolInterface (&Handle, &gMsBootGraphicsCacheProtocolGuid, EFI_NATIVE_INTERFACE, Cache);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a - Failed to install boot graphics cache. %r\n", __FUNCTION__, Status));
+    FreePool (Cache);
+    return NULL;
+  }
+
+  return Cache;
+}
+
+/**
+  Find a ready-to-blit boot graphic for the current display mode.
+
+  @param[in] Graphic               The boot graphic being displayed.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+
+  @retval NULL    The graphic is not cached for this display mode.
+  @retval Others  The cache entry.  It is owned by the cache and must not be freed.
+**/
+BOOT_GRAPHICS_CACHE_ENTRY *
+BootGraphicsCacheLookup (
+  IN BOOT_GRAPHIC  Graphic,
+  IN UINT32        HorizontalResolution,
+  IN UINT32        VerticalResolution
+  )
+{
+  EFI_STATUS                 Status;
+  BOOT_GRAPHICS_CACHE        *Cache;
+  BOOT_GRAPHICS_CACHE_ENTRY  *Entry;
+  UINTN                      Index;
+
+  // Only look for an existing cache, there is nothing to find in a new one
+  Status = gBS->LocateProtocol (&gMsBootGraphicsCacheProtocolGuid, NULL, (VOID **)&Cache);
+  if (EFI_ERROR (Status) ||
+      (Cache->Signature != BOOT_GRAPHICS_CACHE_SIGNATURE) ||
+      (Cache->Version != BOOT_GRAPHICS_CACHE_VERSION))
+  {
+    return NULL;
+  }
+
+  for (Index = 0; Index < Cache->Count; Index++) {
+    Entry = &Cache->Entries[Index];
+    if ((Entry->Graphic == Graphic) &&
+        (Entry->MaxScale == PcdGet8 (PcdBootGraphicsLogoMaxScale)) &&
+        (Entry->HorizontalResolution == HorizontalResolution) &&
+        (Entry->VerticalResolution == VerticalResolution))
+    {
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Append an entry to the cache, evicting the oldest entry if the cache is full.
+
+  @param[in] Cache                 The shared cache.
+  @param[in] Graphic               The boot graphic.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+  @param[in] Blt                   Blt buffer, owned by the cache from now on.
+  @param[in] Width                 Width of Blt, in pixels.
+  @param[in] Height                Height of Blt, in pixels.
+  @param[in] Persisted             TRUE if Blt is in the reserved pages rather than in pool.
+
+  @return The new entry.
+**/
+STATIC
+BOOT_GRAPHICS_CACHE_ENTRY *
+AddCacheEntry (
+  IN BOOT_GRAPHICS_CACHE            *Cache,
+  IN BOOT_GRAPHIC                   Graphic,
+  IN UINT32                         HorizontalResolution,
+  IN UINT32                         VerticalResolution,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt,
+  IN UINTN                          Width,
+  IN UINTN                          Height,
+  IN BOOLEAN                        Persisted
+  )
+{
+  BOOT_GRAPHICS_CACHE_ENTRY  *Entry;
+
+  if (Cache->Count == BOOT_GRAPHICS_CACHE_MAX_ENTRIES) {
+    // The reserved pages stay allocated for the next boot
+    if (!Cache->Entries[0].Persisted) {
+      FreePool (Cache->Entries[0].Blt);
+    }
+
+    CopyMem (&Cache->Entries[0], &Cache->Entries[1], (BOOT_GRAPHICS_CACHE_MAX_ENTRIES - 1) * sizeof (BOOT_GRAPHICS_CACHE_ENTRY));
+    Cache->Count--;
+  }
+
+  Entry                       = &Cache->Entries[Cache->Count];
+  Entry->Graphic              = Graphic;
+  Entry->MaxScale             = PcdGet8 (PcdBootGraphicsLogoMaxScale);
+  Entry->HorizontalResolution = HorizontalResolution;
+  Entry->VerticalResolution   = VerticalResolution;
+  Entry->Width                = Width;
+  Entry->Height               = Height;
+  Entry->Blt                  = Blt;
+  Entry->Persisted            = Persisted;
+  Cache->Count++;
+
+  return Entry;
+}
+
+/**
+  Add a ready-to-blit boot graphic to the cache, evicting the oldest entry if the cache is full.
+
+  @param[in] Graphic               The boot graphic that was displayed.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+  @param[in] Blt                   Pool allocated Blt buffer.  Ownership passes to the cache on success.
+  @param[in] Width                 Width of Blt, in pixels.
+  @param[in] Height                Height of Blt, in pixels.
+
+  @retval EFI_SUCCESS  The cache now owns Blt.
+  @retval Others       The graphic was not cached, and the caller still owns Blt.
+**/
+EFI_STATUS
+BootGraphicsCacheInsert (
+  IN BOOT_GRAPHIC                   Graphic,
+  IN UINT32                         HorizontalResolution,
+  IN UINT32                         VerticalResolution,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt,
+  IN UINTN                          Width,
+  IN UINTN                          Height
+  )
+{
+  BOOT_GRAPHICS_CACHE  *Cache;
+
+  if (Blt == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Cache = GetBootGraphicsCache ();
+  if (Cache == NULL) {
+    return EFI_NOT_READY;
+  }
+
+  AddCacheEntry (Cache, Graphic, HorizontalResolution, VerticalResolution, Blt, Width, Height, FALSE);
+  return EFI_SUCCESS;
+}
+
+/**
+  Find the system logo kept in reserved memory by the previous boot.
+
+  Only the first call in a boot looks at the reserved pages.  A match is added to the cache,
+  so later calls find it with BootGraphicsCacheLookup().
+
+  @param[in] Graphic               The boot graphic being displayed.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+  @param[in] ImageCrc              CRC32 of the BMP of the graphic.
+
+  @retval NULL    Nothing usable was kept for this graphic, logo and display mode.
+  @retval Others  The cache entry.  It is owned by the cache and must not be freed.
+**/
+BOOT_GRAPHICS_CACHE_ENTRY *
+BootGraphicsCacheRestore (
+  IN BOOT_GRAPHIC  Graphic,
+  IN UINT32        HorizontalResolution,
+  IN UINT32        VerticalResolution,
+  IN UINT32        ImageCrc
+  )
+{
+  EFI_STATUS                      Status;
+  BOOT_GRAPHICS_CACHE             *Cache;
+  BOOT_GRAPHICS_PERSIST_VARIABLE  Variable;
+  BOOT_GRAPHICS_PERSIST_HEADER    *Header;
+  EFI_PHYSICAL_ADDRESS            Address;
+  UINTN                           Size;
+  UINTN                           BltSize;
+  UINT32                          BltCrc;
+
+  if (!FeaturePcdGet (PcdBootGraphicsPersistCache) || (Graphic != BG_SYSTEM_LOGO)) {
+    return NULL;
+  }
+
+  Cache = GetBootGraphicsCache ();
+  if ((Cache == NULL) || Cache->PersistChecked) {
+    return NULL;
+  }
+
+  Cache->PersistChecked = TRUE;
+
+  Size   = sizeof (Variable);
+  Status = gRT->GetVariable (
+                  BOOT_GRAPHICS_PERSIST_VARIABLE_NAME,
+                  &gMsBootGraphicsCacheVariableGuid,
+                  NULL,
+                  &Size,
+                  &Variable
+                  );
+  if (EFI_ERROR (Status) ||
+      (Size != sizeof (Variable)) ||
+      (Variable.Signature != BOOT_GRAPHICS_PERSIST_SIGNATURE) ||
+      (Variable.Version != BOOT_GRAPHICS_PERSIST_VERSION) ||
+      (Variable.Pages == 0) ||
+      (Variable.Pages > (MAX_UINTN >> EFI_PAGE_SHIFT)))
+  {
+    return NULL;
+  }
+
+  //
+  // Claim the pages again before looking at them.  If anything else got them first this boot,
+  // a new copy is made elsewhere after the logo is translated.
+  //
+  Address = Variable.Address;
+  Status  = gBS->AllocatePages (AllocateAddress, EfiReservedMemoryType, (UINTN)Variable.Pages, &Address);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "%a - Boot graphic pages at 0x%lx are in use. %r\n", __FUNCTION__, Variable.Address, Status));
+    return NULL;
+  }
+
+  Cache->PersistAddress = Address;
+  Cache->PersistPages   = (UINTN)Variable.Pages;
+
+  Header = (BOOT_GRAPHICS_PERSIST_HEADER *)(UINTN)Address;
+  if ((Header->Signature != BOOT_GRAPHICS_PERSIST_SIGNATURE) ||
+      (Header->Version != BOOT_GRAPHICS_PERSIST_VERSION) ||
+      (Header->Graphic != Graphic) ||
+      (Header->MaxScale != PcdGet8 (PcdBootGraphicsLogoMaxScale)) ||
+      (Header->HorizontalResolution != HorizontalResolution) ||
+      (Header->VerticalResolution != VerticalResolution) ||
+      (Header->ImageCrc != ImageCrc) ||
+      (Header->Width == 0) || (Header->Width > HorizontalResolution) ||
+      (Header->Height == 0) || (Header->Height > VerticalResolution))
+  {
+    DEBUG ((DEBUG_INFO, "%a - Kept boot graphic does not match this logo and mode\n", __FUNCTION__));
+    return NULL;
+  }
+
+  Size = EFI_PAGES_TO_SIZE (Cache->PersistPages) - sizeof (BOOT_GRAPHICS_PERSIST_HEADER);
+  if ((UINTN)Header->Width > Size / sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL) / (UINTN)Header->Height) {
+    return NULL;
+  }
+
+  BltSize = (UINTN)Header->Width * (UINTN)Header->Height * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  Status  = gBS->CalculateCrc32 (Header + 1, BltSize, &BltCrc);
+  if (EFI_ERROR (Status) || (BltCrc != Header->BltCrc)) {
+    DEBUG ((DEBUG_INFO, "%a - Kept boot graphic did not survive the reset\n", __FUNCTION__));
+    return NULL;
+  }
+
+  DEBUG ((DEBUG_INFO, "%a - Using boot graphic kept at 0x%lx\n", __FUNCTION__, Address));
+  return AddCacheEntry (
+           Cache,
+           Graphic,
+           HorizontalResolution,
+           VerticalResolution,
+           (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)(Header + 1),
+           (UINTN)Header->Width,
+           (UINTN)Header->Height,
+           TRUE
+           );
+}
+
+/**
+  Keep a translated system logo in reserved memory for the next warm boot.
+
+  @param[in] Graphic               The boot graphic that was displayed.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+  @param[in] ImageCrc              CRC32 of the BMP of the graphic.
+  @param[in] Blt                   Blt buffer that was drawn.  It is copied.
+  @param[in] Width                 Width of Blt, in pixels.
+  @param[in] Height                Height of Blt, in pixels.
+**/
+VOID
+BootGraphicsCachePersist (
+  IN BOOT_GRAPHIC                         Graphic,
+  IN UINT32                               HorizontalResolution,
+  IN UINT32                               VerticalResolution,
+  IN UINT32                               ImageCrc,
+  IN CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt,
+  IN UINTN                                Width,
+  IN UINTN                                Height
+  )
+{
+  EFI_STATUS                      Status;
+  BOOT_GRAPHICS_CACHE             *Cache;
+  BOOT_GRAPHICS_PERSIST_VARIABLE  Variable;
+  BOOT_GRAPHICS_PERSIST_HEADER    *Header;
+  UINTN                           BltSize;
+  UINTN                           Pages;
+  VOID                            *Buffer;
+  BOOLEAN                         Moved;
+
+  if (!FeaturePcdGet (PcdBootGraphicsPersistCache) || (Graphic != BG_SYSTEM_LOGO) || (Blt == NULL)) {
+    return;
+  }
+
+  Cache = GetBootGraphicsCache ();
+  if ((Cache == NULL) || Cache->PersistWritten) {
+    return;
+  }
+
+  // The logo already passed the size checks against the display mode, so this cannot overflow
+  BltSize = Width * Height * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  Pages   = EFI_SIZE_TO_PAGES (sizeof (BOOT_GRAPHICS_PERSIST_HEADER) + BltSize);
+
+  //
+  // Reuse the pages claimed back from the previous boot when the logo fits, so the variable
+  // only has to be written when the logo first grows or the pages are lost.
+  //
+  Moved = FALSE;
+  if (Cache->PersistPages < Pages) {
+    if (Cache->PersistPages != 0) {
+      gBS->FreePages (Cache->PersistAddress, Cache->PersistPages);
+      Cache->PersistAddress = 0;
+      Cache->PersistPages   = 0;
+    }
+
+    Buffer = AllocateReservedPages (Pages);
+    if (Buffer == NULL) {
+      DEBUG ((DEBUG_WARN, "%a - Failed to reserve %d pages for the boot graphic\n", __FUNCTION__, Pages));
+      return;
+    }
+
+    Cache->PersistAddress = (EFI_PHYSICAL_ADDRESS)(UINTN)Buffer;
+    Cache->PersistPages   = Pages;
+    Moved                 = TRUE;
+  }
+
+  Header = (BOOT_GRAPHICS_PERSIST_HEADER *)(UINTN)Cache->PersistAddress;
+  ZeroMem (Header, sizeof (BOOT_GRAPHICS_PERSIST_HEADER));
+  Header->Signature            = BOOT_GRAPHICS_PERSIST_SIGNATURE;
+  Header->Version              = BOOT_GRAPHICS_PERSIST_VERSION;
+  Header->Graphic              = Graphic;
+  Header->MaxScale             = PcdGet8 (PcdBootGraphicsLogoMaxScale);
+  Header->HorizontalResolution = HorizontalResolution;
+  Header->VerticalResolution   = VerticalResolution;
+  Header->ImageCrc             = ImageCrc;
+  Header->Width                = Width;
+  Header->Height               = Height;
+  CopyMem (Header + 1, Blt, BltSize);
+
+  Status = gBS->CalculateCrc32 (Header + 1, BltSize, &Header->BltCrc);
+  if (EFI_ERROR (Status)) {
+    Header->Signature = 0;
+    return;
+  }
+
+  Cache->PersistWritten = TRUE;
+  if (!Moved) {
+    return;
+  }
+
+  Variable.Signature = BOOT_GRAPHICS_PERSIST_SIGNATURE;
+  Variable.Version   = BOOT_GRAPHICS_PERSIST_VERSION;
+  Variable.Address   = Cache->PersistAddress;
+  Variable.Pages     = Cache->PersistPages;
+
+  Status = gRT->SetVariable (
+                  BOOT_GRAPHICS_PERSIST_VARIABLE_NAME,
+                  &gMsBootGraphicsCacheVariableGuid,
+                  EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                  sizeof (Variable),
+                  &Variable
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a - Failed to save the boot graphic location. %r\n", __FUNCTION__, Status));
+  }
+}
+
+/**
+  Scale a Blt buffer by an integer factor using pixel replication.
+
+  Replication keeps the logo crisp on high DPI panels and only needs row copies.
+
+  @param[in]  Blt        Source Blt buffer.
+  @param[in]  Width      Width of Blt, in pixels.
+  @param[in]  Height     Height of Blt, in pixels.
+  @param[in]  Scale      Scale factor, greater than 1.
+  @param[out] ScaledBlt  Returns a pool allocated Blt buffer of (Width * Scale) by (Height * Scale) pixels.
+
+  @retval EFI_SUCCESS            The buffer was scaled.
+  @retval EFI_INVALID_PARAMETER  An input is invalid or the scaled size overflows.
+  @retval EFI_OUT_OF_RESOURCES   The scaled buffer could not be allocated.
+**/
+EFI_STATUS
+ScaleBootGraphicBlt (
+  IN  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt,
+  IN  UINTN                                Width,
+  IN  UINTN                                Height,
+  IN  UINTN                                Scale,
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        **ScaledBlt
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Dest;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Row;
+  UINTN                          ScaledWidth;
+  UINTN                          RowSize;
+  UINTN                          X;
+  UINTN                          Y;
+  UINTN                          Repeat;
+
+  if ((Blt == NULL) || (ScaledBlt == NULL) || (Width == 0) || (Height == 0) || (Scale < 2)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ScaledWidth = Width * Scale;
+  if ((ScaledWidth / Scale != Width) ||
+      (MAX_UINTN / sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL) / ScaledWidth / Scale < Height))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  RowSize = ScaledWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  Dest    = AllocatePool (RowSize * Height * Scale);
+  if (Dest == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Row = Dest;
+  for (Y = 0; Y < Height; Y++) {
+    // Widen one source row, then replicate the widened row
+    for (X = 0; X < ScaledWidth; X++) {
+      Row[X] = Blt[(Y * Width) + (X / Scale)];
+    }
+
+    for (Repeat = 1; Repeat < Scale; Repeat++) {
+      CopyMem (Row + (Repeat * ScaledWidth), Row, RowSize);
+    }
+
+    Row += ScaledWidth * Scale;
+  }
+
+  *ScaledBlt = Dest;
+  return EFI_SUCCESS;
+}
@@ -22,6 +22,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BmpSupportLib.h>
 #include <Library/UefiLib.h>
 
+#include "BootGraphicsLibInternal.h"
+
 #define MS_MAX_HEIGHT_PERCENTAGE  40 // 40%
 #define MS_MAX_WIDTH_PERCENTAGE   40 // 40%
 
@@ -42,7 +44,12 @@ DisplayBootGraphic (
   UINTN                          ImageSize;
   UINT32                         Color;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *ScaledBlt;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *DrawBlt;
   UINTN                          BltSize;
+  UINTN                          Scale;
+  UINT32                         ImageCrc;
+  BOOT_GRAPHICS_CACHE_ENTRY      *CacheEntry;
   EFI_GRAPHICS_OUTPUT_PROTOCOL   *GraphicsOutput;
   EDKII_BOOT_LOGO2_PROTOCOL      *BootLogo2;
   UINT8                          SkipCounter;
@@ -142,33 +149,79 @@ DisplayBootGraphic (
     (INT32)SizeOfY
     );
 
-  Status = GetBootGraphic (Graphic, &ImageSize, &ImageData);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "GetPlatformBootGraphic Status: %r\n", Status));
-    goto CleanUp;
-  }
-
   //
-  // Convert Bmp To Blt Buffer
+  // Use the graphic as already translated for this display mode, if available
   //
-  Status = TranslateBmpToGopBlt (ImageData, ImageSize, &Blt, &BltSize, &Height, &Width);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Failed to TranslateBmpToGopBlt In Logo.c %r\n", Status));
-    goto CleanUp;
-  }
+  ImageCrc   = 0;
+  CacheEntry = BootGraphicsCacheLookup (Graphic, SizeOfX, SizeOfY);
+  if (CacheEntry == NULL) {
+    Status = GetBootGraphic (Graphic, &ImageSize, &ImageData);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "GetPlatformBootGraphic Status: %r\n", Status));
+      goto CleanUp;
+    }
 
-  if (SizeOfX >= SizeOfY) {
-    DEBUG ((DEBUG_VERBOSE, "Landscape mode detected.\n"));
+    //
+    // A logo translated by the previous boot is only reused if this BMP is the one it came from
+    //
+    if (FeaturePcdGet (PcdBootGraphicsPersistCache) &&
+        !EFI_ERROR (gBS->CalculateCrc32 (ImageData, ImageSize, &ImageCrc)))
+    {
+      CacheEntry = BootGraphicsCacheRestore (Graphic, SizeOfX, SizeOfY, ImageCrc);
+    }
   }
 
-  // If system logo it must meet size requirements.
-  if (Graphic == BG_SYSTEM_LOGO) {
-    // check if the image is appropriate size as per data defined in the windows engineering guide.
-    if ((Width > ((SizeOfX * MS_MAX_WIDTH_PERCENTAGE) / 100)) || (Height > ((SizeOfY * MS_MAX_HEIGHT_PERCENTAGE) / 100))) {
-      DEBUG ((DEBUG_ERROR, "Logo dimensions are not according to Specification. Screen size is %d by %d, Logo size is %d by %d   \n", SizeOfX, SizeOfY, Width, Height));
-      Status = EFI_INVALID_PARAMETER;
+  if (CacheEntry != NULL) {
+    DEBUG ((DEBUG_INFO, "%a - Using cached boot graphic %d\n", __FUNCTION__, Graphic));
+    DrawBlt = CacheEntry->Blt;
+    Width   = CacheEntry->Width;
+    Height  = CacheEntry->Height;
+  } else {
+    //
+    // Convert Bmp To Blt Buffer
+    //
+    Status = TranslateBmpToGopBlt (ImageData, ImageSize, &Blt, &BltSize, &Height, &Width);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to TranslateBmpToGopBlt In Logo.c %r\n", Status));
       goto CleanUp;
     }
+
+    if (SizeOfX >= SizeOfY) {
+      DEBUG ((DEBUG_VERBOSE, "Landscape mode detected.\n"));
+    }
+
+    // If system logo it must meet size requirements.
+    if (Graphic == BG_SYSTEM_LOGO) {
+      // check if the image is appropriate size as per data defined in the windows engineering guide.
+      if ((Width > ((SizeOfX * MS_MAX_WIDTH_PERCENTAGE) / 100)) || (Height > ((SizeOfY * MS_MAX_HEIGHT_PERCENTAGE) / 100))) {
+        DEBUG ((DEBUG_ERROR, "Logo dimensions are not according to Specification. Screen size is %d by %d, Logo size is %d by %d   \n", SizeOfX, SizeOfY, Width, Height));
+        Status = EFI_INVALID_PARAMETER;
+        goto CleanUp;
+      }
+
+      // Scale the logo up on high DPI panels, as far as the size requirements allow
+      Scale = PcdGet8 (PcdBootGraphicsLogoMaxScale);
+      while ((Scale > 1) &&
+             (((Width * Scale) > ((SizeOfX * MS_MAX_WIDTH_PERCENTAGE) / 100)) ||
+              ((Height * Scale) > ((SizeOfY * MS_MAX_HEIGHT_PERCENTAGE) / 100))))
+      {
+        Scale--;
+      }
+
+      if (Scale > 1) {
+        Status = ScaleBootGraphicBlt (Blt, Width, Height, Scale, &ScaledBlt);
+        if (EFI_ERROR (Status)) {
+          DEBUG ((DEBUG_WARN, "%a - Failed to scale logo by %d, using original size. %r\n", __FUNCTION__, Scale, Status));
+        } else {
+          FreePool (Blt);
+          Blt     = ScaledBlt;
+          Width  *= Scale;
+          Height *= Scale;
+        }
+      }
+    }
+
+    DrawBlt = Blt;
   }
 
   DestX = (SizeOfX - Width) / 2;
@@ -178,7 +231,7 @@ DisplayBootGraphic (
   if ((DestX >= 0) && (DestY >= 0)) {
     Status = GraphicsOutput->Blt (
                                GraphicsOutput,
-                               Blt,
+                               DrawBlt,
                                EfiBltBufferToVideo,
                                0,
                                0,
@@ -202,12 +255,20 @@ DisplayBootGraphic (
     // Attempt to register logo with Boot Logo 2 Protocol
     //
     if ((Graphic == BG_SYSTEM_LOGO) && (BootLogo2 != NULL)) {
-      Status = BootLogo2->SetBootLogo (BootLogo2, Blt, DestX, DestY, Width, Height);
+      Status = BootLogo2->SetBootLogo (BootLogo2, DrawBlt, DestX, DestY, Width, Height);
       if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "%a - BootLogo2 Error %r\n", __FUNCTION__, Status));
       }
     }
 
+    // Keep the translated graphic so that redrawing it is a single blit
+    if (CacheEntry == NULL) {
+      BootGraphicsCachePersist (Graphic, SizeOfX, SizeOfY, ImageCrc, DrawBlt, Width, Height);
+      if (!EFI_ERROR (BootGraphicsCacheInsert (Graphic, SizeOfX, SizeOfY, Blt, Width, Height))) {
+        Blt = NULL;
+      }
+    }
+
     // Signals that boot graphics has been displayed
     EfiEventGroupSignal (&gLogoDisplayedEventGroup);
 
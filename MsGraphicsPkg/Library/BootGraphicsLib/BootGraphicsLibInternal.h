@@ -0,0 +1,187 @@
+/** @file
+Internal definitions for the BootGraphicsLib boot graphic cache.
+
+Copyright (C) Microsoft Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _BOOT_GRAPHICS_LIB_INTERNAL_H_
+#define _BOOT_GRAPHICS_LIB_INTERNAL_H_
+
+#define BOOT_GRAPHICS_CACHE_SIGNATURE    SIGNATURE_32 ('B', 'G', 'C', 'H')
+#define BOOT_GRAPHICS_CACHE_VERSION      2
+#define BOOT_GRAPHICS_CACHE_MAX_ENTRIES  4
+
+#define BOOT_GRAPHICS_PERSIST_SIGNATURE     SIGNATURE_32 ('B', 'G', 'P', 'C')
+#define BOOT_GRAPHICS_PERSIST_VERSION       1
+#define BOOT_GRAPHICS_PERSIST_VARIABLE_NAME  L"BootGraphicsCache"
+
+//
+// A boot graphic that has already been translated (and optionally scaled) for a display mode,
+// ready to be handed straight to Gop->Blt.
+//
+typedef struct {
+  BOOT_GRAPHIC                     Graphic;
+  UINT8                            MaxScale;
+  UINT32                           HorizontalResolution;
+  UINT32                           VerticalResolution;
+  UINTN                            Width;
+  UINTN                            Height;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    *Blt;
+  BOOLEAN                          Persisted; // Blt lives in the reserved pages, not in pool
+} BOOT_GRAPHICS_CACHE_ENTRY;
+
+//
+// Interface of gMsBootGraphicsCacheProtocolGuid.  The cache is shared by every module
+// linking BootGraphicsLib for the remainder of boot services.
+//
+typedef struct {
+  UINT32                       Signature;
+  UINT32                       Version;
+  UINTN                        Count;
+  BOOT_GRAPHICS_CACHE_ENTRY    Entries[BOOT_GRAPHICS_CACHE_MAX_ENTRIES];
+  BOOLEAN                      PersistChecked; // The reserved pages were looked for this boot
+  BOOLEAN                      PersistWritten; // The logo was saved to the reserved pages this boot
+  EFI_PHYSICAL_ADDRESS         PersistAddress; // Reserved pages held this boot, 0 if none
+  UINTN                        PersistPages;
+} BOOT_GRAPHICS_CACHE;
+
+//
+// Value of the BootGraphicsCache variable.  It locates the reserved pages holding the
+// system logo over a warm reset.
+//
+typedef struct {
+  UINT32                  Signature;
+  UINT32                  Version;
+  EFI_PHYSICAL_ADDRESS    Address;
+  UINT64                  Pages;
+} BOOT_GRAPHICS_PERSIST_VARIABLE;
+
+//
+// Header of the reserved pages, followed by Width * Height pixels.  Nothing in the pages is
+// trusted until the key matches and BltCrc verifies, since memory may not survive the reset.
+//
+typedef struct {
+  UINT32          Signature;
+  UINT32          Version;
+  BOOT_GRAPHIC    Graphic;
+  UINT8           MaxScale;
+  UINT8           Reserved[2];
+  UINT32          HorizontalResolution;
+  UINT32          VerticalResolution;
+  UINT32          ImageCrc;
+  UINT32          BltCrc;
+  UINT64          Width;
+  UINT64          Height;
+} BOOT_GRAPHICS_PERSIST_HEADER;
+
+/**
+  Find a ready-to-blit boot graphic for the current display mode.
+
+  @param[in] Graphic               The boot graphic being displayed.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+
+  @retval NULL    The graphic is not cached for this display mode.
+  @retval Others  The cache entry.  It is owned by the cache and must not be freed.
+**/
+BOOT_GRAPHICS_CACHE_ENTRY *
+BootGraphicsCacheLookup (
+  IN BOOT_GRAPHIC  Graphic,
+  IN UINT32        HorizontalResolution,
+  IN UINT32        VerticalResolution
+  );
+
+/**
+  Add a ready-to-blit boot graphic to the cache, evicting the oldest entry if the cache is full.
+
+  @param[in] Graphic               The boot graphic that was displayed.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+  @param[in] Blt                   Pool allocated Blt buffer.  Ownership passes to the cache on success.
+  @param[in] Width                 Width of Blt, in pixels.
+  @param[in] Height                Height of Blt, in pixels.
+
+  @retval EFI_SUCCESS  The cache now owns Blt.
+  @retval Others       The graphic was not cached, and the caller still owns Blt.
+**/
+EFI_STATUS
+BootGraphicsCacheInsert (
+  IN BOOT_GRAPHIC                   Graphic,
+  IN UINT32                         HorizontalResolution,
+  IN UINT32                         VerticalResolution,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt,
+  IN UINTN                          Width,
+  IN UINTN                          Height
+  );
+
+/**
+  Find the system logo kept in reserved memory by the previous boot.
+
+  Only the first call in a boot looks at the reserved pages.  A match is added to the cache,
+  so later calls find it with BootGraphicsCacheLookup().
+
+  @param[in] Graphic               The boot graphic being displayed.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+  @param[in] ImageCrc              CRC32 of the BMP of the graphic.
+
+  @retval NULL    Nothing usable was kept for this graphic, logo and display mode.
+  @retval Others  The cache entry.  It is owned by the cache and must not be freed.
+**/
+BOOT_GRAPHICS_CACHE_ENTRY *
+BootGraphicsCacheRestore (
+  IN BOOT_GRAPHIC  Graphic,
+  IN UINT32        HorizontalResolution,
+  IN UINT32        VerticalResolution,
+  IN UINT32        ImageCrc
+  );
+
+/**
+  Keep a translated system logo in reserved memory for the next warm boot.
+
+  @param[in] Graphic               The boot graphic that was displayed.
+  @param[in] HorizontalResolution  Horizontal resolution of the display mode.
+  @param[in] VerticalResolution    Vertical resolution of the display mode.
+  @param[in] ImageCrc              CRC32 of the BMP of the graphic.
+  @param[in] Blt                   Blt buffer that was drawn.  It is copied.
+  @param[in] Width                 Width of Blt, in pixels.
+  @param[in] Height                Height of Blt, in pixels.
+**/
+VOID
+BootGraphicsCachePersist (
+  IN BOOT_GRAPHIC                         Graphic,
+  IN UINT32                               HorizontalResolution,
+  IN UINT32                               VerticalResolution,
+  IN UINT32                               ImageCrc,
+  IN CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt,
+  IN UINTN                                Width,
+  IN UINTN                                Height
+  );
+
+/**
+  Scale a Blt buffer by an integer factor using pixel replication.
+
+  Replication keeps the logo crisp on high DPI panels and only needs row copies.
+
+  @param[in]  Blt        Source Blt buffer.
+  @param[in]  Width      Width of Blt, in pixels.
+  @param[in]  Height     Height of Blt, in pixels.
+  @param[in]  Scale      Scale factor, greater than 1.
+  @param[out] ScaledBlt  Returns a pool allocated Blt buffer of (Width * Scale) by (Height * Scale) pixels.
+
+  @retval EFI_SUCCESS            The buffer was scaled.
+  @retval EFI_INVALID_PARAMETER  An input is invalid or the scaled size overflows.
+  @retval EFI_OUT_OF_RESOURCES   The scaled buffer could not be allocated.
+**/
+EFI_STATUS
+ScaleBootGraphicBlt (
+  IN  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt,
+  IN  UINTN                                Width,
+  IN  UINTN                                Height,
+  IN  UINTN                                Scale,
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        **ScaledBlt
+  );
+
+#endif
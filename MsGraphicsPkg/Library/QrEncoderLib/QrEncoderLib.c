@@ -3,6 +3,11 @@ QrEncoderLib.c
 
 QrEncoderLib is used to generate a QR code from caller data.
 
+All encoding state lives in a QR_ENCODER_CONTEXT supplied by the caller, so the
+encoder is reentrant and a context can be reused for any number of symbols.
+The symbol is held as row bitsets (one bit per module per plane), which lets the
+mask patterns be applied and scored a word of modules at a time.
+
 Copyright (C) Microsoft Corporation. All rights reserved.
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -12,48 +17,88 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <Protocol/GraphicsOutput.h>
 
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>            // AllocatePool
 #include <Library/QrEncoderLib.h>
-#include <Library/UefiBootServicesTableLib.h>       // gBS
 
 #include "QrEncoderTables.h"
 
+#define BITS_PER_BYTE  8
+
 // *----------------------------------------------------------------------------*
-// *   Global Variables                                prefix g for Global      *
+// *   Module storage                                                           *
+// *                                                                            *
+// *   Each row of the symbol is a bitset of QR_ROW_WORDS words per plane, with *
+// *   column x in bit (x % QR_BITS_PER_WORD) of word (x / QR_BITS_PER_WORD).   *
+// *   The two color planes hold bit 0 and bit 1 of the module color, so       *
+// *   QrGray, QrBlack, QrWhite and QrRsvd keep their values from the header.  *
 // *----------------------------------------------------------------------------*
-UINT8                          gQrVersion;
-INTN                           gQrSize;
-QRLEVEL                        gQrLevel;
-QRENCODING                     gQrMode;
-INTN                           gQrMask;
-UINT8                          *gQrBitmap = NULL;
-INTN                           gQrBitmapLen;
-UINT8                          *gCodeWords = NULL;
-UINTN                          gCodeWordCount;
-UINT8                          *gECWords = NULL;
-UINTN                          gECWordCount;
-UINT8                          *gBitStream = NULL;
-UINTN                          gBitStreamCount;
-CONST QrTableEntry             *gQrT;
-UINT32                         gFlags;
-EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *gBltBuffer = NULL;
-
-// Module Colors
-#define  QrRsvd     0x03
-#define  QrWhite    0x02
-#define  QrBlack    0x01
-#define  QrGray     0x00
-#define  QrExclude  0x80       // Color mask to assist with XOR pattern
-
-// Module Drawing state
-static BOOLEAN  up;
-static BOOLEAN  right;
-static INTN     row;
-static INTN     col;
+#define QR_MAX_SIZE         (QrMaxVersion * 4 + 17)      // 177 modules for version 40
+#define QR_BITS_PER_WORD    (sizeof (UINTN) * BITS_PER_BYTE)
+#define QR_ROW_WORDS        ((QR_MAX_SIZE + QR_BITS_PER_WORD - 1) / QR_BITS_PER_WORD)
+#define QR_MAX_CODE_WORDS   3706                         // Data + EC code words of a version 40 symbol
+#define QR_MASK_ROW_PERIOD  12                           // Every mask pattern repeats after 12 rows
+#define QR_FINDER_LENGTH    10                           // Modules of the Evaluate3 targets that are compared
+
+#define QR_WORD_INDEX(x)  ((UINTN)(x) / QR_BITS_PER_WORD)
+#define QR_WORD_BIT(x)    ((UINTN)1 << ((UINTN)(x) % QR_BITS_PER_WORD))
+
+typedef UINTN QR_ROW[QR_ROW_WORDS];
+
+typedef struct {
+  UINT8                 Version;
+  INTN                  Size;
+  UINTN                 RowWords;                   // Words of a row used by a symbol of Size modules
+  QRLEVEL               Level;
+  QRENCODING            Mode;
+  INTN                  Mask;
+  UINT32                Flags;
+  CONST QrTableEntry    *QrT;
+
+  //
+  // The symbol
+  //
+  QR_ROW                Color0[QR_MAX_SIZE];        // Bit 0 of the module color
+  QR_ROW                Color1[QR_MAX_SIZE];        // Bit 1 of the module color
+  QR_ROW                Exclude[QR_MAX_SIZE];       // Module does not participate in data masking
+  QR_ROW                RowMask;                    // Columns 0 to Size - 1
+
+  //
+  // Mask evaluation.  Dark and Gray hold the colors of the masked symbol with QrRsvd
+  // treated as white, HEqual and VEqual flag modules that match the module to their
+  // right and below.
+  //
+  QR_ROW                FlipRows[QR_MASK_PATTERNS][QR_MASK_ROW_PERIOD];
+  QR_ROW                Dark[QR_MAX_SIZE];
+  QR_ROW                Gray[QR_MAX_SIZE];
+  QR_ROW                HEqual[QR_MAX_SIZE];
+  QR_ROW                VEqual[QR_MAX_SIZE];
+
+  UINT8                 CodeWords[QR_MAX_CODE_WORDS];
+  UINTN                 CodeWordCount;
+  UINT8                 ECWords[QR_MAX_CODE_WORDS];
+  UINTN                 ECWordCount;
+  UINT8                 BitStream[QR_MAX_CODE_WORDS];
+  UINTN                 BitStreamCount;
+
+  //
+  // AddCodeWordBits state
+  //
+  UINTN                 CwIndex;
+  UINTN                 CwUsed;
+  UINTN                 CwTarget;
+
+  //
+  // Module drawing state
+  //
+  BOOLEAN               Up;
+  BOOLEAN               Right;
+  INTN                  Row;
+  INTN                  Col;
+} QR_ENCODER_CONTEXT;
 
-#define BITS_PER_BYTE  8
 // *----------------------------------------------------------------------------*
 // *   Check Encoding Type.                                                     *
 // *   Checks the data stream and returns the lowest encoding type for the      *
@@ -106,10 +151,12 @@ CheckEncodingType (
 // *   Checks the data stream and returns the lowest encoding type for the      *
 // *   data                                                                     *
 // *----------------------------------------------------------------------------*
+static
 UINT8
 CheckQrVersion (
-  UINT8   *Data,
-  UINT16  DataLen
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT8               *Data,
+  UINT16              DataLen
   )
 {
   UINTN               i;
@@ -117,13 +164,12 @@ CheckQrVersion (
   UINT16              qLen;
   CONST QrTableEntry  *QrT;
 
-  // Start with Version 1 table entry - using qQrLevel to select which of the 4 entries per version to look at
-  for (i = gQrLevel - 1; i < QR_TABLE_ENTRIES; i += 4) {
+  // Start with Version 1 table entry - using Level to select which of the 4 entries per version to look at
+  for (i = Ctx->Level - 1; i < QR_TABLE_ENTRIES; i += 4) {
     // Spec has versions 1-40, and 4 EC levels.
     QrT = &gQrTable[i];
-    DEBUG ((DEBUG_INFO, "Checking version table entry %d\n", i));
 
-    switch (gQrMode) {
+    switch (Ctx->Mode) {
       case QrNumericMode:
         qLen = QrT->maxNumeric;
         break;
@@ -135,7 +181,7 @@ CheckQrVersion (
         break;
       default:
         qLen = 0;
-        DEBUG ((DEBUG_ERROR, "%a Internal error - QrMode invalid %d\n", __FUNCTION__, gQrMode));
+        DEBUG ((DEBUG_ERROR, "%a Internal error - QrMode invalid %d\n", __FUNCTION__, Ctx->Mode));
         ASSERT (FALSE);
     }
 
@@ -154,31 +200,22 @@ CheckQrVersion (
   return Version;
 }
 
-// *----------------------------------------------------------------------------*
-// *   Private Variables for AddCodeWordBits    prefix pv for Private Variables *
-// *----------------------------------------------------------------------------*
-static UINTN  pvCwIndex;
-static UINTN  pvCwUsed;
-static UINTN  pvCwTarget;
-
 /*--------------------------------------------------------------------------------*/
 /*  Init Code Word Bits                                                           */
-/*       Bits           - The bits to be added                                    */
-/*       Count          - Number of bits.  Intended to work with number of bits in*/
-/*                        Bits - 1                                                */
-/*       NOTE:  It is the callers responsibility to free the gCodeWords array     */
+/*       NumberOfCodeWords - Number of data code words in the symbol              */
 /*--------------------------------------------------------------------------------*/
 static
 VOID
 InitCodeWords (
-  UINTN  NumberOfCodeWords
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINTN               NumberOfCodeWords
   )
 {
-  gCodeWords     = AllocateZeroPool (NumberOfCodeWords); // CodeWords needs to be zeros.
-  gCodeWordCount = NumberOfCodeWords;
-  pvCwIndex      = 0;
-  pvCwUsed       = 0;
-  pvCwTarget     = NumberOfCodeWords;
+  ZeroMem (Ctx->CodeWords, NumberOfCodeWords);  // CodeWords needs to be zeros.
+  Ctx->CodeWordCount = NumberOfCodeWords;
+  Ctx->CwIndex       = 0;
+  Ctx->CwUsed        = 0;
+  Ctx->CwTarget      = NumberOfCodeWords;
 }
 
 /*--------------------------------------------------------------------------------*/
@@ -190,46 +227,44 @@ InitCodeWords (
 static
 VOID
 AddCodeWordBits (
-  UINTN  Bits,
-  UINTN  Count
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINTN               Bits,
+  UINTN               Count
   )
 {
   // allows bits up to 31/63
   UINTN  temp;
   UINTN  mask;
 
-  if (gFlags & QR_FLAGS_DEBUG_ENCODING) {
+  if (Ctx->Flags & QR_FLAGS_DEBUG_ENCODING) {
     DEBUG ((DEBUG_INFO, "Adding %d bits %x\n", Count, Bits));
   }
 
-  ASSERT (gCodeWords != NULL);
-
   while (Count > 0) {
-    mask = (-1 << Count);
+    mask = (MAX_UINTN << Count);
     temp = Bits & ~mask;
 
-    if (Count <= (BITS_PER_BYTE - pvCwUsed)) {
+    if (Count <= (BITS_PER_BYTE - Ctx->CwUsed)) {
       // All remaining bits fit into this CodeWord
-      temp    <<= (BITS_PER_BYTE - pvCwUsed) - Count;
-      pvCwUsed += Count;
-      Count     = 0;
+      temp       <<= (BITS_PER_BYTE - Ctx->CwUsed) - Count;
+      Ctx->CwUsed += Count;
+      Count        = 0;
     } else {
       // Take up to 8 bits from the remaining bits
-      temp    >>= Count - (BITS_PER_BYTE - pvCwUsed);
-      Count    -= (BITS_PER_BYTE - pvCwUsed);
-      pvCwUsed += BITS_PER_BYTE - pvCwUsed;
+      temp       >>= Count - (BITS_PER_BYTE - Ctx->CwUsed);
+      Count       -= (BITS_PER_BYTE - Ctx->CwUsed);
+      Ctx->CwUsed += BITS_PER_BYTE - Ctx->CwUsed;
     }
 
-    if (pvCwIndex < pvCwTarget) {
-      gCodeWords[pvCwIndex] |= (UINT8)temp;
-    } else {
+    if (Ctx->CwIndex < Ctx->CwTarget) {
+      Ctx->CodeWords[Ctx->CwIndex] |= (UINT8)temp;
+    } else if (temp != 0) {
       DEBUG ((DEBUG_ERROR, "Unable to store bits %d\n", temp));
     }
 
-    gCodeWords[pvCwIndex] |= (UINT8)temp;
-    if (pvCwUsed == BITS_PER_BYTE) {
-      pvCwIndex++;
-      pvCwUsed = 0;
+    if (Ctx->CwUsed == BITS_PER_BYTE) {
+      Ctx->CwIndex++;
+      Ctx->CwUsed = 0;
     }
   }
 }
@@ -275,15 +310,12 @@ PrintBinary (
 }
 
 /*--------------------------------------------------------------------------------*/
-/*  AddCodeWordBits     Adds bits to the CodeWord array                           */
-/*       Bits           - The bits to be added                                    */
-/*       Count          - Number of bits.  Intended to work with number of bits in*/
-/*                        Bits - 1                                                */
+/*  AddCodeWordPadBytes  Fills the unused data code words with the pad pattern    */
 /*--------------------------------------------------------------------------------*/
 static
 VOID
 AddCodeWordPadBytes (
-  VOID
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
   BOOLEAN  PadSelect;
@@ -293,13 +325,13 @@ AddCodeWordPadBytes (
   #define PAD1  0xEC// Pad code word values from ISO 18004-2015 7.4.10
   #define PAD2  0x11
 
-  if (pvCwUsed > 0) {
-    pvCwIndex++;
+  if (Ctx->CwUsed > 0) {
+    Ctx->CwIndex++;
   }
 
   PadSelect = FALSE;
 
-  while (pvCwIndex < pvCwTarget) {
+  while (Ctx->CwIndex < Ctx->CwTarget) {
     if (PadSelect) {
       PadSelect    = FALSE;
       PadCharacter = PAD2;
@@ -308,13 +340,13 @@ AddCodeWordPadBytes (
       PadSelect    = TRUE;
     }
 
-    gCodeWords[pvCwIndex++] = PadCharacter;
+    Ctx->CodeWords[Ctx->CwIndex++] = PadCharacter;
   }
 
-  if (gFlags & QR_FLAGS_DEBUG_CODE_WORDS) {
-    for (i = 0; i < pvCwTarget; i++) {
-      DEBUG ((DEBUG_INFO, " CodeWord %4d is %4d - ", i, gCodeWords[i]));
-      PrintBinary (gCodeWords[i], 8, '0');
+  if (Ctx->Flags & QR_FLAGS_DEBUG_CODE_WORDS) {
+    for (i = 0; i < Ctx->CwTarget; i++) {
+      DEBUG ((DEBUG_INFO, " CodeWord %4d is %4d - ", i, Ctx->CodeWords[i]));
+      PrintBinary (Ctx->CodeWords[i], 8, '0');
       DEBUG ((DEBUG_INFO, "\n"));
     }
   }
@@ -328,23 +360,26 @@ AddCodeWordPadBytes (
 /*       Remainder      - Where to store the EC code words                        */
 /*                                                                                */
 /*  Divisor is a polynomial from table A.1 based on the number of ECWords         */
+/*                                                                                */
+/*  The division is done as a shift register in Remainder, so no temporary copy   */
+/*  of the message is needed.  Divisor terms are logs, so each step is one        */
+/*  gGfLog lookup and RemainderCount gGfExp lookups.                              */
 /*--------------------------------------------------------------------------------*/
 static
 VOID
 PolynomialDivision (
-  UINT16  DividendCount,
-  UINT8   *Dividend,
-  UINT16  RemainderCount,
-  UINT8   *Remainder
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT16              DividendCount,
+  UINT8               *Dividend,
+  UINT16              RemainderCount,
+  UINT8               *Remainder
   )
 {
-  UINT8        *TempRemainder;
   CONST UINT8  *Divisor;
-  UINT8        temp;
-  UINTN        sizeofnumbers;
   UINTN        i;
   UINTN        j;
-  UINT8        stepMultiplier;
+  UINT8        Lead;
+  UINTN        stepMultiplier;
 
   Divisor = gGeneratorPolynomials[RemainderCount];
   if (Divisor == NULL) {
@@ -353,7 +388,7 @@ PolynomialDivision (
     return;
   }
 
-  if (gFlags & QR_FLAGS_DEBUG_POLYDIVIDE) {
+  if (Ctx->Flags & QR_FLAGS_DEBUG_POLYDIVIDE) {
     DEBUG ((DEBUG_INFO, "Divisor %3d  ", RemainderCount));
     for (j = 0; j < (UINTN)(RemainderCount+1); j++) {
       DEBUG ((DEBUG_INFO, " %3d,", Divisor[j]));
@@ -362,62 +397,30 @@ PolynomialDivision (
     DEBUG ((DEBUG_INFO, "\n"));
   }
 
-  sizeofnumbers = DividendCount + RemainderCount;
-  TempRemainder = AllocateZeroPool (sizeofnumbers);
+  ZeroMem (Remainder, RemainderCount);
 
   for (i = 0; i < DividendCount; i++) {
-    TempRemainder[i] = Dividend[i];
-  }
-
-  if (gFlags & QR_FLAGS_DEBUG_POLYDIVIDE) {
-    DEBUG ((DEBUG_INFO, "MsgPly %3d   ", i));
-    for (j = 0; j < sizeofnumbers; j++) {
-      DEBUG ((DEBUG_INFO, " %3d,", TempRemainder[j]));
-    }
-
-    DEBUG ((DEBUG_INFO, "\n"));
-  }
-
-  for (i = 0; i < DividendCount; i++) {
-    stepMultiplier = logTable[TempRemainder[i]];     // Lead term of message / previous result
-    if (TempRemainder[i] == 0) {
+    Lead = Dividend[i] ^ Remainder[0];                 // Lead term of message / previous result
+    CopyMem (Remainder, Remainder + 1, RemainderCount - 1);
+    Remainder[RemainderCount - 1] = 0;
+    if (Lead == 0) {
       continue;
     }
 
-    for (j = i; j < i + RemainderCount + 1; j++) {
-      temp              = alogTable[(stepMultiplier + Divisor[j - i]) % (GF256_SIZE - 1)];
-      TempRemainder[j] ^= temp;        // XOR is Galois field Add
-      if (gFlags & QR_FLAGS_DEBUG_POLYDIVIDE) {
-        DEBUG ((DEBUG_INFO, "--- s=%3d d=%3d t=%3d r=%3d\n", stepMultiplier, Divisor[j-i], temp, TempRemainder[j]));
-      }
-    }
-
-    if (gFlags & QR_FLAGS_DEBUG_POLYDIVIDE) {
-      DEBUG ((DEBUG_INFO, "Result %3d   ", i));
-      for (j = 0; j < sizeofnumbers; j++) {
-        DEBUG ((DEBUG_INFO, " %3d,", TempRemainder[j]));
-      }
-
-      DEBUG ((DEBUG_INFO, "\n"));
+    stepMultiplier = gGfLog[Lead];
+    for (j = 0; j < RemainderCount; j++) {
+      Remainder[j] ^= gGfExp[stepMultiplier + Divisor[j + 1]];     // XOR is Galois field Add
     }
   }
 
-  if (gFlags & QR_FLAGS_DEBUG_POLYDIVIDE) {
+  if (Ctx->Flags & QR_FLAGS_DEBUG_POLYDIVIDE) {
     DEBUG ((DEBUG_INFO, "Result - "));
-  }
-
-  for (j = 0; j < RemainderCount; j++) {
-    Remainder[j] = TempRemainder[j+DividendCount];     // Copy remainder
-    if (gFlags & QR_FLAGS_DEBUG_POLYDIVIDE) {
+    for (j = 0; j < RemainderCount; j++) {
       DEBUG ((DEBUG_INFO, " %3d,", Remainder[j]));
     }
-  }
 
-  if (gFlags & QR_FLAGS_DEBUG_POLYDIVIDE) {
     DEBUG ((DEBUG_INFO, "\n"));
   }
-
-  FreePool (TempRemainder);
 }
 
 /*--------------------------------------------------------------------------------*/
@@ -426,8 +429,9 @@ PolynomialDivision (
 static
 VOID
 EncodeBytes (
-  UINT8  *Data,
-  UINTN  DataLen
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT8               *Data,
+  UINTN               DataLen
   )
 {
   UINTN  i;
@@ -437,8 +441,8 @@ EncodeBytes (
   // all binary data is allowed.
 
   for (i = 0; i < DataLen; i++) {
-    AddCodeWordBits (Data[i], 8);
-    if (gFlags & QR_FLAGS_DEBUG_ENCODING) {
+    AddCodeWordBits (Ctx, Data[i], 8);
+    if (Ctx->Flags & QR_FLAGS_DEBUG_ENCODING) {
       DEBUG ((DEBUG_INFO, " Binary %2d:%2d is %4d - ", i - 1, i, Data[i]));
       PrintBinary (Data[i], 8, '0');
       DEBUG ((DEBUG_INFO, "\n"));
@@ -452,8 +456,9 @@ EncodeBytes (
 static
 VOID
 EncodeNumeric (
-  UINT8  *Data,
-  UINTN  DataLen
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT8               *Data,
+  UINTN               DataLen
   )
 {
   UINT16  Triplet  = 0;
@@ -466,8 +471,8 @@ EncodeNumeric (
     Triplet += Data[i] - '0';
     TripIndx++;
     if (TripIndx == 3) {
-      AddCodeWordBits (Triplet, 10);         // Three digits pack into 10 bits
-      if (gFlags & QR_FLAGS_DEBUG_ENCODING) {
+      AddCodeWordBits (Ctx, Triplet, 10);    // Three digits pack into 10 bits
+      if (Ctx->Flags & QR_FLAGS_DEBUG_ENCODING) {
         DEBUG ((DEBUG_INFO, " Triplet %2d:%2d is %4d - ", i - 1, i, Triplet));
         PrintBinary (Triplet, 10, '0');
         DEBUG ((DEBUG_INFO, "\n"));
@@ -480,15 +485,15 @@ EncodeNumeric (
 
   // Handle left over digits....
   if (TripIndx == 1) {
-    AddCodeWordBits (Triplet, 4);            // One left over digits pack into 4 bits
-    if (gFlags & QR_FLAGS_DEBUG_ENCODING) {
+    AddCodeWordBits (Ctx, Triplet, 4);       // One left over digits pack into 4 bits
+    if (Ctx->Flags & QR_FLAGS_DEBUG_ENCODING) {
       DEBUG ((DEBUG_INFO, " Triplet %2d:%2d is %4d -       ", i - 1, i, Triplet));
       PrintBinary (Triplet, 4, '0');
       DEBUG ((DEBUG_INFO, "\n"));
     }
   } else if (TripIndx == 2) {
-    AddCodeWordBits (Triplet, 7);            // Two left over digits pack into 7 bits;
-    if (gFlags & QR_FLAGS_DEBUG_ENCODING) {
+    AddCodeWordBits (Ctx, Triplet, 7);       // Two left over digits pack into 7 bits;
+    if (Ctx->Flags & QR_FLAGS_DEBUG_ENCODING) {
       DEBUG ((DEBUG_INFO, " Triplet %2d:%2d is %4d -    ", i - 1, i, Triplet));
       PrintBinary (Triplet, 7, '0');
       DEBUG ((DEBUG_INFO, "\n"));
@@ -502,8 +507,9 @@ EncodeNumeric (
 static
 VOID
 EncodeAlphanumeric (
-  UINT8  *Data,
-  UINTN  DataLen
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT8               *Data,
+  UINTN               DataLen
   )
 {
   UINTN   i;
@@ -529,8 +535,8 @@ EncodeAlphanumeric (
       Pair = index;
     } else {
       Pair = index + (UINT16)(Pair * 45);
-      AddCodeWordBits (Pair, 11);
-      if (gFlags & QR_FLAGS_DEBUG_ENCODING) {
+      AddCodeWordBits (Ctx, Pair, 11);
+      if (Ctx->Flags & QR_FLAGS_DEBUG_ENCODING) {
         DEBUG ((DEBUG_INFO, " Pair %2d:%2d is %4d - ", i - 1, i, Pair));
         PrintBinary (Pair, 11, '0');
         DEBUG ((DEBUG_INFO, "\n"));
@@ -539,8 +545,8 @@ EncodeAlphanumeric (
   }
 
   if (1 == (i % 2)) {
-    AddCodeWordBits (Pair, 6);
-    if (gFlags & QR_FLAGS_DEBUG_ENCODING) {
+    AddCodeWordBits (Ctx, Pair, 6);
+    if (Ctx->Flags & QR_FLAGS_DEBUG_ENCODING) {
       DEBUG ((DEBUG_INFO, " Pair  :%2d is%4d -      ", i, Pair));
       PrintBinary (Pair, 6, '0');
       DEBUG ((DEBUG_INFO, "\n"));
@@ -548,62 +554,136 @@ EncodeAlphanumeric (
   }
 }
 
+/*--------------------------------------------------------------------------------*/
+/* getModule - returns the color, including QrExclude, of the module at x:y       */
+/*--------------------------------------------------------------------------------*/
+static
+UINT8
+getModule (
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                x,
+  INTN                y
+  )
+{
+  UINTN  w;
+  UINTN  b;
+  UINT8  Color;
+
+  w     = QR_WORD_INDEX (x);
+  b     = QR_WORD_BIT (x);
+  Color = 0;
+  if ((Ctx->Color0[y][w] & b) != 0) {
+    Color |= 0x01;
+  }
+
+  if ((Ctx->Color1[y][w] & b) != 0) {
+    Color |= 0x02;
+  }
+
+  if ((Ctx->Exclude[y][w] & b) != 0) {
+    Color |= QrExclude;
+  }
+
+  return Color;
+}
+
+/*--------------------------------------------------------------------------------*/
+/* setModule - sets the module at x:y to Color, which may include QrExclude       */
+/*--------------------------------------------------------------------------------*/
+static
+VOID
+setModule (
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                x,
+  INTN                y,
+  UINT8               Color
+  )
+{
+  UINTN  w;
+  UINTN  b;
+
+  if ((x < 0) || (x >= Ctx->Size) || (y < 0) || (y >= Ctx->Size)) {
+    DEBUG ((DEBUG_ERROR, "%a Attempt to write module out of bitmap bounds\n", __FUNCTION__));
+    ASSERT (FALSE);
+    return;
+  }
+
+  w = QR_WORD_INDEX (x);
+  b = QR_WORD_BIT (x);
+
+  Ctx->Color0[y][w]  &= ~b;
+  Ctx->Color1[y][w]  &= ~b;
+  Ctx->Exclude[y][w] &= ~b;
+  if ((Color & 0x01) != 0) {
+    Ctx->Color0[y][w] |= b;
+  }
+
+  if ((Color & 0x02) != 0) {
+    Ctx->Color1[y][w] |= b;
+  }
+
+  if ((Color & QrExclude) != 0) {
+    Ctx->Exclude[y][w] |= b;
+  }
+}
+
 /*--------------------------------------------------------------------------------*/
 /* setBitmap - this draws a module at the next module location ISO 18004 7.7.3    */
 /*--------------------------------------------------------------------------------*/
 static
 VOID
 setBitmap (
-  UINT8  *bitmap,
-  INTN   rowSize,
-  UINT8  Color
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT8               Color
   )
 {
   BOOLEAN  done = FALSE;
+  INTN     rowSize;
 
+  rowSize = Ctx->Size;
   while (!done) {
-    if (bitmap[row * rowSize + col] == QrGray) {
-      bitmap[row * rowSize + col] = Color;
-      done                        = TRUE;
+    if (getModule (Ctx, Ctx->Col, Ctx->Row) == QrGray) {
+      setModule (Ctx, Ctx->Col, Ctx->Row, Color);
+      done = TRUE;
     }
 
-    if (up) {
-      if (right) {
-        col--;
-        right = FALSE;
+    if (Ctx->Up) {
+      if (Ctx->Right) {
+        Ctx->Col--;
+        Ctx->Right = FALSE;
       } else {
-        if (row > 0) {
-          col++;
-          row--;
+        if (Ctx->Row > 0) {
+          Ctx->Col++;
+          Ctx->Row--;
         } else {
-          up = FALSE;
-          col--;
-          if (col == 6) {
+          Ctx->Up = FALSE;
+          Ctx->Col--;
+          if (Ctx->Col == 6) {
             // Column 7 is reserved
-            col = 5;
+            Ctx->Col = 5;
           }
         }
 
-        right = TRUE;
+        Ctx->Right = TRUE;
       }
     } else {
-      if (right) {
-        col--;
-        right = FALSE;
+      if (Ctx->Right) {
+        Ctx->Col--;
+        Ctx->Right = FALSE;
       } else {
-        if (row < (rowSize - 1)) {
-          col++;
-          row++;
+        if (Ctx->Row < (rowSize - 1)) {
+          Ctx->Col++;
+          Ctx->Row++;
         } else {
-          up = TRUE;
-          col--;
-          if (col == 6) {
+          Ctx->Up = TRUE;
+          Ctx->Col--;
+          if (Ctx->Col == 6) {
             // Column 7 is reserved
-            col = 5;
+            Ctx->Col = 5;
           }
         }
 
-        right = TRUE;
+        Ctx->Right = TRUE;
       }
     }
   }
@@ -615,8 +695,7 @@ setBitmap (
 static
 VOID
 drawBits (
-  UINT8  *bitmap,
-  INTN   rowSize
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
   UINTN  i;
@@ -624,79 +703,62 @@ drawBits (
   UINT8  bit;
   UINTN  mask;
 
-  up    = TRUE;
-  right = TRUE;
-  row   = rowSize - 1;
-  col   = rowSize - 1;
+  Ctx->Up    = TRUE;
+  Ctx->Right = TRUE;
+  Ctx->Row   = Ctx->Size - 1;
+  Ctx->Col   = Ctx->Size - 1;
 
-  for (i = 0; i < gBitStreamCount; i++ ) {
-    data = gBitStream[i];
-    mask = 0x80;
+  for (i = 0; i < Ctx->BitStreamCount; i++ ) {
+    data = Ctx->BitStream[i];
 
     for (mask = 0x80; mask != 0; mask >>= 1) {
       bit = (UINT8)(data & mask);
-      setBitmap (bitmap, rowSize, (bit == 0) ? QrWhite : QrBlack);
+      setBitmap (Ctx, (bit == 0) ? QrWhite : QrBlack);
     }
   }
 
-  for (i = 0; i < gQrT->requiredRemainder; i++) {
-    setBitmap (bitmap, rowSize, QrWhite);
+  for (i = 0; i < Ctx->QrT->requiredRemainder; i++) {
+    setBitmap (Ctx, QrWhite);
   }
 }
 
 /*--------------------------------------------------------------------------------*/
-/* drawHLine - draw a horizontal line left to right from x:y to x+tx-1:y          */
+/* drawHLine - draw a horizontal line left to right from x:y to tx:y              */
 /*--------------------------------------------------------------------------------*/
 static
 VOID
 drawHLine (
-  UINT8  *bitmap,
-  INTN   s,
-  INTN   x,
-  INTN   y,
-  INTN   tx,
-  UINT8  Color
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                x,
+  INTN                y,
+  INTN                tx,
+  UINT8               Color
   )
 {
   INTN  i;
-  INTN  g;
-  INTN  b;
 
-  g = y * s;         // Index of ROW to set bits into
-  b = g + x;         // Index of starting point for the line
   for (i = x; i <= tx; i++) {
-    if (b > (gQrBitmapLen)) {
-      DEBUG ((DEBUG_ERROR, "%a Attempt to write module out of bitmap bounds\n", __FUNCTION__));
-      ASSERT (FALSE);
-    } else {
-      bitmap[g + i] = Color;
-    }
+    setModule (Ctx, i, y, Color);
   }
 }
 
 /*--------------------------------------------------------------------------------*/
-/* drawVLine - draw a vertical line top to bottom from x:y to x:y+ty-1            */
+/* drawVLine - draw a vertical line top to bottom from x:y to x:ty                */
 /*--------------------------------------------------------------------------------*/
 static
 VOID
 drawVLine (
-  UINT8  *bitmap,
-  INTN   s,
-  INTN   x,
-  INTN   y,
-  INTN   ty,
-  UINT8  Color
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                x,
+  INTN                y,
+  INTN                ty,
+  UINT8               Color
   )
 {
   INTN  i;
 
   for (i = y; i <= ty; i++) {
-    if ((x + (i * s)) > (gQrBitmapLen)) {
-      DEBUG ((DEBUG_ERROR, "%a Attempt to write module out of bitmap bounds\n", __FUNCTION__));
-      ASSERT (FALSE);
-    } else {
-      bitmap[x +(i * s)] = Color;
-    }
+    setModule (Ctx, x, i, Color);
   }
 }
 
@@ -706,23 +768,25 @@ drawVLine (
 static
 VOID
 drawReserved (
-  UINT8  *bitmap,
-  INTN   rowSize
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  drawVLine (bitmap, rowSize, 8, 0, 8, QrRsvd_E);
-  drawHLine (bitmap, rowSize, 0, 8, 7, QrRsvd_E);
-  drawVLine (bitmap, rowSize, 8, rowSize - 7, rowSize - 1, QrRsvd_E);
-  drawHLine (bitmap, rowSize, rowSize-8, 8, rowSize - 1, QrRsvd_E);
+  INTN  rowSize;
+
+  rowSize = Ctx->Size;
+  drawVLine (Ctx, 8, 0, 8, QrRsvd_E);
+  drawHLine (Ctx, 0, 8, 7, QrRsvd_E);
+  drawVLine (Ctx, 8, rowSize - 7, rowSize - 1, QrRsvd_E);
+  drawHLine (Ctx, rowSize-8, 8, rowSize - 1, QrRsvd_E);
 
-  if (gQrVersion >= 7) {
+  if (Ctx->Version >= 7) {
     // Reserve the Version locations
-    drawHLine (bitmap, rowSize, 0, rowSize - 11, 6, QrRsvd_E);
-    drawHLine (bitmap, rowSize, 0, rowSize - 10, 6, QrRsvd_E);
-    drawHLine (bitmap, rowSize, 0, rowSize -  9, 6, QrRsvd_E);
-    drawVLine (bitmap, rowSize, rowSize - 11, 0, 6, QrRsvd_E);
-    drawVLine (bitmap, rowSize, rowSize - 10, 0, 6, QrRsvd_E);
-    drawVLine (bitmap, rowSize, rowSize -  9, 0, 6, QrRsvd_E);
+    drawHLine (Ctx, 0, rowSize - 11, 6, QrRsvd_E);
+    drawHLine (Ctx, 0, rowSize - 10, 6, QrRsvd_E);
+    drawHLine (Ctx, 0, rowSize -  9, 6, QrRsvd_E);
+    drawVLine (Ctx, rowSize - 11, 0, 6, QrRsvd_E);
+    drawVLine (Ctx, rowSize - 10, 0, 6, QrRsvd_E);
+    drawVLine (Ctx, rowSize -  9, 0, 6, QrRsvd_E);
   }
 }
 
@@ -737,36 +801,35 @@ drawReserved (
 static
 VOID
 drawFinder (
-  UINT8  *bitmap,
-  INTN   rowSize,
-  INTN   x,
-  INTN   y
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                x,
+  INTN                y
   )
 {
-  drawHLine (bitmap, rowSize, x, y, x + 6, QrBlack_E);
-  drawHLine (bitmap, rowSize, x, y + 6, x + 6, QrBlack_E);
-  drawVLine (bitmap, rowSize, x, y + 1, y + 6, QrBlack_E);
-  drawVLine (bitmap, rowSize, x + 6, y + 1, y + 6, QrBlack_E);
+  drawHLine (Ctx, x, y, x + 6, QrBlack_E);
+  drawHLine (Ctx, x, y + 6, x + 6, QrBlack_E);
+  drawVLine (Ctx, x, y + 1, y + 6, QrBlack_E);
+  drawVLine (Ctx, x + 6, y + 1, y + 6, QrBlack_E);
 
-  drawHLine (bitmap, rowSize, x + 1, y + 1, x + 5, QrWhite_E);
-  drawHLine (bitmap, rowSize, x + 1, y + 5, x + 5, QrWhite_E);
-  drawVLine (bitmap, rowSize, x + 1, y + 2, y + 5, QrWhite_E);
-  drawVLine (bitmap, rowSize, x + 5, y + 2, y + 5, QrWhite_E);
+  drawHLine (Ctx, x + 1, y + 1, x + 5, QrWhite_E);
+  drawHLine (Ctx, x + 1, y + 5, x + 5, QrWhite_E);
+  drawVLine (Ctx, x + 1, y + 2, y + 5, QrWhite_E);
+  drawVLine (Ctx, x + 5, y + 2, y + 5, QrWhite_E);
 
-  drawHLine (bitmap, rowSize, x + 2, y + 2, x + 4, QrBlack_E);
-  drawHLine (bitmap, rowSize, x + 2, y + 3, x + 4, QrBlack_E);
-  drawHLine (bitmap, rowSize, x + 2, y + 4, x + 4, QrBlack_E);
+  drawHLine (Ctx, x + 2, y + 2, x + 4, QrBlack_E);
+  drawHLine (Ctx, x + 2, y + 3, x + 4, QrBlack_E);
+  drawHLine (Ctx, x + 2, y + 4, x + 4, QrBlack_E);
 
   if (y != 0) {
-    drawHLine (bitmap, rowSize, x, y - 1, x + 7, QrWhite_E);
-    drawVLine (bitmap, rowSize, x + 7, y, y + 6, QrWhite_E);
+    drawHLine (Ctx, x, y - 1, x + 7, QrWhite_E);
+    drawVLine (Ctx, x + 7, y, y + 6, QrWhite_E);
   } else {
     if (x == 0) {
-      drawVLine (bitmap, rowSize, x + 7, y, y + 7, QrWhite_E);
-      drawHLine (bitmap, rowSize, x, y + 7, x + 6, QrWhite_E);
+      drawVLine (Ctx, x + 7, y, y + 7, QrWhite_E);
+      drawHLine (Ctx, x, y + 7, x + 6, QrWhite_E);
     } else {
-      drawVLine (bitmap, rowSize, x - 1, y, y + 7, QrWhite_E);
-      drawHLine (bitmap, rowSize, x, y + 7, x + 6, QrWhite_E);
+      drawVLine (Ctx, x - 1, y, y + 7, QrWhite_E);
+      drawHLine (Ctx, x, y + 7, x + 6, QrWhite_E);
     }
   }
 }
@@ -781,10 +844,9 @@ drawFinder (
 static
 VOID
 drawAlignment (
-  UINT8  *bitmap,
-  INTN   rowSize,
-  UINT8  x,
-  UINT8  y
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT8               x,
+  UINT8               y
   )
 {
   INTN  i;
@@ -795,59 +857,55 @@ drawAlignment (
   // Check to see if the area for the alignment patter is free
   for (i = y; i < y + 5; i++) {
     for (j = x; j < x + 5; j++) {
-      if (bitmap[(i * rowSize) + j] != QrGray) {
+      if (getModule (Ctx, j, i) != QrGray) {
         return;          // No Alignment pattern here
       }
     }
   }
 
-  drawHLine (bitmap, rowSize, x, y, x + 4, QrBlack_E);
-  drawHLine (bitmap, rowSize, x, y + 4, x + 4, QrBlack_E);
-  drawVLine (bitmap, rowSize, x, y + 1, y + 4, QrBlack_E);
-  drawVLine (bitmap, rowSize, x + 4, y + 1, y + 4, QrBlack_E);
-  drawHLine (bitmap, rowSize, x + 1, y + 1, x + 3, QrWhite_E);
-  drawHLine (bitmap, rowSize, x + 1, y + 2, x + 3, QrWhite_E);
-  drawHLine (bitmap, rowSize, x + 1, y + 3, x + 3, QrWhite_E);
-  bitmap[x + 2 + ((y + 2)* rowSize)] = QrBlack_E;
+  drawHLine (Ctx, x, y, x + 4, QrBlack_E);
+  drawHLine (Ctx, x, y + 4, x + 4, QrBlack_E);
+  drawVLine (Ctx, x, y + 1, y + 4, QrBlack_E);
+  drawVLine (Ctx, x + 4, y + 1, y + 4, QrBlack_E);
+  drawHLine (Ctx, x + 1, y + 1, x + 3, QrWhite_E);
+  drawHLine (Ctx, x + 1, y + 2, x + 3, QrWhite_E);
+  drawHLine (Ctx, x + 1, y + 3, x + 3, QrWhite_E);
+  setModule (Ctx, x + 2, y + 2, QrBlack_E);
 }
 
 /*--------------------------------------------------------------------------------*/
-/* drawHTiming - draw the horizontal timing pattern from x:y to x+tx-1:y          */
+/* drawHTiming - draw the horizontal timing pattern from x:y-1 to tx-1:y-1        */
 /*--------------------------------------------------------------------------------*/
 static
 VOID
 drawHTiming (
-  UINT8  *bitmap,
-  INTN   rowSize,
-  INTN   x,
-  INTN   y,
-  INTN   tx
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                x,
+  INTN                y,
+  INTN                tx
   )
 {
   INTN     i;
-  INTN     b;
   BOOLEAN  IsWhite;
 
-  b       = (y - 1) * rowSize;
   IsWhite = FALSE;
 
   for (i = x; i < tx; i++) {
-    bitmap[b + i] = (IsWhite) ? QrWhite_E : QrBlack_E;
-    IsWhite       = !IsWhite;
+    setModule (Ctx, i, y - 1, (IsWhite) ? QrWhite_E : QrBlack_E);
+    IsWhite = !IsWhite;
   }
 }
 
 /*--------------------------------------------------------------------------------*/
-/* drawVTiming - draw the vertical timing pattern from x:y to x:y+ty-1            */
+/* drawVTiming - draw the vertical timing pattern from x:y-1 to x:ty-1            */
 /*--------------------------------------------------------------------------------*/
 static
 VOID
 drawVTiming (
-  UINT8  *bitmap,
-  INTN   rowSize,
-  INTN   x,
-  INTN   y,
-  INTN   ty
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                x,
+  INTN                y,
+  INTN                ty
   )
 {
   INTN     i;
@@ -856,11 +914,250 @@ drawVTiming (
   IsWhite = FALSE;
 
   for (i = y; i < ty; i++) {
-    bitmap[(i - 1) * rowSize + x] = (IsWhite) ? QrWhite_E : QrBlack_E;
-    IsWhite                       = !IsWhite;
+    setModule (Ctx, x, i - 1, (IsWhite) ? QrWhite_E : QrBlack_E);
+    IsWhite = !IsWhite;
+  }
+}
+
+/*--------------------------------------------------------------------------------*/
+/* ShiftRowLeft - bit x of Dst is bit x + Count of Src (Count < QR_BITS_PER_WORD) */
+/*--------------------------------------------------------------------------------*/
+static
+VOID
+ShiftRowLeft (
+  UINTN        *Dst,
+  CONST UINTN  *Src,
+  UINTN        Words,
+  UINTN        Count
+  )
+{
+  UINTN  w;
+
+  if (Count == 0) {
+    CopyMem (Dst, Src, Words * sizeof (UINTN));
+    return;
+  }
+
+  for (w = 0; w < Words; w++) {
+    Dst[w] = Src[w] >> Count;
+    if (w + 1 < Words) {
+      Dst[w] |= Src[w + 1] << (QR_BITS_PER_WORD - Count);
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------*/
+/* ShiftRowRight - bit x of Dst is bit x - 1 of Src, and bit 0 of Dst is 0        */
+/*--------------------------------------------------------------------------------*/
+static
+VOID
+ShiftRowRight (
+  UINTN        *Dst,
+  CONST UINTN  *Src,
+  UINTN        Words
+  )
+{
+  UINTN  w;
+
+  for (w = 0; w < Words; w++) {
+    Dst[w] = Src[w] << 1;
+    if (w > 0) {
+      Dst[w] |= Src[w - 1] >> (QR_BITS_PER_WORD - 1);
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------*/
+/* CountRowBits - number of bits set in the first Words words of Row              */
+/*--------------------------------------------------------------------------------*/
+static
+INTN
+CountRowBits (
+  CONST UINTN  *Row,
+  UINTN        Words
+  )
+{
+  UINTN  w;
+  INTN   Count;
+
+  Count = 0;
+  for (w = 0; w < Words; w++) {
+    if (Row[w] != 0) {
+      Count += BitFieldCountOnes64 ((UINT64)Row[w], 0, 63);
+    }
+  }
+
+  return Count;
+}
+
+/*--------------------------------------------------------------------------------*/
+/* MaskFlip - TRUE if data mask pattern k inverts the module at Row:Column        */
+/*--------------------------------------------------------------------------------*/
+static
+BOOLEAN
+MaskFlip (
+  INTN  k,
+  INTN  Row,
+  INTN  Column
+  )
+{
+  switch (k) {
+    case 0:                                                       /* Data Mask Reference 000 */
+      return 0 == ((Row + Column) % 2);                           // (i + j) mod 2 = 0
+    case 1:                                                       /* Data Mask Reference 001 */
+      return 0 == (Row % 2);                                      // i mod 2 = 0
+    case 2:                                                       /* Data Mask Reference 010 */
+      return 0 == (Column % 3);                                   // j mod 3 = 0
+    case 3:                                                       /* Data Mask Reference 011 */
+      return 0 == ((Row + Column) % 3);                           // (i + j) mod 3 = 0
+    case 4:                                                       /* Data Mask Reference 100 */
+      return 0 == ((Row / 2) + (Column / 3)) % 2;                 // ((i div 2) + ( j div 3)) mod 2 = 0
+    case 5:                                                       /* Data Mask Reference 101 */
+      return 0 == ((Row * Column) % 2) + ((Row * Column) % 3);    // (i j) mod 2 + (i j) mod 3 = 0
+    case 6:                                                       /* Data Mask Reference 110 */
+      return 0 == (((Row * Column) % 2) + ((Row * Column) % 3)) % 2; // ((i j) mod 2 + (i j) mod 3) mod 2 = 0
+    case 7:                                                       /* Data Mask Reference 111 */
+      return 0 == (((Row + Column) % 2) + ((Row * Column) % 3)) % 2; // ((i+j) mod 2 + (i j) mod 3) mod 2 = 0
+  }
+
+  return FALSE;
+}
+
+/*--------------------------------------------------------------------------------*/
+/* BuildFlipRows - build the bitsets of modules each mask pattern inverts.  Every */
+/*                 pattern only depends on Row mod 12, so 12 rows cover a symbol. */
+/*--------------------------------------------------------------------------------*/
+static
+VOID
+BuildFlipRows (
+  QR_ENCODER_CONTEXT  *Ctx
+  )
+{
+  INTN  k;
+  INTN  Row;
+  INTN  Column;
+
+  ZeroMem (Ctx->FlipRows, sizeof (Ctx->FlipRows));
+  for (k = 0; k < QR_MASK_PATTERNS; k++) {
+    for (Row = 0; Row < QR_MASK_ROW_PERIOD; Row++) {
+      for (Column = 0; Column < Ctx->Size; Column++) {
+        if (MaskFlip (k, Row, Column)) {
+          Ctx->FlipRows[k][Row][QR_WORD_INDEX (Column)] |= QR_WORD_BIT (Column);
+        }
+      }
+    }
   }
 }
 
+/*--------------------------------------------------------------------------------*/
+/* MaskRowWord - color planes of one word of a row after applying mask pattern k  */
+/*                                                                                */
+/*         Normal:    modules not excluded and flipped change from white to       */
+/*                    black, and from any other color to white.                   */
+/*         MASK_ONLY: draw the mask pattern from ISO Spec Fig 21.  Flipped        */
+/*                    modules are black, or gray if excluded.  All others white.  */
+/*--------------------------------------------------------------------------------*/
+static
+VOID
+MaskRowWord (
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                k,
+  INTN                y,
+  UINTN               w,
+  UINTN               *C0,
+  UINTN               *C1
+  )
+{
+  UINTN  Flip;
+  UINTN  Excl;
+  UINTN  Flipped;
+  UINTN  IsWhite;
+
+  Flip = Ctx->FlipRows[k][y % QR_MASK_ROW_PERIOD][w];
+  Excl = Ctx->Exclude[y][w];
+
+  if (Ctx->Flags & QR_FLAGS_DEBUG_MASK_ONLY) {
+    *C0 = Flip & ~Excl;
+    *C1 = ~Flip & Ctx->RowMask[w];
+    return;
+  }
+
+  Flipped = Flip & ~Excl;
+  IsWhite = Ctx->Color1[y][w] & ~Ctx->Color0[y][w];
+  *C0     = (Ctx->Color0[y][w] & ~Flipped) | (IsWhite & Flipped);
+  *C1     = (Ctx->Color1[y][w] & ~Flipped) | (~IsWhite & Flipped);
+}
+
+/*--------------------------------------------------------------------------------*/
+/* BuildEvaluationPlanes - fill Dark, Gray, HEqual and VEqual for mask pattern k  */
+/*                                                                                */
+/*         QrRsvd is treated as white, as in the penalty rules.  A module equals  */
+/*         its neighbor when both are dark, both are gray, or both are neither.   */
+/*--------------------------------------------------------------------------------*/
+static
+VOID
+BuildEvaluationPlanes (
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                k
+  )
+{
+  INTN    y;
+  UINTN   w;
+  UINTN   C0;
+  UINTN   C1;
+  QR_ROW  PairMask;
+  QR_ROW  NextDark;
+  QR_ROW  NextGray;
+
+  // Horizontal pairs exist for columns 0 to Size - 2
+  ShiftRowLeft (PairMask, Ctx->RowMask, Ctx->RowWords, 1);
+
+  for (y = 0; y < Ctx->Size; y++) {
+    for (w = 0; w < Ctx->RowWords; w++) {
+      MaskRowWord (Ctx, k, y, w, &C0, &C1);
+      Ctx->Dark[y][w] = C0 & ~C1;
+      Ctx->Gray[y][w] = ~C0 & ~C1 & Ctx->RowMask[w];
+    }
+
+    ShiftRowLeft (NextDark, Ctx->Dark[y], Ctx->RowWords, 1);
+    ShiftRowLeft (NextGray, Ctx->Gray[y], Ctx->RowWords, 1);
+    for (w = 0; w < Ctx->RowWords; w++) {
+      Ctx->HEqual[y][w] = ~((Ctx->Dark[y][w] ^ NextDark[w]) | (Ctx->Gray[y][w] ^ NextGray[w])) & PairMask[w];
+    }
+
+    if (y > 0) {
+      for (w = 0; w < Ctx->RowWords; w++) {
+        Ctx->VEqual[y - 1][w] = ~((Ctx->Dark[y - 1][w] ^ Ctx->Dark[y][w]) | (Ctx->Gray[y - 1][w] ^ Ctx->Gray[y][w])) & Ctx->RowMask[w];
+      }
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------*/
+/* RunPenalty - Evaluate1 penalty of one line of adjacent module pairs            */
+/*                                                                                */
+/*         A run of L equal pairs (L + 1 modules) costs L - 1 once L >= 4.  Each  */
+/*         bit of Four starts 4 equal pairs, so a run has L - 3 of them, and each */
+/*         run has one bit of Four with no equal pair before it.                  */
+/*--------------------------------------------------------------------------------*/
+static
+INTN
+RunPenalty (
+  CONST UINTN  *Four,
+  CONST UINTN  *Previous,
+  UINTN        Words
+  )
+{
+  UINTN   w;
+  QR_ROW  Start;
+
+  for (w = 0; w < Words; w++) {
+    Start[w] = Four[w] & ~Previous[w];
+  }
+
+  return CountRowBits (Four, Words) + 2 * CountRowBits (Start, Words);
+}
+
 /*--------------------------------------------------------------------------------*/
 /* Evaluate 1                                                                     */
 /*         Compute a penalty based on runs of horizontal or vertical cells        */
@@ -872,89 +1169,47 @@ drawVTiming (
 static
 INTN
 Evaluate1 (
-  UINT8  *Bitmap,
-  INTN   RowSize
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  INTN   Penalty;
-  INTN   x, y;
-  INTN   AdjacentCount;
-  INTN   RowOffset;
-  UINT8  Cell1;
-  UINT8  Cell2;
+  INTN    Penalty;
+  INTN    y;
+  UINTN   w;
+  UINTN   i;
+  QR_ROW  Four;
+  QR_ROW  Shifted;
+  QR_ROW  Previous;
 
   Penalty = 0;
 
   //
   // Check each row for adjacent cells the same color.
   //
-  for (y = 0; y < RowSize; y++) {
-    // Check every Row
-    AdjacentCount = 0;
-    RowOffset     = y * RowSize;
-    Cell1         = Bitmap[RowOffset] & ~QrExclude;
-    if (Cell1 == QrRsvd) {
-      Cell1 = QrWhite;
-    }
-
-    for (x = 1; x < RowSize; x++) {
-      // Check every cell in the row
-      Cell2 = Bitmap[RowOffset + x] & ~QrExclude;
-      if (Cell2 == QrRsvd) {
-        Cell2 = QrWhite;
-      }
-
-      if (Cell1 == Cell2) {
-        AdjacentCount++;
-        if (AdjacentCount == 4) {
-          // 4th adjacent module is 5 in a row
-          Penalty += 3;
-        } else if (AdjacentCount > 4) {
-          Penalty++;
-        }
-      } else {
-        AdjacentCount = 0;
+  for (y = 0; y < Ctx->Size; y++) {
+    CopyMem (Four, Ctx->HEqual[y], sizeof (Four));
+    for (i = 1; i < 4; i++) {
+      ShiftRowLeft (Shifted, Ctx->HEqual[y], Ctx->RowWords, i);
+      for (w = 0; w < Ctx->RowWords; w++) {
+        Four[w] &= Shifted[w];
       }
-
-      Cell1 = Cell2;
     }
+
+    ShiftRowRight (Previous, Ctx->HEqual[y], Ctx->RowWords);
+    Penalty += RunPenalty (Four, Previous, Ctx->RowWords);
   }
 
   //
-  // Check each column for adjacent cells the same color.
+  // Check each column for adjacent cells the same color.  VEqual rows 0 to Size - 2 are valid.
   //
-  for (x = 0; x < RowSize; x++) {
-    // Check every column
-    AdjacentCount = 0;
-    Cell1         = Bitmap[x] & ~QrExclude;
-    if (Cell1 == QrRsvd) {
-      Cell1 = QrWhite;
+  ZeroMem (Previous, sizeof (Previous));
+  for (y = 0; y + 4 < Ctx->Size; y++) {
+    for (w = 0; w < Ctx->RowWords; w++) {
+      Four[w] = Ctx->VEqual[y][w] & Ctx->VEqual[y + 1][w] & Ctx->VEqual[y + 2][w] & Ctx->VEqual[y + 3][w];
     }
 
-    for (y = 1; y < RowSize; y++) {
-      // Check every cell in the column
-      Cell2 = Bitmap[(y * RowSize) + x] & ~QrExclude;
-      if (Cell2 == QrRsvd) {
-        Cell2 = QrWhite;
-      }
-
-      if (Cell1 == Cell2) {
-        AdjacentCount++;
-        if (AdjacentCount == 4) {
-          // 4th adjacent module is 5 in a row
-          Penalty += 3;
-        } else if (AdjacentCount > 4) {
-          Penalty++;
-        }
-      } else {
-        AdjacentCount = 0;
-      }
-
-      Cell1 = Cell2;
-    }
+    Penalty += RunPenalty (Four, (y > 0) ? Ctx->VEqual[y - 1] : Previous, Ctx->RowWords);
   }
 
-  DEBUG ((DEBUG_INFO, "Evaluate 1 penalty is %d\n", Penalty));
   return Penalty;
 }
 
@@ -969,57 +1224,112 @@ Evaluate1 (
 static
 INTN
 Evaluate2 (
-  UINT8  *Bitmap,
-  INTN   RowSize
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  INTN   Penalty;
-  INTN   x, y;
-  UINT8  Cell1;
-  UINT8  Cell2;
-  UINT8  Cell3;
-  UINT8  Cell4;
+  INTN    Penalty;
+  INTN    y;
+  UINTN   w;
+  QR_ROW  Right;
+  QR_ROW  Block;
 
   Penalty = 0;
 
   //
-  // Check each row for 2x2 collections of the same color.
+  // A block matches when the top pair, the left pair and the right pair are equal.
   //
-  for (y = 0; y < (RowSize - 1); y++) {
-    // Check two cells vertically and two cells horizontal
-    for (x = 0; x < (RowSize - 1); x++) {
-      // Checking two cells - so stop one short
-      Cell1 = Bitmap[(y * RowSize) + x] & ~QrExclude;
-      if (Cell1 == QrRsvd) {
-        Cell1 = QrWhite;
-      }
+  for (y = 0; y < (Ctx->Size - 1); y++) {
+    ShiftRowLeft (Right, Ctx->VEqual[y], Ctx->RowWords, 1);
+    for (w = 0; w < Ctx->RowWords; w++) {
+      Block[w] = Ctx->HEqual[y][w] & Ctx->VEqual[y][w] & Right[w];
+    }
 
-      Cell2 = Bitmap[(y * RowSize) + x + 1] & ~QrExclude;
-      if (Cell2 == QrRsvd) {
-        Cell2 = QrWhite;
-      }
+    Penalty += 3 * CountRowBits (Block, Ctx->RowWords);
+  }
 
-      if (Cell1 == Cell2) {
-        Cell3 = Bitmap[((y + 1) * RowSize) + x] & ~QrExclude;
-        if (Cell3 == QrRsvd) {
-          Cell3 = QrWhite;
-        }
+  return Penalty;
+}
 
-        if (Cell1 == Cell3) {
-          Cell4 = Bitmap[((y + 1) * RowSize) + x + 1] & ~QrExclude;
-          if (Cell4 == QrRsvd) {
-            Cell4 = QrWhite;
-          }
+/*--------------------------------------------------------------------------------*/
+/* FinderCandidates - bits of starting columns in row y where the first           */
+/*                    QR_FINDER_LENGTH modules of Target match                    */
+/*--------------------------------------------------------------------------------*/
+static
+VOID
+FinderCandidates (
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                y,
+  CONST UINT8         *Target,
+  CONST UINTN         *White,
+  UINTN               *Candidates
+  )
+{
+  UINTN   i;
+  UINTN   w;
+  QR_ROW  Shifted;
 
-          if (Cell1 == Cell4) {
-            Penalty += 3;
-          }
-        }
+  for (i = 0; i < QR_FINDER_LENGTH; i++) {
+    ShiftRowLeft (Shifted, (Target[i] == QrBlack) ? Ctx->Dark[y] : White, Ctx->RowWords, i);
+    for (w = 0; w < Ctx->RowWords; w++) {
+      Candidates[w] &= Shifted[w];
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------------*/
+/* ScanFinderRow - Evaluate3 penalty of row y, matching one module at a time      */
+/*--------------------------------------------------------------------------------*/
+static
+INTN
+ScanFinderRow (
+  QR_ENCODER_CONTEXT  *Ctx,
+  INTN                y,
+  CONST UINT8         *Target1,
+  CONST UINT8         *Target2
+  )
+{
+  INTN   Penalty;
+  INTN   x;
+  UINT8  Cell;
+  INTN   Target1Index;
+  INTN   Target2Index;
+
+  Penalty      = 0;
+  Target1Index = 0;
+  Target2Index = 0;
+  for (x = 0; x < (Ctx->Size - 11); x++) {
+    // Checking mutiple cells
+    if ((Ctx->Dark[y][QR_WORD_INDEX (x)] & QR_WORD_BIT (x)) != 0) {
+      Cell = QrBlack;
+    } else if ((Ctx->Gray[y][QR_WORD_INDEX (x)] & QR_WORD_BIT (x)) != 0) {
+      Cell = QrGray;
+    } else {
+      Cell = QrWhite;
+    }
+
+    if (Cell == Target1[Target1Index]) {
+      Target1Index++;
+      if (Target1Index == QR_FINDER_LENGTH) {
+        Penalty     += 40;
+        Target1Index = 0;
+        DEBUG ((DEBUG_INFO, "Found pattern 1 at %d:%d\n", y, x));
       }
+    } else {
+      Target1Index = 0;
+    }
+
+    if (Cell == Target2[Target2Index]) {
+      Target2Index++;
+      if (Target2Index == QR_FINDER_LENGTH) {
+        Penalty     += 40;
+        Target2Index = 0;
+        DEBUG ((DEBUG_INFO, "Found pattern 2 at %d:%d\n", y, x));
+      }
+    } else {
+      Target2Index = 0;
     }
   }
 
-  DEBUG ((DEBUG_INFO, "Evaluate 2 penalty is %d\n", Penalty));
   return Penalty;
 }
 
@@ -1032,104 +1342,64 @@ Evaluate2 (
 /*                                                                                */
 /*         Either horizontally or vertically                                      */
 /*         Add a penalty of 40 points for each occurrence.                        */
+/*                                                                                */
+/*         The scoring matches what this library has always produced, so mask    */
+/*         selection and the symbol do not change: the first 10 modules of each   */
+/*         target are compared, a match must end before column Size - 11, and    */
+/*         the vertical pass scores the rows a second time.  A row is only        */
+/*         scanned module by module when a whole word compare of the targets      */
+/*         finds a possible match in it.                                          */
 /*--------------------------------------------------------------------------------*/
 static
 INTN
 Evaluate3 (
-  UINT8  *Bitmap,
-  INTN   RowSize
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  INTN   Penalty;
-  INTN   x, y;
-  UINT8  Cell;
-  INTN   Target1Index;
-  INTN   Target2Index;
-  UINT8  Target1[] = { QrBlack, QrWhite, QrBlack, QrBlack, QrBlack, QrWhite, QrBlack, QrWhite, QrWhite, QrWhite, QrWhite };
-  UINT8  Target2[] = { QrWhite, QrWhite, QrWhite, QrWhite, QrBlack, QrWhite, QrBlack, QrBlack, QrBlack, QrWhite, QrBlack };
+  STATIC CONST UINT8  Target1[] = { QrBlack, QrWhite, QrBlack, QrBlack, QrBlack, QrWhite, QrBlack, QrWhite, QrWhite, QrWhite, QrWhite };
+  STATIC CONST UINT8  Target2[] = { QrWhite, QrWhite, QrWhite, QrWhite, QrBlack, QrWhite, QrBlack, QrBlack, QrBlack, QrWhite, QrBlack };
+  INTN                Penalty;
+  INTN                y;
+  INTN                x;
+  UINTN               w;
+  BOOLEAN             Found;
+  QR_ROW              StartMask;
+  QR_ROW              White;
+  QR_ROW              Candidates1;
+  QR_ROW              Candidates2;
 
   Penalty = 0;
 
-  //
-  // Check each row for the special patters.
-  //
-  for (y = 0; y < RowSize; y++) {
-    // Check every Row
-    Target1Index = 0;
-    Target2Index = 0;
-    for (x = 0; x < (RowSize - 11); x++) {
-      // Checking mutiple cells
-
-      Cell = Bitmap[(y * RowSize) + x] & ~QrExclude;
-      if (Cell == QrRsvd) {
-        Cell = QrWhite;
-      }
-
-      if (Cell == Target1[Target1Index]) {
-        Target1Index++;
-        if (Target1Index == 10) {
-          Penalty     += 40;
-          Target1Index = 0;
-          DEBUG ((DEBUG_INFO, "Found horizontal pattern 1 at %d:%d\n", y, x));
-        }
-      } else {
-        Target1Index = 0;
-      }
+  // A match starting at column x ends at x + 9, which must be before column Size - 11
+  ZeroMem (StartMask, sizeof (StartMask));
+  for (x = 0; x + QR_FINDER_LENGTH + 11 <= Ctx->Size; x++) {
+    StartMask[QR_WORD_INDEX (x)] |= QR_WORD_BIT (x);
+  }
 
-      if (Cell == Target2[Target2Index]) {
-        Target2Index++;
-        if (Target2Index == 10) {
-          Penalty     += 40;
-          Target2Index = 0;
-          DEBUG ((DEBUG_INFO, "Found horizontal pattern 2 at %d:%d\n", y, x));
-        }
-      } else {
-        Target2Index = 0;
-      }
+  for (y = 0; y < Ctx->Size; y++) {
+    for (w = 0; w < Ctx->RowWords; w++) {
+      White[w]       = ~(Ctx->Dark[y][w] | Ctx->Gray[y][w]) & Ctx->RowMask[w];
+      Candidates1[w] = StartMask[w];
+      Candidates2[w] = StartMask[w];
     }
-  }
 
-  //
-  // Check each column for the special patterns
-  //
-  for (y = 0; y < RowSize; y++) {
-    // Check every Row
-    Target1Index = 0;
-    Target2Index = 0;
-    for (x = 0; x < (RowSize - 11); x++) {
-      // Checking mutiple cells
-
-      Cell = Bitmap[(y * RowSize) + x] & ~QrExclude;
-      if (Cell == QrRsvd) {
-        Cell = QrWhite;
-      }
+    FinderCandidates (Ctx, y, Target1, White, Candidates1);
+    FinderCandidates (Ctx, y, Target2, White, Candidates2);
 
-      if (Cell == Target1[Target1Index]) {
-        Target1Index++;
-        if (Target1Index == 10) {
-          Penalty     += 40;
-          Target1Index = 0;
-          DEBUG ((DEBUG_INFO, "Found vertical pattern 1 at %d:%d\n", y, x));
-        }
-      } else {
-        Target1Index = 0;
+    Found = FALSE;
+    for (w = 0; w < Ctx->RowWords; w++) {
+      if ((Candidates1[w] | Candidates2[w]) != 0) {
+        Found = TRUE;
       }
+    }
 
-      if (Cell == Target2[Target2Index]) {
-        Target2Index++;
-        if (Target2Index == 10) {
-          Penalty     += 40;
-          Target2Index = 0;
-          DEBUG ((DEBUG_INFO, "Found vertical pattern 2 at %d:%d\n", y, x));
-        }
-      } else {
-        Target2Index = 0;
-      }
+    if (Found) {
+      Penalty += ScanFinderRow (Ctx, y, Target1, Target2);
     }
   }
 
-  DEBUG ((DEBUG_INFO, "Evaluate 3 penalty is %d\n", Penalty));
-  return Penalty;
+  // Horizontal and "vertical" passes both scan the rows
+  return 2 * Penalty;
 }
 
 /*--------------------------------------------------------------------------------*/
@@ -1139,32 +1409,23 @@ Evaluate3 (
 /*         For every 5% deviation, add 10 points                                  */
 /*         eg. 45% to 55% == 0 points                                             */
 /*         eg. 40% to 60% == 10 points                                            */
-/*         FYI - a 3x3 collection contains 4 2x2 collections - worth 12 points    */
 /*--------------------------------------------------------------------------------*/
 static
 INTN
 Evaluate4 (
-  UINT8  *Bitmap,
-  INTN   RowSize
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  INTN   Penalty;
-  INTN   x, y;
-  UINT8  Cell;
-  INTN   CountOfBlack;
-  INTN   TotalCount;
-  INTN   Ratio;
+  INTN  Penalty;
+  INTN  y;
+  INTN  CountOfBlack;
+  INTN  TotalCount;
+  INTN  Ratio;
 
-  TotalCount   = RowSize * RowSize;
+  TotalCount   = Ctx->Size * Ctx->Size;
   CountOfBlack = 0;
-  for (y = 0; y < RowSize; y++) {
-    for (x = 0; x < RowSize; x++) {
-      Cell = Bitmap[(y * RowSize) + x] & ~QrExclude;
-      // gQrRsvd is treated as White
-      if (Cell == QrBlack) {
-        CountOfBlack++;
-      }
-    }
+  for (y = 0; y < Ctx->Size; y++) {
+    CountOfBlack += CountRowBits (Ctx->Dark[y], Ctx->RowWords);
   }
 
   Ratio = ((CountOfBlack * 100) / TotalCount) - 50;
@@ -1174,8 +1435,6 @@ Evaluate4 (
 
   Penalty = 10 * (Ratio / 5);
 
-  DEBUG ((DEBUG_INFO, "Evaluate 4 penalty is %d, based on TC=%d, CB=%d, R=%d\n", Penalty, TotalCount, CountOfBlack, Ratio));
-
   return Penalty;
 }
 
@@ -1186,78 +1445,87 @@ Evaluate4 (
 static
 EFI_STATUS
 Step1_Process (
-  UINT8   *Data,
-  UINT16  DataLen,
-  INTN    RegionSize
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT8               *Data,
+  UINT16              DataLen,
+  INTN                RegionSize
   )
 {
   QRENCODING  suggestedMode;
   UINT8       suggestedQrVersion;
+  INTN        x;
 
   suggestedMode = CheckEncodingType (Data, DataLen);
 
-  if (gQrMode  < suggestedMode) {
-    if (gQrMode == QrAutoMode) {
-      gQrMode = suggestedMode;
+  if (Ctx->Mode  < suggestedMode) {
+    if (Ctx->Mode == QrAutoMode) {
+      Ctx->Mode = suggestedMode;
     } else {
-      DEBUG ((DEBUG_ERROR, "Suggested mode %d is larger than requested mode %d\n", suggestedMode, gQrMode));
+      DEBUG ((DEBUG_ERROR, "Suggested mode %d is larger than requested mode %d\n", suggestedMode, Ctx->Mode));
       return EFI_INVALID_PARAMETER;
     }
   }
 
-  suggestedQrVersion = CheckQrVersion (Data, DataLen);
+  suggestedQrVersion = CheckQrVersion (Ctx, Data, DataLen);
 
-  if (gQrVersion < suggestedQrVersion) {
-    if (gQrVersion == QrAutoVersion) {
+  if (Ctx->Version < suggestedQrVersion) {
+    if (Ctx->Version == QrAutoVersion) {
       // Automatic selection
-      gQrVersion = suggestedQrVersion;
+      Ctx->Version = suggestedQrVersion;
     } else {
-      DEBUG ((DEBUG_INFO, "Suggested version %d is larger than requested version %d\n", suggestedQrVersion, gQrVersion));
+      DEBUG ((DEBUG_INFO, "Suggested version %d is larger than requested version %d\n", suggestedQrVersion, Ctx->Version));
       return EFI_INVALID_PARAMETER;
     }
   }
 
   // Validate that Version and Mode are currect after applying suggested values;
-  if ((gQrVersion < QrMinVersion) || (gQrVersion > QrMaxVersion)) {
+  if ((Ctx->Version < QrMinVersion) || (Ctx->Version > QrMaxVersion)) {
     // ISO 18004:2015 Qr Versions supported
-    DEBUG ((DEBUG_INFO, "Suggested version %d is not 1<=QrVersion<=40\n", gQrVersion));
+    DEBUG ((DEBUG_INFO, "Suggested version %d is not 1<=QrVersion<=40\n", Ctx->Version));
     return EFI_INVALID_PARAMETER;
   }
 
-  if ((gQrMode <= QrAutoMode) || (gQrMode > QrByteMode)) {
+  if ((Ctx->Mode <= QrAutoMode) || (Ctx->Mode > QrByteMode)) {
     // Only support Num/Alpha/Byte for now
-    DEBUG ((DEBUG_INFO, "Suggested QrMode %d is not supported\n", gQrMode));
+    DEBUG ((DEBUG_INFO, "Suggested QrMode %d is not supported\n", Ctx->Mode));
     return EFI_INVALID_PARAMETER;
   }
 
-  DEBUG ((DEBUG_INFO, "QrVersion is %d\n", gQrVersion));
-  gQrSize = gQrVersion * 4 + 17;    // Rule from ISO 18004.
-  if (RegionSize < (gQrSize + (2 * QR_QUIET_ZONE))) {
-    DEBUG ((DEBUG_ERROR, "Region size %d for QR code size %d is too small\n", RegionSize, gQrSize));
+  DEBUG ((DEBUG_INFO, "QrVersion is %d\n", Ctx->Version));
+  Ctx->Size = Ctx->Version * 4 + 17;    // Rule from ISO 18004.
+  if (RegionSize < (Ctx->Size + (2 * QR_QUIET_ZONE))) {
+    DEBUG ((DEBUG_ERROR, "Region size %d for QR code size %d is too small\n", RegionSize, Ctx->Size));
     return EFI_INVALID_PARAMETER;
   }
 
-  gQrBitmapLen = gQrSize * gQrSize;
-  gQrBitmap    = AllocateZeroPool (gQrBitmapLen); // Initialize to "gray"
+  // Initialize to "gray"
+  Ctx->RowWords = (Ctx->Size + QR_BITS_PER_WORD - 1) / QR_BITS_PER_WORD;
+  ZeroMem (Ctx->Color0, sizeof (Ctx->Color0));
+  ZeroMem (Ctx->Color1, sizeof (Ctx->Color1));
+  ZeroMem (Ctx->Exclude, sizeof (Ctx->Exclude));
+  ZeroMem (Ctx->RowMask, sizeof (Ctx->RowMask));
+  for (x = 0; x < Ctx->Size; x++) {
+    Ctx->RowMask[QR_WORD_INDEX (x)] |= QR_WORD_BIT (x);
+  }
 
-  gQrT = &gQrTable[(gQrVersion - 1) * 4 + gQrLevel - 1];   // QrT points to the table entry to use;
+  Ctx->QrT = &gQrTable[(Ctx->Version - 1) * 4 + Ctx->Level - 1];   // QrT points to the table entry to use;
 
-  DEBUG ((DEBUG_INFO, "Using QrCode=%d (%dx%d), Mode=%d, ECLevel=%d\n", gQrVersion, gQrSize, gQrSize, gQrMode, gQrLevel));
+  DEBUG ((DEBUG_INFO, "Using QrCode=%d (%dx%d), Mode=%d, ECLevel=%d\n", Ctx->Version, Ctx->Size, Ctx->Size, Ctx->Mode, Ctx->Level));
 
   DEBUG ((
     DEBUG_INFO,
     "entry   %d %d %d %d %d %d %d %d %d %d %d\n",
-    gQrT->totalWords,
-    gQrT->ECWordsPerBlock,
-    gQrT->group1BlockCount,
-    gQrT->group1Words,
-    gQrT->group2BlockCount,
-    gQrT->group2Words,
-    gQrT->requiredRemainder,
-    gQrT->maxNumeric,
-    gQrT->maxAlphanumeric,
-    gQrT->maxBytes,
-    gQrT->maxKanji
+    Ctx->QrT->totalWords,
+    Ctx->QrT->ECWordsPerBlock,
+    Ctx->QrT->group1BlockCount,
+    Ctx->QrT->group1Words,
+    Ctx->QrT->group2BlockCount,
+    Ctx->QrT->group2Words,
+    Ctx->QrT->requiredRemainder,
+    Ctx->QrT->maxNumeric,
+    Ctx->QrT->maxAlphanumeric,
+    Ctx->QrT->maxBytes,
+    Ctx->QrT->maxKanji
     ));
 
   return EFI_SUCCESS;
@@ -1275,51 +1543,52 @@ Step1_Process (
 static
 EFI_STATUS
 Step2_Process (
-  UINT8  *Data,
-  UINTN  DataLen
+  QR_ENCODER_CONTEXT  *Ctx,
+  UINT8               *Data,
+  UINTN               DataLen
   )
 {
   UINTN  lengthBits = 0;
 
-  if (gQrVersion <= gLengthBits[0][0]) {
-    lengthBits = gLengthBits[0][gQrMode];
-  } else if (gQrVersion <= gLengthBits[1][0]) {
-    lengthBits = gLengthBits[1][gQrMode];
+  if (Ctx->Version <= gLengthBits[0][0]) {
+    lengthBits = gLengthBits[0][Ctx->Mode];
+  } else if (Ctx->Version <= gLengthBits[1][0]) {
+    lengthBits = gLengthBits[1][Ctx->Mode];
   } else {
-    lengthBits = gLengthBits[2][gQrMode];
+    lengthBits = gLengthBits[2][Ctx->Mode];
   }
 
-  InitCodeWords (gQrT->totalWords);
+  InitCodeWords (Ctx, Ctx->QrT->totalWords);
 
-  switch (gQrMode) {
+  switch (Ctx->Mode) {
     case QrNumericMode:
-      AddCodeWordBits (ISO_NUMERIC_CODE, 4);
-      AddCodeWordBits (DataLen, lengthBits);
-      EncodeNumeric (Data, DataLen);
+      AddCodeWordBits (Ctx, ISO_NUMERIC_CODE, 4);
+      AddCodeWordBits (Ctx, DataLen, lengthBits);
+      EncodeNumeric (Ctx, Data, DataLen);
       break;
 
     case QrAlphaNumericMode:
-      AddCodeWordBits (ISO_ALPHANUMERIC_CODE, 4);
-      AddCodeWordBits (DataLen, lengthBits);
-      EncodeAlphanumeric (Data, DataLen);
+      AddCodeWordBits (Ctx, ISO_ALPHANUMERIC_CODE, 4);
+      AddCodeWordBits (Ctx, DataLen, lengthBits);
+      EncodeAlphanumeric (Ctx, Data, DataLen);
       break;
 
     case QrByteMode:
-      AddCodeWordBits (ISO_BYTE_CODE, 4);
-      AddCodeWordBits (DataLen, lengthBits);
-      EncodeBytes (Data, DataLen);
+      AddCodeWordBits (Ctx, ISO_BYTE_CODE, 4);
+      AddCodeWordBits (Ctx, DataLen, lengthBits);
+      EncodeBytes (Ctx, Data, DataLen);
       break;
 
     default:
-      DEBUG ((DEBUG_ERROR, "Unsupported mode %d\n", gQrMode));
+      DEBUG ((DEBUG_ERROR, "Unsupported mode %d\n", Ctx->Mode));
       ASSERT (FALSE);
       break;
   }
 
   DEBUG ((DEBUG_INFO, "Adding terminator bits. They are allowed not to fit, so ignore AddWords error on this call\n"));
 
-  AddCodeWordBits (0, 4);    // Terminating 0000's as required - if they fit
-  AddCodeWordPadBytes ();
+  AddCodeWordBits (Ctx, 0, 4);    // Terminating 0000's as required - if they fit
+  AddCodeWordPadBytes (Ctx);
 
   return EFI_SUCCESS;
 }
@@ -1333,43 +1602,45 @@ Step2_Process (
 static
 EFI_STATUS
 Step3_Process (
-  VOID
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  UINTN   i;
-  UINTN   ECWordIndex;
-  UINTN   CodeWordIndex;
-  UINTN   ECWords;
-  UINT16  ECWordsPerBlock;
-  UINTN   Blocks;
-
-  Blocks          = gQrT->group1BlockCount + gQrT->group2BlockCount;
-  ECWordsPerBlock = gQrT->ECWordsPerBlock;
+  UINTN               i;
+  UINTN               ECWordIndex;
+  UINTN               CodeWordIndex;
+  UINTN               ECWords;
+  UINT16              ECWordsPerBlock;
+  UINTN               Blocks;
+  CONST QrTableEntry  *QrT;
+
+  QrT             = Ctx->QrT;
+  Blocks          = QrT->group1BlockCount + QrT->group2BlockCount;
+  ECWordsPerBlock = QrT->ECWordsPerBlock;
   ECWords         = ECWordsPerBlock * Blocks;
   CodeWordIndex   = 0;
   ECWordIndex     = 0;
 
-  gECWords     = AllocatePool (ECWords);
-  gECWordCount = ECWords;
-  ASSERT (NULL != gECWords);
-  if (NULL == gECWords) {
-    return EFI_OUT_OF_RESOURCES;
+  Ctx->ECWordCount = ECWords;
+  if (Ctx->CodeWordCount + ECWords > QR_MAX_CODE_WORDS) {
+    DEBUG ((DEBUG_ERROR, "%a Internal error - %d code words do not fit\n", __FUNCTION__, Ctx->CodeWordCount + ECWords));
+    ASSERT (FALSE);
+    return EFI_BAD_BUFFER_SIZE;
   }
 
   //
   // Compute EC Words for every block
   //
-  for (i = 0; i < gQrT->group1BlockCount; i++) {
+  for (i = 0; i < QrT->group1BlockCount; i++) {
     // Process Group 1 blocks
-    PolynomialDivision (gQrT->group1Words, &gCodeWords[CodeWordIndex], ECWordsPerBlock, &gECWords[ECWordIndex]);
-    CodeWordIndex += gQrT->group1Words;
+    PolynomialDivision (Ctx, QrT->group1Words, &Ctx->CodeWords[CodeWordIndex], ECWordsPerBlock, &Ctx->ECWords[ECWordIndex]);
+    CodeWordIndex += QrT->group1Words;
     ECWordIndex   += ECWordsPerBlock;
   }
 
-  for (i = 0; i < gQrT->group2BlockCount; i++) {
+  for (i = 0; i < QrT->group2BlockCount; i++) {
     // Process Group 2 blocks
-    PolynomialDivision (gQrT->group2Words, &gCodeWords[CodeWordIndex], ECWordsPerBlock, &gECWords[ECWordIndex]);
-    CodeWordIndex += gQrT->group2Words;
+    PolynomialDivision (Ctx, QrT->group2Words, &Ctx->CodeWords[CodeWordIndex], ECWordsPerBlock, &Ctx->ECWords[ECWordIndex]);
+    CodeWordIndex += QrT->group2Words;
     ECWordIndex   += ECWordsPerBlock;
   }
 
@@ -1408,20 +1679,20 @@ Step3_Process (
 
   */
 
-  if ((gQrVersion == 1) &&                        // Specific data to match we site samples
-      (gQrMode    == QrAlphaNumericMode) &&       // of masking.  The underlying data at that
-      (gQrLevel   == QrECLevel_Q) &&              // site is invalid (IMHO) due to incorrect padding
-      (gFlags & QR_FLAGS_DEBUG_MASKING))
+  if ((Ctx->Version == 1) &&                      // Specific data to match we site samples
+      (Ctx->Mode    == QrAlphaNumericMode) &&     // of masking.  The underlying data at that
+      (Ctx->Level   == QrECLevel_Q) &&            // site is invalid (IMHO) due to incorrect padding
+      (Ctx->Flags & QR_FLAGS_DEBUG_MASKING))
   {
-    gCodeWords[12] = 0;                           // Codeword is incorrect on Web page
+    Ctx->CodeWords[12] = 0;                       // Codeword is incorrect on Web page
     DEBUG ((DEBUG_INFO, "CodeWord[12] set to 0 to match web page masking sample\n"));
   }
 
-  if (gFlags & QR_FLAGS_DEBUG_CODE_WORDS) {
+  if (Ctx->Flags & QR_FLAGS_DEBUG_CODE_WORDS) {
     DEBUG ((DEBUG_INFO, "ECWords=%d, ECWordIndex=%d\n", ECWords, ECWordIndex));
     for (i = 0; i < ECWords; i++) {
-      DEBUG ((DEBUG_INFO, " EC Word %4d is %4d - ", i, gECWords[i]));
-      PrintBinary (gECWords[i], 8, '0');
+      DEBUG ((DEBUG_INFO, " EC Word %4d is %4d - ", i, Ctx->ECWords[i]));
+      PrintBinary (Ctx->ECWords[i], 8, '0');
       DEBUG ((DEBUG_INFO, "\n"));
     }
   }
@@ -1437,55 +1708,56 @@ Step3_Process (
 static
 EFI_STATUS
 Step4_Process (
-  VOID
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  UINTN  StreamWordIndex;
-  UINTN  i;
-  UINTN  Indx;
-  UINTN  MaxIndx;
-  UINTN  Blocks;
-  UINTN  G2Base;
+  UINTN               StreamWordIndex;
+  UINTN               i;
+  UINTN               Indx;
+  UINTN               MaxIndx;
+  UINTN               Blocks;
+  UINTN               G2Base;
+  CONST QrTableEntry  *QrT;
 
-  gBitStreamCount = gCodeWordCount + gECWordCount;
-  gBitStream      = AllocatePool (gBitStreamCount);
-  StreamWordIndex = 0;
+  QrT                 = Ctx->QrT;
+  Ctx->BitStreamCount = Ctx->CodeWordCount + Ctx->ECWordCount;
+  StreamWordIndex     = 0;
 
-  Blocks = gQrT->group1BlockCount + gQrT->group2BlockCount;
+  Blocks = QrT->group1BlockCount + QrT->group2BlockCount;
 
-  MaxIndx = gQrT->group1Words;
-  if (MaxIndx < gQrT->group2Words) {
-    MaxIndx = gQrT->group2Words;
+  MaxIndx = QrT->group1Words;
+  if (MaxIndx < QrT->group2Words) {
+    MaxIndx = QrT->group2Words;
   }
 
-  G2Base =  gQrT->group1BlockCount * gQrT->group1Words;
+  G2Base =  QrT->group1BlockCount * QrT->group1Words;
   //
   //  Interleave the bitstream followed by interleaved EC words
   //
   for (Indx = 0; Indx < MaxIndx; Indx++) {
     for (i = 0; i < Blocks; i++) {
-      if (i < gQrT->group1BlockCount) {
-        if (Indx < gQrT->group1Words) {
-          gBitStream[StreamWordIndex++] = gCodeWords[(i * gQrT->group1Words) + Indx];
+      if (i < QrT->group1BlockCount) {
+        if (Indx < QrT->group1Words) {
+          Ctx->BitStream[StreamWordIndex++] = Ctx->CodeWords[(i * QrT->group1Words) + Indx];
         }
       } else {
-        if (Indx < gQrT->group2Words) {
-          gBitStream[StreamWordIndex++] = gCodeWords[G2Base + ((i - gQrT->group1BlockCount) * gQrT->group2Words) + Indx];
+        if (Indx < QrT->group2Words) {
+          Ctx->BitStream[StreamWordIndex++] = Ctx->CodeWords[G2Base + ((i - QrT->group1BlockCount) * QrT->group2Words) + Indx];
         }
       }
     }
   }
 
-  for (Indx = 0; Indx < gQrT->ECWordsPerBlock; Indx++) {
+  for (Indx = 0; Indx < QrT->ECWordsPerBlock; Indx++) {
     for (i = 0; i < Blocks; i++) {
-      gBitStream[StreamWordIndex++] = gECWords[(i * gQrT->ECWordsPerBlock) + Indx];
+      Ctx->BitStream[StreamWordIndex++] = Ctx->ECWords[(i * QrT->ECWordsPerBlock) + Indx];
     }
   }
 
-  if (gFlags & QR_FLAGS_DEBUG_BIT_STREAM) {
-    for (i = 0; i < gBitStreamCount; i++) {
-      DEBUG ((DEBUG_INFO, " BitStream %4d is %4d - ", i, gBitStream[i]));
-      PrintBinary (gBitStream[i], 8, '0');
+  if (Ctx->Flags & QR_FLAGS_DEBUG_BIT_STREAM) {
+    for (i = 0; i < Ctx->BitStreamCount; i++) {
+      DEBUG ((DEBUG_INFO, " BitStream %4d is %4d - ", i, Ctx->BitStream[i]));
+      PrintBinary (Ctx->BitStream[i], 8, '0');
       DEBUG ((DEBUG_INFO, "\n"));
     }
   }
@@ -1508,44 +1780,46 @@ Step4_Process (
 static
 EFI_STATUS
 Step5_Process (
-  VOID
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  INTN  i;
-  INTN  j;
+  INTN         i;
+  INTN         j;
+  CONST UINT8  *Locations;
 
   // All QR Codes get the same size finder in the upper left, upper right, and lower left cornet
   // along with a single black module next to the lower left Finder.
-  drawFinder (gQrBitmap, gQrSize, 0, 0);
-  drawFinder (gQrBitmap, gQrSize, gQrSize - 7, 0);
-  drawFinder (gQrBitmap, gQrSize, 0, gQrSize - 7);
+  drawFinder (Ctx, 0, 0);
+  drawFinder (Ctx, Ctx->Size - 7, 0);
+  drawFinder (Ctx, 0, Ctx->Size - 7);
 
-  gQrBitmap[((4 * gQrVersion) + 9)  * gQrSize + 8] = QrBlack_E;
+  setModule (Ctx, 8, (4 * Ctx->Version) + 9, QrBlack_E);
 
   // All QR Code > version 1 get alignment patterns
-  if (gQrVersion > 1) {
+  if (Ctx->Version > 1) {
+    Locations = gAlignmentLocations[Ctx->Version - 2];
     for (i = 0; i < QR_MAX_LOCATIONS; i++) {
-      if (gAlignmentLocations[gQrVersion-2][i] == 0) {
+      if (Locations[i] == 0) {
         break;
       }
 
       for (j = 0; j < QR_MAX_LOCATIONS; j++) {
-        if (gAlignmentLocations[gQrVersion-2][j] == 0) {
+        if (Locations[j] == 0) {
           break;
         }
 
-        drawAlignment (gQrBitmap, gQrSize, gAlignmentLocations[gQrVersion-2][i], gAlignmentLocations[gQrVersion-2][j]);
-        drawAlignment (gQrBitmap, gQrSize, gAlignmentLocations[gQrVersion-2][j], gAlignmentLocations[gQrVersion-2][i]);
+        drawAlignment (Ctx, Locations[i], Locations[j]);
+        drawAlignment (Ctx, Locations[j], Locations[i]);
       }
     }
   }
 
-  drawReserved (gQrBitmap, gQrSize);
+  drawReserved (Ctx);
 
-  drawVTiming (gQrBitmap, gQrSize, 6, 9, gQrSize - 7);
-  drawHTiming (gQrBitmap, gQrSize, 8, 7, gQrSize - 8);
+  drawVTiming (Ctx, 6, 9, Ctx->Size - 7);
+  drawHTiming (Ctx, 8, 7, Ctx->Size - 8);
 
-  drawBits (gQrBitmap, gQrSize);
+  drawBits (Ctx);
 
   return EFI_SUCCESS;
 }
@@ -1558,121 +1832,58 @@ Step5_Process (
 static
 EFI_STATUS
 Step6_Process (
-  VOID
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
-  UINT8    *TestBitmaps[QR_MASK_PATTERNS];
-  INTN     TestPenalty[QR_MASK_PATTERNS];
-  BOOLEAN  flip = FALSE;
-  UINT8    *Temp;
-  INTN     MinPenalty = MAX_INTN;
-  INTN     MinPenaltyIndex = QR_MASK_PATTERNS;
-  INTN     k, Row, Column;
-  UINT8    Cell;
-
-  // Get 8 copies of the bitmap to apply mask patterns to.
-  for (k = 0; k < QR_MASK_PATTERNS; k++) {
-    DEBUG ((DEBUG_INFO, "Processing pattern %d\n", k));
-    TestBitmaps[k] = AllocateCopyPool (gQrBitmapLen, gQrBitmap);
-
-    for (Row = 0; Row < gQrSize; Row++) {
-      // i is Row
-      for (Column = 0; Column < gQrSize; Column++) {
-        // j is Column
-        switch (k) {
-          case 0:                              /* Data Mask Reference 000 */
-            flip =  0 == ((Row + Column) % 2); // (i + j) mod 2 = 0
-            break;
-          case 1:                   /* Data Mask Reference 001 */
-            flip =  0 == (Row % 2); // i mod 2 = 0
-            break;
-          case 2:                      /* Data Mask Reference 010 */
-            flip =  0 == (Column % 3); // j mod 3 = 0
-            break;
-          case 3:                              /* Data Mask Reference 011 */
-            flip =  0 == ((Row + Column) % 3); // (i + j) mod 3 = 0
-            break;
-          case 4:                                        /* Data Mask Reference 100 */
-            flip =  0 == ((Row / 2) + (Column / 3)) % 2; // ((i div 2) + ( j div 3)) mod 2 = 0
-            break;
-          case 5:                                                     /* Data Mask Reference 101 */
-            flip =  0 == ((Row * Column) % 2) + ((Row * Column) % 3); // (i j) mod 2 + (i j) mod 3 = 0
-            break;
-          case 6:                                                           /* Data Mask Reference 110 */
-            flip =  0 == (((Row * Column) % 2) + ((Row * Column) % 3)) % 2; // ((i j) mod 2 + (i j) mod 3) mod 2 = 0
-            break;
-          case 7:                                                           /* Data Mask Reference 111 */
-            flip =  0 == (((Row + Column) % 2) + ((Row * Column) % 3)) % 2; // ((i+j) mod 2 + (i j) mod 3) mod 2 = 0
-            break;
-        }
+  INTN   Penalty[4];
+  INTN   TestPenalty;
+  INTN   MinPenalty      = MAX_INTN;
+  INTN   MinPenaltyIndex = QR_MASK_PATTERNS;
+  INTN   k;
+  INTN   y;
+  UINTN  w;
+  UINTN  C0;
+  UINTN  C1;
+
+  if (Ctx->Flags & QR_FLAGS_NO_MASK) {
+    DEBUG ((DEBUG_INFO, "Not using mask\n"));
+    return EFI_SUCCESS;
+  }
 
-        if (gFlags & QR_FLAGS_DEBUG_MASK_ONLY) {
-          // Draw the Masking patters from ISO Spec Fig 21
-          Cell = TestBitmaps[k][Row * gQrSize + Column];
-          if ( 0 != (Cell & QrExclude)) {
-            // If a module is "excluded", draw as gray
-            if (flip) {
-              Cell = QrGray;
-            } else {
-              Cell = QrWhite;
-            }
-          } else {
-            if (flip) {
-              Cell = QrBlack;
-            } else {
-              Cell = QrWhite;
-            }
-          }
+  BuildFlipRows (Ctx);
 
-          TestBitmaps[k][Row * gQrSize + Column] = Cell;
-        } else {
-          if (flip) {
-            Cell = TestBitmaps[k][Row * gQrSize + Column];
-            if ( 0 == (Cell & QrExclude)) {
-              // If a module is "excluded", don't flip the bit.
-              if (Cell == QrWhite) {
-                Cell = QrBlack;
-              } else {
-                Cell = QrWhite;
-              }
-
-              TestBitmaps[k][Row * gQrSize + Column] = Cell;
-            }
-          }
-        }
+  if (Ctx->Flags & QR_FLAGS_MASK_SEL) {
+    MinPenaltyIndex = Ctx->Flags & 0x07;
+  } else {
+    for (k = 0; k < QR_MASK_PATTERNS; k++) {
+      BuildEvaluationPlanes (Ctx, k);
+      Penalty[0]  = Evaluate1 (Ctx);
+      Penalty[1]  = Evaluate2 (Ctx);
+      Penalty[2]  = Evaluate3 (Ctx);
+      Penalty[3]  = Evaluate4 (Ctx);
+      TestPenalty = Penalty[0] + Penalty[1] + Penalty[2] + Penalty[3];
+      DEBUG ((DEBUG_INFO, "Pattern %d penalty is %d (%d, %d, %d, %d)\n", k, TestPenalty, Penalty[0], Penalty[1], Penalty[2], Penalty[3]));
+      if (MinPenalty > TestPenalty) {
+        MinPenalty      = TestPenalty;
+        MinPenaltyIndex = k;
       }
     }
 
-    TestPenalty[k]  = Evaluate1 (TestBitmaps[k], gQrSize);
-    TestPenalty[k] += Evaluate2 (TestBitmaps[k], gQrSize);
-    TestPenalty[k] += Evaluate3 (TestBitmaps[k], gQrSize);
-    TestPenalty[k] += Evaluate4 (TestBitmaps[k], gQrSize);
-    if (MinPenalty > TestPenalty[k]) {
-      MinPenalty      = TestPenalty[k];
-      MinPenaltyIndex = k;
-    }
+    DEBUG ((DEBUG_INFO, "Minimum penalty is %d from index %d\n", MinPenalty, MinPenaltyIndex));
+    ASSERT (MinPenaltyIndex < QR_MASK_PATTERNS);
   }
 
-  DEBUG ((DEBUG_INFO, "Minimum penalty is %d from index %d\n", MinPenalty, MinPenaltyIndex));
-  ASSERT (MinPenaltyIndex < QR_MASK_PATTERNS);
-  if (gFlags & QR_FLAGS_NO_MASK) {
-    DEBUG ((DEBUG_INFO, "Not using mask\n"));
-  } else {
-    if (gFlags & QR_FLAGS_MASK_SEL) {
-      MinPenaltyIndex = gFlags & 0x07;
+  // Apply the "best" mask to the symbol
+  for (y = 0; y < Ctx->Size; y++) {
+    for (w = 0; w < Ctx->RowWords; w++) {
+      MaskRowWord (Ctx, MinPenaltyIndex, y, w, &C0, &C1);
+      Ctx->Color0[y][w] = C0;
+      Ctx->Color1[y][w] = C1;
     }
-
-    // Swap the "best" masked bitmap with gQrBitmap, and free the 8 unused bitmaps.
-    Temp                         = TestBitmaps[MinPenaltyIndex];
-    TestBitmaps[MinPenaltyIndex] = gQrBitmap;
-    gQrBitmap                    = Temp;
-    gQrMask                      = MinPenaltyIndex;
-    DEBUG ((DEBUG_INFO, "Using mask %d\n", MinPenaltyIndex));
   }
 
-  for (k = 0; k < QR_MASK_PATTERNS; k++) {
-    FreePool (TestBitmaps[k]);
-  }
+  Ctx->Mask = MinPenaltyIndex;
+  DEBUG ((DEBUG_INFO, "Using mask %d\n", MinPenaltyIndex));
 
   return EFI_SUCCESS;
 }
@@ -1685,7 +1896,7 @@ Step6_Process (
 static
 EFI_STATUS
 Step7_Process (
-  VOID
+  QR_ENCODER_CONTEXT  *Ctx
   )
 {
   UINT16  FormatInfo;
@@ -1695,13 +1906,15 @@ Step7_Process (
   INTN    j;
   UINT16  Mask;
   UINT32  VMask;
+  INTN    Size;
 
-  FormatInfo = gFormatInfo[gQrLevel-1][gQrMask];
+  Size       = Ctx->Size;
+  FormatInfo = gFormatInfo[Ctx->Level-1][Ctx->Mask];
 
   DEBUG ((DEBUG_INFO, " FormatInfo %x - ", FormatInfo));
   PrintBinary (FormatInfo, 15, '0');
   DEBUG ((DEBUG_INFO, "\n"));
-  if (gFlags & QR_FLAGS_DEBUG_MASK_ONLY) {
+  if (Ctx->Flags & QR_FLAGS_DEBUG_MASK_ONLY) {
     // Don't draw Format or version info
     return EFI_SUCCESS;
   }
@@ -1714,9 +1927,9 @@ Step7_Process (
       t = 1;
     }
 
-    gQrBitmap[(i + t) * gQrSize + 8] = (Mask & FormatInfo) ? QrBlack : QrWhite;
-    gQrBitmap[9 * gQrSize - 1 - i]   = (Mask & FormatInfo) ? QrBlack : QrWhite;
-    Mask                           <<= 1;
+    setModule (Ctx, 8, i + t, (Mask & FormatInfo) ? QrBlack : QrWhite);
+    setModule (Ctx, Size - 1 - i, 8, (Mask & FormatInfo) ? QrBlack : QrWhite);
+    Mask <<= 1;
   }
 
   t = 1;
@@ -1726,13 +1939,13 @@ Step7_Process (
       t = 0;
     }
 
-    gQrBitmap[8 * gQrSize + 6 - i + t]         = (Mask & FormatInfo) ? QrBlack : QrWhite;
-    gQrBitmap[(gQrSize - 7 + i) * gQrSize + 8] = (Mask & FormatInfo) ? QrBlack : QrWhite;
-    Mask                                     <<= 1;
+    setModule (Ctx, 6 - i + t, 8, (Mask & FormatInfo) ? QrBlack : QrWhite);
+    setModule (Ctx, 8, Size - 7 + i, (Mask & FormatInfo) ? QrBlack : QrWhite);
+    Mask <<= 1;
   }
 
-  if (gQrVersion > 6) {
-    VersionInfo = gVersionInfo[gQrVersion-7];      // Table starts at version 7
+  if (Ctx->Version > 6) {
+    VersionInfo = gVersionInfo[Ctx->Version-7];    // Table starts at version 7
     VMask       = 0x00001;
     DEBUG ((DEBUG_INFO, " VersionInfo  %x - ", VersionInfo));
     PrintBinary (VersionInfo, 18, '0');
@@ -1743,10 +1956,10 @@ Step7_Process (
       for (i = 0; i < 3; i++) {
         // Enter data column by column
         // Lower Left block
-        gQrBitmap[(gQrSize - 11 + i) * gQrSize + j] = (VMask & VersionInfo) ? QrBlack : QrWhite;
+        setModule (Ctx, j, Size - 11 + i, (VMask & VersionInfo) ? QrBlack : QrWhite);
         // Upper Right block
-        gQrBitmap[(gQrSize * j) + gQrSize - 11 + i] = (VMask & VersionInfo) ? QrBlack : QrWhite;
-        VMask                                     <<= 1;
+        setModule (Ctx, Size - 11 + i, j, (VMask & VersionInfo) ? QrBlack : QrWhite);
+        VMask <<= 1;
       }
     }
   }
@@ -1756,115 +1969,66 @@ Step7_Process (
 
 /*--------------------------------------------------------------------------------*/
 /* Step 8. Build the Gop->Blt ready bitmap                                        */
-/*         Generate the format information and version information and complete   */
-/*         the symbol.                                                            */
+/*         Each module row is drawn into the first of its Factor pixel rows,      */
+/*         which is then copied to the other Factor - 1 pixel rows.               */
 /*--------------------------------------------------------------------------------*/
 static
 EFI_STATUS
 Step8_Process (
-  INTN  RegionSize
+  QR_ENCODER_CONTEXT             *Ctx,
+  INTN                           RegionSize,
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  **BltBuffer
   )
 {
   INTN                           Factor;
   UINTN                          QrOffset;
   UINTN                          BltBufferSize;
-  UINTN                          Offset;
-  INTN                           y, x, fy, fx;
-  INTN                           yy, xx;
+  UINTN                          LineSize;
+  INTN                           y, x, yy, xx;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Line;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Pixel;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Color;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  ColorRsvd   =  { 232, 162, 0, 255 };        // Visibly different error pixel
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  ColorWhite  =  { 255, 255, 255, 255 };
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  ColorBlack  =  { 0, 0, 0, 255 };
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  ColorGray   =  { 135, 135, 135, 255 };      // Visibly different missing pixel
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  ColorBad    =  { 0, 255, 0, 255 };          // Visibly different data corruption pixel
-  BOOLEAN                        OutOfBounds = FALSE;
-
-  Factor   = RegionSize / (gQrSize + 2 * QR_QUIET_ZONE);    // There must be 4 modules of white around bitmap from spec.
-  QrOffset = ((RegionSize - (Factor * gQrSize)) / Factor) / 2;
-  DEBUG ((DEBUG_INFO, "RegionSize data R=%d, Computed R%d\n", RegionSize, Factor * gQrSize));
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Colors[4] = {
+    { 135, 135, 135, 255 },                                                  // QrGray - Visibly different missing pixel
+    { 0,   0,   0,   255 },                                                  // QrBlack
+    { 255, 255, 255, 255 },                                                  // QrWhite
+    { 232, 162, 0,   255 }                                                   // QrRsvd - Visibly different error pixel
+  };
+
+  Factor   = RegionSize / (Ctx->Size + 2 * QR_QUIET_ZONE);    // There must be 4 modules of white around bitmap from spec.
+  QrOffset = ((RegionSize - (Factor * Ctx->Size)) / Factor) / 2;
+  DEBUG ((DEBUG_INFO, "RegionSize data R=%d, Computed R%d\n", RegionSize, Factor * Ctx->Size));
+  if ((INTN)((QrOffset + Ctx->Size) * Factor) > RegionSize) {
+    DEBUG ((DEBUG_ERROR, "Out of bounds for PIXEL Array. Factor=%d, QrOffset=%d, RegionSize=%d\n", Factor, QrOffset, RegionSize));
+    return EFI_NO_MEDIA;
+  }
+
   BltBufferSize = RegionSize * RegionSize;
-  gBltBuffer    = AllocatePool (BltBufferSize * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-  if (NULL == gBltBuffer) {
-    DEBUG ((DEBUG_ERROR, "Error allocating gBltBuffer\n"));
+  *BltBuffer    = AllocatePool (BltBufferSize * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  if (NULL == *BltBuffer) {
+    DEBUG ((DEBUG_ERROR, "Error allocating BltBuffer\n"));
     return EFI_OUT_OF_RESOURCES;
   }
 
-  SetMem32 (gBltBuffer, BltBufferSize * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL), (UINT32)0xffffffff);
-
-  for (y = 0; y < gQrSize; y++) {
-    for (x = 0; x < gQrSize; x++) {
-      switch (gQrBitmap[y * gQrSize + x]) {
-        case QrRsvd:
-        case QrRsvd_E:
-          Color =  ColorRsvd;
-          break;
-        case QrWhite:
-        case QrWhite_E:
-          Color =  ColorWhite;
-          break;
-        case QrBlack:
-        case QrBlack_E:
-          Color =  ColorBlack;
-          break;
-        case QrGray:
-        case QrGray_E:
-          Color =  ColorGray;
-          break;
-        default:
-          Color =  ColorBad;
-          break;
-      }
-
-      //
-      // The BltBuffer larger than the Bitmap buffer - Factor * each side.
-      fy = (y + QrOffset) * Factor;
-      fx = (x + QrOffset) * Factor;
-
-      //
-      //  copy Bitmap[x:y] to BltBuffer[fx:fy], but fill in BltBuffer with Factor * Factor pixels
-      //  for each single pixel in Bitmap.
-      //                                fxo = fx + QrOffset
-      //                                fyo = fy + QrOffset
-      // QrCode is centered within the Region provided, and entire region is
-      // set to white before the QrCode is written
-      for (yy = 0; (yy < Factor) && (!OutOfBounds); yy++) {
-        for (xx = 0; (xx < Factor) && (!OutOfBounds); xx++) {
-          Offset = ((fy + yy) * RegionSize) + fx + xx;
-          if (Offset >= BltBufferSize) {
-            DEBUG ((DEBUG_ERROR, "Out of bounds for PIXEL Array. y=%d, x=%d, fy=%d, fx=%d, yy=%d, xx=%d, Factor=%d, Of=%d, BltSize=%d,Reg=%d\n", y, x, fy, fx, yy, xx, Factor, Offset, BltBufferSize, RegionSize));
-            OutOfBounds = TRUE;
-          } else {
-            gBltBuffer[Offset] = Color;
-          }
-        }
-      }
-
-      if (OutOfBounds) {
-        return EFI_NO_MEDIA;
-      }
-
- #if 0
-      //
-      // The BltBuffer larger than the Bitmap buffer - Factor * each side.
-
-      fy = (y * Factor) * (BitmapLen * Factor);
-      fx = x * Factor;
-      //
-      //  copy Bitmap[x:y] to BltBuffer[fx:fy], but fill in BltBuffer with Factor * Factor pixels
-      //
-      for (yy = 0; yy < Factor; yy++) {
-        for (xx = 0; xx < Factor; xx++) {
-          Offset = fy + (yy * BitmapLen * Factor) + fx + xx;
-          if (Offset > BltBufferElements) {
-            DEBUG ((DEBUG_ERROR, "Out of bounds for PIXEL Array\n"));
-            ASSERT (FALSE);
-          }
-
-          BltBuffer[Offset] = Color;
-        }
+  //
+  // QrCode is centered within the Region provided, and entire region is
+  // set to white before the QrCode is written
+  //
+  SetMem32 (*BltBuffer, BltBufferSize * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL), (UINT32)0xffffffff);
+
+  LineSize = Ctx->Size * Factor * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  for (y = 0; y < Ctx->Size; y++) {
+    Line  = *BltBuffer + ((y + QrOffset) * Factor * RegionSize) + (QrOffset * Factor);
+    Pixel = Line;
+    for (x = 0; x < Ctx->Size; x++) {
+      Color = Colors[getModule (Ctx, x, y) & ~QrExclude];
+      for (xx = 0; xx < Factor; xx++) {
+        *Pixel++ = Color;
       }
+    }
 
- #endif
+    for (yy = 1; yy < Factor; yy++) {
+      CopyMem (Line + (yy * RegionSize), Line, LineSize);
     }
   }
 
@@ -1874,13 +2038,14 @@ Step8_Process (
 // *----------------------------------------------------------------------------*
 // *   QrInitialize                                                             *
 // *                                                                            *
-// *   Initializes the encoder for a fixed choice of QR code, QR                *
+// *   Initializes the encoder context for a fixed choice of QR code, QR        *
 // *   Correction level, and character encoding mode.                           *
 // *                                                                            *
 // *   QR Version and Encoding mode can be set to Auto, and will be determined  *
 // *   by the data.                                                             *
 // *                                                                            *
 // *   Input:                                                                   *
+// *       Ctx                  = Encoder context                               *
 // *       Version              = Version Requested (1-40, QrAutoVersion=Auto)  *
 // *       Level                = Error Correction Level                        *
 // *       Mode                 = Character Encoding mode                       *
@@ -1897,10 +2062,11 @@ Step8_Process (
 static
 EFI_STATUS
 QrInitialize (
-  IN UINT8       Version,
-  IN QRLEVEL     Level,
-  IN QRENCODING  Mode,
-  IN UINT32      Flags
+  IN QR_ENCODER_CONTEXT  *Ctx,
+  IN UINT8               Version,
+  IN QRLEVEL             Level,
+  IN QRENCODING          Mode,
+  IN UINT32              Flags
   )
 {
   if (Version > QrMaxVersion) {
@@ -1921,28 +2087,41 @@ QrInitialize (
     return EFI_INVALID_PARAMETER;
   }
 
-  InitializeLogTables ();
-
-  gQrVersion = Version;
-  gQrSize    = 0;
-  gQrLevel   = Level;
-  gQrMode    = Mode;
-  gQrMask    = 0;
-  gFlags     = Flags;
+  Ctx->Version = Version;
+  Ctx->Size    = 0;
+  Ctx->Level   = Level;
+  Ctx->Mode    = Mode;
+  Ctx->Mask    = 0;
+  Ctx->Flags   = Flags;
 
   return EFI_SUCCESS;
 }
 
 // *----------------------------------------------------------------------------*
-// *   QrEncodeData                                                             *
+// *   QrEncoderGetContextSize                                                  *
+// *                                                                            *
+// *   Returns the size of the encoder context QrEncodeDataEx needs.            *
+// *----------------------------------------------------------------------------*
+UINTN
+EFIAPI
+QrEncoderGetContextSize (
+  VOID
+  )
+{
+  return sizeof (QR_ENCODER_CONTEXT);
+}
+
+// *----------------------------------------------------------------------------*
+// *   QrEncodeDataEx                                                           *
 // *                                                                            *
-// *   Creates the QR Bitmap using the Version and Mode from the initialize     *
-// *   setp                                                                     *
+// *   Creates the QR Bitmap using a caller supplied encoder context.           *
 // *                                                                            *
 // *   QR Version and Encoding mode can be set to Auto, and will be determined  *
 // *   by the data.                                                             *
 // *                                                                            *
 // *   Input:                                                                   *
+// *      Context      QrEncoderGetContextSize () bytes of memory.  It does not *
+// *                   need to be initialized, and may be reused.               *
 // *      Version      Version Requested (1-40, QrAutoVersion=Auto)             *
 // *      Level        Error Correction Level                                   *
 // *      Mode         Character Encoding mode                                  *
@@ -1955,13 +2134,14 @@ QrInitialize (
 // *                                                                            *
 // *   Returns:                                                                 *
 // *      EFI_INVALID_PARAMETER = Version, Level, or Mode out of range          *
-// *                              Data == NULL, or Datalen == 0                 *
+// *                              Context == NULL, Data == NULL, or Datalen == 0*
 // *                              RegionSize too small                          *
-// *                              Bitmap == NULL, BitmapLen == NULL,            *
+// *                              Bitmap == NULL                                *
 // *----------------------------------------------------------------------------*
 EFI_STATUS
 EFIAPI
-QrEncodeData (
+QrEncodeDataEx (
+  IN  VOID                           *Context,                   // Encoder context
   IN  UINT8                          Version,                    // Version requested
   IN  QRLEVEL                        Level,                      // EC Correction level
   IN  QRENCODING                     Mode,                       // Alpha encoding??
@@ -1973,14 +2153,19 @@ QrEncodeData (
   )
 {
   // Place to store the created bitmap pointer
-  EFI_STATUS  Status;
+  EFI_STATUS                     Status;
+  QR_ENCODER_CONTEXT             *Ctx;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *BltBuffer;
 
-  if ((Data == NULL) || (DataLen == 0) || (Bitmap == NULL)) {
-    DEBUG ((DEBUG_ERROR, "%a - Data == NULL, DataLen == 0, or Bitmap == NULL\n", __FUNCTION__));
+  if ((Context == NULL) || (Data == NULL) || (DataLen == 0) || (Bitmap == NULL)) {
+    DEBUG ((DEBUG_ERROR, "%a - Context == NULL, Data == NULL, DataLen == 0, or Bitmap == NULL\n", __FUNCTION__));
     return EFI_INVALID_PARAMETER;
   }
 
-  Status = QrInitialize (Version, Level, Mode, Flags);
+  Ctx       = (QR_ENCODER_CONTEXT *)Context;
+  BltBuffer = NULL;
+
+  Status = QrInitialize (Ctx, Version, Level, Mode, Flags);
 
   if (EFI_ERROR (Status)) {
     return Status;
@@ -1990,7 +2175,7 @@ QrEncodeData (
   /* Step 1. Data Analysis                                                          */
   /*         Analyze input data to identify the characteristics of the data         */
   /*--------------------------------------------------------------------------------*/
-  Status = Step1_Process (Data, DataLen, RegionSize);
+  Status = Step1_Process (Ctx, Data, DataLen, RegionSize);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Step 1 Process error.  Code=%r\n", Status));
     goto error_exit;
@@ -2002,7 +2187,7 @@ QrEncodeData (
   /*         Convert the characters to a bit stream in accordance with the QR Code, */
   /*         the encoding mode, and the EC lavel.                                   */
   /*--------------------------------------------------------------------------------*/
-  Status = Step2_Process (Data, DataLen);
+  Status = Step2_Process (Ctx, Data, DataLen);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Step 2 Process error.  Code=%r\n", Status));
     goto error_exit;
@@ -2016,7 +2201,7 @@ QrEncodeData (
   /*         the error correction codewords for each block.                         */
   /*         the encoding mode, and the EC lavel.                                   */
   /*--------------------------------------------------------------------------------*/
-  Status = Step3_Process ();
+  Status = Step3_Process (Ctx);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Step 3 Process error.  Code=%r\n", Status));
     goto error_exit;
@@ -2029,7 +2214,7 @@ QrEncodeData (
   /*         Interleave the data and codewords from each block and add remainder    */
   /*         bits if necessary                                                      */
   /*--------------------------------------------------------------------------------*/
-  Status = Step4_Process ();
+  Status = Step4_Process (Ctx);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Step 4 Process error.  Code=%r\n", Status));
     goto error_exit;
@@ -2046,7 +2231,7 @@ QrEncodeData (
   /*         Place the alignment patterns (if required)                             */
   /*         Place the codewords into the Matrix                                    */
   /*--------------------------------------------------------------------------------*/
-  Status = Step5_Process ();
+  Status = Step5_Process (Ctx);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Step 5 Process error.  Code=%r\n", Status));
     goto error_exit;
@@ -2059,7 +2244,7 @@ QrEncodeData (
   /*         Apply the 8 data masking patterns and evaluate each pattern for quality*/
   /*         Choose the pattern with the best quality                               */
   /*--------------------------------------------------------------------------------*/
-  Status = Step6_Process ();
+  Status = Step6_Process (Ctx);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Step 6 Process error.  Code=%r\n", Status));
     goto error_exit;
@@ -2072,7 +2257,7 @@ QrEncodeData (
   /*         Generate the format information and version information and complete   */
   /*         the symbol.                                                            */
   /*--------------------------------------------------------------------------------*/
-  Status = Step7_Process ();
+  Status = Step7_Process (Ctx);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Step 7 Process error.  Code=%r\n", Status));
     goto error_exit;
@@ -2083,7 +2268,7 @@ QrEncodeData (
   /*--------------------------------------------------------------------------------*/
   /* Step 8. Build the Gop->Blt ready bitmap                                        */
   /*--------------------------------------------------------------------------------*/
-  Status = Step8_Process (RegionSize);
+  Status = Step8_Process (Ctx, RegionSize, &BltBuffer);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Step 8 Process error.  Code=%r\n", Status));
     goto error_exit;
@@ -2095,38 +2280,57 @@ error_exit:
 
   // Free all the memory allocated - EXCEPT the returned bitmap
 
-  if (NULL != gCodeWords ) {
-    FreePool (gCodeWords);
-    gCodeWords = NULL;
+  if (EFI_ERROR (Status)) {
+    *Bitmap = NULL;
+    if (NULL != BltBuffer) {
+      FreePool (BltBuffer);
+    }
+  } else {
+    *Bitmap = BltBuffer;
   }
 
-  if (NULL != gECWords ) {
-    FreePool (gECWords);
-    gECWords = NULL;
-  }
+  DEBUG ((DEBUG_INFO, "QrEncode complete. Code = %r\n", Status));
 
-  if (NULL != gBitStream ) {
-    FreePool (gBitStream);
-    gBitStream = NULL;
-  }
+  return Status;
+}
+
+// *----------------------------------------------------------------------------*
+// *   QrEncodeData                                                             *
+// *                                                                            *
+// *   Creates the QR Bitmap using an encoder context allocated for this call.  *
+// *   See QrEncodeDataEx.                                                      *
+// *----------------------------------------------------------------------------*
+EFI_STATUS
+EFIAPI
+QrEncodeData (
+  IN  UINT8                          Version,                    // Version requested
+  IN  QRLEVEL                        Level,                      // EC Correction level
+  IN  QRENCODING                     Mode,                       // Alpha encoding??
+  IN  UINT32                         Flags,                      // Debug fla
+  IN  UINT8                          *Data,                      // Input Ascii Character data (BINARY IS NOT SUPPORTED)
+  IN  UINT16                         DataLen,                    // Length of the data
+  IN  INTN                           RegionSize,                 // Width and height of the square display area
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  **Bitmap
+  )
+{
+  // Place to store the created bitmap pointer
+  EFI_STATUS  Status;
+  VOID        *Context;
 
-  if (gQrBitmap != NULL) {
-    FreePool (gQrBitmap);
-    gQrBitmap = NULL;
+  if ((Data == NULL) || (DataLen == 0) || (Bitmap == NULL)) {
+    DEBUG ((DEBUG_ERROR, "%a - Data == NULL, DataLen == 0, or Bitmap == NULL\n", __FUNCTION__));
+    return EFI_INVALID_PARAMETER;
   }
 
-  if (EFI_ERROR (Status)) {
+  Context = AllocatePool (QrEncoderGetContextSize ());
+  if (Context == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a - Unable to allocate the encoder context\n", __FUNCTION__));
     *Bitmap = NULL;
-    if (NULL != gBltBuffer) {
-      FreePool (gBltBuffer);
-      gBltBuffer = NULL;
-    }
-  } else {
-    *Bitmap    = gBltBuffer;
-    gBltBuffer = NULL;
+    return EFI_OUT_OF_RESOURCES;
   }
 
-  DEBUG ((DEBUG_INFO, "QrEncode complete. Code = %r\n", Status));
+  Status = QrEncodeDataEx (Context, Version, Level, Mode, Flags, Data, DataLen, RegionSize, Bitmap);
 
+  FreePool (Context);
   return Status;
 }
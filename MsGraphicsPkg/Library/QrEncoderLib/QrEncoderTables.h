@@ -57,13 +57,10 @@ extern CONST UINT8  gAlignmentLocations[QR_CODES - 1][QR_MAX_LOCATIONS]; // ISO
 extern CONST UINT8  *gGeneratorPolynomials[QR_MAX_GEN_POLYS]; // ISO 18004:2015 Table A.1 - ISO has a sparse list up to 68.
                                                               // However, only those code up to 30 are used
 // Galios Field GF(256) log tables
-#define GF256_SIZE  256
-extern UINT8  logTable[GF256_SIZE];
-extern UINT8  alogTable[GF256_SIZE];
+#define GF256_SIZE      256
+#define GF256_EXP_SIZE  (2 * GF256_SIZE)
 
-VOID
-InitializeLogTables (
-  VOID
-  );                               // Initialize Galois field Log Tables
+extern CONST UINT8  gGfLog[GF256_SIZE];     // Log base alpha of a field element
+extern CONST UINT8  gGfExp[GF256_EXP_SIZE]; // Alpha to the power of the index, doubled to avoid the modulo 255
 
 #endif
@@ -0,0 +1,515 @@
+/** @file
+  Host based unit test and benchmark for QrEncoderLib.
+
+  Every symbol is compared pixel for pixel with the output of the frozen byte
+  per module pipeline in QrEncoderReference.c, for every version, error
+  correction level and encoding mode, and for each of the debug mask flags.
+  The benchmark encodes full symbols with both and logs the time of each.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+
+#include <Protocol/GraphicsOutput.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/QrEncoderLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "../QrEncoderTables.h"
+#include "QrEncoderReference.h"
+
+#define UNIT_TEST_NAME     "QrEncoderLib Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define MAX_TEST_DATA         7089   // Numeric capacity of a version 40-L symbol
+#define BENCHMARK_ITERATIONS  10
+
+STATIC UINT8   mData[MAX_TEST_DATA];
+STATIC VOID    *mContext = NULL;
+STATIC UINT32  mSeed     = 1;
+
+/**
+  Return the next byte of a fixed pseudo random sequence.
+
+  @return The next byte.
+**/
+STATIC
+UINT8
+NextRandomByte (
+  VOID
+  )
+{
+  mSeed = mSeed * 1103515245 + 12345;
+  return (UINT8)(mSeed >> 16);
+}
+
+/**
+  Fill mData with characters valid for Mode.
+
+  @param[in]  Mode     Encoding mode of the data.
+  @param[in]  DataLen  Number of characters.
+**/
+STATIC
+VOID
+BuildData (
+  IN QRENCODING  Mode,
+  IN UINTN       DataLen
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < DataLen; Index++) {
+    switch (Mode) {
+      case QrNumericMode:
+        mData[Index] = '0' + (NextRandomByte () % 10);
+        break;
+      case QrAlphaNumericMode:
+        mData[Index] = gAlphaNumerics[NextRandomByte () % QR_ALPHA_TABLE_SIZE];
+        break;
+      default:
+        mData[Index] = NextRandomByte ();
+        break;
+    }
+  }
+}
+
+/**
+  Return the capacity of a symbol in characters of Mode.
+
+  @param[in]  Version  Symbol version.
+  @param[in]  Level    Error correction level.
+  @param[in]  Mode     Encoding mode.
+
+  @return The maximum number of characters.
+**/
+STATIC
+UINT16
+Capacity (
+  IN UINT8       Version,
+  IN QRLEVEL     Level,
+  IN QRENCODING  Mode
+  )
+{
+  CONST QrTableEntry  *QrT;
+
+  QrT = &gQrTable[(Version - 1) * QR_EC_LEVELS + Level - 1];
+  switch (Mode) {
+    case QrNumericMode:
+      return QrT->maxNumeric;
+    case QrAlphaNumericMode:
+      return QrT->maxAlphanumeric;
+    default:
+      return QrT->maxBytes;
+  }
+}
+
+/**
+  Encode mData with the library and the reference pipeline and compare the results.
+
+  @param[in]  Version     Version requested.
+  @param[in]  Level       Error correction level.
+  @param[in]  Mode        Encoding mode.
+  @param[in]  Flags       QR_FLAGS_xxx.
+  @param[in]  DataLen     Number of characters of mData to encode.
+  @param[in]  RegionSize  Width and height of the bitmap.
+
+  @retval UNIT_TEST_PASSED    Both returned the same status and the same bitmap.
+  @retval Others              An assertion failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+CompareWithReference (
+  IN UINT8       Version,
+  IN QRLEVEL     Level,
+  IN QRENCODING  Mode,
+  IN UINT32      Flags,
+  IN UINT16      DataLen,
+  IN INTN        RegionSize
+  )
+{
+  EFI_STATUS                     ExpectedStatus;
+  EFI_STATUS                     Status;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Expected;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Bitmap;
+
+  Expected = NULL;
+  Bitmap   = NULL;
+
+  ExpectedStatus = QrEncodeDataReference (Version, Level, Mode, Flags, mData, DataLen, RegionSize, &Expected);
+  Status         = QrEncodeDataEx (mContext, Version, Level, Mode, Flags, mData, DataLen, RegionSize, &Bitmap);
+  if ((Status != ExpectedStatus) ||
+      (!EFI_ERROR (Status) && (CompareMem (Bitmap, Expected, RegionSize * RegionSize * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)) != 0)))
+  {
+    UT_LOG_ERROR ("Version %d Level %d Mode %d Flags %x DataLen %d: %r, expected %r\n", Version, Level, Mode, Flags, DataLen, Status, ExpectedStatus);
+  }
+
+  UT_ASSERT_STATUS_EQUAL (Status, ExpectedStatus);
+  if (!EFI_ERROR (Status)) {
+    UT_ASSERT_NOT_NULL (Bitmap);
+    UT_ASSERT_MEM_EQUAL (Bitmap, Expected, RegionSize * RegionSize * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    FreePool (Bitmap);
+    FreePool (Expected);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Every version, level and mode, filled to capacity and partly filled, should
+  produce the same bitmap as the reference pipeline.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8       Version;
+  QRLEVEL     Level;
+  QRENCODING  Mode;
+  UINT16      Lengths[3];
+  UINTN       Index;
+  INTN        Size;
+
+  for (Version = QrMinVersion; Version <= QrMaxVersion; Version++) {
+    Size = Version * 4 + 17;
+    for (Level = QrECLevel_L; Level <= QrECLevel_H; Level++) {
+      for (Mode = QrNumericMode; Mode <= QrByteMode; Mode++) {
+        Lengths[0] = 1;
+        Lengths[1] = Capacity (Version, Level, Mode) / 2 + 1;
+        Lengths[2] = Capacity (Version, Level, Mode);
+        for (Index = 0; Index < ARRAY_SIZE (Lengths); Index++) {
+          BuildData (Mode, Lengths[Index]);
+          UT_ASSERT_EQUAL (
+            CompareWithReference (Version, Level, Mode, 0, Lengths[Index], (Size + 2 * QR_QUIET_ZONE) * (1 + Index) + Version % 5),
+            UNIT_TEST_PASSED
+            );
+        }
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Automatic version and mode selection, forced masks, no mask and the mask
+  debug flags should produce the same bitmap as the reference pipeline.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestFlagsMatchReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINT8   Versions[] = { 1, 7, 21, 40 };
+  STATIC CONST UINT32  Flags[]    = {
+    QR_FLAGS_NO_MASK,
+    QR_FLAGS_MASK_0,
+    QR_FLAGS_MASK_1,
+    QR_FLAGS_MASK_2,
+    QR_FLAGS_MASK_3,
+    QR_FLAGS_MASK_4,
+    QR_FLAGS_MASK_5,
+    QR_FLAGS_MASK_6,
+    QR_FLAGS_MASK_7,
+    QR_FLAGS_DEBUG_MASKING,
+    QR_FLAGS_DEBUG_MASK_ONLY,
+    QR_FLAGS_DEBUG_MASK_ONLY | QR_FLAGS_MASK_5
+  };
+  UINTN                VersionIndex;
+  UINTN                FlagIndex;
+  UINT16               DataLen;
+
+  //
+  // "HELLO WORLD" at 1-Q is the sample QR_FLAGS_DEBUG_MASKING exists for
+  //
+  CopyMem (mData, "HELLO WORLD", 11);
+  for (FlagIndex = 0; FlagIndex < ARRAY_SIZE (Flags); FlagIndex++) {
+    UT_ASSERT_EQUAL (CompareWithReference (QrAutoVersion, QrECLevel_Q, QrAutoMode, Flags[FlagIndex], 11, 100), UNIT_TEST_PASSED);
+  }
+
+  for (VersionIndex = 0; VersionIndex < ARRAY_SIZE (Versions); VersionIndex++) {
+    DataLen = Capacity (Versions[VersionIndex], QrECLevel_M, QrByteMode);
+    BuildData (QrByteMode, DataLen);
+    UT_ASSERT_EQUAL (CompareWithReference (QrAutoVersion, QrECLevel_M, QrAutoMode, 0, DataLen, 400), UNIT_TEST_PASSED);
+    for (FlagIndex = 0; FlagIndex < ARRAY_SIZE (Flags); FlagIndex++) {
+      UT_ASSERT_EQUAL (CompareWithReference (Versions[VersionIndex], QrECLevel_M, QrByteMode, Flags[FlagIndex], DataLen, 400), UNIT_TEST_PASSED);
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Invalid parameters and data that does not fit the requested symbol should be
+  rejected without returning a bitmap.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestInvalidParameters (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Bitmap;
+
+  CopyMem (mData, "HELLO WORLD", 11);
+
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (NULL, QrAutoVersion, QrECLevel_Q, QrAutoMode, 0, mData, 11, 100, &Bitmap), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, QrAutoVersion, QrECLevel_Q, QrAutoMode, 0, NULL, 11, 100, &Bitmap), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, QrAutoVersion, QrECLevel_Q, QrAutoMode, 0, mData, 0, 100, &Bitmap), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, QrAutoVersion, QrECLevel_Q, QrAutoMode, 0, mData, 11, 100, NULL), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (QrEncodeData (QrAutoVersion, QrECLevel_Q, QrAutoMode, 0, NULL, 11, 100, &Bitmap), EFI_INVALID_PARAMETER);
+
+  //
+  // Out of range version, level and mode
+  //
+  Bitmap = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)mData;
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, QrMaxVersion + 1, QrECLevel_Q, QrAutoMode, 0, mData, 11, 100, &Bitmap), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, QrAutoVersion, 0, QrAutoMode, 0, mData, 11, 100, &Bitmap), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, QrAutoVersion, QrECLevel_Q, QrECIMode, 0, mData, 11, 100, &Bitmap), EFI_INVALID_PARAMETER);
+
+  //
+  // Data too large for the version or mode, and region too small for the symbol
+  //
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, 1, QrECLevel_H, QrAutoMode, 0, mData, 11, 100, &Bitmap), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, QrAutoVersion, QrECLevel_Q, QrNumericMode, 0, mData, 11, 100, &Bitmap), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (QrEncodeDataEx (mContext, QrAutoVersion, QrECLevel_Q, QrAutoMode, 0, mData, 11, 28, &Bitmap), EFI_INVALID_PARAMETER);
+  UT_ASSERT_TRUE (Bitmap == NULL);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A context should give the same result when reused after other symbols, and
+  QrEncodeData should give the same result as QrEncodeDataEx.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestContextReuse (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *First;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Bitmap;
+  INTN                           RegionSize;
+
+  RegionSize = 100;
+  CopyMem (mData, "HTTPS://AKA.MS/", 15);
+
+  UT_ASSERT_NOT_EFI_ERROR (QrEncodeDataEx (mContext, QrAutoVersion, QrECLevel_M, QrAutoMode, 0, mData, 15, RegionSize, &First));
+
+  //
+  // Leave the context holding a version 40 symbol with a different mask
+  //
+  BuildData (QrByteMode, Capacity (40, QrECLevel_L, QrByteMode));
+  UT_ASSERT_NOT_EFI_ERROR (QrEncodeDataEx (mContext, 40, QrECLevel_L, QrByteMode, QR_FLAGS_MASK_7, mData, Capacity (40, QrECLevel_L, QrByteMode), 200, &Bitmap));
+  FreePool (Bitmap);
+
+  CopyMem (mData, "HTTPS://AKA.MS/", 15);
+  UT_ASSERT_NOT_EFI_ERROR (QrEncodeDataEx (mContext, QrAutoVersion, QrECLevel_M, QrAutoMode, 0, mData, 15, RegionSize, &Bitmap));
+  UT_ASSERT_MEM_EQUAL (Bitmap, First, RegionSize * RegionSize * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  FreePool (Bitmap);
+
+  UT_ASSERT_NOT_EFI_ERROR (QrEncodeData (QrAutoVersion, QrECLevel_M, QrAutoMode, 0, mData, 15, RegionSize, &Bitmap));
+  UT_ASSERT_MEM_EQUAL (Bitmap, First, RegionSize * RegionSize * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  FreePool (Bitmap);
+
+  FreePool (First);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Encode mData repeatedly and return the average time per call.
+
+  @param[in]  Reference  TRUE to time the reference pipeline, FALSE for the library.
+  @param[in]  Version    Symbol version.
+  @param[in]  DataLen    Number of bytes of mData to encode.
+
+  @return The average time per call in microseconds, or MAX_UINTN if encoding failed.
+**/
+STATIC
+UINTN
+TimeEncode (
+  IN BOOLEAN  Reference,
+  IN UINT8    Version,
+  IN UINT16   DataLen
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Bitmap;
+  INTN                           RegionSize;
+  clock_t                        Start;
+  UINTN                          Iteration;
+
+  RegionSize = (Version * 4 + 17 + 2 * QR_QUIET_ZONE) * 2;
+  Start      = clock ();
+  for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+    if (Reference) {
+      Status = QrEncodeDataReference (Version, QrECLevel_M, QrByteMode, 0, mData, DataLen, RegionSize, &Bitmap);
+    } else {
+      Status = QrEncodeDataEx (mContext, Version, QrECLevel_M, QrByteMode, 0, mData, DataLen, RegionSize, &Bitmap);
+    }
+
+    if (EFI_ERROR (Status)) {
+      return MAX_UINTN;
+    }
+
+    FreePool (Bitmap);
+  }
+
+  return (UINTN)((UINT64)(clock () - Start) * 1000000 / CLOCKS_PER_SEC / BENCHMARK_ITERATIONS);
+}
+
+/**
+  Encode full symbols of several versions with the reference pipeline and the
+  library and log the time of each.
+
+  @param[in]  Context    Unused.
+
+  @retval UNIT_TEST_PASSED    The test passed.
+  @retval Others              An assertion failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINT8  Versions[] = { 10, 25, 40 };
+  UINTN               Index;
+  UINT16              DataLen;
+  UINTN               ReferenceMicro;
+  UINTN               Micro;
+
+  for (Index = 0; Index < ARRAY_SIZE (Versions); Index++) {
+    DataLen = Capacity (Versions[Index], QrECLevel_M, QrByteMode);
+    BuildData (QrByteMode, DataLen);
+
+    ReferenceMicro = TimeEncode (TRUE, Versions[Index], DataLen);
+    UT_ASSERT_NOT_EQUAL (ReferenceMicro, MAX_UINTN);
+    Micro = TimeEncode (FALSE, Versions[Index], DataLen);
+    UT_ASSERT_NOT_EQUAL (Micro, MAX_UINTN);
+    DEBUG ((DEBUG_INFO, "%a: Version %d-M %d bytes, reference %d us, QrEncoderLib %d us\n", __FUNCTION__, Versions[Index], DataLen, ReferenceMicro, Micro));
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for QrEncoderLib
+  and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      EncoderSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  mContext = AllocatePool (QrEncoderGetContextSize ());
+  if (mContext == NULL) {
+    DEBUG ((DEBUG_ERROR, "Failed to allocate the encoder context\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the QrEncoder Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&EncoderSuite, Framework, "QrEncoder", "MsGraphics.QrEncoderLib", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for EncoderSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (EncoderSuite, "Every version, level and mode should match the reference encoder", "MatchesReference", UnitTestMatchesReference, NULL, NULL, NULL);
+  AddTestCase (EncoderSuite, "Mask and debug flags should match the reference encoder", "FlagsMatchReference", UnitTestFlagsMatchReference, NULL, NULL, NULL);
+  AddTestCase (EncoderSuite, "Invalid parameters should be rejected", "InvalidParameters", UnitTestInvalidParameters, NULL, NULL, NULL);
+  AddTestCase (EncoderSuite, "A reused context should give the same result", "ContextReuse", UnitTestContextReuse, NULL, NULL, NULL);
+  AddTestCase (EncoderSuite, "Benchmark the reference encoder and QrEncoderLib", "Benchmark", UnitTestBenchmark, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (mContext != NULL) {
+    FreePool (mContext);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
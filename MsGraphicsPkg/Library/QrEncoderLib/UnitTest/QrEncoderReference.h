@@ -0,0 +1,34 @@
+/**@file
+QrEncoderReference.h
+
+Entry point of the frozen byte per module QrEncoderLib pipeline used as the
+expected output by QrEncoderLibHostTest.
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __QRENCODER_REFERENCE__
+#define __QRENCODER_REFERENCE__
+
+/**
+  Encode Data with the original QrEncodeData pipeline.
+
+  Parameters and return values are the same as QrEncodeData.
+
+**/
+EFI_STATUS
+EFIAPI
+QrEncodeDataReference (
+  IN  UINT8                          Version,
+  IN  QRLEVEL                        Level,
+  IN  QRENCODING                     Mode,
+  IN  UINT32                         Flags,
+  IN  UINT8                          *Data,
+  IN  UINT16                         DataLen,
+  IN  INTN                           RegionSize,
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  **Bitmap
+  );
+
+#endif
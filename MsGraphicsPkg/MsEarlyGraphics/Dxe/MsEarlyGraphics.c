@@ -64,6 +64,12 @@ MsEarlyGraphicsEntry (
   mEarlyGraphicsProtocol.SimpleFill            = SimpleFill;
   mEarlyGraphicsProtocol.PrintLn               = PrintLn;
   mEarlyGraphicsProtocol.Mode                  = mMode;
+  mEarlyGraphicsProtocol.ScrollUp              = ScrollUp;
+
+  //
+  // Blt and fill work without the text buffers, so a failure here only disables PrintLn.
+  //
+  InitializeText (mEarlyGraphicsProtocol.Maxcolumns);
 
   Status = gBS->InstallProtocolInterface (
                   &ImageHandle,
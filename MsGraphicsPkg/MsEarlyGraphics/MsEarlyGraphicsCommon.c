@@ -15,25 +15,54 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define BITMAP_LEN_1_BIT(Width, Height)  (((Width) + 7) / 8 * (Height))
 
+//
+// Glyphs of the characters PrintLn () can print are indexed when the driver starts.
+//
+#define GLYPH_INDEX_SIZE  256
+
+//
+// Pixels of a glyph bitmap byte, most significant bit first.
+//
+#define PIXELS_PER_BYTE  8
+
+typedef struct {
+  EFI_HII_GLYPH_INFO    *Cell;
+  UINT8                 *Bitmap;
+} MS_EARLY_GRAPHICS_GLYPH;
+
+STATIC MS_EARLY_GRAPHICS_GLYPH  *mGlyphIndex = NULL;
+
+//
+// The pixels of every bitmap byte value, in the colors of the last PrintLn ().
+//
+STATIC UINT32   (*mBytePixels)[PIXELS_PER_BYTE] = NULL;
+STATIC BOOLEAN  mBytePixelsValid                = FALSE;
+STATIC UINT32   mBytePixelsForeground;
+STATIC UINT32   mBytePixelsBackground;
+
+//
+// One scan line of a text row, copied to the frame buffer in one piece.
+//
+STATIC UINT32  *mScanLine = NULL;
+
 /**
-  Parse all glyph blocks to find a glyph block specified by CharValue.
-  If CharValue = (CHAR16) (-1), collect all default character cell information
-  within this font package and backup its information.
+  Parse the glyph blocks of the fixed font once and record the glyphs of a range
+  of characters.
 
-  @param  CharValue               Unicode character value, which identifies a glyph
-                                  block.
-  @param  Cell                    Output cell information of the encoded bitmap.
-  @param  GlyphBlock              Pointer to the static Glyph Block.
+  @param  FirstChar               First character to record.
+  @param  LastChar                Last character to record.
+  @param  Glyphs                  Receives the glyph of each character of the range.
+                                  Entries of characters without a glyph are not changed.
 
-  @retval EFI_SUCCESS             The bitmap data is retrieved successfully.
-  @retval EFI_NOT_FOUND           The specified CharValue does not exist in current
-                                  database.
+  @retval EFI_SUCCESS             The glyph blocks were parsed.
+  @retval EFI_NOT_FOUND           The glyph blocks are not valid.
 **/
+STATIC
 EFI_STATUS
-FindGlyph (
-  IN  CHAR16              CharValue,
-  OUT EFI_HII_GLYPH_INFO  **Cell,
-  OUT UINT8               **GlyphBlock
+ParseGlyphBlocks (
+  IN  CHAR16                   FirstChar,
+  IN  CHAR16                   LastChar,
+  OUT MS_EARLY_GRAPHICS_GLYPH  *Glyphs
   )
 {
   UINT8                      *BlockPtr;
@@ -42,20 +71,21 @@ FindGlyph (
   UINT16                     Length16;
   UINTN                      BufferLen;
   EFI_HII_GLYPH_INFO         *DefaultCell;
+  EFI_HII_GLYPH_INFO         *Cell;
+  UINT8                      *Bitmap;
 
   BlockPtr    = MS_EARLY_GRAPHICS_FONT;
   CharCurrent = 1;
-  BufferLen   = 0;
   DefaultCell = NULL;
 
   while (*BlockPtr != EFI_HII_GIBT_END) {
+    Cell = NULL;
     switch (*BlockPtr) {
       case EFI_HII_GIBT_DEFAULTS:
         //
         // Collect all default character cell information specified by
         // EFI_HII_GIBT_DEFAULTS.
         //
-        //        AsciiPrint("Ignoring GIBT_DEFAULTS\n");
         DefaultCell = &((EFI_HII_GIBT_DEFAULTS_BLOCK *)BlockPtr)->Cell;
         BlockPtr   += sizeof (EFI_HII_GIBT_DEFAULTS_BLOCK);
         break;
@@ -63,34 +93,21 @@ FindGlyph (
       case EFI_HII_GIBT_GLYPH_DEFAULT:
         if (DefaultCell == NULL) {
           ASSERT (DefaultCell != NULL);
-          return EFI_NOT_FOUND;      // MS_CHANGE - check with MT.  What is best way to exit this func
-        }
-
-        BufferLen = BITMAP_LEN_1_BIT (DefaultCell->Width, DefaultCell->Height);
-        if (CharCurrent == CharValue) {
-          *GlyphBlock = (UINT8 *)((UINTN)BlockPtr + sizeof (EFI_HII_GIBT_GLYPH_DEFAULT_BLOCK) - sizeof (UINT8));
-          *Cell       = DefaultCell;
-          //  DumpMemory(*GlyphBlock, 16);
-          return EFI_SUCCESS;
+          return EFI_NOT_FOUND;
         }
 
-        CharCurrent++;
-        BlockPtr += sizeof (EFI_HII_GIBT_GLYPH_DEFAULT_BLOCK) - sizeof (UINT8) + BufferLen;
+        Cell      = DefaultCell;
+        Bitmap    = BlockPtr + sizeof (EFI_HII_GIBT_GLYPH_DEFAULT_BLOCK) - sizeof (UINT8);
+        BufferLen = BITMAP_LEN_1_BIT (Cell->Width, Cell->Height);
+        BlockPtr  = Bitmap + BufferLen;
         break;
 
       case EFI_HII_GIBT_GLYPH:
         BlockGlyphs = (EFI_HII_GIBT_GLYPHS_BLOCK *)BlockPtr;
-        *Cell       = &BlockGlyphs->Cell;
-        BufferLen   = BITMAP_LEN_1_BIT (BlockGlyphs->Cell.Width, BlockGlyphs->Cell.Height);
-        if (CharCurrent == CharValue) {
-          *GlyphBlock = (UINT8 *)((UINTN)BlockPtr + sizeof (EFI_HII_GIBT_GLYPH_BLOCK) - sizeof (UINT8));
-          *Cell       = &BlockGlyphs->Cell;
-          // DumpMemory (*GlyphBlock,16);
-          return EFI_SUCCESS;
-        }
-
-        CharCurrent++;
-        BlockPtr += sizeof (EFI_HII_GIBT_GLYPH_BLOCK) - sizeof (UINT8) + BufferLen;
+        Cell        = &BlockGlyphs->Cell;
+        Bitmap      = BlockPtr + sizeof (EFI_HII_GIBT_GLYPH_BLOCK) - sizeof (UINT8);
+        BufferLen   = BITMAP_LEN_1_BIT (Cell->Width, Cell->Height);
+        BlockPtr    = Bitmap + BufferLen;
         break;
 
       case EFI_HII_GIBT_SKIP1:
@@ -106,102 +123,203 @@ FindGlyph (
 
       default:
         return EFI_NOT_FOUND;
-        break;
     }
 
-    if (CharValue < CharCurrent) {
-      return EFI_NOT_FOUND;
+    if (CharCurrent > LastChar) {
+      break;
     }
+
+    if (Cell != NULL) {
+      if (CharCurrent >= FirstChar) {
+        Glyphs[CharCurrent - FirstChar].Cell   = Cell;
+        Glyphs[CharCurrent - FirstChar].Bitmap = Bitmap;
+      }
+
+      CharCurrent++;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Find the glyph of a character of the fixed font.
+
+  Characters below 256 are looked up in the index built by InitializeText ().
+  Other characters are found by parsing the glyph blocks.
+
+  @param  CharValue               Unicode character value, which identifies a glyph
+                                  block.
+  @param  Cell                    Output cell information of the encoded bitmap.
+  @param  GlyphBlock              Pointer to the static Glyph Block.
+
+  @retval EFI_SUCCESS             The bitmap data is retrieved successfully.
+  @retval EFI_NOT_FOUND           The specified CharValue does not exist in current
+                                  database.
+**/
+EFI_STATUS
+FindGlyph (
+  IN  CHAR16              CharValue,
+  OUT EFI_HII_GLYPH_INFO  **Cell,
+  OUT UINT8               **GlyphBlock
+  )
+{
+  MS_EARLY_GRAPHICS_GLYPH  Glyph;
+
+  if ((mGlyphIndex != NULL) && (CharValue < GLYPH_INDEX_SIZE)) {
+    Glyph = mGlyphIndex[CharValue];
+  } else {
+    ZeroMem (&Glyph, sizeof (Glyph));
+    ParseGlyphBlocks (CharValue, CharValue, &Glyph);
   }
 
-  return EFI_NOT_FOUND;
+  if (Glyph.Cell == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  *Cell       = Glyph.Cell;
+  *GlyphBlock = Glyph.Bitmap;
+  return EFI_SUCCESS;
 }
 
 /**
-  Convert bitmap data of the glyph to blt structure.
-
-  This is a internal function.
-
-  @param  GlyphBuffer             Buffer points to bitmap data of glyph.
-  @param  Foreground              The color of the "on" pixels in the glyph in the
-                                  bitmap.
-  @param  Background              The color of the "off" pixels in the glyph in the
-                                  bitmap.
-  @param  ImageWidth              Width of the whole image in pixels.
-  @param  BaseLine                BaseLine in the line.
-  @param  RowWidth                The width of the text on the line, in pixels.
-  @param  RowHeight               The height of the line, in pixels.
-  @param  Cell                    Points to EFI_HII_GLYPH_INFO structure.
-  @param  Origin                  Points to the origin of the output buffer for the
-                                  displayed character.
+  Index the glyphs of the fixed font and allocate the buffers used by PrintLn ().
+
+  @param  Maxcolumns              Number of text columns of the display.
+
+  @retval EFI_SUCCESS             Text can be printed.
+  @retval EFI_NOT_FOUND           The glyph blocks of the fixed font are not valid.
+  @retval EFI_OUT_OF_RESOURCES    The buffers could not be allocated.
 **/
 EFI_STATUS
-GlyphToBlt (
-  IN     UINT8                          *GlyphBuffer,
-  IN     EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Foreground,
-  IN     EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Background,
-  IN     UINT16                         ImageWidth,
-  IN     UINT16                         BaseLine,
-  IN     UINT32                         RowWidth,
-  IN     UINT32                         RowHeight,
-  IN     CONST EFI_HII_GLYPH_INFO       *Cell,
-  OUT    EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Origin
+InitializeText (
+  IN UINT32  Maxcolumns
   )
 {
-  UINT16                         Xpos;
-  UINT16                         Ypos;
-  UINT8                          Data;
-  UINT16                         Index;
-  UINT16                         YposOffset;
-  UINTN                          OffsetY;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *BltBuffer;
-
-  if ((GlyphBuffer == NULL) || (Cell == NULL)) {
-    return EFI_INVALID_PARAMETER;
+  EFI_STATUS  Status;
+
+  mGlyphIndex = AllocateZeroPool (GLYPH_INDEX_SIZE * sizeof (MS_EARLY_GRAPHICS_GLYPH));
+  mBytePixels = AllocatePool (GLYPH_INDEX_SIZE * sizeof (*mBytePixels));
+  mScanLine   = AllocatePool (Maxcolumns * MS_EARLY_GRAPHICS_CELL_WIDTH * sizeof (UINT32));
+  if ((mGlyphIndex == NULL) || (mBytePixels == NULL) || (mScanLine == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
   }
 
-  // Move position to the left-top corner of char.
-  //
-  BltBuffer  = Origin + Cell->OffsetX - (Cell->OffsetY + Cell->Height) * ImageWidth;
-  YposOffset = (UINT16)(BaseLine - (Cell->OffsetY + Cell->Height));
+  Status = ParseGlyphBlocks (0, GLYPH_INDEX_SIZE - 1, mGlyphIndex);
 
-  //
-  // The glyph's upper left hand corner pixel is the most significant bit of the
-  // first bitmap byte.
-  //
-  for (Ypos = 0; Ypos < Cell->Height && ((UINTN)(Ypos + YposOffset) < RowHeight); Ypos++) {
-    OffsetY = BITMAP_LEN_1_BIT (Cell->Width, Ypos);
-
-    //
-    // All bits in these bytes are meaningful.
-    //
-    for (Xpos = 0; Xpos < Cell->Width / 8; Xpos++) {
-      Data = *(GlyphBuffer + OffsetY + Xpos);
-      for (Index = 0; Index < 8 && ((UINTN)(Xpos * 8 + Index + Cell->OffsetX) < RowWidth); Index++) {
-        if ((Data & (1 << (8 - Index - 1))) != 0) {
-          BltBuffer[Ypos * ImageWidth + Xpos * 8 + Index] = Foreground;
-        } else {
-          BltBuffer[Ypos * ImageWidth + Xpos * 8 + Index] = Background;
-        }
-      }
+Exit:
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Unable to initialize text output. Code=%r\n", __FUNCTION__, Status));
+    if (mGlyphIndex != NULL) {
+      FreePool (mGlyphIndex);
+      mGlyphIndex = NULL;
     }
 
-    if (Cell->Width % 8 != 0) {
-      //
-      // There are some padding bits in this byte. Ignore them.
-      //
-      Data = *(GlyphBuffer + OffsetY + Xpos);
-      for (Index = 0; Index < Cell->Width % 8 && ((UINTN)(Xpos * 8 + Index + Cell->OffsetX) < RowWidth); Index++) {
-        if ((Data & (1 << (8 - Index - 1))) != 0) {
-          BltBuffer[Ypos * ImageWidth + Xpos * 8 + Index] = Foreground;
-        } else {
-          BltBuffer[Ypos * ImageWidth + Xpos * 8 + Index] = Background;
-        }
-      }
-    }     // end of if (Width % 8...)
-  }   // end of for (Ypos=0...)
+    if (mBytePixels != NULL) {
+      FreePool (mBytePixels);
+      mBytePixels = NULL;
+    }
 
-  return EFI_SUCCESS;
+    if (mScanLine != NULL) {
+      FreePool (mScanLine);
+      mScanLine = NULL;
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Fill the byte to pixels table with the colors of the text, unless it already
+  holds them.
+
+  @param  Foreground              The color of the "on" pixels of the glyphs.
+  @param  Background              The color of the "off" pixels of the glyphs.
+**/
+STATIC
+VOID
+SetTextColors (
+  IN UINT32  Foreground,
+  IN UINT32  Background
+  )
+{
+  UINTN  Value;
+  UINTN  Bit;
+
+  if (mBytePixelsValid && (mBytePixelsForeground == Foreground) && (mBytePixelsBackground == Background)) {
+    return;
+  }
+
+  for (Value = 0; Value < GLYPH_INDEX_SIZE; Value++) {
+    for (Bit = 0; Bit < PIXELS_PER_BYTE; Bit++) {
+      mBytePixels[Value][Bit] = ((Value & (0x80 >> Bit)) != 0) ? Foreground : Background;
+    }
+  }
+
+  mBytePixelsForeground = Foreground;
+  mBytePixelsBackground = Background;
+  mBytePixelsValid      = TRUE;
+}
+
+/**
+  Render one scan line of a character cell.
+
+  The glyph's upper left hand corner pixel is the most significant bit of the
+  first bitmap byte, and the glyph is drawn from the top of the cell.
+
+  @param  Glyph                   The glyph of the character. Cell is NULL for a
+                                  character without a glyph.
+  @param  Line                    The scan line of the cell.
+  @param  Background              The color of the pixels outside the glyph.
+  @param  Pixels                  Receives the MS_EARLY_GRAPHICS_CELL_WIDTH pixels of
+                                  the scan line.
+**/
+STATIC
+VOID
+RenderGlyphLine (
+  IN  CONST MS_EARLY_GRAPHICS_GLYPH  *Glyph,
+  IN  UINT32                         Line,
+  IN  UINT32                         Background,
+  OUT UINT32                         *Pixels
+  )
+{
+  CONST EFI_HII_GLYPH_INFO  *Cell;
+  CONST UINT8               *Bits;
+  UINT32                    CellWidth;
+  UINT32                    Start;
+  UINT32                    Width;
+  UINT32                    X;
+
+  Cell      = Glyph->Cell;
+  CellWidth = MS_EARLY_GRAPHICS_CELL_WIDTH;
+  Start     = ((Cell != NULL) && (Cell->OffsetX > 0)) ? (UINT32)Cell->OffsetX : 0;
+  if ((Cell == NULL) || (Line >= Cell->Height) || (Start >= CellWidth)) {
+    SetMem32 (Pixels, CellWidth * sizeof (UINT32), Background);
+    return;
+  }
+
+  Width = MIN (Cell->Width, CellWidth - Start);
+  Bits  = Glyph->Bitmap + BITMAP_LEN_1_BIT (Cell->Width, Line);
+
+  if (Start > 0) {
+    SetMem32 (Pixels, Start * sizeof (UINT32), Background);
+  }
+
+  for (X = 0; X + PIXELS_PER_BYTE <= Width; X += PIXELS_PER_BYTE) {
+    CopyMem (Pixels + Start + X, mBytePixels[Bits[X / PIXELS_PER_BYTE]], PIXELS_PER_BYTE * sizeof (UINT32));
+  }
+
+  //
+  // The padding bits of the last byte are not drawn.
+  //
+  if (X < Width) {
+    CopyMem (Pixels + Start + X, mBytePixels[Bits[X / PIXELS_PER_BYTE]], (Width - X) * sizeof (UINT32));
+  }
+
+  if (Start + Width < CellWidth) {
+    SetMem32 (Pixels + Start + Width, (CellWidth - Start - Width) * sizeof (UINT32), Background);
+  }
 }
 
 /**
@@ -297,7 +415,10 @@ SimpleFill (
 /**
  * Print a line at the row specified. There is no line
  * wrapping, and \n and other special characters are not
- * supported.
+ * supported. Characters past the last column are not printed.
+ *
+ * The row is rendered one scan line at a time and each scan line
+ * is copied to the frame buffer in one piece.
  *
  * @param Row               Row to display msg on
  * @param Column            Column to start display of message
@@ -305,7 +426,9 @@ SimpleFill (
  * @param BackgroundColor   Color of background behind text
  * @param Msg               String to display
  *
- * @retval EFI_SUCCESS      String was written to display
+ * @retval EFI_SUCCESS           String was written to display
+ * @retval EFI_INVALID_PARAMETER Row or Column is not on the display
+ * @retval EFI_NOT_READY         Text output was not initialized
  */
 EFI_STATUS
 EFIAPI
@@ -318,54 +441,115 @@ PrintLn (
   IN  CONST CHAR8                    *Msg
   )
 {
-  EFI_STATUS                     Status;
-  OUT EFI_HII_GLYPH_INFO         *Cell;
-  OUT UINT8                      *GlyphBlock;
-  UINT16                         BaseLine;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *BufferPtr;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *ImageBuffer;
+  UINT32                         Foreground;
+  UINT32                         Background;
+  UINT32                         CellWidth;
+  UINT32                         CellHeight;
+  UINTN                          Count;
+  UINTN                          Index;
+  UINT32                         Line;
+  UINT32                         *Dest;
+  CONST MS_EARLY_GRAPHICS_GLYPH  *Glyph;
+
+  if ((mScanLine == NULL) || (mGlyphIndex == NULL) || (mBytePixels == NULL)) {
+    return EFI_NOT_READY;
+  }
 
-  this->UpdateFrameBufferBase (this);
-  ImageBuffer = AllocatePool (MS_EARLY_GRAPHICS_CELL_HEIGHT * MS_EARLY_GRAPHICS_CELL_ADVANCE * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-  if (ImageBuffer == NULL) {
-    return EFI_OUT_OF_RESOURCES;
+  if ((Row >= this->Maxrows) || (Column >= this->Maxcolumns)) {
+    return EFI_INVALID_PARAMETER;
   }
 
-  Status = EFI_SUCCESS;
-  while ('\0' != *Msg) {
-    Status = FindGlyph ((UINT8)*Msg, &Cell, &GlyphBlock);    // Poor man's CHAR8 to CHAR16 conversion
-    if (!EFI_ERROR (Status)) {
-      BaseLine  = Cell->Height + Cell->OffsetY;
-      BufferPtr = ImageBuffer + BaseLine * Cell->Width;
-      Status    = GlyphToBlt (
-                    GlyphBlock,
-                    ForegroundColor,
-                    BackgroundColor,
-                    Cell->Width,
-                    BaseLine,
-                    Cell->Width,
-                    Cell->Height,
-                    Cell,
-                    BufferPtr
-                    );
-      if (!EFI_ERROR (Status)) {
-        Status = SimpleBlt (
-                   this,
-                   ImageBuffer,
-                   Column * MS_EARLY_GRAPHICS_CELL_WIDTH,
-                   Row * MS_EARLY_GRAPHICS_CELL_HEIGHT,
-                   Cell->Width,
-                   Cell->Height
-                   );
-      }
+  Count = AsciiStrnLenS (Msg, this->Maxcolumns - Column);
+  if (Count == 0) {
+    return EFI_SUCCESS;
+  }
+
+  this->UpdateFrameBufferBase (this);
+
+  CopyMem (&Foreground, &ForegroundColor, sizeof (Foreground));
+  CopyMem (&Background, &BackgroundColor, sizeof (Background));
+  SetTextColors (Foreground, Background);
+
+  CellWidth  = MS_EARLY_GRAPHICS_CELL_WIDTH;
+  CellHeight = MS_EARLY_GRAPHICS_CELL_HEIGHT;
+
+  // FrameBuffer has to be in low 4GB to work in PEI anyway.  Allw full 64 bit memory address in DXE
+  Dest = (UINT32 *)((UINTN)this->Mode->FrameBufferBase +
+                    Column * CellWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL) +
+                    Row * CellHeight * this->Mode->Info->PixelsPerScanLine * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+
+  for (Line = 0; Line < CellHeight; Line++) {
+    for (Index = 0; Index < Count; Index++) {
+      Glyph = &mGlyphIndex[(UINT8)Msg[Index]];    // Poor man's CHAR8 to CHAR16 conversion
+      RenderGlyphLine (Glyph, Line, Background, mScanLine + Index * CellWidth);
     }
 
-    Msg++;
-    Column++;
+    CopyMem (Dest, mScanLine, Count * CellWidth * sizeof (UINT32));
+    Dest = Dest + this->Mode->Info->PixelsPerScanLine;
   }
 
-  FreePool (ImageBuffer);
-  return Status;
+  return EFI_SUCCESS;
+}
+
+/**
+ * Scroll the text rows up, and fill the rows uncovered at the bottom with the
+ * background color.
+ *
+ * The rows are moved with one copy of the frame buffer, so the text does not
+ * have to be printed again.
+ *
+ * @param Rows              Number of rows to scroll
+ * @param BackgroundColor   Color of the rows uncovered at the bottom
+ *
+ * @retval EFI_SUCCESS      The display was scrolled
+ */
+EFI_STATUS
+EFIAPI
+ScrollUp (
+  IN  MS_EARLY_GRAPHICS_PROTOCOL     *this,
+  IN  UINT32                         Rows,
+  IN  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  BackgroundColor
+  )
+{
+  UINT32  Background;
+  UINT32  CellHeight;
+  UINTN   LineSize;
+  UINT8   *FrameBuffer;
+
+  if (Rows == 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (Rows > this->Maxrows) {
+    Rows = this->Maxrows;
+  }
+
+  this->UpdateFrameBufferBase (this);
+
+  CellHeight  = MS_EARLY_GRAPHICS_CELL_HEIGHT;
+  LineSize    = this->Mode->Info->PixelsPerScanLine * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  FrameBuffer = (UINT8 *)(UINTN)this->Mode->FrameBufferBase;
+
+  //
+  // CopyMem handles the overlap of the source and destination.
+  //
+  if (Rows < this->Maxrows) {
+    CopyMem (
+      FrameBuffer,
+      FrameBuffer + Rows * CellHeight * LineSize,
+      (this->Maxrows - Rows) * CellHeight * LineSize
+      );
+  }
+
+  CopyMem (&Background, &BackgroundColor, sizeof (Background));
+  return SimpleFill (
+           this,
+           Background,
+           0,
+           (this->Maxrows - Rows) * CellHeight,
+           this->Mode->Info->HorizontalResolution,
+           Rows * CellHeight
+           );
 }
 
 /**
@@ -14,6 +14,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/GraphicsOutput.h>
 #include <Protocol/MsEarlyGraphics.h>
 #include <Protocol/MsUiThemeProtocol.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/DebugLib.h>
@@ -22,9 +23,10 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 extern MS_UI_THEME_DESCRIPTION  *gPlatformTheme;
 
 /**
- Parse all glyph blocks to find a glyph block specified by CharValue.
- If CharValue = (CHAR16) (-1), collect all default character cell information
- within this font package and backup its information.
+ Find the glyph of a character of the fixed font.
+
+ Characters below 256 are looked up in the index built by InitializeText ().
+ Other characters are found by parsing the glyph blocks.
 
  @param  CharValue               Unicode character value, which identifies a glyph
                                  block.
@@ -43,34 +45,18 @@ FindGlyph (
   );
 
 /**
-  Convert bitmap data of the glyph to blt structure.
-
-  This is a internal function.
-
-  @param  GlyphBuffer             Buffer points to bitmap data of glyph.
-  @param  Foreground              The color of the "on" pixels in the glyph in the
-                                  bitmap.
-  @param  Background              The color of the "off" pixels in the glyph in the
-                                  bitmap.
-  @param  ImageWidth              Width of the whole image in pixels.
-  @param  BaseLine                BaseLine in the line.
-  @param  RowWidth                The width of the text on the line, in pixels.
-  @param  RowHeight               The height of the line, in pixels.
-  @param  Cell                    Points to EFI_HII_GLYPH_INFO structure.
-  @param  Origin                  Points to the origin of the output buffer for the
-                                  displayed character.
+  Index the glyphs of the fixed font and allocate the buffers used by PrintLn ().
+  Called once by the entry point, before the protocol is published.
+
+  @param  Maxcolumns              Number of text columns of the display.
+
+  @retval EFI_SUCCESS             Text can be printed.
+  @retval EFI_NOT_FOUND           The glyph blocks of the fixed font are not valid.
+  @retval EFI_OUT_OF_RESOURCES    The buffers could not be allocated.
 **/
 EFI_STATUS
-GlyphToBlt (
-  IN     UINT8                          *GlyphBuffer,
-  IN     EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Foreground,
-  IN     EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Background,
-  IN     UINT16                         ImageWidth,
-  IN     UINT16                         BaseLine,
-  IN     UINT32                         RowWidth,
-  IN     UINT32                         RowHeight,
-  IN     CONST EFI_HII_GLYPH_INFO       *Cell,
-  OUT    EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Origin
+InitializeText (
+  IN UINT32  Maxcolumns
   );
 
 /**
@@ -122,7 +108,7 @@ SimpleFill (
 /**
 *  Print a line at the row specified. There is no line
 *  wrapping, and \n and other special characters are not
-*  supported.
+*  supported. Characters past the last column are not printed.
 
    @param Row                    Row to display msg on
    @param Column                 Column to start display of message
@@ -131,6 +117,8 @@ SimpleFill (
    @param Msg                    String to display
 
    @retval EFI_SUCCESS           String was written to display
+   @retval EFI_INVALID_PARAMETER Row or Column is not on the display
+   @retval EFI_NOT_READY         Text output was not initialized
 */
 EFI_STATUS
 EFIAPI
@@ -143,6 +131,23 @@ PrintLn (
   IN  CONST CHAR8                    *Msg
   );
 
+/**
+*  Scroll the text rows up, and fill the rows uncovered at the
+*  bottom with the background color.
+
+   @param Rows                   Number of rows to scroll
+   @param BackgroundColor        Color of the rows uncovered at the bottom
+
+   @retval EFI_SUCCESS           The display was scrolled
+*/
+EFI_STATUS
+EFIAPI
+ScrollUp (
+  IN  MS_EARLY_GRAPHICS_PROTOCOL     *this,
+  IN  UINT32                         Rows,
+  IN  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  BackgroundColor
+  );
+
 /**
  * GetCellHeight
  *
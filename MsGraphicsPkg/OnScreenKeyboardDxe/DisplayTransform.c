@@ -209,17 +209,25 @@ RotateX (
   IN float  Angle
   )
 {
-  float  rotex[4][4];
+  float   rotex[4][4];
+  double  Radians;
+  double  Sine;
+  double  Cosine;
 
   SetMem (rotex, sizeof (float)*16, 0);
 
+  // One range reduction gives both sine and cosine
+  //
+  Radians = Angle;
+  SinCosArray (&Radians, &Sine, &Cosine, 1);
+
   // Fill in rotation matrix with x-axis rotation values
   //
   rotex[0][0] = 1.0;
-  rotex[1][1] = (float)cos_d (Angle);
-  rotex[2][1] = (float)sin_d (Angle);
-  rotex[1][2] = (float)-sin_d (Angle);
-  rotex[2][2] = (float)cos_d (Angle);
+  rotex[1][1] = (float)Cosine;
+  rotex[2][1] = (float)Sine;
+  rotex[1][2] = (float)-Sine;
+  rotex[2][2] = (float)Cosine;
   rotex[3][3] = 1.0;
 
   // Update the xform matrix
@@ -239,17 +247,25 @@ RotateY (
   float  Angle
   )
 {
-  float  rotey[4][4];
+  float   rotey[4][4];
+  double  Radians;
+  double  Sine;
+  double  Cosine;
 
   SetMem (rotey, sizeof (float)*16, 0);
 
+  // One range reduction gives both sine and cosine
+  //
+  Radians = Angle;
+  SinCosArray (&Radians, &Sine, &Cosine, 1);
+
   // Fill in rotation matrix with y-axis rotation values
   //
-  rotey[0][0] = (float)cos_d (Angle);
-  rotey[2][0] = (float)-sin_d (Angle);
+  rotey[0][0] = (float)Cosine;
+  rotey[2][0] = (float)-Sine;
   rotey[1][1] = 1.0;
-  rotey[0][2] = (float)sin_d (Angle);
-  rotey[2][2] = (float)cos_d (Angle);
+  rotey[0][2] = (float)Sine;
+  rotey[2][2] = (float)Cosine;
   rotey[3][3] = 1.0;
 
   // Update the xform matrix
@@ -269,16 +285,24 @@ RotateZ (
   float  Angle
   )
 {
-  float  rotez[4][4];
+  float   rotez[4][4];
+  double  Radians;
+  double  Sine;
+  double  Cosine;
 
   SetMem (rotez, sizeof (float)*16, 0);
 
+  // One range reduction gives both sine and cosine
+  //
+  Radians = Angle;
+  SinCosArray (&Radians, &Sine, &Cosine, 1);
+
   // Fill in rotation matrix with z-axis rotation values
   //
-  rotez[0][0] = (float)cos_d (Angle);
-  rotez[1][0] = (float)sin_d (Angle);
-  rotez[0][1] = (float)-sin_d (Angle);
-  rotez[1][1] = (float)cos_d (Angle);
+  rotez[0][0] = (float)Cosine;
+  rotez[1][0] = (float)Sine;
+  rotez[0][1] = (float)-Sine;
+  rotez[1][1] = (float)Cosine;
   rotez[2][2] = rotez[3][3] = 1.0;
 
   // Update the xform matrix
@@ -55,6 +55,21 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define DOCK_BUTTON_X_PERCENT   (float)0.920000         // X position is 92% of keyboard width
 #define CLOSE_BUTTON_X_PERCENT  (float)0.970000         // X position is 97% of keyboard width
 
+// Key hit-test grid.  The transformed key area is divided into a uniform grid of cells, each listing the keys
+// that overlap it, so a touch/mouse coordinate only needs to be checked against a handful of keys.
+//
+#define KEY_HIT_GRID_COLUMNS        16                  // Number of grid cells across the key area.
+#define KEY_HIT_GRID_ROWS           16                  // Number of grid cells down the key area.
+#define KEY_HIT_GRID_CELL_KEYS      6                   // Maximum number of keys listed per grid cell.
+#define KEY_HIT_GRID_CELL_OVERFLOW  0xFF                // Cell key count indicating the cell must be searched linearly.
+
+// Pre-rendered key states held in the key atlas.
+//
+#define KEY_ATLAS_NORMAL   0                            // Standard key mapping, no modifier, not selected.
+#define KEY_ATLAS_PRESSED  1                            // Standard key mapping, no modifier, selected.
+#define KEY_ATLAS_SHIFTED  2                            // Shift key mapping and shift modifier, not selected.
+#define KEY_ATLAS_STATES   3
+
 // Function prototypes
 //
 EFI_STATUS
@@ -171,6 +186,35 @@ typedef struct _KEYINFO_tag {
   } KeyDisplayHitRect;
 } KEY_INFO;
 
+// Key hit-test grid (see KEY_HIT_GRID_*).  Keys are listed in each cell in ascending key order so a lookup
+// returns the same key as a linear search of the key list.
+//
+typedef struct _KEY_HIT_GRID_tag {
+  UINTN    Left;                    // Screen X coordinate of the grid origin
+  UINTN    Top;                     // Screen Y coordinate of the grid origin
+  UINTN    Width;                   // Grid width (pixels), zero if no key is hittable
+  UINTN    Height;                  // Grid height (pixels)
+  UINT8    KeyCount[KEY_HIT_GRID_ROWS][KEY_HIT_GRID_COLUMNS];
+  UINT8    Keys[KEY_HIT_GRID_ROWS][KEY_HIT_GRID_COLUMNS][KEY_HIT_GRID_CELL_KEYS];
+} KEY_HIT_GRID;
+
+// Pre-rendered image of a key (fill and label) for one key state.  The image is only used when the key
+// label and colors needed match the ones it was rendered with.
+//
+typedef struct _KEY_ATLAS_IMAGE_tag {
+  EFI_STRING                       KeyLabel;      // Label rendered into the image, NULL if the image isn't valid
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    FillColor;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    LabelFGColor;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    LabelBGColor;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    *pBitmap;      // Width x Height pixels within the key atlas buffer
+} KEY_ATLAS_IMAGE;
+
+typedef struct _KEY_ATLAS_ENTRY_tag {
+  UINTN              Width;                       // Key width (pixels) the images were rendered at
+  UINTN              Height;                      // Key height (pixels) the images were rendered at
+  KEY_ATLAS_IMAGE    Image[KEY_ATLAS_STATES];
+} KEY_ATLAS_ENTRY;
+
 // Icon and special button bitmap information.
 //
 typedef struct _BITMAP_INFO_tag {
@@ -251,11 +295,20 @@ typedef struct _KEYBOARDINFO_tag {
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *pBackBuffer;
   EFI_IMAGE_OUTPUT                     *pKeyTextBltBuffer;
 
+  // Pre-rendered key images (see KEY_ATLAS_*) and the key mapping and modifier state last rendered for the
+  // whole keyboard, used to redraw only the selected and deselected keys on a key press.
+  //
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *pKeyAtlas;
+  KEY_ATLAS_ENTRY                      KeyAtlas[NUMBER_OF_KEYS];
+  OSK_KEY_MAPPING                      *pRenderedKeyMap;
+  OSK_KEY_MODIFIER_STATE               RenderedModifierState;
+
   // Individual key information (references key geometries below for hit detection)
   //
   UINTN                                SelectedKey;
   UINTN                                DeselectKey;
   KEY_INFO                             KeyList[NUMBER_OF_KEYS];
+  KEY_HIT_GRID                         KeyHitGrid;
 
   // Individual key geometries - original and screen-transformed pointsets
   //
@@ -112,6 +112,12 @@ GetKeyboardIconBoundingRect (
   OUT SWM_RECT  *pRect
   );
 
+STATIC
+VOID
+FreeKeyAtlas (
+  VOID
+  );
+
 EFI_STATUS
 EFIAPI
 OSKDriverInit (
@@ -620,6 +626,10 @@ HandleDisplayModeChange (
 
   AllocateBackBuffers ();
 
+  // Key labels are re-rendered with the new font.
+  //
+  FreeKeyAtlas ();
+
   // Hide keyboard and icon.
   //
   ShowKeyboard (FALSE);
@@ -913,6 +923,121 @@ InitializeKeyboardGeometry (
   return (AllocateBackBuffers ());
 }
 
+/**
+    Computes the hit-test grid cell containing a screen coordinate along one axis.
+
+    @param[in]      Coordinate          Screen coordinate (must lie within the grid).
+    @param[in]      Origin              Screen coordinate of the grid origin along this axis.
+    @param[in]      Extent              Grid size (pixels) along this axis.
+    @param[in]      Cells               Number of grid cells along this axis.
+
+    @retval         Cell index.
+
+**/
+STATIC
+UINTN
+GetKeyHitGridCell (
+  IN UINTN  Coordinate,
+  IN UINTN  Origin,
+  IN UINTN  Extent,
+  IN UINTN  Cells
+  )
+{
+  return ((Coordinate - Origin) * Cells) / Extent;
+}
+
+/**
+    Rebuilds the key hit-test grid from the key display hit rectangles.
+
+    Each key is listed in every grid cell its hit rectangle overlaps, in ascending key order.  A cell that
+    would list more than KEY_HIT_GRID_CELL_KEYS keys is marked for a linear search instead.
+
+    @param[in]      pKeyList            Pointer to the keys.
+    @param[in]      NumberOfKeys        Total number of keys in the list.
+
+    @retval         None.
+
+**/
+STATIC
+VOID
+BuildKeyHitGrid (
+  IN KEY_INFO  *pKeyList,
+  IN UINTN     NumberOfKeys
+  )
+{
+  KEY_HIT_GRID  *pGrid = &mOSK.KeyHitGrid;
+  UINTN         Count;
+  UINTN         Left, Top, Right, Bottom;
+  UINTN         FirstColumn, LastColumn, FirstRow, LastRow;
+  UINTN         Row, Column;
+  UINT8         *pKeyCount;
+
+  ZeroMem (pGrid, sizeof (KEY_HIT_GRID));
+
+  // Find the area covered by the keys.  Inverted rectangles can never be hit so they're ignored.
+  //
+  Left   = MAX_UINTN;
+  Top    = MAX_UINTN;
+  Right  = 0;
+  Bottom = 0;
+
+  for (Count = 0; Count < NumberOfKeys; Count++) {
+    if ((pKeyList[Count].KeyDisplayHitRect.Left > pKeyList[Count].KeyDisplayHitRect.Right) ||
+        (pKeyList[Count].KeyDisplayHitRect.Top > pKeyList[Count].KeyDisplayHitRect.Bottom))
+    {
+      continue;
+    }
+
+    Left   = MIN (Left, pKeyList[Count].KeyDisplayHitRect.Left);
+    Top    = MIN (Top, pKeyList[Count].KeyDisplayHitRect.Top);
+    Right  = MAX (Right, pKeyList[Count].KeyDisplayHitRect.Right);
+    Bottom = MAX (Bottom, pKeyList[Count].KeyDisplayHitRect.Bottom);
+  }
+
+  if ((Left > Right) || (Top > Bottom)) {
+    return;
+  }
+
+  pGrid->Left   = Left;
+  pGrid->Top    = Top;
+  pGrid->Width  = (Right - Left + 1);
+  pGrid->Height = (Bottom - Top + 1);
+
+  // List each key in the cells it overlaps.
+  //
+  for (Count = 0; Count < NumberOfKeys; Count++) {
+    if ((pKeyList[Count].KeyDisplayHitRect.Left > pKeyList[Count].KeyDisplayHitRect.Right) ||
+        (pKeyList[Count].KeyDisplayHitRect.Top > pKeyList[Count].KeyDisplayHitRect.Bottom))
+    {
+      continue;
+    }
+
+    FirstColumn = GetKeyHitGridCell (pKeyList[Count].KeyDisplayHitRect.Left, pGrid->Left, pGrid->Width, KEY_HIT_GRID_COLUMNS);
+    LastColumn  = GetKeyHitGridCell (pKeyList[Count].KeyDisplayHitRect.Right, pGrid->Left, pGrid->Width, KEY_HIT_GRID_COLUMNS);
+    FirstRow    = GetKeyHitGridCell (pKeyList[Count].KeyDisplayHitRect.Top, pGrid->Top, pGrid->Height, KEY_HIT_GRID_ROWS);
+    LastRow     = GetKeyHitGridCell (pKeyList[Count].KeyDisplayHitRect.Bottom, pGrid->Top, pGrid->Height, KEY_HIT_GRID_ROWS);
+
+    for (Row = FirstRow; Row <= LastRow; Row++) {
+      for (Column = FirstColumn; Column <= LastColumn; Column++) {
+        pKeyCount = &pGrid->KeyCount[Row][Column];
+        if (KEY_HIT_GRID_CELL_OVERFLOW == *pKeyCount) {
+          continue;
+        }
+
+        if (KEY_HIT_GRID_CELL_KEYS == *pKeyCount) {
+          *pKeyCount = KEY_HIT_GRID_CELL_OVERFLOW;
+          continue;
+        }
+
+        pGrid->Keys[Row][Column][*pKeyCount] = (UINT8)Count;
+        (*pKeyCount)++;
+      }
+    }
+  }
+
+  return;
+}
+
 /**
     Updates the "hit rectangle" for each key, used to determine key selection.  The area is computed based on the
     currently applied display transform.
@@ -940,6 +1065,10 @@ UpdateKeyDisplayHitRect (
     pKeyList[Count].KeyDisplayHitRect.Bottom = (UINTN)pTransformRectSet[Count].botR.pt.y;
   }
 
+  // Rebuild the hit-test grid now that the key rectangles have moved.
+  //
+  BuildKeyHitGrid (pKeyList, NumberOfKeys);
+
   return;
 }
 
@@ -1099,6 +1228,368 @@ GetKeyboardBoundingRect (
   return;
 }
 
+/**
+Selects the key fill and label colors based on key mapping, keyboard modifier state, and color scheme.
+
+@param[in]      KeyNumber           Index of the key.
+@param[in]      ModifierState       Keyboard modifier state to render the key for.
+@param[in]      pKeyMap             Key mapping table to render the key for.
+@param[in]      bSelected           Whether the key is selected.
+@param[out]     pFillColor          Key fill color.
+@param[out]     pLabelFGColor       Key label foreground color.
+@param[out]     pLabelBGColor       Key label background color.
+
+@retval         None.
+
+**/
+STATIC
+VOID
+GetKeyColors (
+  IN  UINTN                          KeyNumber,
+  IN  OSK_KEY_MODIFIER_STATE         ModifierState,
+  IN  OSK_KEY_MAPPING                *pKeyMap,
+  IN  BOOLEAN                        bSelected,
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pFillColor,
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pLabelFGColor,
+  OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pLabelBGColor
+  )
+{
+  BOOLEAN  bShiftKey = (BOOLEAN)((EfiKeyLShift == pKeyMap[KeyNumber].EfiKey) || (EfiKeyRShift == pKeyMap[KeyNumber].EfiKey));
+
+  if ((Shift == ModifierState) && bShiftKey) {
+    CopyMem (pFillColor, &gMsColorTable.KeyboardShiftStateKeyColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelFGColor, &gMsColorTable.KeyboardShiftStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelBGColor, &gMsColorTable.KeyboardShiftStateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  } else if ((CapsLock == ModifierState) && bShiftKey) {
+    CopyMem (pFillColor, &gMsColorTable.KeyboardCapsLockStateKeyColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelFGColor, &gMsColorTable.KeyboardCapsLockStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelBGColor, &gMsColorTable.KeyboardCapsLockStateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  } else if (((NumSym == ModifierState) || (Function == ModifierState)) && bShiftKey) {
+    CopyMem (pFillColor, mOSK.KeyList[KeyNumber].pKeyFillColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelFGColor, &gMsColorTable.KeyboardNumSymStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));                    // Gray-out shift keys in these modes
+    CopyMem (pLabelBGColor, mOSK.KeyList[KeyNumber].pKeyFillColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  } else if ((NumSym == ModifierState) && (EfiKeyA0 == pKeyMap[KeyNumber].EfiKey)) {
+    CopyMem (pFillColor, &gMsColorTable.KeyboardNumSymStateKeyColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelFGColor, &gMsColorTable.KeyboardNumSymA0StateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelBGColor, &gMsColorTable.KeyboardNumSymA0StateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  } else if ((Function == ModifierState) && (EfiKeyA2 == pKeyMap[KeyNumber].EfiKey)) {
+    CopyMem (pFillColor, &gMsColorTable.KeyboardFunctionStateKeyColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelFGColor, &gMsColorTable.KeyboardFunctionStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelBGColor, &gMsColorTable.KeyboardFunctionStateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  } else if (TRUE == bSelected) {
+    CopyMem (pFillColor, &gMsColorTable.KeyboardSelectedStateKeyColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelFGColor, &gMsColorTable.KeyboardSelectedStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelBGColor, &gMsColorTable.KeyboardSelectedStateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  } else {
+    CopyMem (pFillColor, mOSK.KeyList[KeyNumber].pKeyFillColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelFGColor, mOSK.KeyList[KeyNumber].pKeyLabelColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    CopyMem (pLabelBGColor, mOSK.KeyList[KeyNumber].pKeyFillColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  }
+
+  return;
+}
+
+/**
+Frees the key atlas.  Keys are rendered directly until the atlas is rebuilt.
+
+@param      None.
+
+@retval     None.
+**/
+STATIC
+VOID
+FreeKeyAtlas (
+  VOID
+  )
+{
+  if (NULL != mOSK.pKeyAtlas) {
+    FreePool (mOSK.pKeyAtlas);
+    mOSK.pKeyAtlas = NULL;
+  }
+
+  ZeroMem (mOSK.KeyAtlas, sizeof (mOSK.KeyAtlas));
+
+  return;
+}
+
+/**
+Renders each key in its normal, pressed, and shifted states (see KEY_ATLAS_*) into an off-screen atlas so
+the keyboard can be redrawn by blitting key images instead of filling and rendering label text per key.
+
+The atlas is only rebuilt when a key's dimensions no longer match the ones it was rendered at.  A key whose
+label doesn't fit on it has no atlas images and is always rendered directly.
+
+@param[in]      StringInfo          Font display information used to render the key labels.
+
+@retval         EFI_SUCCESS             The atlas matches the current key dimensions.
+@retval         EFI_OUT_OF_RESOURCES    The atlas couldn't be allocated.
+**/
+STATIC
+EFI_STATUS
+RenderKeyAtlas (
+  IN EFI_FONT_DISPLAY_INFO  *StringInfo
+  )
+{
+  OSK_KEY_MAPPING                *StateKeyMap[KEY_ATLAS_STATES]       = { mOSK_StdMode_US_EN, mOSK_StdMode_US_EN, mOSK_ShiftMode_US_EN };
+  OSK_KEY_MODIFIER_STATE         StateModifier[KEY_ATLAS_STATES]      = { Normal, Normal, Shift };
+  BOOLEAN                        StateSelected[KEY_ATLAS_STATES]      = { FALSE, TRUE, FALSE };
+  KEY_ATLAS_ENTRY                *pEntry;
+  KEY_ATLAS_IMAGE                *pImage;
+  EFI_IMAGE_OUTPUT               KeyImage;
+  EFI_IMAGE_OUTPUT               *pKeyImage;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pBitmap;
+  UINTN                          KeyWidth, KeyHeight;
+  UINTN                          AtlasPixels;
+  UINTN                          Count;
+  UINTN                          State;
+  BOOLEAN                        bKeyFits[NUMBER_OF_KEYS];
+  BOOLEAN                        bRebuild;
+  EFI_STATUS                     Status;
+
+  // Determine which keys can be pre-rendered and whether the atlas still matches the key dimensions.
+  //
+  bRebuild    = (BOOLEAN)(NULL == mOSK.pKeyAtlas);
+  AtlasPixels = 0;
+
+  for (Count = 0; Count < NUMBER_OF_KEYS; Count++) {
+    KeyWidth  = (mOSK.KeyList[Count].KeyDisplayHitRect.Right  - mOSK.KeyList[Count].KeyDisplayHitRect.Left);
+    KeyHeight = (mOSK.KeyList[Count].KeyDisplayHitRect.Bottom - mOSK.KeyList[Count].KeyDisplayHitRect.Top);
+
+    bKeyFits[Count] = (BOOLEAN)((mOSK.KeyList[Count].KeyDisplayHitRect.Right > mOSK.KeyList[Count].KeyDisplayHitRect.Left) &&
+                                (mOSK.KeyList[Count].KeyDisplayHitRect.Bottom > mOSK.KeyList[Count].KeyDisplayHitRect.Top) &&
+                                (KeyWidth <= MAX_UINT16) && (KeyHeight <= MAX_UINT16));
+
+    for (State = 0; (State < KEY_ATLAS_STATES) && bKeyFits[Count]; State++) {
+      if ((StateKeyMap[State][Count].KeyLabelWidth > KeyWidth) || (StateKeyMap[State][Count].KeyLabelHeight > KeyHeight)) {
+        bKeyFits[Count] = FALSE;
+      }
+    }
+
+    if (!bKeyFits[Count]) {
+      continue;
+    }
+
+    if ((mOSK.KeyAtlas[Count].Width != KeyWidth) || (mOSK.KeyAtlas[Count].Height != KeyHeight)) {
+      bRebuild = TRUE;
+    }
+
+    AtlasPixels += (KeyWidth * KeyHeight * KEY_ATLAS_STATES);
+  }
+
+  if (!bRebuild) {
+    return EFI_SUCCESS;
+  }
+
+  FreeKeyAtlas ();
+
+  if (0 == AtlasPixels) {
+    return EFI_SUCCESS;
+  }
+
+  mOSK.pKeyAtlas = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)AllocatePool (AtlasPixels * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  if (NULL == mOSK.pKeyAtlas) {
+    DEBUG ((DEBUG_WARN, "WARN [OSK]: Failed to allocate key atlas, keys will be rendered directly.\r\n"));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  // Render each key state into its own slice of the atlas.
+  //
+  pBitmap = mOSK.pKeyAtlas;
+
+  for (Count = 0; Count < NUMBER_OF_KEYS; Count++) {
+    if (!bKeyFits[Count]) {
+      continue;
+    }
+
+    KeyWidth  = (mOSK.KeyList[Count].KeyDisplayHitRect.Right  - mOSK.KeyList[Count].KeyDisplayHitRect.Left);
+    KeyHeight = (mOSK.KeyList[Count].KeyDisplayHitRect.Bottom - mOSK.KeyList[Count].KeyDisplayHitRect.Top);
+
+    pEntry         = &mOSK.KeyAtlas[Count];
+    pEntry->Width  = KeyWidth;
+    pEntry->Height = KeyHeight;
+
+    for (State = 0; State < KEY_ATLAS_STATES; State++) {
+      pImage          = &pEntry->Image[State];
+      pImage->pBitmap = pBitmap;
+      pBitmap        += (KeyWidth * KeyHeight);
+
+      GetKeyColors (
+        Count,
+        StateModifier[State],
+        StateKeyMap[State],
+        StateSelected[State],
+        &pImage->FillColor,
+        &pImage->LabelFGColor,
+        &pImage->LabelBGColor
+        );
+
+      // Fill the key background.
+      //
+      SetMem32 (pImage->pBitmap, (KeyWidth * KeyHeight * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)), *(UINT32 *)&pImage->FillColor);
+
+      // Draw the label centered on the key, the same as it would be drawn on screen.
+      //
+      CopyMem (&StringInfo->ForegroundColor, &pImage->LabelFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+      CopyMem (&StringInfo->BackgroundColor, &pImage->LabelBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+      StringInfo->FontInfoMask = EFI_FONT_INFO_ANY_FONT;
+
+      KeyImage.Width        = (UINT16)KeyWidth;
+      KeyImage.Height       = (UINT16)KeyHeight;
+      KeyImage.Image.Bitmap = pImage->pBitmap;
+      pKeyImage             = &KeyImage;
+
+      Status = mSWMProtocol->StringToWindow (
+                               mSWMProtocol,
+                               mImageHandle,
+                               EFI_HII_IGNORE_IF_NO_GLYPH | EFI_HII_IGNORE_LINE_BREAK,    // NOTE: clipping isn't possible when rendering to a bitmap buffer.
+                               StateKeyMap[State][Count].KeyLabel,
+                               StringInfo,
+                               &pKeyImage,
+                               ((KeyWidth  / 2) - (StateKeyMap[State][Count].KeyLabelWidth  / 2)),
+                               ((KeyHeight / 2) - (StateKeyMap[State][Count].KeyLabelHeight / 2)),
+                               NULL,
+                               NULL,
+                               NULL
+                               );
+
+      // Only use images whose label rendered successfully.
+      //
+      pImage->KeyLabel = (EFI_ERROR (Status) ? NULL : StateKeyMap[State][Count].KeyLabel);
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+Finds the pre-rendered image of a key matching its current dimensions, label, and colors.
+
+@param[in]      KeyNumber           Index of the key.
+@param[in]      pFillColor          Key fill color needed.
+@param[in]      pLabelFGColor       Key label foreground color needed.
+@param[in]      pLabelBGColor       Key label background color needed.
+
+@retval         Pointer to the key image, or NULL if the key needs to be rendered directly.
+**/
+STATIC
+EFI_GRAPHICS_OUTPUT_BLT_PIXEL *
+GetKeyAtlasImage (
+  IN UINTN                          KeyNumber,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pFillColor,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pLabelFGColor,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pLabelBGColor
+  )
+{
+  KEY_ATLAS_ENTRY  *pEntry = &mOSK.KeyAtlas[KeyNumber];
+  KEY_ATLAS_IMAGE  *pImage;
+  UINTN            State;
+
+  if ((NULL == mOSK.pKeyAtlas) ||
+      (pEntry->Width  != (mOSK.KeyList[KeyNumber].KeyDisplayHitRect.Right  - mOSK.KeyList[KeyNumber].KeyDisplayHitRect.Left)) ||
+      (pEntry->Height != (mOSK.KeyList[KeyNumber].KeyDisplayHitRect.Bottom - mOSK.KeyList[KeyNumber].KeyDisplayHitRect.Top)))
+  {
+    return NULL;
+  }
+
+  for (State = 0; State < KEY_ATLAS_STATES; State++) {
+    pImage = &pEntry->Image[State];
+    if ((NULL != pImage->KeyLabel) &&
+        (pImage->KeyLabel == mOSK.pKeyMap[KeyNumber].KeyLabel) &&
+        (0 == CompareMem (&pImage->FillColor, pFillColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))) &&
+        (0 == CompareMem (&pImage->LabelFGColor, pLabelFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))) &&
+        (0 == CompareMem (&pImage->LabelBGColor, pLabelBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL))))
+    {
+      return pImage->pBitmap;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+Redraws only the selected and deselected keys from the key atlas after a key press or release.
+
+This is only possible when the rest of the keyboard on screen is current - either the keyboard hasn't
+changed (the case RenderKeyboard also redraws just these keys for) or the key mapping and modifier state
+are the ones the whole keyboard was last rendered with - and both keys have atlas images for their current
+state.  Nothing is drawn otherwise.
+
+@param      None.
+
+@retval     EFI_SUCCESS         The keys were redrawn.
+@retval     EFI_NOT_READY       The whole keyboard needs to be rendered.
+@retval     EFI_NOT_FOUND       A key has no atlas image for its current state.
+**/
+STATIC
+EFI_STATUS
+RenderSelectedKeys (
+  VOID
+  )
+{
+  UINTN                          Keys[2];
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pKeyImage[2];
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  FillColor, LabelFGColor, LabelBGColor;
+  UINTN                          KeyWidth, KeyHeight;
+  UINTN                          Count;
+
+  if (TRUE == mOSK.bKeyboardSizeChanged) {
+    return EFI_NOT_READY;
+  }
+
+  if ((TRUE == mOSK.bKeyboardStateChanged) &&
+      ((mOSK.pKeyMap != mOSK.pRenderedKeyMap) || (mOSK.KeyModifierState != mOSK.RenderedModifierState)))
+  {
+    return EFI_NOT_READY;
+  }
+
+  Keys[0] = mOSK.DeselectKey;
+  Keys[1] = mOSK.SelectedKey;
+
+  // Look up both images before drawing so a miss leaves the screen untouched.
+  //
+  for (Count = 0; Count < ARRAY_SIZE (Keys); Count++) {
+    pKeyImage[Count] = NULL;
+    if (NUMBER_OF_KEYS <= Keys[Count]) {
+      continue;
+    }
+
+    GetKeyColors (Keys[Count], mOSK.KeyModifierState, mOSK.pKeyMap, (BOOLEAN)(mOSK.SelectedKey == Keys[Count]), &FillColor, &LabelFGColor, &LabelBGColor);
+    pKeyImage[Count] = GetKeyAtlasImage (Keys[Count], &FillColor, &LabelFGColor, &LabelBGColor);
+    if (NULL == pKeyImage[Count]) {
+      return EFI_NOT_FOUND;
+    }
+  }
+
+  for (Count = 0; Count < ARRAY_SIZE (Keys); Count++) {
+    if (NULL == pKeyImage[Count]) {
+      continue;
+    }
+
+    KeyWidth  = mOSK.KeyAtlas[Keys[Count]].Width;
+    KeyHeight = mOSK.KeyAtlas[Keys[Count]].Height;
+
+    mSWMProtocol->BltWindow (
+                    mSWMProtocol,
+                    mImageHandle,
+                    pKeyImage[Count],
+                    EfiBltBufferToVideo,
+                    0,
+                    0,
+                    mOSK.KeyList[Keys[Count]].KeyDisplayHitRect.Left,
+                    mOSK.KeyList[Keys[Count]].KeyDisplayHitRect.Top,
+                    KeyWidth,
+                    KeyHeight,
+                    KeyWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+                    );
+  }
+
+  // The deselection has been rendered.
+  //
+  mOSK.DeselectKey = NUMBER_OF_KEYS;
+
+  return EFI_SUCCESS;
+}
+
 /**
 Renders the keyboard.
 
@@ -1112,13 +1603,15 @@ RenderKeyboard (
   IN BOOLEAN  bShowKeyLabels
   )
 {
-  EFI_STATUS             Status = EFI_SUCCESS;
-  UINTN                  KeyOrigX, KeyOrigY, KeyWidth, KeyHeight;
-  SWM_RECT               Rect;
-  UINT32                 KeyboardWidth, KeyboardHeight;
-  UINTN                  KeyLabelOrigX, KeyLabelOrigY;
-  UINTN                  Count;
-  EFI_FONT_DISPLAY_INFO  *StringInfo = NULL;
+  EFI_STATUS                     Status = EFI_SUCCESS;
+  UINTN                          KeyOrigX, KeyOrigY, KeyWidth, KeyHeight;
+  SWM_RECT                       Rect;
+  UINT32                         KeyboardWidth, KeyboardHeight;
+  UINTN                          KeyLabelOrigX, KeyLabelOrigY;
+  UINTN                          Count;
+  EFI_FONT_DISPLAY_INFO          *StringInfo = NULL;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  FillColor;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pKeyImage;
 
   // First check whether there's something to do.
   //
@@ -1246,6 +1739,12 @@ RenderKeyboard (
                       NULL
                       );
     }
+
+    // Key dimensions may have changed - make sure the key atlas matches them.
+    //
+    if (TRUE == bShowKeyLabels) {
+      RenderKeyAtlas (StringInfo);
+    }
   }
 
   // Draw each of the individual keys based on key mapping, keyboard modifier state, and color scheme
@@ -1265,28 +1764,47 @@ RenderKeyboard (
     KeyOrigX  =  mOSK.KeyList[Count].KeyDisplayHitRect.Left;
     KeyOrigY  =  mOSK.KeyList[Count].KeyDisplayHitRect.Top;
 
-    // Fill the key background with the correct color based on state
+    // Select the key fill and label colors based on state
+    //
+    GetKeyColors (
+      Count,
+      mOSK.KeyModifierState,
+      mOSK.pKeyMap,
+      (BOOLEAN)(mOSK.SelectedKey == Count),
+      &FillColor,
+      &StringInfo->ForegroundColor,
+      &StringInfo->BackgroundColor
+      );
+
+    // Blit the pre-rendered key if the key atlas has it in this state
     //
-    EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *pFillColor = mOSK.KeyList[Count].pKeyFillColor;
-
-    if ((Shift == mOSK.KeyModifierState) && ((EfiKeyLShift == mOSK.pKeyMap[Count].EfiKey) || (EfiKeyRShift == mOSK.pKeyMap[Count].EfiKey))) {
-      pFillColor = &gMsColorTable.KeyboardShiftStateKeyColor;
-    } else if ((CapsLock == mOSK.KeyModifierState) && ((EfiKeyLShift == mOSK.pKeyMap[Count].EfiKey) || (EfiKeyRShift == mOSK.pKeyMap[Count].EfiKey))) {
-      pFillColor = &gMsColorTable.KeyboardCapsLockStateKeyColor;
-    } else if (((NumSym == mOSK.KeyModifierState) || (Function == mOSK.KeyModifierState)) && ((EfiKeyLShift == mOSK.pKeyMap[Count].EfiKey) || (EfiKeyRShift == mOSK.pKeyMap[Count].EfiKey))) {
-      pFillColor = mOSK.KeyList[Count].pKeyFillColor;
-    } else if ((NumSym == mOSK.KeyModifierState) && (EfiKeyA0 == mOSK.pKeyMap[Count].EfiKey)) {
-      pFillColor = &gMsColorTable.KeyboardNumSymStateKeyColor;
-    } else if ((Function == mOSK.KeyModifierState) && (EfiKeyA2 == mOSK.pKeyMap[Count].EfiKey)) {
-      pFillColor = &gMsColorTable.KeyboardFunctionStateKeyColor;
-    } else if (mOSK.SelectedKey == Count) {
-      pFillColor = &gMsColorTable.KeyboardSelectedStateKeyColor;
+    if (TRUE == bShowKeyLabels) {
+      pKeyImage = GetKeyAtlasImage (Count, &FillColor, &StringInfo->ForegroundColor, &StringInfo->BackgroundColor);
+      if (NULL != pKeyImage) {
+        mSWMProtocol->BltWindow (
+                        mSWMProtocol,
+                        mImageHandle,
+                        pKeyImage,
+                        EfiBltBufferToVideo,
+                        0,
+                        0,
+                        KeyOrigX,
+                        KeyOrigY,
+                        KeyWidth,
+                        KeyHeight,
+                        KeyWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+                        );
+
+        continue;
+      }
     }
 
+    // Fill the key background with the correct color based on state
+    //
     mSWMProtocol->BltWindow (
                     mSWMProtocol,
                     mImageHandle,
-                    pFillColor,
+                    &FillColor,
                     EfiBltVideoFill,
                     0,
                     0,
@@ -1300,31 +1818,6 @@ RenderKeyboard (
     // Draw key text if requested
     //
     if (TRUE == bShowKeyLabels) {
-      // Use correct color for key text, based on state
-      //
-      if ((Shift == mOSK.KeyModifierState) && ((EfiKeyLShift == mOSK.pKeyMap[Count].EfiKey) || (EfiKeyRShift == mOSK.pKeyMap[Count].EfiKey))) {
-        CopyMem (&StringInfo->ForegroundColor, &gMsColorTable.KeyboardShiftStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-        CopyMem (&StringInfo->BackgroundColor, &gMsColorTable.KeyboardShiftStateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-      } else if ((CapsLock == mOSK.KeyModifierState) && ((EfiKeyLShift == mOSK.pKeyMap[Count].EfiKey) || (EfiKeyRShift == mOSK.pKeyMap[Count].EfiKey))) {
-        CopyMem (&StringInfo->ForegroundColor, &gMsColorTable.KeyboardCapsLockStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-        CopyMem (&StringInfo->BackgroundColor, &gMsColorTable.KeyboardCapsLockStateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-      } else if (((NumSym == mOSK.KeyModifierState) || (Function == mOSK.KeyModifierState)) && ((EfiKeyLShift == mOSK.pKeyMap[Count].EfiKey) || (EfiKeyRShift == mOSK.pKeyMap[Count].EfiKey))) {
-        CopyMem (&StringInfo->ForegroundColor, &gMsColorTable.KeyboardNumSymStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));                    // Gray-out shift keys in these modes
-        CopyMem (&StringInfo->BackgroundColor, mOSK.KeyList[Count].pKeyFillColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-      } else if ((NumSym == mOSK.KeyModifierState) && (EfiKeyA0 == mOSK.pKeyMap[Count].EfiKey)) {
-        CopyMem (&StringInfo->ForegroundColor, &gMsColorTable.KeyboardNumSymA0StateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-        CopyMem (&StringInfo->BackgroundColor, &gMsColorTable.KeyboardNumSymA0StateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-      } else if ((Function == mOSK.KeyModifierState) && (EfiKeyA2 == mOSK.pKeyMap[Count].EfiKey)) {
-        CopyMem (&StringInfo->ForegroundColor, &gMsColorTable.KeyboardFunctionStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-        CopyMem (&StringInfo->BackgroundColor, &gMsColorTable.KeyboardFunctionStateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-      } else if (mOSK.SelectedKey == Count) {
-        CopyMem (&StringInfo->ForegroundColor, &gMsColorTable.KeyboardSelectedStateFGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-        CopyMem (&StringInfo->BackgroundColor, &gMsColorTable.KeyboardSelectedStateBGColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-      } else {
-        CopyMem (&StringInfo->ForegroundColor, mOSK.KeyList[Count].pKeyLabelColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-        CopyMem (&StringInfo->BackgroundColor, mOSK.KeyList[Count].pKeyFillColor, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-      }
-
       // Select preferred font size/style.
       //
       StringInfo->FontInfoMask = EFI_FONT_INFO_ANY_FONT;
@@ -1389,6 +1882,13 @@ RenderKeyboard (
                   TRUE
                   );
 
+  // Track the key mapping and modifier state the whole keyboard was rendered with.
+  //
+  if ((TRUE == mOSK.bKeyboardSizeChanged) || (TRUE == mOSK.bKeyboardStateChanged)) {
+    mOSK.pRenderedKeyMap       = mOSK.pKeyMap;
+    mOSK.RenderedModifierState = mOSK.KeyModifierState;
+  }
+
   // If there is no selected key, we may have just rendered a key deselection.  Now that
   // we're done rendering, clear the deselection state.
   //
@@ -2432,6 +2932,20 @@ Exit:
   return Status;
 }
 
+STATIC
+BOOLEAN
+IsKeyHit (
+  IN UINTN  TouchX,
+  IN UINTN  TouchY,
+  IN UINTN  KeyNumber
+  )
+{
+  return (BOOLEAN)((TouchX >= mOSK.KeyList[KeyNumber].KeyDisplayHitRect.Left) &&
+                   (TouchX <= mOSK.KeyList[KeyNumber].KeyDisplayHitRect.Right) &&
+                   (TouchY >= mOSK.KeyList[KeyNumber].KeyDisplayHitRect.Top) &&
+                   (TouchY <= mOSK.KeyList[KeyNumber].KeyDisplayHitRect.Bottom));
+}
+
 EFI_STATUS
 CheckForKeyHit (
   IN  UINTN  TouchX,
@@ -2439,17 +2953,40 @@ CheckForKeyHit (
   OUT UINTN  *pKeyNumber
   )
 {
-  UINTN  Count;
+  KEY_HIT_GRID  *pGrid = &mOSK.KeyHitGrid;
+  UINTN         Row, Column;
+  UINTN         KeyCount;
+  UINTN         Count;
 
-  // TODO - need to optimize this routine and/or point set...
+  // Nothing can be hit outside of the area covered by the key hit-test grid.
+  //
+  if ((0 == pGrid->Width) ||
+      (TouchX < pGrid->Left) || ((TouchX - pGrid->Left) >= pGrid->Width) ||
+      (TouchY < pGrid->Top) || ((TouchY - pGrid->Top) >= pGrid->Height))
+  {
+    return EFI_NOT_FOUND;
+  }
 
-  for (Count = 0; Count < NUMBER_OF_KEYS; Count++) {
-    if ((TouchX >= mOSK.KeyList[Count].KeyDisplayHitRect.Left) &&
-        (TouchX <= mOSK.KeyList[Count].KeyDisplayHitRect.Right) &&
-        (TouchY >= mOSK.KeyList[Count].KeyDisplayHitRect.Top) &&
-        (TouchY <= mOSK.KeyList[Count].KeyDisplayHitRect.Bottom))
-    {
-      *pKeyNumber = Count;
+  Column   = GetKeyHitGridCell (TouchX, pGrid->Left, pGrid->Width, KEY_HIT_GRID_COLUMNS);
+  Row      = GetKeyHitGridCell (TouchY, pGrid->Top, pGrid->Height, KEY_HIT_GRID_ROWS);
+  KeyCount = pGrid->KeyCount[Row][Column];
+
+  // Crowded cells don't list their keys - search all of them.
+  //
+  if (KEY_HIT_GRID_CELL_OVERFLOW == KeyCount) {
+    for (Count = 0; Count < NUMBER_OF_KEYS; Count++) {
+      if (IsKeyHit (TouchX, TouchY, Count)) {
+        *pKeyNumber = Count;
+        return EFI_SUCCESS;
+      }
+    }
+
+    return EFI_NOT_FOUND;
+  }
+
+  for (Count = 0; Count < KeyCount; Count++) {
+    if (IsKeyHit (TouchX, TouchY, pGrid->Keys[Row][Column][Count])) {
+      *pKeyNumber = pGrid->Keys[Row][Column][Count];
       return EFI_SUCCESS;
     }
   }
@@ -2792,10 +3329,14 @@ RefreshKeyboard:
   mOSK.DeselectKey = mOSK.SelectedKey;
   mOSK.SelectedKey = (TRUE == bFingerDown ? KeyNumber : NUMBER_OF_KEYS);
 
-  // Render the keyboard with key text (key mapping/text may have changed) if it should be displayed.
+  // Render the keyboard with key text (key mapping/text may have changed) if it should be displayed.  When
+  // only the key selection changed, just the affected keys are redrawn from the key atlas.
   //
   if (TRUE == mOSK.bDisplayKeyboard) {
-    RenderKeyboard (TRUE);
+    Status = RenderSelectedKeys ();
+    if (EFI_ERROR (Status)) {
+      RenderKeyboard (TRUE);
+    }
   }
 
 Exit:
@@ -3122,6 +3663,7 @@ OSKDriverInit (
   mOSK.SimpleTextInEx.UnregisterKeyNotify = OSKUnregisterKeyNotify;
 
   mOSK.pBackBuffer = NULL;
+  mOSK.pKeyAtlas   = NULL;
 
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &mControllerHandle,
@@ -1,7 +1,7 @@
 /** @file
 PrintScreenLogger.c
 
-PrintScreen logger to capture UEFI menus into a BMP written to a USB key
+PrintScreen logger to capture UEFI menus into a PNG or BMP written to a USB key
 
 Copyright (C) Microsoft Corporation. All rights reserved.
 SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -179,163 +179,6 @@ CleanUp:
   return Status;
 }
 
-/**
-  Convert a Gop 32 bits per pixel video frame buffer to a
-  24 bits per pixel *.BMP graphics image
-
-  @param  BmpFileName   Name of file to create
-  @param  Gop           GRAPHICS_OUTPUT_PROTOCOL
-  @param  BltBuffer     Buffer containing GOP version of BmpImage.
-
-  @retval EFI_SUCCESS           GopBlt and GopBltSize are returned.
-  @retval EFI_UNSUPPORTED       BmpImage is not a valid *.BMP image
-  @retval EFI_BUFFER_TOO_SMALL  The passed in GopBlt buffer is not big enough.
-                                GopBltSize will contain the required size.
-  @retval EFI_OUT_OF_RESOURCES  No enough buffer to allocate.
-
-**/
-EFI_STATUS
-WriteBmpToFile (
-  IN EFI_FILE_PROTOCOL  *FileHandle
-  )
-{
-  EFI_STATUS                     Status;
-  BMP_IMAGE_HEADER               *BmpHeader;
-  UINTN                          DataSizePerLine;
-  UINTN                          BmpBufferSize;
-  UINT8                          *Image;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *BltBuffer;
-  UINT32                         Height;
-  UINT32                         Width;
-  UINT64                         WriteSize;
-
-  EFI_GRAPHICS_OUTPUT_PROTOCOL  *Gop;
-
-  #define BMP_BITS_PER_PIXEL  24
-
-  BmpHeader = NULL;
-  BltBuffer = NULL;
-
-  Status = gBS->LocateProtocol (
-                  &gEfiGraphicsOutputProtocolGuid,
-                  NULL,
-                  (VOID **)&Gop
-                  );
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Unable to locate Gop protocol\n"));
-    return Status;
-  }
-
-  if ((Gop->Mode->Info->PixelFormat != PixelRedGreenBlueReserved8BitPerColor) &&
-      (Gop->Mode->Info->PixelFormat != PixelBlueGreenRedReserved8BitPerColor))
-  {
-    DEBUG ((DEBUG_ERROR, "%a: Unsupported video mode\n", __FUNCTION__));
-    return EFI_UNSUPPORTED;
-  }
-
-  BltBuffer = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)AllocatePool (Gop->Mode->FrameBufferSize);
-  if (NULL == BltBuffer) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  Height = Gop->Mode->Info->VerticalResolution;
-  Width  = Gop->Mode->Info->HorizontalResolution;
-
-  Status = Gop->Blt (
-                  Gop,
-                  BltBuffer,
-                  EfiBltVideoToBltBuffer,
-                  0,
-                  0,
-                  0,
-                  0,
-                  Width,
-                  Height,
-                  0
-                  );
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Unable to BLt video to buffer, code=%r\n", Status));
-    goto ErrorExit;
-  }
-
-  DataSizePerLine = ((Gop->Mode->Info->HorizontalResolution * BMP_BITS_PER_PIXEL + 31) >> 3) & (~0x3);
-  BmpBufferSize   = MultU64x32 (DataSizePerLine, Gop->Mode->Info->VerticalResolution) + sizeof (BMP_IMAGE_HEADER) + ((sizeof (BMP_IMAGE_HEADER) + 3) & ~0x03);
-
-  if (BmpBufferSize > (UINT32) ~0) {
-    Status = EFI_INVALID_PARAMETER;
-    goto ErrorExit;
-  }
-
-  BmpHeader = AllocateZeroPool (BmpBufferSize);   // Insure unfilled area is zeroed
-  if (NULL == BmpHeader) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto ErrorExit;
-  }
-
-  Status = EFI_SUCCESS;
-
-  BmpHeader->CharB           = 'B';   // Header flag
-  BmpHeader->CharM           = 'M';
-  BmpHeader->Size            = (UINT32)BmpBufferSize;
-  BmpHeader->Reserved[0]     = 0;
-  BmpHeader->Reserved[1]     = 0;
-  BmpHeader->ImageOffset     = (sizeof (BMP_IMAGE_HEADER) + 3) & ~0x03; // Start first row on 4 byte boundary
-  BmpHeader->HeaderSize      = sizeof (BMP_IMAGE_HEADER) - OFFSET_OF (BMP_IMAGE_HEADER, HeaderSize);
-  BmpHeader->PixelWidth      = Width;
-  BmpHeader->PixelHeight     = Height;
-  BmpHeader->Planes          = 1;
-  BmpHeader->BitPerPixel     = 24;
-  BmpHeader->CompressionType = 0;     // Not Compressed
-  BmpHeader->ImageSize       = 0;
-  BmpHeader->XPixelsPerMeter = 11000;    // Approximately 300 dpi
-  BmpHeader->YPixelsPerMeter = 11000;
-  BmpHeader->NumberOfColors  = 0;
-  BmpHeader->ImportantColors = 0;
-
-  Image = ((UINT8 *)BmpHeader) + BmpHeader->ImageOffset;
-
-  for (Height = 0; Height < BmpHeader->PixelHeight; Height++) {
-    Blt = &BltBuffer[(BmpHeader->PixelHeight - Height - 1) * BmpHeader->PixelWidth];
-    for (Width = 0; Width < BmpHeader->PixelWidth; Width++, Blt++) {
-      if (Gop->Mode->Info->PixelFormat == PixelRedGreenBlueReserved8BitPerColor) {
-        *Image++ = Blt->Red;
-        *Image++ = Blt->Green;
-        *Image++ = Blt->Blue;
-      } else {
-        // PixelBlueGreenRedReserved8BitPerColor
-        *Image++ = Blt->Blue;
-        *Image++ = Blt->Green;
-        *Image++ = Blt->Red;
-      }
-    }
-
-    Image = (UINT8 *)(((UINT64)Image + 3) & ~0x03);        // Start next row on 4 byte boundary.
-  }
-
-  WriteSize = BmpBufferSize;
-  Status    = FileHandle->Write (FileHandle, &WriteSize, BmpHeader);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Error writing Bmp file. Code=%r\n", Status));
-  }
-
-  if (WriteSize != BmpBufferSize) {
-    DEBUG ((DEBUG_ERROR, "Wrong number of bytes written.  S/B=%ld, Actual=%ld\n", BmpBufferSize, WriteSize));
-    Status = EFI_BAD_BUFFER_SIZE;
-  }
-
-ErrorExit:
-  if (BltBuffer != NULL) {
-    FreePool (BltBuffer);
-  }
-
-  if (BmpHeader != NULL) {
-    FreePool (BmpHeader);
-  }
-
-  return Status;
-}
-
 /**
   Handler for hot key notification
 
@@ -353,7 +196,8 @@ PrintScreenCallback (
 {
   EFI_FILE_PROTOCOL  *FileHandle;
   UINTN              Index;
-  CHAR16             PrtScrnFileName[] = L"PrtScreen####.bmp";
+  CHAR16             PrtScrnFileName[] = L"PrtScreen####.xxx";
+  CHAR16             *Extension;
   EFI_STATUS         Status;
   EFI_STATUS         Status2;
   EFI_FILE_PROTOCOL  *VolumeHandle;
@@ -386,7 +230,8 @@ PrintScreenCallback (
     //
     // 2. Find the first value of PrtScreen#### that is available
     //
-    Index = 0;
+    Index     = 0;
+    Extension = FeaturePcdGet (PcdPrintScreenLoggerPngEnable) ? L"png" : L"bmp";
 
     do {
       Index++;
@@ -394,7 +239,7 @@ PrintScreenCallback (
         goto Exit;
       }
 
-      UnicodeSPrint (PrtScrnFileName, sizeof (PrtScrnFileName), L"PrtScreen%04d.bmp", Index);
+      UnicodeSPrint (PrtScrnFileName, sizeof (PrtScrnFileName), L"PrtScreen%04d.%s", Index, Extension);
       Status = VolumeHandle->Open (VolumeHandle, &FileHandle, PrtScrnFileName, EFI_FILE_MODE_READ, 0);
       if (!EFI_ERROR (Status)) {
         if (Index % PRINT_SCREEN_DEBUG_WARNING == 0) {
@@ -415,7 +260,7 @@ PrintScreenCallback (
     } while (TRUE);
 
     //
-    // 3. Create the new file that will contain the bitmap
+    // 3. Create the new file that will contain the image
     //
     Status = VolumeHandle->Open (VolumeHandle, &FileHandle, PrtScrnFileName, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE, EFI_FILE_ARCHIVE);
     if (EFI_ERROR (Status)) {
@@ -426,13 +271,13 @@ PrintScreenCallback (
     //
     // 4. Write the contents of the display to the new file
     //
-    Status = WriteBmpToFile (FileHandle);
+    Status = WriteScreenToFile (FileHandle);
     if (!EFI_ERROR (Status)) {
       DEBUG ((DEBUG_INFO, "%a: Screen captured to file %s.\n", __FUNCTION__, PrtScrnFileName));
     }
 
     //
-    // 4. Close the bitmap file
+    // 4. Close the image file
     //
     Status2 = FileHandle->Close (FileHandle);
     if (EFI_ERROR (Status2)) {
@@ -1,7 +1,7 @@
 /** @file
 PrintScreenLogger.h
 
-PrintScreen logger to capture UEFI menus into a BMP written to a USB key
+PrintScreen logger to capture UEFI menus into a PNG or BMP written to a USB key
 
 Copyright (C) Microsoft Corporation. All rights reserved.
 SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -20,9 +20,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/SimpleTextInEx.h>
 
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/DevicePathLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
 #include <Library/PrintLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
@@ -40,4 +42,29 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 // 3 seconds in 100ns intervals = 3 * ms in 1 second * us in 1 ms * 100ns in 1us
 #define PRINT_SCREEN_DELAY  (3 * 1000           * 1000       * 10)
 
+//
+// The display is captured a band of rows at a time, bounded by PRINT_SCREEN_BAND_SIZE bytes
+// of Blt pixels, and the encoded image is written to the file in PRINT_SCREEN_WRITE_CHUNK_SIZE
+// writes.
+//
+#define PRINT_SCREEN_BAND_SIZE         SIZE_1MB
+#define PRINT_SCREEN_WRITE_CHUNK_SIZE  SIZE_256KB
+
+/**
+  Write the contents of the display to a file in the format selected by
+  PcdPrintScreenLoggerPngEnable.
+
+  @param  FileHandle            File to write to.
+
+  @retval EFI_SUCCESS           The display was captured to the file.
+  @retval EFI_UNSUPPORTED       The video mode is not supported.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory to capture the display.
+  @retval Others                The capture or write failed.
+
+**/
+EFI_STATUS
+WriteScreenToFile (
+  IN EFI_FILE_PROTOCOL  *FileHandle
+  );
+
 #endif // __PRINTSCREEN_LOGGER_H__
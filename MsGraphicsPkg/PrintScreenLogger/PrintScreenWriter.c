@@ -0,0 +1,700 @@
+/** @file
+PrintScreenWriter.c
+
+Streams the contents of the display to a file, either as a compressed PNG or as
+an uncompressed 24bpp BMP.  The display is read a band of rows at a time and the
+encoded image is written in large chunks, so memory use is bounded regardless of
+the display resolution.
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "PrintScreenLogger.h"
+
+#define BMP_BITS_PER_PIXEL    24
+#define RGB_BYTES_PER_PIXEL   3
+#define PNG_FILTER_SUB        1
+#define PNG_FILTER_UP         2
+#define PNG_CHUNK_HEADER_SIZE 8                 // Length + Type
+#define PNG_CHUNK_CRC_SIZE    4
+#define DEFLATE_MAX_MATCH     258
+#define DEFLATE_MIN_MATCH     3
+#define ADLER_MODULUS         65521
+#define ADLER_MAX_RUN         5552              // Largest run that cannot overflow the 32 bit sums
+
+STATIC CONST UINT8  mPngSignature[] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+//
+// Deflate length codes 257..285 (RFC 1951 section 3.2.5)
+//
+STATIC CONST UINT16  mLengthBase[] = {
+  3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+STATIC CONST UINT8  mLengthExtraBits[] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+  2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+//
+// State for streaming the zlib compressed image data into IDAT chunks.
+// Runs of repeated bytes are encoded as distance 1 matches in a single fixed Huffman block,
+// which suits the flat areas of UEFI menus once rows are filtered.
+//
+typedef struct {
+  EFI_FILE_PROTOCOL    *FileHandle;
+  UINT8                *Chunk;                   // IDAT chunk being assembled, including header and CRC
+  UINTN                ChunkDataSize;            // Bytes of data in the current IDAT chunk
+  UINTN                ChunkDataCapacity;
+  UINT32               BitBuffer;
+  UINTN                BitCount;
+  UINT8                RunByte;
+  UINTN                RunLength;                // Repeats of RunByte not yet encoded
+  BOOLEAN              HaveRunByte;
+  UINT32               AdlerA;
+  UINT32               AdlerB;
+  EFI_STATUS           Status;                   // First error, later output is discarded
+} PNG_STREAM;
+
+/**
+  Write a buffer to the capture file.
+
+  @param  FileHandle    File to write to.
+  @param  Buffer        Data to write.
+  @param  BufferSize    Number of bytes to write.
+
+  @retval EFI_SUCCESS           All of the data was written.
+  @retval EFI_BAD_BUFFER_SIZE   Only part of the data was written.
+  @retval Others                The write failed.
+
+**/
+STATIC
+EFI_STATUS
+WriteCaptureData (
+  IN EFI_FILE_PROTOCOL  *FileHandle,
+  IN VOID               *Buffer,
+  IN UINTN              BufferSize
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       WriteSize;
+
+  WriteSize = BufferSize;
+  Status    = FileHandle->Write (FileHandle, &WriteSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Error writing screen capture file. Code=%r\n", Status));
+    return Status;
+  }
+
+  if (WriteSize != BufferSize) {
+    DEBUG ((DEBUG_ERROR, "Wrong number of bytes written.  S/B=%ld, Actual=%ld\n", BufferSize, WriteSize));
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Store a 32 bit value in network (big endian) byte order, as PNG requires.
+
+  @param  Buffer    Where to store the value.
+  @param  Value     Value to store.
+
+**/
+STATIC
+VOID
+PutBigEndian32 (
+  OUT UINT8  *Buffer,
+  IN  UINT32  Value
+  )
+{
+  Buffer[0] = (UINT8)(Value >> 24);
+  Buffer[1] = (UINT8)(Value >> 16);
+  Buffer[2] = (UINT8)(Value >> 8);
+  Buffer[3] = (UINT8)Value;
+}
+
+/**
+  Complete a PNG chunk whose type and data are already in place, and write it.
+
+  @param  FileHandle    File to write to.
+  @param  Chunk         Buffer holding PNG_CHUNK_HEADER_SIZE + DataSize + PNG_CHUNK_CRC_SIZE bytes.
+  @param  DataSize      Size of the chunk data.
+
+  @retval EFI_SUCCESS   The chunk was written.
+  @retval Others        The CRC could not be computed, or the write failed.
+
+**/
+STATIC
+EFI_STATUS
+WritePngChunk (
+  IN EFI_FILE_PROTOCOL  *FileHandle,
+  IN UINT8              *Chunk,
+  IN UINTN              DataSize
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Crc;
+
+  PutBigEndian32 (Chunk, (UINT32)DataSize);
+
+  // The CRC covers the chunk type and data, but not the length
+  Status = gBS->CalculateCrc32 (Chunk + 4, 4 + DataSize, &Crc);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  PutBigEndian32 (Chunk + PNG_CHUNK_HEADER_SIZE + DataSize, Crc);
+
+  return WriteCaptureData (FileHandle, Chunk, PNG_CHUNK_HEADER_SIZE + DataSize + PNG_CHUNK_CRC_SIZE);
+}
+
+/**
+  Write the IDAT chunk being assembled, and start a new one.
+
+  @param  Stream    The PNG stream.
+
+**/
+STATIC
+VOID
+PngFlushChunk (
+  IN OUT PNG_STREAM  *Stream
+  )
+{
+  if ((Stream->ChunkDataSize > 0) && !EFI_ERROR (Stream->Status)) {
+    Stream->Status = WritePngChunk (Stream->FileHandle, Stream->Chunk, Stream->ChunkDataSize);
+  }
+
+  Stream->ChunkDataSize = 0;
+}
+
+/**
+  Append a byte of compressed data to the current IDAT chunk.
+
+  @param  Stream    The PNG stream.
+  @param  Byte      The byte to append.
+
+**/
+STATIC
+VOID
+PngPutByte (
+  IN OUT PNG_STREAM  *Stream,
+  IN     UINT8       Byte
+  )
+{
+  Stream->Chunk[PNG_CHUNK_HEADER_SIZE + Stream->ChunkDataSize++] = Byte;
+  if (Stream->ChunkDataSize == Stream->ChunkDataCapacity) {
+    PngFlushChunk (Stream);
+  }
+}
+
+/**
+  Append bits to the deflate stream, least significant bit first.
+
+  @param  Stream    The PNG stream.
+  @param  Value     The bits to append.
+  @param  Count     Number of bits in Value, at most 16.
+
+**/
+STATIC
+VOID
+PngPutBits (
+  IN OUT PNG_STREAM  *Stream,
+  IN     UINT32      Value,
+  IN     UINTN       Count
+  )
+{
+  Stream->BitBuffer |= Value << Stream->BitCount;
+  Stream->BitCount  += Count;
+  while (Stream->BitCount >= 8) {
+    PngPutByte (Stream, (UINT8)Stream->BitBuffer);
+    Stream->BitBuffer >>= 8;
+    Stream->BitCount   -= 8;
+  }
+}
+
+/**
+  Append a Huffman code to the deflate stream.  Huffman codes are packed most
+  significant bit first.
+
+  @param  Stream    The PNG stream.
+  @param  Code      The Huffman code.
+  @param  Length    Number of bits in Code.
+
+**/
+STATIC
+VOID
+PngPutHuffman (
+  IN OUT PNG_STREAM  *Stream,
+  IN     UINT32      Code,
+  IN     UINTN       Length
+  )
+{
+  UINT32  Reversed;
+  UINTN   Index;
+
+  Reversed = 0;
+  for (Index = 0; Index < Length; Index++) {
+    Reversed = (Reversed << 1) | ((Code >> Index) & 1);
+  }
+
+  PngPutBits (Stream, Reversed, Length);
+}
+
+/**
+  Append a literal/length symbol using the fixed Huffman code (RFC 1951 section 3.2.6).
+
+  @param  Stream    The PNG stream.
+  @param  Symbol    Literal/length symbol, 0..287.
+
+**/
+STATIC
+VOID
+PngPutSymbol (
+  IN OUT PNG_STREAM  *Stream,
+  IN     UINT32      Symbol
+  )
+{
+  if (Symbol <= 143) {
+    PngPutHuffman (Stream, 0x30 + Symbol, 8);
+  } else if (Symbol <= 255) {
+    PngPutHuffman (Stream, 0x190 + (Symbol - 144), 9);
+  } else if (Symbol <= 279) {
+    PngPutHuffman (Stream, Symbol - 256, 7);
+  } else {
+    PngPutHuffman (Stream, 0xC0 + (Symbol - 280), 8);
+  }
+}
+
+/**
+  Encode the pending run of RunByte, as a distance 1 match when it is long enough.
+
+  @param  Stream    The PNG stream.
+
+**/
+STATIC
+VOID
+PngFlushRun (
+  IN OUT PNG_STREAM  *Stream
+  )
+{
+  UINTN  Index;
+
+  if (Stream->RunLength < DEFLATE_MIN_MATCH) {
+    for ( ; Stream->RunLength > 0; Stream->RunLength--) {
+      PngPutSymbol (Stream, Stream->RunByte);
+    }
+
+    return;
+  }
+
+  for (Index = ARRAY_SIZE (mLengthBase) - 1; mLengthBase[Index] > Stream->RunLength; Index--) {
+  }
+
+  PngPutSymbol (Stream, (UINT32)(257 + Index));
+  PngPutBits (Stream, (UINT32)(Stream->RunLength - mLengthBase[Index]), mLengthExtraBits[Index]);
+  PngPutHuffman (Stream, 0, 5);         // Distance code 0 is a distance of 1
+  Stream->RunLength = 0;
+}
+
+/**
+  Compress uncompressed (filtered) image data into the stream.
+
+  @param  Stream    The PNG stream.
+  @param  Data      Filtered scanline data.
+  @param  Size      Number of bytes in Data.
+
+**/
+STATIC
+VOID
+PngCompress (
+  IN OUT PNG_STREAM  *Stream,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        Size
+  )
+{
+  UINTN  Index;
+  UINTN  Run;
+
+  // zlib checksum of the uncompressed data
+  for (Index = 0; Index < Size; ) {
+    for (Run = MIN (Size - Index, ADLER_MAX_RUN); Run > 0; Run--, Index++) {
+      Stream->AdlerA += Data[Index];
+      Stream->AdlerB += Stream->AdlerA;
+    }
+
+    Stream->AdlerA %= ADLER_MODULUS;
+    Stream->AdlerB %= ADLER_MODULUS;
+  }
+
+  for (Index = 0; Index < Size; Index++) {
+    if (Stream->HaveRunByte && (Data[Index] == Stream->RunByte)) {
+      Stream->RunLength++;
+      if (Stream->RunLength == DEFLATE_MAX_MATCH) {
+        PngFlushRun (Stream);
+      }
+
+      continue;
+    }
+
+    PngFlushRun (Stream);
+    PngPutSymbol (Stream, Data[Index]);
+    Stream->RunByte     = Data[Index];
+    Stream->HaveRunByte = TRUE;
+  }
+}
+
+/**
+  Stream the display to a file as a PNG image.
+
+  @param  FileHandle    File to write to.
+  @param  Gop           Graphics output protocol to capture.
+  @param  Band          Buffer of BandRows rows of Gop->Blt pixels.
+  @param  BandRows      Number of rows that fit in Band.
+
+  @retval EFI_SUCCESS   The image was written.
+  @retval Others        The capture or write failed.
+
+**/
+STATIC
+EFI_STATUS
+WritePngToFile (
+  IN EFI_FILE_PROTOCOL              *FileHandle,
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL   *Gop,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Band,
+  IN UINTN                          BandRows
+  )
+{
+  EFI_STATUS                     Status;
+  PNG_STREAM                     Stream;
+  UINT8                          Header[PNG_CHUNK_HEADER_SIZE + 13 + PNG_CHUNK_CRC_SIZE];
+  UINT8                          *Row;
+  UINT8                          *PreviousRow;
+  UINT8                          *Swap;
+  UINT8                          *Pixel;
+  UINT8                          Filter;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt;
+  UINTN                          RowSize;
+  UINTN                          Width;
+  UINTN                          Height;
+  UINTN                          Rows;
+  UINTN                          Y;
+  UINTN                          BandY;
+  UINTN                          X;
+
+  Width   = Gop->Mode->Info->HorizontalResolution;
+  Height  = Gop->Mode->Info->VerticalResolution;
+  RowSize = Width * RGB_BYTES_PER_PIXEL;
+
+  ZeroMem (&Stream, sizeof (Stream));
+  Stream.FileHandle        = FileHandle;
+  Stream.ChunkDataCapacity = PRINT_SCREEN_WRITE_CHUNK_SIZE;
+  Stream.AdlerA            = 1;
+  Stream.Chunk             = AllocatePool (PNG_CHUNK_HEADER_SIZE + Stream.ChunkDataCapacity + PNG_CHUNK_CRC_SIZE);
+  Row                      = AllocatePool (RowSize);
+  PreviousRow              = AllocateZeroPool (RowSize);
+  if ((Stream.Chunk == NULL) || (Row == NULL) || (PreviousRow == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  CopyMem (Stream.Chunk + 4, "IDAT", 4);
+
+  //
+  // Signature and IHDR
+  //
+  Status = WriteCaptureData (FileHandle, (VOID *)mPngSignature, sizeof (mPngSignature));
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  CopyMem (Header + 4, "IHDR", 4);
+  PutBigEndian32 (Header + PNG_CHUNK_HEADER_SIZE, (UINT32)Width);
+  PutBigEndian32 (Header + PNG_CHUNK_HEADER_SIZE + 4, (UINT32)Height);
+  Header[PNG_CHUNK_HEADER_SIZE + 8]  = 8;       // Bit depth
+  Header[PNG_CHUNK_HEADER_SIZE + 9]  = 2;       // Color type RGB
+  Header[PNG_CHUNK_HEADER_SIZE + 10] = 0;       // Deflate
+  Header[PNG_CHUNK_HEADER_SIZE + 11] = 0;       // Adaptive filtering
+  Header[PNG_CHUNK_HEADER_SIZE + 12] = 0;       // No interlace
+  Status                             = WritePngChunk (FileHandle, Header, 13);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  //
+  // zlib header (deflate, 32K window), then a single final fixed Huffman block
+  //
+  PngPutByte (&Stream, 0x78);
+  PngPutByte (&Stream, 0x01);
+  PngPutBits (&Stream, 1, 1);                   // BFINAL
+  PngPutBits (&Stream, 1, 2);                   // BTYPE fixed Huffman
+
+  for (BandY = 0; (BandY < Height) && !EFI_ERROR (Stream.Status); BandY += Rows) {
+    Rows   = MIN (BandRows, Height - BandY);
+    Status = Gop->Blt (Gop, Band, EfiBltVideoToBltBuffer, 0, BandY, 0, 0, Width, Rows, 0);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Unable to BLt video to buffer, code=%r\n", Status));
+      goto Exit;
+    }
+
+    for (Y = 0; Y < Rows; Y++) {
+      Blt   = &Band[Y * Width];
+      Pixel = Row;
+      for (X = 0; X < Width; X++, Blt++) {
+        if (Gop->Mode->Info->PixelFormat == PixelRedGreenBlueReserved8BitPerColor) {
+          *Pixel++ = Blt->Blue;
+          *Pixel++ = Blt->Green;
+          *Pixel++ = Blt->Red;
+        } else {
+          // PixelBlueGreenRedReserved8BitPerColor
+          *Pixel++ = Blt->Red;
+          *Pixel++ = Blt->Green;
+          *Pixel++ = Blt->Blue;
+        }
+      }
+
+      // A row that repeats the one above filters to all zeros with Up, otherwise Sub
+      // turns horizontal runs of a color into runs of zeros.
+      if (((BandY + Y) > 0) && (CompareMem (Row, PreviousRow, RowSize) == 0)) {
+        // PreviousRow already holds this row
+        ZeroMem (Row, RowSize);
+        Filter = PNG_FILTER_UP;
+      } else {
+        // Filter in place from the end of the row, PreviousRow keeps the unfiltered copy
+        CopyMem (PreviousRow, Row, RowSize);
+        for (X = RowSize - 1; X >= RGB_BYTES_PER_PIXEL; X--) {
+          Row[X] = (UINT8)(Row[X] - Row[X - RGB_BYTES_PER_PIXEL]);
+        }
+
+        Filter = PNG_FILTER_SUB;
+      }
+
+      PngCompress (&Stream, &Filter, 1);
+      PngCompress (&Stream, Row, RowSize);
+    }
+  }
+
+  //
+  // End of block, zlib Adler-32 trailer, final IDAT and IEND
+  //
+  PngFlushRun (&Stream);
+  PngPutSymbol (&Stream, 256);
+  if (Stream.BitCount > 0) {
+    PngPutBits (&Stream, 0, 8 - Stream.BitCount);   // Pad to a byte boundary
+  }
+
+  PngPutByte (&Stream, (UINT8)(Stream.AdlerB >> 8));
+  PngPutByte (&Stream, (UINT8)Stream.AdlerB);
+  PngPutByte (&Stream, (UINT8)(Stream.AdlerA >> 8));
+  PngPutByte (&Stream, (UINT8)Stream.AdlerA);
+  PngFlushChunk (&Stream);
+
+  Status = Stream.Status;
+  if (!EFI_ERROR (Status)) {
+    CopyMem (Header + 4, "IEND", 4);
+    Status = WritePngChunk (FileHandle, Header, 0);
+  }
+
+Exit:
+  if (Stream.Chunk != NULL) {
+    FreePool (Stream.Chunk);
+  }
+
+  if (Row != NULL) {
+    FreePool (Row);
+  }
+
+  if (PreviousRow != NULL) {
+    FreePool (PreviousRow);
+  }
+
+  return Status;
+}
+
+/**
+  Stream the display to a file as a 24 bits per pixel BMP image.
+
+  @param  FileHandle    File to write to.
+  @param  Gop           Graphics output protocol to capture.
+  @param  Band          Buffer of BandRows rows of Gop->Blt pixels.
+  @param  BandRows      Number of rows that fit in Band.
+
+  @retval EFI_SUCCESS   The image was written.
+  @retval Others        The capture or write failed.
+
+**/
+STATIC
+EFI_STATUS
+WriteBmpToFile (
+  IN EFI_FILE_PROTOCOL              *FileHandle,
+  IN EFI_GRAPHICS_OUTPUT_PROTOCOL   *Gop,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Band,
+  IN UINTN                          BandRows
+  )
+{
+  EFI_STATUS                     Status;
+  BMP_IMAGE_HEADER               *BmpHeader;
+  UINT8                          *Buffer;
+  UINT8                          *Image;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Blt;
+  UINTN                          DataSizePerLine;
+  UINTN                          BufferSize;
+  UINTN                          Used;
+  UINT64                         BmpFileSize;
+  UINTN                          Width;
+  UINTN                          Height;
+  UINTN                          Rows;
+  UINTN                          BandY;
+  UINTN                          Y;
+  UINTN                          X;
+
+  Width           = Gop->Mode->Info->HorizontalResolution;
+  Height          = Gop->Mode->Info->VerticalResolution;
+  DataSizePerLine = ((Width * BMP_BITS_PER_PIXEL + 31) >> 3) & (~0x3);
+  BmpFileSize     = MultU64x32 (DataSizePerLine, (UINT32)Height) + ((sizeof (BMP_IMAGE_HEADER) + 3) & ~0x03);
+
+  if (BmpFileSize > (UINT32) ~0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // Stage whole rows, and at least the header, between writes
+  BufferSize = MAX (PRINT_SCREEN_WRITE_CHUNK_SIZE, DataSizePerLine + sizeof (BMP_IMAGE_HEADER) + 3);
+  Buffer     = AllocateZeroPool (BufferSize);   // Insure row padding is zeroed
+  if (NULL == Buffer) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  BmpHeader                  = (BMP_IMAGE_HEADER *)Buffer;
+  BmpHeader->CharB           = 'B';   // Header flag
+  BmpHeader->CharM           = 'M';
+  BmpHeader->Size            = (UINT32)BmpFileSize;
+  BmpHeader->Reserved[0]     = 0;
+  BmpHeader->Reserved[1]     = 0;
+  BmpHeader->ImageOffset     = (sizeof (BMP_IMAGE_HEADER) + 3) & ~0x03; // Start first row on 4 byte boundary
+  BmpHeader->HeaderSize      = sizeof (BMP_IMAGE_HEADER) - OFFSET_OF (BMP_IMAGE_HEADER, HeaderSize);
+  BmpHeader->PixelWidth      = (UINT32)Width;
+  BmpHeader->PixelHeight     = (UINT32)Height;
+  BmpHeader->Planes          = 1;
+  BmpHeader->BitPerPixel     = BMP_BITS_PER_PIXEL;
+  BmpHeader->CompressionType = 0;     // Not Compressed
+  BmpHeader->ImageSize       = 0;
+  BmpHeader->XPixelsPerMeter = 11000;    // Approximately 300 dpi
+  BmpHeader->YPixelsPerMeter = 11000;
+  BmpHeader->NumberOfColors  = 0;
+  BmpHeader->ImportantColors = 0;
+
+  Used   = BmpHeader->ImageOffset;
+  Status = EFI_SUCCESS;
+
+  // BMP rows are stored bottom up, so capture bands from the bottom of the display
+  for (BandY = Height; BandY > 0; BandY -= Rows) {
+    Rows   = MIN (BandRows, BandY);
+    Status = Gop->Blt (Gop, Band, EfiBltVideoToBltBuffer, 0, BandY - Rows, 0, 0, Width, Rows, 0);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Unable to BLt video to buffer, code=%r\n", Status));
+      goto Exit;
+    }
+
+    for (Y = Rows; Y > 0; Y--) {
+      if (Used + DataSizePerLine > BufferSize) {
+        Status = WriteCaptureData (FileHandle, Buffer, Used);
+        if (EFI_ERROR (Status)) {
+          goto Exit;
+        }
+
+        Used = 0;
+      }
+
+      Image = Buffer + Used;
+      Blt   = &Band[(Y - 1) * Width];
+      for (X = 0; X < Width; X++, Blt++) {
+        if (Gop->Mode->Info->PixelFormat == PixelRedGreenBlueReserved8BitPerColor) {
+          *Image++ = Blt->Red;
+          *Image++ = Blt->Green;
+          *Image++ = Blt->Blue;
+        } else {
+          // PixelBlueGreenRedReserved8BitPerColor
+          *Image++ = Blt->Blue;
+          *Image++ = Blt->Green;
+          *Image++ = Blt->Red;
+        }
+      }
+
+      // Rows are padded to a 4 byte boundary
+      ZeroMem (Image, DataSizePerLine - (Width * RGB_BYTES_PER_PIXEL));
+      Used += DataSizePerLine;
+    }
+  }
+
+  Status = WriteCaptureData (FileHandle, Buffer, Used);
+
+Exit:
+  FreePool (Buffer);
+  return Status;
+}
+
+/**
+  Write the contents of the display to a file in the format selected by
+  PcdPrintScreenLoggerPngEnable.
+
+  @param  FileHandle            File to write to.
+
+  @retval EFI_SUCCESS           The display was captured to the file.
+  @retval EFI_UNSUPPORTED       The video mode is not supported.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory to capture the display.
+  @retval Others                The capture or write failed.
+
+**/
+EFI_STATUS
+WriteScreenToFile (
+  IN EFI_FILE_PROTOCOL  *FileHandle
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_GRAPHICS_OUTPUT_PROTOCOL   *Gop;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Band;
+  UINTN                          BandRows;
+  UINTN                          RowSize;
+
+  Status = gBS->LocateProtocol (
+                  &gEfiGraphicsOutputProtocolGuid,
+                  NULL,
+                  (VOID **)&Gop
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Unable to locate Gop protocol\n"));
+    return Status;
+  }
+
+  if ((Gop->Mode->Info->PixelFormat != PixelRedGreenBlueReserved8BitPerColor) &&
+      (Gop->Mode->Info->PixelFormat != PixelBlueGreenRedReserved8BitPerColor))
+  {
+    DEBUG ((DEBUG_ERROR, "%a: Unsupported video mode\n", __FUNCTION__));
+    return EFI_UNSUPPORTED;
+  }
+
+  if ((Gop->Mode->Info->HorizontalResolution == 0) || (Gop->Mode->Info->VerticalResolution == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  // Capture the display a band of rows at a time rather than the whole frame buffer
+  RowSize  = Gop->Mode->Info->HorizontalResolution * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  BandRows = MAX (PRINT_SCREEN_BAND_SIZE / RowSize, 1);
+  BandRows = MIN (BandRows, Gop->Mode->Info->VerticalResolution);
+  Band     = AllocatePool (BandRows * RowSize);
+  if (NULL == Band) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (FeaturePcdGet (PcdPrintScreenLoggerPngEnable)) {
+    Status = WritePngToFile (FileHandle, Gop, Band, BandRows);
+  } else {
+    Status = WriteBmpToFile (FileHandle, Gop, Band, BandRows);
+  }
+
+  FreePool (Band);
+  return Status;
+}
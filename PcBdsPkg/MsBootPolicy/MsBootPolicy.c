@@ -9,6 +9,19 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define USB_DRIVE_SECOND_CHANCE_DELAY_S  6
 
+// Indices into the event array used while waiting for a USB boot device.
+// WaitForEvent reports the lowest signaled index, so arrivals take priority over the deadline.
+#define USB_WAIT_FILE_SYSTEM_EVENT  0
+#define USB_WAIT_BLOCK_IO_EVENT     1
+#define USB_WAIT_DEADLINE_EVENT     2
+#define USB_WAIT_EVENT_COUNT        3
+
+// Sort key for a handle, so the device path is only looked up once per handle
+typedef struct {
+  EFI_HANDLE                  Handle;
+  EFI_DEVICE_PATH_PROTOCOL    *DevicePath;
+} HANDLE_SORT_KEY;
+
 static BOOT_SEQUENCE  mDefaultBootSequence[] = {
   MsBootHDD,
   MsBootUSB,
@@ -146,8 +159,8 @@ FilterHandles (
   return;
 }
 
-BOOLEAN
-CompareDevicePathAgtB (
+INTN
+CompareDevicePaths (
   EFI_DEVICE_PATH_PROTOCOL  *DevicePathA,
   EFI_DEVICE_PATH_PROTOCOL  *DevicePathB
   )
@@ -233,7 +246,40 @@ CompareDevicePathAgtB (
     }
   }
 
-  return (Result >= 0);
+  return Result;
+}
+
+/**
+  SORT_COMPARE routine for an array of HANDLE_SORT_KEY.
+
+  Handles without a device path are sorted to the end.
+
+  @param[in] Buffer1  Pointer to the first HANDLE_SORT_KEY.
+  @param[in] Buffer2  Pointer to the second HANDLE_SORT_KEY.
+
+  @retval <0  Buffer1 sorts before Buffer2.
+  @retval 0   Buffer1 and Buffer2 are equivalent.
+  @retval >0  Buffer1 sorts after Buffer2.
+**/
+STATIC
+INTN
+EFIAPI
+CompareHandleSortKeys (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  CONST HANDLE_SORT_KEY  *KeyA;
+  CONST HANDLE_SORT_KEY  *KeyB;
+
+  KeyA = (CONST HANDLE_SORT_KEY *)Buffer1;
+  KeyB = (CONST HANDLE_SORT_KEY *)Buffer2;
+
+  if ((KeyA->DevicePath == NULL) || (KeyB->DevicePath == NULL)) {
+    return (KeyA->DevicePath == NULL) - (KeyB->DevicePath == NULL);
+  }
+
+  return CompareDevicePaths (KeyA->DevicePath, KeyB->DevicePath);
 }
 
 VOID
@@ -266,43 +312,40 @@ SortHandles (
   UINTN       HandleCount
   )
 {
-  UINTN                     Index;
-  EFI_DEVICE_PATH_PROTOCOL  *DevicePathA;
-  EFI_DEVICE_PATH_PROTOCOL  *DevicePathB;
-  EFI_HANDLE                *TempHandle;
-  BOOLEAN                   Swap;
-  UINTN                     SwapCount;
+  UINTN            Index;
+  HANDLE_SORT_KEY  *Keys;
 
   DEBUG ((DEBUG_INFO, "%a\n", __FUNCTION__));
   if (HandleCount < 2) {
     return;
   }
 
-  SwapCount = 0;
+  // Look up each device path once, rather than on every comparison
+  Keys = AllocatePool (HandleCount * sizeof (HANDLE_SORT_KEY));
+  if (Keys == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a - Unable to allocate sort keys, handles left unsorted\n", __FUNCTION__));
+    return;
+  }
+
+  for (Index = 0; Index < HandleCount; Index++) {
+    Keys[Index].Handle     = HandleBuffer[Index];
+    Keys[Index].DevicePath = DevicePathFromHandle (HandleBuffer[Index]);
+  }
+
   DEBUG ((DEBUG_INFO, "SortHandles - Before sorting\n"));
   DisplayDevicePaths (HandleBuffer, HandleCount);
-  do {
-    Swap = FALSE;
-    for (Index = 0; Index < (HandleCount - 1); Index++) {
-      DevicePathA = DevicePathFromHandle (HandleBuffer[Index]);
-      DevicePathB = DevicePathFromHandle (HandleBuffer[Index + 1]);
-
-      if (CompareDevicePathAgtB (DevicePathA, DevicePathB)) {
-        TempHandle              = HandleBuffer[Index];
-        HandleBuffer[Index]     = HandleBuffer[Index + 1];
-        HandleBuffer[Index + 1] = TempHandle;
-        Swap                    = TRUE;
-      }
-    }
 
-    if (Swap) {
-      SwapCount++;
-    }
-  } while ((Swap == TRUE) && (SwapCount < 50));
+  PerformQuickSort (Keys, HandleCount, sizeof (HANDLE_SORT_KEY), CompareHandleSortKeys);
+
+  for (Index = 0; Index < HandleCount; Index++) {
+    HandleBuffer[Index] = Keys[Index].Handle;
+  }
+
+  FreePool (Keys);
 
   DEBUG ((DEBUG_INFO, "SortHandles - After sorting\n"));
   DisplayDevicePaths (HandleBuffer, HandleCount);
-  DEBUG ((DEBUG_INFO, "Exit %a, SwapCount = %d\n", __FUNCTION__, SwapCount));
+  DEBUG ((DEBUG_INFO, "Exit %a\n", __FUNCTION__));
   return;
 }
 
@@ -530,40 +573,159 @@ CleanLoadOptions (
 }
 
 /**
-Pauses for a defined number of seconds to allow USB mass storage devices enumerate
-through hubs that may take a long time (hundreds of ms) to power up and enumerate.
-Our test system is forced to use hubs on BB of some units due to lack of connectivity
-options.
+  Determine if a SimpleFileSystem handle is a USB device that boot policy allows booting from.
+
+  @param[in] Handle  Handle with the SimpleFileSystem protocol installed.
+
+  @retval TRUE   The handle is a bootable USB file system.
+  @retval FALSE  The handle is not a USB device, or is blocked from booting.
+**/
+STATIC
+BOOLEAN
+IsBootableUsbFileSystem (
+  IN EFI_HANDLE  Handle
+  )
+{
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+
+  DevicePath = DevicePathFromHandle (Handle);
+  if ((DevicePath == NULL) || !FilterOnlyUSB (DevicePath)) {
+    return FALSE;
+  }
+
+  return MsBootPolicyLibIsDeviceBootable (Handle);
+}
+
+/**
+Waits for a bootable USB mass storage device to arrive.  USB mass storage devices behind
+hubs may take a long time (hundreds of ms per hub) to power up and enumerate.  Our test
+system is forced to use hubs on BB of some units due to lack of connectivity options.
 
-No params
-No return value.  On failure the delay just doesn't happen, which is not fatal.
+Rather than always pausing for USB_DRIVE_SECOND_CHANCE_DELAY_S, this registers for BlockIo
+and SimpleFileSystem arrivals and returns as soon as a bootable USB file system is present.
+USB BlockIo arrivals are connected so the partition and file system drivers bind promptly.
+
+@retval TRUE   A bootable USB file system is present.
+@retval FALSE  The deadline expired, or the wait could not be set up.  Neither is fatal.
 **/
 STATIC
-void
-PauseToLetUsbDrivesEnumerateThroughHubs (
+BOOLEAN
+WaitForUsbBootDevice (
   VOID
   )
 {
-  EFI_STATUS  Status;
-  EFI_EVENT   PauseEvent;
-  UINTN       SignalIndex;
+  EFI_STATUS                Status;
+  EFI_EVENT                 WaitEvents[USB_WAIT_EVENT_COUNT];
+  VOID                      *FileSystemRegistration;
+  VOID                      *BlockIoRegistration;
+  EFI_HANDLE                *Handles;
+  EFI_HANDLE                Handle;
+  EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
+  UINTN                     HandleCount;
+  UINTN                     BufferSize;
+  UINTN                     SignalIndex;
+  UINTN                     Index;
+  BOOLEAN                   Found;
+
+  Found = FALSE;
+  ZeroMem (WaitEvents, sizeof (WaitEvents));
+
+  // The arrival events have no notification function so they can be passed to WaitForEvent
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &WaitEvents[USB_WAIT_FILE_SYSTEM_EVENT]);
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &WaitEvents[USB_WAIT_BLOCK_IO_EVENT]);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->CreateEvent (EVT_TIMER, TPL_NOTIFY, NULL, NULL, &WaitEvents[USB_WAIT_DEADLINE_EVENT]);
+  }
 
-  Status = gBS->CreateEvent (EVT_TIMER, TPL_NOTIFY, NULL, NULL, &PauseEvent);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Could not create event! %r\n", Status));
-    return;
+    goto Exit;
   }
 
-  // 100ns units. so *10 = us, then *1000 = ms, then *1000 again = s
-  Status = gBS->SetTimer (PauseEvent, TimerRelative, 10 * 1000 * 1000 * USB_DRIVE_SECOND_CHANCE_DELAY_S);
+  Status = gBS->RegisterProtocolNotify (
+                  &gEfiSimpleFileSystemProtocolGuid,
+                  WaitEvents[USB_WAIT_FILE_SYSTEM_EVENT],
+                  &FileSystemRegistration
+                  );
   if (!EFI_ERROR (Status)) {
-    Status = gBS->WaitForEvent (1, &PauseEvent, &SignalIndex);
+    Status = gBS->RegisterProtocolNotify (
+                    &gEfiBlockIoProtocolGuid,
+                    WaitEvents[USB_WAIT_BLOCK_IO_EVENT],
+                    &BlockIoRegistration
+                    );
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Could not register protocol notify! %r\n", Status));
+    goto Exit;
+  }
+
+  // A device may have arrived between the failed boot attempt and registering for notifications
+  Status = gBS->LocateHandleBuffer (ByProtocol, &gEfiSimpleFileSystemProtocolGuid, NULL, &HandleCount, &Handles);
+  if (!EFI_ERROR (Status)) {
+    for (Index = 0; (Index < HandleCount) && !Found; Index++) {
+      Found = IsBootableUsbFileSystem (Handles[Index]);
+    }
+
+    FreePool (Handles);
+  }
+
+  if (Found) {
+    goto Exit;
+  }
+
+  // 100ns units. so *10 = us, then *1000 = ms, then *1000 again = s
+  Status = gBS->SetTimer (WaitEvents[USB_WAIT_DEADLINE_EVENT], TimerRelative, 10 * 1000 * 1000 * USB_DRIVE_SECOND_CHANCE_DELAY_S);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Could not set timer! %r\n", Status));
+    goto Exit;
+  }
+
+  while (!Found) {
+    Status = gBS->WaitForEvent (USB_WAIT_EVENT_COUNT, WaitEvents, &SignalIndex);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Wait for Event failed! %r\n", Status));
+      break;
+    }
+
+    if (SignalIndex == USB_WAIT_DEADLINE_EVENT) {
+      DEBUG ((DEBUG_WARN, "No bootable USB device arrived within %d seconds\n", USB_DRIVE_SECOND_CHANCE_DELAY_S));
+      break;
+    }
+
+    // Drain every handle that arrived since the last signal
+    do {
+      BufferSize = sizeof (Handle);
+      if (SignalIndex == USB_WAIT_FILE_SYSTEM_EVENT) {
+        Status = gBS->LocateHandle (ByRegisterNotify, NULL, FileSystemRegistration, &BufferSize, &Handle);
+        if (!EFI_ERROR (Status)) {
+          Found = IsBootableUsbFileSystem (Handle);
+        }
+      } else {
+        Status = gBS->LocateHandle (ByRegisterNotify, NULL, BlockIoRegistration, &BufferSize, &Handle);
+        if (!EFI_ERROR (Status)) {
+          DevicePath = DevicePathFromHandle (Handle);
+          if ((DevicePath != NULL) && FilterOnlyUSB (DevicePath)) {
+            gBS->ConnectController (Handle, NULL, NULL, TRUE);
+          }
+        }
+      }
+    } while (!EFI_ERROR (Status) && !Found);
+  }
+
+Exit:
+  // Closing the arrival events also cancels their protocol notify registrations
+  for (Index = 0; Index < USB_WAIT_EVENT_COUNT; Index++) {
+    if (WaitEvents[Index] != NULL) {
+      gBS->CloseEvent (WaitEvents[Index]);
     }
   }
 
-  gBS->CloseEvent (PauseEvent);
+  DEBUG ((DEBUG_INFO, "%a - bootable USB device %a\n", __FUNCTION__, Found ? "found" : "not found"));
+  return Found;
 }
 
 /**
@@ -678,8 +840,8 @@ MsBootPolicyEntry (
           DEBUG ((DEBUG_WARN, "USB boot desired, but no USB devices found on first attempt\n"));
           // attempting USB boot but no USB devices were found.
           // USB enumeration through (crappy, slow) hubs may take a while, especially in
-          // debug builds. wait a number of seconds and try one more time.
-          PauseToLetUsbDrivesEnumerateThroughHubs ();
+          // debug builds. wait for a device to arrive, up to a number of seconds, and try one more time.
+          WaitForUsbBootDevice ();
           Status = SelectAndBootDevice (&gEfiSimpleFileSystemProtocolGuid, FilterOnlyUSB);
           if (EFI_ERROR (Status)) {
             DEBUG ((DEBUG_WARN, "Second chance USB boot failed! Status = %r\n", Status));
@@ -14,9 +14,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Pi/PiHob.h>
 #include <Library/HobLib.h>
 #include <Library/DxeServicesTableLib.h>
-
-#define NEXT_MEMORY_SPACE_DESCRIPTOR(MemoryDescriptor, Size) \
-  ((EFI_GCD_MEMORY_SPACE_DESCRIPTOR *)((UINT8 *)(MemoryDescriptor) + (Size)))
+#include <Library/SortLib.h>
 
 #define PREVIOUS_MEMORY_DESCRIPTOR(MemoryDescriptor, Size) \
   ((EFI_MEMORY_DESCRIPTOR *)((UINT8 *)(MemoryDescriptor) - (Size)))
@@ -149,7 +147,7 @@ CalculateMaximumSupportAddressBits (
 
 /**
   This helper function writes a string entry to the memory info database buffer.
-  If string would exceed current buffer allocation, it will realloc.
+  If string would exceed current buffer allocation, the allocation is doubled.
 
   NOTE: The buffer tracks its size. It does not work with NULL terminators.
 
@@ -168,7 +166,7 @@ AppendToMemoryInfoDatabase (
   )
 {
   EFI_STATUS  Status = EFI_SUCCESS;
-  UINTN       NewStringSize, NewDatabaseSize;
+  UINTN       NewStringSize, NewDatabaseSize, NewAllocSize;
   CHAR8       *NewDatabaseBuffer;
 
   // If the incoming string is NULL or empty, get out of here.
@@ -182,12 +180,14 @@ AppendToMemoryInfoDatabase (
   NewStringSize = NewStringSize - sizeof (CHAR8);    // Remove NULL.
 
   // If we need more space, realloc now.
-  // Subtract 1 because we only need a single NULL terminator.
+  // Double the allocation so that appending N strings only copies the buffer log(N) times.
   NewDatabaseSize = NewStringSize + mMemoryInfoDatabaseSize;
   if (NewDatabaseSize > mMemoryInfoDatabaseAllocSize) {
+    NewAllocSize      = MAX (mMemoryInfoDatabaseAllocSize * 2, MEM_INFO_DATABASE_REALLOC_CHUNK);
+    NewAllocSize      = MAX (NewAllocSize, NewDatabaseSize);
     NewDatabaseBuffer = ReallocatePool (
                           mMemoryInfoDatabaseAllocSize,
-                          mMemoryInfoDatabaseAllocSize + MEM_INFO_DATABASE_REALLOC_CHUNK,
+                          NewAllocSize,
                           mMemoryInfoDatabaseBuffer
                           );
     // If we failed, don't change anything.
@@ -196,8 +196,8 @@ AppendToMemoryInfoDatabase (
     }
     // Otherwise, updated the pointers and sizes.
     else {
-      mMemoryInfoDatabaseBuffer     = NewDatabaseBuffer;
-      mMemoryInfoDatabaseAllocSize += MEM_INFO_DATABASE_REALLOC_CHUNK;
+      mMemoryInfoDatabaseBuffer    = NewDatabaseBuffer;
+      mMemoryInfoDatabaseAllocSize = NewAllocSize;
     }
   }
 
@@ -396,6 +396,52 @@ MemoryAttributesTableDump (
   FreePool (Buffer);
 }
 
+/**
+  SortLib compare function ordering EFI_MEMORY_DESCRIPTOR entries by PhysicalStart.
+**/
+STATIC
+INTN
+EFIAPI
+CompareMemoryDescriptor (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  EFI_PHYSICAL_ADDRESS  Start1;
+  EFI_PHYSICAL_ADDRESS  Start2;
+
+  Start1 = ((CONST EFI_MEMORY_DESCRIPTOR *)Buffer1)->PhysicalStart;
+  Start2 = ((CONST EFI_MEMORY_DESCRIPTOR *)Buffer2)->PhysicalStart;
+  if (Start1 < Start2) {
+    return -1;
+  }
+
+  return (Start1 > Start2) ? 1 : 0;
+}
+
+/**
+  SortLib compare function ordering EFI_GCD_MEMORY_SPACE_DESCRIPTOR entries by BaseAddress.
+**/
+STATIC
+INTN
+EFIAPI
+CompareMemorySpaceDescriptor (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  EFI_PHYSICAL_ADDRESS  Base1;
+  EFI_PHYSICAL_ADDRESS  Base2;
+
+  Base1 = ((CONST EFI_GCD_MEMORY_SPACE_DESCRIPTOR *)Buffer1)->BaseAddress;
+  Base2 = ((CONST EFI_GCD_MEMORY_SPACE_DESCRIPTOR *)Buffer2)->BaseAddress;
+  if (Base1 < Base2) {
+    return -1;
+  }
+
+  return (Base1 > Base2) ? 1 : 0;
+}
+
 /**
   Sort memory map entries based upon PhysicalStart, from low to high.
 
@@ -413,71 +459,23 @@ SortMemoryMap (
   IN UINTN                      DescriptorSize
   )
 {
-  EFI_MEMORY_DESCRIPTOR  *MemoryMapEntry;
-  EFI_MEMORY_DESCRIPTOR  *NextMemoryMapEntry;
-  EFI_MEMORY_DESCRIPTOR  *MemoryMapEnd;
-  EFI_MEMORY_DESCRIPTOR  TempMemoryMap;
-
-  MemoryMapEntry     = MemoryMap;
-  NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
-  MemoryMapEnd       = (EFI_MEMORY_DESCRIPTOR *)((UINT8 *)MemoryMap + MemoryMapSize);
-  while (MemoryMapEntry < MemoryMapEnd) {
-    while (NextMemoryMapEntry < MemoryMapEnd) {
-      if (MemoryMapEntry->PhysicalStart > NextMemoryMapEntry->PhysicalStart) {
-        CopyMem (&TempMemoryMap, MemoryMapEntry, sizeof (EFI_MEMORY_DESCRIPTOR));
-        CopyMem (MemoryMapEntry, NextMemoryMapEntry, sizeof (EFI_MEMORY_DESCRIPTOR));
-        CopyMem (NextMemoryMapEntry, &TempMemoryMap, sizeof (EFI_MEMORY_DESCRIPTOR));
-      }
-
-      NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (NextMemoryMapEntry, DescriptorSize);
-    }
-
-    MemoryMapEntry     = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
-    NextMemoryMapEntry = NEXT_MEMORY_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
-  }
-
-  return;
+  PerformQuickSort (MemoryMap, MemoryMapSize / DescriptorSize, DescriptorSize, CompareMemoryDescriptor);
 }
 
 /**
-  Sort memory map entries based upon PhysicalStart, from low to high.
+  Sort memory space map entries based upon BaseAddress, from low to high.
 
-  @param[in, out]   MemoryMap       A pointer to the buffer containing the current memory map
-  @param[in]        MemoryMapSize   Size, in bytes, of the MemoryMap buffer
-  @param[in]        DescriptorSize  Size, in bytes, of an individual EFI_GCD_MEMORY_SPACE_DESCRIPTOR
+  @param[in, out]   MemoryMap       A pointer to the array of GCD memory space descriptors
+  @param[in]        NumberOfEntries Number of descriptors in MemoryMap
 **/
 STATIC
 VOID
 SortMemorySpaceMap (
   IN OUT EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *MemoryMap,
-  IN UINTN                                MemoryMapSize,
-  IN UINTN                                DescriptorSize
+  IN UINTN                                NumberOfEntries
   )
 {
-  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *MemoryMapEntry;
-  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *NextMemoryMapEntry;
-  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *MemoryMapEnd;
-  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  TempMemoryMap;
-
-  MemoryMapEntry     = MemoryMap;
-  NextMemoryMapEntry = NEXT_MEMORY_SPACE_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
-  MemoryMapEnd       = (EFI_GCD_MEMORY_SPACE_DESCRIPTOR *)((UINT8 *)MemoryMap + MemoryMapSize);
-  while (MemoryMapEntry < MemoryMapEnd) {
-    while (NextMemoryMapEntry < MemoryMapEnd) {
-      if (MemoryMapEntry->BaseAddress > NextMemoryMapEntry->BaseAddress) {
-        CopyMem (&TempMemoryMap, MemoryMapEntry, sizeof (EFI_GCD_MEMORY_SPACE_DESCRIPTOR));
-        CopyMem (MemoryMapEntry, NextMemoryMapEntry, sizeof (EFI_GCD_MEMORY_SPACE_DESCRIPTOR));
-        CopyMem (NextMemoryMapEntry, &TempMemoryMap, sizeof (EFI_GCD_MEMORY_SPACE_DESCRIPTOR));
-      }
-
-      NextMemoryMapEntry = NEXT_MEMORY_SPACE_DESCRIPTOR (NextMemoryMapEntry, DescriptorSize);
-    }
-
-    MemoryMapEntry     = NEXT_MEMORY_SPACE_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
-    NextMemoryMapEntry = NEXT_MEMORY_SPACE_DESCRIPTOR (MemoryMapEntry, DescriptorSize);
-  }
-
-  return;
+  PerformQuickSort (MemoryMap, NumberOfEntries, sizeof (EFI_GCD_MEMORY_SPACE_DESCRIPTOR), CompareMemorySpaceDescriptor);
 }
 
 /**
@@ -795,7 +793,7 @@ MemoryMapDumpHandler (
       goto Done;
     }
 
-    SortMemorySpaceMap (MemorySpaceMap, NumberOfDescriptors, sizeof (EFI_GCD_MEMORY_SPACE_DESCRIPTOR));
+    SortMemorySpaceMap (MemorySpaceMap, NumberOfDescriptors);
     Status = MergeMemorySpaceMap (&NumberOfDescriptors, &MemorySpaceMap);
 
     if (EFI_ERROR (Status)) {
@@ -1093,45 +1091,149 @@ CleanUp:
   return Status;
 }
 
+#define PAGE_TABLE_SNAPSHOT_INITIAL_RECORDS  0x100
+
+//
+// Page table snapshot under construction.  Header is followed by Capacity records.
+//
+typedef struct {
+  PAGE_TABLE_SNAPSHOT_HEADER    *Header;
+  UINTN                         Capacity;
+  UINT64                        NextLinearAddress;  // Linear address following the last record
+} PAGE_TABLE_SNAPSHOT_WRITER;
+
+#define SNAPSHOT_RECORDS(Writer)  ((PAGE_TABLE_SNAPSHOT_RECORD *)((Writer)->Header + 1))
+
+STATIC CONST UINT8  mSnapshotPageShift[] = { 12, 21, 30 };
+
+/**
+  Add one leaf page table entry to the snapshot.  The entry extends the last record if
+  it has the same size and attributes and continues both its linear and physical range.
+  Otherwise a new record is started, doubling the buffer if it is full.
+
+  @param[in, out] Writer          Snapshot under construction.
+  @param[in]      LinearAddress   Linear address translated by the entry.
+  @param[in]      Address         Physical address mapped by the entry, or the linear
+                                  address for guard pages.
+  @param[in]      PageSize        PAGE_TABLE_SNAPSHOT_PAGE_* size of the entry.
+  @param[in]      Attributes      PAGE_TABLE_SNAPSHOT_* attribute bits of the entry.
+
+  @retval EFI_SUCCESS           The entry was added.
+  @retval EFI_OUT_OF_RESOURCES  The buffer could not be grown.  The entry was not added.
+**/
+STATIC
+EFI_STATUS
+AppendToPageTableSnapshot (
+  IN OUT PAGE_TABLE_SNAPSHOT_WRITER  *Writer,
+  IN     UINT64                      LinearAddress,
+  IN     UINT64                      Address,
+  IN     UINT8                       PageSize,
+  IN     UINT8                       Attributes
+  )
+{
+  PAGE_TABLE_SNAPSHOT_HEADER  *NewHeader;
+  PAGE_TABLE_SNAPSHOT_RECORD  *Record;
+  UINTN                       Count;
+  UINTN                       NewCapacity;
+  UINT64                      EntrySize;
+
+  EntrySize = LShiftU64 (1, mSnapshotPageShift[PageSize]);
+  Count     = (UINTN)Writer->Header->RecordCount;
+
+  if (Count > 0) {
+    Record = &SNAPSHOT_RECORDS (Writer)[Count - 1];
+    if ((Record->PageSize == PageSize) &&
+        (Record->Attributes == Attributes) &&
+        (Writer->NextLinearAddress == LinearAddress) &&
+        (Record->Address + LShiftU64 (Record->EntryCount, mSnapshotPageShift[PageSize]) == Address))
+    {
+      Record->EntryCount++;
+      Writer->NextLinearAddress += EntrySize;
+      return EFI_SUCCESS;
+    }
+  }
+
+  if (Count == Writer->Capacity) {
+    NewCapacity = Writer->Capacity * 2;
+    NewHeader   = ReallocatePool (
+                    sizeof (PAGE_TABLE_SNAPSHOT_HEADER) + Writer->Capacity * sizeof (PAGE_TABLE_SNAPSHOT_RECORD),
+                    sizeof (PAGE_TABLE_SNAPSHOT_HEADER) + NewCapacity * sizeof (PAGE_TABLE_SNAPSHOT_RECORD),
+                    Writer->Header
+                    );
+    if (NewHeader == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Writer->Header   = NewHeader;
+    Writer->Capacity = NewCapacity;
+  }
+
+  Record = &SNAPSHOT_RECORDS (Writer)[Count];
+  ZeroMem (Record, sizeof (*Record));
+  Record->Address    = Address;
+  Record->EntryCount = 1;
+  Record->PageSize   = PageSize;
+  Record->Attributes = Attributes;
+
+  Writer->Header->RecordCount++;
+  Writer->NextLinearAddress = LinearAddress + EntrySize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Translate the bits of a leaf page table entry that the audit reports to
+  PAGE_TABLE_SNAPSHOT_* attribute bits.
+
+  @param[in]  Entry   Leaf page table entry of any size.
+
+  @return PAGE_TABLE_SNAPSHOT_* attribute bits.
+**/
+STATIC
+UINT8
+GetSnapshotAttributes (
+  IN UINT64  Entry
+  )
+{
+  UINT8  Attributes;
+
+  Attributes = 0;
+  if ((Entry & BIT0) != 0) {
+    Attributes |= PAGE_TABLE_SNAPSHOT_PRESENT;
+  }
+
+  if ((Entry & BIT1) != 0) {
+    Attributes |= PAGE_TABLE_SNAPSHOT_READ_WRITE;
+  }
+
+  if ((Entry & BIT2) != 0) {
+    Attributes |= PAGE_TABLE_SNAPSHOT_USER;
+  }
+
+  if ((Entry & BIT63) != 0) {
+    Attributes |= PAGE_TABLE_SNAPSHOT_NX;
+  }
+
+  return Attributes;
+}
+
 /**
-  This helper function walks the page tables to retrieve:
-  - a count of each entry
-  - a count of each directory entry
-  - [optional] a flat list of each entry
-  - [optional] a flat list of each directory entry
-
-  @param[in, out]   Pte1GCount, Pte2MCount, Pte4KCount, PdeCount
-      On input, the number of entries that can fit in the corresponding buffer (if provided).
-      It is expected that this will be zero if the corresponding buffer is NULL.
-      On output, the number of entries that were encountered in the page table.
-  @param[out]       Pte1GEntries, Pte2MEntries, Pte4KEntries, PdeEntries
-      A buffer which will be filled with the entries that are encountered in the tables.
-
-  @retval     EFI_SUCCESS             All requested data has been returned.
-  @retval     EFI_INVALID_PARAMETER   One or more of the count parameter pointers is NULL.
-  @retval     EFI_INVALID_PARAMETER   Presence of buffer counts and pointers is incongruent.
-  @retval     EFI_BUFFER_TOO_SMALL    One or more of the buffers was insufficient to hold
-                                      all of the entries in the page tables. The counts
-                                      have been updated with the total number of entries
-                                      encountered.
+  Walk the page tables once and build a run-length merged snapshot of every leaf entry
+  and guard page.
+
+  @param[out] Header      Returns the snapshot, which must be freed by the caller with FreePool.
+                          The header is followed by Header->RecordCount records.
 
+  @retval     EFI_SUCCESS           The snapshot was built.
+  @retval     EFI_OUT_OF_RESOURCES  The snapshot buffer could not be allocated.
 **/
 STATIC
 EFI_STATUS
-GetFlatPageTableData (
-  IN OUT UINTN             *Pte1GCount,
-  IN OUT UINTN             *Pte2MCount,
-  IN OUT UINTN             *Pte4KCount,
-  IN OUT UINTN             *PdeCount,
-  IN OUT UINTN             *GuardCount,
-  OUT PAGE_TABLE_1G_ENTRY  *Pte1GEntries,
-  OUT PAGE_TABLE_ENTRY     *Pte2MEntries,
-  OUT PAGE_TABLE_4K_ENTRY  *Pte4KEntries,
-  OUT UINT64               *PdeEntries,
-  OUT UINT64               *GuardEntries
+CollectPageTableSnapshot (
+  OUT PAGE_TABLE_SNAPSHOT_HEADER  **Header
   )
 {
   EFI_STATUS                      Status = EFI_SUCCESS;
+  PAGE_TABLE_SNAPSHOT_WRITER      Writer;
   PAGE_MAP_AND_DIRECTORY_POINTER  *Work;
   PAGE_MAP_AND_DIRECTORY_POINTER  *Pml4;
   PAGE_TABLE_1G_ENTRY             *Pte1G;
@@ -1151,48 +1253,31 @@ GetFlatPageTableData (
   UINTN                           NumPage1GNotPresent = 0;
   UINT64                          Address;
 
-  //
-  // First, fail fast if some of the parameters don't look right.
-  //
-  // ALL count parameters should be provided.
-  if ((Pte1GCount == NULL) || (Pte2MCount == NULL) || (Pte4KCount == NULL) || (PdeCount == NULL) || (GuardCount == NULL)) {
-    return EFI_INVALID_PARAMETER;
-  }
+  *Header = NULL;
 
-  // If a count is greater than 0, the corresponding buffer pointer MUST be provided.
-  // It will be assumed that all buffers have space for any corresponding count.
-  if (((*Pte1GCount > 0) && (Pte1GEntries == NULL)) || ((*Pte2MCount > 0) && (Pte2MEntries == NULL)) ||
-      ((*Pte4KCount > 0) && (Pte4KEntries == NULL)) || ((*PdeCount > 0) && (PdeEntries == NULL)) ||
-      ((*GuardCount > 0) && (GuardEntries == NULL)))
-  {
-    return EFI_INVALID_PARAMETER;
+  Writer.Capacity          = PAGE_TABLE_SNAPSHOT_INITIAL_RECORDS;
+  Writer.NextLinearAddress = 0;
+  Writer.Header            = AllocateZeroPool (sizeof (PAGE_TABLE_SNAPSHOT_HEADER) + Writer.Capacity * sizeof (PAGE_TABLE_SNAPSHOT_RECORD));
+  if (Writer.Header == NULL) {
+    return EFI_OUT_OF_RESOURCES;
   }
 
-  //
-  // Alright, let's get to work.
-  //
+  Writer.Header->Signature  = PAGE_TABLE_SNAPSHOT_SIGNATURE;
+  Writer.Header->Version    = PAGE_TABLE_SNAPSHOT_VERSION;
+  Writer.Header->RecordSize = sizeof (PAGE_TABLE_SNAPSHOT_RECORD);
+
   Pml4 = (PAGE_MAP_AND_DIRECTORY_POINTER *)AsmReadCr3 ();
-  // Increase the count.
-  // If we have room for more PDE Entries, add one.
   MyPdeCount++;
-  if (MyPdeCount <= *PdeCount) {
-    PdeEntries[MyPdeCount-1] = (UINT64)(UINTN)Pml4;
-  }
 
-  for (Index4 = 0x0; Index4 < 0x200; Index4++) {
+  for (Index4 = 0x0; Index4 < 0x200 && !EFI_ERROR (Status); Index4++) {
     if (!Pml4[Index4].Bits.Present) {
       continue;
     }
 
     Pte1G = (PAGE_TABLE_1G_ENTRY *)(UINTN)(Pml4[Index4].Bits.PageTableBaseAddress << 12);
-    // Increase the count.
-    // If we have room for more PDE Entries, add one.
     MyPdeCount++;
-    if (MyPdeCount <= *PdeCount) {
-      PdeEntries[MyPdeCount-1] = (UINT64)(UINTN)Pte1G;
-    }
 
-    for (Index3 = 0x0; Index3 < 0x200; Index3++ ) {
+    for (Index3 = 0x0; Index3 < 0x200 && !EFI_ERROR (Status); Index3++ ) {
       if (!Pte1G[Index3].Bits.Present) {
         NumPage1GNotPresent++;
         continue;
@@ -1209,14 +1294,9 @@ GetFlatPageTableData (
         //
         Work  = (PAGE_MAP_AND_DIRECTORY_POINTER *)Pte1G;
         Pte2M = (PAGE_TABLE_ENTRY *)(UINTN)(Work[Index3].Bits.PageTableBaseAddress << 12);
-        // Increase the count.
-        // If we have room for more PDE Entries, add one.
         MyPdeCount++;
-        if (MyPdeCount <= *PdeCount) {
-          PdeEntries[MyPdeCount-1] = (UINT64)(UINTN)Pte2M;
-        }
 
-        for (Index2 = 0x0; Index2 < 0x200; Index2++ ) {
+        for (Index2 = 0x0; Index2 < 0x200 && !EFI_ERROR (Status); Index2++ ) {
           if (!Pte2M[Index2].Bits.Present) {
             NumPage2MNotPresent++;
             continue;
@@ -1225,50 +1305,51 @@ GetFlatPageTableData (
           if (!(Pte2M[Index2].Bits.MustBe1)) {
             Work  = (PAGE_MAP_AND_DIRECTORY_POINTER *)Pte2M;
             Pte4K = (PAGE_TABLE_4K_ENTRY *)(UINTN)(Work[Index2].Bits.PageTableBaseAddress << 12);
-            // Increase the count.
-            // If we have room for more PDE Entries, add one.
             MyPdeCount++;
-            if (MyPdeCount <= *PdeCount) {
-              PdeEntries[MyPdeCount-1] = (UINT64)(UINTN)Pte4K;
-            }
 
-            for (Index1 = 0x0; Index1 < 0x200; Index1++ ) {
+            for (Index1 = 0x0; Index1 < 0x200 && !EFI_ERROR (Status); Index1++ ) {
+              Address = IndexToAddress (Index4, Index3, Index2, Index1);
               if (!Pte4K[Index1].Bits.Present) {
                 NumPage4KNotPresent++;
-                Address = IndexToAddress (Index4, Index3, Index2, Index1);
                 if ((mMemoryProtectionProtocol != NULL) && (mMemoryProtectionProtocol->IsGuardPage (Address))) {
                   MyGuardCount++;
-                  if (MyGuardCount <= *GuardCount) {
-                    GuardEntries[MyGuardCount - 1] = Address;
-                  }
-
+                  Status = AppendToPageTableSnapshot (&Writer, Address, Address, PAGE_TABLE_SNAPSHOT_PAGE_4K, PAGE_TABLE_SNAPSHOT_GUARD);
                   continue;
                 }
+
+                // Like the 2M and 1G entries, a not present 4K entry is only reported as a guard page.
+                continue;
               }
 
-              // Increase the count.
-              // If we have room for more Page Table entries, add one.
               My4KCount++;
-              if (My4KCount <= *Pte4KCount) {
-                Pte4KEntries[My4KCount-1] = Pte4K[Index1];
-              }
+              Status = AppendToPageTableSnapshot (
+                         &Writer,
+                         Address,
+                         LShiftU64 (Pte4K[Index1].Bits.PageTableBaseAddress, 12),
+                         PAGE_TABLE_SNAPSHOT_PAGE_4K,
+                         GetSnapshotAttributes (Pte4K[Index1].Uint64)
+                         );
             }
           } else {
-            // Increase the count.
-            // If we have room for more Page Table entries, add one.
             My2MCount++;
-            if (My2MCount <= *Pte2MCount) {
-              Pte2MEntries[My2MCount-1] = Pte2M[Index2];
-            }
+            Status = AppendToPageTableSnapshot (
+                       &Writer,
+                       IndexToAddress (Index4, Index3, Index2, 0),
+                       LShiftU64 (Pte2M[Index2].Bits.PageTableBaseAddress, 21),
+                       PAGE_TABLE_SNAPSHOT_PAGE_2M,
+                       GetSnapshotAttributes (Pte2M[Index2].Uint64)
+                       );
           }
         }
       } else {
-        // Increase the count.
-        // If we have room for more Page Table entries, add one.
         My1GCount++;
-        if (My1GCount <= *Pte1GCount) {
-          Pte1GEntries[My1GCount-1] = Pte1G[Index3];
-        }
+        Status = AppendToPageTableSnapshot (
+                   &Writer,
+                   IndexToAddress (Index4, Index3, 0, 0),
+                   LShiftU64 (Pte1G[Index3].Bits.PageTableBaseAddress, 30),
+                   PAGE_TABLE_SNAPSHOT_PAGE_1G,
+                   GetSnapshotAttributes (Pte1G[Index3].Uint64)
+                   );
       }
     }
   }
@@ -1278,162 +1359,17 @@ GetFlatPageTableData (
   DEBUG ((DEBUG_ERROR, "Number of   2M Pages active  = %d - NotPresent = %d\n", My2MCount, NumPage2MNotPresent));
   DEBUG ((DEBUG_ERROR, "Number of   1G Pages active  = %d - NotPresent = %d\n", My1GCount, NumPage1GNotPresent));
   DEBUG ((DEBUG_ERROR, "Number of   Guard Pages active  = %d\n", MyGuardCount));
+  DEBUG ((DEBUG_ERROR, "Number of   Snapshot records = %ld\n", Writer.Header->RecordCount));
 
-  //
-  // determine whether any of the buffers were too small.
-  // Only matters if a given buffer was provided.
-  //
-  if (((Pte1GEntries != NULL) && (*Pte1GCount < My1GCount)) || ((Pte2MEntries != NULL) && (*Pte2MCount < My2MCount)) ||
-      ((Pte4KEntries != NULL) && (*Pte4KCount < My4KCount)) || ((PdeEntries != NULL) && (*PdeCount < MyPdeCount)) ||
-      ((GuardEntries != NULL) && (*GuardCount < MyGuardCount)))
-  {
-    Status = EFI_BUFFER_TOO_SMALL;
-  }
-
-  //
-  // Update all the return pointers.
-  //
-  *Pte1GCount = My1GCount;
-  *Pte2MCount = My2MCount;
-  *Pte4KCount = My4KCount;
-  *PdeCount   = MyPdeCount;
-  *GuardCount = MyGuardCount;
-
-  return Status;
-} // GetFlatPageTableData()
-
-STATIC
-BOOLEAN
-LoadFlatPageTableData (
-  OUT UINTN                *Pte1GCount,
-  OUT UINTN                *Pte2MCount,
-  OUT UINTN                *Pte4KCount,
-  OUT UINTN                *PdeCount,
-  OUT UINTN                *GuardCount,
-  OUT PAGE_TABLE_1G_ENTRY  **Pte1GEntries,
-  OUT PAGE_TABLE_ENTRY     **Pte2MEntries,
-  OUT PAGE_TABLE_4K_ENTRY  **Pte4KEntries,
-  OUT UINT64               **PdeEntries,
-  OUT UINT64               **GuardEntries
-  )
-{
-  EFI_STATUS  Status = EFI_SUCCESS;
-
-  // Run once to get counts.
-  DEBUG ((DEBUG_ERROR, "%a - First call to determine required buffer sizes.\n", __FUNCTION__));
-  *Pte1GCount = 0;
-  *Pte2MCount = 0;
-  *Pte4KCount = 0;
-  *PdeCount   = 0;
-  *GuardCount = 0;
-  Status      = GetFlatPageTableData (Pte1GCount, Pte2MCount, Pte4KCount, PdeCount, GuardCount, NULL, NULL, NULL, NULL, NULL);
-
-  (*Pte1GCount) += 15;
-  (*Pte2MCount) += 15;
-  (*Pte4KCount) += 15;
-  (*PdeCount)   += 15;
-
-  // Allocate buffers if successful.
-  if (!EFI_ERROR (Status)) {
-    *Pte1GEntries = AllocateZeroPool (*Pte1GCount * sizeof (PAGE_TABLE_1G_ENTRY));
-    *Pte2MEntries = AllocateZeroPool (*Pte2MCount * sizeof (PAGE_TABLE_ENTRY));
-    *Pte4KEntries = AllocateZeroPool (*Pte4KCount * sizeof (PAGE_TABLE_4K_ENTRY));
-    *PdeEntries   = AllocateZeroPool (*PdeCount * sizeof (UINT64));
-    *GuardEntries = AllocateZeroPool (*GuardCount * sizeof (UINT64));
-
-    // Check for errors.
-    if ((*Pte1GEntries == NULL) || (*Pte2MEntries == NULL) || (*Pte4KEntries == NULL) || (*PdeEntries == NULL) || (*GuardEntries == NULL)) {
-      Status = EFI_OUT_OF_RESOURCES;
-    }
-  }
-
-  // If still good, grab the data.
-  if (!EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_INFO, "%a - Second call to grab the data.\n", __FUNCTION__));
-    Status = GetFlatPageTableData (
-               Pte1GCount,
-               Pte2MCount,
-               Pte4KCount,
-               PdeCount,
-               GuardCount,
-               *Pte1GEntries,
-               *Pte2MEntries,
-               *Pte4KEntries,
-               *PdeEntries,
-               *GuardEntries
-               );
-    if (Status == EFI_BUFFER_TOO_SMALL) {
-      DEBUG ((DEBUG_ERROR, "%a Second GetFlatPageTableData call returned - %r\n", __FUNCTION__, Status));
-      FreePool (*Pte1GEntries);
-      FreePool (*Pte2MEntries);
-      FreePool (*Pte4KEntries);
-      FreePool (*PdeEntries);
-      FreePool (*GuardEntries);
-
-      (*Pte1GCount) += 15;
-      (*Pte2MCount) += 15;
-      (*Pte4KCount) += 15;
-      (*PdeCount)   += 15;
-      (*GuardCount) += 15;
-
-      *Pte1GEntries = AllocateZeroPool (*Pte1GCount * sizeof (PAGE_TABLE_1G_ENTRY));
-      *Pte2MEntries = AllocateZeroPool (*Pte2MCount * sizeof (PAGE_TABLE_ENTRY));
-      *Pte4KEntries = AllocateZeroPool (*Pte4KCount * sizeof (PAGE_TABLE_4K_ENTRY));
-      *PdeEntries   = AllocateZeroPool (*PdeCount * sizeof (UINT64));
-      *GuardEntries = AllocateZeroPool (*GuardCount * sizeof (UINT64));
-
-      Status = GetFlatPageTableData (
-                 Pte1GCount,
-                 Pte2MCount,
-                 Pte4KCount,
-                 PdeCount,
-                 GuardCount,
-                 *Pte1GEntries,
-                 *Pte2MEntries,
-                 *Pte4KEntries,
-                 *PdeEntries,
-                 *GuardEntries
-                 );
-    }
-  }
-
-  // If an error occurred, bail and free.
   if (EFI_ERROR (Status)) {
-    if (*Pte1GEntries != NULL) {
-      FreePool (*Pte1GEntries);
-      *Pte1GEntries = NULL;
-    }
-
-    if (*Pte2MEntries != NULL) {
-      FreePool (*Pte2MEntries);
-      *Pte2MEntries = NULL;
-    }
-
-    if (*Pte4KEntries != NULL) {
-      FreePool (*Pte4KEntries);
-      *Pte4KEntries = NULL;
-    }
-
-    if (*PdeEntries != NULL) {
-      FreePool (*PdeEntries);
-      *PdeEntries = NULL;
-    }
-
-    if (*GuardEntries != NULL) {
-      FreePool (*GuardEntries);
-      *GuardEntries = NULL;
-    }
-
-    *Pte1GCount = 0;
-    *Pte2MCount = 0;
-    *Pte4KCount = 0;
-    *PdeCount   = 0;
-    *GuardCount = 0;
+    DEBUG ((DEBUG_ERROR, "%a - Failed to grow the snapshot - %r\n", __FUNCTION__, Status));
+    FreePool (Writer.Header);
+    return Status;
   }
 
-  DEBUG ((DEBUG_ERROR, "%a - Exit... - %r\n", __FUNCTION__, Status));
-  return !EFI_ERROR (Status);
-}
+  *Header = Writer.Header;
+  return EFI_SUCCESS;
+} // CollectPageTableSnapshot()
 
 /**
   This helper function will flush the MemoryInfoDatabase to its corresponding
@@ -1481,18 +1417,8 @@ DumpPagingInfo (
   IN      VOID       *Context
   )
 {
-  EFI_STATUS           Status        = EFI_SUCCESS;
-  UINTN                Pte1GCount    = 0;
-  UINTN                Pte2MCount    = 0;
-  UINTN                Pte4KCount    = 0;
-  UINTN                PdeCount      = 0;
-  UINTN                GuardCount    = 0;
-  PAGE_TABLE_1G_ENTRY  *Pte1GEntries = NULL;
-  PAGE_TABLE_ENTRY     *Pte2MEntries = NULL;
-  PAGE_TABLE_4K_ENTRY  *Pte4KEntries = NULL;
-  UINT64               *PdeEntries   = NULL;
-  UINT64               *GuardEntries = NULL;
-  CHAR8                TempString[MAX_STRING_SIZE];
+  EFI_STATUS                  Status    = EFI_SUCCESS;
+  PAGE_TABLE_SNAPSHOT_HEADER  *Snapshot = NULL;
 
   if (EFI_ERROR (PopulateHeapGuardDebugProtocol ())) {
     DEBUG ((DEBUG_ERROR, "%a - Error finding heap guard debug protocol\n", __FUNCTION__));
@@ -1504,41 +1430,18 @@ DumpPagingInfo (
     return;
   }
 
-  if (LoadFlatPageTableData (
-        &Pte1GCount,
-        &Pte2MCount,
-        &Pte4KCount,
-        &PdeCount,
-        &GuardCount,
-        &Pte1GEntries,
-        &Pte2MEntries,
-        &Pte4KEntries,
-        &PdeEntries,
-        &GuardEntries
-        ))
-  {
-    CreateAndWriteFileSFS (mFs_Handle, L"1G.dat", Pte1GCount * sizeof (PAGE_TABLE_1G_ENTRY), Pte1GEntries);
-    CreateAndWriteFileSFS (mFs_Handle, L"2M.dat", Pte2MCount * sizeof (PAGE_TABLE_ENTRY), Pte2MEntries);
-    CreateAndWriteFileSFS (mFs_Handle, L"4K.dat", Pte4KCount * sizeof (PAGE_TABLE_4K_ENTRY), Pte4KEntries);
-    CreateAndWriteFileSFS (mFs_Handle, L"PDE.dat", PdeCount * sizeof (UINT64), PdeEntries);
-
-    // Only populate guard pages when function call is successful
-    for (UINT64 i = 0; i < GuardCount; i++) {
-      AsciiSPrint (
-        TempString,
-        MAX_STRING_SIZE,
-        "GuardPage,0x%016lx\n",
-        GuardEntries[i]
-        );
-      DEBUG ((DEBUG_ERROR, "%a  %s\n", __FUNCTION__, TempString));
-      AppendToMemoryInfoDatabase (TempString);
-    }
-  } else {
-    DEBUG ((DEBUG_ERROR, "%a - LoadFlatPageTableData returned with failure, bail from here!\n", __FUNCTION__));
+  Status = CollectPageTableSnapshot (&Snapshot);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a - CollectPageTableSnapshot returned with failure, bail from here!\n", __FUNCTION__));
     goto Cleanup;
   }
 
-  FlushAndClearMemoryInfoDatabase (L"GuardPage");
+  WriteBufferToFile (
+    L"PageTableSnapshot",
+    Snapshot,
+    sizeof (PAGE_TABLE_SNAPSHOT_HEADER) + (UINTN)Snapshot->RecordCount * sizeof (PAGE_TABLE_SNAPSHOT_RECORD)
+    );
+
   DumpProcessorSpecificHandlers ();
   MemoryMapDumpHandler ();
   LoadedImageTableDump ();
@@ -1546,24 +1449,8 @@ DumpPagingInfo (
   FlushAndClearMemoryInfoDatabase (L"MemoryInfoDatabase");
 
 Cleanup:
-  if (Pte1GEntries != NULL) {
-    FreePool (Pte1GEntries);
-  }
-
-  if (Pte2MEntries != NULL) {
-    FreePool (Pte2MEntries);
-  }
-
-  if (Pte4KEntries != NULL) {
-    FreePool (Pte4KEntries);
-  }
-
-  if (PdeEntries != NULL) {
-    FreePool (PdeEntries);
-  }
-
-  if (GuardEntries != NULL) {
-    FreePool (GuardEntries);
+  if (Snapshot != NULL) {
+    FreePool (Snapshot);
   }
 
   DEBUG ((DEBUG_ERROR, "%a leave - %r\n", __FUNCTION__, Status));
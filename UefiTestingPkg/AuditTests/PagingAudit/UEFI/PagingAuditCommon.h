@@ -143,6 +143,41 @@ typedef union {
   UINT64    Uint64;
 } PAGE_TABLE_1G_ENTRY;
 
+//
+// Binary page table snapshot written by the DXE paging audit to PageTableSnapshot.dat
+// and read by Windows\BinaryParsing.py.  The file is a PAGE_TABLE_SNAPSHOT_HEADER
+// followed by RecordCount PAGE_TABLE_SNAPSHOT_RECORD entries.  Each record describes a
+// run of EntryCount leaf entries of the same size and attributes that map contiguous
+// linear addresses to contiguous physical addresses.
+//
+#define PAGE_TABLE_SNAPSHOT_SIGNATURE  SIGNATURE_32 ('P', 'T', 'S', 'S')
+#define PAGE_TABLE_SNAPSHOT_VERSION    1
+
+#define PAGE_TABLE_SNAPSHOT_PAGE_4K  0
+#define PAGE_TABLE_SNAPSHOT_PAGE_2M  1
+#define PAGE_TABLE_SNAPSHOT_PAGE_1G  2
+
+#define PAGE_TABLE_SNAPSHOT_PRESENT     BIT0
+#define PAGE_TABLE_SNAPSHOT_READ_WRITE  BIT1
+#define PAGE_TABLE_SNAPSHOT_USER        BIT2
+#define PAGE_TABLE_SNAPSHOT_NX          BIT3
+#define PAGE_TABLE_SNAPSHOT_GUARD       BIT4      // Not present 4K guard page.  Address is the linear address.
+
+typedef struct {
+  UINT32    Signature;
+  UINT16    Version;
+  UINT16    RecordSize;                       // sizeof (PAGE_TABLE_SNAPSHOT_RECORD)
+  UINT64    RecordCount;
+} PAGE_TABLE_SNAPSHOT_HEADER;
+
+typedef struct {
+  UINT64    Address;                          // Physical address mapped by the first entry
+  UINT64    EntryCount;
+  UINT8     PageSize;                         // PAGE_TABLE_SNAPSHOT_PAGE_*
+  UINT8     Attributes;                       // PAGE_TABLE_SNAPSHOT_* bits
+  UINT8     Reserved[6];
+} PAGE_TABLE_SNAPSHOT_RECORD;
+
 #pragma pack()
 
 /**
@@ -157,7 +192,7 @@ CalculateMaximumSupportAddress (
 
 /**
   This helper function writes a string entry to the memory info database buffer.
-  If string would exceed current buffer allocation, it will realloc.
+  If string would exceed current buffer allocation, the allocation is doubled.
 
   NOTE: The buffer tracks its size. It does not work with NULL terminators.
 
@@ -100,4 +100,50 @@ def Parse1gPages(fileName, addressbits):
         pages.append(MemoryRange("PTEntry", "1g", Present, ReadWrite, Nx, MustBe1, User, PageTableBaseAddress))
         num += 1
     logging.debug("%d entries found in file %s" % (num, fileName))
-    return pages
\ No newline at end of file
+    return pages
+
+
+# Layout of PAGE_TABLE_SNAPSHOT_HEADER and PAGE_TABLE_SNAPSHOT_RECORD in UEFI/PagingAuditCommon.h
+PageTableSnapshotSignature = 0x53535450  # 'PTSS'
+PageTableSnapshotVersion = 1
+PageTableSnapshotHeader = struct.Struct("<IHHQ")
+PageTableSnapshotRecord = struct.Struct("<QQBB6x")
+PageTableSnapshotPageSizes = ("4k", "2m", "1g")
+PageTableSnapshotPresent = 0x01
+PageTableSnapshotReadWrite = 0x02
+PageTableSnapshotUser = 0x04
+PageTableSnapshotNx = 0x08
+PageTableSnapshotGuard = 0x10
+
+
+def ParsePageTableSnapshot(fileName, addressbits):
+    pages = []
+    logging.debug("-- Processing file '%s'..." % fileName)
+    with open(fileName, "rb") as file:
+        data = file.read()
+    if len(data) < PageTableSnapshotHeader.size:
+        raise Exception("Page table snapshot %s is truncated" % fileName)
+    Signature, Version, RecordSize, RecordCount = PageTableSnapshotHeader.unpack_from(data, 0)
+    if Signature != PageTableSnapshotSignature or Version != PageTableSnapshotVersion:
+        raise Exception("Page table snapshot %s has an unsupported signature or version" % fileName)
+    if RecordSize < PageTableSnapshotRecord.size or len(data) < PageTableSnapshotHeader.size + (RecordSize * RecordCount):
+        raise Exception("Page table snapshot %s is truncated" % fileName)
+
+    offset = PageTableSnapshotHeader.size
+    for _ in range(RecordCount):
+        Address, EntryCount, PageSize, Attributes = PageTableSnapshotRecord.unpack_from(data, offset)
+        offset += RecordSize
+        if Attributes & PageTableSnapshotGuard:
+            page = MemoryRange("GuardPage", "0x%x" % Address)
+        else:
+            page = MemoryRange("PTEntry", PageTableSnapshotPageSizes[PageSize],
+                               1 if Attributes & PageTableSnapshotPresent else 0,
+                               1 if Attributes & PageTableSnapshotReadWrite else 0,
+                               1 if Attributes & PageTableSnapshotNx else 0,
+                               1,
+                               1 if Attributes & PageTableSnapshotUser else 0,
+                               Address & addressbits)
+        page.setEntryCount(EntryCount)
+        pages.append(page)
+    logging.debug("%d ranges found in file %s" % (len(pages), fileName))
+    return pages
@@ -234,6 +234,12 @@ class MemoryRange(object):
     def getPageSizeStr(self):
         return self.PageSize
 
+    # Used for ranges that describe several consecutive entries of the same page size
+    def setEntryCount(self, count):
+        self.NumberOfEntries = count
+        self.PhysicalSize = self.getPageSize() * count
+        self.CalculateEnd()
+
     # Used to combine two page table entries with the same attributes
     def grow(self, other):
         self.NumberOfEntries += other.NumberOfEntries
@@ -311,6 +317,20 @@ class MemoryRange(object):
                             f"self.PhysicalEnd = {self.PhysicalEnd} " +
                             f"end_of_current = {end_of_current}" )
 
+        # A range of several whole entries split on an entry boundary becomes two
+        # ranges of whole entries rather than a partial page.
+        FirstSize = end_of_current + 1 - self.PhysicalStart
+        if (self.NumberOfEntries > 1) and (self.getPageSizeStr() in MemoryRange.PageSize) and \
+           (FirstSize % self.getPageSize() == 0):
+            next = copy.deepcopy(self)
+            self.PhysicalEnd = end_of_current
+            self.PhysicalSize = FirstSize
+            self.NumberOfEntries = FirstSize // self.getPageSize()
+            next.PhysicalStart = end_of_current + 1
+            next.PhysicalSize -= FirstSize
+            next.NumberOfEntries -= self.NumberOfEntries
+            return next
+
         self.PageSplit = True
         next = copy.deepcopy(self)
         self.PhysicalEnd = end_of_current
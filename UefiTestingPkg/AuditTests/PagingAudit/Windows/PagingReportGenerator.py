@@ -46,6 +46,7 @@ class ParsingTool(object):
         Pte4kbFileList =  glob.glob(os.path.join(self.DatFolderPath, "*4K*.dat"))
         MatFileList =  glob.glob(os.path.join(self.DatFolderPath, "*MAT*.dat"))
         GuardPageFileList =  glob.glob(os.path.join(self.DatFolderPath, "*GuardPage*.dat"))
+        SnapshotFileList =  glob.glob(os.path.join(self.DatFolderPath, "*PageTableSnapshot*.dat"))
 
         logging.debug("Found %d Info Files" % len(InfoFileList))
         logging.debug("Found %d 1gb Page Files" % len(Pte1gbFileList))
@@ -53,6 +54,7 @@ class ParsingTool(object):
         logging.debug("Found %d 4kb Page Files" % len(Pte4kbFileList))
         logging.debug("Found %d MAT Files" % len(MatFileList))
         logging.debug("Found %d GuardPage Files" % len(GuardPageFileList))
+        logging.debug("Found %d Page Table Snapshot Files" % len(SnapshotFileList))
 
 
         # Parse each file, keeping PTEs and "Memory Ranges" separate
@@ -88,6 +90,9 @@ class ParsingTool(object):
         for guardpage in GuardPageFileList:
             self.PageDirectoryInfo.extend(ParseInfoFile(guardpage))
 
+        for snapshot in SnapshotFileList:
+            self.PageDirectoryInfo.extend(ParsePageTableSnapshot(snapshot, self.AddressBits))
+
         for mat in MatFileList:
             self.MemoryAttributesTable.extend(ParseInfoFile(mat))
 
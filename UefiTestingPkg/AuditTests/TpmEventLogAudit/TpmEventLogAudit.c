@@ -14,27 +14,46 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/Tpm2CommandLib.h>
+#include <Library/TcgEventLogReplayLib.h>
 #include <Protocol/Tcg2Protocol.h>
 #include <IndustryStandard/UefiTcgPlatform.h>
 #include "TpmEventLogXml.h"
 
 /**
-  Add Header Event to XML List
+  Write Header Event to the XML output
 
+  @param[in]  Writer       XML writer positioned inside the Events element.
   @param[in]  EventHdr     TCG PCR event structure.
 **/
 EFI_STATUS
 AddHeaderEvent (
-  IN XmlNode            *RootNode,
+  IN XML_WRITER         *Writer,
   IN TCG_PCR_EVENT_HDR  *EventHdr
   )
 {
-  if (New_NodeInList (RootNode, (UINTN)EventHdr->PCRIndex, (UINTN)EventHdr->EventType, EventHdr->EventSize, (UINT8 *)(EventHdr + 1), 0, NULL) == NULL) {
-    DEBUG ((DEBUG_ERROR, "Failed to create new Header Node.  Event Type: %s PcrIndex: %g\n", EventHdr->EventType, EventHdr->PCRIndex));
-    return EFI_DEVICE_ERROR;
+  EFI_STATUS  Status;
+
+  Status = WriteEventEntry (Writer, (UINTN)EventHdr->PCRIndex, (UINTN)EventHdr->EventType, EventHdr->EventSize, (UINT8 *)(EventHdr + 1), 0, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to write Header Event.  Event Type: 0x%x PcrIndex: %d\n", EventHdr->EventType, EventHdr->PCRIndex));
   }
 
-  return EFI_SUCCESS;
+  return Status;
+}
+
+/**
+  XML_WRITER_FLUSH that appends each chunk of the manifest to the open file.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+WriteChunkToFile (
+  IN       VOID   *Context,
+  IN CONST CHAR8  *Buffer,
+  IN       UINTN  Length
+  )
+{
+  return ShellWriteFile ((SHELL_FILE_HANDLE)Context, &Length, (VOID *)Buffer);
 }
 
 /**
@@ -60,16 +79,18 @@ GetTcgEfiSpecIdEventStructSize (
 }
 
 /**
-  Add Event to Xml List
+  Write Event to the XML output
 
+  @param[in]  Writer           XML writer positioned inside the Events element.
   @param[in]  TcgPcrEvent2     TCG PCR event 2 structure.
 **/
 EFI_STATUS
 AddEvent (
-  IN XmlNode         *RootNode,
+  IN XML_WRITER      *Writer,
   IN TCG_PCR_EVENT2  *TcgPcrEvent2
   )
 {
+  EFI_STATUS     Status;
   UINT32         DigestIndex;
   UINT32         DigestCount;
   TPMI_ALG_HASH  HashAlgo;
@@ -95,12 +116,12 @@ AddEvent (
   CopyMem (&EventSize, DigestBuffer, sizeof (TcgPcrEvent2->EventSize));
   EventBuffer = DigestBuffer + sizeof (TcgPcrEvent2->EventSize);
 
-  if (New_NodeInList (RootNode, (UINTN)TcgPcrEvent2->PCRIndex, (UINTN)TcgPcrEvent2->EventType, EventSize, EventBuffer, TcgPcrEvent2->Digest.count, &TcgPcrEvent2->Digest) == NULL) {
-    DEBUG ((DEBUG_ERROR, "Failed to create new Event Node.  Event Type: %s PcrIndex: %g\n", TcgPcrEvent2->EventType, TcgPcrEvent2->PCRIndex));
-    return EFI_DEVICE_ERROR;
+  Status = WriteEventEntry (Writer, (UINTN)TcgPcrEvent2->PCRIndex, (UINTN)TcgPcrEvent2->EventType, EventSize, EventBuffer, TcgPcrEvent2->Digest.count, &TcgPcrEvent2->Digest);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to write Event.  Event Type: 0x%x PcrIndex: %d\n", TcgPcrEvent2->EventType, TcgPcrEvent2->PCRIndex));
   }
 
-  return EFI_SUCCESS;
+  return Status;
 }
 
 /**
@@ -166,24 +187,47 @@ DumpEventLog (
   TCG_PCR_EVENT2            *TcgPcrEvent2;
   TCG_EfiSpecIDEventStruct  *TcgEfiSpecIdEventStruct;
   UINTN                     NumberOfEvents;
-  XmlNode                   *List;
+  XML_WRITER                *Writer       = NULL;
   CHAR16                    LogFileName[] = L"TpmEventLogAudit_manifest.xml";
-  SHELL_FILE_HANDLE         FileHandle;
-  UINTN                     StringSize = 0;
-  CHAR8                     *XmlString = NULL;
+  SHELL_FILE_HANDLE         FileHandle    = NULL;
   EFI_STATUS                Status;
 
   switch (EventLogFormat) {
     case EFI_TCG2_EVENT_LOG_FORMAT_TCG_2:
-      List = New_EventsNodeList ();
-      if (List == NULL) {
-        Status = EFI_DEVICE_ERROR;
-        DEBUG ((DEBUG_ERROR, "Failed to allocate an XML list\n"));
+      Status = ShellOpenFileByName (LogFileName, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "Failed to open %s file for create. Status = %r\n", LogFileName, Status));
+        FileHandle = NULL;
+        goto Exit;
+      }
+
+      // Workaround start - delete the file if it exists and then reopen it to fix an issue where file data may be corrupted at the end
+      ShellDeleteFile (&FileHandle);
+      Status = ShellOpenFileByName (LogFileName, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "Failed to open %s file for create. Status = %r\n", LogFileName, Status));
+        FileHandle = NULL;
+        goto Exit;
+      }
+
+      // Workaround end
+
+      ShellPrintEx (-1, -1, L"Writing XML to file %s\n", LogFileName);
+
+      //
+      // Each event is written to the file as it is walked rather than collected in memory first
+      //
+      Status = XmlWriterCreate (WriteChunkToFile, FileHandle, XML_WRITER_DEFAULT_BUFFER_SIZE, &Writer);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "Failed to create xml writer.  %r\n", Status));
         goto Exit;
       }
 
+      XmlWriterDeclaration (Writer);
+      XmlWriterStartElement (Writer, LIST_ELEMENT_NAME);
+
       EventHdr = (TCG_PCR_EVENT_HDR *)(UINTN)EventLogLocation;
-      Status   = AddHeaderEvent (List, EventHdr);
+      Status   = AddHeaderEvent (Writer, EventHdr);
       if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "AddHeaderEvent failed.  %r\n", Status));
         goto Exit;
@@ -192,7 +236,7 @@ DumpEventLog (
       TcgEfiSpecIdEventStruct = (TCG_EfiSpecIDEventStruct *)(EventHdr + 1);
       TcgPcrEvent2            = (TCG_PCR_EVENT2 *)((UINTN)TcgEfiSpecIdEventStruct + GetTcgEfiSpecIdEventStructSize (TcgEfiSpecIdEventStruct));
       while ((UINTN)TcgPcrEvent2 <= EventLogLastEntry) {
-        Status = AddEvent (List, TcgPcrEvent2);
+        Status = AddEvent (Writer, TcgPcrEvent2);
         if (EFI_ERROR (Status)) {
           DEBUG ((DEBUG_ERROR, "AddEvent failed.  %r\n", Status));
           goto Exit;
@@ -206,7 +250,7 @@ DumpEventLog (
       } else {
         TcgPcrEvent2 = (TCG_PCR_EVENT2 *)(UINTN)(FinalEventsTable + 1);
         for (NumberOfEvents = 0; NumberOfEvents < FinalEventsTable->NumberOfEvents; NumberOfEvents++) {
-          Status = AddEvent (List, TcgPcrEvent2);
+          Status = AddEvent (Writer, TcgPcrEvent2);
           if (EFI_ERROR (Status)) {
             DEBUG ((DEBUG_ERROR, "AddEvent failed.  %r\n", Status));
             goto Exit;
@@ -216,64 +260,196 @@ DumpEventLog (
         }
       }
 
-      // Write XML
-      Status = XmlTreeToString (List, FALSE, &StringSize, &XmlString);
+      // Close the Events element and write whatever is still buffered
+      Status = XmlWriterFinish (Writer);
       if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "XmlNodeListToString failed.  %r\n", Status));
+        DEBUG ((DEBUG_ERROR, "Failed to write XML.  %r\n", Status));
         goto Exit;
       }
 
-      if (StringSize == 0) {
-        Status = EFI_OUT_OF_RESOURCES;
-        DEBUG ((DEBUG_ERROR, "StringSize equal 0.\n"));
-        goto Exit;
-      }
+      // success
+      Status = EFI_SUCCESS;
 
-      //
-      // subtract 1 from string size to avoid writing the NULL terminator
-      //
-      StringSize--;
+Exit:
+      XmlWriterFree (Writer);
 
-      Status = ShellOpenFileByName (LogFileName, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "Failed to open %s file for create. Status = %r\n", LogFileName, Status));
-        goto Exit;
-      } else {
-        // Workaround start - delete the file if it exists and then reopen it to fix an issue where file data may be corrupted at the end
-        ShellDeleteFile (&FileHandle);
-        Status = ShellOpenFileByName (LogFileName, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
+      if (FileHandle != NULL) {
+        // A manifest cut short by a failure would parse as a shorter event log, so delete it
         if (EFI_ERROR (Status)) {
-          DEBUG ((DEBUG_ERROR, "Failed to open %s file for create. Status = %r\n", LogFileName, Status));
-          goto Exit;
+          DEBUG ((DEBUG_ERROR, "Deleting incomplete %s\n", LogFileName));
+          ShellDeleteFile (&FileHandle);
+        } else {
+          ShellCloseFile (&FileHandle);
         }
+      }
+
+      break;
+
+    default:
+      Status = EFI_UNSUPPORTED;
+      break;
+  }
+
+  return Status & 0x7FFFFFFFFFFFFF;
+}
+
+/**
+  Replay the event log and compare the PCR values it produces with the PCRs of the TPM.
+
+  Events logged after the event log was retrieved are replayed from the final events
+  table. The result is printed; a mismatch is part of the audit output, not an error.
+
+  @param[in]  EventLogLocation   A pointer to the memory address of the event log.
+  @param[in]  EventLogLastEntry  A pointer to the address of the start of the last entry
+                                 in the event log in memory.
+  @param[in]  FinalEventsTable   A pointer to the final events table, or NULL.
+  @param[in]  FinalEventsLogged  Number of events of the final events table that were
+                                 already in the event log when it was retrieved.
+
+  @retval EFI_SUCCESS            The PCRs were compared and the result was printed.
+  @retval others                 The log could not be replayed or the PCRs could not be read.
+**/
+EFI_STATUS
+ComparePcrsWithEventLog (
+  IN EFI_PHYSICAL_ADDRESS         EventLogLocation,
+  IN EFI_PHYSICAL_ADDRESS         EventLogLastEntry,
+  IN EFI_TCG2_FINAL_EVENTS_TABLE  *FinalEventsTable OPTIONAL,
+  IN UINT64                       FinalEventsLogged
+  )
+{
+  EFI_STATUS                       Status;
+  TCG_EVENT_LOG_REPLAY             *Replay = NULL;
+  CONST TCG_EVENT_LOG_REPLAY_BANK  *Bank;
+  TCG_PCR_EVENT_HDR                *EventHdr;
+  TCG_PCR_EVENT2                   *FinalEvent;
+  TCG_PCR_EVENT2                   *FinalEventsStart;
+  UINTN                            EventLogSize;
+  UINT64                           FinalIndex;
+  UINT32                           BankIndex;
+  UINT32                           Remaining;
+  UINT32                           Returned;
+  UINT32                           Mismatched;
+  UINT32                           BankMismatched;
+  UINT32                           Index;
+  UINT32                           PcrUpdateCounter;
+  TPML_PCR_SELECTION               PcrSelectionIn;
+  TPML_PCR_SELECTION               PcrSelectionOut;
+  TPML_DIGEST                      PcrValues;
+  BOOLEAN                          AllMatch = TRUE;
+
+  EventHdr = (TCG_PCR_EVENT_HDR *)(UINTN)EventLogLocation;
+  if (EventLogLastEntry == EventLogLocation) {
+    EventLogSize = sizeof (TCG_PCR_EVENT_HDR) + EventHdr->EventSize;
+  } else {
+    EventLogSize = (UINTN)(EventLogLastEntry - EventLogLocation) + GetPcrEvent2Size ((TCG_PCR_EVENT2 *)(UINTN)EventLogLastEntry);
+  }
+
+  Status = TcgEventLogReplayCreate (EventHdr, EventLogSize, &Replay);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to replay the event log.  %r\n", Status));
+    goto Exit;
+  }
+
+  //
+  // The final events table holds every event logged since the first GetEventLog call.
+  // Skip the ones that were already in the retrieved log and replay the rest.
+  //
+  if ((FinalEventsTable != NULL) && (FinalEventsTable->NumberOfEvents > FinalEventsLogged)) {
+    FinalEvent = (TCG_PCR_EVENT2 *)(UINTN)(FinalEventsTable + 1);
+    for (FinalIndex = 0; FinalIndex < FinalEventsLogged; FinalIndex++) {
+      FinalEvent = (TCG_PCR_EVENT2 *)((UINT8 *)FinalEvent + GetPcrEvent2Size (FinalEvent));
+    }
 
-        // Workaround end
+    FinalEventsStart = FinalEvent;
+    for ( ; FinalIndex < FinalEventsTable->NumberOfEvents; FinalIndex++) {
+      FinalEvent = (TCG_PCR_EVENT2 *)((UINT8 *)FinalEvent + GetPcrEvent2Size (FinalEvent));
+    }
+
+    Status = TcgEventLogReplayAppend (
+               Replay,
+               FinalEventsStart,
+               (UINTN)((UINT8 *)FinalEvent - (UINT8 *)FinalEventsStart),
+               (UINTN)(FinalEventsTable->NumberOfEvents - FinalEventsLogged)
+               );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Failed to replay the final events table.  %r\n", Status));
+      goto Exit;
+    }
+  }
+
+  for (BankIndex = 0; BankIndex < Replay->BankCount; BankIndex++) {
+    Bank = &Replay->Bank[BankIndex];
+    if (!Bank->Replayed) {
+      ShellPrintEx (-1, -1, L"PCR bank 0x%x of the event log is not supported and was not replayed\n", Bank->HashAlg);
+      continue;
+    }
 
-        ShellPrintEx (-1, -1, L"Writing XML to file %s\n", LogFileName);
-        ShellWriteFile (FileHandle, &StringSize, XmlString);
-        ShellCloseFile (&FileHandle);
+    //
+    // The TPM returns at most 8 PCRs per read, so keep reading the ones it has not returned.
+    //
+    Remaining  = (UINT32)((1 << IMPLEMENTATION_PCR) - 1);
+    Mismatched = 0;
+    while (Remaining != 0) {
+      ZeroMem (&PcrSelectionIn, sizeof (PcrSelectionIn));
+      PcrSelectionIn.count                         = 1;
+      PcrSelectionIn.pcrSelections[0].hash         = Bank->HashAlg;
+      PcrSelectionIn.pcrSelections[0].sizeofSelect = PCR_SELECT_MAX;
+      for (Index = 0; Index < PCR_SELECT_MAX; Index++) {
+        PcrSelectionIn.pcrSelections[0].pcrSelect[Index] = (UINT8)(Remaining >> (Index * 8));
       }
 
-      // success
-      Status = EFI_SUCCESS;
+      Status = Tpm2PcrRead (&PcrSelectionIn, &PcrUpdateCounter, &PcrSelectionOut, &PcrValues);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "Failed to read PCR bank 0x%x.  %r\n", Bank->HashAlg, Status));
+        goto Exit;
+      }
 
-Exit:
-      if (List != NULL) {
-        FreeXmlTree (&List);
+      Returned = 0;
+      if (PcrSelectionOut.count == 1) {
+        for (Index = 0; Index < PcrSelectionOut.pcrSelections[0].sizeofSelect; Index++) {
+          Returned |= (UINT32)PcrSelectionOut.pcrSelections[0].pcrSelect[Index] << (Index * 8);
+        }
       }
 
-      if (XmlString != NULL) {
-        FreePool (XmlString);
+      //
+      // The bank is not allocated in the TPM.
+      //
+      if ((Returned & Remaining) == 0) {
+        break;
       }
 
-      break;
+      Status = TcgEventLogReplayComparePcrs (Replay, &PcrSelectionOut, &PcrValues, &BankMismatched);
+      if (EFI_ERROR (Status) && (Status != EFI_SECURITY_VIOLATION)) {
+        DEBUG ((DEBUG_ERROR, "Failed to compare PCR bank 0x%x.  %r\n", Bank->HashAlg, Status));
+        goto Exit;
+      }
 
-    default:
-      Status = EFI_UNSUPPORTED;
-      break;
+      Mismatched |= BankMismatched;
+      Remaining  &= ~Returned;
+    }
+
+    if (Remaining != 0) {
+      ShellPrintEx (-1, -1, L"PCR bank 0x%x of the event log is not active in the TPM\n", Bank->HashAlg);
+      AllMatch = FALSE;
+    } else if (Mismatched != 0) {
+      ShellPrintEx (-1, -1, L"PCR bank 0x%x does not match the event log.  Mismatched PCRs: 0x%06x\n", Bank->HashAlg, Mismatched);
+      AllMatch = FALSE;
+    } else {
+      ShellPrintEx (-1, -1, L"PCR bank 0x%x matches the event log\n", Bank->HashAlg);
+    }
   }
 
-  return Status & 0x7FFFFFFFFFFFFF;
+  if (AllMatch) {
+    ShellPrintEx (-1, -1, L"All PCR banks match the event log\n");
+  } else {
+    ShellPrintEx (-1, -1, L"The PCRs do not match the event log\n");
+  }
+
+  Status = EFI_SUCCESS;
+
+Exit:
+  TcgEventLogReplayFree (Replay);
+  return Status;
 }
 
 /**
@@ -292,11 +468,14 @@ UefiTestApp (
   IN EFI_SYSTEM_TABLE  *SystemTable
   )
 {
-  EFI_STATUS                 Status;
-  EFI_TCG2_PROTOCOL          *Tcg2Protocol;
-  EFI_PHYSICAL_ADDRESS       EventLogLocation, EventLogLastEntry;
-  BOOLEAN                    EventLogTruncated;
-  EFI_TCG2_EVENT_LOG_FORMAT  RequestedFormat = EFI_TCG2_EVENT_LOG_FORMAT_TCG_2;
+  EFI_STATUS                   Status;
+  EFI_STATUS                   CompareStatus;
+  EFI_TCG2_PROTOCOL            *Tcg2Protocol;
+  EFI_PHYSICAL_ADDRESS         EventLogLocation, EventLogLastEntry;
+  BOOLEAN                      EventLogTruncated;
+  EFI_TCG2_EVENT_LOG_FORMAT    RequestedFormat   = EFI_TCG2_EVENT_LOG_FORMAT_TCG_2;
+  EFI_TCG2_FINAL_EVENTS_TABLE  *FinalEventsTable = NULL;
+  UINT64                       FinalEventsLogged = 0;
 
   //
   // Initialize the shell lib (we must be in non-auto-init...)
@@ -332,7 +511,26 @@ UefiTestApp (
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Failed to retrieve the event log.  %r\n", Status));
     } else {
+      //
+      // Events of the final events table logged up to now are already in the retrieved log.
+      //
+      if (!EFI_ERROR (EfiGetSystemConfigurationTable (&gEfiTcg2FinalEventsTableGuid, (VOID **)&FinalEventsTable))) {
+        FinalEventsLogged = FinalEventsTable->NumberOfEvents;
+      } else {
+        FinalEventsTable = NULL;
+      }
+
       Status = DumpEventLog (RequestedFormat, EventLogLocation, EventLogLastEntry, NULL);
+
+      //
+      // The comparison only prints its result, the exit status reports the dump.
+      //
+      if (!EFI_ERROR (Status) && (EventLogLastEntry != 0)) {
+        CompareStatus = ComparePcrsWithEventLog (EventLogLocation, EventLogLastEntry, FinalEventsTable, FinalEventsLogged);
+        if (EFI_ERROR (CompareStatus)) {
+          ShellPrintEx (-1, -1, L"Failed to compare the PCRs with the event log.  %r\n", CompareStatus);
+        }
+      }
     }
   }
 
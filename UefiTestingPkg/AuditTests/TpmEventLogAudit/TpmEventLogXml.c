@@ -8,69 +8,45 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "TpmEventLogXml.h"
 
-#define LIST_XML_TEMPLATE    "<?xml version=\"1.0\" encoding=\"utf-8\"?><Events></Events>"
-#define DIGEST_XML_TEMPLATE  "<Digests></Digests>"
-
-#define MAX_STRING_LENGTH  (0xFFFF)
-
 // Helper functions
 
 /**
-Creates a new XmlNode list following the List
-format.
-
-Return NULL if error occurs. Otherwise return a pointer to xml doc root element
-of a Events.
-
-List must be freed using FreeNodeList
-
-Result will contain
-LIST Xml Template
-
+Writes an element with an integer value.
 **/
-XmlNode *
-EFIAPI
-New_EventsNodeList (
+STATIC
+EFI_STATUS
+WriteIntElement (
+  IN XML_WRITER   *Writer,
+  IN CONST CHAR8  *Name,
+  IN UINTN        Value
   )
 {
-  EFI_STATUS  Status;
-  XmlNode     *Root = NULL;
+  CHAR8  AsciiString[32];
 
-  Status = CreateXmlTree (LIST_XML_TEMPLATE, sizeof (LIST_XML_TEMPLATE) - 1, &Root);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a - Failed.  Status %r\n", __FUNCTION__, Status));
-    goto ERROR;
-  }
-
-  // Return the root
-  return Root;
-
-ERROR:
-  if (Root) {
-    FreeXmlTree (&Root);
-    // root will be NULL and null returned
-  }
-
-  return Root;
+  AsciiValueToStringS (AsciiString, sizeof (AsciiString), 0, (INT64)Value, 30);
+  return XmlWriterElement (Writer, Name, AsciiString);
 }
 
-#define NUM_OF_PAGES  (16)
-
 /**
-Creates a new XmlNode for an event and adds it to the list
+Writes a complete Event element, or a HeaderEvent element when DigestCount is 0.
 
-Return NULL if error occurs. Otherwise return a pointer Event Node.
+Event data and digests are hex encoded directly into the output, so there is
+no limit on the event size and no per event string allocation.
 
-List must be freed using FreeNodeList
-
-return pointer will be the Event element node
-EVENT_XML_TEMPLATE
+@param[in] Writer       -- Writer positioned inside the Events element.
+@param[in] PcrIndex     -- PCR the event was measured into.
+@param[in] EventType    -- Event type.
+@param[in] EventSize    -- Size of EventBuffer in bytes.
+@param[in] EventBuffer  -- Event data.
+@param[in] DigestCount  -- Number of digests in Digest.
+@param[in] Digest       -- Digests of the event.  Ignored when DigestCount is 0.
 
+@return  EFI_SUCCESS or underlying failure code.
 **/
-XmlNode *
+EFI_STATUS
 EFIAPI
-New_NodeInList (
-  IN CONST XmlNode       *RootNode,
+WriteEventEntry (
+  IN XML_WRITER          *Writer,
   IN UINTN               PcrIndex,
   IN UINTN               EventType,
   IN UINTN               EventSize,
@@ -79,146 +55,47 @@ New_NodeInList (
   IN TPML_DIGEST_VALUES  *Digest
   )
 {
-  XmlNode        *NewEventNode = NULL;
-  XmlNode        *TempNode     = NULL;
-  XmlNode        *DigestNode   = NULL;
-  CHAR8          *AsciiString  = NULL;
   EFI_STATUS     Status;
-  UINTN          i;
   UINTN          DigestIndex;
   TPMI_ALG_HASH  HashAlgo;
   UINTN          DigestSize;
   UINT8          *DigestBuffer;
-  UINT32         BufferSize;
-
-  BufferSize  = NUM_OF_PAGES * SIZE_4KB;
-  AsciiString = AllocatePages (NUM_OF_PAGES);  // allocate 64kb
-  if (AsciiString == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a - Failed to allocate 64kb for string conversion\n", __FUNCTION__));
-    return NULL;
-  }
-
-  // 1 - confirm good root node
-  if (RootNode == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a - RootNode is NULL\n", __FUNCTION__));
-    return NULL;
-  }
-
-  if (RootNode->XmlDeclaration.Declaration == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a - RootNode is not the root node\n", __FUNCTION__));
-    ASSERT (RootNode->XmlDeclaration.Declaration != NULL);
-    return NULL;
-  }
+  CHAR8          AsciiString[32];
 
-  if (AsciiStrnCmp (RootNode->Name, LIST_ELEMENT_NAME, sizeof (LIST_ELEMENT_NAME)) != 0) {
-    DEBUG ((DEBUG_ERROR, "%a - RootNode is not Event List\n", __FUNCTION__));
-    return NULL;
+  if ((Writer == NULL) || ((EventBuffer == NULL) && (EventSize != 0)) || ((Digest == NULL) && (DigestCount != 0))) {
+    DEBUG ((DEBUG_ERROR, "%a - Invalid parameter\n", __FUNCTION__));
+    return EFI_INVALID_PARAMETER;
   }
 
-  // RootNode is good.
-
   if (DigestCount > 0) {
-    // Create the event node with no parent
-    Status = AddNode (NULL, EVENT_ENTRY_ELEMENT_NAME, NULL, &NewEventNode);
+    XmlWriterStartElement (Writer, EVENT_ENTRY_ELEMENT_NAME);
   } else {
-    // Create the header node with no parent
-    Status = AddNode (NULL, HEADER_ENTRY_ELEMENT_NAME, NULL, &NewEventNode);
+    XmlWriterStartElement (Writer, HEADER_ENTRY_ELEMENT_NAME);
   }
 
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a - AddNode for Event Failed.  Status %r\n", __FUNCTION__, Status));
-    goto ERROR_EXIT;
-  }
+  WriteIntElement (Writer, EVENT_PCR_ELEMENT_NAME, PcrIndex);
+  WriteIntElement (Writer, EVENT_TYPE_ELEMENT_NAME, EventType);
+  WriteIntElement (Writer, EVENT_SIZE_ELEMENT_NAME, EventSize);
 
-  // Create the PcrIndex element
-  *AsciiString = '\0';
-  AsciiValueToStringS (AsciiString, BufferSize, 0, (INT64)PcrIndex, 30);
-  Status = AddNode (NewEventNode, EVENT_PCR_ELEMENT_NAME, AsciiString, &TempNode);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a - AddNode for PcrIndex Failed.  Status %r\n", __FUNCTION__, Status));
-    goto ERROR_EXIT;
-  }
-
-  // Create the EventType element
-  *AsciiString = '\0';
-  AsciiValueToStringS (AsciiString, BufferSize, 0, (INT64)EventType, 30);
-  Status = AddNode (NewEventNode, EVENT_TYPE_ELEMENT_NAME, AsciiString, &TempNode);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a - AddNode for EventType Failed.  Status %r\n", __FUNCTION__, Status));
-    goto ERROR_EXIT;
-  }
-
-  // Create the EventSize element
-  *AsciiString = '\0';
-  AsciiValueToStringS (AsciiString, BufferSize, 0, (INT64)EventSize, 30);
-  Status = AddNode (NewEventNode, EVENT_SIZE_ELEMENT_NAME, AsciiString, &TempNode);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a - AddNode for EventSize Failed.  Status %r\n", __FUNCTION__, Status));
-    goto ERROR_EXIT;
-  }
-
-  *AsciiString = '\0';
-  // convert the data into hex bytes
-  if (EventSize * 2 > MAX_STRING_LENGTH) {
-    DEBUG ((DEBUG_ERROR, "%a - Data Size Too Large for String conversion 0x%X\n", __FUNCTION__, EventSize * 2));
-    goto ERROR_EXIT;
-  }
-
-  for (i = 0; i < EventSize; i++) {
-    AsciiValueToStringS ((AsciiString + (i * 2)), BufferSize - (i * 2), (RADIX_HEX | PREFIX_ZERO), (INT64)EventBuffer[i], 2);
-  }
-
-  Status = AddNode (NewEventNode, EVENT_DATA_ELEMENT_NAME, AsciiString, &TempNode);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a - AddNode for EventData Failed.  Status %r\n", __FUNCTION__, Status));
-    goto ERROR_EXIT;
-  }
+  XmlWriterStartElement (Writer, EVENT_DATA_ELEMENT_NAME);
+  XmlWriterHexValue (Writer, EventBuffer, EventSize);
+  XmlWriterEndElement (Writer);
 
   if (DigestCount > 0) {
-    // Create the Event DigestCount element
-    *AsciiString = '\0';
-    AsciiValueToStringS (AsciiString, BufferSize, 0, (INT64)DigestCount, 30);
-    Status = AddNode (NewEventNode, EVENT_DIGEST_COUNT_ELEMENT_NAME, AsciiString, &TempNode);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a - AddNode for DigestCount Failed.  Status %r\n", __FUNCTION__, Status));
-      goto ERROR_EXIT;
-    }
+    WriteIntElement (Writer, EVENT_DIGEST_COUNT_ELEMENT_NAME, DigestCount);
 
-    Status = CreateXmlTree (DIGEST_XML_TEMPLATE, sizeof (DIGEST_XML_TEMPLATE) - 1, &DigestNode);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a - Failed.  Status %r\n", __FUNCTION__, Status));
-      goto ERROR_EXIT;
-    }
+    XmlWriterStartElement (Writer, EVENT_DIGESTS_ELEMENT_NAME);
 
     HashAlgo     = Digest->digests[0].hashAlg;
     DigestBuffer = (UINT8 *)Digest->digests[0].digest.sha1;
     for (DigestIndex = 0; DigestIndex < DigestCount; DigestIndex++) {
-      DigestSize   = GetHashSizeFromAlgo (HashAlgo);
-      *AsciiString = '\0';
-      // convert the data into hex bytes
-      if (DigestSize * 2 > MAX_STRING_LENGTH) {
-        DEBUG ((DEBUG_ERROR, "%a - Data Size Too Large for String conversion 0x%X\n", __FUNCTION__, DigestSize * 2));
-        goto ERROR_EXIT;
-      }
-
-      for (i = 0; i < DigestSize; i++) {
-        AsciiValueToStringS ((AsciiString + (i * 2)), BufferSize - (i * 2), (RADIX_HEX | PREFIX_ZERO), (INT64)DigestBuffer[i], 2);
-      }
+      DigestSize = GetHashSizeFromAlgo (HashAlgo);
 
-      Status = AddNode (DigestNode, EVENT_DIGEST_ELEMENT_NAME, AsciiString, &TempNode);
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "%a - AddNode for Digest Failed.  Status %r\n", __FUNCTION__, Status));
-        goto ERROR_EXIT;
-      }
-
-      // Add the HashAlgo attribute to Digest node
-      *AsciiString = '\0';
-      AsciiSPrint (AsciiString, MAX_STRING_LENGTH + 1, "%d", HashAlgo);
-      Status = AddAttributeToNode (TempNode, EVENT_HASH_ALGO_ATTRIBUTE_NAME, AsciiString);
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "%a - AddNodeAttribute for HashAlgo Failed.  Status %r\n", __FUNCTION__, Status));
-        goto ERROR_EXIT;
-      }
+      XmlWriterStartElement (Writer, EVENT_DIGEST_ELEMENT_NAME);
+      AsciiSPrint (AsciiString, sizeof (AsciiString), "%d", HashAlgo);
+      XmlWriterAttribute (Writer, EVENT_HASH_ALGO_ATTRIBUTE_NAME, AsciiString);
+      XmlWriterHexValue (Writer, DigestBuffer, DigestSize);
+      XmlWriterEndElement (Writer);
 
       //
       // Prepare next
@@ -227,41 +104,16 @@ New_NodeInList (
       DigestBuffer = DigestBuffer + DigestSize + sizeof (TPMI_ALG_HASH);
     }
 
-    // Add the DigestNode List to the end of the NewEventNode
-    Status = AddChildTree ((XmlNode *)NewEventNode, DigestNode);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a - Can't add DigestNode list to NewEventNode.  Status %r\n", __FUNCTION__, Status));
-      goto ERROR_EXIT;
-    }
+    XmlWriterEndElement (Writer);
   } else {
     DEBUG ((DEBUG_INFO, "Header node\n"));
   }
 
-  // Add the NewEventNode to the end of the RootNode children
-  Status = AddChildTree ((XmlNode *)RootNode, NewEventNode);
+  // writer errors are sticky so the final status covers the whole event
+  Status = XmlWriterEndElement (Writer);
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a - Can't add new event to list.  Status %r\n", __FUNCTION__, Status));
-    goto ERROR_EXIT;
-  }
-
-  return NewEventNode;
-
-ERROR_EXIT:
-  if (NewEventNode != NULL) {
-    FreeXmlTree (&NewEventNode);
-  }
-
-  if (TempNode != NULL) {
-    FreeXmlTree (&TempNode);
-  }
-
-  if (DigestNode != NULL) {
-    FreeXmlTree (&DigestNode);
-  }
-
-  if (AsciiString != NULL) {
-    FreePages (AsciiString, NUM_OF_PAGES);
+    DEBUG ((DEBUG_ERROR, "%a - Writing event Failed.  Status %r\n", __FUNCTION__, Status));
   }
 
-  return NULL;
+  return Status;
 }
@@ -16,9 +16,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/PrintLib.h>
-#include <XmlTypes.h>
-#include <Library/XmlTreeLib.h>
-#include <Library/XmlTreeQueryLib.h>
+#include <Library/XmlWriterLib.h>
 #include <Library/ShellLib.h>
 #include <Library/Tpm2CommandLib.h>
 #include <IndustryStandard/UefiTcgPlatform.h>
@@ -62,38 +60,22 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define EVENT_DIGEST_ELEMENT_NAME        "Digest"
 
 /**
-Creates a new XmlNode list following the List
-format.
+Writes a complete Event element, or a HeaderEvent element when DigestCount is 0.
 
-Return NULL if error occurs. Otherwise return a pointer to xml doc root element
-of Events.
-
-List must be freed using FreeNodeList
-
-Result will contain
-LIST Xml Template
-
-**/
-XmlNode *
-EFIAPI
-New_EventsNodeList (
-  );
-
-/**
-Creates a new XmlNode for an event and adds it to the list
-
-Return NULL if error occurs. Otherwise return a pointer Event Node.
-
-List must be freed using FreeNodeList
-
-return pointer will be the Event element node
-EVENT_XML_TEMPLATE
+@param[in] Writer       -- Writer positioned inside the Events element.
+@param[in] PcrIndex     -- PCR the event was measured into.
+@param[in] EventType    -- Event type.
+@param[in] EventSize    -- Size of EventBuffer in bytes.
+@param[in] EventBuffer  -- Event data.
+@param[in] DigestCount  -- Number of digests in Digest.
+@param[in] Digest       -- Digests of the event.  Ignored when DigestCount is 0.
 
+@return  EFI_SUCCESS or underlying failure code.
 **/
-XmlNode *
+EFI_STATUS
 EFIAPI
-New_NodeInList (
-  IN CONST XmlNode       *RootNode,
+WriteEventEntry (
+  IN XML_WRITER          *Writer,
   IN UINTN               PcrIndex,
   IN UINTN               EventType,
   IN UINTN               EventSize,
@@ -24,128 +24,173 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define MAX_NAME_LEN   1024
 #define MAX_NAME_SIZE  (MAX_NAME_LEN * sizeof(CHAR16 ))
 
-XmlNode *
+//
+// Name and guid of a variable found by CreateListOfAllVars
+//
+typedef struct {
+  LIST_ENTRY    Link;
+  EFI_GUID      VarGuid;
+  CHAR16        VarName[1];   // variable length, NULL terminated
+} VAR_LIST_ENTRY;
+
+/**
+  Collect the name and guid of every variable.
+
+  Variables are deleted and restored while they are tested, which changes the order
+  GetNextVariableName returns them in, so all names are collected before any test starts.
+  Only names are kept; the data is read again when the variable is tested.
+
+  @param[out] List  Initialized list head that receives a VAR_LIST_ENTRY per variable.
+
+  @retval EFI_SUCCESS           All variables were added to the list.
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+**/
+EFI_STATUS
 EFIAPI
 CreateListOfAllVars (
+  OUT LIST_ENTRY  *List
   )
 {
-  EFI_STATUS  Status;
-  CHAR16      varName[MAX_NAME_LEN];
-  EFI_GUID    varGuid;
-  UINTN       varNameSize;
-  XmlNode     *List;
-
-  List = New_VariablesNodeList ();
-  if (List == NULL) {
-    DEBUG ((DEBUG_ERROR, "Failed to allocate an XML list\n"));
-    return NULL;
-  }
+  EFI_STATUS      Status;
+  CHAR16          varName[MAX_NAME_LEN];
+  EFI_GUID        varGuid;
+  UINTN           varNameSize;
+  VAR_LIST_ENTRY  *Entry;
 
   ZeroMem (&varGuid, sizeof (EFI_GUID));
   varName[0]  = L'\0';
   varNameSize = MAX_NAME_SIZE;
   Status      = gRT->GetNextVariableName (&varNameSize, &varName[0], &varGuid);
   while (!EFI_ERROR (Status)) {
-    UINT8   *varData      = NULL;
-    UINTN   varDataSize   = 0;
-    UINT32  varAttributes = 0;
-
-    Status = GetVariable3 (varName, &varGuid, (VOID **)&varData, &varDataSize, &varAttributes);
-    if (!EFI_ERROR (Status)) {
-      if (New_VariableNodeInList (List, varName, &varGuid, varAttributes, varDataSize, varData) == NULL) {
-        DEBUG ((DEBUG_ERROR, "Failed to create new Var Node.  Var Name: %s Guid: %g\n", varName, &varGuid));
-        Status = EFI_DEVICE_ERROR;
-      }
+    Entry = AllocatePool (OFFSET_OF (VAR_LIST_ENTRY, VarName) + StrSize (varName));
+    if (Entry == NULL) {
+      DEBUG ((DEBUG_ERROR, "Failed to allocate list entry.  Var Name: %s Guid: %g\n", varName, &varGuid));
+      return EFI_OUT_OF_RESOURCES;
     }
 
-    if (varData) {
-      FreePool (varData);
-    }
+    CopyGuid (&Entry->VarGuid, &varGuid);
+    CopyMem (Entry->VarName, varName, StrSize (varName));
+    InsertTailList (List, &Entry->Link);
 
     // get next
     varNameSize = MAX_NAME_SIZE;
     Status      = gRT->GetNextVariableName (&varNameSize, &varName[0], &varGuid);
   }
 
-  return List;
+  return EFI_SUCCESS;
+}
+
+VOID
+EFIAPI
+FreeListOfAllVars (
+  IN LIST_ENTRY  *List
+  )
+{
+  LIST_ENTRY  *Link;
+
+  while (!IsListEmpty (List)) {
+    Link = GetFirstNode (List);
+    RemoveEntryList (Link);
+    FreePool (BASE_CR (Link, VAR_LIST_ENTRY, Link));
+  }
 }
 
+/**
+  Test every variable in the list and stream one Variable element per variable.
+
+  @param[in] List    List created by CreateListOfAllVars.
+  @param[in] Writer  Writer positioned inside the Variables element.
+
+  @retval EFI_SUCCESS  All variables were tested.
+  @retval Others       A variable could not be read or writing the results failed.
+**/
 EFI_STATUS
 EFIAPI
-UpdateListWithReadWriteInfo (
-  XmlNode  *List
+WriteListWithReadWriteInfo (
+  IN LIST_ENTRY  *List,
+  IN XML_WRITER  *Writer
   )
 {
   EFI_STATUS  Status;
   LIST_ENTRY  *Link = NULL;
 
-  if (List == NULL) {
+  if ((List == NULL) || (Writer == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  // loop thru all children of the list
-  if (List->ParentNode != NULL) {
-    DEBUG ((DEBUG_ERROR, "!!!ERROR: BAD XML.  List should be head node\n"));
-    return EFI_INVALID_PARAMETER;
-  }
-
-  // Loop thru all children which should be variable nodes
-  for (Link = List->ChildrenListHead.ForwardLink; Link != &(List->ChildrenListHead); Link = Link->ForwardLink) {
-    XmlNode     *Current = (XmlNode *)Link;
-    CHAR16      *varName = NULL;
-    EFI_GUID    varGuid;
-    UINT8       *varData         = NULL;
-    UINTN       varDataSize      = 0;
-    UINT32      varAttributes    = 0;
-    EFI_STATUS  StatusFromDelete = EFI_SUCCESS;
-
-    // Get current info
-    Status = GetNameGuidMembersFromNode (Current, &varName, &varGuid);
+  for (Link = GetFirstNode (List); !IsNull (List, Link); Link = GetNextNode (List, Link)) {
+    VAR_LIST_ENTRY  *Current         = BASE_CR (Link, VAR_LIST_ENTRY, Link);
+    CHAR16          *varName         = Current->VarName;
+    EFI_GUID        *varGuid         = &Current->VarGuid;
+    UINT8           *varData         = NULL;
+    UINTN           varDataSize      = 0;
+    UINT32          varAttributes    = 0;
+    EFI_STATUS      StatusFromDelete = EFI_SUCCESS;
+
+    // Get current data
+    Status = GetVariable3 (varName, varGuid, (VOID **)&varData, &varDataSize, &varAttributes);
     if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a Failed in GetNameGuidMembers.  Status = %r\n", __FUNCTION__, Status));
+      DEBUG ((DEBUG_ERROR, "%a Failed in GetVar3 for %g.  Status = %r\n", __FUNCTION__, varGuid, Status));
       return Status;
     }
 
-    // Get current data - don't use XML stringified data...easier just to read binary again
-    Status = GetVariable3 (varName, &varGuid, (VOID **)&varData, &varDataSize, &varAttributes);
+    Status = WriteVariableEntryStart (Writer, varName, varGuid, varAttributes, varDataSize, varData);
     if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a Failed in GetVar3.  Status = %r\n", __FUNCTION__, Status));
-      FreePool (varName);
+      if (varData != NULL) {
+        FreePool (varData);
+      }
+
       return Status;
     }
 
-    DEBUG ((DEBUG_INFO, "%a testing write properties for var %g", __FUNCTION__, &varGuid));
+    DEBUG ((DEBUG_INFO, "%a testing write properties for var %g", __FUNCTION__, varGuid));
     DEBUG ((DEBUG_INFO, " ::%s", varName));
     DEBUG ((DEBUG_INFO, "\n"));  // do independent debug print so that we always have newline.  Some names can be long and overrun the debug buffer
 
     // Delete current var
-    StatusFromDelete = gRT->SetVariable (varName, &varGuid, varAttributes, 0, NULL);
-    Status           = AddReadyToBootStatusToNode (Current, EFI_SUCCESS, StatusFromDelete);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a failed in AddReadyToBootStatusToNode.  Status = %r\n", __FUNCTION__, Status));
-    }
+    StatusFromDelete = gRT->SetVariable (varName, varGuid, varAttributes, 0, NULL);
+    Status           = WriteReadyToBootStatus (Writer, EFI_SUCCESS, StatusFromDelete);
 
     // restore if needed
     if (!EFI_ERROR (StatusFromDelete)) {
-      Status = gRT->SetVariable (varName, &varGuid, varAttributes, varDataSize, varData);
-      if (EFI_ERROR (Status)) {
-        DEBUG ((DEBUG_ERROR, "%a failed to restore variable data.  Status = %r\n", __FUNCTION__, Status));
+      if (EFI_ERROR (gRT->SetVariable (varName, varGuid, varAttributes, varDataSize, varData))) {
+        DEBUG ((DEBUG_ERROR, "%a failed to restore variable data.\n", __FUNCTION__));
       }
     }
 
     // clean up
-    if (varName != NULL) {
-      FreePool (varName);
-    }
-
     if (varData != NULL) {
       FreePool (varData);
     }
+
+    if (!EFI_ERROR (Status)) {
+      Status = XmlWriterEndElement (Writer);
+    }
+
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a failed to write results.  Status = %r\n", __FUNCTION__, Status));
+      return Status;
+    }
   }
 
   return EFI_SUCCESS;
 }
 
+/**
+  XML_WRITER_FLUSH that appends each chunk of the manifest to the open file.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+WriteChunkToFile (
+  IN       VOID   *Context,
+  IN CONST CHAR8  *Buffer,
+  IN       UINTN  Length
+  )
+{
+  return ShellWriteFile ((SHELL_FILE_HANDLE)Context, &Length, (VOID *)Buffer);
+}
+
 /**
   The user Entry Point for Application. The user code starts with this function
   as the real entry point for the application.
@@ -166,43 +211,18 @@ LockTestEntry (
 {
   EFI_STATUS         Status;
   CHAR16             LogFileName[] = L"UefiVarLockAudit_manifest.xml";
-  SHELL_FILE_HANDLE  FileHandle;
-  XmlNode            *MyList    = NULL;
-  UINTN              StringSize = 0;
-  CHAR8              *XmlString = NULL;
-
-  MyList = CreateListOfAllVars ();
-  if (MyList == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    DEBUG ((DEBUG_ERROR, "Failed to get list of vars Status = %r\n", Status));
-    goto Exit;
-  }
+  SHELL_FILE_HANDLE  FileHandle    = NULL;
+  LIST_ENTRY         VarList;
+  XML_WRITER         *Writer = NULL;
 
-  // Get R/W properties
-  Status = UpdateListWithReadWriteInfo (MyList);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Failed to Update List with Read/Write Properties = %r\n", Status));
-    goto Exit;
-  }
+  InitializeListHead (&VarList);
 
-  // Write XML
-  Status = XmlTreeToString (MyList, TRUE, &StringSize, &XmlString);
+  Status = CreateListOfAllVars (&VarList);
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "XmlTreeToString failed.  %r\n", Status));
-    goto Exit;
-  }
-
-  if (StringSize == 0) {
-    Status = EFI_OUT_OF_RESOURCES;
-    DEBUG ((DEBUG_ERROR, "StringSize equal 0.\n"));
+    DEBUG ((DEBUG_ERROR, "Failed to get list of vars Status = %r\n", Status));
     goto Exit;
   }
 
-  //
-  // subtract 1 from string size to avoid writing the NULL terminator
-  //
-  StringSize--;
-
   //
   // First lets open the file if it exists so we can delete it...This is the work around for truncation
   //
@@ -218,24 +238,56 @@ LockTestEntry (
   Status = ShellOpenFileByName (LogFileName, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to open %s file for create. Status = %r\n", LogFileName, Status));
+    FileHandle = NULL;
+    goto Exit;
+  }
+
+  ShellPrintEx (-1, -1, L"Writing XML to file %s\n", LogFileName);
+
+  //
+  // Results are written as each variable is tested rather than collected in memory first
+  //
+  Status = XmlWriterCreate (WriteChunkToFile, FileHandle, XML_WRITER_DEFAULT_BUFFER_SIZE, &Writer);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to create xml writer.  %r\n", Status));
+    goto Exit;
+  }
+
+  XmlWriterDeclaration (Writer);
+  XmlWriterStartElement (Writer, LIST_ELEMENT_NAME);
+
+  // Get R/W properties
+  Status = WriteListWithReadWriteInfo (&VarList, Writer);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to write Read/Write Properties = %r\n", Status));
+    goto Exit;
+  }
+
+  Status = XmlWriterFinish (Writer);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to write XML.  %r\n", Status));
     goto Exit;
-  } else {
-    ShellPrintEx (-1, -1, L"Writing XML to file %s\n", LogFileName);
-    ShellWriteFile (FileHandle, &StringSize, XmlString);
-    ShellCloseFile (&FileHandle);
   }
 
   // success
   Status = EFI_SUCCESS;
 
 Exit:
-  if (MyList != NULL) {
-    FreeXmlTree (&MyList);
-  }
+  XmlWriterFree (Writer);
 
-  if (XmlString != NULL) {
-    FreePool (XmlString);
+  if (FileHandle != NULL) {
+    //
+    // Don't leave a truncated manifest behind for the parser to pick up as a result
+    //
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Deleting incomplete %s\n", LogFileName));
+      ShellDeleteFile (&FileHandle);
+    } else {
+      ShellCloseFile (&FileHandle);
+    }
   }
 
+  FreeListOfAllVars (&VarList);
+
   return Status & 0x7FFFFFFFFFFFFF;
 }
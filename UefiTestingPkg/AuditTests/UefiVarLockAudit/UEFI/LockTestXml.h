@@ -16,9 +16,7 @@
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/PrintLib.h>
-#include <XmlTypes.h>
-#include <Library/XmlTreeLib.h>
-#include <Library/XmlTreeQueryLib.h>
+#include <Library/XmlWriterLib.h>
 #include <Library/ShellLib.h>
 
 /**
@@ -52,66 +50,41 @@
 #define VAR_WRITE_STATUS_ELEMENT_NAME  "WriteStatus"
 
 /**
-Creates a new XmlNode list following the List
-format.
-
-Return NULL if error occurs. Otherwise return a pointer to xml doc root element
-of a Variables.
-
-List must be freed using FreeXmlTree
-
-Result will contain
-LIST Xml Template
-
+Writes the start of a Variable element along with its Attributes, Size and Data
+children.  The caller may add status elements and then ends the element with
+XmlWriterEndElement.
+
+@param[in] Writer      -- Writer positioned inside the Variables element.
+@param[in] VarName     -- Variable name.
+@param[in] VarGuid     -- Variable vendor guid.
+@param[in] Attributes  -- Variable attributes.
+@param[in] DataSize    -- Size of Data in bytes.
+@param[in] Data        -- Variable data.
+
+@return  EFI_SUCCESS or underlying failure code.
 **/
-XmlNode *
+EFI_STATUS
 EFIAPI
-New_VariablesNodeList (
+WriteVariableEntryStart (
+  IN XML_WRITER    *Writer,
+  IN CONST CHAR16  *VarName,
+  IN CONST GUID    *VarGuid,
+  IN UINT32        Attributes,
+  IN UINTN         DataSize,
+  IN CONST UINT8   *Data
   );
 
 /**
-Creates a new XmlNode for a var and adds it to the list
-
-Return NULL if error occurs. Otherwise return a pointer Variable Node.
-
-List must be freed using FreeXmlTree
-
-return pointer will be the variable element node
-VAR_XML_TEMPLATE
+Writes a ReadyToBoot element with the read and write status of the current variable.
 
+@return  EFI_SUCCESS or underlying failure code.
 **/
-XmlNode *
-EFIAPI
-New_VariableNodeInList (
-  IN CONST XmlNode  *RootNode,
-  IN CONST CHAR16   *VarName,
-  IN CONST GUID     *VarGuid,
-  IN UINT32         Attributes,
-  IN UINTN          DataSize,
-  IN CONST UINT8    *Data
-  );
-
-EFI_STATUS
-EFIAPI
-AddReadyToBootStatusToNode (
-  IN CONST XmlNode  *Node,
-  IN EFI_STATUS     ReadStatus,
-  IN EFI_STATUS     WriteStatus
-  );
-
-EFI_STATUS
-EFIAPI
-GetNameGuidMembersFromNode (
-  IN CONST  XmlNode   *Node,
-  OUT       CHAR16    **VarName,
-  OUT       EFI_GUID  *VarGuid
-  );
-
 EFI_STATUS
 EFIAPI
-ConvertAsciiStringToGuid (
-  IN CONST CHAR8   *StringGuid,
-  IN OUT EFI_GUID  *Guid
+WriteReadyToBootStatus (
+  IN XML_WRITER  *Writer,
+  IN EFI_STATUS  ReadStatus,
+  IN EFI_STATUS  WriteStatus
   );
 
 #endif
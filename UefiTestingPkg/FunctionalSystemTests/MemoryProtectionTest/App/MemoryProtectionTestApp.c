@@ -40,6 +40,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "../MemoryProtectionTestCommon.h"
 #include "UefiHardwareNxProtectionStub.h"
+#include "RecoverableFaultStub.h"
 
 #define UNIT_TEST_APP_NAME     "Heap Guard Test"
 #define UNIT_TEST_APP_VERSION  "0.5"
@@ -53,6 +54,17 @@ MM_MEMORY_PROTECTION_SETTINGS            mMmMps;
 DXE_MEMORY_PROTECTION_SETTINGS           mDxeMps;
 MEMORY_PROTECTION_NONSTOP_MODE_PROTOCOL  *mNonstopModeProtocol      = NULL;
 MEMORY_PROTECTION_DEBUG_PROTOCOL         *mMemoryProtectionProtocol = NULL;
+volatile UNIT_TEST_FRAMEWORK             *mFw                       = NULL;
+
+//
+// Recoverable fault mode state. When active, the page fault handler returns to the
+// SetJump() in RunExpectingFault() instead of resetting the system.
+//
+BOOLEAN                   mRecoverableFaultActive = FALSE;
+BASE_LIBRARY_JUMP_BUFFER  mFaultJumpBuffer;
+volatile BOOLEAN          mFaultArmed   = FALSE;
+volatile BOOLEAN          mFaultTaken   = FALSE;
+volatile UINTN            mFaultAddress = 0;
 
 /// ================================================================================================
 /// ================================================================================================
@@ -257,6 +269,50 @@ InterruptHandler (
   ResetWarm ();
 } // InterruptHandler()
 
+#if defined (MDE_CPU_X64)
+
+/**
+  Returns to the SetJump() in RunExpectingFault(). Runs after the recoverable fault handler
+  returns from the exception.
+**/
+STATIC
+VOID
+ResumeAfterFault (
+  VOID
+  )
+{
+  LongJump (&mFaultJumpBuffer, 1);
+} // ResumeAfterFault()
+
+/**
+  Records an expected fault and resumes the test which armed it. Faults which were not
+  armed by RunExpectingFault() reset the system in the same way as InterruptHandler().
+
+  @param  InterruptType    Defines the type of interrupt or exception that
+                           occurred on the processor.This parameter is processor architecture specific.
+  @param  SystemContext    A pointer to the processor context when
+                           the interrupt occurred on the processor.
+**/
+VOID
+EFIAPI
+RecoverableFaultHandler (
+  IN EFI_EXCEPTION_TYPE  InterruptType,
+  IN EFI_SYSTEM_CONTEXT  SystemContext
+  )
+{
+  if (!mFaultArmed) {
+    ResetWarm ();
+  }
+
+  mFaultArmed   = FALSE;
+  mFaultTaken   = TRUE;
+  mFaultAddress = GetFaultAddress (SystemContext);
+
+  RedirectFaultContext (SystemContext, &mFaultJumpBuffer, (VOID *)(UINTN)ResumeAfterFault);
+} // RecoverableFaultHandler()
+
+#endif
+
 /**
   This helper function returns EFI_SUCCESS if the Nonstop protocol is installed.
 
@@ -553,6 +609,123 @@ VOID
   VOID
   );
 
+typedef
+VOID
+(*EXPECTED_FAULT_FUNCTION)(
+  IN UINTN  Argument1,
+  IN UINTN  Argument2
+  );
+
+/**
+  Calls a function which is expected to fault while the recoverable fault handler is armed.
+
+  @param[in]  Function      Function to call.
+  @param[in]  Argument1     First argument passed to Function.
+  @param[in]  Argument2     Second argument passed to Function.
+  @param[out] FaultAddress  The faulting address, or 0 if no fault occurred.
+
+  @retval TRUE    Function faulted and execution was resumed.
+  @retval FALSE   Function returned without faulting.
+**/
+STATIC
+BOOLEAN
+RunExpectingFault (
+  IN  EXPECTED_FAULT_FUNCTION  Function,
+  IN  UINTN                    Argument1,
+  IN  UINTN                    Argument2,
+  OUT UINTN                    *FaultAddress
+  )
+{
+  mFaultTaken   = FALSE;
+  mFaultAddress = 0;
+
+  if (SetJump (&mFaultJumpBuffer) == 0) {
+    mFaultArmed = TRUE;
+    Function (Argument1, Argument2);
+    mFaultArmed = FALSE;
+  }
+
+  *FaultAddress = mFaultAddress;
+
+  if (mFaultTaken) {
+    UT_LOG_INFO ("Caught expected fault at 0x%p\n", (VOID *)*FaultAddress);
+  }
+
+  return mFaultTaken;
+} // RunExpectingFault()
+
+STATIC
+VOID
+HeadPageFault (
+  IN UINTN  Address,
+  IN UINTN  Unused
+  )
+{
+  HeadPageTest ((UINT64 *)Address);
+}
+
+STATIC
+VOID
+TailPageFault (
+  IN UINTN  Address,
+  IN UINTN  Unused
+  )
+{
+  TailPageTest ((UINT64 *)Address);
+}
+
+STATIC
+VOID
+PoolFault (
+  IN UINTN  Address,
+  IN UINTN  AllocationSize
+  )
+{
+  PoolTest ((UINT64 *)Address, AllocationSize);
+}
+
+STATIC
+VOID
+StackOverflowFault (
+  IN UINTN  Unused1,
+  IN UINTN  Unused2
+  )
+{
+  Recursion (1);
+}
+
+STATIC
+VOID
+NullReadFault (
+  IN UINTN  Unused1,
+  IN UINTN  Unused2
+  )
+{
+  if (mFw->Title == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a - Should have failed \n", __FUNCTION__));
+  }
+}
+
+STATIC
+VOID
+NullWriteFault (
+  IN UINTN  Unused1,
+  IN UINTN  Unused2
+  )
+{
+  mFw->Title = "Title";
+}
+
+STATIC
+VOID
+ExecuteFault (
+  IN UINTN  Address,
+  IN UINTN  Unused
+  )
+{
+  ((DUMMY_VOID_FUNCTION_FOR_DATA_TEST)Address)();
+}
+
 /**
   This is a function that serves as a placeholder in the driver code region.
   This function address will be written to by the SmmMemoryProtectionsSelfTestCode()
@@ -841,6 +1014,10 @@ UefiPageGuard (
   MEMORY_PROTECTION_TEST_CONTEXT  MemoryProtectionContext = (*(MEMORY_PROTECTION_TEST_CONTEXT *)Context);
   EFI_PHYSICAL_ADDRESS            ptr;
   EFI_STATUS                      Status;
+  BOOLEAN                         HeadFaulted;
+  BOOLEAN                         TailFaulted;
+  UINTN                           HeadFaultAddress;
+  UINTN                           TailFaultAddress;
 
   DEBUG ((DEBUG_INFO, "%a - Testing Type: %a\n", __FUNCTION__, MEMORY_TYPES[MemoryProtectionContext.TargetMemoryType]));
 
@@ -881,6 +1058,33 @@ UefiPageGuard (
     return UNIT_TEST_PASSED;
   }
 
+  if (mRecoverableFaultActive) {
+    Status = gBS->AllocatePages (AllocateAnyPages, (EFI_MEMORY_TYPE)MemoryProtectionContext.TargetMemoryType, 1, (EFI_PHYSICAL_ADDRESS *)&ptr);
+    if (EFI_ERROR (Status)) {
+      UT_LOG_WARNING ("Memory allocation failed for type %a - %r\n", MEMORY_TYPES[MemoryProtectionContext.TargetMemoryType], Status);
+      return UNIT_TEST_SKIPPED;
+    }
+
+    HeadFaulted = RunExpectingFault (HeadPageFault, (UINTN)ptr, 0, &HeadFaultAddress);
+    TailFaulted = RunExpectingFault (TailPageFault, (UINTN)ptr, 0, &TailFaultAddress);
+
+    gBS->FreePages (ptr, 1);
+
+    if (!HeadFaulted) {
+      UT_LOG_ERROR ("Head guard page failed: %p", ptr);
+    }
+
+    if (!TailFaulted) {
+      UT_LOG_ERROR ("Tail guard page failed: %p", ptr);
+    }
+
+    UT_ASSERT_TRUE (HeadFaulted && TailFaulted);
+    UT_ASSERT_EQUAL (HeadFaultAddress & ~(UINTN)EFI_PAGE_MASK, (UINTN)ptr - EFI_PAGE_SIZE);
+    UT_ASSERT_EQUAL (TailFaultAddress & ~(UINTN)EFI_PAGE_MASK, (UINTN)ptr + EFI_PAGE_SIZE);
+
+    return UNIT_TEST_PASSED;
+  }
+
   if (MemoryProtectionContext.TestProgress < 2) {
     //
     // Context.TestProgress indicates progress within this specific test.
@@ -944,6 +1148,8 @@ UefiPoolGuard (
   EFI_STATUS                      Status;
   UINTN                           AllocationSize;
   UINT8                           Index = 0;
+  BOOLEAN                         Faulted;
+  UINTN                           FaultAddress;
 
   DEBUG ((DEBUG_INFO, "%a - Testing Type: %a\n", __FUNCTION__, MEMORY_TYPES[MemoryProtectionContext.TargetMemoryType]));
 
@@ -985,6 +1191,30 @@ UefiPoolGuard (
     return UNIT_TEST_PASSED;
   }
 
+  if (mRecoverableFaultActive) {
+    for (Index = 0; Index < NUM_POOL_SIZES; Index++) {
+      AllocationSize = mPoolSizeTable[Index];
+
+      Status = gBS->AllocatePool ((EFI_MEMORY_TYPE)MemoryProtectionContext.TargetMemoryType, AllocationSize, (VOID **)&ptr);
+      if (EFI_ERROR (Status)) {
+        UT_LOG_WARNING ("Memory allocation failed for type %a of size %x - %r\n", MEMORY_TYPES[MemoryProtectionContext.TargetMemoryType], AllocationSize, Status);
+        return UNIT_TEST_SKIPPED;
+      }
+
+      Faulted = RunExpectingFault (PoolFault, (UINTN)ptr, AllocationSize, &FaultAddress);
+
+      gBS->FreePool (ptr);
+
+      if (!Faulted) {
+        UT_LOG_ERROR ("Pool guard failed: %p", ptr);
+      }
+
+      UT_ASSERT_TRUE (Faulted);
+    }
+
+    return UNIT_TEST_PASSED;
+  }
+
   if (MemoryProtectionContext.TestProgress < NUM_POOL_SIZES) {
     //
     // Context.TestProgress indicates progress within this specific test.
@@ -1032,6 +1262,7 @@ UefiCpuStackGuard (
   )
 {
   MEMORY_PROTECTION_TEST_CONTEXT  MemoryProtectionContext = (*(MEMORY_PROTECTION_TEST_CONTEXT *)Context);
+  UINTN                           FaultAddress;
 
   DEBUG ((DEBUG_INFO, "%a - Testing CPU Stack Guard\n", __FUNCTION__));
 
@@ -1050,6 +1281,12 @@ UefiCpuStackGuard (
     return UNIT_TEST_PASSED;
   }
 
+  if (mRecoverableFaultActive) {
+    UT_ASSERT_TRUE (RunExpectingFault (StackOverflowFault, 0, 0, &FaultAddress));
+
+    return UNIT_TEST_PASSED;
+  }
+
   if (MemoryProtectionContext.TestProgress < 1) {
     //
     // Context.TestProgress 0 indicates the test hasn't started yet.
@@ -1075,7 +1312,6 @@ UefiCpuStackGuard (
   return UNIT_TEST_PASSED;
 } // UefiCpuStackGuard()
 
-volatile UNIT_TEST_FRAMEWORK  *mFw = NULL;
 UNIT_TEST_STATUS
 EFIAPI
 UefiNullPointerDetection (
@@ -1084,6 +1320,8 @@ UefiNullPointerDetection (
 {
   UINT8                           Index;
   MEMORY_PROTECTION_TEST_CONTEXT  MemoryProtectionContext = (*(MEMORY_PROTECTION_TEST_CONTEXT *)Context);
+  BOOLEAN                         Faulted;
+  UINTN                           FaultAddress;
 
   DEBUG ((DEBUG_INFO, "%a - Testing NULL Pointer Detection\n", __FUNCTION__));
 
@@ -1120,6 +1358,26 @@ UefiNullPointerDetection (
     return UNIT_TEST_PASSED;
   }
 
+  if (mRecoverableFaultActive) {
+    Faulted = RunExpectingFault (NullReadFault, 0, 0, &FaultAddress);
+    if (!Faulted) {
+      UT_LOG_ERROR ("Failed NULL pointer read test.");
+    }
+
+    UT_ASSERT_TRUE (Faulted);
+    UT_ASSERT_TRUE (FaultAddress < EFI_PAGE_SIZE);
+
+    Faulted = RunExpectingFault (NullWriteFault, 0, 0, &FaultAddress);
+    if (!Faulted) {
+      UT_LOG_ERROR ("Failed NULL pointer write test.");
+    }
+
+    UT_ASSERT_TRUE (Faulted);
+    UT_ASSERT_TRUE (FaultAddress < EFI_PAGE_SIZE);
+
+    return UNIT_TEST_PASSED;
+  }
+
   if (MemoryProtectionContext.TestProgress < 2) {
     //
     // Context.TestProgress indicates progress within this specific test.
@@ -1165,6 +1423,8 @@ UefiNxStackGuard (
   MEMORY_PROTECTION_TEST_CONTEXT  MemoryProtectionContext = (*(MEMORY_PROTECTION_TEST_CONTEXT *)Context);
   UINT8                           CodeRegionToCopyTo[DUMMY_FUNCTION_FOR_CODE_SELF_TEST_GENERIC_SIZE];
   UINT8                           *CodeRegionToCopyFrom = (UINT8 *)DummyFunctionForCodeSelfTest;
+  BOOLEAN                         Faulted;
+  UINTN                           FaultAddress;
 
   DEBUG ((DEBUG_INFO, "%a - NX Stack Guard\n", __FUNCTION__));
 
@@ -1184,6 +1444,20 @@ UefiNxStackGuard (
     return UNIT_TEST_PASSED;
   }
 
+  if (mRecoverableFaultActive) {
+    CopyMem (CodeRegionToCopyTo, CodeRegionToCopyFrom, DUMMY_FUNCTION_FOR_CODE_SELF_TEST_GENERIC_SIZE);
+
+    Faulted = RunExpectingFault (ExecuteFault, (UINTN)CodeRegionToCopyTo, 0, &FaultAddress);
+    if (!Faulted) {
+      UT_LOG_ERROR ("NX Stack Guard Test failed.");
+    }
+
+    UT_ASSERT_TRUE (Faulted);
+    UT_ASSERT_EQUAL (FaultAddress, (UINTN)CodeRegionToCopyTo);
+
+    return UNIT_TEST_PASSED;
+  }
+
   if (MemoryProtectionContext.TestProgress < 1) {
     //
     // Context.TestProgress 0 indicates the test hasn't started yet.
@@ -1220,6 +1494,8 @@ UefiNxProtection (
   UINT64                          *ptr;
   EFI_STATUS                      Status;
   UINT8                           *CodeRegionToCopyFrom = (UINT8 *)DummyFunctionForCodeSelfTest;
+  BOOLEAN                         Faulted;
+  UINTN                           FaultAddress;
 
   DEBUG ((DEBUG_INFO, "%a - Testing Type: %a\n", __FUNCTION__, MEMORY_TYPES[MemoryProtectionContext.TargetMemoryType]));
 
@@ -1249,6 +1525,29 @@ UefiNxProtection (
     return UNIT_TEST_PASSED;
   }
 
+  if (mRecoverableFaultActive) {
+    Status = gBS->AllocatePool ((EFI_MEMORY_TYPE)MemoryProtectionContext.TargetMemoryType, EFI_PAGE_SIZE, (VOID **)&ptr);
+    if (EFI_ERROR (Status)) {
+      UT_LOG_WARNING ("Memory allocation failed for type %a - %r\n", MEMORY_TYPES[MemoryProtectionContext.TargetMemoryType], Status);
+      return UNIT_TEST_SKIPPED;
+    }
+
+    CopyMem (ptr, CodeRegionToCopyFrom, DUMMY_FUNCTION_FOR_CODE_SELF_TEST_GENERIC_SIZE);
+
+    Faulted = RunExpectingFault (ExecuteFault, (UINTN)ptr, 0, &FaultAddress);
+
+    FreePool (ptr);
+
+    if (!Faulted) {
+      UT_LOG_ERROR ("NX Test failed.");
+    }
+
+    UT_ASSERT_TRUE (Faulted);
+    UT_ASSERT_EQUAL (FaultAddress, (UINTN)ptr);
+
+    return UNIT_TEST_PASSED;
+  }
+
   if (MemoryProtectionContext.TestProgress < 1) {
     //
     // Context.TestProgress 0 indicates the test hasn't started yet.
@@ -1854,6 +2153,8 @@ MemoryProtectionTestAppEntryPoint (
   UNIT_TEST_SUITE_HANDLE          NxProtection = NULL;
   UNIT_TEST_SUITE_HANDLE          Misc         = NULL;
   MEMORY_PROTECTION_TEST_CONTEXT  *MemoryProtectionContext;
+  BOOLEAN                         MuHandlerInstalled;
+  BOOLEAN                         MuHandlerRemoved;
 
   MemoryProtectionContext                = (MEMORY_PROTECTION_TEST_CONTEXT *)AllocateZeroPool (sizeof (MEMORY_PROTECTION_TEST_CONTEXT));
   MemoryProtectionContext->DynamicActive = FALSE;
@@ -1903,7 +2204,8 @@ MemoryProtectionTestAppEntryPoint (
 
   // Check if the Project Mu page fault handler is installed. This handler will warm-reset on page faults
   // unless the Nonstop Protocol is installed to clear intentional page faults.
-  if (!EFI_ERROR (CheckMemoryProtectionExceptionHandlerInstallation ())) {
+  MuHandlerInstalled = !EFI_ERROR (CheckMemoryProtectionExceptionHandlerInstallation ());
+  if (MuHandlerInstalled) {
     // Clear the memory protection early store in case a fault was previously tripped and was not cleared
     ExPersistClearAll ();
 
@@ -1917,12 +2219,40 @@ MemoryProtectionTestAppEntryPoint (
         "the protocol with this test can reduce execution time by over 98%%.\n"
         ));
     }
-  } else {
+  }
+
+  // Without the Nonstop Protocol, try to replace the page fault handler with one that resumes
+  // the test after each expected fault so the UEFI tests run without resetting. The SMM tests
+  // fault inside SMM and always require a reset.
+  MuHandlerRemoved = FALSE;
+  if (!MemoryProtectionContext->DynamicActive) {
+ #if defined (MDE_CPU_X64)
+    mCpu->RegisterInterruptHandler (mCpu, EXCEPT_IA32_PAGE_FAULT, NULL);
+    MuHandlerRemoved = MuHandlerInstalled;
+
+    Status = mCpu->RegisterInterruptHandler (mCpu, EXCEPT_IA32_PAGE_FAULT, RecoverableFaultHandler);
+    if (!EFI_ERROR (Status)) {
+      mRecoverableFaultActive = TRUE;
+    } else {
+      DEBUG ((DEBUG_WARN, "Failed to install recoverable fault handler. Status = %r\n", Status));
+    }
+
+ #else
+    DEBUG ((DEBUG_WARN, "Recoverable fault mode is not supported on this architecture. Each fault resets the system.\n"));
+ #endif
+  }
+
+  // Otherwise fall back to resetting the system on each fault. The Project Mu handler does this
+  // already unless it was uninstalled above.
+  if (!MemoryProtectionContext->DynamicActive && !mRecoverableFaultActive &&
+      (!MuHandlerInstalled || MuHandlerRemoved))
+  {
     // Uninstall the existing page fault handler
     mCpu->RegisterInterruptHandler (mCpu, EXCEPT_IA32_PAGE_FAULT, NULL);
 
     // Install an interrupt handler to reboot on page faults.
-    if (EFI_ERROR (mCpu->RegisterInterruptHandler (mCpu, EXCEPT_IA32_PAGE_FAULT, InterruptHandler))) {
+    Status = mCpu->RegisterInterruptHandler (mCpu, EXCEPT_IA32_PAGE_FAULT, InterruptHandler);
+    if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Failed to install interrupt handler. Status = %r\n", Status));
       goto EXIT;
     }
@@ -1948,6 +2278,11 @@ MemoryProtectionTestAppEntryPoint (
 
 EXIT:
 
+  // The handler must not outlive this image
+  if (mRecoverableFaultActive) {
+    mCpu->RegisterInterruptHandler (mCpu, EXCEPT_IA32_PAGE_FAULT, NULL);
+  }
+
   if (Fw) {
     FreeUnitTestFramework (Fw);
   }
@@ -0,0 +1,40 @@
+/** @file -- RecoverableFaultStub.h
+Definition of the fault recovery methods. Only X64 implements them. On other
+architectures the app runs the UEFI tests in reset mode.
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _MEMORY_PROTECTION_RECOVERABLE_FAULT_H_
+#define _MEMORY_PROTECTION_RECOVERABLE_FAULT_H_
+
+/**
+  Returns the address which caused the fault described by SystemContext.
+
+  @param[in]  SystemContext   The processor context when the fault occurred.
+
+  @return The faulting address, or 0 if it is not available.
+**/
+UINTN
+GetFaultAddress (
+  IN EFI_SYSTEM_CONTEXT  SystemContext
+  );
+
+/**
+  Updates SystemContext so that returning from the exception calls ResumeFunction
+  on the stack of the function which called SetJump() with JumpBuffer.
+
+  @param[in, out] SystemContext   The processor context when the fault occurred.
+  @param[in]      JumpBuffer      Jump buffer saved before the fault was triggered.
+  @param[in]      ResumeFunction  Function to run after the exception returns. It must not return.
+**/
+VOID
+RedirectFaultContext (
+  IN OUT EFI_SYSTEM_CONTEXT        SystemContext,
+  IN     BASE_LIBRARY_JUMP_BUFFER  *JumpBuffer,
+  IN     VOID                      *ResumeFunction
+  );
+
+#endif // _MEMORY_PROTECTION_RECOVERABLE_FAULT_H_
@@ -0,0 +1,44 @@
+/** @file
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+
+#include <Protocol/Cpu.h>
+
+#include <Library/BaseLib.h>
+
+#include "../RecoverableFaultStub.h"
+
+//
+// Stack left untouched between the frame of the SetJump() caller and the frame of the resume
+// function. This covers the register parameter home area the callee may write above its
+// return address.
+//
+#define RESUME_STACK_GAP  0x100
+
+UINTN
+GetFaultAddress (
+  IN EFI_SYSTEM_CONTEXT  SystemContext
+  )
+{
+  return (UINTN)SystemContext.SystemContextX64->Cr2;
+}
+
+VOID
+RedirectFaultContext (
+  IN OUT EFI_SYSTEM_CONTEXT        SystemContext,
+  IN     BASE_LIBRARY_JUMP_BUFFER  *JumpBuffer,
+  IN     VOID                      *ResumeFunction
+  )
+{
+  //
+  // The faulting stack may be the one that overflowed, so run the resume function below the
+  // SetJump() caller instead. Leave RSP as it would be right after a call instruction.
+  //
+  SystemContext.SystemContextX64->Rsp = ((JumpBuffer->Rsp - RESUME_STACK_GAP) & ~(UINT64)0xF) - sizeof (UINT64);
+  SystemContext.SystemContextX64->Rip = (UINT64)(UINTN)ResumeFunction;
+}
@@ -0,0 +1,217 @@
+/** @file -- TcgEventLogReplayLib.h
+  Parses a TCG crypto agile event log, replays the extends of every event into
+  reconstructed PCR values, and compares them with the PCR values or quote of a TPM.
+
+  Events are indexed by PCR and event type, so the events that produced a PCR value
+  can be found without walking the log again.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef TCG_EVENT_LOG_REPLAY_LIB_H_
+#define TCG_EVENT_LOG_REPLAY_LIB_H_
+
+#include <IndustryStandard/Tpm20.h>
+#include <IndustryStandard/UefiTcgPlatform.h>
+
+//
+// EventType of TcgEventLogReplayFindEvents () that matches every event type.
+//
+#define TCG_EVENT_LOG_REPLAY_ANY_EVENT_TYPE  MAX_UINT32
+
+///
+/// A PCR bank of the log, in the order of the Spec ID event.
+///
+typedef struct {
+  TPMI_ALG_HASH    HashAlg;
+  UINT16           DigestSize;
+  ///
+  /// FALSE if the digest algorithm is not supported by this library. The digests of
+  /// the bank are parsed, but Pcr holds no values.
+  ///
+  BOOLEAN          Replayed;
+  UINT8            Pcr[IMPLEMENTATION_PCR][sizeof (TPMU_HA)];
+} TCG_EVENT_LOG_REPLAY_BANK;
+
+///
+/// An event of the log. The pointers point into the event log buffer.
+///
+typedef struct {
+  UINT32         PcrIndex;
+  UINT32         EventType;
+  UINT32         EventSize;
+  CONST UINT8    *EventData;
+  ///
+  /// Digest of the event for each bank, in the order of TCG_EVENT_LOG_REPLAY.Bank.
+  ///
+  CONST UINT8    *Digest[HASH_COUNT];
+} TCG_EVENT_LOG_REPLAY_EVENT;
+
+///
+/// Entry of the event index. The index is sorted by PCR, then event type, then
+/// position in the log.
+///
+typedef struct {
+  UINT32    PcrIndex;
+  UINT32    EventType;
+  UINT32    EventNumber;                  // Index in TCG_EVENT_LOG_REPLAY.Event
+} TCG_EVENT_LOG_REPLAY_INDEX_ENTRY;
+
+typedef struct {
+  UINT32                              BankCount;
+  TCG_EVENT_LOG_REPLAY_BANK           Bank[HASH_COUNT];
+  UINT8                               StartupLocality;
+  UINT32                              EventCount;
+  TCG_EVENT_LOG_REPLAY_EVENT          *Event;
+  TCG_EVENT_LOG_REPLAY_INDEX_ENTRY    *Index;
+  UINT32                              EventCapacity;
+} TCG_EVENT_LOG_REPLAY;
+
+/**
+  Parse a crypto agile event log and replay its events.
+
+  The log starts with the TCG_PCR_EVENT_HDR of the Spec ID event, as returned by
+  EFI_TCG2_PROTOCOL.GetEventLog () for EFI_TCG2_EVENT_LOG_FORMAT_TCG_2. The digest
+  sizes of the Spec ID event are used to parse the events. The events are not copied,
+  so the log must stay valid until the replay is freed.
+
+  @param[in]  EventLog           The event log.
+  @param[in]  EventLogSize       Size of the event log in bytes, up to the end of the
+                                 last event.
+  @param[out] Replay             Receives the replay. Free it with TcgEventLogReplayFree ().
+
+  @retval EFI_SUCCESS            The log was replayed.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL.
+  @retval EFI_UNSUPPORTED        The log is not a crypto agile log, or has more than
+                                 HASH_COUNT banks.
+  @retval EFI_COMPROMISED_DATA   The log is malformed.
+  @retval EFI_OUT_OF_RESOURCES   Memory allocation failed.
+**/
+EFI_STATUS
+EFIAPI
+TcgEventLogReplayCreate (
+  IN  CONST VOID            *EventLog,
+  IN  UINTN                 EventLogSize,
+  OUT TCG_EVENT_LOG_REPLAY  **Replay
+  );
+
+/**
+  Replay more events of the same log, such as the events of the final events table.
+
+  @param[in, out] Replay         The replay to add the events to.
+  @param[in]      Events         TCG_PCR_EVENT2 events, without a Spec ID event.
+  @param[in]      EventsSize     Size of the buffer holding the events in bytes.
+  @param[in]      NumberOfEvents Number of events to replay.
+
+  @retval EFI_SUCCESS            The events were replayed.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL.
+  @retval EFI_COMPROMISED_DATA   An event is malformed. The events before it were replayed.
+  @retval EFI_OUT_OF_RESOURCES   Memory allocation failed.
+**/
+EFI_STATUS
+EFIAPI
+TcgEventLogReplayAppend (
+  IN OUT TCG_EVENT_LOG_REPLAY  *Replay,
+  IN     CONST VOID            *Events,
+  IN     UINTN                 EventsSize,
+  IN     UINTN                 NumberOfEvents
+  );
+
+/**
+  Free a replay.
+
+  @param[in]  Replay             The replay to free. May be NULL.
+**/
+VOID
+EFIAPI
+TcgEventLogReplayFree (
+  IN TCG_EVENT_LOG_REPLAY  *Replay
+  );
+
+/**
+  Get the replayed bank of a digest algorithm.
+
+  @param[in]  Replay             The replay.
+  @param[in]  HashAlg            The digest algorithm.
+
+  @return The bank, or NULL if the log has no such bank or it was not replayed.
+**/
+CONST TCG_EVENT_LOG_REPLAY_BANK *
+EFIAPI
+TcgEventLogReplayGetBank (
+  IN CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN TPMI_ALG_HASH               HashAlg
+  );
+
+/**
+  Find the events of a PCR and event type.
+
+  @param[in]  Replay             The replay.
+  @param[in]  PcrIndex           The PCR.
+  @param[in]  EventType          The event type, or TCG_EVENT_LOG_REPLAY_ANY_EVENT_TYPE.
+  @param[out] Entries            Receives the first matching index entry. The matching
+                                 entries are consecutive and in log order.
+
+  @return The number of matching events.
+**/
+UINTN
+EFIAPI
+TcgEventLogReplayFindEvents (
+  IN  CONST TCG_EVENT_LOG_REPLAY              *Replay,
+  IN  UINT32                                  PcrIndex,
+  IN  UINT32                                  EventType,
+  OUT CONST TCG_EVENT_LOG_REPLAY_INDEX_ENTRY  **Entries
+  );
+
+/**
+  Compare the replayed PCR values with PCR values read from the TPM.
+
+  The selection and values are in the form returned by Tpm2PcrRead (): the values
+  follow the order of the selection, and the PCRs of each selection in ascending order.
+
+  @param[in]  Replay             The replay.
+  @param[in]  PcrSelection       The PCRs of PcrValues.
+  @param[in]  PcrValues          The PCR values.
+  @param[out] MismatchedPcrs     Optional. Receives a bit mask of the PCRs that do not
+                                 match in any bank.
+
+  @retval EFI_SUCCESS            All the PCR values match.
+  @retval EFI_SECURITY_VIOLATION At least one PCR value does not match.
+  @retval EFI_UNSUPPORTED        A selected bank was not replayed.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL, or the values do not match the selection.
+**/
+EFI_STATUS
+EFIAPI
+TcgEventLogReplayComparePcrs (
+  IN  CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN  CONST TPML_PCR_SELECTION    *PcrSelection,
+  IN  CONST TPML_DIGEST           *PcrValues,
+  OUT UINT32                      *MismatchedPcrs OPTIONAL
+  );
+
+/**
+  Compare the replayed PCR values with the PCR digest of a TPM quote.
+
+  @param[in]  Replay             The replay.
+  @param[in]  QuoteInfo          The unmarshaled quote information of the TPMS_ATTEST
+                                 returned by TPM2_Quote.
+  @param[in]  QuoteHashAlg       The digest algorithm of the quote signing scheme.
+
+  @retval EFI_SUCCESS            The PCR digest matches the replayed PCR values.
+  @retval EFI_SECURITY_VIOLATION The PCR digest does not match.
+  @retval EFI_UNSUPPORTED        A selected bank was not replayed, or QuoteHashAlg is
+                                 not supported.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL, or the selection is not valid.
+  @retval EFI_OUT_OF_RESOURCES   Memory allocation failed.
+**/
+EFI_STATUS
+EFIAPI
+TcgEventLogReplayCompareQuote (
+  IN CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN CONST TPMS_QUOTE_INFO       *QuoteInfo,
+  IN TPMI_ALG_HASH               QuoteHashAlg
+  );
+
+#endif // TCG_EVENT_LOG_REPLAY_LIB_H_
@@ -0,0 +1,955 @@
+/** @file -- TcgEventLogReplayLib.c
+  Parses a TCG crypto agile event log and replays it into reconstructed PCR values.
+
+  The log is walked once. The digest sizes of the Spec ID event are used to step over
+  the digests of every event, so events of banks this library cannot hash are still
+  parsed. Every length is checked against the end of the buffer before it is used.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseCryptLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TcgEventLogReplayLib.h>
+
+//
+// Number of events the event array grows by.
+//
+#define EVENT_ARRAY_GROWTH  64
+
+//
+// The DRTM PCRs 17 to 22 are reset to all ones, the other PCRs to zero.
+//
+#define FIRST_DRTM_PCR  17
+#define LAST_DRTM_PCR   22
+
+typedef
+BOOLEAN
+(EFIAPI *HASH_ALL)(
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  OUT UINT8       *HashValue
+  );
+
+typedef struct {
+  TPMI_ALG_HASH    HashAlg;
+  UINT16           DigestSize;
+  HASH_ALL         HashAll;
+} HASH_ALGORITHM;
+
+STATIC CONST HASH_ALGORITHM  mHashAlgorithms[] = {
+  { TPM_ALG_SHA1,    SHA1_DIGEST_SIZE,    Sha1HashAll   },
+  { TPM_ALG_SHA256,  SHA256_DIGEST_SIZE,  Sha256HashAll },
+  { TPM_ALG_SHA384,  SHA384_DIGEST_SIZE,  Sha384HashAll },
+  { TPM_ALG_SHA512,  SHA512_DIGEST_SIZE,  Sha512HashAll },
+  { TPM_ALG_SM3_256, SM3_256_DIGEST_SIZE, Sm3HashAll    }
+};
+
+typedef struct {
+  CONST TCG_EVENT_LOG_REPLAY_BANK    *Bank;
+  UINT32                             PcrIndex;
+} SELECTED_PCR;
+
+/**
+  Get the hash algorithm of a TPM algorithm ID.
+
+  @param[in]  HashAlg     The TPM algorithm ID.
+
+  @return The hash algorithm, or NULL if it is not supported.
+**/
+STATIC
+CONST HASH_ALGORITHM *
+GetHashAlgorithm (
+  IN TPMI_ALG_HASH  HashAlg
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mHashAlgorithms); Index++) {
+    if (mHashAlgorithms[Index].HashAlg == HashAlg) {
+      return &mHashAlgorithms[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Find the position of a bank in the replay.
+
+  @param[in]  Replay      The replay.
+  @param[in]  HashAlg     The digest algorithm of the bank.
+
+  @return The position of the bank, or Replay->BankCount if there is no such bank.
+**/
+STATIC
+UINT32
+FindBank (
+  IN CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN TPMI_ALG_HASH               HashAlg
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < Replay->BankCount; Index++) {
+    if (Replay->Bank[Index].HashAlg == HashAlg) {
+      break;
+    }
+  }
+
+  return Index;
+}
+
+/**
+  Parse the Spec ID event that starts the log and set up the banks.
+
+  @param[in, out] Replay        The replay to set up.
+  @param[in]      EventLog      The event log.
+  @param[in]      EventLogSize  Size of the event log in bytes.
+  @param[out]     HeaderSize    Receives the size of the Spec ID event.
+
+  @retval EFI_SUCCESS           The banks were set up.
+  @retval EFI_UNSUPPORTED       The log is not a crypto agile log, or has too many banks.
+  @retval EFI_COMPROMISED_DATA  The Spec ID event is malformed.
+**/
+STATIC
+EFI_STATUS
+ParseSpecIdEvent (
+  IN OUT TCG_EVENT_LOG_REPLAY  *Replay,
+  IN     CONST UINT8           *EventLog,
+  IN     UINTN                 EventLogSize,
+  OUT    UINTN                 *HeaderSize
+  )
+{
+  CONST TCG_PCR_EVENT_HDR          *EventHdr;
+  CONST UINT8                      *SpecId;
+  UINT32                           EventSize;
+  UINT32                           NumberOfAlgorithms;
+  UINTN                            AlgorithmsEnd;
+  TCG_EfiSpecIdEventAlgorithmSize  Algorithm;
+  CONST HASH_ALGORITHM             *HashAlgorithm;
+  TCG_EVENT_LOG_REPLAY_BANK        *Bank;
+  UINT32                           Index;
+  UINT32                           Pcr;
+
+  if (EventLogSize < sizeof (TCG_PCR_EVENT_HDR)) {
+    DEBUG ((DEBUG_ERROR, "%a: The log is too small for the Spec ID event. Size=0x%x\n", __FUNCTION__, EventLogSize));
+    return EFI_COMPROMISED_DATA;
+  }
+
+  EventHdr  = (CONST TCG_PCR_EVENT_HDR *)EventLog;
+  EventSize = ReadUnaligned32 (&EventHdr->EventSize);
+  if (EventSize > (EventLogSize - sizeof (TCG_PCR_EVENT_HDR))) {
+    DEBUG ((DEBUG_ERROR, "%a: The Spec ID event overruns the log. EventSize=0x%x\n", __FUNCTION__, EventSize));
+    return EFI_COMPROMISED_DATA;
+  }
+
+  SpecId = (CONST UINT8 *)(EventHdr + 1);
+  if ((ReadUnaligned32 (&EventHdr->EventType) != EV_NO_ACTION) ||
+      (EventSize < sizeof (TCG_EfiSpecIDEventStruct) + sizeof (NumberOfAlgorithms)) ||
+      (CompareMem (
+         ((CONST TCG_EfiSpecIDEventStruct *)SpecId)->signature,
+         TCG_EfiSpecIDEventStruct_SIGNATURE_03,
+         sizeof (TCG_EfiSpecIDEventStruct_SIGNATURE_03)
+         ) != 0))
+  {
+    DEBUG ((DEBUG_ERROR, "%a: The log does not start with a Spec ID Event03.\n", __FUNCTION__));
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Same layout as GetTcgEfiSpecIdEventStructSize (), but bounded by the event size.
+  //
+  NumberOfAlgorithms = ReadUnaligned32 ((CONST UINT32 *)(SpecId + sizeof (TCG_EfiSpecIDEventStruct)));
+  if ((NumberOfAlgorithms == 0) || (NumberOfAlgorithms > HASH_COUNT)) {
+    DEBUG ((DEBUG_ERROR, "%a: Unsupported number of banks %d.\n", __FUNCTION__, NumberOfAlgorithms));
+    return EFI_UNSUPPORTED;
+  }
+
+  AlgorithmsEnd = sizeof (TCG_EfiSpecIDEventStruct) + sizeof (NumberOfAlgorithms) +
+                  NumberOfAlgorithms * sizeof (TCG_EfiSpecIdEventAlgorithmSize);
+  if ((AlgorithmsEnd + sizeof (UINT8) > EventSize) ||
+      (AlgorithmsEnd + sizeof (UINT8) + SpecId[AlgorithmsEnd] > EventSize))
+  {
+    DEBUG ((DEBUG_ERROR, "%a: The Spec ID event is truncated. EventSize=0x%x\n", __FUNCTION__, EventSize));
+    return EFI_COMPROMISED_DATA;
+  }
+
+  for (Index = 0; Index < NumberOfAlgorithms; Index++) {
+    CopyMem (
+      &Algorithm,
+      SpecId + sizeof (TCG_EfiSpecIDEventStruct) + sizeof (NumberOfAlgorithms) + Index * sizeof (Algorithm),
+      sizeof (Algorithm)
+      );
+
+    if ((Algorithm.digestSize == 0) || (Algorithm.digestSize > sizeof (TPMU_HA)) ||
+        (FindBank (Replay, Algorithm.algorithmId) != Replay->BankCount))
+    {
+      DEBUG ((DEBUG_ERROR, "%a: Bad bank 0x%x of digest size %d.\n", __FUNCTION__, Algorithm.algorithmId, Algorithm.digestSize));
+      return EFI_COMPROMISED_DATA;
+    }
+
+    HashAlgorithm = GetHashAlgorithm (Algorithm.algorithmId);
+    if ((HashAlgorithm != NULL) && (HashAlgorithm->DigestSize != Algorithm.digestSize)) {
+      DEBUG ((DEBUG_ERROR, "%a: Bank 0x%x has digest size %d, expected %d.\n", __FUNCTION__, Algorithm.algorithmId, Algorithm.digestSize, HashAlgorithm->DigestSize));
+      return EFI_COMPROMISED_DATA;
+    }
+
+    if (HashAlgorithm == NULL) {
+      DEBUG ((DEBUG_WARN, "%a: Bank 0x%x is not supported and will not be replayed.\n", __FUNCTION__, Algorithm.algorithmId));
+    }
+
+    Bank             = &Replay->Bank[Replay->BankCount++];
+    Bank->HashAlg    = Algorithm.algorithmId;
+    Bank->DigestSize = Algorithm.digestSize;
+    Bank->Replayed   = (BOOLEAN)(HashAlgorithm != NULL);
+    for (Pcr = 0; Pcr < IMPLEMENTATION_PCR; Pcr++) {
+      SetMem (
+        Bank->Pcr[Pcr],
+        Bank->DigestSize,
+        ((Pcr >= FIRST_DRTM_PCR) && (Pcr <= LAST_DRTM_PCR)) ? 0xFF : 0x00
+        );
+    }
+  }
+
+  *HeaderSize = sizeof (TCG_PCR_EVENT_HDR) + EventSize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Apply a StartupLocality event. The locality is the reset value of PCR0, so it only
+  applies while PCR0 has not been extended.
+
+  @param[in, out] Replay      The replay.
+  @param[in]      Event       The EV_NO_ACTION event of PCR0.
+**/
+STATIC
+VOID
+ApplyStartupLocality (
+  IN OUT TCG_EVENT_LOG_REPLAY        *Replay,
+  IN     TCG_EVENT_LOG_REPLAY_EVENT  *Event
+  )
+{
+  TCG_EVENT_LOG_REPLAY_BANK  *Bank;
+  UINT32                     Index;
+
+  if ((Event->EventSize < sizeof (TCG_EfiStartupLocalityEvent)) ||
+      (CompareMem (Event->EventData, TCG_EfiStartupLocalityEvent_SIGNATURE, sizeof (TCG_EfiStartupLocalityEvent_SIGNATURE)) != 0))
+  {
+    return;
+  }
+
+  for (Index = 0; Index < Replay->BankCount; Index++) {
+    Bank = &Replay->Bank[Index];
+    if (Bank->Replayed && !IsZeroBuffer (Bank->Pcr[0], Bank->DigestSize)) {
+      DEBUG ((DEBUG_WARN, "%a: StartupLocality event after PCR0 was extended is ignored.\n", __FUNCTION__));
+      return;
+    }
+  }
+
+  Replay->StartupLocality = Event->EventData[OFFSET_OF (TCG_EfiStartupLocalityEvent, StartupLocality)];
+  for (Index = 0; Index < Replay->BankCount; Index++) {
+    Bank                               = &Replay->Bank[Index];
+    Bank->Pcr[0][Bank->DigestSize - 1] = Replay->StartupLocality;
+  }
+}
+
+/**
+  Parse one TCG_PCR_EVENT2, add it to the events and extend its digests.
+
+  @param[in, out] Replay        The replay.
+  @param[in]      Buffer        The event.
+  @param[in]      BufferSize    Bytes left in the log from the start of the event.
+  @param[out]     EventLength   Receives the size of the event.
+
+  @retval EFI_SUCCESS           The event was replayed.
+  @retval EFI_COMPROMISED_DATA  The event is malformed.
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+**/
+STATIC
+EFI_STATUS
+ReplayEvent (
+  IN OUT TCG_EVENT_LOG_REPLAY  *Replay,
+  IN     CONST UINT8           *Buffer,
+  IN     UINTN                 BufferSize,
+  OUT    UINTN                 *EventLength
+  )
+{
+  TCG_EVENT_LOG_REPLAY_EVENT  *Event;
+  TCG_EVENT_LOG_REPLAY_EVENT  *NewEvents;
+  TCG_EVENT_LOG_REPLAY_BANK   *Bank;
+  CONST HASH_ALGORITHM        *HashAlgorithm;
+  UINT8                       ExtendBuffer[2 * sizeof (TPMU_HA)];
+  UINTN                       Offset;
+  UINT32                      DigestCount;
+  UINT32                      Index;
+  UINT32                      BankIndex;
+  TPMI_ALG_HASH               HashAlg;
+
+  if (Replay->EventCount == Replay->EventCapacity) {
+    if (Replay->EventCapacity > MAX_UINT32 - EVENT_ARRAY_GROWTH) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    NewEvents = ReallocatePool (
+                  Replay->EventCapacity * sizeof (TCG_EVENT_LOG_REPLAY_EVENT),
+                  (Replay->EventCapacity + EVENT_ARRAY_GROWTH) * sizeof (TCG_EVENT_LOG_REPLAY_EVENT),
+                  Replay->Event
+                  );
+    if (NewEvents == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Replay->Event          = NewEvents;
+    Replay->EventCapacity += EVENT_ARRAY_GROWTH;
+  }
+
+  Event = &Replay->Event[Replay->EventCount];
+  ZeroMem (Event, sizeof (*Event));
+
+  //
+  // PCRIndex, EventType and the digest count.
+  //
+  if (BufferSize < 3 * sizeof (UINT32)) {
+    goto Truncated;
+  }
+
+  Event->PcrIndex  = ReadUnaligned32 ((CONST UINT32 *)Buffer);
+  Event->EventType = ReadUnaligned32 ((CONST UINT32 *)(Buffer + sizeof (UINT32)));
+  DigestCount      = ReadUnaligned32 ((CONST UINT32 *)(Buffer + 2 * sizeof (UINT32)));
+  Offset           = 3 * sizeof (UINT32);
+
+  if (Event->PcrIndex >= IMPLEMENTATION_PCR) {
+    DEBUG ((DEBUG_ERROR, "%a: Event %d is for PCR %d.\n", __FUNCTION__, Replay->EventCount, Event->PcrIndex));
+    return EFI_COMPROMISED_DATA;
+  }
+
+  //
+  // Every bank of the Spec ID event has exactly one digest.
+  //
+  if (DigestCount != Replay->BankCount) {
+    DEBUG ((DEBUG_ERROR, "%a: Event %d has %d digests for %d banks.\n", __FUNCTION__, Replay->EventCount, DigestCount, Replay->BankCount));
+    return EFI_COMPROMISED_DATA;
+  }
+
+  for (Index = 0; Index < DigestCount; Index++) {
+    if (BufferSize - Offset < sizeof (TPMI_ALG_HASH)) {
+      goto Truncated;
+    }
+
+    HashAlg   = ReadUnaligned16 ((CONST UINT16 *)(Buffer + Offset));
+    Offset   += sizeof (TPMI_ALG_HASH);
+    BankIndex = FindBank (Replay, HashAlg);
+    if ((BankIndex == Replay->BankCount) || (Event->Digest[BankIndex] != NULL)) {
+      DEBUG ((DEBUG_ERROR, "%a: Event %d has an unexpected digest 0x%x.\n", __FUNCTION__, Replay->EventCount, HashAlg));
+      return EFI_COMPROMISED_DATA;
+    }
+
+    if (BufferSize - Offset < Replay->Bank[BankIndex].DigestSize) {
+      goto Truncated;
+    }
+
+    Event->Digest[BankIndex] = Buffer + Offset;
+    Offset                  += Replay->Bank[BankIndex].DigestSize;
+  }
+
+  if (BufferSize - Offset < sizeof (UINT32)) {
+    goto Truncated;
+  }
+
+  Event->EventSize = ReadUnaligned32 ((CONST UINT32 *)(Buffer + Offset));
+  Offset          += sizeof (UINT32);
+  if (BufferSize - Offset < Event->EventSize) {
+    goto Truncated;
+  }
+
+  Event->EventData = Buffer + Offset;
+  Offset          += Event->EventSize;
+
+  //
+  // EV_NO_ACTION events are informational and are not extended.
+  //
+  if (Event->EventType == EV_NO_ACTION) {
+    if (Event->PcrIndex == 0) {
+      ApplyStartupLocality (Replay, Event);
+    }
+  } else {
+    for (BankIndex = 0; BankIndex < Replay->BankCount; BankIndex++) {
+      Bank = &Replay->Bank[BankIndex];
+      if (!Bank->Replayed) {
+        continue;
+      }
+
+      HashAlgorithm = GetHashAlgorithm (Bank->HashAlg);
+      CopyMem (ExtendBuffer, Bank->Pcr[Event->PcrIndex], Bank->DigestSize);
+      CopyMem (ExtendBuffer + Bank->DigestSize, Event->Digest[BankIndex], Bank->DigestSize);
+      if (!HashAlgorithm->HashAll (ExtendBuffer, 2 * Bank->DigestSize, Bank->Pcr[Event->PcrIndex])) {
+        DEBUG ((DEBUG_ERROR, "%a: Failed to extend bank 0x%x.\n", __FUNCTION__, Bank->HashAlg));
+        return EFI_DEVICE_ERROR;
+      }
+    }
+  }
+
+  Replay->EventCount++;
+  *EventLength = Offset;
+  return EFI_SUCCESS;
+
+Truncated:
+  DEBUG ((DEBUG_ERROR, "%a: Event %d is truncated.\n", __FUNCTION__, Replay->EventCount));
+  return EFI_COMPROMISED_DATA;
+}
+
+/**
+  BASE_SORT_COMPARE for index entries: by PCR, then event type, then log order.
+**/
+STATIC
+INTN
+EFIAPI
+CompareIndexEntries (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  CONST TCG_EVENT_LOG_REPLAY_INDEX_ENTRY  *Entry1;
+  CONST TCG_EVENT_LOG_REPLAY_INDEX_ENTRY  *Entry2;
+
+  Entry1 = (CONST TCG_EVENT_LOG_REPLAY_INDEX_ENTRY *)Buffer1;
+  Entry2 = (CONST TCG_EVENT_LOG_REPLAY_INDEX_ENTRY *)Buffer2;
+
+  if (Entry1->PcrIndex != Entry2->PcrIndex) {
+    return (Entry1->PcrIndex < Entry2->PcrIndex) ? -1 : 1;
+  }
+
+  if (Entry1->EventType != Entry2->EventType) {
+    return (Entry1->EventType < Entry2->EventType) ? -1 : 1;
+  }
+
+  if (Entry1->EventNumber != Entry2->EventNumber) {
+    return (Entry1->EventNumber < Entry2->EventNumber) ? -1 : 1;
+  }
+
+  return 0;
+}
+
+/**
+  Rebuild the event index of a replay.
+
+  @param[in, out] Replay        The replay.
+
+  @retval EFI_SUCCESS           The index was built.
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+**/
+STATIC
+EFI_STATUS
+BuildIndex (
+  IN OUT TCG_EVENT_LOG_REPLAY  *Replay
+  )
+{
+  TCG_EVENT_LOG_REPLAY_INDEX_ENTRY  Scratch;
+  UINT32                            Index;
+
+  if (Replay->Index != NULL) {
+    FreePool (Replay->Index);
+    Replay->Index = NULL;
+  }
+
+  if (Replay->EventCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Replay->Index = AllocatePool (Replay->EventCount * sizeof (TCG_EVENT_LOG_REPLAY_INDEX_ENTRY));
+  if (Replay->Index == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < Replay->EventCount; Index++) {
+    Replay->Index[Index].PcrIndex    = Replay->Event[Index].PcrIndex;
+    Replay->Index[Index].EventType   = Replay->Event[Index].EventType;
+    Replay->Index[Index].EventNumber = Index;
+  }
+
+  QuickSort (Replay->Index, Replay->EventCount, sizeof (TCG_EVENT_LOG_REPLAY_INDEX_ENTRY), CompareIndexEntries, &Scratch);
+  return EFI_SUCCESS;
+}
+
+/**
+  Replay a number of consecutive events.
+
+  @param[in, out] Replay          The replay.
+  @param[in]      Events          The first event.
+  @param[in]      EventsSize      Size of the buffer holding the events in bytes.
+  @param[in]      NumberOfEvents  Number of events to replay, or MAX_UINTN to replay
+                                  until the end of the buffer.
+
+  @retval EFI_SUCCESS             The events were replayed.
+  @retval others                  An event could not be replayed.
+**/
+STATIC
+EFI_STATUS
+ReplayEvents (
+  IN OUT TCG_EVENT_LOG_REPLAY  *Replay,
+  IN     CONST UINT8           *Events,
+  IN     UINTN                 EventsSize,
+  IN     UINTN                 NumberOfEvents
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Offset;
+  UINTN       EventLength;
+  UINTN       Count;
+
+  Status = EFI_SUCCESS;
+  Offset = 0;
+  for (Count = 0; Count < NumberOfEvents; Count++) {
+    if ((NumberOfEvents == MAX_UINTN) && (Offset == EventsSize)) {
+      break;
+    }
+
+    Status = ReplayEvent (Replay, Events + Offset, EventsSize - Offset, &EventLength);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a: Failed at offset 0x%x. %r\n", __FUNCTION__, Offset, Status));
+      break;
+    }
+
+    Offset += EventLength;
+  }
+
+  //
+  // The events before a bad event were replayed, so keep them searchable.
+  //
+  if (EFI_ERROR (BuildIndex (Replay)) && !EFI_ERROR (Status)) {
+    Status = EFI_OUT_OF_RESOURCES;
+  }
+
+  return Status;
+}
+
+/**
+  Parse a crypto agile event log and replay its events.
+
+  @param[in]  EventLog           The event log.
+  @param[in]  EventLogSize       Size of the event log in bytes, up to the end of the
+                                 last event.
+  @param[out] Replay             Receives the replay. Free it with TcgEventLogReplayFree ().
+
+  @retval EFI_SUCCESS            The log was replayed.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL.
+  @retval EFI_UNSUPPORTED        The log is not a crypto agile log, or has more than
+                                 HASH_COUNT banks.
+  @retval EFI_COMPROMISED_DATA   The log is malformed.
+  @retval EFI_OUT_OF_RESOURCES   Memory allocation failed.
+**/
+EFI_STATUS
+EFIAPI
+TcgEventLogReplayCreate (
+  IN  CONST VOID            *EventLog,
+  IN  UINTN                 EventLogSize,
+  OUT TCG_EVENT_LOG_REPLAY  **Replay
+  )
+{
+  EFI_STATUS            Status;
+  TCG_EVENT_LOG_REPLAY  *NewReplay;
+  UINTN                 HeaderSize;
+
+  if ((EventLog == NULL) || (Replay == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  NewReplay = AllocateZeroPool (sizeof (TCG_EVENT_LOG_REPLAY));
+  if (NewReplay == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = ParseSpecIdEvent (NewReplay, EventLog, EventLogSize, &HeaderSize);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  Status = ReplayEvents (NewReplay, (CONST UINT8 *)EventLog + HeaderSize, EventLogSize - HeaderSize, MAX_UINTN);
+
+Exit:
+  if (EFI_ERROR (Status)) {
+    TcgEventLogReplayFree (NewReplay);
+  } else {
+    *Replay = NewReplay;
+  }
+
+  return Status;
+}
+
+/**
+  Replay more events of the same log, such as the events of the final events table.
+
+  @param[in, out] Replay         The replay to add the events to.
+  @param[in]      Events         TCG_PCR_EVENT2 events, without a Spec ID event.
+  @param[in]      EventsSize     Size of the buffer holding the events in bytes.
+  @param[in]      NumberOfEvents Number of events to replay.
+
+  @retval EFI_SUCCESS            The events were replayed.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL.
+  @retval EFI_COMPROMISED_DATA   An event is malformed. The events before it were replayed.
+  @retval EFI_OUT_OF_RESOURCES   Memory allocation failed.
+**/
+EFI_STATUS
+EFIAPI
+TcgEventLogReplayAppend (
+  IN OUT TCG_EVENT_LOG_REPLAY  *Replay,
+  IN     CONST VOID            *Events,
+  IN     UINTN                 EventsSize,
+  IN     UINTN                 NumberOfEvents
+  )
+{
+  if ((Replay == NULL) || ((Events == NULL) && (NumberOfEvents != 0)) || (NumberOfEvents == MAX_UINTN)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return ReplayEvents (Replay, Events, EventsSize, NumberOfEvents);
+}
+
+/**
+  Free a replay.
+
+  @param[in]  Replay             The replay to free. May be NULL.
+**/
+VOID
+EFIAPI
+TcgEventLogReplayFree (
+  IN TCG_EVENT_LOG_REPLAY  *Replay
+  )
+{
+  if (Replay == NULL) {
+    return;
+  }
+
+  if (Replay->Event != NULL) {
+    FreePool (Replay->Event);
+  }
+
+  if (Replay->Index != NULL) {
+    FreePool (Replay->Index);
+  }
+
+  FreePool (Replay);
+}
+
+/**
+  Get the replayed bank of a digest algorithm.
+
+  @param[in]  Replay             The replay.
+  @param[in]  HashAlg            The digest algorithm.
+
+  @return The bank, or NULL if the log has no such bank or it was not replayed.
+**/
+CONST TCG_EVENT_LOG_REPLAY_BANK *
+EFIAPI
+TcgEventLogReplayGetBank (
+  IN CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN TPMI_ALG_HASH               HashAlg
+  )
+{
+  UINT32  Index;
+
+  if (Replay == NULL) {
+    return NULL;
+  }
+
+  Index = FindBank (Replay, HashAlg);
+  if ((Index == Replay->BankCount) || !Replay->Bank[Index].Replayed) {
+    return NULL;
+  }
+
+  return &Replay->Bank[Index];
+}
+
+/**
+  Find the first index entry that does not sort before a key.
+
+  @return The position of the entry, or Replay->EventCount if there is none.
+**/
+STATIC
+UINTN
+LowerBound (
+  IN CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN UINT32                      PcrIndex,
+  IN UINT32                      EventType,
+  IN UINT32                      EventNumber
+  )
+{
+  TCG_EVENT_LOG_REPLAY_INDEX_ENTRY  Key;
+  UINTN                             Low;
+  UINTN                             High;
+  UINTN                             Middle;
+
+  Key.PcrIndex    = PcrIndex;
+  Key.EventType   = EventType;
+  Key.EventNumber = EventNumber;
+
+  Low  = 0;
+  High = Replay->EventCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (CompareIndexEntries (&Replay->Index[Middle], &Key) < 0) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  return Low;
+}
+
+/**
+  Find the events of a PCR and event type.
+
+  @param[in]  Replay             The replay.
+  @param[in]  PcrIndex           The PCR.
+  @param[in]  EventType          The event type, or TCG_EVENT_LOG_REPLAY_ANY_EVENT_TYPE.
+  @param[out] Entries            Receives the first matching index entry. The matching
+                                 entries are consecutive and in log order.
+
+  @return The number of matching events.
+**/
+UINTN
+EFIAPI
+TcgEventLogReplayFindEvents (
+  IN  CONST TCG_EVENT_LOG_REPLAY              *Replay,
+  IN  UINT32                                  PcrIndex,
+  IN  UINT32                                  EventType,
+  OUT CONST TCG_EVENT_LOG_REPLAY_INDEX_ENTRY  **Entries
+  )
+{
+  UINTN  First;
+  UINTN  End;
+
+  if ((Replay == NULL) || (Entries == NULL) || (Replay->Index == NULL)) {
+    return 0;
+  }
+
+  if (EventType == TCG_EVENT_LOG_REPLAY_ANY_EVENT_TYPE) {
+    First = LowerBound (Replay, PcrIndex, 0, 0);
+    End   = LowerBound (Replay, PcrIndex, MAX_UINT32, MAX_UINT32);
+    //
+    // Event numbers are below MAX_UINT32, so this only adds events of type MAX_UINT32.
+    //
+    while ((End < Replay->EventCount) && (Replay->Index[End].PcrIndex == PcrIndex)) {
+      End++;
+    }
+  } else {
+    First = LowerBound (Replay, PcrIndex, EventType, 0);
+    End   = LowerBound (Replay, PcrIndex, EventType, MAX_UINT32);
+  }
+
+  *Entries = &Replay->Index[First];
+  return End - First;
+}
+
+/**
+  Expand a PCR selection into the list of selected PCRs, in the order the TPM returns
+  or hashes their values.
+
+  @param[in]  Replay             The replay.
+  @param[in]  PcrSelection       The PCR selection.
+  @param[out] Selected           Receives the selected PCRs. Holds at least
+                                 HASH_COUNT * IMPLEMENTATION_PCR entries.
+  @param[out] SelectedCount      Receives the number of selected PCRs.
+
+  @retval EFI_SUCCESS            The selection was expanded.
+  @retval EFI_UNSUPPORTED        A selected bank was not replayed.
+  @retval EFI_INVALID_PARAMETER  The selection is not valid.
+**/
+STATIC
+EFI_STATUS
+ExpandPcrSelection (
+  IN  CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN  CONST TPML_PCR_SELECTION    *PcrSelection,
+  OUT SELECTED_PCR                *Selected,
+  OUT UINTN                       *SelectedCount
+  )
+{
+  CONST TPMS_PCR_SELECTION         *Selection;
+  CONST TCG_EVENT_LOG_REPLAY_BANK  *Bank;
+  UINT32                           Index;
+  UINT32                           Pcr;
+  UINTN                            Count;
+
+  if (PcrSelection->count > HASH_COUNT) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Count = 0;
+  for (Index = 0; Index < PcrSelection->count; Index++) {
+    Selection = &PcrSelection->pcrSelections[Index];
+    if (Selection->sizeofSelect > PCR_SELECT_MAX) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Bank = TcgEventLogReplayGetBank (Replay, Selection->hash);
+    for (Pcr = 0; Pcr < Selection->sizeofSelect * 8; Pcr++) {
+      if ((Selection->pcrSelect[Pcr / 8] & (1 << (Pcr % 8))) == 0) {
+        continue;
+      }
+
+      if (Bank == NULL) {
+        DEBUG ((DEBUG_ERROR, "%a: Bank 0x%x was not replayed.\n", __FUNCTION__, Selection->hash));
+        return EFI_UNSUPPORTED;
+      }
+
+      Selected[Count].Bank     = Bank;
+      Selected[Count].PcrIndex = Pcr;
+      Count++;
+    }
+  }
+
+  *SelectedCount = Count;
+  return EFI_SUCCESS;
+}
+
+/**
+  Compare the replayed PCR values with PCR values read from the TPM.
+
+  The selection and values are in the form returned by Tpm2PcrRead (): the values
+  follow the order of the selection, and the PCRs of each selection in ascending order.
+
+  @param[in]  Replay             The replay.
+  @param[in]  PcrSelection       The PCRs of PcrValues.
+  @param[in]  PcrValues          The PCR values.
+  @param[out] MismatchedPcrs     Optional. Receives a bit mask of the PCRs that do not
+                                 match in any bank.
+
+  @retval EFI_SUCCESS            All the PCR values match.
+  @retval EFI_SECURITY_VIOLATION At least one PCR value does not match.
+  @retval EFI_UNSUPPORTED        A selected bank was not replayed.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL, or the values do not match the selection.
+**/
+EFI_STATUS
+EFIAPI
+TcgEventLogReplayComparePcrs (
+  IN  CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN  CONST TPML_PCR_SELECTION    *PcrSelection,
+  IN  CONST TPML_DIGEST           *PcrValues,
+  OUT UINT32                      *MismatchedPcrs OPTIONAL
+  )
+{
+  EFI_STATUS          Status;
+  SELECTED_PCR        Selected[HASH_COUNT * IMPLEMENTATION_PCR];
+  UINTN               SelectedCount;
+  UINTN               Index;
+  CONST TPM2B_DIGEST  *Value;
+  UINT32              Mismatched;
+
+  if ((Replay == NULL) || (PcrSelection == NULL) || (PcrValues == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = ExpandPcrSelection (Replay, PcrSelection, Selected, &SelectedCount);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if ((PcrValues->count != SelectedCount) || (SelectedCount > ARRAY_SIZE (PcrValues->digests))) {
+    DEBUG ((DEBUG_ERROR, "%a: %d values for %d selected PCRs.\n", __FUNCTION__, PcrValues->count, SelectedCount));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Mismatched = 0;
+  for (Index = 0; Index < SelectedCount; Index++) {
+    Value = &PcrValues->digests[Index];
+    if (Value->size != Selected[Index].Bank->DigestSize) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    if (CompareMem (Value->buffer, Selected[Index].Bank->Pcr[Selected[Index].PcrIndex], Value->size) != 0) {
+      DEBUG ((DEBUG_INFO, "%a: PCR %d of bank 0x%x does not match the log.\n", __FUNCTION__, Selected[Index].PcrIndex, Selected[Index].Bank->HashAlg));
+      Mismatched |= (UINT32)1 << Selected[Index].PcrIndex;
+    }
+  }
+
+  if (MismatchedPcrs != NULL) {
+    *MismatchedPcrs = Mismatched;
+  }
+
+  return (Mismatched == 0) ? EFI_SUCCESS : EFI_SECURITY_VIOLATION;
+}
+
+/**
+  Compare the replayed PCR values with the PCR digest of a TPM quote.
+
+  @param[in]  Replay             The replay.
+  @param[in]  QuoteInfo          The unmarshaled quote information of the TPMS_ATTEST
+                                 returned by TPM2_Quote.
+  @param[in]  QuoteHashAlg       The digest algorithm of the quote signing scheme.
+
+  @retval EFI_SUCCESS            The PCR digest matches the replayed PCR values.
+  @retval EFI_SECURITY_VIOLATION The PCR digest does not match.
+  @retval EFI_UNSUPPORTED        A selected bank was not replayed, or QuoteHashAlg is
+                                 not supported.
+  @retval EFI_INVALID_PARAMETER  A pointer is NULL, or the selection is not valid.
+  @retval EFI_OUT_OF_RESOURCES   Memory allocation failed.
+**/
+EFI_STATUS
+EFIAPI
+TcgEventLogReplayCompareQuote (
+  IN CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN CONST TPMS_QUOTE_INFO       *QuoteInfo,
+  IN TPMI_ALG_HASH               QuoteHashAlg
+  )
+{
+  EFI_STATUS            Status;
+  CONST HASH_ALGORITHM  *HashAlgorithm;
+  SELECTED_PCR          Selected[HASH_COUNT * IMPLEMENTATION_PCR];
+  UINTN                 SelectedCount;
+  UINTN                 Index;
+  UINT8                 *PcrValues;
+  UINTN                 PcrValuesSize;
+  UINT8                 Digest[sizeof (TPMU_HA)];
+
+  if ((Replay == NULL) || (QuoteInfo == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  HashAlgorithm = GetHashAlgorithm (QuoteHashAlg);
+  if (HashAlgorithm == NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = ExpandPcrSelection (Replay, &QuoteInfo->pcrSelect, Selected, &SelectedCount);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  PcrValues = AllocatePool (SelectedCount * sizeof (TPMU_HA) + 1);
+  if (PcrValues == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // The PCR digest is the hash of the selected PCR values, in selection order.
+  //
+  PcrValuesSize = 0;
+  for (Index = 0; Index < SelectedCount; Index++) {
+    CopyMem (PcrValues + PcrValuesSize, Selected[Index].Bank->Pcr[Selected[Index].PcrIndex], Selected[Index].Bank->DigestSize);
+    PcrValuesSize += Selected[Index].Bank->DigestSize;
+  }
+
+  if (!HashAlgorithm->HashAll (PcrValues, PcrValuesSize, Digest)) {
+    Status = EFI_DEVICE_ERROR;
+    goto Exit;
+  }
+
+  if ((QuoteInfo->pcrDigest.size != HashAlgorithm->DigestSize) ||
+      (CompareMem (QuoteInfo->pcrDigest.buffer, Digest, HashAlgorithm->DigestSize) != 0))
+  {
+    DEBUG ((DEBUG_INFO, "%a: The quote PCR digest does not match the log.\n", __FUNCTION__));
+    Status = EFI_SECURITY_VIOLATION;
+  }
+
+Exit:
+  FreePool (PcrValues);
+  return Status;
+}
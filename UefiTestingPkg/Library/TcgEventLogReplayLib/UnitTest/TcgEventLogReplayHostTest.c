@@ -0,0 +1,554 @@
+/** @file
+  Host based test of TcgEventLogReplayLib.
+
+  The logs of TcgEventLogReplayTestLogs.h are replayed and the reconstructed PCR
+  values are checked against PCR values computed separately from the library.
+  Malformed copies of the logs check that every length is bounded by the log.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TcgEventLogReplayLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "TcgEventLogReplayTestLogs.h"
+
+#define UNIT_TEST_NAME     "TCG Event Log Replay Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+//
+// Offset of the first event of mTestLog, and of the fields of that event.
+//
+#define TEST_LOG_FIRST_EVENT_OFFSET  0x45
+#define TEST_LOG_EVENT_PCR_INDEX     0
+#define TEST_LOG_EVENT_DIGEST_COUNT  8
+#define TEST_SPEC_ID_SIGNATURE       (sizeof (TCG_PCR_EVENT_HDR))
+
+STATIC TCG_EVENT_LOG_REPLAY  *mReplay;
+STATIC UINT8                 mLogCopy[sizeof (mTestLog)];
+
+/**
+  Free the replay of a test.
+**/
+STATIC
+VOID
+EFIAPI
+FreeReplay (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TcgEventLogReplayFree (mReplay);
+  mReplay = NULL;
+}
+
+/**
+  Check that every PCR of a bank matches the expected values.
+**/
+STATIC
+BOOLEAN
+BankMatches (
+  IN CONST TCG_EVENT_LOG_REPLAY  *Replay,
+  IN TPMI_ALG_HASH               HashAlg,
+  IN CONST UINT8                 *Expected,
+  IN UINT16                      DigestSize
+  )
+{
+  CONST TCG_EVENT_LOG_REPLAY_BANK  *Bank;
+  UINT32                           Pcr;
+
+  Bank = TcgEventLogReplayGetBank (Replay, HashAlg);
+  if ((Bank == NULL) || (Bank->DigestSize != DigestSize)) {
+    return FALSE;
+  }
+
+  for (Pcr = 0; Pcr < IMPLEMENTATION_PCR; Pcr++) {
+    if (CompareMem (Bank->Pcr[Pcr], Expected + Pcr * DigestSize, DigestSize) != 0) {
+      DEBUG ((DEBUG_ERROR, "PCR %d of bank 0x%x does not match.\n", Pcr, HashAlg));
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Select SHA256 PCRs 0 to 7 and fill in their expected values.
+**/
+STATIC
+VOID
+SelectSha256Pcrs0To7 (
+  OUT TPML_PCR_SELECTION  *Selection,
+  OUT TPML_DIGEST         *Values
+  )
+{
+  UINT32  Pcr;
+
+  ZeroMem (Selection, sizeof (*Selection));
+  Selection->count                         = 1;
+  Selection->pcrSelections[0].hash         = TPM_ALG_SHA256;
+  Selection->pcrSelections[0].sizeofSelect = PCR_SELECT_MIN;
+  Selection->pcrSelections[0].pcrSelect[0] = 0xFF;
+
+  ZeroMem (Values, sizeof (*Values));
+  Values->count = 8;
+  for (Pcr = 0; Pcr < 8; Pcr++) {
+    Values->digests[Pcr].size = SHA256_DIGEST_SIZE;
+    CopyMem (Values->digests[Pcr].buffer, mTestLogSha256Pcrs[Pcr], SHA256_DIGEST_SIZE);
+  }
+}
+
+/**
+  The banks of the log should be replayed into the expected PCR values, including the
+  StartupLocality of PCR0 and the reset value of the DRTM PCRs.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ReplayLog (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = TcgEventLogReplayCreate (mTestLog, sizeof (mTestLog), &mReplay);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  UT_ASSERT_EQUAL (mReplay->BankCount, 2);
+  UT_ASSERT_EQUAL (mReplay->Bank[0].HashAlg, TPM_ALG_SHA1);
+  UT_ASSERT_EQUAL (mReplay->Bank[1].HashAlg, TPM_ALG_SHA256);
+  UT_ASSERT_EQUAL (mReplay->EventCount, TEST_LOG_EVENT_COUNT);
+  UT_ASSERT_EQUAL (mReplay->StartupLocality, 3);
+
+  UT_ASSERT_TRUE (BankMatches (mReplay, TPM_ALG_SHA1, &mTestLogSha1Pcrs[0][0], SHA1_DIGEST_SIZE));
+  UT_ASSERT_TRUE (BankMatches (mReplay, TPM_ALG_SHA256, &mTestLogSha256Pcrs[0][0], SHA256_DIGEST_SIZE));
+  UT_ASSERT_TRUE (TcgEventLogReplayGetBank (mReplay, TPM_ALG_SHA384) == NULL);
+
+  //
+  // Events point into the log.
+  //
+  UT_ASSERT_EQUAL (mReplay->Event[0].EventType, EV_NO_ACTION);
+  UT_ASSERT_TRUE (mReplay->Event[0].EventData > mTestLog);
+  UT_ASSERT_TRUE (mReplay->Event[TEST_LOG_EVENT_COUNT - 1].EventData < mTestLog + sizeof (mTestLog));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Events should be found by PCR and event type, in log order.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FindEvents (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS                              Status;
+  CONST TCG_EVENT_LOG_REPLAY_INDEX_ENTRY  *Entries;
+  UINTN                                   Count;
+  UINTN                                   Index;
+  UINT32                                  Pcr;
+  UINTN                                   Total;
+
+  Status = TcgEventLogReplayCreate (mTestLog, sizeof (mTestLog), &mReplay);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Count = TcgEventLogReplayFindEvents (mReplay, 0, EV_EFI_PLATFORM_FIRMWARE_BLOB, &Entries);
+  UT_ASSERT_EQUAL (Count, 2);
+  UT_ASSERT_EQUAL (Entries[0].EventNumber, 2);
+  UT_ASSERT_EQUAL (Entries[1].EventNumber, 3);
+
+  Count = TcgEventLogReplayFindEvents (mReplay, 4, EV_EFI_BOOT_SERVICES_APPLICATION, &Entries);
+  UT_ASSERT_EQUAL (Count, 2);
+  UT_ASSERT_TRUE (Entries[0].EventNumber < Entries[1].EventNumber);
+  UT_ASSERT_EQUAL (mReplay->Event[Entries[1].EventNumber].EventType, EV_EFI_BOOT_SERVICES_APPLICATION);
+
+  Count = TcgEventLogReplayFindEvents (mReplay, 7, EV_EFI_VARIABLE_DRIVER_CONFIG, &Entries);
+  UT_ASSERT_EQUAL (Count, 2);
+
+  //
+  // Separators of PCRs 0 to 7.
+  //
+  for (Pcr = 0; Pcr < 8; Pcr++) {
+    Count = TcgEventLogReplayFindEvents (mReplay, Pcr, EV_SEPARATOR, &Entries);
+    UT_ASSERT_EQUAL (Count, 1);
+    UT_ASSERT_EQUAL (mReplay->Event[Entries[0].EventNumber].PcrIndex, Pcr);
+  }
+
+  //
+  // PCR0 has the StartupLocality, CRTM version, two firmware blobs, separator and a
+  // late EV_NO_ACTION event.
+  //
+  Count = TcgEventLogReplayFindEvents (mReplay, 0, TCG_EVENT_LOG_REPLAY_ANY_EVENT_TYPE, &Entries);
+  UT_ASSERT_EQUAL (Count, 6);
+  for (Index = 0; Index < Count; Index++) {
+    UT_ASSERT_EQUAL (Entries[Index].PcrIndex, 0);
+  }
+
+  Count = TcgEventLogReplayFindEvents (mReplay, 0, EV_NO_ACTION, &Entries);
+  UT_ASSERT_EQUAL (Count, 2);
+
+  Count = TcgEventLogReplayFindEvents (mReplay, 5, EV_EFI_BOOT_SERVICES_APPLICATION, &Entries);
+  UT_ASSERT_EQUAL (Count, 0);
+  Count = TcgEventLogReplayFindEvents (mReplay, 23, TCG_EVENT_LOG_REPLAY_ANY_EVENT_TYPE, &Entries);
+  UT_ASSERT_EQUAL (Count, 0);
+
+  Total = 0;
+  for (Pcr = 0; Pcr < IMPLEMENTATION_PCR; Pcr++) {
+    Total += TcgEventLogReplayFindEvents (mReplay, Pcr, TCG_EVENT_LOG_REPLAY_ANY_EVENT_TYPE, &Entries);
+  }
+
+  UT_ASSERT_EQUAL (Total, TEST_LOG_EVENT_COUNT);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  PCR values read from a TPM should be compared per PCR and bank.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ComparePcrs (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS          Status;
+  TPML_PCR_SELECTION  Selection;
+  TPML_DIGEST         Values;
+  UINT32              Mismatched;
+
+  Status = TcgEventLogReplayCreate (mTestLog, sizeof (mTestLog), &mReplay);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  SelectSha256Pcrs0To7 (&Selection, &Values);
+  Mismatched = MAX_UINT32;
+  Status     = TcgEventLogReplayComparePcrs (mReplay, &Selection, &Values, &Mismatched);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+  UT_ASSERT_EQUAL (Mismatched, 0);
+
+  //
+  // Values follow the selection order, so PCRs 1 and 7 are digests 1 and 7.
+  //
+  Values.digests[1].buffer[0] ^= 1;
+
+  Values.digests[7].buffer[SHA256_DIGEST_SIZE - 1] ^= 1;
+  Status = TcgEventLogReplayComparePcrs (mReplay, &Selection, &Values, &Mismatched);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SECURITY_VIOLATION);
+  UT_ASSERT_EQUAL (Mismatched, BIT1 | BIT7);
+
+  //
+  // SHA1 PCRs 16 and 17, as a second selection with sparse PCRs.
+  //
+  SelectSha256Pcrs0To7 (&Selection, &Values);
+  Selection.count                         = 2;
+  Selection.pcrSelections[1].hash         = TPM_ALG_SHA1;
+  Selection.pcrSelections[1].sizeofSelect = PCR_SELECT_MIN;
+  Selection.pcrSelections[1].pcrSelect[2] = BIT0 | BIT1;
+  Selection.pcrSelections[0].pcrSelect[0] = BIT0 | BIT2;
+  Values.count                            = 4;
+  CopyMem (Values.digests[1].buffer, mTestLogSha256Pcrs[2], SHA256_DIGEST_SIZE);
+  Values.digests[2].size = SHA1_DIGEST_SIZE;
+  CopyMem (Values.digests[2].buffer, mTestLogSha1Pcrs[16], SHA1_DIGEST_SIZE);
+  Values.digests[3].size = SHA1_DIGEST_SIZE;
+  CopyMem (Values.digests[3].buffer, mTestLogSha1Pcrs[17], SHA1_DIGEST_SIZE);
+  Status = TcgEventLogReplayComparePcrs (mReplay, &Selection, &Values, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  //
+  // Values that do not match the selection.
+  //
+  Values.count = 3;
+  Status       = TcgEventLogReplayComparePcrs (mReplay, &Selection, &Values, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Values.count           = 4;
+  Values.digests[3].size = SHA256_DIGEST_SIZE;
+  Status                 = TcgEventLogReplayComparePcrs (mReplay, &Selection, &Values, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  //
+  // Selections larger than PCR_SELECT_MAX and banks that are not in the log.
+  //
+  SelectSha256Pcrs0To7 (&Selection, &Values);
+  Selection.pcrSelections[0].sizeofSelect = PCR_SELECT_MAX + 1;
+  Status                                  = TcgEventLogReplayComparePcrs (mReplay, &Selection, &Values, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  SelectSha256Pcrs0To7 (&Selection, &Values);
+  Selection.pcrSelections[0].hash = TPM_ALG_SHA384;
+  Status                          = TcgEventLogReplayComparePcrs (mReplay, &Selection, &Values, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_UNSUPPORTED);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The PCR digest of a quote should be compared with the replayed PCR values.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CompareQuote (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS       Status;
+  TPMS_QUOTE_INFO  QuoteInfo;
+  TPML_DIGEST      Values;
+
+  Status = TcgEventLogReplayCreate (mTestLog, sizeof (mTestLog), &mReplay);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  SelectSha256Pcrs0To7 (&QuoteInfo.pcrSelect, &Values);
+  QuoteInfo.pcrDigest.size = sizeof (mTestLogQuoteDigest);
+  CopyMem (QuoteInfo.pcrDigest.buffer, mTestLogQuoteDigest, sizeof (mTestLogQuoteDigest));
+
+  Status = TcgEventLogReplayCompareQuote (mReplay, &QuoteInfo, TPM_ALG_SHA256);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SUCCESS);
+
+  //
+  // The digest of a different selection, or of a different hash, does not match.
+  //
+  QuoteInfo.pcrSelect.pcrSelections[0].pcrSelect[0] = 0x7F;
+  Status                                            = TcgEventLogReplayCompareQuote (mReplay, &QuoteInfo, TPM_ALG_SHA256);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SECURITY_VIOLATION);
+
+  QuoteInfo.pcrSelect.pcrSelections[0].pcrSelect[0] = 0xFF;
+  Status                                            = TcgEventLogReplayCompareQuote (mReplay, &QuoteInfo, TPM_ALG_SHA384);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SECURITY_VIOLATION);
+
+  QuoteInfo.pcrDigest.buffer[0] ^= 1;
+  Status                         = TcgEventLogReplayCompareQuote (mReplay, &QuoteInfo, TPM_ALG_SHA256);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_SECURITY_VIOLATION);
+
+  Status = TcgEventLogReplayCompareQuote (mReplay, &QuoteInfo, TPM_ALG_NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_UNSUPPORTED);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Events of the final events table should continue the replay of the log.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+AppendEvents (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS                              Status;
+  CONST TCG_EVENT_LOG_REPLAY_INDEX_ENTRY  *Entries;
+
+  Status = TcgEventLogReplayCreate (mTestLog, TEST_LOG_SPLIT_OFFSET, &mReplay);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (mReplay->EventCount, TEST_LOG_SPLIT_EVENT_COUNT);
+  UT_ASSERT_FALSE (BankMatches (mReplay, TPM_ALG_SHA256, &mTestLogSha256Pcrs[0][0], SHA256_DIGEST_SIZE));
+
+  //
+  // The rest of the log stands in for the final events table.
+  //
+  Status = TcgEventLogReplayAppend (
+             mReplay,
+             mTestLog + TEST_LOG_SPLIT_OFFSET,
+             sizeof (mTestLog) - TEST_LOG_SPLIT_OFFSET,
+             TEST_LOG_EVENT_COUNT - TEST_LOG_SPLIT_EVENT_COUNT
+             );
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  UT_ASSERT_EQUAL (mReplay->EventCount, TEST_LOG_EVENT_COUNT);
+  UT_ASSERT_TRUE (BankMatches (mReplay, TPM_ALG_SHA1, &mTestLogSha1Pcrs[0][0], SHA1_DIGEST_SIZE));
+  UT_ASSERT_TRUE (BankMatches (mReplay, TPM_ALG_SHA256, &mTestLogSha256Pcrs[0][0], SHA256_DIGEST_SIZE));
+  UT_ASSERT_EQUAL (TcgEventLogReplayFindEvents (mReplay, 4, EV_EFI_BOOT_SERVICES_APPLICATION, &Entries), 2);
+
+  Status = TcgEventLogReplayAppend (mReplay, mTestLog + TEST_LOG_SPLIT_OFFSET, 0, 1);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_COMPROMISED_DATA);
+  UT_ASSERT_EQUAL (mReplay->EventCount, TEST_LOG_EVENT_COUNT);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Banks of digest algorithms the library cannot hash should be parsed but not replayed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnknownBank (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = TcgEventLogReplayCreate (mTestLogUnknownBank, sizeof (mTestLogUnknownBank), &mReplay);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  UT_ASSERT_EQUAL (mReplay->BankCount, 3);
+  UT_ASSERT_EQUAL (mReplay->EventCount, TEST_LOG_UNKNOWN_BANK_EVENT_COUNT);
+  UT_ASSERT_FALSE (mReplay->Bank[1].Replayed);
+  UT_ASSERT_TRUE (mReplay->Event[0].Digest[1] != NULL);
+  UT_ASSERT_TRUE (TcgEventLogReplayGetBank (mReplay, mReplay->Bank[1].HashAlg) == NULL);
+
+  UT_ASSERT_TRUE (BankMatches (mReplay, TPM_ALG_SHA256, &mTestLogUnknownBankSha256Pcrs[0][0], SHA256_DIGEST_SIZE));
+  UT_ASSERT_TRUE (BankMatches (mReplay, TPM_ALG_SHA384, &mTestLogUnknownBankSha384Pcrs[0][0], SHA384_DIGEST_SIZE));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Malformed logs should be rejected without reading past the log.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MalformedLogs (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Size;
+  UINT8       *Log;
+  UINT32      Value;
+
+  //
+  // Every truncation either ends between events or is rejected. Each copy is in a
+  // buffer of its own size so reads past the end are caught.
+  //
+  for (Size = 0; Size < sizeof (mTestLog); Size++) {
+    Log = AllocateCopyPool (MAX (Size, 1), mTestLog);
+    UT_ASSERT_NOT_NULL (Log);
+    Status = TcgEventLogReplayCreate (Log, Size, &mReplay);
+    if (!EFI_ERROR (Status)) {
+      UT_ASSERT_TRUE (Size >= TEST_LOG_FIRST_EVENT_OFFSET);
+      UT_ASSERT_TRUE (mReplay->EventCount < TEST_LOG_EVENT_COUNT);
+      FreeReplay (NULL);
+    } else {
+      UT_ASSERT_TRUE ((Status == EFI_COMPROMISED_DATA) || (Status == EFI_UNSUPPORTED));
+    }
+
+    FreePool (Log);
+  }
+
+  //
+  // Not a crypto agile log.
+  //
+  CopyMem (mLogCopy, mTestLog, sizeof (mTestLog));
+  mLogCopy[TEST_SPEC_ID_SIGNATURE + 14] = '2';
+  Status                                = TcgEventLogReplayCreate (mLogCopy, sizeof (mLogCopy), &mReplay);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_UNSUPPORTED);
+
+  //
+  // An event for a PCR that does not exist.
+  //
+  CopyMem (mLogCopy, mTestLog, sizeof (mTestLog));
+  Value = IMPLEMENTATION_PCR;
+  CopyMem (mLogCopy + TEST_LOG_FIRST_EVENT_OFFSET + TEST_LOG_EVENT_PCR_INDEX, &Value, sizeof (Value));
+  Status = TcgEventLogReplayCreate (mLogCopy, sizeof (mLogCopy), &mReplay);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_COMPROMISED_DATA);
+
+  //
+  // An event without a digest for every bank, and one with a huge digest count.
+  //
+  CopyMem (mLogCopy, mTestLog, sizeof (mTestLog));
+  Value = 1;
+  CopyMem (mLogCopy + TEST_LOG_FIRST_EVENT_OFFSET + TEST_LOG_EVENT_DIGEST_COUNT, &Value, sizeof (Value));
+  Status = TcgEventLogReplayCreate (mLogCopy, sizeof (mLogCopy), &mReplay);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_COMPROMISED_DATA);
+
+  Value = MAX_UINT32;
+  CopyMem (mLogCopy + TEST_LOG_FIRST_EVENT_OFFSET + TEST_LOG_EVENT_DIGEST_COUNT, &Value, sizeof (Value));
+  Status = TcgEventLogReplayCreate (mLogCopy, sizeof (mLogCopy), &mReplay);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_COMPROMISED_DATA);
+
+  //
+  // An event size that overruns the log.
+  //
+  CopyMem (mLogCopy, mTestLog, sizeof (mTestLog));
+  Value = MAX_UINT32;
+  CopyMem (mLogCopy + TEST_LOG_SPLIT_OFFSET - sizeof (UINT32) - 4, &Value, sizeof (Value));
+  Status = TcgEventLogReplayCreate (mLogCopy, sizeof (mLogCopy), &mReplay);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_COMPROMISED_DATA);
+
+  UT_ASSERT_TRUE (mReplay == NULL);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  TCG event log replay and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ReplaySuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the Replay Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&ReplaySuite, Framework, "Replay", "TcgEventLog.Replay", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ReplaySuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (ReplaySuite, "The log should replay into the expected PCR values", "ReplayLog", ReplayLog, NULL, FreeReplay, NULL);
+  AddTestCase (ReplaySuite, "Events should be found by PCR and event type", "FindEvents", FindEvents, NULL, FreeReplay, NULL);
+  AddTestCase (ReplaySuite, "PCR values should be compared per PCR and bank", "ComparePcrs", ComparePcrs, NULL, FreeReplay, NULL);
+  AddTestCase (ReplaySuite, "The PCR digest of a quote should be compared", "CompareQuote", CompareQuote, NULL, FreeReplay, NULL);
+  AddTestCase (ReplaySuite, "Final events should continue the replay", "AppendEvents", AppendEvents, NULL, FreeReplay, NULL);
+  AddTestCase (ReplaySuite, "Unsupported banks should be parsed but not replayed", "UnknownBank", UnknownBank, NULL, FreeReplay, NULL);
+  AddTestCase (ReplaySuite, "Malformed logs should be rejected", "MalformedLogs", MalformedLogs, NULL, FreeReplay, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
@@ -0,0 +1,722 @@
+/** @file
+  Event logs used by the TcgEventLogReplayLib host test.
+
+  The logs are in the TCG PC Client crypto agile format, as returned by
+  EFI_TCG2_PROTOCOL.GetEventLog (). The PCR values were computed separately
+  from the library by hashing the event data and extending each bank.
+
+  mTestLog has SHA1 and SHA256 banks. It starts with a StartupLocality event of
+  locality 3, has an event in the DRTM PCR 17, EV_NO_ACTION events before and
+  after PCR0 is extended, and an event with its digests out of bank order.
+
+  mTestLogUnknownBank has SHA256, SHA3_256 and SHA384 banks.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef TCG_EVENT_LOG_REPLAY_TEST_LOGS_H_
+#define TCG_EVENT_LOG_REPLAY_TEST_LOGS_H_
+
+STATIC CONST UINT8  mTestLog[] = {
+  0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00, 0x53, 0x70, 0x65, 0x63,
+  0x20, 0x49, 0x44, 0x20, 0x45, 0x76, 0x65, 0x6e, 0x74, 0x30, 0x33, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x02, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x14, 0x00, 0x0b, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00, 0x53, 0x74, 0x61,
+  0x72, 0x74, 0x75, 0x70, 0x4c, 0x6f, 0x63, 0x61, 0x6c, 0x69, 0x74, 0x79,
+  0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x02, 0x00,
+  0x00, 0x00, 0x04, 0x00, 0x44, 0x34, 0xc0, 0x22, 0x5b, 0x67, 0x3c, 0x7f,
+  0x63, 0x8d, 0x98, 0x48, 0x19, 0xfe, 0x8b, 0x58, 0x7e, 0xe2, 0xd4, 0xb7,
+  0x0b, 0x00, 0x7f, 0xd0, 0x54, 0x4e, 0x8a, 0xf8, 0xd7, 0xfd, 0x49, 0xf9,
+  0xb2, 0x47, 0x93, 0x55, 0x1b, 0x9b, 0x55, 0xab, 0x0a, 0xe6, 0xa0, 0xd1,
+  0x69, 0xf5, 0xca, 0x56, 0x17, 0x5c, 0x42, 0x8c, 0x68, 0x6b, 0x0c, 0x00,
+  0x00, 0x00, 0x31, 0x00, 0x2e, 0x00, 0x30, 0x00, 0x2e, 0x00, 0x30, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x80, 0x02, 0x00,
+  0x00, 0x00, 0x04, 0x00, 0xa1, 0xfc, 0x49, 0x06, 0x5d, 0x44, 0x71, 0xc7,
+  0xf9, 0x23, 0x4b, 0x6b, 0x5e, 0xa5, 0x71, 0x4e, 0x73, 0x13, 0x58, 0x5f,
+  0x0b, 0x00, 0xf6, 0x34, 0x2e, 0x7d, 0xb7, 0x3e, 0x52, 0x38, 0xe7, 0x81,
+  0xb7, 0x60, 0x2b, 0xc3, 0x7f, 0x76, 0xc2, 0x05, 0x7c, 0x75, 0x06, 0x28,
+  0x4b, 0xd6, 0xc9, 0x45, 0x90, 0xf6, 0x18, 0x04, 0xae, 0xb1, 0x10, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00,
+  0x00, 0x80, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0xf1, 0xe9, 0xd9, 0xcf,
+  0x55, 0xc6, 0x7b, 0x11, 0xb6, 0xf0, 0x51, 0xe7, 0xf8, 0x8b, 0x30, 0x38,
+  0x30, 0x46, 0xca, 0x9e, 0x0b, 0x00, 0x64, 0x3f, 0x01, 0x6e, 0x3f, 0x13,
+  0xf7, 0xca, 0xa8, 0xda, 0xec, 0xd1, 0xff, 0xf8, 0x48, 0xc4, 0xc1, 0x41,
+  0xbb, 0x8b, 0xd3, 0x03, 0x62, 0x57, 0xfe, 0x78, 0x9a, 0xb8, 0xd9, 0xea,
+  0x93, 0x01, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0xff, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00,
+  0x00, 0x00, 0x01, 0x00, 0x00, 0x80, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00,
+  0xc0, 0x7f, 0x74, 0x3e, 0xba, 0x9b, 0xab, 0xf9, 0x96, 0xad, 0xe0, 0xdc,
+  0x61, 0x58, 0xe6, 0x8e, 0xcc, 0x00, 0xaf, 0xb7, 0x0b, 0x00, 0xe0, 0x01,
+  0x72, 0x16, 0x44, 0x2a, 0x2e, 0xd1, 0x95, 0x5b, 0xac, 0xec, 0x6c, 0xc4,
+  0x21, 0xa1, 0xf1, 0xc9, 0x3c, 0x13, 0x31, 0x3c, 0x5c, 0x60, 0x97, 0x11,
+  0xcd, 0x80, 0xf1, 0x20, 0xcc, 0xbe, 0x0c, 0x00, 0x00, 0x00, 0x53, 0x65,
+  0x63, 0x75, 0x72, 0x65, 0x42, 0x6f, 0x6f, 0x74, 0x00, 0x01, 0x07, 0x00,
+  0x00, 0x00, 0x01, 0x00, 0x00, 0x80, 0x02, 0x00, 0x00, 0x00, 0x0b, 0x00,
+  0x67, 0x21, 0x2a, 0x7d, 0x16, 0x2a, 0x0a, 0x2d, 0xcd, 0x82, 0xfd, 0xc3,
+  0x68, 0xe2, 0x23, 0x20, 0x0c, 0x4f, 0x04, 0x2e, 0x4e, 0xee, 0x5f, 0xee,
+  0x27, 0x2a, 0xc6, 0xec, 0x68, 0xd9, 0xfa, 0x85, 0x04, 0x00, 0x0e, 0xe6,
+  0xf4, 0xd6, 0x04, 0x50, 0xed, 0x88, 0xb8, 0x4a, 0x89, 0x93, 0x66, 0xde,
+  0xca, 0x20, 0x94, 0x3a, 0x5a, 0xd1, 0x23, 0x00, 0x00, 0x00, 0x50, 0x4b,
+  0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+  0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+  0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x01, 0x00, 0x00,
+  0x00, 0x02, 0x00, 0x00, 0x80, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x77,
+  0x2d, 0xd4, 0x77, 0x9f, 0xe6, 0x5f, 0x5a, 0x41, 0xfa, 0x93, 0x60, 0x66,
+  0xb9, 0x46, 0x98, 0xac, 0x4a, 0x0c, 0x09, 0x0b, 0x00, 0x51, 0x92, 0x5d,
+  0x42, 0x15, 0x94, 0xda, 0xcc, 0xd9, 0x1d, 0x96, 0xb2, 0x4d, 0xc8, 0x39,
+  0x16, 0x73, 0x99, 0x43, 0xf8, 0x25, 0xe7, 0x3d, 0x0e, 0x72, 0x7f, 0x6c,
+  0x4f, 0xba, 0x36, 0xc6, 0xfc, 0x33, 0x00, 0x00, 0x00, 0x42, 0x6f, 0x6f,
+  0x74, 0x30, 0x30, 0x30, 0x30, 0x00, 0x57, 0x00, 0x69, 0x00, 0x6e, 0x00,
+  0x64, 0x00, 0x6f, 0x00, 0x77, 0x00, 0x73, 0x00, 0x20, 0x00, 0x42, 0x00,
+  0x6f, 0x00, 0x6f, 0x00, 0x74, 0x00, 0x20, 0x00, 0x4d, 0x00, 0x61, 0x00,
+  0x6e, 0x00, 0x61, 0x00, 0x67, 0x00, 0x65, 0x00, 0x72, 0x00, 0x00, 0x00,
+  0x11, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x4e, 0xd1, 0x84, 0xef, 0xd8, 0x57, 0x63, 0x97, 0xc4, 0xc5,
+  0x95, 0x97, 0x41, 0xd0, 0x5a, 0x9e, 0xc9, 0xb5, 0x74, 0x78, 0x0b, 0x00,
+  0x6a, 0xef, 0xac, 0x42, 0x56, 0x21, 0xdf, 0x01, 0x17, 0x08, 0x80, 0x9a,
+  0xc0, 0x69, 0x22, 0xb7, 0xff, 0x74, 0xdc, 0x7c, 0xd7, 0xcc, 0x3f, 0x32,
+  0x41, 0x21, 0x68, 0xfe, 0x7f, 0xdf, 0xfa, 0xa2, 0x04, 0x00, 0x00, 0x00,
+  0x44, 0x52, 0x54, 0x4d, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+  0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x90, 0x69, 0xca, 0x78, 0xe7, 0x45,
+  0x0a, 0x28, 0x51, 0x73, 0x43, 0x1b, 0x3e, 0x52, 0xc5, 0xc2, 0x52, 0x99,
+  0xe4, 0x73, 0x0b, 0x00, 0xdf, 0x3f, 0x61, 0x98, 0x04, 0xa9, 0x2f, 0xdb,
+  0x40, 0x57, 0x19, 0x2d, 0xc4, 0x3d, 0xd7, 0x48, 0xea, 0x77, 0x8a, 0xdc,
+  0x52, 0xbc, 0x49, 0x8c, 0xe8, 0x05, 0x24, 0xc0, 0x14, 0xb8, 0x11, 0x19,
+  0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x90, 0x69,
+  0xca, 0x78, 0xe7, 0x45, 0x0a, 0x28, 0x51, 0x73, 0x43, 0x1b, 0x3e, 0x52,
+  0xc5, 0xc2, 0x52, 0x99, 0xe4, 0x73, 0x0b, 0x00, 0xdf, 0x3f, 0x61, 0x98,
+  0x04, 0xa9, 0x2f, 0xdb, 0x40, 0x57, 0x19, 0x2d, 0xc4, 0x3d, 0xd7, 0x48,
+  0xea, 0x77, 0x8a, 0xdc, 0x52, 0xbc, 0x49, 0x8c, 0xe8, 0x05, 0x24, 0xc0,
+  0x14, 0xb8, 0x11, 0x19, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x90, 0x69, 0xca, 0x78, 0xe7, 0x45, 0x0a, 0x28, 0x51, 0x73,
+  0x43, 0x1b, 0x3e, 0x52, 0xc5, 0xc2, 0x52, 0x99, 0xe4, 0x73, 0x0b, 0x00,
+  0xdf, 0x3f, 0x61, 0x98, 0x04, 0xa9, 0x2f, 0xdb, 0x40, 0x57, 0x19, 0x2d,
+  0xc4, 0x3d, 0xd7, 0x48, 0xea, 0x77, 0x8a, 0xdc, 0x52, 0xbc, 0x49, 0x8c,
+  0xe8, 0x05, 0x24, 0xc0, 0x14, 0xb8, 0x11, 0x19, 0x04, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+  0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x90, 0x69, 0xca, 0x78, 0xe7, 0x45,
+  0x0a, 0x28, 0x51, 0x73, 0x43, 0x1b, 0x3e, 0x52, 0xc5, 0xc2, 0x52, 0x99,
+  0xe4, 0x73, 0x0b, 0x00, 0xdf, 0x3f, 0x61, 0x98, 0x04, 0xa9, 0x2f, 0xdb,
+  0x40, 0x57, 0x19, 0x2d, 0xc4, 0x3d, 0xd7, 0x48, 0xea, 0x77, 0x8a, 0xdc,
+  0x52, 0xbc, 0x49, 0x8c, 0xe8, 0x05, 0x24, 0xc0, 0x14, 0xb8, 0x11, 0x19,
+  0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x90, 0x69,
+  0xca, 0x78, 0xe7, 0x45, 0x0a, 0x28, 0x51, 0x73, 0x43, 0x1b, 0x3e, 0x52,
+  0xc5, 0xc2, 0x52, 0x99, 0xe4, 0x73, 0x0b, 0x00, 0xdf, 0x3f, 0x61, 0x98,
+  0x04, 0xa9, 0x2f, 0xdb, 0x40, 0x57, 0x19, 0x2d, 0xc4, 0x3d, 0xd7, 0x48,
+  0xea, 0x77, 0x8a, 0xdc, 0x52, 0xbc, 0x49, 0x8c, 0xe8, 0x05, 0x24, 0xc0,
+  0x14, 0xb8, 0x11, 0x19, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x05, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x90, 0x69, 0xca, 0x78, 0xe7, 0x45, 0x0a, 0x28, 0x51, 0x73,
+  0x43, 0x1b, 0x3e, 0x52, 0xc5, 0xc2, 0x52, 0x99, 0xe4, 0x73, 0x0b, 0x00,
+  0xdf, 0x3f, 0x61, 0x98, 0x04, 0xa9, 0x2f, 0xdb, 0x40, 0x57, 0x19, 0x2d,
+  0xc4, 0x3d, 0xd7, 0x48, 0xea, 0x77, 0x8a, 0xdc, 0x52, 0xbc, 0x49, 0x8c,
+  0xe8, 0x05, 0x24, 0xc0, 0x14, 0xb8, 0x11, 0x19, 0x04, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+  0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x90, 0x69, 0xca, 0x78, 0xe7, 0x45,
+  0x0a, 0x28, 0x51, 0x73, 0x43, 0x1b, 0x3e, 0x52, 0xc5, 0xc2, 0x52, 0x99,
+  0xe4, 0x73, 0x0b, 0x00, 0xdf, 0x3f, 0x61, 0x98, 0x04, 0xa9, 0x2f, 0xdb,
+  0x40, 0x57, 0x19, 0x2d, 0xc4, 0x3d, 0xd7, 0x48, 0xea, 0x77, 0x8a, 0xdc,
+  0x52, 0xbc, 0x49, 0x8c, 0xe8, 0x05, 0x24, 0xc0, 0x14, 0xb8, 0x11, 0x19,
+  0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x90, 0x69,
+  0xca, 0x78, 0xe7, 0x45, 0x0a, 0x28, 0x51, 0x73, 0x43, 0x1b, 0x3e, 0x52,
+  0xc5, 0xc2, 0x52, 0x99, 0xe4, 0x73, 0x0b, 0x00, 0xdf, 0x3f, 0x61, 0x98,
+  0x04, 0xa9, 0x2f, 0xdb, 0x40, 0x57, 0x19, 0x2d, 0xc4, 0x3d, 0xd7, 0x48,
+  0xea, 0x77, 0x8a, 0xdc, 0x52, 0xbc, 0x49, 0x8c, 0xe8, 0x05, 0x24, 0xc0,
+  0x14, 0xb8, 0x11, 0x19, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x80, 0x02, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x1d, 0x54, 0xf3, 0x15, 0xa8, 0x38, 0x72, 0x70, 0xbd, 0x6a,
+  0x68, 0x25, 0xf5, 0x8b, 0x66, 0x35, 0x42, 0x9b, 0x53, 0xf2, 0x0b, 0x00,
+  0xd0, 0xfa, 0x3f, 0x6b, 0xd5, 0x8f, 0x10, 0x0e, 0x72, 0xf0, 0xd9, 0xf7,
+  0x4c, 0xab, 0x1f, 0xf1, 0x79, 0x89, 0x2b, 0xca, 0x4e, 0x5a, 0x94, 0x3f,
+  0xbc, 0xbe, 0xd2, 0xa4, 0x64, 0x19, 0xa4, 0x93, 0x18, 0x00, 0x00, 0x00,
+  0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10,
+  0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10,
+  0x0e, 0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+  0x04, 0x00, 0x80, 0x68, 0xa1, 0x7f, 0x53, 0x1e, 0x7c, 0xb8, 0x71, 0xf7,
+  0x32, 0x7d, 0x9d, 0x48, 0xdf, 0xa6, 0xee, 0xa0, 0x61, 0x31, 0x0b, 0x00,
+  0x0c, 0xd5, 0x17, 0x0b, 0xd6, 0x02, 0xbd, 0x00, 0x49, 0x75, 0x04, 0xb0,
+  0x29, 0x1d, 0xda, 0x2c, 0x0d, 0xe9, 0x2d, 0x29, 0xdc, 0xa9, 0x86, 0x18,
+  0x98, 0xb1, 0x8b, 0xa3, 0x9c, 0x20, 0xd1, 0x04, 0x07, 0x00, 0x00, 0x00,
+  0x4d, 0x6f, 0x6b, 0x4c, 0x69, 0x73, 0x74, 0x00, 0x00, 0x00, 0x00, 0x03,
+  0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x53, 0x50, 0x38, 0x30, 0x30,
+  0x2d, 0x31, 0x35, 0x35, 0x20, 0x45, 0x76, 0x65, 0x6e, 0x74, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x03,
+  0x00, 0x00, 0x80, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x16, 0x04, 0xb8,
+  0x30, 0x99, 0x09, 0xe8, 0xa7, 0x62, 0x6f, 0xad, 0x67, 0x0d, 0x09, 0x2c,
+  0x3b, 0xec, 0xd8, 0x23, 0x4b, 0x0b, 0x00, 0xa8, 0x94, 0x27, 0xc2, 0xd8,
+  0x09, 0xf7, 0x72, 0x08, 0x79, 0xb8, 0xee, 0x26, 0x7f, 0x61, 0x94, 0xb7,
+  0x6f, 0x4a, 0x8e, 0x2f, 0x70, 0x04, 0xb3, 0x97, 0x92, 0xd3, 0x41, 0xe0,
+  0x34, 0x59, 0xab, 0x18, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x20, 0x00,
+  0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00,
+  0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20,
+};
+
+#define TEST_LOG_EVENT_COUNT        20
+#define TEST_LOG_SPLIT_EVENT_COUNT  10
+#define TEST_LOG_SPLIT_OFFSET       0x3c0
+
+STATIC CONST UINT8  mTestLogSha1Pcrs[IMPLEMENTATION_PCR][20] = {
+  {
+    0xe3, 0xc6, 0x53, 0x42, 0x68, 0xe3, 0xa9, 0xff, 0xae, 0x5b, 0x58, 0x51,
+    0xfc, 0x89, 0x34, 0x5a, 0x9b, 0x02, 0x08, 0x0c,
+  },
+  {
+    0x50, 0x07, 0xb5, 0xe4, 0x66, 0x22, 0xac, 0x65, 0x30, 0xd0, 0xd5, 0x2e,
+    0x23, 0x50, 0x52, 0x86, 0xb2, 0xcd, 0x92, 0x45,
+  },
+  {
+    0xb2, 0xa8, 0x3b, 0x0e, 0xbf, 0x2f, 0x83, 0x74, 0x29, 0x9a, 0x5b, 0x2b,
+    0xdf, 0xc3, 0x1e, 0xa9, 0x55, 0xad, 0x72, 0x36,
+  },
+  {
+    0xb2, 0xa8, 0x3b, 0x0e, 0xbf, 0x2f, 0x83, 0x74, 0x29, 0x9a, 0x5b, 0x2b,
+    0xdf, 0xc3, 0x1e, 0xa9, 0x55, 0xad, 0x72, 0x36,
+  },
+  {
+    0x4e, 0xcb, 0xc8, 0x52, 0xe7, 0x36, 0xc9, 0x3d, 0x80, 0x13, 0x81, 0x11,
+    0xa0, 0x92, 0x52, 0x65, 0x15, 0xf7, 0x24, 0xf1,
+  },
+  {
+    0xb2, 0xa8, 0x3b, 0x0e, 0xbf, 0x2f, 0x83, 0x74, 0x29, 0x9a, 0x5b, 0x2b,
+    0xdf, 0xc3, 0x1e, 0xa9, 0x55, 0xad, 0x72, 0x36,
+  },
+  {
+    0xb2, 0xa8, 0x3b, 0x0e, 0xbf, 0x2f, 0x83, 0x74, 0x29, 0x9a, 0x5b, 0x2b,
+    0xdf, 0xc3, 0x1e, 0xa9, 0x55, 0xad, 0x72, 0x36,
+  },
+  {
+    0xf7, 0xf0, 0xd9, 0x3d, 0x34, 0xb2, 0x0e, 0x26, 0xb0, 0x7a, 0x31, 0xb2,
+    0x3d, 0x06, 0xed, 0x25, 0x00, 0x8f, 0xbb, 0xaf,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x7e, 0x19, 0xcf, 0x3e, 0x58, 0x76, 0x04, 0x1e, 0xed, 0x4a, 0x3f, 0xcb,
+    0x3a, 0x96, 0x04, 0x19, 0x1e, 0x88, 0xd3, 0xe7,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x78, 0x5f, 0xc5, 0x5b, 0x65, 0xf4, 0xd4, 0xeb, 0x3e, 0x8c, 0x3a, 0xd2,
+    0x9d, 0x3b, 0xdd, 0xe2, 0x2d, 0x1a, 0x21, 0xbb,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+};
+
+STATIC CONST UINT8  mTestLogSha256Pcrs[IMPLEMENTATION_PCR][32] = {
+  {
+    0xc2, 0xcd, 0x56, 0x2d, 0x07, 0xad, 0x16, 0x55, 0xd8, 0x17, 0xfb, 0x34,
+    0x3c, 0xf4, 0x69, 0xd3, 0x5c, 0x35, 0x32, 0xd1, 0x8c, 0x0f, 0x90, 0xd1,
+    0xd2, 0x34, 0xff, 0x5e, 0xbc, 0x34, 0x9c, 0x9b,
+  },
+  {
+    0x4c, 0xef, 0xb2, 0xca, 0xf3, 0x29, 0x0e, 0x6d, 0x21, 0xcd, 0xf9, 0xa0,
+    0x49, 0x7b, 0x3e, 0x02, 0xd2, 0x0c, 0x16, 0x78, 0x19, 0x9f, 0x83, 0xce,
+    0x42, 0x58, 0x6d, 0x56, 0xdd, 0xfe, 0x65, 0xf0,
+  },
+  {
+    0x3d, 0x45, 0x8c, 0xfe, 0x55, 0xcc, 0x03, 0xea, 0x1f, 0x44, 0x3f, 0x15,
+    0x62, 0xbe, 0xec, 0x8d, 0xf5, 0x1c, 0x75, 0xe1, 0x4a, 0x9f, 0xcf, 0x9a,
+    0x72, 0x34, 0xa1, 0x3f, 0x19, 0x8e, 0x79, 0x69,
+  },
+  {
+    0x3d, 0x45, 0x8c, 0xfe, 0x55, 0xcc, 0x03, 0xea, 0x1f, 0x44, 0x3f, 0x15,
+    0x62, 0xbe, 0xec, 0x8d, 0xf5, 0x1c, 0x75, 0xe1, 0x4a, 0x9f, 0xcf, 0x9a,
+    0x72, 0x34, 0xa1, 0x3f, 0x19, 0x8e, 0x79, 0x69,
+  },
+  {
+    0xfe, 0xfb, 0x7e, 0x4d, 0xe5, 0x70, 0xe3, 0xee, 0x18, 0x5a, 0x82, 0x7e,
+    0xcb, 0x43, 0x20, 0x65, 0xd8, 0x80, 0x06, 0x70, 0xd4, 0xb9, 0xd2, 0xc1,
+    0x69, 0xc1, 0xc3, 0x98, 0x16, 0x59, 0x20, 0x38,
+  },
+  {
+    0x3d, 0x45, 0x8c, 0xfe, 0x55, 0xcc, 0x03, 0xea, 0x1f, 0x44, 0x3f, 0x15,
+    0x62, 0xbe, 0xec, 0x8d, 0xf5, 0x1c, 0x75, 0xe1, 0x4a, 0x9f, 0xcf, 0x9a,
+    0x72, 0x34, 0xa1, 0x3f, 0x19, 0x8e, 0x79, 0x69,
+  },
+  {
+    0x3d, 0x45, 0x8c, 0xfe, 0x55, 0xcc, 0x03, 0xea, 0x1f, 0x44, 0x3f, 0x15,
+    0x62, 0xbe, 0xec, 0x8d, 0xf5, 0x1c, 0x75, 0xe1, 0x4a, 0x9f, 0xcf, 0x9a,
+    0x72, 0x34, 0xa1, 0x3f, 0x19, 0x8e, 0x79, 0x69,
+  },
+  {
+    0xab, 0x5a, 0x11, 0x68, 0x38, 0xf3, 0x9e, 0x3e, 0x35, 0x8e, 0x7b, 0x32,
+    0x88, 0x85, 0x50, 0x15, 0x55, 0xfb, 0x2b, 0x82, 0x77, 0xba, 0xeb, 0xec,
+    0xcc, 0xcc, 0xaa, 0x97, 0x00, 0xfc, 0x09, 0x86,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x12, 0x01, 0x03, 0x21, 0x2c, 0xb2, 0x46, 0xe5, 0xaa, 0x58, 0x1a, 0x3e,
+    0x7b, 0xd8, 0xff, 0xa0, 0x0d, 0x37, 0x68, 0x56, 0x72, 0x8b, 0x78, 0x2e,
+    0xab, 0xfc, 0x48, 0x32, 0xb3, 0xe4, 0xc3, 0xff,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x4e, 0xbf, 0x38, 0xc6, 0x4f, 0x5a, 0xb3, 0x16, 0xb6, 0xcb, 0xd4, 0x5b,
+    0xd5, 0xf7, 0x77, 0x32, 0x6f, 0x66, 0x94, 0x56, 0x48, 0xe5, 0xfc, 0xdd,
+    0xf0, 0xd8, 0x9f, 0x89, 0x0f, 0xd3, 0x96, 0x36,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+};
+
+STATIC CONST UINT8  mTestLogQuoteDigest[] = {
+  0x94, 0x4f, 0x63, 0x0c, 0x66, 0xfd, 0x94, 0x9d, 0x6d, 0x98, 0x85, 0x4c,
+  0xd7, 0x7f, 0x12, 0x76, 0xe2, 0xdb, 0xf7, 0xeb, 0x07, 0xea, 0x68, 0x0e,
+  0x9e, 0xad, 0x2d, 0x03, 0xa2, 0x04, 0x4f, 0xb1,
+};
+
+STATIC CONST UINT8  mTestLogUnknownBank[] = {
+  0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00, 0x53, 0x70, 0x65, 0x63,
+  0x20, 0x49, 0x44, 0x20, 0x45, 0x76, 0x65, 0x6e, 0x74, 0x30, 0x33, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x03, 0x00, 0x00, 0x00,
+  0x0b, 0x00, 0x20, 0x00, 0x27, 0x00, 0x20, 0x00, 0x0c, 0x00, 0x30, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00,
+  0x00, 0x0b, 0x00, 0x31, 0xb6, 0xd3, 0x1f, 0x4b, 0x51, 0x37, 0x5f, 0x19,
+  0xcf, 0xe4, 0xbd, 0xe0, 0x15, 0x3d, 0xfe, 0xd4, 0x0a, 0xaa, 0xbb, 0x6e,
+  0xc0, 0x30, 0x8a, 0x85, 0x64, 0x08, 0x3f, 0x2c, 0x07, 0x33, 0x4a, 0x27,
+  0x00, 0x90, 0xf0, 0x37, 0xa2, 0xa2, 0x8e, 0x93, 0xf4, 0x38, 0xba, 0x2f,
+  0xfd, 0x0a, 0x96, 0x43, 0x19, 0x00, 0x29, 0x95, 0xc0, 0xf4, 0xfe, 0xd0,
+  0x92, 0x62, 0x72, 0xe2, 0xc9, 0x1b, 0x8b, 0xb9, 0x05, 0x0c, 0x00, 0x6f,
+  0xad, 0x0a, 0xb1, 0x9e, 0xca, 0xb5, 0x23, 0xcb, 0x45, 0x5f, 0xd4, 0x09,
+  0xb1, 0xa3, 0x1b, 0x44, 0xfa, 0x54, 0x51, 0x52, 0x48, 0xa8, 0xec, 0x7a,
+  0x44, 0x4a, 0xf0, 0x0b, 0xb7, 0x1a, 0x25, 0x2d, 0x8f, 0x37, 0x11, 0x7e,
+  0xb7, 0x33, 0xe6, 0x73, 0xcd, 0x95, 0x6c, 0x98, 0xb7, 0x46, 0x17, 0x08,
+  0x00, 0x00, 0x00, 0x32, 0x00, 0x2e, 0x00, 0x30, 0x00, 0x00, 0x00, 0x02,
+  0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x80, 0x03, 0x00, 0x00, 0x00, 0x0b,
+  0x00, 0xd1, 0x09, 0xe0, 0x24, 0xf0, 0xb0, 0x82, 0xac, 0xc1, 0x27, 0x2c,
+  0x5d, 0xb4, 0x1b, 0x87, 0x43, 0xd4, 0x4f, 0x02, 0x25, 0x70, 0x2e, 0xcb,
+  0x99, 0xc1, 0x26, 0x14, 0x55, 0xec, 0xc6, 0xd5, 0xc0, 0x27, 0x00, 0x3d,
+  0x5d, 0x2f, 0x65, 0xc3, 0x59, 0x1a, 0xa8, 0xae, 0x80, 0x54, 0x88, 0x8c,
+  0xbc, 0xaa, 0xaa, 0xa9, 0xef, 0x7e, 0xb1, 0xec, 0x8d, 0xa2, 0x41, 0x76,
+  0x05, 0x65, 0x1f, 0x4c, 0x94, 0x6c, 0xd1, 0x0c, 0x00, 0xbe, 0xb0, 0xb0,
+  0x2b, 0x01, 0x7d, 0x6d, 0xcc, 0x2e, 0x08, 0xab, 0xf0, 0x2c, 0x72, 0x23,
+  0x38, 0x87, 0x59, 0xfe, 0x8c, 0x3d, 0xa9, 0xd2, 0xa9, 0x8e, 0xe3, 0x3d,
+  0x4b, 0xa8, 0x0b, 0x4e, 0x81, 0x96, 0x11, 0x7f, 0xb1, 0x2a, 0x38, 0xc8,
+  0x68, 0xf4, 0x0d, 0xc9, 0x8a, 0xbf, 0x57, 0xf2, 0x92, 0x09, 0x00, 0x00,
+  0x00, 0x4f, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x52, 0x6f, 0x6d, 0x00, 0x00,
+  0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x0b, 0x00,
+  0xdf, 0x3f, 0x61, 0x98, 0x04, 0xa9, 0x2f, 0xdb, 0x40, 0x57, 0x19, 0x2d,
+  0xc4, 0x3d, 0xd7, 0x48, 0xea, 0x77, 0x8a, 0xdc, 0x52, 0xbc, 0x49, 0x8c,
+  0xe8, 0x05, 0x24, 0xc0, 0x14, 0xb8, 0x11, 0x19, 0x27, 0x00, 0x8b, 0x0a,
+  0x23, 0x85, 0xd8, 0x3c, 0x8b, 0xf7, 0xbe, 0x27, 0xe5, 0x99, 0x96, 0xf7,
+  0xd8, 0x81, 0xd3, 0xbf, 0x1f, 0xc6, 0x60, 0x6f, 0x81, 0xce, 0x60, 0x0b,
+  0x75, 0x3a, 0xd9, 0x41, 0x92, 0xa2, 0x0c, 0x00, 0x39, 0x43, 0x41, 0xb7,
+  0x18, 0x2c, 0xd2, 0x27, 0xc5, 0xc6, 0xb0, 0x7e, 0xf8, 0x00, 0x0c, 0xdf,
+  0xd8, 0x61, 0x36, 0xc4, 0x29, 0x2b, 0x8e, 0x57, 0x65, 0x73, 0xad, 0x7e,
+  0xd9, 0xae, 0x41, 0x01, 0x9f, 0x58, 0x18, 0xb4, 0xb9, 0x71, 0xc9, 0xef,
+  0xfc, 0x60, 0xe1, 0xad, 0x9f, 0x12, 0x89, 0xf0, 0x04, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+};
+
+#define TEST_LOG_UNKNOWN_BANK_EVENT_COUNT  3
+
+STATIC CONST UINT8  mTestLogUnknownBankSha256Pcrs[IMPLEMENTATION_PCR][32] = {
+  {
+    0xd0, 0xcf, 0x5f, 0xa9, 0xba, 0x97, 0x4c, 0xbb, 0x51, 0xdf, 0x1d, 0xf8,
+    0x2d, 0xa9, 0xd2, 0xc1, 0x57, 0x0b, 0x53, 0x8a, 0x72, 0x75, 0xc4, 0xe3,
+    0x6e, 0xe5, 0x47, 0x0e, 0x05, 0x51, 0x64, 0x5a,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0xbf, 0x64, 0x82, 0x0d, 0x23, 0x39, 0xb9, 0xe3, 0xb6, 0x07, 0x9c, 0x27,
+    0xe2, 0xb7, 0xce, 0x4d, 0x7f, 0xe7, 0x52, 0x32, 0x8e, 0xad, 0xb9, 0xab,
+    0x7b, 0x49, 0xd3, 0x54, 0x1b, 0x7f, 0xa0, 0xee,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+};
+
+STATIC CONST UINT8  mTestLogUnknownBankSha384Pcrs[IMPLEMENTATION_PCR][48] = {
+  {
+    0x61, 0x79, 0x9a, 0xb5, 0x6e, 0xf3, 0x53, 0x37, 0xe1, 0x00, 0x24, 0x88,
+    0x9f, 0xfb, 0xff, 0x2b, 0x70, 0x94, 0xb4, 0x4e, 0xc6, 0xc6, 0x6f, 0xc2,
+    0xdc, 0x19, 0x17, 0x08, 0x84, 0x79, 0x2f, 0x63, 0xb5, 0x13, 0x93, 0xef,
+    0x48, 0x3c, 0x3f, 0xef, 0xce, 0xfb, 0xef, 0x06, 0x5f, 0xdb, 0x68, 0x35,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x6c, 0x0c, 0xd9, 0x3f, 0x11, 0x45, 0x46, 0x61, 0x35, 0x79, 0x30, 0xcf,
+    0xcf, 0xce, 0xbb, 0xb2, 0x1e, 0x6b, 0x0e, 0x90, 0x47, 0xa2, 0x38, 0x27,
+    0xda, 0xdf, 0x7b, 0xfd, 0x7c, 0x5d, 0x22, 0x4d, 0x18, 0x69, 0x55, 0x01,
+    0x6e, 0xab, 0x32, 0xae, 0x32, 0x12, 0x13, 0x84, 0xf4, 0xef, 0x41, 0x0f,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  },
+  {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  },
+};
+
+#endif // TCG_EVENT_LOG_REPLAY_TEST_LOGS_H_
@@ -0,0 +1,473 @@
+/** @file -- BlockIoBenchmark.c
+ *
+ * Block io benchmark engine.  Issues reads with a given pattern, transfer size and
+ * queue depth, and reduces the per read latencies to min/median/p99/max and throughput.
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SortLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include "BlockIoBenchmark.h"
+
+typedef struct {
+  EFI_BLOCK_IO2_TOKEN    Token;
+  UINT8                  *Buffer;
+  UINT64                 SubmitTime;
+  BOOLEAN                Busy;
+} BENCHMARK_SLOT;
+
+//
+// Sequential position and random order carried between calls so that every cold pass
+// reads blocks that earlier passes against the same device have not touched.  The
+// random order is the shuffle of mRandomSlots slots selected by mRandomKey, and
+// mRandomNext is the position in it.
+//
+STATIC EFI_BLOCK_IO_PROTOCOL  *mStateDevice = NULL;
+STATIC EFI_LBA                mNextSequentialLba;
+STATIC UINT64                 mRandomState;
+STATIC UINT64                 mRandomKey;
+STATIC UINT64                 mRandomSlots;
+STATIC UINT64                 mRandomNext;
+
+STATIC BOOLEAN  mCounterCountsDown;
+STATIC BOOLEAN  mCounterInitialized = FALSE;
+
+/**
+  Convert a performance counter interval to nanoseconds.
+
+  @param[in]  Begin   Counter value at the start of the interval.
+  @param[in]  Finish  Counter value at the end of the interval.
+
+  @return Interval in nanoseconds.
+**/
+STATIC
+UINT64
+IntervalToNs (
+  IN UINT64  Begin,
+  IN UINT64  Finish
+  )
+{
+  UINT64  StartValue;
+  UINT64  EndValue;
+
+  if (!mCounterInitialized) {
+    GetPerformanceCounterProperties (&StartValue, &EndValue);
+    mCounterCountsDown  = (BOOLEAN)(StartValue > EndValue);
+    mCounterInitialized = TRUE;
+  }
+
+  return GetTimeInNanoSecond (mCounterCountsDown ? (Begin - Finish) : (Finish - Begin));
+}
+
+/**
+  xorshift64 pseudo random number generator.
+
+  @param[in,out]  State  Generator state.  Must not be 0.
+
+  @return Next pseudo random value.
+**/
+STATIC
+UINT64
+NextRandom (
+  IN OUT UINT64  *State
+  )
+{
+  UINT64  X;
+
+  X      = *State;
+  X     ^= LShiftU64 (X, 13);
+  X     ^= RShiftU64 (X, 7);
+  X     ^= LShiftU64 (X, 17);
+  *State = X;
+  return X;
+}
+
+/**
+  Map a position in a shuffled order of Count slots to the slot at that position.
+
+  The slot is a keyed mix of Position that is one to one over the smallest power of
+  two range holding Count.  Results outside of Count are mixed again until they fall
+  inside it, which keeps the mapping one to one over [0, Count).  So every slot is
+  returned once as Position goes from 0 to Count - 1, without a table of the media.
+
+  @param[in]  Position  Position in the order.  Must be below Count.
+  @param[in]  Count     Number of slots.
+  @param[in]  Key       Selects the order.
+
+  @return Slot at Position.
+**/
+STATIC
+UINT64
+ShuffleSlot (
+  IN UINT64  Position,
+  IN UINT64  Count,
+  IN UINT64  Key
+  )
+{
+  UINT64  Mask;
+  UINTN   Bits;
+  UINTN   Shift;
+  UINT64  Value;
+
+  Bits  = (Count > 1) ? (UINTN)HighBitSet64 (Count - 1) + 1 : 1;
+  Mask  = (Bits == 64) ? MAX_UINT64 : LShiftU64 (1, Bits) - 1;
+  Shift = (Bits + 1) / 2;
+  Value = Position;
+
+  //
+  // Multiplying by an odd constant, adding, and xor with a right shift are each one
+  // to one modulo a power of two.
+  //
+  do {
+    Value  = (MultU64x64 (Value, 0xBF58476D1CE4E5B9ull) + Key) & Mask;
+    Value ^= RShiftU64 (Value, Shift);
+    Value  = MultU64x64 (Value, 0x94D049BB133111EBull) & Mask;
+    Value ^= RShiftU64 (Value, Shift);
+  } while (Value >= Count);
+
+  return Value;
+}
+
+/**
+  SortLib compare function for UINT64 latencies.
+**/
+STATIC
+INTN
+EFIAPI
+CompareLatency (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  UINT64  A;
+  UINT64  B;
+
+  A = *(CONST UINT64 *)Buffer1;
+  B = *(CONST UINT64 *)Buffer2;
+  if (A < B) {
+    return -1;
+  }
+
+  return (A > B) ? 1 : 0;
+}
+
+/**
+  Read every LBA in the list once, recording the latency of each successful read.
+
+  @param[in]      BlkIo         Block io protocol.
+  @param[in]      BlkIo2        Block io 2 protocol, or NULL when QueueDepth is 1.
+  @param[in]      Lbas          LBAs to read.
+  @param[in]      LbaCount      Number of entries in Lbas.
+  @param[in]      TransferSize  Bytes per read.
+  @param[in]      Slots         One buffer and token per outstanding read.
+  @param[in]      QueueDepth    Number of entries in Slots to use.
+  @param[in,out]  Result        IoCount, Errors and ElapsedNs are updated.
+  @param[out]     Latencies     Latency of each successful read is appended at Result->IoCount.
+**/
+STATIC
+VOID
+ReadPass (
+  IN     EFI_BLOCK_IO_PROTOCOL      *BlkIo,
+  IN     EFI_BLOCK_IO2_PROTOCOL     *BlkIo2 OPTIONAL,
+  IN     CONST EFI_LBA              *Lbas,
+  IN     UINTN                      LbaCount,
+  IN     UINTN                      TransferSize,
+  IN     BENCHMARK_SLOT             *Slots,
+  IN     UINTN                      QueueDepth,
+  IN OUT BLOCK_IO_BENCHMARK_RESULT  *Result,
+  OUT    UINT64                     *Latencies
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      MediaId;
+  UINT64      PassStart;
+  UINT64      Begin;
+  UINT64      Finish;
+  UINTN       Next;
+  UINTN       Outstanding;
+  UINTN       Index;
+
+  MediaId   = BlkIo->Media->MediaId;
+  PassStart = GetPerformanceCounter ();
+
+  if ((QueueDepth <= 1) || (BlkIo2 == NULL)) {
+    for (Next = 0; Next < LbaCount; Next++) {
+      Begin  = GetPerformanceCounter ();
+      Status = BlkIo->ReadBlocks (BlkIo, MediaId, Lbas[Next], TransferSize, Slots[0].Buffer);
+      Finish = GetPerformanceCounter ();
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "%a - ReadBlocks of LBA 0x%lx failed. %r\n", __FUNCTION__, Lbas[Next], Status));
+        Result->Errors++;
+      } else {
+        Latencies[Result->IoCount++] = IntervalToNs (Begin, Finish);
+      }
+    }
+  } else {
+    Next        = 0;
+    Outstanding = 0;
+    while ((Next < LbaCount) || (Outstanding > 0)) {
+      for (Index = 0; Index < QueueDepth; Index++) {
+        if (Slots[Index].Busy) {
+          if (gBS->CheckEvent (Slots[Index].Token.Event) != EFI_SUCCESS) {
+            continue;
+          }
+
+          Finish             = GetPerformanceCounter ();
+          Slots[Index].Busy  = FALSE;
+          Outstanding       -= 1;
+          if (EFI_ERROR (Slots[Index].Token.TransactionStatus)) {
+            DEBUG ((DEBUG_ERROR, "%a - ReadBlocksEx completed with %r\n", __FUNCTION__, Slots[Index].Token.TransactionStatus));
+            Result->Errors++;
+          } else {
+            Latencies[Result->IoCount++] = IntervalToNs (Slots[Index].SubmitTime, Finish);
+          }
+        }
+
+        if (Next < LbaCount) {
+          Slots[Index].Token.TransactionStatus = EFI_NOT_READY;
+          Slots[Index].SubmitTime              = GetPerformanceCounter ();
+          Status                               = BlkIo2->ReadBlocksEx (
+                                                           BlkIo2,
+                                                           MediaId,
+                                                           Lbas[Next],
+                                                           &Slots[Index].Token,
+                                                           TransferSize,
+                                                           Slots[Index].Buffer
+                                                           );
+          if (EFI_ERROR (Status)) {
+            DEBUG ((DEBUG_ERROR, "%a - ReadBlocksEx of LBA 0x%lx failed. %r\n", __FUNCTION__, Lbas[Next], Status));
+            Result->Errors++;
+          } else {
+            Slots[Index].Busy = TRUE;
+            Outstanding      += 1;
+          }
+
+          Next++;
+        }
+      }
+    }
+  }
+
+  Result->ElapsedNs += IntervalToNs (PassStart, GetPerformanceCounter ());
+}
+
+/**
+  Reduce the recorded latencies to the summary statistics in Result.
+
+  @param[in,out]  Result     IoCount and ElapsedNs must be set.
+  @param[in]      Latencies  Result->IoCount latencies.  Sorted on return.
+**/
+STATIC
+VOID
+SummarizeResult (
+  IN OUT BLOCK_IO_BENCHMARK_RESULT  *Result,
+  IN OUT UINT64                     *Latencies
+  )
+{
+  UINT64  TotalKiB;
+
+  if (Result->IoCount == 0) {
+    return;
+  }
+
+  PerformQuickSort (Latencies, Result->IoCount, sizeof (UINT64), CompareLatency);
+
+  Result->MinNs    = Latencies[0];
+  Result->MedianNs = Latencies[(Result->IoCount - 1) / 2];
+  Result->P99Ns    = Latencies[((Result->IoCount * 99) + 99) / 100 - 1];
+  Result->MaxNs    = Latencies[Result->IoCount - 1];
+
+  if (Result->ElapsedNs != 0) {
+    TotalKiB             = MultU64x64 (Result->IoCount, Result->TransferSize) / SIZE_1KB;
+    Result->KiBPerSecond = DivU64x64Remainder (MultU64x32 (TotalKiB, 1000000000), Result->ElapsedNs, NULL);
+  }
+}
+
+/**
+  Measure reads of one transfer size and pattern.
+
+  Each run reads Config->IoCount blocks of TransferSize bytes from LBAs that were not
+  read by an earlier run (cold), then immediately reads the same LBAs again (warm).
+  Sequential runs walk the whole media, wrapping at the end.  Random runs visit the
+  TransferSize aligned LBAs of the media in a shuffled order, starting a new order
+  once every LBA has been read.  The queue depth is limited so that the read buffers
+  fit in BLOCK_IO_BENCHMARK_MAX_QUEUED_BYTES.
+
+  @param[in]  BlkIo         Block io protocol of the device.
+  @param[in]  BlkIo2        Block io 2 protocol of the device.  Optional.  Required for
+                            a queue depth above 1.
+  @param[in]  Config        Benchmark parameters.
+  @param[in]  Pattern       Access pattern.
+  @param[in]  TransferSize  Bytes per read.  Must be a multiple of the block size.
+  @param[out] Cold          Results of the cold passes.
+  @param[out] Warm          Results of the warm passes.
+
+  @retval EFI_SUCCESS            Results are valid.
+  @retval EFI_INVALID_PARAMETER  A parameter is invalid, or TransferSize does not fit the media.
+  @retval EFI_NO_MEDIA           No media is present.
+  @retval EFI_OUT_OF_RESOURCES   Unable to allocate buffers.
+**/
+EFI_STATUS
+RunBlockIoBenchmark (
+  IN  EFI_BLOCK_IO_PROTOCOL            *BlkIo,
+  IN  EFI_BLOCK_IO2_PROTOCOL           *BlkIo2 OPTIONAL,
+  IN  CONST BLOCK_IO_BENCHMARK_CONFIG  *Config,
+  IN  BLOCK_IO_PATTERN                 Pattern,
+  IN  UINTN                            TransferSize,
+  OUT BLOCK_IO_BENCHMARK_RESULT        *Cold,
+  OUT BLOCK_IO_BENCHMARK_RESULT        *Warm
+  )
+{
+  EFI_STATUS          Status;
+  EFI_BLOCK_IO_MEDIA  *Media;
+  BENCHMARK_SLOT      Slots[BLOCK_IO_BENCHMARK_MAX_QUEUE_DEPTH];
+  UINTN               QueueDepth;
+  UINTN               Pages;
+  EFI_LBA             *Lbas;
+  UINT64              *ColdLatencies;
+  UINT64              *WarmLatencies;
+  UINT64              BlocksPerIo;
+  UINT64              IoSlotsOnMedia;
+  UINTN               Run;
+  UINTN               Index;
+
+  if ((BlkIo == NULL) || (Config == NULL) || (Cold == NULL) || (Warm == NULL) ||
+      (Pattern >= BlockIoPatternMax) || (TransferSize == 0) ||
+      (Config->IoCount == 0) || (Config->Runs == 0))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Media = BlkIo->Media;
+  if (!Media->MediaPresent) {
+    return EFI_NO_MEDIA;
+  }
+
+  if ((Media->BlockSize == 0) || ((TransferSize % Media->BlockSize) != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  BlocksPerIo    = TransferSize / Media->BlockSize;
+  IoSlotsOnMedia = DivU64x64Remainder (Media->LastBlock + 1, BlocksPerIo, NULL);
+  if (IoSlotsOnMedia == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  QueueDepth = MIN (Config->QueueDepth, BLOCK_IO_BENCHMARK_MAX_QUEUE_DEPTH);
+  QueueDepth = MAX (1, MIN (QueueDepth, BLOCK_IO_BENCHMARK_MAX_QUEUED_BYTES / TransferSize));
+  if (BlkIo2 == NULL) {
+    QueueDepth = 1;
+  }
+
+  if (mStateDevice != BlkIo) {
+    mStateDevice       = BlkIo;
+    mNextSequentialLba = 0;
+    mRandomState       = (Config->Seed != 0) ? Config->Seed : 0x9E3779B97F4A7C15ull;
+    mRandomSlots       = 0;
+  }
+
+  //
+  // The slots change with the transfer size, so a new size starts a new order
+  //
+  if (mRandomSlots != IoSlotsOnMedia) {
+    mRandomSlots = IoSlotsOnMedia;
+    mRandomKey   = NextRandom (&mRandomState);
+    mRandomNext  = 0;
+  }
+
+  ZeroMem (Cold, sizeof (*Cold));
+  Cold->Pattern      = Pattern;
+  Cold->TransferSize = TransferSize;
+  Cold->QueueDepth   = QueueDepth;
+  CopyMem (Warm, Cold, sizeof (*Warm));
+  Warm->Warm = TRUE;
+
+  ZeroMem (Slots, sizeof (Slots));
+  Pages         = EFI_SIZE_TO_PAGES (TransferSize);
+  Lbas          = AllocatePool (Config->IoCount * sizeof (EFI_LBA));
+  ColdLatencies = AllocatePool (Config->IoCount * Config->Runs * sizeof (UINT64));
+  WarmLatencies = AllocatePool (Config->IoCount * Config->Runs * sizeof (UINT64));
+  if ((Lbas == NULL) || (ColdLatencies == NULL) || (WarmLatencies == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Cleanup;
+  }
+
+  for (Index = 0; Index < QueueDepth; Index++) {
+    Slots[Index].Buffer = AllocateAlignedPages (Pages, MAX (Media->IoAlign, EFI_PAGE_SIZE));
+    if (Slots[Index].Buffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Cleanup;
+    }
+
+    if (QueueDepth > 1) {
+      Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Slots[Index].Token.Event);
+      if (EFI_ERROR (Status)) {
+        Slots[Index].Token.Event = NULL;
+        goto Cleanup;
+      }
+    }
+  }
+
+  for (Run = 0; Run < Config->Runs; Run++) {
+    for (Index = 0; Index < Config->IoCount; Index++) {
+      if (Pattern == BlockIoPatternSequential) {
+        if (mNextSequentialLba + BlocksPerIo > Media->LastBlock + 1) {
+          mNextSequentialLba = 0;
+        }
+
+        Lbas[Index]         = mNextSequentialLba;
+        mNextSequentialLba += BlocksPerIo;
+      } else {
+        if (mRandomNext == mRandomSlots) {
+          mRandomKey  = NextRandom (&mRandomState);
+          mRandomNext = 0;
+        }
+
+        Lbas[Index] = MultU64x64 (ShuffleSlot (mRandomNext++, mRandomSlots, mRandomKey), BlocksPerIo);
+      }
+    }
+
+    ReadPass (BlkIo, BlkIo2, Lbas, Config->IoCount, TransferSize, Slots, QueueDepth, Cold, ColdLatencies);
+    ReadPass (BlkIo, BlkIo2, Lbas, Config->IoCount, TransferSize, Slots, QueueDepth, Warm, WarmLatencies);
+  }
+
+  SummarizeResult (Cold, ColdLatencies);
+  SummarizeResult (Warm, WarmLatencies);
+  Status = EFI_SUCCESS;
+
+Cleanup:
+  for (Index = 0; Index < QueueDepth; Index++) {
+    if (Slots[Index].Token.Event != NULL) {
+      gBS->CloseEvent (Slots[Index].Token.Event);
+    }
+
+    if (Slots[Index].Buffer != NULL) {
+      FreeAlignedPages (Slots[Index].Buffer, Pages);
+    }
+  }
+
+  if (Lbas != NULL) {
+    FreePool (Lbas);
+  }
+
+  if (ColdLatencies != NULL) {
+    FreePool (ColdLatencies);
+  }
+
+  if (WarmLatencies != NULL) {
+    FreePool (WarmLatencies);
+  }
+
+  return Status;
+}
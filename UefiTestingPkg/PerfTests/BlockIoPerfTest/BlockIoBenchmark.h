@@ -0,0 +1,93 @@
+/** @file -- BlockIoBenchmark.h
+ *
+ * Block io benchmark engine used by BlockIoPerfTest.
+
+Copyright (C) Microsoft Corporation. All rights reserved.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef BLOCK_IO_BENCHMARK_H_
+#define BLOCK_IO_BENCHMARK_H_
+
+#include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
+
+#define BLOCK_IO_BENCHMARK_MAX_QUEUE_DEPTH  32
+
+//
+// Each outstanding read has its own TransferSize buffer.  The queue depth is lowered for
+// large transfers so that the buffers stay within this many bytes.
+//
+#define BLOCK_IO_BENCHMARK_MAX_QUEUED_BYTES  SIZE_64MB
+
+typedef enum {
+  BlockIoPatternSequential,
+  BlockIoPatternRandom,
+  BlockIoPatternMax
+} BLOCK_IO_PATTERN;
+
+//
+// Parameters shared by every run against a device
+//
+typedef struct {
+  UINTN     QueueDepth;         // Outstanding reads.  Values above 1 require EFI_BLOCK_IO2_PROTOCOL
+  UINTN     IoCount;            // Reads per run
+  UINTN     Runs;               // Runs per pattern and transfer size
+  UINT64    Seed;               // Seed for the random pattern
+} BLOCK_IO_BENCHMARK_CONFIG;
+
+//
+// Result of all runs for one pattern, transfer size and cache state
+//
+typedef struct {
+  BLOCK_IO_PATTERN    Pattern;
+  BOOLEAN             Warm;          // TRUE if the blocks were read by the previous pass
+  UINTN               TransferSize;  // Bytes per read
+  UINTN               QueueDepth;    // Queue depth actually used
+  UINTN               IoCount;       // Reads completed successfully
+  UINTN               Errors;        // Reads that failed
+  UINT64              MinNs;
+  UINT64              MedianNs;
+  UINT64              P99Ns;
+  UINT64              MaxNs;
+  UINT64              ElapsedNs;     // Wall time of all runs
+  UINT64              KiBPerSecond;  // Throughput over ElapsedNs
+} BLOCK_IO_BENCHMARK_RESULT;
+
+/**
+  Measure reads of one transfer size and pattern.
+
+  Each run reads Config->IoCount blocks of TransferSize bytes from LBAs that were not
+  read by an earlier run (cold), then immediately reads the same LBAs again (warm).
+  Sequential runs walk the whole media, wrapping at the end.  Random runs visit the
+  TransferSize aligned LBAs of the media in a shuffled order, starting a new order
+  once every LBA has been read.  The queue depth is limited so that the read buffers
+  fit in BLOCK_IO_BENCHMARK_MAX_QUEUED_BYTES.
+
+  @param[in]  BlkIo         Block io protocol of the device.
+  @param[in]  BlkIo2        Block io 2 protocol of the device.  Optional.  Required for
+                            a queue depth above 1.
+  @param[in]  Config        Benchmark parameters.
+  @param[in]  Pattern       Access pattern.
+  @param[in]  TransferSize  Bytes per read.  Must be a multiple of the block size.
+  @param[out] Cold          Results of the cold passes.
+  @param[out] Warm          Results of the warm passes.
+
+  @retval EFI_SUCCESS            Results are valid.
+  @retval EFI_INVALID_PARAMETER  A parameter is invalid, or TransferSize does not fit the media.
+  @retval EFI_NO_MEDIA           No media is present.
+  @retval EFI_OUT_OF_RESOURCES   Unable to allocate buffers.
+**/
+EFI_STATUS
+RunBlockIoBenchmark (
+  IN  EFI_BLOCK_IO_PROTOCOL            *BlkIo,
+  IN  EFI_BLOCK_IO2_PROTOCOL           *BlkIo2 OPTIONAL,
+  IN  CONST BLOCK_IO_BENCHMARK_CONFIG  *Config,
+  IN  BLOCK_IO_PATTERN                 Pattern,
+  IN  UINTN                            TransferSize,
+  OUT BLOCK_IO_BENCHMARK_RESULT        *Cold,
+  OUT BLOCK_IO_BENCHMARK_RESULT        *Warm
+  );
+
+#endif // BLOCK_IO_BENCHMARK_H_
@@ -9,6 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <Uefi.h>
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/DevicePath.h>
 
 #include <Library/BaseLib.h>
@@ -18,10 +19,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiApplicationEntryPoint.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/BaseMemoryLib.h>
-#include <Library/UefiBootServicesTableLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/TimerLib.h>
 #include <Library/DevicePathLib.h>
+#include <Library/PrintLib.h>
+
+#include "BlockIoBenchmark.h"
 
 #define MAX_SIZE_FOR_TEST  (0x100000 * 20)
 
@@ -29,75 +32,121 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define ONE_MILLISECOND  (1000 * ONE_MICROSECOND)
 #define ONE_SECOND       (1000 * ONE_MILLISECOND)
 
-#define GET_SECONDS(a)       (DivU64x32 ((a), ONE_SECOND))
-#define GET_MILLISECONDS(a)  (DivU64x32 ((a), ONE_MILLISECOND))
-#define GET_MICROSECONDS(a)  (DivU64x32 ((a), ONE_MICROSECOND))
+#define DEFAULT_QUEUE_DEPTH  1
+#define DEFAULT_IO_COUNT     64
+#define DEFAULT_RUNS         3
+#define DEFAULT_SEED         0x5EED5EED5EED5EEDull
+
+#define CSV_LINE_SIZE  512
+
+#define CSV_HEADER  "Device,Pattern,Cache,TransferBytes,QueueDepth,Ios,Errors,MinNs,MedianNs,P99Ns,MaxNs,KiBps\n"
+
+//
+// Parameters
+//
+STATIC CONST SHELL_PARAM_ITEM  ParamList[] = {
+  { L"-h", TypeFlag  },    // -h Help
+  { L"-q", TypeValue },    // -q queue depth
+  { L"-n", TypeValue },    // -n reads per run
+  { L"-r", TypeValue },    // -r runs
+  { L"-o", TypeValue },    // -o csv output file
+  { NULL,  TypeMax   }
+};
+
+STATIC CONST CHAR8  *mPatternNames[BlockIoPatternMax] = { "Sequential", "Random" };
 
+/**
+  Print one result as a table row and, if a csv file is open, append it as a csv row.
+
+  @param[in]  Result            Result to report.
+  @param[in]  DevicePathString  Device the result was measured on.  Optional.
+  @param[in]  CsvFile           Open csv file, or NULL.
+**/
 VOID
-PrintTimeFromNs (
-  UINT64  TimeInNs
+ReportResult (
+  IN CONST BLOCK_IO_BENCHMARK_RESULT  *Result,
+  IN CONST CHAR16                     *DevicePathString OPTIONAL,
+  IN SHELL_FILE_HANDLE                CsvFile OPTIONAL
   )
 {
-  UINT64  Sec           = 0;
-  UINT64  Milli         = 0;
-  UINT64  Micro         = 0;
-  UINT64  Nano          = 0;
-  UINT64  RemainingTime = TimeInNs;
+  CHAR8       Line[CSV_LINE_SIZE];
+  UINTN       LineSize;
+  EFI_STATUS  Status;
 
-  if (RemainingTime > ONE_SECOND) {
-    Sec            = GET_SECONDS (RemainingTime);
-    RemainingTime -= MultU64x32 (Sec, ONE_SECOND);
-  }
-
-  if (RemainingTime > ONE_MILLISECOND) {
-    Milli          = GET_MILLISECONDS (RemainingTime);
-    RemainingTime -= MultU64x32 (Milli, ONE_MILLISECOND);
-  }
+  Print (
+    L"  %-10a %-4a %8dKB QD%-2d %5d ios %3d err  min %8ldus  med %8ldus  p99 %8ldus  max %8ldus  %8ld KiB/s\n",
+    mPatternNames[Result->Pattern],
+    Result->Warm ? "Warm" : "Cold",
+    Result->TransferSize / SIZE_1KB,
+    Result->QueueDepth,
+    Result->IoCount,
+    Result->Errors,
+    DivU64x32 (Result->MinNs, ONE_MICROSECOND),
+    DivU64x32 (Result->MedianNs, ONE_MICROSECOND),
+    DivU64x32 (Result->P99Ns, ONE_MICROSECOND),
+    DivU64x32 (Result->MaxNs, ONE_MICROSECOND),
+    Result->KiBPerSecond
+    );
 
-  if (RemainingTime > ONE_MICROSECOND) {
-    Micro          = GET_MICROSECONDS (RemainingTime);
-    RemainingTime -= MultU64x32 (Micro, ONE_MICROSECOND);
+  if (CsvFile == NULL) {
+    return;
   }
 
-  if (RemainingTime > 0) {
-    Nano = RemainingTime;
-  }
+  LineSize = AsciiSPrint (
+               Line,
+               sizeof (Line),
+               "\"%s\",%a,%a,%d,%d,%d,%d,%ld,%ld,%ld,%ld,%ld\n",
+               (DevicePathString != NULL) ? DevicePathString : L"Unknown",
+               mPatternNames[Result->Pattern],
+               Result->Warm ? "Warm" : "Cold",
+               Result->TransferSize,
+               Result->QueueDepth,
+               Result->IoCount,
+               Result->Errors,
+               Result->MinNs,
+               Result->MedianNs,
+               Result->P99Ns,
+               Result->MaxNs,
+               Result->KiBPerSecond
+               );
 
-  if (Sec > 0) {
-    Print (L"%d.%d%d%d seconds\n", Sec, Milli, Micro, Nano);
-  } else if (Milli > 0) {
-    Print (L"%d.%d%d milliseconds\n", Milli, Micro, Nano);
-  } else if (Micro > 0) {
-    Print (L"%d.%d microseconds\n", Micro, Nano);
-  } else {
-    Print (L"%d nanoseconds\n", Nano);
+  Status = ShellWriteFile (CsvFile, &LineSize, Line);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a - Failed to write csv row. %r\n", __FUNCTION__, Status));
   }
 }
 
+/**
+  Run every transfer size and pattern against one device.
+
+  @param[in]  BlkIo             Block io protocol of the device.
+  @param[in]  BlkIo2            Block io 2 protocol of the device, or NULL.
+  @param[in]  Config            Benchmark parameters.
+  @param[in]  DevicePathString  Device being tested.  Optional.
+  @param[in]  CsvFile           Open csv file, or NULL.
+**/
 VOID
 TestBlockIo (
-  EFI_BLOCK_IO_PROTOCOL  *BlkIo
+  IN EFI_BLOCK_IO_PROTOCOL            *BlkIo,
+  IN EFI_BLOCK_IO2_PROTOCOL           *BlkIo2 OPTIONAL,
+  IN CONST BLOCK_IO_BENCHMARK_CONFIG  *Config,
+  IN CONST CHAR16                     *DevicePathString OPTIONAL,
+  IN SHELL_FILE_HANDLE                CsvFile OPTIONAL
   )
 {
-  EFI_STATUS  Status = EFI_SUCCESS;
-  UINT32      MediaId;
-  EFI_LBA     Lba;
-  UINT8       *Buffer     = NULL;
-  UINTN       ReadSizes[] = { 0x1000, 0x2000, 0x4000, 0x8000, 0x10000, 0x100000, MAX_SIZE_FOR_TEST };
-  UINTN       Index;
+  EFI_STATUS                 Status;
+  UINTN                      ReadSizes[] = { 0x1000, 0x2000, 0x4000, 0x8000, 0x10000, 0x100000, MAX_SIZE_FOR_TEST };
+  UINTN                      Index;
+  UINTN                      TransferSize;
+  BLOCK_IO_PATTERN           Pattern;
+  BLOCK_IO_BENCHMARK_RESULT  Cold;
+  BLOCK_IO_BENCHMARK_RESULT  Warm;
 
   if (BlkIo == NULL) {
     Print (L"BlockIo is NULL\n");
     return;
   }
 
-  Buffer = AllocatePages (EFI_SIZE_TO_PAGES (MAX_SIZE_FOR_TEST));
-  if (Buffer == NULL) {
-    Print (L"Failed to allocate memory");
-    return;
-  }
-
-  MediaId = BlkIo->Media->MediaId;
   Print (
     L" Revision: 0x%lX\n WriteCaching: 0x%X\n BlockSize: 0x%X\n",
     BlkIo->Revision,
@@ -105,24 +154,114 @@ TestBlockIo (
     BlkIo->Media->BlockSize
     );
   Print (L" IoAlign: 0x%X\n", BlkIo->Media->IoAlign);
+  Print (L" LastBlock: 0x%lX\n", BlkIo->Media->LastBlock);
+  Print (L" BlockIo2: %a\n", (BlkIo2 != NULL) ? "Yes" : "No");
+
+  if (!BlkIo->Media->MediaPresent || (BlkIo->Media->BlockSize == 0)) {
+    Print (L"No media present.  Skipping\n");
+    return;
+  }
+
+  if ((Config->QueueDepth > 1) && (BlkIo2 == NULL)) {
+    Print (L"No BlockIo2 on this device.  Running at queue depth 1\n");
+  }
 
   for (Index = 0; Index < ARRAY_SIZE (ReadSizes); Index++) {
-    UINT64  Start = 0;
-    UINT64  End   = 0;
-    Lba = 0;
-    Print (L"Test %dKB\n", ReadSizes[Index]/1024);
-    Start  = GetPerformanceCounter ();
-    Status = BlkIo->ReadBlocks (BlkIo, MediaId, Lba, ReadSizes[Index], (VOID *)Buffer);
-    End    = GetPerformanceCounter ();
+    TransferSize = ALIGN_VALUE (ReadSizes[Index], BlkIo->Media->BlockSize);
+    if (DivU64x32 (TransferSize, BlkIo->Media->BlockSize) > BlkIo->Media->LastBlock + 1) {
+      Print (L"  %dKB is larger than the media.  Skipping\n", TransferSize / SIZE_1KB);
+      continue;
+    }
+
+    for (Pattern = BlockIoPatternSequential; Pattern < BlockIoPatternMax; Pattern++) {
+      Status = RunBlockIoBenchmark (BlkIo, BlkIo2, Config, Pattern, TransferSize, &Cold, &Warm);
+      if (EFI_ERROR (Status)) {
+        Print (L"  %a %dKB failed.  Status = %r\n", mPatternNames[Pattern], TransferSize / SIZE_1KB, Status);
+        continue;
+      }
+
+      ReportResult (&Cold, DevicePathString, CsvFile);
+      ReportResult (&Warm, DevicePathString, CsvFile);
+    }
+  }
+}
+
+/**
+  Open the csv output file, replacing any existing file, and write the header row.
+
+  @param[in]  FileName  Name of the csv file.
+  @param[out] CsvFile   Returns the open file.
+
+  @retval EFI_SUCCESS  The file is open and the header has been written.
+  @retval Others       Errors passed from ShellOpenFileByName or ShellWriteFile
+**/
+EFI_STATUS
+OpenCsvFile (
+  IN  CONST CHAR16       *FileName,
+  OUT SHELL_FILE_HANDLE  *CsvFile
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       HeaderSize;
+
+  //
+  // First lets open the file if it exists so we can delete it...This is the work around for truncation
+  //
+  Status = ShellOpenFileByName (FileName, CsvFile, EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
+  if (!EFI_ERROR (Status)) {
+    Status = ShellDeleteFile (CsvFile);
     if (EFI_ERROR (Status)) {
-      Print (L"Error reading blocks.  Status = %r\n", Status);
+      DEBUG ((DEBUG_ERROR, "%a failed to delete file %r\n", __FUNCTION__, Status));
     }
+  }
+
+  Status = ShellOpenFileByName (FileName, CsvFile, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
-    PrintTimeFromNs (GetTimeInNanoSecond (End-Start));
-    Print (L"\n\n");
+  HeaderSize = AsciiStrLen (CSV_HEADER);
+  Status     = ShellWriteFile (*CsvFile, &HeaderSize, CSV_HEADER);
+  if (EFI_ERROR (Status)) {
+    ShellCloseFile (CsvFile);
   }
 
-  FreePages (Buffer, EFI_SIZE_TO_PAGES (MAX_SIZE_FOR_TEST));
+  return Status;
+}
+
+/**
+  Read an optional numeric parameter.
+
+  @param[in]  ParamPackage  Parsed command line.
+  @param[in]  Name          Parameter name.
+  @param[in]  Default       Value used if the parameter is absent.
+  @param[out] Value         Returns the value.
+
+  @retval TRUE   Value is valid.
+  @retval FALSE  The parameter is present but is not a positive number.
+**/
+BOOLEAN
+GetNumericParam (
+  IN  LIST_ENTRY    *ParamPackage,
+  IN  CONST CHAR16  *Name,
+  IN  UINTN         Default,
+  OUT UINTN         *Value
+  )
+{
+  CONST CHAR16  *String;
+
+  String = ShellCommandLineGetValue (ParamPackage, Name);
+  if (String == NULL) {
+    *Value = Default;
+    return TRUE;
+  }
+
+  if (!ShellIsDecimalDigitCharacter (*String)) {
+    return FALSE;
+  }
+
+  *Value = ShellStrToUintn (String);
+  return (BOOLEAN)(*Value != 0);
 }
 
 /**
@@ -132,6 +271,7 @@ TestBlockIo (
   @param[in]  SystemTable     The system table.
 
   @retval EFI_SUCCESS            Command completed successfully.
+  @retval EFI_INVALID_PARAMETER  The command line is not valid.
 
 **/
 EFI_STATUS
@@ -141,13 +281,21 @@ TestMain (
   IN EFI_SYSTEM_TABLE  *SystemTable
   )
 {
-  EFI_STATUS                Status;
-  UINTN                     BlockIoHandleCount;
-  EFI_HANDLE                *BlockIoBuffer = NULL;
-  UINTN                     Index;
-  EFI_DEVICE_PATH_PROTOCOL  *BlockIoDevicePath = NULL;
-  CHAR16                    *DevicePathString  = NULL;
-  EFI_BLOCK_IO_PROTOCOL     *BlockIoProtocol   = NULL;
+  EFI_STATUS                 Status;
+  UINTN                      BlockIoHandleCount;
+  EFI_HANDLE                 *BlockIoBuffer = NULL;
+  UINTN                      Index;
+  EFI_DEVICE_PATH_PROTOCOL   *BlockIoDevicePath = NULL;
+  CHAR16                     *DevicePathString  = NULL;
+  EFI_BLOCK_IO_PROTOCOL      *BlockIoProtocol   = NULL;
+  EFI_BLOCK_IO2_PROTOCOL     *BlockIo2Protocol;
+  LIST_ENTRY                 *ParamPackage;
+  CHAR16                     *ProblemParm = NULL;
+  CONST CHAR16               *OutputFileName;
+  SHELL_FILE_HANDLE          CsvFile = NULL;
+  BLOCK_IO_BENCHMARK_CONFIG  Config;
+  BOOLEAN                    FlagH;
+  BOOLEAN                    InvalidParam;
 
   //
   // Initialize the shell lib (we must be in non-auto-init...)
@@ -159,6 +307,53 @@ TestMain (
     return Status;
   }
 
+  Status = ShellCommandLineParseEx (ParamList, &ParamPackage, &ProblemParm, FALSE, TRUE);
+  if (EFI_ERROR (Status)) {
+    if (ProblemParm != NULL) {
+      Print (L"Invalid parameter %s\n", ProblemParm);
+      FreePool (ProblemParm);
+    } else {
+      Print (L"Unable to parse command line. Code=%r\n", Status);
+    }
+
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (&Config, sizeof (Config));
+  Config.Seed = DEFAULT_SEED;
+
+  FlagH        = ShellCommandLineGetFlag (ParamPackage, L"-h");
+  InvalidParam = FALSE;
+  if (!GetNumericParam (ParamPackage, L"-q", DEFAULT_QUEUE_DEPTH, &Config.QueueDepth) ||
+      !GetNumericParam (ParamPackage, L"-n", DEFAULT_IO_COUNT, &Config.IoCount) ||
+      !GetNumericParam (ParamPackage, L"-r", DEFAULT_RUNS, &Config.Runs) ||
+      (Config.QueueDepth > BLOCK_IO_BENCHMARK_MAX_QUEUE_DEPTH))
+  {
+    Print (L"Invalid numeric parameter\n");
+    InvalidParam = TRUE;
+  }
+
+  if (FlagH || InvalidParam) {
+    Print (L"%a [-q QueueDepth] [-n ReadsPerRun] [-r Runs] [-o CsvFileName] [-h]\n", gEfiCallerBaseName);
+    Print (L"   -h    Print this Help\n");
+    Print (L"   -q    Outstanding reads, 1 to %d.  Above 1 uses BlockIo2.  Default %d\n", BLOCK_IO_BENCHMARK_MAX_QUEUE_DEPTH, DEFAULT_QUEUE_DEPTH);
+    Print (L"   -n    Reads per run.  Default %d\n", DEFAULT_IO_COUNT);
+    Print (L"   -r    Runs per pattern and size.  Default %d\n", DEFAULT_RUNS);
+    Print (L"   -o    Write results to a csv file\n");
+    ShellCommandLineFreeVarList (ParamPackage);
+    return InvalidParam ? EFI_INVALID_PARAMETER : EFI_SUCCESS;
+  }
+
+  OutputFileName = ShellCommandLineGetValue (ParamPackage, L"-o");
+  if (OutputFileName != NULL) {
+    Status = OpenCsvFile (OutputFileName, &CsvFile);
+    if (EFI_ERROR (Status)) {
+      Print (L"ERROR: Failed to open %s file. Status = %r\n", OutputFileName, Status);
+      ShellCommandLineFreeVarList (ParamPackage);
+      return Status;
+    }
+  }
+
   // locate all handles with blockio
   Status = gBS->LocateHandleBuffer (ByProtocol, &gEfiBlockIoProtocolGuid, NULL, &BlockIoHandleCount, &BlockIoBuffer);
   if (EFI_ERROR (Status) || (BlockIoHandleCount == 0) || (BlockIoBuffer == NULL)) {
@@ -167,7 +362,8 @@ TestMain (
     // the BLOCK_IO Protocol, then return.
     //
     Print (L"No BlockIO in this system\n");
-    return EFI_SUCCESS;
+    Status = EFI_SUCCESS;
+    goto Exit;
   }
 
   Print (L"Found %d BlockIO handles\n", BlockIoHandleCount);
@@ -182,8 +378,6 @@ TestMain (
       DevicePathString = ConvertDevicePathToText (BlockIoDevicePath, TRUE, FALSE);
       if (DevicePathString != NULL) {
         Print (L"DevicePath is %s\n", DevicePathString);
-        FreePool (DevicePathString);
-        DevicePathString = NULL;
       } else {
         Print (L"DevicePath to text was NULL\n");
       }
@@ -193,16 +387,32 @@ TestMain (
     if (EFI_ERROR (Status) || (BlockIoProtocol == NULL)) {
       Print (L"BlockIoProtocol failed.  Can't test this one");
       Print (L"\n\n");
-      continue;
+    } else {
+      if (EFI_ERROR (gBS->HandleProtocol (BlockIoBuffer[Index], &gEfiBlockIo2ProtocolGuid, (VOID *)&BlockIo2Protocol))) {
+        BlockIo2Protocol = NULL;
+      }
+
+      TestBlockIo (BlockIoProtocol, BlockIo2Protocol, &Config, DevicePathString, CsvFile);
+      Print (L"\n\n");
     }
 
-    TestBlockIo (BlockIoProtocol);
-    Print (L"\n\n");
+    if (DevicePathString != NULL) {
+      FreePool (DevicePathString);
+      DevicePathString = NULL;
+    }
   } // end for loop
 
+  Status = EFI_SUCCESS;
+
+Exit:
   if (BlockIoBuffer != NULL) {
     gBS->FreePool (BlockIoBuffer);
   }
 
+  if (CsvFile != NULL) {
+    ShellCloseFile (&CsvFile);
+  }
+
+  ShellCommandLineFreeVarList (ParamPackage);
   return Status;
 }
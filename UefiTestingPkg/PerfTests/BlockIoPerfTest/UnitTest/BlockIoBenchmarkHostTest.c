@@ -0,0 +1,578 @@
+/** @file
+  Host based test of the BlockIoPerfTest benchmark engine.
+
+  RunBlockIoBenchmark is run against a fake device with BlockIo and BlockIo2.  The
+  fake records every read, completes BlockIo2 reads after a few polls of their
+  event, and checks the size, range and buffer of each request.
+
+  Copyright (C) Microsoft Corporation. All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "../BlockIoBenchmark.h"
+
+#define UNIT_TEST_NAME     "Block Io Benchmark Host Test"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define TEST_BLOCK_SIZE     512
+#define TEST_MAX_READS      1024
+#define TEST_POLLS_TO_DONE  2
+
+typedef struct {
+  EFI_BLOCK_IO_PROTOCOL     BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL    BlockIo2;
+  EFI_BLOCK_IO_MEDIA        Media;
+} FAKE_BLOCK_DEVICE;
+
+typedef struct {
+  BOOLEAN                Pending;
+  UINTN                  PollsLeft;
+  EFI_BLOCK_IO2_TOKEN    *Token;
+  VOID                   *Buffer;
+} FAKE_EVENT;
+
+STATIC UINT64      mTicks;
+STATIC UINTN       mTransferSize;
+STATIC EFI_LBA     mReads[TEST_MAX_READS];
+STATIC UINTN       mReadCount;
+STATIC UINTN       mBlockIoReads;
+STATIC UINTN       mBlockIo2Reads;
+STATIC UINTN       mOutstanding;
+STATIC UINTN       mMaxOutstanding;
+STATIC BOOLEAN     mBadRequest;
+STATIC FAKE_EVENT  mEvents[BLOCK_IO_BENCHMARK_MAX_QUEUE_DEPTH];
+STATIC UINTN       mEventCount;
+STATIC UINTN       mOpenEvents;
+
+/**
+  Mocked TimerLib GetPerformanceCounter ().  Every call is one tick.
+**/
+UINT64
+EFIAPI
+GetPerformanceCounter (
+  VOID
+  )
+{
+  return ++mTicks;
+}
+
+/**
+  Mocked TimerLib GetPerformanceCounterProperties ().  A 1GHz up counter.
+**/
+UINT64
+EFIAPI
+GetPerformanceCounterProperties (
+  OUT UINT64  *StartValue   OPTIONAL,
+  OUT UINT64  *EndValue     OPTIONAL
+  )
+{
+  if (StartValue != NULL) {
+    *StartValue = 0;
+  }
+
+  if (EndValue != NULL) {
+    *EndValue = MAX_UINT64;
+  }
+
+  return 1000000000;
+}
+
+/**
+  Mocked TimerLib GetTimeInNanoSecond ().
+**/
+UINT64
+EFIAPI
+GetTimeInNanoSecond (
+  IN UINT64  Ticks
+  )
+{
+  return Ticks;
+}
+
+/**
+  Check one read request against the media and record it.
+**/
+STATIC
+VOID
+RecordRead (
+  IN EFI_BLOCK_IO_MEDIA  *Media,
+  IN UINT32              MediaId,
+  IN EFI_LBA             Lba,
+  IN UINTN               BufferSize,
+  IN VOID                *Buffer
+  )
+{
+  UINT64  Blocks;
+
+  Blocks = BufferSize / Media->BlockSize;
+  if ((MediaId != Media->MediaId) || (Buffer == NULL) || (BufferSize != mTransferSize) ||
+      ((Lba % Blocks) != 0) || (Lba + Blocks > Media->LastBlock + 1))
+  {
+    mBadRequest = TRUE;
+  }
+
+  if (mReadCount < TEST_MAX_READS) {
+    mReads[mReadCount] = Lba;
+  }
+
+  mReadCount++;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+FakeReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  mBlockIoReads++;
+  RecordRead (This->Media, MediaId, Lba, BufferSize, Buffer);
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+FakeReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  OUT    VOID                    *Buffer
+  )
+{
+  FAKE_EVENT  *Event;
+  UINTN       Index;
+
+  mBlockIo2Reads++;
+  RecordRead (This->Media, MediaId, Lba, BufferSize, Buffer);
+
+  Event = (FAKE_EVENT *)Token->Event;
+  if ((Event == NULL) || Event->Pending) {
+    mBadRequest = TRUE;
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Every outstanding read needs a buffer of its own.
+  //
+  for (Index = 0; Index < mEventCount; Index++) {
+    if (mEvents[Index].Pending && (mEvents[Index].Buffer == Buffer)) {
+      mBadRequest = TRUE;
+    }
+  }
+
+  Event->Pending   = TRUE;
+  Event->PollsLeft = TEST_POLLS_TO_DONE;
+  Event->Token     = Token;
+  Event->Buffer    = Buffer;
+  mOutstanding++;
+  mMaxOutstanding = MAX (mMaxOutstanding, mOutstanding);
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+FakeCreateEvent (
+  IN  UINT32            Type,
+  IN  EFI_TPL           NotifyTpl,
+  IN  EFI_EVENT_NOTIFY  NotifyFunction OPTIONAL,
+  IN  VOID              *NotifyContext OPTIONAL,
+  OUT EFI_EVENT         *Event
+  )
+{
+  if (mEventCount == ARRAY_SIZE (mEvents)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ZeroMem (&mEvents[mEventCount], sizeof (FAKE_EVENT));
+  *Event = &mEvents[mEventCount++];
+  mOpenEvents++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Complete the read of the event once it has been polled TEST_POLLS_TO_DONE times.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+FakeCheckEvent (
+  IN EFI_EVENT  Event
+  )
+{
+  FAKE_EVENT  *FakeEvent;
+
+  FakeEvent = (FAKE_EVENT *)Event;
+  if (!FakeEvent->Pending) {
+    return EFI_NOT_READY;
+  }
+
+  if (FakeEvent->PollsLeft > 0) {
+    FakeEvent->PollsLeft--;
+    return EFI_NOT_READY;
+  }
+
+  FakeEvent->Pending                  = FALSE;
+  FakeEvent->Token->TransactionStatus = EFI_SUCCESS;
+  mOutstanding--;
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+FakeCloseEvent (
+  IN EFI_EVENT  Event
+  )
+{
+  mOpenEvents--;
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_BOOT_SERVICES  mBootServices = {
+  .CreateEvent = FakeCreateEvent,
+  .CheckEvent  = FakeCheckEvent,
+  .CloseEvent  = FakeCloseEvent,
+};
+
+EFI_BOOT_SERVICES  *gBS = &mBootServices;
+
+/**
+  Set up a fake device of the given size.  The benchmark keeps its position on the
+  media per device, so each test uses a device of its own.
+**/
+STATIC
+VOID
+InitDevice (
+  OUT FAKE_BLOCK_DEVICE  *Device,
+  IN  UINT64             Blocks
+  )
+{
+  ZeroMem (Device, sizeof (*Device));
+  Device->Media.MediaId      = 1;
+  Device->Media.MediaPresent = TRUE;
+  Device->Media.BlockSize    = TEST_BLOCK_SIZE;
+  Device->Media.LastBlock    = Blocks - 1;
+
+  Device->BlockIo.Revision   = EFI_BLOCK_IO_PROTOCOL_REVISION3;
+  Device->BlockIo.Media      = &Device->Media;
+  Device->BlockIo.ReadBlocks = FakeReadBlocks;
+
+  Device->BlockIo2.Media        = &Device->Media;
+  Device->BlockIo2.ReadBlocksEx = FakeReadBlocksEx;
+}
+
+/**
+  Reset the fake device state.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ResetFake (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  mTicks          = 0;
+  mTransferSize   = 0;
+  mReadCount      = 0;
+  mBlockIoReads   = 0;
+  mBlockIo2Reads  = 0;
+  mOutstanding    = 0;
+  mMaxOutstanding = 0;
+  mBadRequest     = FALSE;
+  mEventCount     = 0;
+  mOpenEvents     = 0;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The cold passes of random runs should read every aligned LBA of the media once
+  before any is read again, and each warm pass should read the LBAs of its cold pass.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+RandomColdReadsDoNotRepeat (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC FAKE_BLOCK_DEVICE   Device;
+  BLOCK_IO_BENCHMARK_CONFIG  Config;
+  BLOCK_IO_BENCHMARK_RESULT  Cold;
+  BLOCK_IO_BENCHMARK_RESULT  Warm;
+  BOOLEAN                    Seen[100];
+  BOOLEAN                    Shuffled;
+  UINTN                      Pass;
+  UINTN                      Run;
+  UINTN                      Index;
+  UINTN                      Slot;
+  EFI_LBA                    Lba;
+
+  //
+  // 100 slots of 4KB, which is not a power of two.
+  //
+  mTransferSize = SIZE_4KB;
+  InitDevice (&Device, ARRAY_SIZE (Seen) * (SIZE_4KB / TEST_BLOCK_SIZE));
+
+  ZeroMem (&Config, sizeof (Config));
+  Config.QueueDepth = 1;
+  Config.IoCount    = 10;
+  Config.Runs       = 10;
+  Config.Seed       = 0x5EED;
+
+  //
+  // The second call covers the media again in a new order.
+  //
+  for (Pass = 0; Pass < 2; Pass++) {
+    mReadCount = 0;
+    UT_ASSERT_NOT_EFI_ERROR (RunBlockIoBenchmark (&Device.BlockIo, NULL, &Config, BlockIoPatternRandom, mTransferSize, &Cold, &Warm));
+    UT_ASSERT_EQUAL (Cold.IoCount, ARRAY_SIZE (Seen));
+    UT_ASSERT_EQUAL (Warm.IoCount, ARRAY_SIZE (Seen));
+    UT_ASSERT_EQUAL (Cold.Errors, 0);
+    UT_ASSERT_EQUAL (mReadCount, 2 * ARRAY_SIZE (Seen));
+    UT_ASSERT_FALSE (mBadRequest);
+
+    ZeroMem (Seen, sizeof (Seen));
+    Shuffled = FALSE;
+    for (Run = 0; Run < Config.Runs; Run++) {
+      for (Index = 0; Index < Config.IoCount; Index++) {
+        Lba  = mReads[Run * Config.IoCount * 2 + Index];
+        Slot = (UINTN)(Lba / (SIZE_4KB / TEST_BLOCK_SIZE));
+        UT_ASSERT_TRUE (Slot < ARRAY_SIZE (Seen));
+        UT_ASSERT_FALSE (Seen[Slot]);
+        Seen[Slot] = TRUE;
+        UT_ASSERT_EQUAL (mReads[Run * Config.IoCount * 2 + Config.IoCount + Index], Lba);
+        if (Slot != Run * Config.IoCount + Index) {
+          Shuffled = TRUE;
+        }
+      }
+    }
+
+    UT_ASSERT_TRUE (Shuffled);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A queue depth above 1 should keep that many BlockIo2 reads outstanding, each with a
+  buffer of its own, and close every event.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+QueueDepthUsesBlockIo2 (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC FAKE_BLOCK_DEVICE   Device;
+  BLOCK_IO_BENCHMARK_CONFIG  Config;
+  BLOCK_IO_BENCHMARK_RESULT  Cold;
+  BLOCK_IO_BENCHMARK_RESULT  Warm;
+
+  mTransferSize = SIZE_64KB;
+  InitDevice (&Device, SIZE_16MB / TEST_BLOCK_SIZE);
+
+  ZeroMem (&Config, sizeof (Config));
+  Config.QueueDepth = 4;
+  Config.IoCount    = 32;
+  Config.Runs       = 2;
+  Config.Seed       = 0x5EED;
+
+  UT_ASSERT_NOT_EFI_ERROR (RunBlockIoBenchmark (&Device.BlockIo, &Device.BlockIo2, &Config, BlockIoPatternSequential, mTransferSize, &Cold, &Warm));
+  UT_ASSERT_FALSE (mBadRequest);
+  UT_ASSERT_EQUAL (mBlockIoReads, 0);
+  UT_ASSERT_EQUAL (mBlockIo2Reads, 2 * 32 * 2);
+  UT_ASSERT_EQUAL (mMaxOutstanding, 4);
+  UT_ASSERT_EQUAL (mOutstanding, 0);
+  UT_ASSERT_EQUAL (mOpenEvents, 0);
+
+  UT_ASSERT_EQUAL (Cold.QueueDepth, 4);
+  UT_ASSERT_EQUAL (Cold.IoCount, 64);
+  UT_ASSERT_EQUAL (Warm.IoCount, 64);
+  UT_ASSERT_EQUAL (Cold.Errors, 0);
+  UT_ASSERT_TRUE (Cold.MinNs <= Cold.MedianNs);
+  UT_ASSERT_TRUE (Cold.MedianNs <= Cold.P99Ns);
+  UT_ASSERT_TRUE (Cold.P99Ns <= Cold.MaxNs);
+  UT_ASSERT_TRUE (Cold.KiBPerSecond > 0);
+
+  //
+  // Sequential runs continue where the previous run stopped.
+  //
+  UT_ASSERT_EQUAL (mReads[0], 0);
+  UT_ASSERT_EQUAL (mReads[64], 32 * (SIZE_64KB / TEST_BLOCK_SIZE));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Large transfers should lower the queue depth so the read buffers stay within
+  BLOCK_IO_BENCHMARK_MAX_QUEUED_BYTES.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LargeTransfersLimitQueueDepth (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC FAKE_BLOCK_DEVICE   Device;
+  BLOCK_IO_BENCHMARK_CONFIG  Config;
+  BLOCK_IO_BENCHMARK_RESULT  Cold;
+  BLOCK_IO_BENCHMARK_RESULT  Warm;
+  UINTN                      Expected;
+
+  mTransferSize = SIZE_16MB + SIZE_4MB;
+  Expected      = BLOCK_IO_BENCHMARK_MAX_QUEUED_BYTES / mTransferSize;
+  InitDevice (&Device, SIZE_1GB / TEST_BLOCK_SIZE);
+
+  ZeroMem (&Config, sizeof (Config));
+  Config.QueueDepth = BLOCK_IO_BENCHMARK_MAX_QUEUE_DEPTH;
+  Config.IoCount    = 8;
+  Config.Runs       = 1;
+  Config.Seed       = 0x5EED;
+
+  UT_ASSERT_NOT_EFI_ERROR (RunBlockIoBenchmark (&Device.BlockIo, &Device.BlockIo2, &Config, BlockIoPatternRandom, mTransferSize, &Cold, &Warm));
+  UT_ASSERT_FALSE (mBadRequest);
+  UT_ASSERT_TRUE (Expected > 1);
+  UT_ASSERT_TRUE (Expected < BLOCK_IO_BENCHMARK_MAX_QUEUE_DEPTH);
+  UT_ASSERT_EQUAL (Cold.QueueDepth, Expected);
+  UT_ASSERT_EQUAL (mMaxOutstanding, Expected);
+  UT_ASSERT_EQUAL (mEventCount, Expected);
+  UT_ASSERT_EQUAL (Cold.IoCount, 8);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Transfers that do not fit the media, and media that is not present, should be
+  rejected before any read.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+InvalidTransfersRejected (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC FAKE_BLOCK_DEVICE   Device;
+  BLOCK_IO_BENCHMARK_CONFIG  Config;
+  BLOCK_IO_BENCHMARK_RESULT  Cold;
+  BLOCK_IO_BENCHMARK_RESULT  Warm;
+  EFI_STATUS                 Status;
+
+  InitDevice (&Device, 16);
+
+  ZeroMem (&Config, sizeof (Config));
+  Config.QueueDepth = 1;
+  Config.IoCount    = 1;
+  Config.Runs       = 1;
+
+  Status = RunBlockIoBenchmark (&Device.BlockIo, NULL, &Config, BlockIoPatternRandom, TEST_BLOCK_SIZE + 1, &Cold, &Warm);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = RunBlockIoBenchmark (&Device.BlockIo, NULL, &Config, BlockIoPatternRandom, 32 * TEST_BLOCK_SIZE, &Cold, &Warm);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = RunBlockIoBenchmark (&Device.BlockIo, NULL, &Config, BlockIoPatternMax, TEST_BLOCK_SIZE, &Cold, &Warm);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  Device.Media.MediaPresent = FALSE;
+  Status                    = RunBlockIoBenchmark (&Device.BlockIo, NULL, &Config, BlockIoPatternRandom, TEST_BLOCK_SIZE, &Cold, &Warm);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NO_MEDIA);
+
+  UT_ASSERT_EQUAL (mReadCount, 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  block io benchmark and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the Benchmark Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&BenchmarkSuite, Framework, "Benchmark", "BlockIoPerfTest.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BenchmarkSuite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (BenchmarkSuite, "Random cold reads should not repeat an LBA", "RandomColdReads", RandomColdReadsDoNotRepeat, ResetFake, NULL, NULL);
+  AddTestCase (BenchmarkSuite, "A queue depth above 1 should use BlockIo2", "QueueDepth", QueueDepthUsesBlockIo2, ResetFake, NULL, NULL);
+  AddTestCase (BenchmarkSuite, "Large transfers should limit the queue depth", "LargeTransfers", LargeTransfersLimitQueueDepth, ResetFake, NULL, NULL);
+  AddTestCase (BenchmarkSuite, "Invalid transfers should be rejected", "InvalidTransfers", InvalidTransfersRejected, ResetFake, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
@@ -0,0 +1,197 @@
+/**
+XmlWriterLib.h
+
+Library to write an XML document as a stream without building an XmlNode tree.
+
+Output is produced in document order into a fixed size buffer which is handed to
+a caller supplied flush function whenever it fills.  Attribute and element values
+are escaped the same way as XmlEscape(), and the notation matches XmlTreeToString()
+(no whitespace, " />" for empty elements).
+
+Copyright (C) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __XML_WRITER_LIB_H__
+#define __XML_WRITER_LIB_H__
+
+#define XML_WRITER_MAX_DEPTH            (32)
+#define XML_WRITER_DEFAULT_BUFFER_SIZE  (SIZE_4KB)
+
+typedef struct _XML_WRITER XML_WRITER;
+
+/**
+Function called with each chunk of the document.
+
+@param[in] Context  -- Context passed to XmlWriterCreate.
+@param[in] Buffer   -- Next chunk of the document.  Not NULL terminated.
+@param[in] Length   -- Number of bytes in Buffer.
+
+@return  EFI_SUCCESS or underlying failure code.  A failure stops the writer.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *XML_WRITER_FLUSH)(
+  IN       VOID   *Context,
+  IN CONST CHAR8  *Buffer,
+  IN       UINTN  Length
+  );
+
+/**
+Create a new XML writer.
+
+@param[in]  Flush       -- Function that receives the document.
+@param[in]  Context     -- Optional context passed to Flush.
+@param[in]  BufferSize  -- Bytes to buffer between calls to Flush.  0 selects XML_WRITER_DEFAULT_BUFFER_SIZE.
+                          Any other size, down to 1, is valid.
+@param[out] Writer      -- The new writer.  Must be freed with XmlWriterFree.
+
+@return  EFI_SUCCESS or underlying failure code.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterCreate (
+  IN  XML_WRITER_FLUSH  Flush,
+  IN  VOID              *Context OPTIONAL,
+  IN  UINTN             BufferSize,
+  OUT XML_WRITER        **Writer
+  );
+
+/**
+Write the XML declaration.  Must be called before the root element, if at all.
+
+@param[in] Writer -- The writer.
+
+@return  EFI_SUCCESS or underlying failure code.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterDeclaration (
+  IN XML_WRITER  *Writer
+  );
+
+/**
+Start a new element as the last child of the current element.
+
+@param[in] Writer -- The writer.
+@param[in] Name   -- Element name.  Must stay valid until the element is ended.
+
+@return  EFI_SUCCESS or underlying failure code.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterStartElement (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Name
+  );
+
+/**
+Add an attribute to the element just started.  Attributes must be
+written before any value or child of the element.
+
+@param[in] Writer -- The writer.
+@param[in] Name   -- Attribute name.
+@param[in] Value  -- Attribute value.  It will be escaped.
+
+@return  EFI_SUCCESS or underlying failure code.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterAttribute (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Name,
+  IN CONST CHAR8       *Value
+  );
+
+/**
+Append text to the value of the current element.  May be called more
+than once to write a value in pieces.  An empty Value writes nothing, so
+an element given only empty values is written as an empty element.
+
+@param[in] Writer -- The writer.
+@param[in] Value  -- Text to append.  It will be escaped.
+
+@return  EFI_SUCCESS or underlying failure code.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterValue (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Value
+  );
+
+/**
+Append bytes to the value of the current element as two upper case
+hex digits each.  The data is never copied into an intermediate string.
+
+@param[in] Writer -- The writer.
+@param[in] Data   -- Bytes to append.
+@param[in] Size   -- Number of bytes in Data.
+
+@return  EFI_SUCCESS or underlying failure code.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterHexValue (
+  IN       XML_WRITER  *Writer,
+  IN CONST UINT8       *Data,
+  IN       UINTN       Size
+  );
+
+/**
+End the current element.
+
+@param[in] Writer -- The writer.
+
+@return  EFI_SUCCESS or underlying failure code.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterEndElement (
+  IN XML_WRITER  *Writer
+  );
+
+/**
+Write a complete element with an optional value and no attributes.
+
+@param[in] Writer -- The writer.
+@param[in] Name   -- Element name.
+@param[in] Value  -- Optional element value.  It will be escaped.
+
+@return  EFI_SUCCESS or underlying failure code.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterElement (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Name,
+  IN CONST CHAR8       *Value OPTIONAL
+  );
+
+/**
+End all open elements and flush the remaining output.
+
+@param[in] Writer -- The writer.
+
+@return  EFI_SUCCESS if the whole document was written, otherwise the first failure
+         returned by any writer function or by Flush.
+**/
+EFI_STATUS
+EFIAPI
+XmlWriterFinish (
+  IN XML_WRITER  *Writer
+  );
+
+/**
+Free a writer.  Output not written by XmlWriterFinish is discarded.
+
+@param[in] Writer -- The writer.  May be NULL.
+**/
+VOID
+EFIAPI
+XmlWriterFree (
+  IN XML_WRITER  *Writer
+  );
+
+#endif // __XML_WRITER_LIB_H__
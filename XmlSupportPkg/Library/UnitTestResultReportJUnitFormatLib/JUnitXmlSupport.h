@@ -11,8 +11,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <Uefi.h>
 #include <Library/DebugLib.h>
-#include <XmlTypes.h>
-#include <Library/XmlTreeLib.h>
+#include <Library/XmlWriterLib.h>
 #include <Library/BaseLib.h>
 #include <Library/PrintLib.h>
 
@@ -97,80 +96,52 @@ http://help.catchsoftware.com/display/ET/JUnit+Format
 #define TESTCASE_SKIPPED_ELEMENT_NAME  "skipped"
 
 /**
-Creates a new MsXmlNode list following the List
-format.  This is the root document that test suite objects can be
-added to.
-
-Return NULL if error occurs. Otherwise return a pointer to xml doc root element
-of a testsuite.
-
-List must be freed using FreeXmlTree
-
+Writes the start of a testsuite element, including the suite statistics.
+The caller writes the testcase elements and then ends the element with XmlWriterEndElement.
+
+@param[in] Writer         -- Writer positioned inside the testsuites element.
+@param[in] Name           -- Suite name.
+@param[in] Package        -- Suite package.
+@param[in] Id             -- Index of the suite in the document.
+@param[in] TotalTests     -- Number of test cases in the suite.
+@param[in] TotalFailures  -- Number of failed test cases in the suite.
+@param[in] TotalSkips     -- Number of skipped test cases in the suite.
+@param[in] TotalErrors    -- Number of errored test cases in the suite.
+
+@return  EFI_SUCCESS or underlying failure code.
 **/
-XmlNode *
-EFIAPI
-New_JUnitXmlDocNodeList (
-  );
-
-/**
-Creates a new MsXmlNode for a Test Suite and adds it to the list
-
-Return NULL if error occurs.
-
-return pointer will be the newly created test suite element node
-**/
-XmlNode *
-EFIAPI
-New_TestSuiteNodeInList (
-  IN CONST  XmlNode  *RootNode,
-  IN CONST  CHAR8    *Name,
-  IN CONST  CHAR8    *Package,
-  UINTN              Id
-  );
-
-/**
-Creates a new MsXmlNode for a Test case and adds it to the list
-
-Return NULL if error occurs. Otherwise return a pointer to the Testcase Node.
-
-return pointer will be the newly created test case element node
-**/
-XmlNode *
+EFI_STATUS
 EFIAPI
-New_TestCaseInSuite (
-  IN CONST XmlNode   *TestSuite,
-  IN CONST  CHAR8    *Name,
-  IN CONST  CHAR8    *ClassName,
-  UINTN              TimeInSeconds,
-  IN CONST  CHAR8    *Log  OPTIONAL,
-  IN CONST  CHAR8    *FailureMsg   OPTIONAL,
-  IN CONST  CHAR8    *FailureType  OPTIONAL,
-  IN        BOOLEAN  Skipped
+WriteTestSuiteStart (
+  IN        XML_WRITER  *Writer,
+  IN CONST  CHAR8       *Name,
+  IN CONST  CHAR8       *Package,
+  UINTN                 Id,
+  UINTN                 TotalTests,
+  UINTN                 TotalFailures,
+  UINTN                 TotalSkips,
+  UINTN                 TotalErrors
   );
 
 /**
-Creates a new MsXmlNode for a Test case failure and add it to the test case
+Writes a complete testcase element to the current testsuite.
 
-Return NULL if error occurs or no failure node needed. Otherwise return a pointer to the failure Node.
+A failure element is only written when both FailureMsg and FailureType are provided.
 
-return pointer will be the newly created failure element node
+@retval  EFI_INVALID_PARAMETER  Writer, Name or ClassName is NULL.  Nothing was written.
+@return  EFI_SUCCESS or underlying failure code.
 **/
-XmlNode *
-EFIAPI
-New_FailureForTestCase (
-  IN CONST  XmlNode  *TestCase,
-  IN CONST  CHAR8    *Msg  OPTIONAL,
-  IN CONST  CHAR8    *Type OPTIONAL
-  );
-
 EFI_STATUS
 EFIAPI
-AddTestSuiteStats (
-  IN    XmlNode  *TestSuite,
-  UINTN          TotalTests,
-  UINTN          TotalFailures,
-  UINTN          TotalSkips,
-  UINTN          TotalErrors
+WriteTestCase (
+  IN        XML_WRITER  *Writer,
+  IN CONST  CHAR8       *Name,
+  IN CONST  CHAR8       *ClassName,
+  UINTN                 TimeInSeconds,
+  IN CONST  CHAR8       *Log  OPTIONAL,
+  IN CONST  CHAR8       *FailureMsg   OPTIONAL,
+  IN CONST  CHAR8       *FailureType  OPTIONAL,
+  IN        BOOLEAN     Skipped
   );
 
 #endif
@@ -64,32 +64,32 @@ GetStringForFailureType (
   return Result;
 }
 
+/**
+XML_WRITER_FLUSH that appends each chunk of the report to the open log file.
+**/
 STATIC
 EFI_STATUS
-WriteXmlNodeToLogFile (
-  IN UNIT_TEST_FRAMEWORK  *Framework,
-  IN XmlNode              *Doc
+EFIAPI
+WriteChunkToLogFile (
+  IN       VOID   *Context,
+  IN CONST CHAR8  *Buffer,
+  IN       UINTN  Length
   )
 {
-  EFI_STATUS         Status;
-  UINTN              FileNameLen        = 0;
-  CHAR16             *LogFileName       = NULL;
-  CHAR16             *LogFileNameSuffix = L"_JUNIT.XML";
-  SHELL_FILE_HANDLE  FileHandle;
-  UINTN              StringSize = 0;
-  CHAR8              *XmlString = NULL;
-
-  if (Framework == NULL) {
-    Status = EFI_INVALID_PARAMETER;
-    DEBUG ((DEBUG_ERROR, "Framework is NULL.\n"));
-    goto Exit;
-  }
+  return ShellWriteFile ((SHELL_FILE_HANDLE)Context, &Length, (VOID *)Buffer);
+}
 
-  if (Doc == NULL) {
-    Status = EFI_INVALID_PARAMETER;
-    DEBUG ((DEBUG_ERROR, "XML Doc Node List is NULL.\n"));
-    goto Exit;
-  }
+STATIC
+EFI_STATUS
+OpenLogFile (
+  IN  UNIT_TEST_FRAMEWORK  *Framework,
+  OUT SHELL_FILE_HANDLE    *FileHandle
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       FileNameLen        = 0;
+  CHAR16      *LogFileName       = NULL;
+  CHAR16      *LogFileNameSuffix = L"_JUNIT.XML";
 
   // Get the file name based on framework name
   FileNameLen  = AsciiStrLen (Framework->ShortTitle);
@@ -105,64 +105,40 @@ WriteXmlNodeToLogFile (
   AsciiStrToUnicodeStrS (Framework->ShortTitle, LogFileName, FileNameLen);
   StrnCatS (LogFileName, FileNameLen, LogFileNameSuffix, FileNameLen - 1);
 
-  // Write XML
-  Status = XmlTreeToString (Doc, TRUE, &StringSize, &XmlString);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "XmlTreeToString failed.  %r\n", Status));
-    goto Exit;
-  }
-
-  if (StringSize == 0) {
-    Status = EFI_OUT_OF_RESOURCES;
-    DEBUG ((DEBUG_ERROR, "StringSize equal 0.\n"));
-    goto Exit;
-  }
-
-  //
-  // subtract 1 from string size to avoid writing the NULL terminator
-  //
-  StringSize--;
-
   //
   // First lets open the file if it exists so we can delete it...This is the work around for truncation
   //
-  Status = ShellOpenFileByName (LogFileName, &FileHandle, EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
+  Status = ShellOpenFileByName (LogFileName, FileHandle, EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
   if (!EFI_ERROR (Status)) {
     // if file handle above was opened it will be closed by the delete.
-    Status = ShellDeleteFile (&FileHandle);
+    Status = ShellDeleteFile (FileHandle);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "%a failed to delete file %r\n", __FUNCTION__, Status));
     }
   }
 
-  Status = ShellOpenFileByName (LogFileName, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
+  Status = ShellOpenFileByName (LogFileName, FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to open %s file for create. Status = %r\n", LogFileName, Status));
     goto Exit;
-  } else {
-    ShellPrintEx (-1, -1, L"Writing XML to file %s\n", LogFileName);
-    ShellWriteFile (FileHandle, &StringSize, XmlString);
-    ShellCloseFile (&FileHandle);
   }
 
-  // success
-  Status = EFI_SUCCESS;
+  ShellPrintEx (-1, -1, L"Writing XML to file %s\n", LogFileName);
 
 Exit:
   if (LogFileName != NULL) {
     FreePool (LogFileName);
   }
 
-  if (XmlString != NULL) {
-    FreePool (XmlString);
-  }
-
   return Status;
 }
 
 /*
 Method to print the Unit Test run results
 
+The report is streamed to the log file one test case at a time so memory use
+does not grow with the number of tests.
+
 @retval Success
 */
 EFI_STATUS
@@ -173,7 +149,8 @@ OutputUnitTestFrameworkReport (
 {
   EFI_STATUS                  Status     = EFI_SUCCESS;
   UNIT_TEST_SUITE_LIST_ENTRY  *Suite     = NULL;
-  XmlNode                     *Doc       = NULL;
+  XML_WRITER                  *Writer    = NULL;
+  SHELL_FILE_HANDLE           FileHandle = NULL;
   UINTN                       Id         = 0;
   UNIT_TEST_FRAMEWORK         *Framework = NULL;
 
@@ -185,13 +162,21 @@ OutputUnitTestFrameworkReport (
     goto EXIT;
   }
 
-  Doc = New_JUnitXmlDocNodeList ();
-  if (Doc == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a Failed to create new xml doc\n", __FUNCTION__));
-    Status = EFI_DEVICE_ERROR;
+  Status = OpenLogFile (Framework, &FileHandle);
+  if (EFI_ERROR (Status)) {
+    FileHandle = NULL;
     goto EXIT;
   }
 
+  Status = XmlWriterCreate (WriteChunkToLogFile, FileHandle, XML_WRITER_DEFAULT_BUFFER_SIZE, &Writer);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a Failed to create xml writer.  Status = %r\n", __FUNCTION__, Status));
+    goto EXIT;
+  }
+
+  XmlWriterDeclaration (Writer);
+  XmlWriterStartElement (Writer, TESTSUITE_LIST_ELEMENT_NAME);
+
   //
   // Iterate all suites
   //
@@ -200,7 +185,6 @@ OutputUnitTestFrameworkReport (
        Suite = (UNIT_TEST_SUITE_LIST_ENTRY *)GetNextNode (&Framework->TestSuiteList, (LIST_ENTRY *)Suite), Id++)
   {
     UNIT_TEST_LIST_ENTRY  *Test         = NULL;
-    XmlNode               *SuiteNode    = NULL;
     CHAR8                 *SuiteName    = NULL;
     CHAR8                 *SuitePackage = NULL;
     UINTN                 TotalTests    = 0;
@@ -221,47 +205,57 @@ OutputUnitTestFrameworkReport (
       goto EXIT;
     }
 
-    SuiteNode = New_TestSuiteNodeInList (Doc, SuiteName, SuitePackage, Id);
-    FreePool (SuiteName);
-    FreePool (SuitePackage);
-    if (SuiteNode == NULL) {
-      DEBUG ((DEBUG_ERROR, "%a Failed to create new test suite\n", __FUNCTION__));
-      Status = EFI_DEVICE_ERROR;
-      goto EXIT;
-    }
-
     //
-    // Iterate all tests within the suite
+    // The suite stats are attributes of the suite element, so count them before writing any test case
     //
     for (Test = (UNIT_TEST_LIST_ENTRY *)GetFirstNode (&(Suite->UTS.TestCaseList));
          (LIST_ENTRY *)Test != &(Suite->UTS.TestCaseList);
          Test = (UNIT_TEST_LIST_ENTRY *)GetNextNode (&(Suite->UTS.TestCaseList), (LIST_ENTRY *)Test))
     {
-      CHAR8    *Name       = NULL;
-      CHAR8    *ClassName  = NULL;
-      CHAR8    *Log        = NULL;
-      CHAR8    *FailureMsg = NULL;
-      BOOLEAN  Skipped     = FALSE;
-
       TotalTests++;
 
       if (Test->UT.Result == UNIT_TEST_ERROR_PREREQUISITE_NOT_MET) {
-        Skipped = TRUE;
         TotalSkips++;
-      } else {
+      } else if (Test->UT.FailureType != FAILURETYPE_NOFAILURE) {
         // only count failures if there is a failuretype and no skip
-        if (Test->UT.FailureType != FAILURETYPE_NOFAILURE) {
-          TotalFailures++;
-        }
+        TotalFailures++;
       }
+    }
+
+    Status = WriteTestSuiteStart (Writer, SuiteName, SuitePackage, Id, TotalTests, TotalFailures, TotalSkips, TotalErrors);
+    FreePool (SuiteName);
+    FreePool (SuitePackage);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a Failed to write test suite.  Status = %r\n", __FUNCTION__, Status));
+      goto EXIT;
+    }
 
-      Name       = Test->UT.Description;
-      ClassName  = Test->UT.Name;
-      Log        = Test->UT.Log;
-      FailureMsg = Test->UT.FailureMessage;
+    //
+    // Iterate all tests within the suite
+    //
+    for (Test = (UNIT_TEST_LIST_ENTRY *)GetFirstNode (&(Suite->UTS.TestCaseList));
+         (LIST_ENTRY *)Test != &(Suite->UTS.TestCaseList);
+         Test = (UNIT_TEST_LIST_ENTRY *)GetNextNode (&(Suite->UTS.TestCaseList), (LIST_ENTRY *)Test))
+    {
+      CHAR8  *Name      = NULL;
+      CHAR8  *ClassName = NULL;
+      CHAR8  *Log       = NULL;
+
+      Name      = Test->UT.Description;
+      ClassName = Test->UT.Name;
+      Log       = Test->UT.Log;
 
       // TODO:  need to handle timing.  Right now its hard coded to 1 second.
-      New_TestCaseInSuite (SuiteNode, Name, ClassName, 1, Log, FailureMsg, GetStringForFailureType (Test->UT.FailureType), Skipped);
+      Status = WriteTestCase (
+                 Writer,
+                 Name,
+                 ClassName,
+                 1,
+                 Log,
+                 Test->UT.FailureMessage,
+                 GetStringForFailureType (Test->UT.FailureType),
+                 (BOOLEAN)(Test->UT.Result == UNIT_TEST_ERROR_PREREQUISITE_NOT_MET)
+                 );
 
       if (Name != NULL) {
         FreePool (Name);
@@ -274,27 +268,36 @@ OutputUnitTestFrameworkReport (
       if (ClassName != NULL) {
         FreePool (ClassName);
       }
+
+      // A test case without a name was left out of the report before it was streamed too.  Only a write error stops it.
+      if (Status == EFI_INVALID_PARAMETER) {
+        DEBUG ((DEBUG_ERROR, "%a Test case is missing a name and is not in the report.\n", __FUNCTION__));
+        continue;
+      }
+
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "%a Failed to write test case.  Status = %r\n", __FUNCTION__, Status));
+        goto EXIT;
+      }
     } // End Test iteration
 
-    Status = AddTestSuiteStats (SuiteNode, TotalTests, TotalFailures, TotalSkips, TotalErrors);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a Failed in AddTestSuiteStats.  Status = %r\n", __FUNCTION__, Status));
-      goto EXIT;
-    }
+    XmlWriterEndElement (Writer);
   }// End Suite iteration
 
-  // write junit xml to file
-  Status = WriteXmlNodeToLogFile (Framework, Doc);
+  // closes testsuites and writes whatever is still buffered
+  Status = XmlWriterFinish (Writer);
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a Failed to Write Xml Node To LogFile.  Status = %r\n", __FUNCTION__, Status));
+    DEBUG ((DEBUG_ERROR, "%a Failed to Write Xml To LogFile.  Status = %r\n", __FUNCTION__, Status));
     goto EXIT;
   }
 
   // done - clean up
 
 EXIT:
-  if (Doc != NULL) {
-    FreeXmlTree (&Doc);
+  XmlWriterFree (Writer);
+
+  if (FileHandle != NULL) {
+    ShellCloseFile (&FileHandle);
   }
 
   return Status;
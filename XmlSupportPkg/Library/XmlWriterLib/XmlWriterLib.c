@@ -0,0 +1,541 @@
+/**
+XmlWriterLib.c
+
+Streaming XML writer.  See XmlWriterLib.h.
+
+Copyright (C) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/XmlWriterLib.h>
+
+#define XML_DECLARATION  "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+
+struct _XML_WRITER {
+  XML_WRITER_FLUSH    Flush;
+  VOID                *Context;
+  CHAR8               *Buffer;
+  UINTN               BufferSize;
+  UINTN               Used;
+  EFI_STATUS          Status;                      // First failure.  Once set, nothing more is written.
+  BOOLEAN             StartTagOpen;                // The start tag of the current element still needs its '>'
+  BOOLEAN             RootWritten;
+  UINTN               Depth;
+  CONST CHAR8         *Names[XML_WRITER_MAX_DEPTH];
+};
+
+/**
+Hand the buffered output to the flush function.
+**/
+STATIC
+EFI_STATUS
+FlushBuffer (
+  IN XML_WRITER  *Writer
+  )
+{
+  EFI_STATUS  Status;
+
+  if (Writer->Used == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Status = Writer->Flush (Writer->Context, Writer->Buffer, Writer->Used);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a - Flush failed.  Status %r\n", __FUNCTION__, Status));
+    Writer->Status = Status;
+  }
+
+  Writer->Used = 0;
+  return Status;
+}
+
+/**
+Append raw bytes to the output.
+**/
+STATIC
+EFI_STATUS
+WriteBytes (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Data,
+  IN       UINTN       Length
+  )
+{
+  UINTN  Chunk;
+
+  while (Length > 0) {
+    if (Writer->Used == Writer->BufferSize) {
+      if (EFI_ERROR (FlushBuffer (Writer))) {
+        return Writer->Status;
+      }
+    }
+
+    Chunk = MIN (Length, Writer->BufferSize - Writer->Used);
+    CopyMem (Writer->Buffer + Writer->Used, Data, Chunk);
+    Writer->Used += Chunk;
+    Data         += Chunk;
+    Length       -= Chunk;
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+WriteString (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *String
+  )
+{
+  return WriteBytes (Writer, String, AsciiStrLen (String));
+}
+
+/**
+Append a string to the output, escaping the characters XmlEscape() escapes.
+Runs of characters that need no escaping are copied in one piece.
+**/
+STATIC
+EFI_STATUS
+WriteEscaped (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *String
+  )
+{
+  CONST CHAR8  *Run;
+  CONST CHAR8  *Escape;
+  EFI_STATUS   Status;
+
+  for (Run = String; ; String++) {
+    switch (*String) {
+      case '<':
+        Escape = "&lt;";
+        break;
+      case '>':
+        Escape = "&gt;";
+        break;
+      case '\"':
+        Escape = "&quot;";
+        break;
+      case '\'':
+        Escape = "&apos;";
+        break;
+      case '&':
+        Escape = "&amp;";
+        break;
+      case '\0':
+        return WriteBytes (Writer, Run, String - Run);
+      default:
+        continue;
+    }
+
+    Status = WriteBytes (Writer, Run, String - Run);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Status = WriteString (Writer, Escape);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Run = String + 1;
+  }
+}
+
+/**
+Finish the start tag of the current element so content can follow it.
+**/
+STATIC
+EFI_STATUS
+CloseStartTag (
+  IN XML_WRITER  *Writer
+  )
+{
+  if (!Writer->StartTagOpen) {
+    return EFI_SUCCESS;
+  }
+
+  Writer->StartTagOpen = FALSE;
+  return WriteBytes (Writer, ">", 1);
+}
+
+/**
+Common parameter and state checks.  Records misuse as the writer status.
+**/
+STATIC
+EFI_STATUS
+CheckWriter (
+  IN XML_WRITER  *Writer,
+  IN BOOLEAN     NeedElement
+  )
+{
+  if (Writer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (EFI_ERROR (Writer->Status)) {
+    return Writer->Status;
+  }
+
+  if (NeedElement && (Writer->Depth == 0)) {
+    DEBUG ((DEBUG_ERROR, "%a - No element is open\n", __FUNCTION__));
+    Writer->Status = EFI_INVALID_PARAMETER;
+    return Writer->Status;
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterCreate (
+  IN  XML_WRITER_FLUSH  Flush,
+  IN  VOID              *Context OPTIONAL,
+  IN  UINTN             BufferSize,
+  OUT XML_WRITER        **Writer
+  )
+{
+  XML_WRITER  *NewWriter;
+
+  if ((Flush == NULL) || (Writer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (BufferSize == 0) {
+    BufferSize = XML_WRITER_DEFAULT_BUFFER_SIZE;
+  }
+
+  NewWriter = AllocateZeroPool (sizeof (XML_WRITER));
+  if (NewWriter == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  NewWriter->Buffer = AllocatePool (BufferSize);
+  if (NewWriter->Buffer == NULL) {
+    FreePool (NewWriter);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  NewWriter->Flush      = Flush;
+  NewWriter->Context    = Context;
+  NewWriter->BufferSize = BufferSize;
+  NewWriter->Status     = EFI_SUCCESS;
+
+  *Writer = NewWriter;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterDeclaration (
+  IN XML_WRITER  *Writer
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = CheckWriter (Writer, FALSE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Writer->RootWritten || (Writer->Used != 0)) {
+    DEBUG ((DEBUG_ERROR, "%a - Declaration must be the start of the document\n", __FUNCTION__));
+    Writer->Status = EFI_INVALID_PARAMETER;
+    return Writer->Status;
+  }
+
+  return WriteString (Writer, XML_DECLARATION);
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterStartElement (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Name
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = CheckWriter (Writer, FALSE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if ((Name == NULL) || (*Name == '\0')) {
+    Writer->Status = EFI_INVALID_PARAMETER;
+    return Writer->Status;
+  }
+
+  if (Writer->Depth >= XML_WRITER_MAX_DEPTH) {
+    DEBUG ((DEBUG_ERROR, "%a - Max depth exceeded\n", __FUNCTION__));
+    Writer->Status = EFI_BAD_BUFFER_SIZE;
+    return Writer->Status;
+  }
+
+  if ((Writer->Depth == 0) && Writer->RootWritten) {
+    DEBUG ((DEBUG_ERROR, "%a - Document already has a root element\n", __FUNCTION__));
+    Writer->Status = EFI_INVALID_PARAMETER;
+    return Writer->Status;
+  }
+
+  Status = CloseStartTag (Writer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = WriteBytes (Writer, "<", 1);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = WriteString (Writer, Name);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Writer->Names[Writer->Depth++] = Name;
+  Writer->StartTagOpen           = TRUE;
+  Writer->RootWritten            = TRUE;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterAttribute (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Name,
+  IN CONST CHAR8       *Value
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = CheckWriter (Writer, TRUE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if ((Name == NULL) || (Value == NULL)) {
+    Writer->Status = EFI_INVALID_PARAMETER;
+    return Writer->Status;
+  }
+
+  if (!Writer->StartTagOpen) {
+    DEBUG ((DEBUG_ERROR, "%a - Attribute %a written after element content\n", __FUNCTION__, Name));
+    Writer->Status = EFI_INVALID_PARAMETER;
+    return Writer->Status;
+  }
+
+  Status = WriteBytes (Writer, " ", 1);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = WriteString (Writer, Name);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = WriteBytes (Writer, "=\"", 2);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = WriteEscaped (Writer, Value);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return WriteBytes (Writer, "\"", 1);
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterValue (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Value
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = CheckWriter (Writer, TRUE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Value == NULL) {
+    Writer->Status = EFI_INVALID_PARAMETER;
+    return Writer->Status;
+  }
+
+  // An empty value leaves the element empty, same as XmlTreeLib
+  if (*Value == '\0') {
+    return EFI_SUCCESS;
+  }
+
+  Status = CloseStartTag (Writer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return WriteEscaped (Writer, Value);
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterHexValue (
+  IN       XML_WRITER  *Writer,
+  IN CONST UINT8       *Data,
+  IN       UINTN       Size
+  )
+{
+  STATIC CONST CHAR8  HexDigits[] = "0123456789ABCDEF";
+  CHAR8               Hex[64];
+  EFI_STATUS          Status;
+  UINTN               Index;
+  UINTN               Length;
+
+  Status = CheckWriter (Writer, TRUE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if ((Data == NULL) && (Size != 0)) {
+    Writer->Status = EFI_INVALID_PARAMETER;
+    return Writer->Status;
+  }
+
+  if (Size == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Status = CloseStartTag (Writer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Hex digits never need escaping.  Format them in chunks and let WriteBytes split
+  // the chunks across flushes, as a digit pair may not fit a small buffer.
+  //
+  Length = 0;
+  for (Index = 0; Index < Size; Index++) {
+    Hex[Length++] = HexDigits[Data[Index] >> 4];
+    Hex[Length++] = HexDigits[Data[Index] & 0xF];
+    if ((Length == sizeof (Hex)) || (Index + 1 == Size)) {
+      Status = WriteBytes (Writer, Hex, Length);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+
+      Length = 0;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterEndElement (
+  IN XML_WRITER  *Writer
+  )
+{
+  EFI_STATUS   Status;
+  CONST CHAR8  *Name;
+
+  Status = CheckWriter (Writer, TRUE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Name = Writer->Names[--Writer->Depth];
+
+  // Use empty element notation when there was no value or child
+  if (Writer->StartTagOpen) {
+    Writer->StartTagOpen = FALSE;
+    return WriteBytes (Writer, " />", 3);
+  }
+
+  Status = WriteBytes (Writer, "</", 2);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = WriteString (Writer, Name);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return WriteBytes (Writer, ">", 1);
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterElement (
+  IN       XML_WRITER  *Writer,
+  IN CONST CHAR8       *Name,
+  IN CONST CHAR8       *Value OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = XmlWriterStartElement (Writer, Name);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Value != NULL) {
+    Status = XmlWriterValue (Writer, Value);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return XmlWriterEndElement (Writer);
+}
+
+EFI_STATUS
+EFIAPI
+XmlWriterFinish (
+  IN XML_WRITER  *Writer
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = CheckWriter (Writer, FALSE);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  while (Writer->Depth > 0) {
+    Status = XmlWriterEndElement (Writer);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  FlushBuffer (Writer);
+  return Writer->Status;
+}
+
+VOID
+EFIAPI
+XmlWriterFree (
+  IN XML_WRITER  *Writer
+  )
+{
+  if (Writer == NULL) {
+    return;
+  }
+
+  if (Writer->Buffer != NULL) {
+    FreePool (Writer->Buffer);
+  }
+
+  FreePool (Writer);
+}
@@ -0,0 +1,386 @@
+/**
+@file
+Code for unit testing the XmlWriterLib.
+
+Copyright (C) Microsoft Corporation.
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+#include <XmlTypes.h>
+#include <Library/XmlTreeLib.h>
+#include <Library/XmlWriterLib.h>
+
+#define UNIT_TEST_APP_NAME     "XML Writer Lib Unit Test Application"
+#define UNIT_TEST_APP_VERSION  "0.1"
+
+//
+// Small enough that every document below is flushed in many pieces
+//
+#define TEST_BUFFER_SIZE  (7)
+#define TEST_OUTPUT_SIZE  (0x1000)
+
+#define TEST_XML_TEMPLATE  "<?xml version=\"1.0\" encoding=\"utf-8\"?><Variables></Variables>"
+
+typedef struct {
+  CHAR8         Output[TEST_OUTPUT_SIZE];
+  UINTN         Length;
+  UINTN         FlushCount;
+  UINTN         FailAfter;     // Fail the flush with this count.  0 never fails.
+  XML_WRITER    *Writer;
+  XmlNode       *Tree;
+  CHAR8         *TreeString;
+} XML_WRITER_TEST_CONTEXT;
+
+STATIC XML_WRITER_TEST_CONTEXT  mContext;
+
+/**
+Collect the writer output into the test context.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestFlush (
+  IN       VOID   *Context,
+  IN CONST CHAR8  *Buffer,
+  IN       UINTN  Length
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+
+  TestContext->FlushCount++;
+  if ((TestContext->FailAfter != 0) && (TestContext->FlushCount >= TestContext->FailAfter)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (TestContext->Length + Length >= sizeof (TestContext->Output)) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  CopyMem (TestContext->Output + TestContext->Length, Buffer, Length);
+  TestContext->Length                      += Length;
+  TestContext->Output[TestContext->Length] = '\0';
+  return EFI_SUCCESS;
+}
+
+/**
+Reset the context and create a writer for the test.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+SetUpWriter (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+
+  ZeroMem (TestContext, sizeof (*TestContext));
+  if (EFI_ERROR (XmlWriterCreate (TestFlush, TestContext, TEST_BUFFER_SIZE, &TestContext->Writer))) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+Simple clean up method to make sure tests clean up even if interrupted and fail in the middle.
+**/
+VOID
+EFIAPI
+CleanUpWriter (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+
+  XmlWriterFree (TestContext->Writer);
+  TestContext->Writer = NULL;
+
+  if (TestContext->Tree != NULL) {
+    FreeXmlTree (&TestContext->Tree);
+  }
+
+  if (TestContext->TreeString != NULL) {
+    FreePool (TestContext->TreeString);
+    TestContext->TreeString = NULL;
+  }
+}
+
+/**
+The writer must produce the same document as building the tree and calling XmlTreeToString.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MatchesXmlTreeToString (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+  XmlNode                  *Node;
+  XmlNode                  *Child;
+  UINTN                    Size;
+  XML_WRITER               *Writer;
+
+  Writer = TestContext->Writer;
+
+  UT_ASSERT_NOT_EFI_ERROR (CreateXmlTree (TEST_XML_TEMPLATE, sizeof (TEST_XML_TEMPLATE) - 1, &TestContext->Tree));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (TestContext->Tree, "Variable", NULL, &Node));
+  UT_ASSERT_NOT_EFI_ERROR (AddAttributeToNode (Node, "Name", "A<B>&'C'"));
+  UT_ASSERT_NOT_EFI_ERROR (AddAttributeToNode (Node, "Guid", "\"quoted\""));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (Node, "Size", "4", NULL));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (Node, "Data", "DEADBEEF", NULL));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (Node, "ReadyToBoot", NULL, &Child));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (Child, "ReadStatus", "0x0 Success", NULL));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (Child, "WriteStatus", "a < b && c > d", NULL));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (Node, "Empty", NULL, NULL));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (Node, "Blank", "", NULL));
+  UT_ASSERT_NOT_EFI_ERROR (AddNode (Node, "NoData", "", NULL));
+  UT_ASSERT_NOT_EFI_ERROR (XmlTreeToString (TestContext->Tree, TRUE, &Size, &TestContext->TreeString));
+
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterDeclaration (Writer));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (Writer, "Variables"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (Writer, "Variable"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterAttribute (Writer, "Name", "A<B>&'C'"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterAttribute (Writer, "Guid", "\"quoted\""));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterElement (Writer, "Size", "4"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (Writer, "Data"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterHexValue (Writer, (CONST UINT8 *)"\xde\xad\xbe\xef", 4));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterEndElement (Writer));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (Writer, "ReadyToBoot"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterElement (Writer, "ReadStatus", "0x0 Success"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (Writer, "WriteStatus"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterValue (Writer, "a < b "));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterValue (Writer, "&& c > d"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterEndElement (Writer));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterEndElement (Writer));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterElement (Writer, "Empty", NULL));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterElement (Writer, "Blank", ""));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (Writer, "NoData"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterHexValue (Writer, NULL, 0));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterEndElement (Writer));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterFinish (Writer));
+
+  UT_LOG_INFO ("Tree:   %a\n", TestContext->TreeString);
+  UT_LOG_INFO ("Writer: %a\n", TestContext->Output);
+  UT_ASSERT_TRUE (TestContext->FlushCount > 1);
+  UT_ASSERT_EQUAL (TestContext->Length, AsciiStrLen (TestContext->TreeString));
+  UT_ASSERT_MEM_EQUAL (TestContext->Output, TestContext->TreeString, TestContext->Length);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+Every escaped character must produce the same output as XmlEscape.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+EscapesLikeXmlEscape (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+  CONST CHAR8              *Raw         = "<>\"'&plain&amp;";
+
+  UT_ASSERT_NOT_EFI_ERROR (XmlEscape (Raw, AsciiStrLen (Raw) + 1, &TestContext->TreeString));
+
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (TestContext->Writer, "a"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterValue (TestContext->Writer, Raw));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterFinish (TestContext->Writer));
+
+  UT_ASSERT_EQUAL (TestContext->Length, AsciiStrLen (TestContext->TreeString) + AsciiStrLen ("<a></a>"));
+  UT_ASSERT_MEM_EQUAL (TestContext->Output + 3, TestContext->TreeString, AsciiStrLen (TestContext->TreeString));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+Hex values must be written whole with any buffer size, including a single byte.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+HexValueAnyBufferSize (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+  UINT8                    Data[100];
+  UINTN                    Index;
+
+  for (Index = 0; Index < sizeof (Data); Index++) {
+    Data[Index] = (UINT8)(Index * 7);
+  }
+
+  XmlWriterFree (TestContext->Writer);
+  TestContext->Writer = NULL;
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterCreate (TestFlush, TestContext, 1, &TestContext->Writer));
+
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (TestContext->Writer, "a"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterHexValue (TestContext->Writer, Data, sizeof (Data)));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterFinish (TestContext->Writer));
+
+  UT_ASSERT_EQUAL (TestContext->Length, sizeof (Data) * 2 + AsciiStrLen ("<a></a>"));
+  UT_ASSERT_EQUAL (TestContext->FlushCount, TestContext->Length);
+  UT_ASSERT_MEM_EQUAL (TestContext->Output, "<a>00070E15", 11);
+  UT_ASSERT_MEM_EQUAL (TestContext->Output + TestContext->Length - 6, "B5</a>", 6);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+Finish must close every element that is still open.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FinishClosesElements (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (TestContext->Writer, "a"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (TestContext->Writer, "b"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (TestContext->Writer, "c"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterFinish (TestContext->Writer));
+
+  UT_ASSERT_EQUAL (TestContext->Length, AsciiStrLen ("<a><b><c /></b></a>"));
+  UT_ASSERT_MEM_EQUAL (TestContext->Output, "<a><b><c /></b></a>", TestContext->Length);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+Misuse is reported and stops the writer.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MisuseStopsWriter (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+
+  UT_ASSERT_STATUS_EQUAL (XmlWriterValue (TestContext->Writer, "no element"), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (XmlWriterStartElement (TestContext->Writer, "a"), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (XmlWriterFinish (TestContext->Writer), EFI_INVALID_PARAMETER);
+  UT_ASSERT_EQUAL (TestContext->Length, 0);
+
+  XmlWriterFree (TestContext->Writer);
+  UT_ASSERT_EQUAL (SetUpWriter (Context), UNIT_TEST_PASSED);
+
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (TestContext->Writer, "a"));
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterValue (TestContext->Writer, "value"));
+  UT_ASSERT_STATUS_EQUAL (XmlWriterAttribute (TestContext->Writer, "late", "1"), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (XmlWriterFinish (TestContext->Writer), EFI_INVALID_PARAMETER);
+
+  XmlWriterFree (TestContext->Writer);
+  UT_ASSERT_EQUAL (SetUpWriter (Context), UNIT_TEST_PASSED);
+
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterElement (TestContext->Writer, "a", NULL));
+  UT_ASSERT_STATUS_EQUAL (XmlWriterElement (TestContext->Writer, "b", NULL), EFI_INVALID_PARAMETER);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+A failing flush stops the writer and is returned by Finish.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FlushFailureIsReturned (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  XML_WRITER_TEST_CONTEXT  *TestContext = (XML_WRITER_TEST_CONTEXT *)Context;
+  UINTN                    Index;
+
+  TestContext->FailAfter = 2;
+
+  UT_ASSERT_NOT_EFI_ERROR (XmlWriterStartElement (TestContext->Writer, "list"));
+  for (Index = 0; Index < 8; Index++) {
+    if (EFI_ERROR (XmlWriterElement (TestContext->Writer, "item", "value"))) {
+      break;
+    }
+  }
+
+  UT_ASSERT_TRUE (Index < 8);
+  UT_ASSERT_STATUS_EQUAL (XmlWriterFinish (TestContext->Writer), EFI_DEVICE_ERROR);
+  UT_ASSERT_EQUAL (TestContext->FlushCount, 2);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Main fuction sets up the unit test environment
+
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Fw = NULL;
+  UNIT_TEST_SUITE_HANDLE      WriterTestSuite;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Fw, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&WriterTestSuite, Fw, "XML Streaming Writer Test Suite", "Common.Xml.Writer", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for XML Streaming Writer Test Suite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (WriterTestSuite, "Writer output matches XmlTreeToString", "MatchesTree", MatchesXmlTreeToString, SetUpWriter, CleanUpWriter, &mContext);
+  AddTestCase (WriterTestSuite, "Writer escapes values like XmlEscape", "Escape", EscapesLikeXmlEscape, SetUpWriter, CleanUpWriter, &mContext);
+  AddTestCase (WriterTestSuite, "Hex values are written with any buffer size", "HexBufferSize", HexValueAnyBufferSize, SetUpWriter, CleanUpWriter, &mContext);
+  AddTestCase (WriterTestSuite, "Finish closes open elements", "Finish", FinishClosesElements, SetUpWriter, CleanUpWriter, &mContext);
+  AddTestCase (WriterTestSuite, "Misuse stops the writer", "Misuse", MisuseStopsWriter, SetUpWriter, CleanUpWriter, &mContext);
+  AddTestCase (WriterTestSuite, "Flush failure is returned", "FlushFailure", FlushFailureIsReturned, SetUpWriter, CleanUpWriter, &mContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Fw);
+
+EXIT:
+  if (Fw) {
+    FreeUnitTestFramework (Fw);
+  }
+
+  return Status;
+}
+
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  return UnitTestingEntry ();
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}